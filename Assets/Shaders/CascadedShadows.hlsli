@@ -0,0 +1,56 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Shader side of cascaded sun shadows (Renderer/CascadedShadows.h)
+The pixel uses the first cascade whose map it lands inside, then takes a 3x3 PCF
+of that slice.
+----------------------------------------------*/
+#ifndef CASCADEDSHADOWS_H
+#define CASCADEDSHADOWS_H
+
+// Must match Renderer::cbShadowCascade
+struct ShadowCascade
+{
+    float4x4 viewProjection;    // World to light clip space: xy in [-1, 1], z in [0, 1]
+    float4   params;            // x: world units per texel
+};
+
+cbuffer PSShadows : register(b13)
+{
+    ShadowCascade shadowCascades[4];    // Renderer::kMaxShadowCascades
+    uint  shadowCascadeCount;
+    float shadowTexelUV;        // 1 / resolution
+    float shadowNormalOffset;   // In texels, pushes the lookup off the surface against acne
+}
+
+Texture2DArray         shadowMap     : register(t11);
+SamplerComparisonState shadowSampler : register(s1);
+
+// 1 fully lit, 0 fully shadowed
+float SampleCascadedShadow(float3 worldPos, float3 normal)
+{
+    for (uint i = 0; i != shadowCascadeCount; ++i)
+    {
+        // Sphere fits leave each cascade a little larger than its slice, so containment picks the sharpest one
+        float3 offsetPos = worldPos + normal * shadowCascades[i].params.x * shadowNormalOffset;
+        float3 lightPos = mul(shadowCascades[i].viewProjection, float4(offsetPos, 1.0f)).xyz;
+        if (any(abs(lightPos.xy) > 1.0f - 2.0f * shadowTexelUV))
+            continue;
+
+        float2 uv = float2(0.5f + 0.5f * lightPos.x, 0.5f - 0.5f * lightPos.y);
+        float depth = saturate(lightPos.z);
+
+        float lit = 0;
+        [unroll] for (int y = -1; y <= 1; ++y)
+        {
+            [unroll] for (int x = -1; x <= 1; ++x)
+                lit += shadowMap.SampleCmpLevelZero(shadowSampler, float3(uv + float2(x, y) * shadowTexelUV, i), depth);
+        }
+        return lit / 9.0f;
+    }
+
+    // Past the last cascade
+    return 1.0f;
+}
+
+#endif
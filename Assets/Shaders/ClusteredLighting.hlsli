@@ -0,0 +1,90 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Shader side of clustered forward lighting (Renderer/ClusteredLighting.h)
+The pixel finds its cluster from its screen position and view depth, then walks
+that cluster's slice of the light index list.
+----------------------------------------------*/
+#ifndef CLUSTEREDLIGHTING_H
+#define CLUSTEREDLIGHTING_H
+
+#define CLUSTER_LIGHT_POINT 0
+#define CLUSTER_LIGHT_SPOT  1
+
+// Must match Renderer::ClusterLight
+struct ClusterLight
+{
+    float3 position;
+    float  range;
+    float3 color;
+    uint   type;
+    float3 direction;
+    float  cosOuterAngle;
+};
+
+cbuffer PSClusters : register(b12)
+{
+    float3 cameraForward;
+    float  sliceScale;      // slice = floor(log2(viewZ) * sliceScale + sliceBias)
+    float  sliceBias;
+    float2 tileScale;       // Tiles per pixel
+    uint   clusterTilesX;
+    uint   clusterTilesY;
+    uint   clusterSlices;
+}
+
+StructuredBuffer<ClusterLight> gClusterLights       : register(t8);
+StructuredBuffer<uint2>        gClusterGrid         : register(t9);     // (offset, count) into gClusterLightIndices
+StructuredBuffer<uint>         gClusterLightIndices : register(t10);
+
+uint GetClusterIndex(float2 pixel, float viewZ)
+{
+    uint2 tile = min(uint2(pixel * tileScale), uint2(clusterTilesX, clusterTilesY) - 1);
+    int slice = (int)floor(log2(max(viewZ, 1e-4f)) * sliceScale + sliceBias);
+    uint clampedSlice = (uint)clamp(slice, 0, (int)clusterSlices - 1);
+    return (clampedSlice * clusterTilesY + tile.y) * clusterTilesX + tile.x;
+}
+
+// Smooth falloff that reaches zero exactly at the range the light was binned with
+float ClusterLightAttenuation(ClusterLight light, float3 toLight, float dist)
+{
+    float ratio = dist / light.range;
+    float falloff = saturate(1 - ratio * ratio);
+    float attenuation = falloff * falloff;
+
+    if (light.type == CLUSTER_LIGHT_SPOT)
+    {
+        float cosAngle = dot(-toLight, light.direction);
+        attenuation *= smoothstep(light.cosOuterAngle, lerp(light.cosOuterAngle, 1, 0.2f), cosAngle);
+    }
+
+    return attenuation;
+}
+
+// Diffuse and specular from every light in this pixel's cluster
+float3 ShadeClusteredLights(float4 svPosition, float3 worldPos, float3 normal, float3 toCamera, float viewZ, float specularExp)
+{
+    uint2 range = gClusterGrid[GetClusterIndex(svPosition.xy, viewZ)];
+
+    float3 total = 0;
+    for (uint i = 0; i != range.y; ++i)
+    {
+        ClusterLight light = gClusterLights[gClusterLightIndices[range.x + i]];
+
+        float3 toLight = light.position - worldPos;
+        float dist = length(toLight);
+        if (dist >= light.range)
+            continue;
+
+        toLight /= max(dist, 1e-4f);
+        float attenuation = ClusterLightAttenuation(light, toLight, dist);
+
+        float diffuse = DiffuseAmount(normal, toLight);
+        float specular = SpecularPhong(normal, -toLight, toCamera, specularExp) * (diffuse > 0);
+        total += light.color * (diffuse + specular) * attenuation;
+    }
+
+    return total;
+}
+
+#endif
@@ -0,0 +1,34 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Shader side of the bindless material table (Renderer/MaterialTable.h)
+Instances carry an index into gMaterials, whose texture indices point into the
+shader visible descriptor heap. Needs SM 6.6 for ResourceDescriptorHeap.
+----------------------------------------------*/
+#ifndef MATERIALTABLE_H
+#define MATERIALTABLE_H
+
+#define NO_DESCRIPTOR 0xFFFFFFFF
+
+// Must match Renderer::GPUMaterial
+struct GPUMaterial
+{
+    float4 colorTint;
+    float  specularExp;
+    uint   diffuseIndex;
+    uint   normalIndex;
+    uint   flags;
+};
+
+StructuredBuffer<GPUMaterial> gMaterials : register(t0, space1);
+
+float4 SampleMaterialTexture(uint descriptorIndex, SamplerState samp, float2 uv, float4 fallback)
+{
+    if (descriptorIndex == NO_DESCRIPTOR)
+        return fallback;
+
+    Texture2D tex = ResourceDescriptorHeap[NonUniformResourceIndex(descriptorIndex)];
+    return tex.Sample(samp, uv);
+}
+
+#endif
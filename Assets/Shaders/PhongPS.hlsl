@@ -1,4 +1,11 @@
+// Variants: NORMAL_MAP ALPHA_TEST TEXTURE_ARRAY CLUSTERED_LIGHTS SHADOWS
 #include "PhongCommon.hlsli"
+#if CLUSTERED_LIGHTS
+#include "ClusteredLighting.hlsli"
+#endif
+#if SHADOWS
+#include "CascadedShadows.hlsli"
+#endif
 
 struct VertexOut
 {
@@ -22,18 +29,71 @@ cbuffer PSPerMaterial : register(b11)
 {
     float4 colorTint;
     float  specularity;
+    uint   diffuseSlice;
+    uint   normalSlice;
+    float4 diffuseRect;         // Atlas offset (xy) and scale (zw), identity for array slices
+    float4 normalRect;
 }
 
+#if TEXTURE_ARRAY
+Texture2DArray diffuseTexture : register(t0);
+#if NORMAL_MAP
+Texture2DArray normalMap      : register(t1);
+#endif
+#else
 Texture2D diffuseTexture    : register(t0);
+#if NORMAL_MAP
+Texture2D normalMap         : register(t1);
+#endif
+#endif
 SamplerState samplerOptions : register(s0);
+
+#if TEXTURE_ARRAY
+// Wraps uv inside the material's cell. Gradients come from the unwrapped uv, so the wrap doesn't drop to the coarsest mip.
+float4 SamplePacked(Texture2DArray page, uint slice, float4 rect, float2 uv)
+{
+    float2 pageUV = rect.xy + frac(uv) * rect.zw;
+    return page.SampleGrad(samplerOptions, float3(pageUV, slice), ddx(uv) * rect.zw, ddy(uv) * rect.zw);
+}
+#endif
+
+#if ALPHA_TEST
+static const float alphaCutoff = 0.5f;
+#endif
+
 float4 main(VertexOut input) : SV_TARGET
 {
     // Sample diffuse texture, normal map(unpacked)
-    float3 surfaceColor = diffuseTexture.Sample(samplerOptions, input.uv).rgb;
+#if TEXTURE_ARRAY
+    float4 diffuseSample = SamplePacked(diffuseTexture, diffuseSlice, diffuseRect, input.uv);
+#else
+    float4 diffuseSample = diffuseTexture.Sample(samplerOptions, input.uv);
+#endif
+    float3 surfaceColor = diffuseSample.rgb;
+
+#if ALPHA_TEST
+    clip(diffuseSample.a - alphaCutoff);
+#endif
 
     // Normalize normal vector
     input.normal = normalize(input.normal);
 
+#if NORMAL_MAP
+    // Cooked normal maps are BC5 and only store xy, so rebuild z
+#if TEXTURE_ARRAY
+    float2 sampledXY = SamplePacked(normalMap, normalSlice, normalRect, input.uv).rg * 2 - 1;
+#else
+    float2 sampledXY = normalMap.Sample(samplerOptions, input.uv).rg * 2 - 1;
+#endif
+    float3 sampledNormal = float3(sampledXY, sqrt(saturate(1 - dot(sampledXY, sampledXY))));
+    input.tangent = normalize(input.tangent - dot(input.tangent, input.normal) * input.normal);
+    input.binormal = normalize(input.binormal);
+
+    // create transformation matrix TBN
+    float3x3 TBN = float3x3(input.tangent, input.binormal, input.normal);
+    input.normal = mul(sampledNormal, TBN);
+#endif
+
     // Holds the total light for this pixel
     float3 totalLight = 0;
     float3 toCamera = normalize(cameraWorldPos - input.worldPos);
@@ -47,7 +107,16 @@ float4 main(VertexOut input) : SV_TARGET
         SpecularPhong(input.normal, -directionalLight.toLight, toCamera, specularity) * any(diffuseLighting);
 
     // Add to totallight
+#if SHADOWS
+    totalLight += (diffuseLighting + specularLighting) * SampleCascadedShadow(input.worldPos, input.normal);
+#else
     totalLight += diffuseLighting + specularLighting;
+#endif
+
+#if CLUSTERED_LIGHTS
+    float viewZ = dot(input.worldPos - cameraWorldPos, cameraForward);
+    totalLight += ShadeClusteredLights(input.position, input.worldPos, input.normal, toCamera, viewZ, specularity);
+#endif
 
     // Finally, add the ambient color
     totalLight += ambientColor;
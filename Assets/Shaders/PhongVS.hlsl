@@ -1,3 +1,4 @@
+// Variants: INSTANCED
 #include "VS_Common.hlsli"
 
 struct VertexIn
@@ -7,6 +8,11 @@ struct VertexIn
     float2 uv       : TEXCOORD;
     float3 tangent  : TANGENT;
     float3 binormal : BINORMAL;
+
+#if INSTANCED
+    // Instancing
+    float4x4 world  : INSTANCE_WORLDMATRIX;
+#endif
 };
 
 struct VertexOut
@@ -24,24 +30,30 @@ VertexOut main( VertexIn vi)
 {
     VertexOut vo;
 
+#if INSTANCED
+    float4x4 toWorld = vi.world;
+#else
+    float4x4 toWorld = world;
+#endif
+
     // Construct camera matrix
-    matrix wvp = mul(viewProjection, world);
+    matrix wvp = mul(viewProjection, toWorld);
 
     // Transform position by camera matrix
     vo.position = mul(wvp, float4(vi.position, 1.0f));
 
     // Transform normal too
-    vo.normal = mul((float3x3)world, vi.normal);
+    vo.normal = mul((float3x3)toWorld, vi.normal);
 
     // Pass along UVs
     vo.uv = vi.uv;
 
-    // Pass along world position
-    vo.worldPos = mul((float3x3)world, vi.position);
+    // Pass along world position, translation included: lights and shadows look it up
+    vo.worldPos = mul(toWorld, float4(vi.position, 1.0f)).xyz;
 
     // Transform tangent, binormal
-    vo.tangent = mul((float3x3)world, vi.tangent);
-    vo.binormal = mul((float3x3)world, vi.binormal);
+    vo.tangent = mul((float3x3)toWorld, vi.tangent);
+    vo.binormal = mul((float3x3)toWorld, vi.binormal);
 
     vo.color = float4(1, 1, 1, 1);
     
@@ -0,0 +1,247 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of Benchmark.h
+----------------------------------------------*/
+#include "Benchmark.h"
+
+#include <Muon/Renderer/NullRenderBackend.h>
+
+#include <algorithm>
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+namespace Benchmark {
+
+namespace {
+
+// Every path loops over this, ten seconds of the 60Hz simulation
+const float kPathSeconds = 10.0f;
+
+// Entities, meshes, materials, lights, cascades, texture budget in KB, bindless, camera
+const Scene kScenes[] =
+{
+    { "default",   "The grid Headless runs with no options, flown over",                       4096,  4,  3,    0, 0,     0, false, CameraMove::FLYOVER },
+    { "crowd",     "Four times the entities and ten times the materials, in one material table", 16384, 8, 32,    0, 0,     0, true,  CameraMove::STREET  },
+    { "lights",    "A thousand clustered lights seen from inside the grid",                     4096,  4,  3, 1024, 0,     0, false, CameraMove::STREET  },
+    { "shadows",   "Four sun cascades chasing a camera that won't keep still",                  4096,  4,  3,    0, 4,     0, false, CameraMove::SWEEP   },
+    { "streaming", "Sixty four streamed materials under a 16MB budget, from far to close",      4096,  4, 64,    0, 0, 16384, false, CameraMove::DOLLY   },
+    { "full",      "Everything at once",                                                        8192,  8, 16,  512, 4,     0, true,  CameraMove::FLYOVER },
+};
+
+const uint32_t kSceneCount = (uint32_t)(sizeof(kScenes) / sizeof(kScenes[0]));
+
+void SetKey(Core::CameraKey& key, float time, float x, float y, float z, float targetX, float targetY, float targetZ)
+{
+    key = { time, { x, y, z }, { targetX, targetY, targetZ } };
+}
+
+// Scaled to the grid, so a scene with more entities flies further rather than seeing less of them
+void BuildPath(CameraMove move, float halfExtent, Core::CameraPath& out_path)
+{
+    const float h = halfExtent;
+    Core::CameraKey keys[8];
+    uint32_t count = 0;
+
+    switch (move)
+    {
+    case CameraMove::FLYOVER:
+    {
+        // Round the corners, looking at the ground under the next one
+        const float c = 0.6f * h;
+        const float y = 0.3f * h + 10.0f;
+        SetKey(keys[count++], 0.0f,                -c, y, -c,  c, 0.0f, -c);
+        SetKey(keys[count++], kPathSeconds * 0.25f, c, y, -c,  c, 0.0f,  c);
+        SetKey(keys[count++], kPathSeconds * 0.5f,  c, y,  c, -c, 0.0f,  c);
+        SetKey(keys[count++], kPathSeconds * 0.75f, -c, y,  c, -c, 0.0f, -c);
+        break;
+    }
+    case CameraMove::STREET:
+    {
+        // Up one row and back down another, looking where it's headed
+        const float x = 0.7f * h;
+        const float z = 0.4f * h;
+        const float y = 2.0f;
+        SetKey(keys[count++], 0.0f,                -x, y, -z,  x, y, -z);
+        SetKey(keys[count++], kPathSeconds * 0.4f,  x, y, -z,  x, y,  z);
+        SetKey(keys[count++], kPathSeconds * 0.5f,  x, y,  z, -x, y,  z);
+        SetKey(keys[count++], kPathSeconds * 0.9f, -x, y,  z, -x, y, -z);
+        break;
+    }
+    case CameraMove::DOLLY:
+    {
+        // Two keys looping eases out of each end, so it lingers wide and close
+        SetKey(keys[count++], 0.0f,                0.0f, 0.5f * h + 10.0f, -1.1f * h, 0.0f, 0.0f, 0.0f);
+        SetKey(keys[count++], kPathSeconds * 0.5f, 0.0f, 3.0f,             -6.0f,     0.0f, 1.0f, 0.0f);
+        break;
+    }
+    case CameraMove::SWEEP:
+    {
+        // Once around the center, swinging in low and out high every eighth of the way
+        for (uint32_t i = 0; i != 8; ++i)
+        {
+            const float angle = (float)i * 0.7853982f;
+            const float radius = (i & 1) ? 0.8f * h : 0.3f * h;
+            const float y = (i & 1) ? 30.0f : 8.0f;
+            SetKey(keys[count++], kPathSeconds * i / 8.0f, cosf(angle) * radius, y, sinf(angle) * radius, 0.0f, 0.0f, 0.0f);
+        }
+        break;
+    }
+    }
+
+    out_path.SetKeys(keys, count, kPathSeconds);
+}
+
+void WriteStage(FILE* file, const char* name, Core::FrameStatsSummary const& stage, bool last)
+{
+    fprintf(file, "      \"%s\":{\"avgMs\":%.4f,\"minMs\":%.4f,\"p50Ms\":%.4f,\"p95Ms\":%.4f,\"p99Ms\":%.4f,\"maxMs\":%.4f,\"stdDevMs\":%.4f}%s\n",
+        name, stage.AvgMs, stage.MinMs, stage.P50Ms, stage.P95Ms, stage.P99Ms, stage.MaxMs, stage.StdDevMs, last ? "" : ",");
+}
+
+}
+
+uint32_t GetSceneCount()
+{
+    return kSceneCount;
+}
+
+Scene const& GetScene(uint32_t index)
+{
+    assert(index < kSceneCount);
+    return kScenes[index];
+}
+
+Scene const* FindScene(const char* name)
+{
+    for (Scene const& scene : kScenes)
+    {
+        if (!strcmp(scene.Name, name))
+            return &scene;
+    }
+    return nullptr;
+}
+
+void ApplyScene(Scene const& scene, Core::HeadlessConfig& out_config, Core::CameraPath& out_path)
+{
+    out_config.EntityCount       = scene.EntityCount;
+    out_config.MeshCount         = scene.MeshCount;
+    out_config.MaterialCount     = scene.MaterialCount;
+    out_config.LightCount        = scene.LightCount;
+    out_config.ShadowCascades    = scene.ShadowCascades;
+    out_config.TextureBudgetKB   = scene.TextureBudgetKB;
+    out_config.BindlessMaterials = scene.BindlessMaterials;
+    out_config.TextureArrays     = false;
+
+    BuildPath(scene.Camera, Core::HeadlessGame::GetGridHalfExtent(scene.EntityCount), out_path);
+    out_config.pCameraPath = &out_path;
+}
+
+bool Run(Scene const& scene, Core::HeadlessConfig config, uint32_t contextCount, Result& out_result)
+{
+    Core::CameraPath path;
+    ApplyScene(scene, config, path);
+
+    // Every scene replays a recording from its start
+    if (config.pInputReplay)
+        config.pInputReplay->Rewind();
+
+    Renderer::NullRenderBackend backend(contextCount);
+    Core::HeadlessGame game;
+    if (!game.Init(&backend, config))
+        return false;
+
+    // Big enough for every frame, so the percentiles cover the whole run
+    const uint32_t capacity = std::max(config.FrameCount, 1u);
+    std::vector<Core::FrameStatistics> stages((uint8_t)Core::HeadlessStage::COUNT, Core::FrameStatistics(capacity));
+    Core::FrameStatistics frame(capacity);
+
+    // The report only keeps totals, so each frame's times are what the totals went up by
+    double stageTotals[(uint8_t)Core::HeadlessStage::COUNT] = {};
+    double frameTotal = 0.0;
+    for (uint32_t i = 0; i != config.FrameCount; ++i)
+    {
+        game.Frame();
+
+        Core::HeadlessReport const& report = game.GetReport();
+        for (uint8_t s = 0; s != (uint8_t)Core::HeadlessStage::COUNT; ++s)
+        {
+            stages[s].AddFrame(report.Stages[s].TotalMs - stageTotals[s]);
+            stageTotals[s] = report.Stages[s].TotalMs;
+        }
+        frame.AddFrame(report.Frame.TotalMs - frameTotal);
+        frameTotal = report.Frame.TotalMs;
+    }
+
+    out_result.pScene = &scene;
+    out_result.Report = game.GetReport();
+    for (uint8_t s = 0; s != (uint8_t)Core::HeadlessStage::COUNT; ++s)
+        out_result.Stages[s] = stages[s].Summarize();
+    out_result.Frame = frame.Summarize();
+    out_result.CommandHash = backend.GetStats().CommandHash;
+    out_result.StateChanges = backend.GetStats().StateChanges;
+    return true;
+}
+
+void PrintResult(Result const& result)
+{
+    Scene const& scene = *result.pScene;
+    Core::HeadlessReport const& report = result.Report;
+    const double frames = report.Frames ? (double)report.Frames : 1.0;
+
+    printf("%s: %s\n", scene.Name, scene.Description);
+    printf("  %u frames, %u entities, %u meshes, %u materials, %u lights, %u cascades\n",
+        report.Frames, scene.EntityCount, scene.MeshCount, scene.MaterialCount, scene.LightCount, scene.ShadowCascades);
+    printf("  %-8s %10s %10s %10s %10s %10s\n", "Stage", "Avg(ms)", "p50(ms)", "p95(ms)", "p99(ms)", "Max(ms)");
+    for (uint8_t s = 0; s != (uint8_t)Core::HeadlessStage::COUNT; ++s)
+    {
+        Core::FrameStatsSummary const& t = result.Stages[s];
+        printf("  %-8s %10.4f %10.4f %10.4f %10.4f %10.4f\n",
+            Core::HeadlessGame::GetStageName((Core::HeadlessStage)s), t.AvgMs, t.P50Ms, t.P95Ms, t.P99Ms, t.MaxMs);
+    }
+    printf("  %-8s %10.4f %10.4f %10.4f %10.4f %10.4f\n", "Frame", result.Frame.AvgMs, result.Frame.P50Ms, result.Frame.P95Ms, result.Frame.P99Ms, result.Frame.MaxMs);
+    printf("  Per frame: %.1f draws, %.1f instances, %.1f triangles, %.1f KB uploaded, %.1f shadow draws\n",
+        report.DrawCalls / frames, report.Instances / frames, report.Triangles / frames, report.UploadBytes / frames / 1024.0, report.ShadowDraws / frames);
+    printf("  Run hash: %016llx\n", (unsigned long long)report.CommandHash);
+}
+
+bool WriteResults(const char* path, Result const* pResults, uint32_t count, uint32_t workerCount, uint32_t contextCount)
+{
+    FILE* file = fopen(path, "wb");
+    if (!file)
+        return false;
+
+    fprintf(file, "{\n  \"workers\":%u,\n  \"contexts\":%u,\n  \"scenes\":[\n", workerCount, contextCount);
+    for (uint32_t i = 0; i != count; ++i)
+    {
+        Result const& result = pResults[i];
+        Scene const& scene = *result.pScene;
+        Core::HeadlessReport const& report = result.Report;
+        const double frames = report.Frames ? (double)report.Frames : 1.0;
+
+        // Hashes as strings, a JSON number can't hold 64 bits
+        fprintf(file, "  {\n    \"name\":\"%s\",\"frames\":%u,\"entities\":%u,\"meshes\":%u,\"materials\":%u,\"lights\":%u,\"cascades\":%u,\"textureBudgetKB\":%u,\"bindless\":%s,\n",
+            scene.Name, report.Frames, scene.EntityCount, scene.MeshCount, scene.MaterialCount, scene.LightCount, scene.ShadowCascades,
+            scene.TextureBudgetKB, scene.BindlessMaterials ? "true" : "false");
+        fprintf(file, "    \"runHash\":\"%016llx\",\"commandHash\":\"%016llx\",\"stateChanges\":%u,\n",
+            (unsigned long long)report.CommandHash, (unsigned long long)result.CommandHash, result.StateChanges);
+        fprintf(file, "    \"perFrame\":{\"draws\":%.2f,\"instances\":%.2f,\"triangles\":%.2f,\"uploadKB\":%.2f,\"shadowDraws\":%.2f,\"recordContexts\":%.2f},\n",
+            report.DrawCalls / frames, report.Instances / frames, report.Triangles / frames, report.UploadBytes / frames / 1024.0,
+            report.ShadowDraws / frames, report.RecordContexts / frames);
+
+        fprintf(file, "    \"stages\":{\n");
+        for (uint8_t s = 0; s != (uint8_t)Core::HeadlessStage::COUNT; ++s)
+            WriteStage(file, Core::HeadlessGame::GetStageName((Core::HeadlessStage)s), result.Stages[s], false);
+        WriteStage(file, "Frame", result.Frame, true);
+        fprintf(file, "    }\n  }%s\n", i + 1 != count ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+
+    const bool ok = !ferror(file);
+    fclose(file);
+    return ok;
+}
+
+}
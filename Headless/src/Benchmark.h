@@ -0,0 +1,70 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Named benchmark scenes for regression tracking
+Each scene fixes what's in the world and flies the camera along a scripted
+path over it, so two runs of the same scene at the same frame count do the
+same work and differ only in how long it took. Stage times are kept for
+every frame, so results carry percentiles as well as averages.
+----------------------------------------------*/
+#ifndef MUON_BENCHMARK_H
+#define MUON_BENCHMARK_H
+
+#include <Muon/Core/CameraPath.h>
+#include <Muon/Core/FrameStatistics.h>
+#include <Muon/Core/HeadlessGame.h>
+
+#include <stdint.h>
+
+namespace Benchmark {
+
+enum class CameraMove : uint8_t
+{
+    FLYOVER,    // High circuit of the grid looking down ahead of itself
+    STREET,     // Eye level down the rows, with most of the grid in front of it
+    DOLLY,      // From the whole grid to a close up on its center and back
+    SWEEP       // Swinging in and out around the center, so cached shadow cascades keep going stale
+};
+
+struct Scene
+{
+    const char* Name;
+    const char* Description;
+    uint32_t    EntityCount;
+    uint32_t    MeshCount;
+    uint32_t    MaterialCount;
+    uint32_t    LightCount;
+    uint32_t    ShadowCascades;
+    uint32_t    TextureBudgetKB;
+    bool        BindlessMaterials;
+    CameraMove  Camera;
+};
+
+struct Result
+{
+    Scene const*            pScene;
+    Core::HeadlessReport    Report;
+    Core::FrameStatsSummary Stages[(uint8_t)Core::HeadlessStage::COUNT];
+    Core::FrameStatsSummary Frame;
+    uint64_t                CommandHash;    // The null backend's, over every command it was given
+    uint32_t                StateChanges;
+};
+
+uint32_t     GetSceneCount();
+Scene const& GetScene(uint32_t index);
+Scene const* FindScene(const char* name);    // Null if there's no such scene
+
+// Sets the scene's content on the config and lays its camera path over the grid. Frame count, seed,
+// fixed step and the submission options are left as they were.
+void ApplyScene(Scene const& scene, Core::HeadlessConfig& out_config, Core::CameraPath& out_path);
+
+// Runs config.FrameCount frames of the scene on a fresh null backend. False if it couldn't initialize.
+bool Run(Scene const& scene, Core::HeadlessConfig config, uint32_t contextCount, Result& out_result);
+
+void PrintResult(Result const& result);
+
+// Every result as one JSON document. False if the file couldn't be written.
+bool WriteResults(const char* path, Result const* pResults, uint32_t count, uint32_t workerCount, uint32_t contextCount);
+
+}
+#endif
@@ -0,0 +1,1525 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of Checks.h
+----------------------------------------------*/
+#include "Checks.h"
+
+#include <Muon/Core/Clock.h>
+#include <Muon/Core/DescriptorAllocator.h>
+#include <Muon/Core/JobSystem.h>
+#include <Muon/Core/PipelineKey.h>
+#include <Muon/Memory/Allocators.h>
+#include <Muon/Renderer/MaterialTable.h>
+#include <Muon/Renderer/RenderGraph.h>
+#include <Muon/Renderer/ShaderReflectionRecord.h>
+#include <Muon/Renderer/hash_util.h>
+
+#include <stdarg.h>
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+namespace Checks {
+
+namespace {
+
+int Fail(const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fputc('\n', stderr);
+    return EXIT_FAILURE;
+}
+
+double MsSince(uint64_t start)
+{
+    Core::SystemClock& clock = Core::SystemClock::Get();
+    return (double)(clock.GetCounter() - start) * 1000.0 / clock.GetFrequency();
+}
+
+// Same LCG as the headless game's, so a failing seed can be stepped through
+struct Random
+{
+    uint32_t State;
+
+    uint32_t Next()                  { State = State * 1664525u + 1013904223u; return State >> 8; }
+    uint32_t Next(uint32_t lo, uint32_t hi) { return lo + Next() % (hi - lo + 1); }
+};
+
+const uint32_t kFreeSlot = ~0u;
+
+// Stands in for a descriptor heap: who owns each slot, so overlapping ranges are caught the moment they're handed out
+class FakeHeap
+{
+public:
+    FakeHeap(uint32_t baseOffset, uint32_t capacity) :
+        mBase(baseOffset),
+        mOwners(capacity, kFreeSlot)
+    {}
+
+    bool Claim(Muon::DescriptorRange range, uint32_t owner)
+    {
+        if (range.Offset < mBase || range.Offset + range.Count > mBase + (uint32_t)mOwners.size())
+            return false;
+        for (uint32_t i = 0; i != range.Count; ++i)
+        {
+            if (mOwners[range.Offset - mBase + i] != kFreeSlot)
+                return false;
+            mOwners[range.Offset - mBase + i] = owner;
+        }
+        return true;
+    }
+
+    bool Release(Muon::DescriptorRange range, uint32_t owner)
+    {
+        for (uint32_t i = 0; i != range.Count; ++i)
+        {
+            if (mOwners[range.Offset - mBase + i] != owner)
+                return false;
+            mOwners[range.Offset - mBase + i] = kFreeSlot;
+        }
+        return true;
+    }
+
+    // Every slot some owner still holds, and the longest run of free ones
+    uint32_t CountOwned() const
+    {
+        uint32_t owned = 0;
+        for (uint32_t owner : mOwners)
+            owned += owner != kFreeSlot ? 1 : 0;
+        return owned;
+    }
+
+    uint32_t GetLargestFreeRun() const
+    {
+        uint32_t largest = 0;
+        uint32_t run = 0;
+        for (uint32_t owner : mOwners)
+        {
+            run = owner == kFreeSlot ? run + 1 : 0;
+            largest = run > largest ? run : largest;
+        }
+        return largest;
+    }
+
+private:
+    uint32_t              mBase;
+    std::vector<uint32_t> mOwners;
+};
+
+bool IsRange(Muon::DescriptorRange range, uint32_t offset, uint32_t count)
+{
+    return range.Offset == offset && range.Count == count;
+}
+
+// Mostly small tables with the odd big one, allocated a little more often than freed so the list runs close to
+// full and splinters. Every range goes through the heap when there is one. False on the first overlap.
+bool ChurnFreeList(Muon::DescriptorFreeList& list, FakeHeap* pHeap, uint32_t ops)
+{
+    Random rng = { 1234 };
+    std::vector<Muon::DescriptorRange> live;
+    for (uint32_t op = 0; op != ops; ++op)
+    {
+        if (live.empty() || rng.Next(0, 99) < 52)
+        {
+            const Muon::DescriptorRange range = list.Allocate(rng.Next() % 8 ? rng.Next(1, 8) : rng.Next(16, 64));
+            if (!range.IsValid())
+                continue;
+            if (pHeap && !pHeap->Claim(range, (uint32_t)live.size()))
+            {
+                Fail("The free list handed out [%u, +%u), which overlaps a live range", range.Offset, range.Count);
+                return false;
+            }
+            live.push_back(range);
+        }
+        else
+        {
+            // Each range's owner is its index, so the one moved into the hole changes hands
+            const uint32_t i = rng.Next(0, (uint32_t)live.size() - 1);
+            const uint32_t last = (uint32_t)live.size() - 1;
+            if (pHeap && (!pHeap->Release(live[i], i) || (i != last && (!pHeap->Release(live[last], last) || !pHeap->Claim(live[last], i)))))
+            {
+                Fail("A live free list range was handed to someone else");
+                return false;
+            }
+            list.Free(live[i]);
+            live[i] = live[last];
+            live.pop_back();
+        }
+    }
+    return true;
+}
+
+// A frame's ranges are retired two frames after it's submitted, as with that many frames in flight
+bool ChurnRing(Muon::DescriptorRing& ring, FakeHeap* pHeap, uint32_t frames)
+{
+    const uint32_t kLatency = 2;
+
+    Random rng = { 5678 };
+    std::vector<std::vector<Muon::DescriptorRange>> inFlight(kLatency + 1);
+    for (uint32_t frame = 1; frame <= frames; ++frame)
+    {
+        if (frame > kLatency)
+        {
+            const uint32_t retired = frame - kLatency;
+            ring.Retire(retired);
+            for (Muon::DescriptorRange const& range : inFlight[retired % inFlight.size()])
+            {
+                if (pHeap && !pHeap->Release(range, retired))
+                {
+                    Fail("A ring range was handed out again before its fence passed");
+                    return false;
+                }
+            }
+            inFlight[retired % inFlight.size()].clear();
+        }
+
+        std::vector<Muon::DescriptorRange>& ranges = inFlight[frame % inFlight.size()];
+        // Some frames draw nothing, so the ring empties out with their markers still queued
+        const uint32_t draws = rng.Next(0, 3) == 0 ? 0 : rng.Next(16, 96);
+        for (uint32_t i = 0; i != draws; ++i)
+        {
+            const Muon::DescriptorRange range = ring.Allocate(rng.Next(1, 16));
+            if (!range.IsValid())
+                continue;
+            if (pHeap && !pHeap->Claim(range, frame))
+            {
+                Fail("The ring handed out [%u, +%u) on frame %u, which a frame in flight still holds", range.Offset, range.Count, frame);
+                return false;
+            }
+            ranges.push_back(range);
+        }
+        ring.EndFrame(frame);
+    }
+    return true;
+}
+
+// Fills every block of a pool whose elements are smaller than its free list pointer, and empties it twice over
+bool CheckSmallPool(size_t elementSize, size_t alignment)
+{
+    const uint32_t kCount = 64;
+
+    Memory::PoolAllocator pool;
+    pool.Init(elementSize, kCount, Memory::MemoryTag::GENERAL, alignment);
+
+    std::vector<uint8_t*> blocks(kCount);
+    for (uint32_t round = 0; round != 2; ++round)
+    {
+        for (uint32_t i = 0; i != kCount; ++i)
+        {
+            blocks[i] = static_cast<uint8_t*>(pool.Alloc());
+            if (!blocks[i])
+                return false;
+            memset(blocks[i], (int)i, elementSize);
+        }
+        if (pool.Alloc() || !pool.CheckGuards())
+            return false;
+
+        for (uint32_t i = 0; i != kCount; ++i)
+        {
+            for (size_t b = 0; b != elementSize; ++b)
+            {
+                if (blocks[i][b] != (uint8_t)i)
+                    return false;
+            }
+        }
+
+        // Backwards, so the free list comes out in a different order the second time round
+        for (uint32_t i = kCount; i != 0; --i)
+            pool.Free(blocks[i - 1]);
+    }
+    return pool.GetLiveCount() == 0 && pool.CheckGuards();
+}
+
+// The members of D3D12_GRAPHICS_PIPELINE_STATE_DESC that HashGraphicsPipelineDesc reads, under the same names.
+// The state structs keep D3D12's layout, padding after the UINT8 masks included.
+namespace FakeD3D12 {
+
+struct ShaderBytecode     { const void* pShaderBytecode; size_t BytecodeLength; };
+struct SODeclarationEntry { uint32_t Stream; const char* SemanticName; uint32_t SemanticIndex; uint8_t StartComponent, ComponentCount, OutputSlot; };
+struct StreamOutputDesc   { SODeclarationEntry const* pSODeclaration; uint32_t NumEntries; const uint32_t* pBufferStrides; uint32_t NumStrides; uint32_t RasterizedStream; };
+struct RenderTargetBlend  { int32_t BlendEnable, LogicOpEnable; uint32_t SrcBlend, DestBlend, BlendOp, SrcBlendAlpha, DestBlendAlpha, BlendOpAlpha, LogicOp; uint8_t RenderTargetWriteMask; };
+struct BlendDesc          { int32_t AlphaToCoverageEnable, IndependentBlendEnable; RenderTargetBlend RenderTarget[8]; };
+struct RasterizerDesc     { uint32_t FillMode, CullMode; int32_t FrontCounterClockwise, DepthBias; float DepthBiasClamp, SlopeScaledDepthBias;
+                            int32_t DepthClipEnable, MultisampleEnable, AntialiasedLineEnable; uint32_t ForcedSampleCount, ConservativeRaster; };
+struct StencilOpDesc      { uint32_t StencilFailOp, StencilDepthFailOp, StencilPassOp, StencilFunc; };
+struct DepthStencilDesc   { int32_t DepthEnable; uint32_t DepthWriteMask, DepthFunc; int32_t StencilEnable; uint8_t StencilReadMask, StencilWriteMask;
+                            StencilOpDesc FrontFace, BackFace; };
+struct InputElementDesc   { const char* SemanticName; uint32_t SemanticIndex, Format, InputSlot, AlignedByteOffset, InputSlotClass, InstanceDataStepRate; };
+struct InputLayoutDesc    { InputElementDesc const* pInputElementDescs; uint32_t NumElements; };
+struct MultisampleDesc    { uint32_t Count, Quality; };
+
+struct GraphicsPipelineDesc
+{
+    ShaderBytecode   VS, PS, DS, HS, GS;
+    StreamOutputDesc StreamOutput;
+    BlendDesc        BlendState;
+    uint32_t         SampleMask;
+    RasterizerDesc   RasterizerState;
+    DepthStencilDesc DepthStencilState;
+    InputLayoutDesc  InputLayout;
+    uint32_t         IBStripCutValue;
+    uint32_t         PrimitiveTopologyType;
+    uint32_t         NumRenderTargets;
+    uint32_t         RTVFormats[8];
+    uint32_t         DSVFormat;
+    MultisampleDesc  SampleDesc;
+    uint32_t         NodeMask;
+    uint32_t         Flags;
+};
+
+}
+
+// Owns everything a desc points at, so two of them can be built the same out of different memory
+struct PipelineDescSource
+{
+    std::vector<uint8_t>                     VS;
+    std::vector<uint8_t>                     PS;
+    std::vector<std::string>                 Semantics;
+    std::vector<FakeD3D12::InputElementDesc> Elements;
+    FakeD3D12::GraphicsPipelineDesc          Desc;
+
+    PipelineDescSource() :
+        VS(64),
+        PS(48),
+        Semantics({ "POSITION", "NORMAL", "TEXCOORD" }),
+        Elements(3),
+        Desc()
+    {
+        for (size_t i = 0; i != VS.size(); ++i)
+            VS[i] = (uint8_t)(i * 7);
+        for (size_t i = 0; i != PS.size(); ++i)
+            PS[i] = (uint8_t)(i * 13 + 1);
+
+        const uint32_t formats[] = { 6, 6, 16 };    // R32G32B32_FLOAT twice, R32G32_FLOAT
+        const uint32_t offsets[] = { 0, 12, 24 };
+        for (size_t i = 0; i != Elements.size(); ++i)
+            Elements[i] = { nullptr, 0, formats[i], 0, offsets[i], 0, 0 };
+
+        SetStates(Desc);
+        Desc.SampleMask = ~0u;
+        Desc.PrimitiveTopologyType = 3;
+        Desc.NumRenderTargets = 1;
+        Desc.RTVFormats[0] = 28;
+        Desc.DSVFormat = 40;
+        Desc.SampleDesc = { 1, 0 };
+        Refresh();
+    }
+
+    PipelineDescSource(PipelineDescSource const& other) :
+        VS(other.VS),
+        PS(other.PS),
+        Semantics(other.Semantics),
+        Elements(other.Elements),
+        Desc(other.Desc)
+    {
+        Refresh();
+    }
+
+    // Member by member, the way a desc is built on the stack, so padding is left as it was
+    static void SetStates(FakeD3D12::GraphicsPipelineDesc& desc)
+    {
+        desc.BlendState.AlphaToCoverageEnable = 0;
+        desc.BlendState.IndependentBlendEnable = 0;
+        for (FakeD3D12::RenderTargetBlend& target : desc.BlendState.RenderTarget)
+        {
+            target.BlendEnable = 0;
+            target.LogicOpEnable = 0;
+            target.SrcBlend = target.SrcBlendAlpha = 2;
+            target.DestBlend = target.DestBlendAlpha = 1;
+            target.BlendOp = target.BlendOpAlpha = 1;
+            target.LogicOp = 4;
+            target.RenderTargetWriteMask = 0xF;
+        }
+
+        desc.RasterizerState.FillMode = 3;
+        desc.RasterizerState.CullMode = 3;
+        desc.RasterizerState.FrontCounterClockwise = 0;
+        desc.RasterizerState.DepthBias = 0;
+        desc.RasterizerState.DepthBiasClamp = 0.0f;
+        desc.RasterizerState.SlopeScaledDepthBias = 0.0f;
+        desc.RasterizerState.DepthClipEnable = 1;
+        desc.RasterizerState.MultisampleEnable = 0;
+        desc.RasterizerState.AntialiasedLineEnable = 0;
+        desc.RasterizerState.ForcedSampleCount = 0;
+        desc.RasterizerState.ConservativeRaster = 0;
+
+        desc.DepthStencilState.DepthEnable = 1;
+        desc.DepthStencilState.DepthWriteMask = 1;
+        desc.DepthStencilState.DepthFunc = 4;
+        desc.DepthStencilState.StencilEnable = 0;
+        desc.DepthStencilState.StencilReadMask = 0xFF;
+        desc.DepthStencilState.StencilWriteMask = 0xFF;
+        desc.DepthStencilState.FrontFace = { 1, 1, 1, 8 };
+        desc.DepthStencilState.BackFace = { 1, 1, 1, 8 };
+    }
+
+    // Points the desc back at this source's own buffers after any of them changed
+    void Refresh()
+    {
+        Desc.VS = { VS.data(), VS.size() };
+        Desc.PS = { PS.data(), PS.size() };
+        for (size_t i = 0; i != Elements.size(); ++i)
+            Elements[i].SemanticName = Semantics[i].c_str();
+        Desc.InputLayout = { Elements.data(), (uint32_t)Elements.size() };
+    }
+
+    uint64_t GetKey(uint64_t rootSignatureHash = 0x1234) const { return Muon::HashGraphicsPipelineDesc(Desc, rootSignatureHash); }
+};
+
+bool WriteFile(std::filesystem::path const& path, const uint8_t* pData, size_t size)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write((const char*)pData, size);
+    return file.good();
+}
+
+// Loads what's at path into a record that starts out filled with a marker, so a refusal that still wrote to it shows
+Renderer::ReflectionResult LoadMarked(std::filesystem::path const& path, std::vector<uint8_t> const& bytecode, bool& out_touched)
+{
+    Renderer::ShaderReflectionRecord record;
+    memset(&record, 0xAB, sizeof(record));
+    const Renderer::ReflectionResult result = Renderer::LoadReflectionRecord(path, bytecode.data(), bytecode.size(), &record);
+
+    Renderer::ShaderReflectionRecord marker;
+    memset(&marker, 0xAB, sizeof(marker));
+    out_touched = memcmp(&record, &marker, sizeof(record)) != 0;
+    return result;
+}
+
+struct GraphAccess
+{
+    Renderer::RGResource Resource;
+    Renderer::RGState    State;
+    bool                 IsWrite;
+};
+
+// Follows a graph's execution the way a command list would: the state each barrier leaves a resource in,
+// which passes ran, and the batches in front of each. Errors keep the first thing that went wrong.
+struct GraphRecorder
+{
+    std::vector<Renderer::RGState>        States;
+    std::vector<std::vector<GraphAccess>> Accesses;   // Per pass, as declared
+    std::vector<uint32_t>                 BatchBefore; // Barriers in the batch right before each pass that ran
+    std::vector<Renderer::RGPass>         Executed;
+    uint32_t                              Batches = 0;
+    uint32_t                              Barriers = 0;
+    uint32_t                              PendingBatch = 0;
+    bool                                  BatchSincePass = false;
+    std::string                           Error;
+
+    void SetError(std::string const& error)
+    {
+        if (Error.empty())
+            Error = error;
+    }
+
+    void OnBarriers(Renderer::RenderGraph const& graph, Renderer::RGBarrier const* pBarriers, uint32_t count)
+    {
+        if (BatchSincePass)
+            SetError("Two barrier batches went in with no pass between them");
+
+        BatchSincePass = true;
+        PendingBatch = count;
+        Batches++;
+        Barriers += count;
+
+        for (uint32_t i = 0; i != count; ++i)
+        {
+            Renderer::RGBarrier const& barrier = pBarriers[i];
+            for (uint32_t j = 0; j != i; ++j)
+                if (pBarriers[j].Resource == barrier.Resource)
+                    SetError(std::string("One batch transitioned ") + graph.GetResourceName(barrier.Resource) + " twice");
+
+            if (barrier.Before != States[barrier.Resource])
+                SetError(std::string("A barrier took ") + graph.GetResourceName(barrier.Resource) + " from " +
+                    Renderer::RenderGraph::GetStateName(barrier.Before) + " but it was in " +
+                    Renderer::RenderGraph::GetStateName(States[barrier.Resource]));
+
+            States[barrier.Resource] = barrier.After;
+        }
+    }
+
+    void OnPass(Renderer::RenderGraph const& graph, Renderer::RGPass pass)
+    {
+        for (GraphAccess const& access : Accesses[pass])
+            if (States[access.Resource] != access.State)
+                SetError(std::string(graph.GetPassName(pass)) + " ran with " + graph.GetResourceName(access.Resource) + " in " +
+                    Renderer::RenderGraph::GetStateName(States[access.Resource]) + " instead of " +
+                    Renderer::RenderGraph::GetStateName(access.State));
+
+        Executed.push_back(pass);
+        BatchBefore[pass] = PendingBatch;
+        PendingBatch = 0;
+        BatchSincePass = false;
+    }
+
+    // States has to hold where each resource starts out first
+    void Execute(Renderer::RenderGraph const& graph)
+    {
+        graph.Execute(this, [this, &graph](Renderer::RGBarrier const* pBarriers, uint32_t count, void*)
+        {
+            OnBarriers(graph, pBarriers, count);
+        });
+    }
+};
+
+// Declares a pass whose execution checks that every resource it touches arrived in the state it asked for
+Renderer::RGPass AddCheckedPass(Renderer::RenderGraph& graph, GraphRecorder& recorder, const char* name,
+    std::initializer_list<GraphAccess> accesses, bool hasSideEffects = false)
+{
+    const Renderer::RGPass pass = (Renderer::RGPass)recorder.Accesses.size();
+    Renderer::RenderGraph const* pGraph = &graph;
+    graph.AddPass(name, [pGraph, pass](void* pContext) { ((GraphRecorder*)pContext)->OnPass(*pGraph, pass); }, hasSideEffects);
+
+    for (GraphAccess const& access : accesses)
+    {
+        if (access.IsWrite)
+            graph.Write(pass, access.Resource, access.State);
+        else
+            graph.Read(pass, access.Resource, access.State);
+    }
+
+    recorder.Accesses.push_back(accesses);
+    recorder.BatchBefore.push_back(0);
+    return pass;
+}
+
+// Every transient placed on the 64KB grid, at least as big as its texture, inside its heap, and clear of every
+// other transient in the same heap that's alive at the same time. Lifetimes come from the passes that weren't culled.
+bool CheckPlacements(Renderer::RenderGraph const& graph, GraphRecorder const& recorder, uint32_t resourceCount,
+    std::vector<Renderer::RGTextureDesc> const& descs, std::string& out_error)
+{
+    using namespace Renderer;
+
+    std::vector<uint32_t> firstUse(resourceCount, ~0u);
+    std::vector<uint32_t> lastUse(resourceCount, 0);
+    for (RGPass p = 0; p != (RGPass)recorder.Accesses.size(); ++p)
+    {
+        if (graph.IsPassCulled(p))
+            continue;
+
+        for (GraphAccess const& access : recorder.Accesses[p])
+        {
+            firstUse[access.Resource] = std::min<uint32_t>(firstUse[access.Resource], p);
+            lastUse[access.Resource] = p;
+        }
+    }
+
+    RGStats const& stats = graph.GetStats();
+    for (RGResource a = 0; a != resourceCount; ++a)
+    {
+        if (graph.IsImported(a) || firstUse[a] == ~0u)
+            continue;
+
+        RGPlacement const& placement = graph.GetPlacement(a);
+        if (placement.Offset % RenderGraph::kPlacementAlignment || placement.Size < RenderGraph::GetTextureSize(descs[a]) ||
+            placement.Offset + placement.Size > stats.HeapBytes[(uint8_t)placement.HeapClass])
+        {
+            out_error = std::string(graph.GetResourceName(a)) + " was placed off the grid, too small or outside its heap";
+            return false;
+        }
+
+        for (RGResource b = 0; b != a; ++b)
+        {
+            if (graph.IsImported(b) || firstUse[b] == ~0u)
+                continue;
+
+            RGPlacement const& other = graph.GetPlacement(b);
+            const bool alive = firstUse[a] <= lastUse[b] && firstUse[b] <= lastUse[a];
+            const bool shared = placement.Offset < other.Offset + other.Size && other.Offset < placement.Offset + placement.Size;
+            if (alive && shared && placement.HeapClass == other.HeapClass)
+            {
+                out_error = std::string(graph.GetResourceName(a)) + " shares memory with " + graph.GetResourceName(b) + " while both are alive";
+                return false;
+            }
+        }
+    }
+
+    uint64_t heapBytes = 0;
+    for (uint64_t bytes : stats.HeapBytes)
+        heapBytes += bytes;
+    if (heapBytes != stats.AliasedBytes)
+    {
+        out_error = "The aliased size isn't the sum of the heaps";
+        return false;
+    }
+
+    return true;
+}
+
+}
+
+int Allocators()
+{
+    using namespace Memory;
+
+    const uint32_t corruptionBefore = GetCorruptionCount();
+
+    if (!CheckSmallPool(1, 1) || !CheckSmallPool(4, 4) || !CheckSmallPool(sizeof(void*), 8))
+        return Fail("A pool with elements smaller than a pointer lost track of its blocks");
+    if (GetCorruptionCount() != corruptionBefore)
+        return Fail("A pool with elements smaller than a pointer reported corruption that wasn't there");
+
+#if MN_MEMORY_GUARDS
+    // Every one of these is on purpose, so they're counted instead of asserting
+    SetAssertOnCorruption(false);
+
+    LinearArena guardedArena;
+    guardedArena.Init(4096, MemoryTag::GENERAL);
+    {
+        ScratchScope scope(guardedArena);
+        uint8_t* pBytes = scope.AllocArray<uint8_t>(24);
+        pBytes[24] = 0;
+        if (guardedArena.CheckGuards())
+            return Fail("A linear arena didn't see a write one past the end of an allocation");
+    }
+    if (GetCorruptionCount() != corruptionBefore + 1)
+        return Fail("Rewinding a scratch scope over an overrun didn't report it");
+    guardedArena.Destroy();
+
+    PoolAllocator guardedPool;
+    guardedPool.Init(24, 8, MemoryTag::GENERAL);
+    uint8_t* pBlock = static_cast<uint8_t*>(guardedPool.Alloc());
+    pBlock[24] = 0;
+    if (guardedPool.CheckGuards())
+        return Fail("A pool didn't see a write one past the end of a block");
+    guardedPool.Free(pBlock);
+    if (GetCorruptionCount() != corruptionBefore + 2)
+        return Fail("Freeing an overrun pool block didn't report it");
+
+    void* pFreed = guardedPool.Alloc();
+    guardedPool.Free(pFreed);
+    guardedPool.Free(pFreed);
+    if (GetCorruptionCount() != corruptionBefore + 3)
+        return Fail("Freeing a pool block twice didn't report it");
+
+    // The second free must not have put it on the free list again
+    void* pFirst = guardedPool.Alloc();
+    void* pSecond = guardedPool.Alloc();
+    if (!pFirst || pFirst == pSecond || guardedPool.GetLiveCount() != 2)
+        return Fail("A double free handed the same pool block out twice");
+    guardedPool.Free(pFirst);
+    guardedPool.Free(pSecond);
+    guardedPool.Destroy();
+
+    SetAssertOnCorruption(true);
+#else
+    printf("Memory guards are off in this build (they need MN_DEBUG), so overruns and double frees weren't provoked\n");
+#endif
+
+    // Leaves one block live, which the leak report has to name
+    const TagStats general = GetTagStats(MemoryTag::GENERAL);
+    {
+        PoolAllocator pool;
+        pool.Init(64, 4, MemoryTag::GENERAL);
+        void* pLeaked = pool.Alloc();
+
+        printf("Leaving one General block live on purpose:\n");
+        fflush(stdout);
+        const uint32_t leakingTags = ReportLeaks();
+        if (!leakingTags || GetTagStats(MemoryTag::GENERAL).LiveAllocations != general.LiveAllocations + 1)
+            return Fail("The leak report missed a live block");
+
+        pool.Free(pLeaked);
+        if (GetTagStats(MemoryTag::GENERAL).LiveAllocations != general.LiveAllocations)
+            return Fail("Freeing the leaked block didn't take it out of the report");
+    }
+
+    // The same mix of sizes through each, a batch at a time, every block touched so none are optimized away
+    const uint32_t kBatch = 1024;
+    const uint32_t kRounds = 1000;
+    const size_t   kPoolSize = 256;
+
+    std::vector<size_t> sizes(kBatch);
+    for (uint32_t i = 0; i != kBatch; ++i)
+        sizes[i] = 16 + (i * 37) % 241;
+
+    std::vector<uint8_t*> blocks(kBatch);
+    uint64_t touched = 0;
+    auto touch = [&blocks, &touched]()
+    {
+        for (uint8_t* pBlock : blocks)
+            touched += *pBlock;
+    };
+
+    uint64_t start = Core::SystemClock::Get().GetCounter();
+    for (uint32_t round = 0; round != kRounds; ++round)
+    {
+        for (uint32_t i = 0; i != kBatch; ++i)
+        {
+            blocks[i] = static_cast<uint8_t*>(malloc(sizes[i]));
+            *blocks[i] = (uint8_t)i;
+        }
+        touch();
+        for (uint8_t* pBlock : blocks)
+            free(pBlock);
+    }
+    const double mallocMs = MsSince(start);
+
+    LinearArena arena;
+    arena.Init(kBatch * (kPoolSize + 64), MemoryTag::GENERAL);
+    start = Core::SystemClock::Get().GetCounter();
+    for (uint32_t round = 0; round != kRounds; ++round)
+    {
+        for (uint32_t i = 0; i != kBatch; ++i)
+        {
+            blocks[i] = static_cast<uint8_t*>(arena.Alloc(sizes[i]));
+            *blocks[i] = (uint8_t)i;
+        }
+        touch();
+        arena.Reset();
+    }
+    const double arenaMs = MsSince(start);
+
+    start = Core::SystemClock::Get().GetCounter();
+    for (uint32_t round = 0; round != kRounds; ++round)
+    {
+        ScratchScope scope(arena);
+        for (uint32_t i = 0; i != kBatch; ++i)
+        {
+            blocks[i] = static_cast<uint8_t*>(scope.Alloc(sizes[i]));
+            *blocks[i] = (uint8_t)i;
+        }
+        touch();
+    }
+    const double scratchMs = MsSince(start);
+    arena.Destroy();
+
+    start = Core::SystemClock::Get().GetCounter();
+    for (uint32_t round = 0; round != kRounds; ++round)
+    {
+        for (uint32_t i = 0; i != kBatch; ++i)
+        {
+            blocks[i] = static_cast<uint8_t*>(malloc(kPoolSize));
+            *blocks[i] = (uint8_t)i;
+        }
+        touch();
+        for (uint8_t* pBlock : blocks)
+            free(pBlock);
+    }
+    const double mallocFixedMs = MsSince(start);
+
+    PoolAllocator pool;
+    pool.Init(kPoolSize, kBatch, MemoryTag::GENERAL);
+    start = Core::SystemClock::Get().GetCounter();
+    for (uint32_t round = 0; round != kRounds; ++round)
+    {
+        for (uint32_t i = 0; i != kBatch; ++i)
+        {
+            blocks[i] = static_cast<uint8_t*>(pool.Alloc());
+            *blocks[i] = (uint8_t)i;
+        }
+        touch();
+        for (uint8_t* pBlock : blocks)
+            pool.Free(pBlock);
+    }
+    const double poolMs = MsSince(start);
+    pool.Destroy();
+
+    if (GetTagStats(MemoryTag::GENERAL).LiveAllocations != general.LiveAllocations)
+        return Fail("Timing the allocators left blocks live");
+
+    const double ops = (double)kBatch * kRounds;
+    auto row = [ops](const char* name, double ms, double baselineMs)
+    {
+        printf("%-32s %10.2f %10.2f %9.2fx\n", name, ms, ms * 1e6 / ops, ms > 0.0 ? baselineMs / ms : 0.0);
+    };
+
+    printf("Allocator checks passed (timing checksum %llx)\n", (unsigned long long)touched);
+    printf("%-32s %10s %10s %10s\n", "Alloc and free, 16-256 bytes", "ms", "ns/alloc", "vs malloc");
+    row("malloc/free", mallocMs, mallocMs);
+    row("LinearArena, reset per batch", arenaMs, mallocMs);
+    row("ScratchScope per batch", scratchMs, mallocMs);
+    printf("%-32s\n", "Alloc and free, 256 bytes");
+    row("malloc/free", mallocFixedMs, mallocFixedMs);
+    row("PoolAllocator", poolMs, mallocFixedMs);
+    return EXIT_SUCCESS;
+}
+
+int Descriptors()
+{
+    using Muon::DescriptorRange;
+
+    // Free list: [100, 164) carved up front to back
+    Muon::DescriptorFreeList list;
+    list.Init(100, 64);
+
+    const DescriptorRange a = list.Allocate(8);
+    const DescriptorRange b = list.Allocate(4);
+    const DescriptorRange c = list.Allocate(16);
+    const DescriptorRange d = list.Allocate(8);
+    if (!IsRange(a, 100, 8) || !IsRange(b, 108, 4) || !IsRange(c, 112, 16) || !IsRange(d, 128, 8))
+        return Fail("The descriptor free list didn't carve a fresh heap front to back");
+
+    // d runs into the free tail, so it merges into it and b stays on its own
+    list.Free(b);
+    list.Free(d);
+    if (list.GetStats().FreeBlockCount != 2 || list.GetStats().LargestFreeBlock != 36)
+        return Fail("Freeing next to a free block didn't coalesce (%u blocks, largest %u)", list.GetStats().FreeBlockCount, list.GetStats().LargestFreeBlock);
+
+    // The four slot hole fits exactly, so best fit has to take it over the bigger block after it
+    const DescriptorRange exact = list.Allocate(4);
+    if (!IsRange(exact, 108, 4))
+        return Fail("Best fit took [%u, +%u) over the exact fit at 108", exact.Offset, exact.Count);
+    list.Free(exact);
+
+    // c has free blocks on both sides, so all three become one
+    list.Free(c);
+    if (list.GetStats().FreeBlockCount != 1 || list.GetStats().LargestFreeBlock != 56 || list.GetStats().Allocated != 8)
+        return Fail("Freeing between two free blocks didn't merge all three (%u blocks, largest %u)", list.GetStats().FreeBlockCount, list.GetStats().LargestFreeBlock);
+
+    // Holes of 10 and 6 with a 38 block after them: 5 fits best in the 6
+    const DescriptorRange ten = list.Allocate(10);
+    const DescriptorRange pin0 = list.Allocate(1);
+    const DescriptorRange six = list.Allocate(6);
+    const DescriptorRange pin1 = list.Allocate(1);
+    list.Free(ten);
+    list.Free(six);
+    const DescriptorRange five = list.Allocate(5);
+    if (!IsRange(five, six.Offset, 5))
+        return Fail("Best fit put 5 descriptors at %u instead of the 6 slot hole at %u", five.Offset, six.Offset);
+
+    const uint32_t failedBefore = (uint32_t)list.GetStats().FailedAllocations;
+    if (list.Allocate(list.GetStats().LargestFreeBlock + 1).IsValid() || list.GetStats().FailedAllocations != failedBefore + 1)
+        return Fail("The free list handed out more than its largest free block");
+
+    list.Free(five);
+    list.Free(pin0);
+    list.Free(pin1);
+    list.Free(a);
+    if (list.GetStats().Allocated != 0 || list.GetStats().FreeBlockCount != 1 || list.GetStats().LargestFreeBlock != 64)
+        return Fail("Freeing everything didn't leave the free list as one block");
+
+    // Ring: [1000, 1016), so a few frames of six fill it
+    Muon::DescriptorRing ring;
+    ring.Init(1000, 16);
+
+    const DescriptorRange frame1 = ring.Allocate(6);
+    ring.EndFrame(1);
+    const DescriptorRange frame2 = ring.Allocate(6);
+    ring.EndFrame(2);
+    if (!IsRange(frame1, 1000, 6) || !IsRange(frame2, 1006, 6))
+        return Fail("The descriptor ring didn't hand out consecutive ranges");
+
+    // Four left before the end and nothing retired to wrap into
+    if (ring.Allocate(6).IsValid())
+        return Fail("The ring wrapped over a frame the GPU hadn't finished");
+
+    ring.Retire(1);
+    const DescriptorRange wrapped = ring.Allocate(6);
+    if (!IsRange(wrapped, 1000, 6) || ring.GetWastedAtWrap() != 4 || ring.GetStats().Allocated != 16)
+        return Fail("The ring didn't wrap into the retired frame (got [%u, +%u), %u wasted)", wrapped.Offset, wrapped.Count, ring.GetWastedAtWrap());
+    ring.EndFrame(3);
+
+    ring.Retire(1);
+    if (ring.Allocate(1).IsValid())
+        return Fail("The ring handed out a slot while full");
+
+    // Frame 2 done frees its six, frame 3 stays live
+    ring.Retire(2);
+    const DescriptorRange frame4 = ring.Allocate(6);
+    ring.EndFrame(4);
+    if (!IsRange(frame4, 1006, 6) || ring.GetStats().Allocated != 16)
+        return Fail("The ring didn't reuse frame 2's slots once its fence passed");
+
+    ring.Retire(3);
+    if (ring.GetStats().Allocated != 6)
+        return Fail("Retiring fence 3 freed %u slots, only frames up to 3 should go", 16 - ring.GetStats().Allocated);
+    ring.Retire(4);
+    if (ring.GetStats().Allocated != 0 || ring.GetStats().LargestFreeBlock != 16)
+        return Fail("Retiring every fence didn't empty the ring");
+
+    // An empty frame queued while the ring is empty mustn't move the tail once the ring has started over
+    ring.Init(1000, 16);
+    ring.Allocate(5);
+    ring.EndFrame(1);
+    ring.Retire(1);
+    ring.EndFrame(2);
+    const DescriptorRange afterEmpty = ring.Allocate(14);
+    ring.EndFrame(3);
+    ring.Retire(2);
+    if (!IsRange(afterEmpty, 1000, 14))
+        return Fail("The emptied ring didn't start over at its base (got [%u, +%u))", afterEmpty.Offset, afterEmpty.Count);
+    const DescriptorRange overlapping = ring.Allocate(3);
+    if (overlapping.IsValid())
+        return Fail("Retiring an empty frame handed out [%u, +%u), which frame 3 still holds", overlapping.Offset, overlapping.Count);
+    ring.Retire(3);
+    if (ring.GetStats().Allocated != 0)
+        return Fail("Retiring past an empty frame left %u slots allocated", ring.GetStats().Allocated);
+
+    // Random churn, checked against a fake heap then timed again without one
+    const uint32_t kListCapacity = 4096;
+    const uint32_t kListOps = 200000;
+
+    FakeHeap listHeap(0, kListCapacity);
+    list.Init(0, kListCapacity);
+    if (!ChurnFreeList(list, &listHeap, kListOps))
+        return EXIT_FAILURE;
+
+    Muon::DescriptorAllocatorStats const listStats = list.GetStats();
+    if (listStats.Allocated != listHeap.CountOwned() || listStats.LargestFreeBlock != listHeap.GetLargestFreeRun())
+        return Fail("The free list's stats disagree with the heap (%u allocated vs %u, largest free %u vs %u)",
+            listStats.Allocated, listHeap.CountOwned(), listStats.LargestFreeBlock, listHeap.GetLargestFreeRun());
+
+    list.Init(0, kListCapacity);
+    uint64_t start = Core::SystemClock::Get().GetCounter();
+    ChurnFreeList(list, nullptr, kListOps);
+    const double listMs = MsSince(start);
+
+    const uint32_t kRingCapacity = 4096;
+    const uint32_t kRingFrames = 20000;
+
+    FakeHeap ringHeap(0, kRingCapacity);
+    ring.Init(0, kRingCapacity);
+    if (!ChurnRing(ring, &ringHeap, kRingFrames))
+        return EXIT_FAILURE;
+
+    Muon::DescriptorAllocatorStats const ringStats = ring.GetStats();
+    const uint32_t ringWasted = ring.GetWastedAtWrap();
+    ring.Init(0, kRingCapacity);
+    start = Core::SystemClock::Get().GetCounter();
+    ChurnRing(ring, nullptr, kRingFrames);
+    const double ringMs = MsSince(start);
+
+    auto perSecond = [](uint32_t n, double ms) { return ms > 0.0 ? n / ms * 1000.0 : 0.0; };
+    printf("Descriptor allocator checks passed\n");
+    printf("Free list: %llu allocations and %llu frees, %.1f M/s; %u of %u free in %u blocks, largest %u (%.1f%% fragmented), %llu failed\n",
+        (unsigned long long)listStats.TotalAllocations, (unsigned long long)listStats.TotalFrees,
+        perSecond((uint32_t)(listStats.TotalAllocations + listStats.TotalFrees), listMs) / 1e6, listStats.Capacity - listStats.Allocated,
+        listStats.Capacity, listStats.FreeBlockCount, listStats.LargestFreeBlock, listStats.GetFragmentation() * 100.0f,
+        (unsigned long long)listStats.FailedAllocations);
+    printf("Ring: %llu allocations over %u frames, %.1f M/s; high water %u of %u, %u wasted at wraps, %llu failed\n",
+        (unsigned long long)ringStats.TotalAllocations, kRingFrames, perSecond((uint32_t)ringStats.TotalAllocations, ringMs) / 1e6,
+        ringStats.HighWater, kRingCapacity, ringWasted, (unsigned long long)ringStats.FailedAllocations);
+    return EXIT_SUCCESS;
+}
+
+int PipelineKeys()
+{
+    const PipelineDescSource base;
+    const uint64_t baseKey = base.GetKey();
+
+    // Everything copied into new memory, so only contents can make the keys match
+    const PipelineDescSource same(base);
+    if (same.GetKey() != baseKey)
+        return Fail("Two identical pipeline descs in different memory got different keys");
+
+    // Garbage in the padding after the blend and stencil masks mustn't split the key
+    PipelineDescSource dirtyPadding(base);
+    memset(&dirtyPadding.Desc.BlendState, 0xCD, sizeof(dirtyPadding.Desc.BlendState));
+    memset(&dirtyPadding.Desc.DepthStencilState, 0xCD, sizeof(dirtyPadding.Desc.DepthStencilState));
+    PipelineDescSource::SetStates(dirtyPadding.Desc);
+    if (dirtyPadding.GetKey() != baseKey)
+        return Fail("Two pipeline descs differing only in padding got different keys");
+
+    // Formats past NumRenderTargets aren't used, so they mustn't split the key
+    PipelineDescSource unusedTarget(base);
+    unusedTarget.Desc.RTVFormats[3] = 87;
+    if (unusedTarget.GetKey() != baseKey)
+        return Fail("A render target format past NumRenderTargets changed the pipeline key");
+
+    struct Variant
+    {
+        const char* Field;
+        void (*Change)(PipelineDescSource&);
+    };
+
+    const Variant variants[] =
+    {
+        { "a byte of VS",           [](PipelineDescSource& s) { s.VS[17] ^= 1; } },
+        { "PS length",              [](PipelineDescSource& s) { s.PS.pop_back(); } },
+        { "a DS",                   [](PipelineDescSource& s) { s.Desc.DS = { s.PS.data(), 4 }; } },
+        { "a semantic name",        [](PipelineDescSource& s) { s.Semantics[1] = "NORMAM"; } },
+        { "semantic names split",   [](PipelineDescSource& s) { s.Semantics[0] = "POSITIONN"; s.Semantics[1] = "ORMAL"; } },
+        { "a semantic index",       [](PipelineDescSource& s) { s.Elements[2].SemanticIndex = 1; } },
+        { "an element format",      [](PipelineDescSource& s) { s.Elements[1].Format = 2; } },
+        { "an element offset",      [](PipelineDescSource& s) { s.Elements[2].AlignedByteOffset = 28; } },
+        { "an element step rate",   [](PipelineDescSource& s) { s.Elements[2].InputSlotClass = 1; s.Elements[2].InstanceDataStepRate = 1; } },
+        { "one fewer element",      [](PipelineDescSource& s) { s.Elements.pop_back(); } },
+        { "blend op",               [](PipelineDescSource& s) { s.Desc.BlendState.RenderTarget[0].BlendOp = 2; } },
+        { "write mask",             [](PipelineDescSource& s) { s.Desc.BlendState.RenderTarget[0].RenderTargetWriteMask = 0x7; } },
+        { "sample mask",            [](PipelineDescSource& s) { s.Desc.SampleMask = 1; } },
+        { "cull mode",              [](PipelineDescSource& s) { s.Desc.RasterizerState.CullMode = 1; } },
+        { "depth bias",             [](PipelineDescSource& s) { s.Desc.RasterizerState.SlopeScaledDepthBias = 1.0f; } },
+        { "depth func",             [](PipelineDescSource& s) { s.Desc.DepthStencilState.DepthFunc = 2; } },
+        { "stencil write mask",     [](PipelineDescSource& s) { s.Desc.DepthStencilState.StencilWriteMask = 0x0F; } },
+        { "back face stencil op",   [](PipelineDescSource& s) { s.Desc.DepthStencilState.BackFace.StencilPassOp = 3; } },
+        { "strip cut",              [](PipelineDescSource& s) { s.Desc.IBStripCutValue = 1; } },
+        { "topology",               [](PipelineDescSource& s) { s.Desc.PrimitiveTopologyType = 2; } },
+        { "render target count",    [](PipelineDescSource& s) { s.Desc.NumRenderTargets = 2; } },
+        { "render target format",   [](PipelineDescSource& s) { s.Desc.RTVFormats[0] = 29; } },
+        { "depth format",           [](PipelineDescSource& s) { s.Desc.DSVFormat = 20; } },
+        { "sample count",           [](PipelineDescSource& s) { s.Desc.SampleDesc.Count = 4; } },
+        { "flags",                  [](PipelineDescSource& s) { s.Desc.Flags = 1; } },
+    };
+    const uint32_t kVariantCount = (uint32_t)(sizeof(variants) / sizeof(variants[0]));
+
+    // Every variant differs from the base and from every other, and a different root signature on its own does too
+    std::vector<uint64_t> keys = { baseKey, base.GetKey(0x5678) };
+    std::vector<const char*> fields = { "nothing", "the root signature" };
+    for (Variant const& variant : variants)
+    {
+        PipelineDescSource changed(base);
+        variant.Change(changed);
+        changed.Refresh();
+        keys.push_back(changed.GetKey());
+        fields.push_back(variant.Field);
+    }
+    for (size_t i = 0; i != keys.size(); ++i)
+    {
+        for (size_t j = i + 1; j != keys.size(); ++j)
+        {
+            if (keys[i] == keys[j])
+                return Fail("Pipeline descs differing in %s and in %s got the same key %016llx", fields[i], fields[j], (unsigned long long)keys[i]);
+        }
+    }
+
+    Muon::PipelineKeyTable table;
+    const Muon::PipelineKeyTable::Result first = table.FindOrAdd(baseKey);
+    const Muon::PipelineKeyTable::Result second = table.FindOrAdd(same.GetKey());
+    if (!first.Inserted || second.Inserted || first.Index != second.Index)
+        return Fail("Identical pipeline descs didn't share one slot");
+
+    // Every worker asking for every key over and over, and exactly one of them told to build each
+    const uint32_t kJobs = 256;
+    const uint32_t kRequestsPerJob = 512;
+    std::vector<std::atomic<uint32_t>> inserts(keys.size());
+    std::vector<std::atomic<uint32_t>> slots(keys.size());
+    for (size_t i = 0; i != keys.size(); ++i)
+    {
+        inserts[i] = 0;
+        slots[i] = Muon::PipelineKeyTable::kNoSlot;
+    }
+    std::atomic<uint32_t> mismatches(0);
+
+    table.Clear();
+    Core::JobCounter counter;
+    Core::JobSystem::Dispatch(counter, kJobs, 1, [&](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t job = begin; job != end; ++job)
+        {
+            for (uint32_t r = 0; r != kRequestsPerJob; ++r)
+            {
+                const size_t k = (job * 7 + r * 13) % keys.size();
+                const Muon::PipelineKeyTable::Result result = table.FindOrAdd(keys[k]);
+                if (result.Inserted)
+                    inserts[k]++;
+
+                uint32_t expected = Muon::PipelineKeyTable::kNoSlot;
+                if (!slots[k].compare_exchange_strong(expected, result.Index) && expected != result.Index)
+                    mismatches++;
+            }
+        }
+    });
+    Core::JobSystem::Wait(counter);
+
+    const Muon::PipelineKeyTableStats stats = table.GetStats();
+    for (size_t i = 0; i != keys.size(); ++i)
+    {
+        if (inserts[i] != 1)
+            return Fail("Concurrent requests for the key of %s were told to build it %u times", fields[i], inserts[i].load());
+    }
+    if (mismatches || stats.Unique != keys.size() || stats.Requests != (uint64_t)kJobs * kRequestsPerJob || stats.Hits != stats.Requests - keys.size())
+        return Fail("Concurrent requests made %u entries for %u keys, %u saw a different slot", stats.Unique, (uint32_t)keys.size(), mismatches.load());
+
+    // Full: new keys are turned away without taking a slot, old ones still found
+    Muon::PipelineKeyTable small;
+    small.SetCapacity(4);
+    for (uint32_t i = 0; i != 4; ++i)
+        small.FindOrAdd(keys[i]);
+    if (small.FindOrAdd(keys[4]).Index != Muon::PipelineKeyTable::kNoSlot || small.FindOrAdd(keys[4]).Index != Muon::PipelineKeyTable::kNoSlot)
+        return Fail("A full pipeline key table handed out a slot");
+
+    uint32_t index = 0;
+    const Muon::PipelineKeyTable::Result old = small.FindOrAdd(keys[2]);
+    if (small.GetStats().Unique != 4 || small.GetStats().Rejected != 2 || small.Find(keys[4], index) || old.Inserted || old.Index != 2)
+        return Fail("A full pipeline key table kept a key it turned away, or lost one it had");
+
+    printf("Pipeline key checks passed: %u descs one field apart, %u requests from %u jobs on %u workers made %u entries\n",
+        kVariantCount, (uint32_t)stats.Requests, kJobs, Core::JobSystem::GetWorkerCount(), stats.Unique);
+    return EXIT_SUCCESS;
+}
+
+int ReflectionRecords()
+{
+    using Renderer::ReflectionResult;
+
+    for (uint8_t semantic = 0; semantic != Renderer::kReflectedSemanticCount; ++semantic)
+    {
+        for (bool instanced : { false, true })
+        {
+            uint8_t found = 0xFF;
+            bool foundInstanced = !instanced;
+            if (!Renderer::FindSemantic(Renderer::GetSemanticName(semantic, instanced), &found, &foundInstanced) || found != semantic || foundInstanced != instanced)
+                return Fail("Semantic %s didn't map back to itself", Renderer::GetSemanticName(semantic, instanced));
+        }
+    }
+
+    std::vector<uint8_t> bytecode(1200);
+    for (size_t i = 0; i != bytecode.size(); ++i)
+        bytecode[i] = (uint8_t)(i * 31 + 7);
+
+    // Position, normal and UV per vertex, then a world matrix per instance
+    Renderer::ShaderReflectionRecord record = {};
+    record.BytecodeHash = Renderer::HashShaderBytecode(bytecode.data(), bytecode.size());
+    record.BytecodeSize = (uint32_t)bytecode.size();
+    record.Inputs[0] = { 0, 0, (uint8_t)Renderer::ReflectedComponentType::FLOAT32, 3, 0 };
+    record.Inputs[1] = { 1, 0, (uint8_t)Renderer::ReflectedComponentType::FLOAT32, 3, 12 };
+    record.Inputs[2] = { 2, 0, (uint8_t)Renderer::ReflectedComponentType::FLOAT32, 2, 24 };
+    for (uint8_t row = 0; row != 4; ++row)
+        record.Inputs[3 + row] = { 8, row, (uint8_t)Renderer::ReflectedComponentType::FLOAT32, 4, (uint16_t)(row * 16) };
+    record.InputCount = 7;
+    record.InstanceStart = 3;
+    record.VertexByteSize = 32;
+    record.InstanceByteSize = 64;
+    record.CBuffers[0] = { fnv1a("PerFrame"), 0, 1, 0 };
+    record.CBuffers[1] = { fnv1a("PerMaterial"), 1, 1, 0 };
+    record.CBufferCount = 2;
+    record.Textures[0] = { fnv1a("diffuseTexture"), 0, 1, 0 };
+    record.TextureCount = 1;
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "MuonCheck.refl";
+    if (!Renderer::SaveReflectionRecord(path, record))
+        return Fail("Couldn't write '%s'", path.string().c_str());
+
+    std::vector<uint8_t> good;
+    Renderer::SerializeReflectionRecord(record, good);
+
+    // Everything has to come back, checked by writing out what was read and comparing bytes
+    Renderer::ShaderReflectionRecord loaded = {};
+    ReflectionResult result = Renderer::LoadReflectionRecord(path, bytecode.data(), bytecode.size(), &loaded);
+    std::vector<uint8_t> reloaded;
+    Renderer::SerializeReflectionRecord(loaded, reloaded);
+    if (result != ReflectionResult::OK || reloaded != good)
+        return Fail("A good reflection record came back %s or changed", Renderer::GetReflectionResultString(result));
+
+    struct Damage
+    {
+        const char*      What;
+        ReflectionResult Expected;
+        void (*Apply)(std::vector<uint8_t>& bytes, std::vector<uint8_t>& bytecode);
+    };
+
+    // Offsets are into the 32 byte header: magic at 0, version at 4, input count at 6, bytecode hash at 8
+    const Damage damages[] =
+    {
+        { "a wrong magic",               ReflectionResult::BAD_HEADER, [](std::vector<uint8_t>& b, std::vector<uint8_t>&) { b[0] ^= 0xFF; } },
+        { "a newer version",             ReflectionResult::BAD_HEADER, [](std::vector<uint8_t>& b, std::vector<uint8_t>&) { b[4]++; } },
+        { "a missing checksum byte",     ReflectionResult::CORRUPT,    [](std::vector<uint8_t>& b, std::vector<uint8_t>&) { b.pop_back(); } },
+        { "half its bindings",           ReflectionResult::CORRUPT,    [](std::vector<uint8_t>& b, std::vector<uint8_t>&) { b.resize(b.size() - 12); } },
+        { "only part of a header",       ReflectionResult::CORRUPT,    [](std::vector<uint8_t>& b, std::vector<uint8_t>&) { b.resize(20); } },
+        { "nothing in it",               ReflectionResult::CORRUPT,    [](std::vector<uint8_t>& b, std::vector<uint8_t>&) { b.clear(); } },
+        { "a trailing byte",             ReflectionResult::CORRUPT,    [](std::vector<uint8_t>& b, std::vector<uint8_t>&) { b.push_back(0); } },
+        { "an input offset flipped",     ReflectionResult::CORRUPT,    [](std::vector<uint8_t>& b, std::vector<uint8_t>&) { b[32 + 6 + 4] ^= 0x04; } },
+        { "a binding slot flipped",      ReflectionResult::CORRUPT,    [](std::vector<uint8_t>& b, std::vector<uint8_t>&) { b[b.size() - 8 - 4] ^= 0x01; } },
+        { "its checksum flipped",        ReflectionResult::CORRUPT,    [](std::vector<uint8_t>& b, std::vector<uint8_t>&) { b.back() ^= 0x80; } },
+        { "the bytecode hash flipped",   ReflectionResult::CORRUPT,    [](std::vector<uint8_t>& b, std::vector<uint8_t>&) { b[8] ^= 0x01; } },
+        { "bytecode recompiled",         ReflectionResult::STALE,      [](std::vector<uint8_t>&, std::vector<uint8_t>& c) { c[600] ^= 0x01; } },
+        { "bytecode grown",              ReflectionResult::STALE,      [](std::vector<uint8_t>&, std::vector<uint8_t>& c) { c.push_back(0); } },
+    };
+
+    for (Damage const& damage : damages)
+    {
+        std::vector<uint8_t> bytes = good;
+        std::vector<uint8_t> shader = bytecode;
+        damage.Apply(bytes, shader);
+        if (!WriteFile(path, bytes.data(), bytes.size()))
+            return Fail("Couldn't write '%s'", path.string().c_str());
+
+        bool touched = false;
+        result = LoadMarked(path, shader, touched);
+        if (result != damage.Expected)
+            return Fail("A reflection record with %s came back %s instead of %s", damage.What,
+                Renderer::GetReflectionResultString(result), Renderer::GetReflectionResultString(damage.Expected));
+        if (touched)
+            return Fail("Refusing a reflection record with %s still wrote to the caller's record", damage.What);
+    }
+
+    std::filesystem::remove(path);
+    bool touched = false;
+    result = LoadMarked(path, bytecode, touched);
+    if (result != ReflectionResult::MISSING || touched)
+        return Fail("A missing reflection record came back %s", Renderer::GetReflectionResultString(result));
+
+    printf("Reflection record checks passed: %u byte record round tripped, %u kinds of damage refused\n",
+        (uint32_t)good.size(), (uint32_t)(sizeof(damages) / sizeof(damages[0])));
+    return EXIT_SUCCESS;
+}
+
+int RenderGraphs()
+{
+    using namespace Renderer;
+
+    const RGTextureDesc backBufferDesc = { 1920, 1080, 0, 4, 1 };
+    const RGTextureDesc fullColor      = { 1920, 1080, 0, 8, 1 };
+    const RGTextureDesc fullDepth      = { 1920, 1080, 0, 4, 1 };
+    const RGTextureDesc halfColor      = { 960, 540, 0, 8, 1 };
+    const RGTextureDesc quarterColor   = { 480, 270, 0, 8, 1 };
+    const RGTextureDesc small          = { 256, 256, 0, 4, 1 };
+    const RGTextureDesc shadowDesc     = { 2048, 2048, 0, 4, 1 };
+
+    RenderGraph graph;
+    std::string error;
+
+    // Exposure's output goes nowhere, which takes the histogram feeding it down too. The overlay is written and
+    // never read. The capture is a side effect, so it stays even though nothing reads what it writes.
+    {
+        GraphRecorder recorder;
+        graph.Reset();
+        RGResource backBuffer = graph.ImportTexture("BackBuffer", backBufferDesc, RGState::PRESENT, RGState::PRESENT);
+        RGResource sceneColor = graph.CreateTexture("SceneColor", fullColor);
+        RGResource blurred    = graph.CreateTexture("Blurred", fullColor);
+        RGResource histogram  = graph.CreateTexture("Histogram", small);
+        RGResource exposure   = graph.CreateTexture("Exposure", small);
+        RGResource overlay    = graph.CreateTexture("Overlay", backBufferDesc);
+        RGResource capture    = graph.CreateTexture("Capture", fullColor);
+        const uint32_t resourceCount = 7;
+
+        RGPass scene     = AddCheckedPass(graph, recorder, "Scene",     { { sceneColor, RGState::RENDER_TARGET, true } });
+        RGPass histo     = AddCheckedPass(graph, recorder, "Histogram", { { sceneColor, RGState::SHADER_READ, false }, { histogram, RGState::UNORDERED_ACCESS, true } });
+        RGPass blur      = AddCheckedPass(graph, recorder, "Blur",      { { sceneColor, RGState::SHADER_READ, false }, { blurred, RGState::RENDER_TARGET, true } });
+        RGPass expose    = AddCheckedPass(graph, recorder, "Exposure",  { { histogram, RGState::SHADER_READ, false }, { exposure, RGState::UNORDERED_ACCESS, true } });
+        RGPass composite = AddCheckedPass(graph, recorder, "Composite", { { blurred, RGState::SHADER_READ, false }, { backBuffer, RGState::RENDER_TARGET, true } });
+        RGPass debug     = AddCheckedPass(graph, recorder, "Overlay",   { { overlay, RGState::RENDER_TARGET, true } });
+        RGPass grab      = AddCheckedPass(graph, recorder, "Capture",   { { sceneColor, RGState::COPY_SOURCE, false }, { capture, RGState::COPY_DEST, true } }, true);
+        graph.Compile();
+
+        const RGPass culled[] = { histo, expose, debug };
+        const RGPass live[] = { scene, blur, composite, grab };
+        for (RGPass pass : culled)
+            if (!graph.IsPassCulled(pass))
+                return Fail("%s should have been culled, since nothing live reads what it writes", graph.GetPassName(pass));
+        for (RGPass pass : live)
+            if (graph.IsPassCulled(pass))
+                return Fail("%s was culled, but it feeds the back buffer or has side effects", graph.GetPassName(pass));
+
+        RGStats const& stats = graph.GetStats();
+        if (stats.DeclaredPasses != 7 || stats.CulledPasses != 3)
+            return Fail("Culling counted %u of %u passes culled instead of 3 of 7", stats.CulledPasses, stats.DeclaredPasses);
+
+        // Only what live passes touch gets memory
+        if (stats.TransientCount != 3 || graph.GetPlacement(histogram).Size || graph.GetPlacement(exposure).Size || graph.GetPlacement(overlay).Size)
+            return Fail("%u transients were placed, including some only culled passes use", stats.TransientCount);
+
+        recorder.States.assign(resourceCount, RGState::UNDEFINED);
+        recorder.States[backBuffer] = RGState::PRESENT;
+        recorder.Execute(graph);
+        if (!recorder.Error.empty())
+            return Fail("%s", recorder.Error.c_str());
+        if (recorder.Executed != std::vector<RGPass>(std::begin(live), std::end(live)))
+            return Fail("%u passes ran instead of the 4 live ones in order", (uint32_t)recorder.Executed.size());
+    }
+
+    // Laid out like the headless frame, plus a compute pass writing the same UAV twice. Forward needs its shadow map,
+    // depth and color moved at once, Sky finds them where Forward left them, and Tonemap moves three resources.
+    {
+        GraphRecorder recorder;
+        graph.Reset();
+        RGResource backBuffer   = graph.ImportTexture("BackBuffer", backBufferDesc, RGState::PRESENT, RGState::PRESENT);
+        RGResource shadowMap    = graph.CreateTexture("ShadowMap", shadowDesc);
+        RGResource sceneDepth   = graph.CreateTexture("SceneDepth", fullDepth);
+        RGResource sceneColor   = graph.CreateTexture("SceneColor", fullColor);
+        RGResource bloomHalf    = graph.CreateTexture("BloomHalf", halfColor);
+        RGResource bloomQuarter = graph.CreateTexture("BloomQuarter", quarterColor);
+        RGResource luminance    = graph.CreateTexture("Luminance", small);
+        const std::vector<RGTextureDesc> descs = { backBufferDesc, shadowDesc, fullDepth, fullColor, halfColor, quarterColor, small };
+        const uint32_t resourceCount = (uint32_t)descs.size();
+
+        AddCheckedPass(graph, recorder, "Shadow",       { { shadowMap, RGState::DEPTH_WRITE, true } });
+        AddCheckedPass(graph, recorder, "DepthPrepass", { { sceneDepth, RGState::DEPTH_WRITE, true } });
+        RGPass forward = AddCheckedPass(graph, recorder, "Forward", { { shadowMap, RGState::SHADER_READ, false },
+            { sceneDepth, RGState::DEPTH_READ, false }, { sceneColor, RGState::RENDER_TARGET, true } });
+        RGPass sky = AddCheckedPass(graph, recorder, "Sky", { { sceneDepth, RGState::DEPTH_READ, false }, { sceneColor, RGState::RENDER_TARGET, true } });
+        AddCheckedPass(graph, recorder, "BloomDown",  { { sceneColor, RGState::SHADER_READ, false }, { bloomHalf, RGState::RENDER_TARGET, true } });
+        AddCheckedPass(graph, recorder, "BloomDown2", { { bloomHalf, RGState::SHADER_READ, false }, { bloomQuarter, RGState::RENDER_TARGET, true } });
+        AddCheckedPass(graph, recorder, "Luminance",  { { sceneColor, RGState::SHADER_READ, false }, { luminance, RGState::UNORDERED_ACCESS, true } });
+        RGPass reduce = AddCheckedPass(graph, recorder, "LuminanceReduce", { { luminance, RGState::UNORDERED_ACCESS, true } });
+        RGPass tonemap = AddCheckedPass(graph, recorder, "Tonemap", { { sceneColor, RGState::SHADER_READ, false },
+            { bloomQuarter, RGState::SHADER_READ, false }, { luminance, RGState::SHADER_READ, false }, { backBuffer, RGState::RENDER_TARGET, true } });
+        graph.Compile();
+
+        RGStats const& stats = graph.GetStats();
+        if (stats.CulledPasses)
+            return Fail("%u passes of a graph where every pass feeds the back buffer were culled", stats.CulledPasses);
+
+        recorder.States.assign(resourceCount, RGState::UNDEFINED);
+        recorder.States[backBuffer] = RGState::PRESENT;
+        recorder.Execute(graph);
+        if (!recorder.Error.empty())
+            return Fail("%s", recorder.Error.c_str());
+
+        // Batched means one ResourceBarrier call per pass boundary at most, carrying everything that pass needs
+        if (recorder.Batches != stats.BarrierBatches || recorder.Barriers != stats.BarrierCount)
+            return Fail("Execute made %u barrier calls with %u barriers, but the stats say %u with %u",
+                recorder.Batches, recorder.Barriers, stats.BarrierBatches, stats.BarrierCount);
+        if (recorder.BatchBefore[forward] != 3 || recorder.BatchBefore[sky] != 0 || recorder.BatchBefore[reduce] != 1 || recorder.BatchBefore[tonemap] != 3)
+            return Fail("Forward, Sky, LuminanceReduce and Tonemap got batches of %u, %u, %u and %u barriers instead of 3, 0, 1 and 3",
+                recorder.BatchBefore[forward], recorder.BatchBefore[sky], recorder.BatchBefore[reduce], recorder.BatchBefore[tonemap]);
+        if (recorder.States[backBuffer] != RGState::PRESENT)
+            return Fail("The back buffer was left in %s instead of handed back in PRESENT", RenderGraph::GetStateName(recorder.States[backBuffer]));
+
+        if (graph.GetPlacement(luminance).HeapClass != RGHeapClass::TEXTURE || graph.GetPlacement(sceneDepth).HeapClass != RGHeapClass::RENDER_TARGET)
+            return Fail("A UAV went in the render target heap or a depth buffer went outside it");
+        if (!CheckPlacements(graph, recorder, resourceCount, descs, error))
+            return Fail("%s", error.c_str());
+
+        // The shadow map is done with by the time the bloom chain starts, so those can take its memory
+        if (stats.AliasedBytes >= stats.UnaliasedBytes)
+            return Fail("The frame's transients took %llu bytes aliased, no less than the %llu they take unaliased",
+                (unsigned long long)stats.AliasedBytes, (unsigned long long)stats.UnaliasedBytes);
+
+    }
+
+    // A chain only ever has two links alive. Each link is bigger than the last, so the biggest are placed first and
+    // every smaller one has to fit around a neighbour whose lifetime starts on the pass its own ends.
+    RGStats chain;
+    {
+        GraphRecorder recorder;
+        graph.Reset();
+        const char* names[] = { "Chain0", "Chain1", "Chain2", "Chain3", "Chain4", "Chain5" };
+        const uint32_t kLinks = sizeof(names) / sizeof(names[0]);
+
+        std::vector<RGTextureDesc> descs = { backBufferDesc };
+        RGResource backBuffer = graph.ImportTexture("BackBuffer", backBufferDesc, RGState::PRESENT, RGState::PRESENT);
+        RGResource links[kLinks];
+        for (uint32_t i = 0; i != kLinks; ++i)
+        {
+            descs.push_back({ 640 + 128 * i, 1080, 0, 8, 1 });
+            links[i] = graph.CreateTexture(names[i], descs.back());
+        }
+
+        AddCheckedPass(graph, recorder, names[0], { { links[0], RGState::RENDER_TARGET, true } });
+        for (uint32_t i = 1; i != kLinks; ++i)
+            AddCheckedPass(graph, recorder, names[i], { { links[i - 1], RGState::SHADER_READ, false }, { links[i], RGState::RENDER_TARGET, true } });
+        AddCheckedPass(graph, recorder, "Present", { { links[kLinks - 1], RGState::SHADER_READ, false }, { backBuffer, RGState::RENDER_TARGET, true } });
+        graph.Compile();
+
+        recorder.States.assign(descs.size(), RGState::UNDEFINED);
+        recorder.States[backBuffer] = RGState::PRESENT;
+        recorder.Execute(graph);
+        if (!recorder.Error.empty())
+            return Fail("%s", recorder.Error.c_str());
+        if (!CheckPlacements(graph, recorder, (uint32_t)descs.size(), descs, error))
+            return Fail("%s", error.c_str());
+
+        chain = graph.GetStats();
+        const uint64_t lastTwoBytes = graph.GetPlacement(links[kLinks - 2]).Size + graph.GetPlacement(links[kLinks - 1]).Size;
+        if (chain.AliasedBytes != lastTwoBytes || chain.AliasedBytes >= chain.UnaliasedBytes)
+            return Fail("A %u link chain took %llu bytes aliased of %llu unaliased instead of the %llu its last two links take",
+                kLinks, (unsigned long long)chain.AliasedBytes, (unsigned long long)chain.UnaliasedBytes, (unsigned long long)lastTwoBytes);
+    }
+
+    printf("Render graph checks passed: unread passes culled, barriers batched per pass, a %u pass chain aliased into %.1f MB of %.1f MB\n",
+        chain.DeclaredPasses, chain.AliasedBytes / (1024.0 * 1024.0), chain.UnaliasedBytes / (1024.0 * 1024.0));
+    return EXIT_SUCCESS;
+}
+
+int MaterialTables()
+{
+    using namespace Renderer;
+
+    auto makeMaterial = [](uint32_t seed)
+    {
+        GPUMaterial material;
+        material.ColorTint[0] = (float)(seed % 7) / 7.0f;
+        material.SpecularExp  = (float)seed;
+        material.DiffuseIndex = seed;
+        return material;
+    };
+
+    auto isDefault = [](GPUMaterial const& material)
+    {
+        const GPUMaterial empty;
+        return !memcmp(&material, &empty, sizeof(material));
+    };
+
+    std::vector<GPUTableRange> ranges;
+    auto rangesAre = [&ranges](std::initializer_list<GPUTableRange> expected)
+    {
+        if (ranges.size() != expected.size())
+            return false;
+
+        size_t i = 0;
+        for (GPUTableRange const& range : expected)
+        {
+            if (ranges[i].First != range.First || ranges[i].Count != range.Count)
+                return false;
+            ++i;
+        }
+        return true;
+    };
+
+    // Slots come back lowest first, but only once the upload carrying their removal has been collected
+    {
+        MaterialTable table;
+        table.Init(16);
+        for (uint32_t i = 0; i != 8; ++i)
+            if (table.Add(makeMaterial(i)) != i)
+                return Fail("Material %u didn't get slot %u in a fresh table", i, i);
+        table.CollectDirtyRanges(ranges);
+
+        table.Remove(5);
+        table.Remove(2);
+        if (table.IsLive(2) || table.IsLive(5) || !isDefault(table.Get(2)) || !isDefault(table.Get(5)))
+            return Fail("Removed materials are still live or kept their old contents");
+
+        uint32_t index = table.Add(makeMaterial(8));
+        if (index != 8)
+            return Fail("A slot removed this frame was handed out again before its removal was uploaded (got %u)", index);
+
+        table.CollectDirtyRanges(ranges);
+        if (!rangesAre({ { 2, 7 } }))
+            return Fail("The removals and the new material didn't go up as one range over 2-8");
+
+        const uint32_t expected[] = { 2, 5, 9 };
+        for (uint32_t want : expected)
+            if ((index = table.Add(makeMaterial(want))) != want)
+                return Fail("Got slot %u instead of %u after freeing 2 and 5", index, want);
+
+        // Freeing the top of the table pulls the high water mark back down to the last live entry
+        table.Remove(9);
+        table.Remove(8);
+        table.CollectDirtyRanges(ranges);
+        if (table.GetHighWater() != 8 || table.GetStats().Live != 8)
+            return Fail("High water mark %u and %u live after freeing the top two of ten, instead of 8 and 8",
+                table.GetHighWater(), table.GetStats().Live);
+
+        while (table.Add(makeMaterial(0)) != kInvalidMaterialIndex) {}
+        if (table.GetStats().Live != 16)
+            return Fail("A full table of 16 holds %u materials", table.GetStats().Live);
+    }
+
+    // Dirty entries a few clean ones apart go up as one copy, further apart as two, across bitmask words too
+    {
+        MaterialTable table;
+        table.Init(128);
+        for (uint32_t i = 0; i != 128; ++i)
+            table.Add(makeMaterial(i));
+        table.CollectDirtyRanges(ranges);
+        if (!rangesAre({ { 0, 128 } }) || table.IsDirty())
+            return Fail("A freshly filled table didn't go up as one range");
+
+        table.Update(3, makeMaterial(1003));
+        table.Update(1, makeMaterial(1001));
+        table.Update(2, makeMaterial(1002));
+        table.Update(2, makeMaterial(2002));
+        table.CollectDirtyRanges(ranges);
+        if (!rangesAre({ { 1, 3 } }))
+            return Fail("Neighbouring updates made out of order didn't merge into one range");
+
+        table.Update(10, makeMaterial(1010));
+        table.Update(13, makeMaterial(1013));
+        table.CollectDirtyRanges(ranges, 2);
+        if (!rangesAre({ { 10, 4 } }))
+            return Fail("Two updates two clean entries apart weren't merged with a gap of 2");
+
+        table.Update(10, makeMaterial(2010));
+        table.Update(13, makeMaterial(2013));
+        table.CollectDirtyRanges(ranges, 1);
+        if (!rangesAre({ { 10, 1 }, { 13, 1 } }))
+            return Fail("Two updates two clean entries apart were merged with a gap of 1");
+
+        table.Update(62, makeMaterial(1062));
+        table.Update(65, makeMaterial(1065));
+        table.Update(120, makeMaterial(1120));
+        table.CollectDirtyRanges(ranges);
+        if (!rangesAre({ { 62, 4 }, { 120, 1 } }))
+            return Fail("Updates either side of a bitmask word didn't merge, or far ones did");
+    }
+
+    // Writing back what's already there isn't a change
+    {
+        MaterialTable table;
+        table.Init(32);
+        for (uint32_t i = 0; i != 32; ++i)
+            table.Add(makeMaterial(i));
+        table.CollectDirtyRanges(ranges);
+
+        const uint64_t uploaded = table.GetStats().UploadedEntries;
+        for (uint32_t i = 0; i != 32; ++i)
+        {
+            const GPUMaterial same = table.Get(i);
+            table.Update(i, same);
+        }
+
+        table.CollectDirtyRanges(ranges);
+        if (table.IsDirty() || !ranges.empty() || table.GetStats().UploadedEntries != uploaded)
+            return Fail("Updating every material with its own contents uploaded %u ranges", (uint32_t)ranges.size());
+    }
+
+    // Random adds, removes and updates, each frame's ranges copied into a stand-in for the GPU buffer. The copy has
+    // to match the table wherever it's live, and removed entries have to have gone up as defaults.
+    Random random = { 42 };
+    MaterialTable table;
+    table.Init(256);
+    std::vector<GPUMaterial> gpu(table.GetCapacity());
+    std::vector<uint32_t> live;
+    uint64_t uploaded = 0;
+
+    for (uint32_t frame = 0; frame != 2000; ++frame)
+    {
+        const uint32_t ops = random.Next(0, 12);
+        for (uint32_t op = 0; op != ops; ++op)
+        {
+            const uint32_t kind = random.Next(0, 9);
+            if (kind < 4 || live.empty())
+            {
+                const uint32_t index = table.Add(makeMaterial(random.Next()));
+                if (index != kInvalidMaterialIndex)
+                    live.push_back(index);
+            }
+            else if (kind < 6)
+            {
+                const uint32_t pick = random.Next(0, (uint32_t)live.size() - 1);
+                table.Remove(live[pick]);
+                live[pick] = live.back();
+                live.pop_back();
+            }
+            else
+            {
+                const uint32_t index = live[random.Next(0, (uint32_t)live.size() - 1)];
+                table.Update(index, kind == 9 ? table.Get(index) : makeMaterial(random.Next()));
+            }
+        }
+
+        table.CollectDirtyRanges(ranges);
+        for (GPUTableRange const& range : ranges)
+        {
+            if (range.First + range.Count > table.GetCapacity())
+                return Fail("Frame %u: range %u+%u runs past the table", frame, range.First, range.Count);
+            memcpy(&gpu[range.First], table.GetData() + range.First, sizeof(GPUMaterial) * range.Count);
+            uploaded += range.Count;
+        }
+
+        for (uint32_t index = 0; index != table.GetCapacity(); ++index)
+        {
+            const bool isLive = table.IsLive(index);
+            if (isLive && index >= table.GetHighWater())
+                return Fail("Frame %u: material %u is live past the high water mark %u", frame, index, table.GetHighWater());
+            if (memcmp(&gpu[index], table.GetData() + index, sizeof(GPUMaterial)) || (!isLive && !isDefault(gpu[index])))
+                return Fail("Frame %u: the uploaded copy of material %u doesn't match the table", frame, index);
+        }
+    }
+
+    GPUTableStats const stats = table.GetStats();
+    if (stats.UploadedEntries != uploaded || stats.Live != live.size())
+        return Fail("The table counts %llu uploaded and %u live, the churn %llu and %u",
+            (unsigned long long)stats.UploadedEntries, stats.Live, (unsigned long long)uploaded, (uint32_t)live.size());
+
+    printf("Material table checks passed: slots reused after upload, dirty ranges merged, no-op updates skipped, "
+        "2000 frames of churn uploaded %llu entries in %u ranges\n", (unsigned long long)stats.UploadedEntries, stats.Uploads);
+    return EXIT_SUCCESS;
+}
+
+}
@@ -0,0 +1,39 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Self checks for the engine's platform-independent modules
+Each one drives a module on its own, without a game around it, provokes the
+cases it has to handle and fails on the first thing that doesn't come out
+as expected, saying what. Some also time the module against the obvious
+alternative. They return EXIT_SUCCESS or EXIT_FAILURE for main to hand back.
+----------------------------------------------*/
+#ifndef MUON_CHECKS_H
+#define MUON_CHECKS_H
+
+#include <stdint.h>
+
+namespace Checks {
+
+// Guards catching overruns and double frees, leak reports, small pool elements, and each allocator timed against malloc
+int Allocators();
+
+// Best fit and coalescing in the descriptor free list, wrapping and fenced retirement in the ring, both over a fake heap
+int Descriptors();
+
+// Pipeline keys telling apart descs one field apart and matching identical ones, and the key table deduping
+// requests from every job worker at once and turning new keys away when full
+int PipelineKeys();
+
+// A reflection sidecar written, read back whole, and refused for each way it can go bad on disk
+int ReflectionRecords();
+
+// Frame graphs checked through execution: unread passes culled, one barrier batch per pass boundary with every
+// transition it needs, and transients with disjoint lifetimes sharing memory without ever overlapping live ones
+int RenderGraphs();
+
+// Material table slots reused lowest first once their removal is uploaded, dirty entries merged into ranges,
+// no-op updates left clean, and random churn whose uploads always reproduce the table
+int MaterialTables();
+
+}
+#endif
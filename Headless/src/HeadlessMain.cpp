@@ -0,0 +1,1086 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Entry point for running the engine without a window or GPU
+Usage: Headless [-frames N] [-entities N] [-materials N] [-workers N] [-contexts N] [-seed N] [-indirect 0|1] [-validate 0|1]
+                [-texbudget KB] [-readmbps N] [-texarrays 0|1] [-bindless 0|1] [-lights N] [-cascades N] [-gputime 0|1]
+                [-profile trace.json] [-framestats out.csv|out.json] [-validatepacing 0|1] [-renderhz N] [-validatestep 0|1]
+                [-benchmark scene|all] [-results out.json] [-replay input.mnir] [-validatereplay 0|1]
+                [-validateinput 0|1] [-ecsbench N] [-validatealloc 0|1]
+                [-validatedescriptors 0|1] [-validatepipelines 0|1]
+                [-validatereflection 0|1] [-validategraph 0|1] [-validatetables 0|1]
+-validate runs the direct and indirect paths in lockstep and fails if their draws ever differ
+-texbudget streams each material's diffuse map under that budget, -readmbps simulates the drive it streams from
+-texarrays packs the diffuse maps into texture arrays so materials that only differ by texture batch together
+-bindless draws every material out of one material table, so batches are only split by mesh
+-lights bins that many point and spot lights into a cluster grid every frame
+-cascades draws a sun shadow map with that many cascades, culling casters into each one
+-gputime times each frame on the null backend's simulated GPU with timestamp queries, and with -profile
+         puts the GPU's frames and passes on their own track under the CPU threads
+-profile writes every profiled scope of the run as a Chrome trace and prints per-scope percentiles.
+         Needs a build with MN_ENABLE_PROFILER (premake --profile).
+-framestats writes every frame's duration and the pacing summary, as CSV or JSON by the extension
+-validatepacing plays a scripted frame sequence on a virtual clock and fails unless the hitches and
+         fixed step updates come out exactly as scripted
+-renderhz renders at that rate on a virtual clock, running the 60Hz simulation as many steps as fit
+         and drawing entities between the last two
+-validatestep runs the same two simulated seconds at several render rates and fails unless each ran
+         the same steps into the same state as a lockstep run, and left off at the right fraction of a step
+-benchmark runs a named scene (or every one) with its camera on a scripted path, printing percentiles per
+         stage. Scenes set their own content; -frames, -seed, -workers, -contexts, -indirect, -renderhz
+         and -gputime still apply. -results writes every scene's stages, counters and hashes as JSON.
+-replay flies the camera on input recorded by the game (MuonInput.mnir from a profiled run), a frame per frame
+-validatereplay records a scripted session, loads it back and fails unless every frame comes back as it was
+         recorded, damaged recordings are refused, and replaying it twice draws the same frames both times
+-validateinput stresses the input event queue across two threads, then feeds random key and mouse events through
+         an input system and fails unless every frame's commands match each chord checked binding by binding
+-ecsbench times spawning, iterating, destroying and respawning N entities (1000000 is the reference size) in
+         the entity world, next to iterating an array of whole entities, and fails if any step loses track of one
+-validatealloc checks pools with elements smaller than a pointer and the leak report, provokes an arena overrun, a
+         pool overrun and a pool double free and fails unless the guards catch each (Debug builds only, since
+         they need MN_MEMORY_GUARDS), then times the arena, scratch scopes and pools against malloc/free
+-validatedescriptors checks best fit and coalescing in the descriptor free list and wrapping and fenced retirement
+         in the ring, churns both over a fake heap that fails on any overlap, and prints their throughput and
+         how fragmented the free list ended up
+-validatepipelines checks that pipeline descs one field apart get different keys and identical ones the same key
+         and slot, then has every job worker (see -workers) request the same keys at once and fails unless each
+         key made exactly one entry
+-validatereflection writes a shader reflection sidecar to the temp directory and reads it back, then fails unless
+         a bad magic or version, truncation, flipped bytes and changed bytecode are each refused as such
+-validategraph compiles and executes frame graphs against a recorder tracking each resource's state, and fails
+         unless passes nothing reads are culled, each pass gets one barrier batch leaving everything it touches in
+         the state it declared, and transients alias into less memory than they'd take unaliased without overlapping
+-validatetables checks that the material table hands freed slots out again lowest first, only after their removal
+         is uploaded, merges nearby dirty entries into one range and skips updates that change nothing, then churns
+         it and fails unless applying each frame's ranges to a copy reproduces the table
+----------------------------------------------*/
+#include "Benchmark.h"
+#include "Checks.h"
+
+#include <Muon/Core/Clock.h>
+#include <Muon/Core/EntityCommandBuffer.h>
+#include <Muon/Core/FrameStatistics.h>
+#include <Muon/Core/HeadlessGame.h>
+#include <Muon/Core/JobSystem.h>
+#include <Muon/Core/Profiler.h>
+#include <Muon/Core/SPSCQueue.h>
+#include <Muon/Core/World.h>
+#include <Muon/Input/InputRecording.h>
+#include <Muon/Input/InputSystem.h>
+#include <Muon/Memory/Allocators.h>
+#include <Muon/Renderer/NullRenderBackend.h>
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+namespace {
+
+void PrintProfile()
+{
+    using namespace Core::Profiler;
+
+    ScopeStats scopes[64];
+    const uint32_t count = std::min(GetScopeStats(scopes, 64), 64u);
+
+    printf("%-40s %6s %10s %10s %10s %10s\n", "Scope (last 256 frames)", "Calls", "p50(ms)", "p95(ms)", "p99(ms)", "Max(ms)");
+    for (uint32_t i = 0; i != count; ++i)
+    {
+        ScopeStats const& scope = scopes[i];
+        char label[64];
+        snprintf(label, sizeof(label), "%*s%s [%u]", scope.Depth * 2, "", scope.Name, scope.ThreadId);
+        printf("%-40s %6u %10.4f %10.4f %10.4f %10.4f\n", label, scope.Calls, scope.P50Ms, scope.P95Ms, scope.P99Ms, scope.MaxMs);
+    }
+    if (GetDroppedEvents())
+        printf("%llu events dropped\n", (unsigned long long)GetDroppedEvents());
+}
+
+// Steps a direct and an indirect game side by side and compares what each backend actually drew
+int ValidateIndirect(Core::HeadlessConfig config, uint32_t contextCount)
+{
+    Renderer::NullRenderBackend directBackend(contextCount);
+    Renderer::NullRenderBackend indirectBackend(contextCount);
+    Core::HeadlessGame directGame;
+    Core::HeadlessGame indirectGame;
+
+    config.IndirectDraws = false;
+    const bool directOk = directGame.Init(&directBackend, config);
+    config.IndirectDraws = true;
+    if (!directOk || !indirectGame.Init(&indirectBackend, config))
+    {
+        fprintf(stderr, "Failed to initialize headless game\n");
+        return EXIT_FAILURE;
+    }
+
+    for (uint32_t frame = 0; frame != config.FrameCount; ++frame)
+    {
+        directGame.Frame();
+        indirectGame.Frame();
+
+        Renderer::NullBackendStats const& direct = directBackend.GetStats();
+        Renderer::NullBackendStats const& indirect = indirectBackend.GetStats();
+        if (direct.DrawArgsHash != indirect.DrawArgsHash || direct.DrawCalls != indirect.DrawCalls ||
+            direct.Instances != indirect.Instances || direct.Triangles != indirect.Triangles)
+        {
+            fprintf(stderr, "Frame %u: indirect draws differ from direct draws (%u vs %u draws, %llu vs %llu instances)\n",
+                frame, indirect.DrawCalls, direct.DrawCalls, (unsigned long long)indirect.Instances, (unsigned long long)direct.Instances);
+            return EXIT_FAILURE;
+        }
+    }
+
+    Core::HeadlessReport const& direct = directGame.GetReport();
+    Core::HeadlessReport const& indirect = indirectGame.GetReport();
+    printf("Indirect validation passed: %u frames, %llu draws in %llu submissions (direct: %llu)\n",
+        config.FrameCount, (unsigned long long)indirect.DrawCalls, (unsigned long long)indirect.IndirectSubmissions, (unsigned long long)direct.DrawCalls);
+    return EXIT_SUCCESS;
+}
+
+// Steady 60Hz, a 50ms spike, steady again, frames alternating 12ms and 21ms, a 500ms pause, steady,
+// then a lasting step up to 45ms with a 100ms spike in it, and back down to 60Hz
+int ValidatePacing()
+{
+    const double kSteadyMs = 1000.0 / 60.0;
+
+    std::vector<double> script(120, kSteadyMs);
+    const size_t spike = script.size();
+    script.push_back(50.0);
+    script.insert(script.end(), 60, kSteadyMs);
+    for (uint32_t i = 0; i != 60; ++i)
+        script.push_back(i & 1 ? 21.0 : 12.0);
+    const size_t pause = script.size();
+    script.push_back(500.0);
+    script.insert(script.end(), 60, kSteadyMs);
+    const size_t step = script.size();
+    script.insert(script.end(), 60, 45.0);
+    const size_t stepSpike = script.size();
+    script.push_back(100.0);
+    script.insert(script.end(), 30, 45.0);
+    script.insert(script.end(), 60, kSteadyMs);
+
+    // The first few frames of the step hitch until the baseline gives up on the old frame time; after that
+    // only a spike over the new one does
+    auto expectHitch = [&](size_t frame)
+    {
+        return frame == spike || frame == pause || (frame >= step && frame < step + 3) || frame == stepSpike;
+    };
+
+    Core::VirtualClock clock;
+    Core::StepTimer timer(&clock);
+    timer.SetFixedTimeStep(true);
+    timer.SetTargetElapsedSeconds(1.0 / 60.0);
+    Core::FrameStatistics stats;
+
+    uint64_t updates = 0;
+    uint64_t passedTicks = 0;
+    for (size_t frame = 0; frame != script.size(); ++frame)
+    {
+        const uint64_t counts = (uint64_t)(script[frame] * 1e6 + 0.5);
+        clock.Advance(counts);
+        timer.Tick([&updates] { updates++; });
+
+        // The timer clamps anything over a tenth of a second, like a debugger pause
+        passedTicks += std::min(counts, clock.GetFrequency() / 10) * Core::StepTimer::TicksPerSecond / clock.GetFrequency();
+
+        const bool hitch = stats.AddFrame(timer);
+        if (hitch != expectHitch(frame))
+        {
+            fprintf(stderr, "Frame %zu (%.2f ms): %s hitch\n", frame, script[frame], hitch ? "unexpected" : "missed");
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Every whole step of the time that passed ran exactly once
+    const uint64_t expectedUpdates = passedTicks / Core::StepTimer::SecondsToTicks(1.0 / 60.0);
+    if (updates != expectedUpdates)
+    {
+        fprintf(stderr, "%llu fixed updates, expected %llu\n", (unsigned long long)updates, (unsigned long long)expectedUpdates);
+        return EXIT_FAILURE;
+    }
+
+    // Into and out of all three spikes, every frame of the alternation including its first, and both edges of the step
+    const Core::FrameStatsSummary summary = stats.Summarize();
+    if (summary.UnevenFrames != 68 || summary.Hitches != 6)
+    {
+        fprintf(stderr, "%u unevenly paced frames and %u hitches, expected 68 and 6\n", summary.UnevenFrames, summary.Hitches);
+        return EXIT_FAILURE;
+    }
+
+    printf("Pacing validation passed: %u frames, %llu fixed updates, %u hitches, %u uneven frames, p99 %.2f ms\n",
+        summary.Frames, (unsigned long long)updates, summary.Hitches, summary.UnevenFrames, summary.P99Ms);
+    return EXIT_SUCCESS;
+}
+
+// Two seconds at rates that divide the timer's ticks exactly, so every run sees the same total time
+int ValidateFixedStep(Core::HeadlessConfig config, uint32_t contextCount)
+{
+    const uint32_t kRenderRates[] = { 25, 50, 80, 125, 200 };
+    const uint32_t kSeconds = 2;
+
+    const uint64_t stepTicks = Core::StepTimer::SecondsToTicks(config.FixedStep);
+    const uint64_t totalTicks = kSeconds * Core::StepTimer::TicksPerSecond;
+    const uint64_t expectedSteps = totalTicks / stepTicks;
+    const double expectedAlpha = (double)(totalTicks % stepTicks) / stepTicks;
+
+    // The state every render rate has to arrive at
+    uint64_t expectedHash;
+    {
+        Renderer::NullRenderBackend backend(contextCount);
+        Core::HeadlessGame game;
+        config.RenderStep = 0.0;
+        if (!game.Init(&backend, config))
+        {
+            fprintf(stderr, "Failed to initialize headless game\n");
+            return EXIT_FAILURE;
+        }
+
+        for (uint64_t step = 0; step != expectedSteps; ++step)
+            game.Frame();
+        expectedHash = game.GetSimulationHash();
+    }
+
+    for (uint32_t rate : kRenderRates)
+    {
+        Renderer::NullRenderBackend backend(contextCount);
+        Core::HeadlessGame game;
+        config.RenderStep = 1.0 / rate;
+        if (!game.Init(&backend, config))
+        {
+            fprintf(stderr, "Failed to initialize headless game\n");
+            return EXIT_FAILURE;
+        }
+
+        for (uint32_t frame = 0; frame != kSeconds * rate; ++frame)
+            game.Frame();
+
+        const uint64_t steps = game.GetReport().SimulationSteps;
+        const double alpha = game.GetInterpolationAlpha();
+        if (steps != expectedSteps || game.GetSimulationHash() != expectedHash || fabs(alpha - expectedAlpha) > 1e-6)
+        {
+            fprintf(stderr, "%uHz: %llu steps (expected %llu), alpha %.6f (expected %.6f), state %s the lockstep run\n",
+                rate, (unsigned long long)steps, (unsigned long long)expectedSteps, alpha, expectedAlpha,
+                game.GetSimulationHash() == expectedHash ? "matches" : "differs from");
+            return EXIT_FAILURE;
+        }
+    }
+
+    printf("Fixed step validation passed: %llu steps at %u render rates, alpha %.4f, state %016llx\n",
+        (unsigned long long)expectedSteps, (uint32_t)(sizeof(kRenderRates) / sizeof(kRenderRates[0])), expectedAlpha, (unsigned long long)expectedHash);
+    return EXIT_SUCCESS;
+}
+
+// Plays a game over a recorded session and returns its run hash, or 0 if it couldn't initialize
+uint64_t RunReplay(Core::HeadlessConfig config, uint32_t contextCount, Input::InputReplay& replay)
+{
+    Renderer::NullRenderBackend backend(contextCount);
+    Core::HeadlessGame game;
+    replay.Rewind();
+    config.pInputReplay = &replay;
+    config.FrameCount = replay.GetFrameCount();
+    if (!game.Init(&backend, config))
+        return 0;
+
+    return game.Run().CommandHash;
+}
+
+// Flies forward, turns, strafes, climbs, looks around, idles, backs off and rolls, with a stretch at 30Hz
+int ValidateReplay(Core::HeadlessConfig const& config, uint32_t contextCount)
+{
+    using Input::CommandBit;
+    using Input::GameCommands;
+
+    struct Segment
+    {
+        uint32_t Frames;
+        uint32_t Commands;
+        int16_t  MouseX;
+        int16_t  MouseY;
+        float    Dt;
+    };
+
+    const uint32_t look = CommandBit(GameCommands::CameraRotation);
+    const Segment kSession[] =
+    {
+        { 120, CommandBit(GameCommands::MoveForward),                                          0, 0, 1.0f / 60.0f },
+        {  60, CommandBit(GameCommands::MoveForward) | look,                                   4, 0, 1.0f / 60.0f },
+        {  90, CommandBit(GameCommands::MoveRight),                                            0, 0, 1.0f / 30.0f },
+        {  45, CommandBit(GameCommands::MoveUp),                                               0, 0, 1.0f / 60.0f },
+        {  60, look,                                                                          -3, 2, 1.0f / 60.0f },
+        {  30, 0,                                                                              0, 0, 1.0f / 60.0f },
+        {  90, CommandBit(GameCommands::MoveBackward) | CommandBit(GameCommands::MoveLeft),    0, 0, 1.0f / 60.0f },
+        {  30, CommandBit(GameCommands::MoveForward) | CommandBit(GameCommands::RollLeft),     0, 0, 1.0f / 60.0f },
+    };
+
+    // A hand never holds the mouse perfectly steady
+    std::vector<Input::InputFrame> frames;
+    for (Segment const& segment : kSession)
+    {
+        for (uint32_t i = 0; i != segment.Frames; ++i)
+        {
+            const int16_t wobble = (segment.Commands & look) ? (int16_t)(i % 3) - 1 : 0;
+            frames.push_back({ segment.Commands, (int16_t)(segment.MouseX + wobble), (int16_t)(segment.MouseY - wobble), segment.Dt });
+        }
+    }
+
+    Input::InputRecorder recorder;
+    for (Input::InputFrame const& frame : frames)
+        recorder.Record(frame);
+
+    std::vector<uint8_t> data;
+    recorder.Serialize(data);
+
+    Input::InputReplay replay;
+    if (!replay.Load(data.data(), data.size()) || replay.GetFrameCount() != frames.size())
+    {
+        fprintf(stderr, "Couldn't load the recording back\n");
+        return EXIT_FAILURE;
+    }
+
+    for (size_t i = 0; i != frames.size(); ++i)
+    {
+        Input::InputFrame played;
+        Input::InputFrame const& recorded = frames[i];
+        if (!replay.Next(played) || played.Commands != recorded.Commands || played.MouseDeltaX != recorded.MouseDeltaX
+            || played.MouseDeltaY != recorded.MouseDeltaY || played.Dt != recorded.Dt)
+        {
+            fprintf(stderr, "Frame %zu didn't play back as it was recorded\n", i);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Cut short and with a flag no frame has
+    Input::InputReplay damaged;
+    std::vector<uint8_t> flipped = data;
+    flipped.back() |= 0x80;
+    if (damaged.Load(data.data(), data.size() - 1) || damaged.Load(flipped.data(), flipped.size()))
+    {
+        fprintf(stderr, "A damaged recording was accepted\n");
+        return EXIT_FAILURE;
+    }
+
+    const uint64_t first = RunReplay(config, contextCount, replay);
+    const uint64_t second = RunReplay(config, contextCount, replay);
+    if (!first || first != second)
+    {
+        fprintf(stderr, "Replaying the same session drew different frames: %016llx, then %016llx\n", (unsigned long long)first, (unsigned long long)second);
+        return EXIT_FAILURE;
+    }
+
+    printf("Replay validation passed: %zu frames in %zu bytes (%.2f per frame), run hash %016llx\n",
+        frames.size(), data.size(), (double)data.size() / frames.size(), (unsigned long long)first);
+    return EXIT_SUCCESS;
+}
+
+// Key codes picked across all four words of the key bits, bound without a Windows key map
+class ScriptedInput : public Input::InputSystem
+{
+public:
+    ScriptedInput() { SetDefaultKeyMap(); }
+
+    void Rebind(Input::GameCommands command, Input::Chord const& chord) { Bind(command, chord); }
+    Input::Chord const& GetChord(Input::GameCommands command) const { return mKeyMap[(size_t)command]; }
+
+protected:
+    void SetDefaultKeyMap() override
+    {
+        using Input::Binding;
+        using Input::Chord;
+        using Input::GameCommands;
+        using Input::KeyState;
+
+        Rebind(GameCommands::Quit,         Chord(L"Quit", 0x1B, KeyState::JustReleased));
+        Rebind(GameCommands::MoveForward,  Chord(L"Move Forward", 'W', KeyState::StillPressed));
+        Rebind(GameCommands::MoveBackward, Chord(L"Move Backward", { Binding(0x10, KeyState::StillPressed), Binding('S', KeyState::JustPressed) }));
+        Rebind(GameCommands::MoveLeft,     Chord(L"Move Left", { Binding('A', KeyState::StillPressed), Binding('D', KeyState::StillReleased) }));
+        Rebind(GameCommands::MoveRight,    Chord(L"Move Right", { Binding('D', KeyState::StillPressed), Binding('A', KeyState::StillReleased) }));
+        Rebind(GameCommands::MoveUp,       Chord(L"Move Up", { Binding(0xFF, KeyState::JustReleased), Binding(0x82, KeyState::StillReleased) }));
+        Rebind(GameCommands::RollLeft,     Chord(L"Roll Left", { Binding('Q', KeyState::JustPressed), Binding('Q', KeyState::StillPressed) }));
+        Rebind(GameCommands::RollRight,    Chord(L"Roll Right", { Binding(0xC8, KeyState::JustPressed), Binding(0x01, KeyState::StillPressed), Binding(0x10, KeyState::StillPressed) }));
+
+        Rebind(GameCommands::CameraRotation, Chord(L"Camera Rotation", 0x02, KeyState::StillPressed));
+    }
+};
+
+// The old polled matching: every binding of every chord checked against the two key states
+uint32_t MatchChords(ScriptedInput const& input, bool const* previous, bool const* current)
+{
+    uint32_t commands = 0;
+    for (uint32_t i = 0; i != (uint32_t)Input::GameCommands::COUNT; ++i)
+    {
+        bool met = true;
+        for (Input::Binding const& binding : input.GetChord((Input::GameCommands)i).GetChord())
+        {
+            const bool wasDown = previous[binding.GetKeyCode()];
+            const bool isDown = current[binding.GetKeyCode()];
+            Input::KeyState state = wasDown ? (isDown ? Input::KeyState::StillPressed : Input::KeyState::JustReleased)
+                                            : (isDown ? Input::KeyState::JustPressed : Input::KeyState::StillReleased);
+            met &= state == binding.GetKeyState();
+        }
+
+        if (met)
+            commands |= 1u << i;
+    }
+    return commands;
+}
+
+// Hammers a small queue from another thread, then plays random key and mouse events through an input system
+// and checks every frame's commands against matching each chord the slow way
+int ValidateInput(uint32_t seed)
+{
+    using Input::GameCommands;
+
+    const uint32_t kStressCount = 1 << 20;
+    Core::SPSCQueue<uint32_t, 64> queue;
+    std::thread producer([&queue, kStressCount]
+    {
+        for (uint32_t i = 0; i != kStressCount;)
+        {
+            if (queue.Push(i))
+                ++i;
+        }
+    });
+
+    uint32_t expected = 0;
+    while (expected != kStressCount)
+    {
+        uint32_t value;
+        if (!queue.Pop(value))
+            continue;
+
+        if (value != expected)
+            break;
+        ++expected;
+    }
+    producer.join();
+
+    if (expected != kStressCount)
+    {
+        fprintf(stderr, "Queue handed back %u out of order\n", expected);
+        return EXIT_FAILURE;
+    }
+
+    // A tap between two frames is still pressed and then released, and losing focus lets go of everything
+    {
+        ScriptedInput input;
+        input.OnKeyDown(0x1B);
+        input.OnKeyUp(0x1B);
+        input.GetInput();
+        const bool tapPressed = !input.IsActive(GameCommands::Quit);
+        input.GetInput();
+        const bool tapReleased = input.IsActive(GameCommands::Quit);
+
+        input.OnKeyDown('W');
+        input.GetInput();
+        input.GetInput();
+        const bool held = input.IsActive(GameCommands::MoveForward);
+        input.OnFocusLost();
+        input.GetInput();
+
+        if (!tapPressed || !tapReleased || !held || input.IsActive(GameCommands::MoveForward))
+        {
+            fprintf(stderr, "A tap or losing focus didn't come through\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    static const uint8_t kKeys[] = { 0x01, 0x02, 0x10, 0x1B, 'A', 'D', 'Q', 'S', 'W', 'Z', 0x82, 0xC8, 0xFF };
+    const uint32_t kFrames = 20000;
+
+    ScriptedInput input;
+    bool previous[256] = {};
+    bool current[256] = {};
+    bool down[256] = {};
+    Input::MousePosition mouse = { 0, 0 };
+    uint64_t events = 0;
+    uint64_t drainCounts = 0;
+
+    srand(seed);
+    for (uint32_t frame = 0; frame != kFrames; ++frame)
+    {
+        // Halfway through, chords change under keys that may already be down
+        if (frame == kFrames / 2)
+        {
+            input.Rebind(GameCommands::MoveForward, Input::Chord(L"Move Forward", { Input::Binding('W', Input::KeyState::JustPressed), Input::Binding(0xFF, Input::KeyState::StillPressed) }));
+            input.Rebind(GameCommands::Quit, Input::Chord(L"Quit", { Input::Binding(0xC8, Input::KeyState::StillReleased) }));
+        }
+
+        bool pressed[256] = {};
+        const uint32_t frameEvents = rand() % 6;
+        for (uint32_t i = 0; i != frameEvents; ++i)
+        {
+            const uint32_t roll = rand() % 100;
+            const uint8_t key = kKeys[rand() % (sizeof(kKeys) / sizeof(kKeys[0]))];
+            if (roll < 45)
+            {
+                input.OnKeyDown(key);
+                down[key] = pressed[key] = true;
+            }
+            else if (roll < 90)
+            {
+                input.OnKeyUp(key);
+                down[key] = false;
+            }
+            else if (roll < 98)
+            {
+                mouse = { rand() % 2000 - 1000, rand() % 2000 - 1000 };
+                input.OnMouseMove((short)mouse.x, (short)mouse.y);
+            }
+            else
+            {
+                input.OnFocusLost();
+                memset(down, 0, sizeof(down));
+                memset(pressed, 0, sizeof(pressed));
+            }
+        }
+        events += frameEvents;
+
+        const uint64_t start = Core::SystemClock::Get().GetCounter();
+        input.GetInput();
+        drainCounts += Core::SystemClock::Get().GetCounter() - start;
+
+        memcpy(previous, current, sizeof(current));
+        for (uint32_t key = 0; key != 256; ++key)
+            current[key] = down[key] || pressed[key];
+
+        const uint32_t reference = MatchChords(input, previous, current);
+        const Input::MousePosition position = input.GetMousePosition();
+        if (input.GetActiveCommands() != reference || position.x != mouse.x || position.y != mouse.y)
+        {
+            fprintf(stderr, "Frame %u: commands %03x, expected %03x\n", frame, input.GetActiveCommands(), reference);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // More than the queue holds without a frame to drain it
+    ScriptedInput flooded;
+    for (uint32_t i = 0; i != 2000; ++i)
+        flooded.OnMouseMove((short)i, 0);
+    if (flooded.GetDroppedEvents() != 2000 - 1024)
+    {
+        fprintf(stderr, "%u events dropped from a full queue, expected %u\n", flooded.GetDroppedEvents(), 2000 - 1024);
+        return EXIT_FAILURE;
+    }
+
+    const double drainNs = (double)drainCounts * 1e9 / Core::SystemClock::Get().GetFrequency() / kFrames;
+    printf("Input validation passed: %u queued values in order, %u frames of %llu events matched, %.0f ns per GetInput\n",
+        kStressCount, kFrames, (unsigned long long)events, drainNs);
+    return EXIT_SUCCESS;
+}
+
+struct BenchPosition { float X, Y, Z; };
+struct BenchVelocity { float X, Y, Z; };
+struct BenchLifetime { float Remaining; };
+
+// Everything an entity used to carry in one struct, for iterating the old way
+struct BenchWholeEntity
+{
+    float    World[16];
+    float    Position[3];
+    float    Velocity[3];
+    float    Lifetime;
+    uint32_t MeshIndex;
+    uint32_t MaterialIndex;
+};
+
+double MsSince(uint64_t start)
+{
+    Core::SystemClock& clock = Core::SystemClock::Get();
+    return (double)(clock.GetCounter() - start) * 1000.0 / clock.GetFrequency();
+}
+
+// Spawns, iterates, destroys and respawns count entities, failing unless every step leaves the world as expected
+int BenchmarkEntities(uint32_t count)
+{
+    const uint32_t kPasses = 10;
+    const float    kDt = 1.0f / 60.0f;
+    Core::SystemClock& clock = Core::SystemClock::Get();
+
+    auto initialPosition = [](uint32_t i) { return BenchPosition{ (float)(i % 1024), 0.0f, (float)(i / 1024) }; };
+    auto initialVelocity = [](uint32_t i) { return BenchVelocity{ 1.0f, (float)(i % 7), -0.5f }; };
+
+    // A quarter also have a lifetime, so there are two archetypes to walk
+    Core::World world;
+    world.Init(count);
+    std::vector<Core::EntityID> entities(count);
+    uint64_t start = clock.GetCounter();
+    for (uint32_t i = 0; i != count; ++i)
+    {
+        if (i % 4 == 0)
+            entities[i] = world.CreateWith(initialPosition(i), initialVelocity(i), BenchLifetime{ 10.0f });
+        else
+            entities[i] = world.CreateWith(initialPosition(i), initialVelocity(i));
+    }
+    const double spawnMs = MsSince(start);
+
+    auto integrate = [kDt](BenchPosition& position, BenchVelocity const& velocity)
+    {
+        position.X += velocity.X * kDt;
+        position.Y += velocity.Y * kDt;
+        position.Z += velocity.Z * kDt;
+    };
+
+    start = clock.GetCounter();
+    for (uint32_t pass = 0; pass != kPasses; ++pass)
+        world.ForEach<BenchPosition, BenchVelocity>(integrate);
+    const double serialMs = MsSince(start) / kPasses;
+
+    start = clock.GetCounter();
+    for (uint32_t pass = 0; pass != kPasses; ++pass)
+        world.ParallelForEach<BenchPosition, BenchVelocity>(integrate, 4);
+    const double parallelMs = MsSince(start) / kPasses;
+
+    std::vector<BenchWholeEntity> whole(count);
+    for (uint32_t i = 0; i != count; ++i)
+    {
+        const BenchPosition position = initialPosition(i);
+        const BenchVelocity velocity = initialVelocity(i);
+        memcpy(whole[i].Position, &position, sizeof(position));
+        memcpy(whole[i].Velocity, &velocity, sizeof(velocity));
+    }
+
+    // As many steps as both runs over the world took together
+    start = clock.GetCounter();
+    for (uint32_t pass = 0; pass != 2 * kPasses; ++pass)
+    {
+        for (BenchWholeEntity& e : whole)
+        {
+            e.Position[0] += e.Velocity[0] * kDt;
+            e.Position[1] += e.Velocity[1] * kDt;
+            e.Position[2] += e.Velocity[2] * kDt;
+        }
+    }
+    const double wholeMs = MsSince(start) / (2 * kPasses);
+
+    // Both ways of iterating ran the same steps, so they have to land in the same place
+    for (uint32_t i = 0; i < count; i += 997)
+    {
+        BenchPosition const* pPosition = world.Get<BenchPosition>(entities[i]);
+        if (!pPosition || fabsf(pPosition->X - whole[i].Position[0]) > 1e-3f || fabsf(pPosition->Y - whole[i].Position[1]) > 1e-3f)
+        {
+            fprintf(stderr, "Entity %u ended up at the wrong place\n", i);
+            return EXIT_FAILURE;
+        }
+    }
+    whole.clear();
+    whole.shrink_to_fit();
+
+    // Every odd entity destroys itself from inside a parallel system, each job recording into its own thread's buffer
+    std::vector<Core::EntityCommandBuffer> buffers(Core::JobSystem::GetWorkerCount() + 1);
+    start = clock.GetCounter();
+    world.ParallelForEachChunk(Core::GetComponentMask<BenchPosition>(), 4, [&buffers](Core::ChunkView const& chunk, uint32_t)
+    {
+        Core::EntityCommandBuffer& buffer = buffers[Core::JobSystem::GetThreadIndex()];
+        Core::EntityID const* ids = chunk.GetEntities();
+        for (uint32_t i = 0; i != chunk.GetCount(); ++i)
+        {
+            if (ids[i].Index & 1)
+                buffer.Destroy(ids[i]);
+        }
+    });
+    const double destroyRecordMs = MsSince(start);
+
+    start = clock.GetCounter();
+    uint32_t destroyed = 0;
+    for (Core::EntityCommandBuffer& buffer : buffers)
+        destroyed += buffer.Playback(world);
+    const double destroyMs = MsSince(start);
+
+    if (destroyed != count / 2 || world.GetEntityCount() != count - count / 2 || (count > 1 && world.IsAlive(entities[1])))
+    {
+        fprintf(stderr, "Destroyed %u of %u, %u left\n", destroyed, count / 2, world.GetEntityCount());
+        return EXIT_FAILURE;
+    }
+
+    // Refills the freed indices, which must not bring the destroyed IDs back
+    Core::EntityCommandBuffer spawns;
+    start = clock.GetCounter();
+    for (uint32_t i = 0; i != count / 2; ++i)
+        spawns.CreateWith(initialPosition(i), initialVelocity(i));
+    const double spawnRecordMs = MsSince(start);
+
+    start = clock.GetCounter();
+    const uint32_t spawned = spawns.Playback(world);
+    const double respawnMs = MsSince(start);
+
+    if (spawned != count / 2 || world.GetEntityCount() != count || (count > 1 && world.Get<BenchPosition>(entities[1])))
+    {
+        fprintf(stderr, "Spawned %u of %u, %u in the world\n", spawned, count / 2, world.GetEntityCount());
+        return EXIT_FAILURE;
+    }
+
+    // Moves every entity with a lifetime over to the archetype without
+    Core::EntityCommandBuffer removals;
+    world.ForEachChunk(Core::GetComponentMask<BenchLifetime>(), [&removals](Core::ChunkView const& chunk, uint32_t)
+    {
+        for (uint32_t i = 0; i != chunk.GetCount(); ++i)
+            removals.Remove<BenchLifetime>(chunk.GetEntities()[i]);
+    });
+
+    const uint32_t withLifetime = world.CountEntities(Core::GetComponentMask<BenchLifetime>());
+    start = clock.GetCounter();
+    const uint32_t moved = removals.Playback(world);
+    const double moveMs = MsSince(start);
+
+    BenchPosition const* pKept = world.Get<BenchPosition>(entities[0]);
+    if (moved != withLifetime || world.CountEntities(Core::GetComponentMask<BenchLifetime>()) != 0
+        || world.CountEntities(Core::GetComponentMask<BenchPosition, BenchVelocity>()) != count || !pKept || pKept->X == 0.0f)
+    {
+        fprintf(stderr, "Moved %u of %u entities out of their archetype\n", moved, withLifetime);
+        return EXIT_FAILURE;
+    }
+
+    // And one back, keeping where it was
+    const BenchPosition kept = *pKept;
+    world.Add(entities[0], BenchLifetime{ 5.0f });
+    BenchLifetime const* pLifetime = world.Get<BenchLifetime>(entities[0]);
+    pKept = world.Get<BenchPosition>(entities[0]);
+    if (!pLifetime || pLifetime->Remaining != 5.0f || !pKept || memcmp(pKept, &kept, sizeof(kept)))
+    {
+        fprintf(stderr, "Adding a component lost the entity's others\n");
+        return EXIT_FAILURE;
+    }
+
+    auto rate = [](uint32_t n, double ms) { return ms > 0.0 ? n / ms / 1000.0 : 0.0; };
+    printf("%u entities in %u archetypes, %u chunks of %u KB, %u workers\n",
+        count, world.GetArchetypeCount(), world.GetChunkCount(), Core::kChunkSize / 1024, Core::JobSystem::GetWorkerCount());
+    printf("%-28s %10s %12s\n", "", "ms", "M entities/s");
+    printf("%-28s %10.3f %12.1f\n", "Spawn", spawnMs, rate(count, spawnMs));
+    printf("%-28s %10.3f %12.1f\n", "Iterate, whole entity array", wholeMs, rate(count, wholeMs));
+    printf("%-28s %10.3f %12.1f\n", "Iterate, serial", serialMs, rate(count, serialMs));
+    printf("%-28s %10.3f %12.1f\n", "Iterate, parallel", parallelMs, rate(count, parallelMs));
+    printf("%-28s %10.3f %12.1f\n", "Destroy, record in parallel", destroyRecordMs, rate(destroyed, destroyRecordMs));
+    printf("%-28s %10.3f %12.1f\n", "Destroy, playback", destroyMs, rate(destroyed, destroyMs));
+    printf("%-28s %10.3f %12.1f\n", "Spawn, record", spawnRecordMs, rate(spawned, spawnRecordMs));
+    printf("%-28s %10.3f %12.1f\n", "Spawn, playback", respawnMs, rate(spawned, respawnMs));
+    printf("%-28s %10.3f %12.1f\n", "Remove component, playback", moveMs, rate(moved, moveMs));
+    return EXIT_SUCCESS;
+}
+
+// Runs one scene or all of them and writes their results, if asked, once they've all finished
+int RunBenchmark(const char* name, const char* resultsPath, Core::HeadlessConfig const& config, uint32_t contextCount)
+{
+    std::vector<Benchmark::Scene const*> scenes;
+    if (!strcmp(name, "all"))
+    {
+        for (uint32_t i = 0; i != Benchmark::GetSceneCount(); ++i)
+            scenes.push_back(&Benchmark::GetScene(i));
+    }
+    else if (Benchmark::Scene const* pScene = Benchmark::FindScene(name))
+    {
+        scenes.push_back(pScene);
+    }
+    else
+    {
+        fprintf(stderr, "Unknown benchmark scene '%s', expected all or one of:\n", name);
+        for (uint32_t i = 0; i != Benchmark::GetSceneCount(); ++i)
+            fprintf(stderr, "  %-10s %s\n", Benchmark::GetScene(i).Name, Benchmark::GetScene(i).Description);
+        return EXIT_FAILURE;
+    }
+
+    printf("Benchmark: %u scenes, %u frames each, %u workers\n", (uint32_t)scenes.size(), config.FrameCount, Core::JobSystem::GetWorkerCount());
+
+    std::vector<Benchmark::Result> results(scenes.size());
+    for (size_t i = 0; i != scenes.size(); ++i)
+    {
+        if (!Benchmark::Run(*scenes[i], config, contextCount, results[i]))
+        {
+            fprintf(stderr, "Failed to initialize benchmark scene '%s'\n", scenes[i]->Name);
+            return EXIT_FAILURE;
+        }
+        Benchmark::PrintResult(results[i]);
+    }
+
+    if (resultsPath && !Benchmark::WriteResults(resultsPath, results.data(), (uint32_t)results.size(), Core::JobSystem::GetWorkerCount(), contextCount))
+    {
+        fprintf(stderr, "Couldn't write '%s'\n", resultsPath);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    Core::HeadlessConfig config;
+    uint32_t workerCount = 0;
+    uint32_t contextCount = 4;
+    bool validate = false;
+    bool validatePacing = false;
+    bool validateStep = false;
+    const char* profilePath = nullptr;
+    const char* frameStatsPath = nullptr;
+    const char* benchmarkName = nullptr;
+    const char* resultsPath = nullptr;
+    const char* replayPath = nullptr;
+    bool validateReplay = false;
+    bool validateInput = false;
+    uint32_t ecsBenchCount = 0;
+    bool validateAlloc = false;
+    bool validateDescriptors = false;
+    bool validatePipelines = false;
+    bool validateReflection = false;
+    bool validateGraph = false;
+    bool validateTables = false;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (!strcmp(argv[i], "-profile"))
+        {
+            profilePath = argv[i + 1];
+            continue;
+        }
+        if (!strcmp(argv[i], "-framestats"))
+        {
+            frameStatsPath = argv[i + 1];
+            continue;
+        }
+        if (!strcmp(argv[i], "-benchmark"))
+        {
+            benchmarkName = argv[i + 1];
+            continue;
+        }
+        if (!strcmp(argv[i], "-results"))
+        {
+            resultsPath = argv[i + 1];
+            continue;
+        }
+        if (!strcmp(argv[i], "-replay"))
+        {
+            replayPath = argv[i + 1];
+            continue;
+        }
+
+        const uint32_t value = (uint32_t)strtoul(argv[i + 1], nullptr, 10);
+
+        if      (!strcmp(argv[i], "-frames"))   config.FrameCount = value;
+        else if (!strcmp(argv[i], "-entities")) config.EntityCount = value;
+        else if (!strcmp(argv[i], "-materials")) config.MaterialCount = value;
+        else if (!strcmp(argv[i], "-workers"))  workerCount = value;
+        else if (!strcmp(argv[i], "-contexts")) contextCount = value;
+        else if (!strcmp(argv[i], "-seed"))     config.Seed = value;
+        else if (!strcmp(argv[i], "-indirect")) config.IndirectDraws = value != 0;
+        else if (!strcmp(argv[i], "-validate")) validate = value != 0;
+        else if (!strcmp(argv[i], "-validatepacing")) validatePacing = value != 0;
+        else if (!strcmp(argv[i], "-validatestep")) validateStep = value != 0;
+        else if (!strcmp(argv[i], "-validatereplay")) validateReplay = value != 0;
+        else if (!strcmp(argv[i], "-validateinput")) validateInput = value != 0;
+        else if (!strcmp(argv[i], "-ecsbench")) ecsBenchCount = value;
+        else if (!strcmp(argv[i], "-validatealloc")) validateAlloc = value != 0;
+        else if (!strcmp(argv[i], "-validatedescriptors")) validateDescriptors = value != 0;
+        else if (!strcmp(argv[i], "-validatepipelines")) validatePipelines = value != 0;
+        else if (!strcmp(argv[i], "-validatereflection")) validateReflection = value != 0;
+        else if (!strcmp(argv[i], "-validategraph")) validateGraph = value != 0;
+        else if (!strcmp(argv[i], "-validatetables")) validateTables = value != 0;
+        else if (!strcmp(argv[i], "-renderhz")) config.RenderStep = value ? 1.0 / value : 0.0;
+        else if (!strcmp(argv[i], "-texbudget")) config.TextureBudgetKB = value;
+        else if (!strcmp(argv[i], "-readmbps")) config.StreamingReadMBps = value;
+        else if (!strcmp(argv[i], "-texarrays")) config.TextureArrays = value != 0;
+        else if (!strcmp(argv[i], "-bindless")) config.BindlessMaterials = value != 0;
+        else if (!strcmp(argv[i], "-lights"))   config.LightCount = value;
+        else if (!strcmp(argv[i], "-cascades")) config.ShadowCascades = value;
+        else if (!strcmp(argv[i], "-gputime"))  config.GpuTiming = value != 0;
+        else
+        {
+            fprintf(stderr, "Unknown argument '%s'\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+
+#if !defined(MN_ENABLE_PROFILER)
+    if (profilePath)
+    {
+        fprintf(stderr, "-profile needs a build with MN_ENABLE_PROFILER\n");
+        return EXIT_FAILURE;
+    }
+#endif
+
+    Input::InputReplay replay;
+    if (replayPath)
+    {
+        if (!replay.Load(replayPath))
+        {
+            fprintf(stderr, "Couldn't load input recording '%s'\n", replayPath);
+            return EXIT_FAILURE;
+        }
+        config.pInputReplay = &replay;
+    }
+
+    Memory::Init();
+    Core::JobSystem::Init(workerCount);
+
+    if (profilePath)
+        Core::Profiler::BeginCapture();
+
+    int result = EXIT_SUCCESS;
+    if (validatePacing)
+    {
+        result = ValidatePacing();
+    }
+    else if (validateStep)
+    {
+        result = ValidateFixedStep(config, contextCount);
+    }
+    else if (validateReplay)
+    {
+        result = ValidateReplay(config, contextCount);
+    }
+    else if (validateInput)
+    {
+        result = ValidateInput(config.Seed);
+    }
+    else if (ecsBenchCount)
+    {
+        result = BenchmarkEntities(ecsBenchCount);
+    }
+    else if (validateAlloc)
+    {
+        result = Checks::Allocators();
+    }
+    else if (validateDescriptors)
+    {
+        result = Checks::Descriptors();
+    }
+    else if (validatePipelines)
+    {
+        result = Checks::PipelineKeys();
+    }
+    else if (validateReflection)
+    {
+        result = Checks::ReflectionRecords();
+    }
+    else if (validateGraph)
+    {
+        result = Checks::RenderGraphs();
+    }
+    else if (validateTables)
+    {
+        result = Checks::MaterialTables();
+    }
+    else if (validate)
+    {
+        result = ValidateIndirect(config, contextCount);
+    }
+    else if (benchmarkName)
+    {
+        result = RunBenchmark(benchmarkName, resultsPath, config, contextCount);
+    }
+    else
+    {
+        Renderer::NullRenderBackend backend(contextCount);
+        Core::HeadlessGame game;
+
+        if (game.Init(&backend, config))
+        {
+            Core::HeadlessReport const report = game.Run();
+            Renderer::NullBackendStats const& stats = backend.GetStats();
+            const double frames = report.Frames ? (double)report.Frames : 1.0;
+
+            printf("Frames: %u  Entities: %u  Workers: %u\n", report.Frames, config.EntityCount, Core::JobSystem::GetWorkerCount());
+            printf("%-8s %10s %10s %10s\n", "Stage", "Avg(ms)", "Min(ms)", "Max(ms)");
+            for (uint8_t s = 0; s != (uint8_t)Core::HeadlessStage::COUNT; ++s)
+            {
+                Core::StageTiming const& t = report.Stages[s];
+                printf("%-8s %10.4f %10.4f %10.4f\n", Core::HeadlessGame::GetStageName((Core::HeadlessStage)s), t.TotalMs / frames, t.MinMs, t.MaxMs);
+            }
+            printf("%-8s %10.4f %10.4f %10.4f\n", "Frame", report.Frame.TotalMs / frames, report.Frame.MinMs, report.Frame.MaxMs);
+
+            if (replayPath)
+                printf("Replayed %u of %u recorded input frames\n", replay.GetFramesPlayed(), replay.GetFrameCount());
+            if (config.RenderStep > 0.0)
+                printf("Rendered at %.1f Hz: %llu fixed steps, %.2f per frame\n",
+                    1.0 / config.RenderStep, (unsigned long long)report.SimulationSteps, report.SimulationSteps / frames);
+            printf("Per frame: %.1f draws, %.1f instances, %.1f triangles, %.1f KB uploaded\n",
+                report.DrawCalls / frames, report.Instances / frames, report.Triangles / frames, report.UploadBytes / frames / 1024.0);
+            if (config.IndirectDraws)
+                printf("Submitted as %.1f ExecuteIndirect per frame, %u state changes, command stream %016llx\n",
+                    report.IndirectSubmissions / frames, stats.StateChanges, (unsigned long long)stats.CommandHash);
+            else
+                printf("Recorded on %.1f contexts, %u state changes, command stream %016llx\n",
+                    report.RecordContexts / frames, stats.StateChanges, (unsigned long long)stats.CommandHash);
+            printf("Resident: %llu KB buffers, %llu KB textures, %llu KB shaders\n",
+                (unsigned long long)(stats.BufferBytes >> 10), (unsigned long long)(stats.TextureBytes >> 10), (unsigned long long)(stats.ShaderBytes >> 10));
+            Renderer::RGStats const& graph = report.Graph;
+            printf("Frame graph: %u/%u passes live, %u barriers in %u batches, transients %.1f MB aliased into %.1f MB (%.1f MB saved)\n",
+                graph.DeclaredPasses - graph.CulledPasses, graph.DeclaredPasses, graph.BarrierCount, graph.BarrierBatches,
+                graph.UnaliasedBytes / 1048576.0, graph.AliasedBytes / 1048576.0, graph.GetSavedBytes() / 1048576.0);
+            if (config.BindlessMaterials)
+                printf("Bindless: %u materials in one table, %llu entries uploaded in %llu ranges\n",
+                    config.MaterialCount, (unsigned long long)report.MaterialEntriesUploaded, (unsigned long long)report.MaterialUploads);
+            else if (config.TextureArrays)
+                printf("Texture arrays: %u materials in %u shading groups\n", config.MaterialCount, report.ShadingGroups);
+            if (config.LightCount)
+            {
+                Renderer::ClusterStats const& lights = report.Lights;
+                printf("Lights: %u (%u visible), %u lit clusters, %u indices (at most %u per cluster, %u dropped), %llu entries uploaded in %llu ranges\n",
+                    lights.Lights, lights.VisibleLights, lights.LitClusters, lights.LightIndices, lights.MaxLightsPerCluster, lights.DroppedIndices,
+                    (unsigned long long)report.LightEntriesUploaded, (unsigned long long)report.LightUploads);
+            }
+            if (config.ShadowCascades)
+                printf("Shadows: %u cascades, %.2f rendered and %.2f cached per frame, %.1f draws and %.1f caster instances per frame\n",
+                    config.ShadowCascades, report.ShadowCascadesRendered / frames, report.ShadowCascadesCached / frames,
+                    report.ShadowDraws / frames, report.ShadowInstances / frames);
+            if (config.TextureBudgetKB)
+            {
+                Renderer::TextureStreamerStats const& streaming = report.Streaming;
+                printf("Streaming: %.2f MB resident of %.2f MB budget (%.2f MB wanted), %u/%u textures at their wanted mip, %u trimmed to fit, %u reads pending\n",
+                    streaming.ResidentBytes / 1048576.0, streaming.BudgetBytes / 1048576.0, streaming.WantedBytes / 1048576.0,
+                    streaming.TexturesAtWanted, streaming.TextureCount, streaming.TexturesTrimmed, streaming.PendingReads);
+                printf("           %llu reads (%.2f MB, %.1f frames to resident on average), %llu cancelled, %llu evictions (%.2f MB)\n",
+                    (unsigned long long)streaming.ReadCount, streaming.ReadBytes / 1048576.0,
+                    streaming.ReadCount ? (double)streaming.ReadLatencyFrames / streaming.ReadCount : 0.0,
+                    (unsigned long long)streaming.CancelledReads, (unsigned long long)streaming.EvictionCount, streaming.EvictedBytes / 1048576.0);
+            }
+            if (config.GpuTiming && report.GPU.FramesRead)
+            {
+                // The GPU sitting idle between frames means it's waiting on the CPU to submit them
+                Renderer::GPUTimingStats const& gpu = report.GPU;
+                const double busyMs = gpu.BusyMs / gpu.FramesRead;
+                const double idleMs = gpu.FramesRead > 1 ? gpu.IdleMs / (gpu.FramesRead - 1) : 0.0;
+                printf("GPU: %.4f ms busy and %.4f ms idle per frame, %.4f ms from submit to done, %u frames read, %u dropped -> %s-bound\n",
+                    busyMs, idleMs, gpu.LatencyMs / gpu.FramesRead, gpu.FramesRead, gpu.FramesDropped, idleMs > busyMs * 0.1 ? "CPU" : "GPU");
+            }
+            Core::FrameStatistics const& frameStats = game.GetFrameStatistics();
+            const Core::FrameStatsSummary pacing = frameStats.Summarize();
+            printf("Pacing (last %u frames): p50 %.4f, p95 %.4f, p99 %.4f, max %.4f ms, stddev %.4f, jitter %.4f ms, %u uneven, %llu hitches\n",
+                pacing.Frames, pacing.P50Ms, pacing.P95Ms, pacing.P99Ms, pacing.MaxMs, pacing.StdDevMs, pacing.JitterMs,
+                pacing.UnevenFrames, (unsigned long long)pacing.TotalHitches);
+            printf("Run hash: %016llx\n", (unsigned long long)report.CommandHash);
+
+            if (frameStatsPath)
+            {
+                const size_t length = strlen(frameStatsPath);
+                const bool csv = length >= 4 && !strcmp(frameStatsPath + length - 4, ".csv");
+                if (!(csv ? frameStats.WriteCSV(frameStatsPath) : frameStats.WriteJSON(frameStatsPath)))
+                {
+                    fprintf(stderr, "Couldn't write '%s'\n", frameStatsPath);
+                    result = EXIT_FAILURE;
+                }
+            }
+
+            if (profilePath)
+            {
+                PrintProfile();
+                if (!Core::Profiler::WriteChromeTrace(profilePath))
+                {
+                    fprintf(stderr, "Couldn't write '%s'\n", profilePath);
+                    result = EXIT_FAILURE;
+                }
+            }
+        }
+        else
+        {
+            fprintf(stderr, "Failed to initialize headless game\n");
+            result = EXIT_FAILURE;
+        }
+    }
+
+    Core::JobSystem::Shutdown();
+    Core::Profiler::Shutdown();
+    Memory::Shutdown();
+
+    return result;
+}
@@ -0,0 +1,132 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of CameraPath.h
+----------------------------------------------*/
+#include "CameraPath.h"
+
+#include <assert.h>
+#include <math.h>
+
+namespace Core {
+
+namespace {
+
+// Cubic Hermite between p1 and p2 over a segment dt long, with Catmull-Rom tangents from the keys either side
+float Spline(float p0, float p1, float p2, float p3, float t0, float t1, float t2, float t3, float s)
+{
+    const float dt = t2 - t1;
+    const float m1 = (p2 - p0) / (t2 - t0) * dt;
+    const float m2 = (p3 - p1) / (t3 - t1) * dt;
+
+    const float s2 = s * s;
+    const float s3 = s2 * s;
+    return (2.0f * s3 - 3.0f * s2 + 1.0f) * p1
+         + (s3 - 2.0f * s2 + s) * m1
+         + (-2.0f * s3 + 3.0f * s2) * p2
+         + (s3 - s2) * m2;
+}
+
+}
+
+CameraPath::CameraPath() :
+    mKeys(),
+    mLoopDuration(0.0f)
+{
+}
+
+void CameraPath::SetKeys(CameraKey const* pKeys, uint32_t count, float loopDuration)
+{
+    assert(pKeys && count >= 2 && pKeys[0].Time == 0.0f);
+    for (uint32_t i = 1; i != count; ++i)
+        assert(pKeys[i].Time > pKeys[i - 1].Time);
+    assert(loopDuration == 0.0f || loopDuration > pKeys[count - 1].Time);
+
+    mKeys.assign(pKeys, pKeys + count);
+    mLoopDuration = loopDuration;
+}
+
+float CameraPath::GetDuration() const
+{
+    if (mKeys.empty())
+        return 0.0f;
+
+    return mLoopDuration > 0.0f ? mLoopDuration : mKeys.back().Time;
+}
+
+CameraKey const& CameraPath::GetKey(int32_t i, float& out_time) const
+{
+    const int32_t count = (int32_t)mKeys.size();
+    if (mLoopDuration > 0.0f)
+    {
+        const int32_t loops = i >= 0 ? i / count : -((count - 1 - i) / count);
+        CameraKey const& key = mKeys[i - loops * count];
+        out_time = key.Time + loops * mLoopDuration;
+        return key;
+    }
+
+    // Repeating an end key makes its tangent one sided
+    CameraKey const& key = mKeys[i < 0 ? 0 : (i >= count ? count - 1 : i)];
+    out_time = key.Time;
+    return key;
+}
+
+void CameraPath::Evaluate(float seconds, float* out_position, float* out_forward) const
+{
+    assert(!mKeys.empty());
+
+    float time;
+    if (mLoopDuration > 0.0f)
+    {
+        time = fmodf(seconds, mLoopDuration);
+        if (time < 0.0f)
+            time += mLoopDuration;
+    }
+    else
+    {
+        time = seconds < 0.0f ? 0.0f : (seconds > mKeys.back().Time ? mKeys.back().Time : seconds);
+    }
+
+    // The segment starting at the last key at or before the time. Paths are a handful of keys, so a scan does.
+    int32_t segment = 0;
+    while (segment + 1 < (int32_t)mKeys.size() && mKeys[segment + 1].Time <= time)
+        segment++;
+
+    // Holding on the last key of a path that doesn't loop
+    if (mLoopDuration <= 0.0f && segment == (int32_t)mKeys.size() - 1)
+        segment--;
+
+    float t0, t1, t2, t3;
+    CameraKey const& k0 = GetKey(segment - 1, t0);
+    CameraKey const& k1 = GetKey(segment, t1);
+    CameraKey const& k2 = GetKey(segment + 1, t2);
+    CameraKey const& k3 = GetKey(segment + 2, t3);
+    const float s = (time - t1) / (t2 - t1);
+
+    float target[3];
+    for (uint32_t axis = 0; axis != 3; ++axis)
+    {
+        out_position[axis] = Spline(k0.Position[axis], k1.Position[axis], k2.Position[axis], k3.Position[axis], t0, t1, t2, t3, s);
+        target[axis] = Spline(k0.Target[axis], k1.Target[axis], k2.Target[axis], k3.Target[axis], t0, t1, t2, t3, s);
+    }
+
+    out_forward[0] = target[0] - out_position[0];
+    out_forward[1] = target[1] - out_position[1];
+    out_forward[2] = target[2] - out_position[2];
+
+    // Looking at itself has no direction, so keep the one every camera starts with
+    const float length = sqrtf(out_forward[0] * out_forward[0] + out_forward[1] * out_forward[1] + out_forward[2] * out_forward[2]);
+    if (length < 1e-6f)
+    {
+        out_forward[0] = 0.0f;
+        out_forward[1] = 0.0f;
+        out_forward[2] = 1.0f;
+        return;
+    }
+
+    out_forward[0] /= length;
+    out_forward[1] /= length;
+    out_forward[2] /= length;
+}
+
+}
@@ -0,0 +1,49 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Scripted camera motion
+A Catmull-Rom spline through timed keys, for both where the camera is and
+the point it looks at, so it turns as smoothly as it moves. Keys can be
+spaced unevenly in time; tangents are scaled by the time around each key,
+so the camera's speed doesn't jump when it crosses one.
+----------------------------------------------*/
+#ifndef MUON_CAMERAPATH_H
+#define MUON_CAMERAPATH_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace Core {
+
+struct CameraKey
+{
+    float Time;         // Seconds from the start of the path
+    float Position[3];
+    float Target[3];
+};
+
+class CameraPath
+{
+public:
+    CameraPath();
+
+    // At least two keys in increasing time order, the first at 0. With a loop duration the path
+    // runs from the last key back into the first, arriving as the loop wraps; without, it stops on the last.
+    void SetKeys(CameraKey const* pKeys, uint32_t count, float loopDuration = 0.0f);
+
+    bool  IsEmpty() const     { return mKeys.empty(); }
+    float GetDuration() const;
+
+    // Forward is unit length. Past the end, a looping path wraps and any other holds its last key.
+    void Evaluate(float seconds, float* out_position, float* out_forward) const;
+
+private:
+    // Key i of the path extended past either end: wrapped with its time shifted by whole loops, or clamped
+    CameraKey const& GetKey(int32_t i, float& out_time) const;
+
+    std::vector<CameraKey> mKeys;
+    float                  mLoopDuration;   // 0 if it doesn't loop
+};
+
+}
+#endif
@@ -0,0 +1,68 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of Clock.h
+----------------------------------------------*/
+#include "Clock.h"
+
+#include <assert.h>
+
+#if defined(MN_PLATFORM_WINDOWS)
+#include <Muon/Core/WinApp.h>
+#else
+#include <time.h>
+#endif
+
+namespace Core {
+
+/////////////////////////////////////////////////////////////////////
+// SystemClock
+
+SystemClock::SystemClock()
+{
+#if defined(MN_PLATFORM_WINDOWS)
+    // Can't fail on anything since XP
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    mFrequency = (uint64_t)frequency.QuadPart;
+#else
+    mFrequency = 1000000000;
+#endif
+}
+
+uint64_t SystemClock::GetCounter()
+{
+#if defined(MN_PLATFORM_WINDOWS)
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)counter.QuadPart;
+#else
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+#endif
+}
+
+SystemClock& SystemClock::Get()
+{
+    static SystemClock sClock;
+    return sClock;
+}
+
+/////////////////////////////////////////////////////////////////////
+// VirtualClock
+
+VirtualClock::VirtualClock(uint64_t frequency) :
+    mFrequency(frequency),
+    mCounter(0)
+{
+    assert(frequency != 0);
+}
+
+void VirtualClock::AdvanceSeconds(double seconds)
+{
+    assert(seconds >= 0.0);
+    mCounter += (uint64_t)(seconds * (double)mFrequency + 0.5);
+}
+
+}
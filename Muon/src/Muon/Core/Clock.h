@@ -0,0 +1,59 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Clock sources for StepTimer
+The system clock reads the OS's monotonic counter. The virtual clock only
+moves when it's told to, so anything timed against it (frame pacing, hitch
+detection, fixed step catch-up) plays out the same way on every run.
+----------------------------------------------*/
+#ifndef MUON_CLOCK_H
+#define MUON_CLOCK_H
+
+#include <stdint.h>
+
+namespace Core {
+
+// A monotonic counter and how many times a second it counts
+class IClock
+{
+public:
+    virtual ~IClock() {}
+
+    virtual uint64_t GetCounter() = 0;
+    virtual uint64_t GetFrequency() const = 0;
+};
+
+// QueryPerformanceCounter on Windows, clock_gettime(CLOCK_MONOTONIC) elsewhere
+class SystemClock final : public IClock
+{
+public:
+    SystemClock();
+
+    uint64_t GetCounter() override;
+    uint64_t GetFrequency() const override { return mFrequency; }
+
+    // The one every timer uses unless it's given another
+    static SystemClock& Get();
+
+private:
+    uint64_t mFrequency;
+};
+
+class VirtualClock final : public IClock
+{
+public:
+    explicit VirtualClock(uint64_t frequency = 1000000000);
+
+    uint64_t GetCounter() override { return mCounter; }
+    uint64_t GetFrequency() const override { return mFrequency; }
+
+    void Advance(uint64_t counts) { mCounter += counts; }
+    void AdvanceSeconds(double seconds);
+
+private:
+    uint64_t mFrequency;
+    uint64_t mCounter;
+};
+
+}
+#endif
@@ -9,13 +9,25 @@ or "Introduction to 3D Game Programming with DirectX 12" by Frank Luna
 #include <Muon.h>
 #include <Muon/Utils/Utils.h>
 #include <Muon/Core/DXCore.h>
+#include <Muon/Core/DescriptorHeap.h>
+#include <Muon/Core/JobSystem.h>
+#include <Muon/Core/PipelineStateCache.h>
+#include <Muon/Core/Profiler.h>
+#include <Muon/Renderer/D3D12Timestamps.h>
+#include <Muon/Renderer/GPUProfiler.h>
+#include <Muon/Renderer/ParallelRecorder.h>
+#include <Muon/Renderer/RenderGraph.h>
 #include <Muon/Renderer/ThrowMacros.h> // TODO: move to Core?
 
 #include <d3dx12.h>
 #include <d3d12.h>
 #include <dxgi1_6.h>
 #include <dxgidebug.h>
+#include <algorithm>
+#include <atomic>
 #include <stdint.h>
+#include <utility>
+#include <vector>
 #include <wrl/client.h>
 
 #define CHECK_SUCCESS(s, msg)       \
@@ -44,6 +56,23 @@ namespace Muon
     ID3D12CommandAllocator* gCommandAllocator = nullptr;
     ID3D12GraphicsCommandList* gCommandList = nullptr;
 
+    // Scene draws are recorded on workers, one list per range. Allocators aren't thread safe, so each list has its own.
+    // Whatever follows the parallel section (e.g. the final barriers) goes on the tail list to keep submission order.
+    const uint32_t MAX_RECORD_LISTS = 4;
+    const uint32_t MIN_DRAWS_PER_LIST = 64;
+
+    // The sample scene is one triangle cut into SCENE_SUBDIVISIONS^2 pieces, each its own draw, so there are
+    // enough draws to spread over the record lists. The pieces tile it exactly, so it looks the same as one draw.
+    const uint32_t SCENE_SUBDIVISIONS = 16;
+    const uint32_t SCENE_DRAW_COUNT = SCENE_SUBDIVISIONS * SCENE_SUBDIVISIONS;
+    ID3D12CommandAllocator* gRecordAllocators[MAX_RECORD_LISTS] = {};
+    ID3D12GraphicsCommandList* gRecordLists[MAX_RECORD_LISTS] = {};
+    ID3D12CommandAllocator* gTailAllocator = nullptr;
+    ID3D12GraphicsCommandList* gTailList = nullptr;
+
+    // This frame's lists in the order they must execute
+    std::vector<ID3D12CommandList*> gSubmitLists;
+
     DXGI_FORMAT BackBufferFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
     DXGI_FORMAT DepthStencilFormat = DXGI_FORMAT_D24_UNORM_S8_UINT;
     const int SWAP_CHAIN_BUFFER_COUNT = 2;
@@ -55,17 +84,52 @@ namespace Muon
 
     D3D12_VIEWPORT gViewport = {0};
 
-    ID3D12DescriptorHeap* gRTVHeap = nullptr;
-    ID3D12DescriptorHeap* gDSVHeap = nullptr;
+    // Persistent sizes leave room for offscreen targets; the shader-visible heap also keeps a per-frame ring.
+    const uint32_t RTV_HEAP_SIZE = 16;
+    const uint32_t DSV_HEAP_SIZE = 8;
+    const uint32_t SRV_PERSISTENT_COUNT = 4096;
+    const uint32_t SRV_TRANSIENT_COUNT = 8192;
+
+    DescriptorHeap gRTVHeap;
+    DescriptorHeap gDSVHeap;
+    DescriptorHeap gSRVStagingHeap;
+    DescriptorHeap gSRVHeap;
+
+    DescriptorRange gBackBufferRTVs;
+    DescriptorRange gDepthStencilDSV;
 
     tagRECT gScissorRect;
 
     // TODO: Move these to the main application and generalize them. 
     ID3D12RootSignature* gRootSig = nullptr;
-    ID3D12PipelineState* gPipelineState = nullptr;
+    ID3D12PipelineState* gPipelineState = nullptr; // Owned by gPipelineCache
     ID3D12Resource* gVertexBuffer = nullptr;
     D3D12_VERTEX_BUFFER_VIEW gVertexBufferView;
 
+    // PSOs compile on the job system during init. The blobs and layouts the descs point at must outlive the prewarm.
+    PipelineStateCache gPipelineCache;
+
+    // Rebuilt every frame. gGraphResources maps graph handles to the D3D resources behind them.
+    Renderer::RenderGraph gFrameGraph;
+    std::vector<ID3D12Resource*> gGraphResources;
+    Core::JobCounter gPipelinePrewarm;
+    Microsoft::WRL::ComPtr<ID3DBlob> gSimpleVSBlob;
+    Microsoft::WRL::ComPtr<ID3DBlob> gSimplePSBlob;
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC gSimplePSODesc = {};
+
+#if defined(MN_ENABLE_PROFILER)
+    // Times the frame and each graph pass onto the profiler's GPU track. A frame is read back once the
+    // fence has passed it, checked at the end of a later frame rather than waited for.
+    Renderer::D3D12Timestamps gTimestamps;
+    Renderer::GPUProfiler gGPUProfiler;
+#endif
+
+    const D3D12_INPUT_ELEMENT_DESC SIMPLE_INPUT_LAYOUT[] =
+    {
+        { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+        { "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
+    };
+
     /////////////////////////////////////////////////////////////////////
     // Accessors
 
@@ -81,22 +145,21 @@ namespace Muon
     IDXGISwapChain3* GetSwapChain() { return gSwapChain.Get(); }
     DXGI_FORMAT GetBackBufferFormat() { return BackBufferFormat; }
     DXGI_FORMAT GetDepthStencilFormat() { return DepthStencilFormat; }
+    DescriptorHeap& GetSRVHeap() { return gSRVHeap; }
+    DescriptorHeap& GetSRVStagingHeap() { return gSRVStagingHeap; }
+    PipelineStateCache& GetPipelineCache() { return gPipelineCache; }
 
     /////////////////////////////////////////////////////////////////////
     /// Interface Utility Functions
 
     D3D12_CPU_DESCRIPTOR_HANDLE CurrentBackBufferView()
     {
-        return CD3DX12_CPU_DESCRIPTOR_HANDLE(
-            gRTVHeap->GetCPUDescriptorHandleForHeapStart(),
-            CurrentBackBuffer,
-            gRTVSize
-        );
+        return gRTVHeap.GetCPUHandle(gBackBufferRTVs.Offset + CurrentBackBuffer);
     }
 
     D3D12_CPU_DESCRIPTOR_HANDLE DepthStencilView()
     {
-        return gDSVHeap->GetCPUDescriptorHandleForHeapStart();
+        return gDSVHeap.GetCPUHandle(gDepthStencilDSV.Offset);
     }
 
     /////////////////////////////////////////////////////////////////////
@@ -286,6 +349,28 @@ namespace Muon
         return SUCCEEDED(hr);
     }
 
+    bool CreateRecordingCommandLists(ID3D12Device* pDevice)
+    {
+        auto createPair = [pDevice](ID3D12CommandAllocator** out_alloc, ID3D12GraphicsCommandList** out_list)
+        {
+            HRESULT hr = pDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(out_alloc));
+            COM_EXCEPT(hr);
+
+            hr = pDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, *out_alloc, nullptr, IID_PPV_ARGS(out_list));
+            COM_EXCEPT(hr);
+
+            // Closed until the frame that uses them resets them
+            (*out_list)->Close();
+            return SUCCEEDED(hr);
+        };
+
+        bool success = createPair(&gTailAllocator, &gTailList);
+        for (uint32_t i = 0; i != MAX_RECORD_LISTS; ++i)
+            success &= createPair(&gRecordAllocators[i], &gRecordLists[i]);
+
+        return success;
+    }
+
     bool CreateSwapChain(ID3D12Device* pDevice, IDXGIFactory6* pFactory, ID3D12CommandQueue* pQueue, HWND hwnd, int width, int height, Microsoft::WRL::ComPtr<IDXGISwapChain3>& out_swapchain)
     {
         // Release the previous swapchain we will be recreating.
@@ -322,41 +407,34 @@ namespace Muon
         return SUCCEEDED(hr);
     }
 
-    bool CreateDescriptorHeaps(ID3D12Device* pDevice, ID3D12DescriptorHeap** out_rtv, ID3D12DescriptorHeap** out_dsv)
+    bool CreateDescriptorHeaps(ID3D12Device* pDevice)
     {
-        D3D12_DESCRIPTOR_HEAP_DESC rtvHeapDesc;
-        rtvHeapDesc.NumDescriptors = SWAP_CHAIN_BUFFER_COUNT;
-        rtvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
-        rtvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
-        rtvHeapDesc.NodeMask = 0;
+        bool success = true;
+        success &= gRTVHeap.Init(pDevice, D3D12_DESCRIPTOR_HEAP_TYPE_RTV, RTV_HEAP_SIZE, 0, false);
+        success &= gDSVHeap.Init(pDevice, D3D12_DESCRIPTOR_HEAP_TYPE_DSV, DSV_HEAP_SIZE, 0, false);
 
-        HRESULT hr = pDevice->CreateDescriptorHeap(
-            &rtvHeapDesc, IID_PPV_ARGS(out_rtv));
-        COM_EXCEPT(hr);
+        // Descriptors are authored into the CPU-only staging heap, then copied into the shader-visible one
+        success &= gSRVStagingHeap.Init(pDevice, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, SRV_PERSISTENT_COUNT, 0, false);
+        success &= gSRVHeap.Init(pDevice, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, SRV_PERSISTENT_COUNT, SRV_TRANSIENT_COUNT, true);
 
-        D3D12_DESCRIPTOR_HEAP_DESC dsvHeapDesc;
-        dsvHeapDesc.NumDescriptors = 1;
-        dsvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_DSV;
-        dsvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
-        dsvHeapDesc.NodeMask = 0;
-        hr = pDevice->CreateDescriptorHeap(
-            &dsvHeapDesc, IID_PPV_ARGS(out_dsv));
-        COM_EXCEPT(hr);
+        if (!success)
+            return false;
 
-        return SUCCEEDED(hr);
+        gBackBufferRTVs = gRTVHeap.AllocatePersistent(SWAP_CHAIN_BUFFER_COUNT);
+        gDepthStencilDSV = gDSVHeap.AllocatePersistent(1);
+
+        return gBackBufferRTVs.IsValid() && gDepthStencilDSV.IsValid();
     }
 
     bool CreateRenderTargetView(ID3D12Device* pDevice, IDXGISwapChain3* pSwapChain, ID3D12Resource* pSwapChainBuffers[SWAP_CHAIN_BUFFER_COUNT])
     {
-        CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHandle(gRTVHeap->GetCPUDescriptorHandleForHeapStart());
         HRESULT hr;
         for (UINT i = 0; i != SWAP_CHAIN_BUFFER_COUNT; ++i)
         {
             hr = pSwapChain->GetBuffer(i, IID_PPV_ARGS(&pSwapChainBuffers[i]));
             COM_EXCEPT(hr);
 
-            pDevice->CreateRenderTargetView(pSwapChainBuffers[i], nullptr, rtvHandle);
-            rtvHandle.Offset(1, gRTVSize);
+            pDevice->CreateRenderTargetView(pSwapChainBuffers[i], nullptr, gRTVHeap.GetCPUHandle(gBackBufferRTVs.Offset + i));
         }
 
         return true;
@@ -462,34 +540,30 @@ namespace Muon
         hr = pDevice->CreateRootSignature(0, signature->GetBufferPointer(), signature->GetBufferSize(), IID_PPV_ARGS(out_sig));
         COM_EXCEPT(hr);
 
+        gPipelineCache.RegisterRootSignature(*out_sig, signature->GetBufferPointer(), signature->GetBufferSize());
+
         return SUCCEEDED(hr);
     }
 
-    bool LoadShaders(ID3D12Device* pDevice, ID3D12GraphicsCommandList* pCommandList, ID3D12RootSignature* pRootSignature, ID3D12PipelineState** out_state)
+    // Loads the shaders and queues their PSOs on the job system. Call FinishLoadingShaders before drawing.
+    bool LoadShaders(ID3D12RootSignature* pRootSignature)
     {
         // Load simple shaders from file
         static const std::wstring VS_PATH = SHADERPATHW "SimpleVS.cso";
         static const std::wstring PS_PATH = SHADERPATHW "SimplePS.cso";
-        Microsoft::WRL::ComPtr<ID3DBlob> pVSBlob;
-        Microsoft::WRL::ComPtr<ID3DBlob> pPSBlob;
-        HRESULT hr = D3DReadFileToBlob(VS_PATH.c_str(), pVSBlob.GetAddressOf());
+        HRESULT hr = D3DReadFileToBlob(VS_PATH.c_str(), gSimpleVSBlob.ReleaseAndGetAddressOf());
         COM_EXCEPT(hr);
 
-        hr = D3DReadFileToBlob(PS_PATH.c_str(), pPSBlob.GetAddressOf());
+        hr = D3DReadFileToBlob(PS_PATH.c_str(), gSimplePSBlob.ReleaseAndGetAddressOf());
         COM_EXCEPT(hr);
 
-        D3D12_INPUT_ELEMENT_DESC inputElementDescs[] =
-        {
-            { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-            { "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
-        };
-
-        // Describe and create the graphics pipeline state object (PSO).
-        D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
-        psoDesc.InputLayout = { inputElementDescs, _countof(inputElementDescs) };
+        // Describe the graphics pipeline state object (PSO).
+        D3D12_GRAPHICS_PIPELINE_STATE_DESC& psoDesc = gSimplePSODesc;
+        psoDesc = {};
+        psoDesc.InputLayout = { SIMPLE_INPUT_LAYOUT, _countof(SIMPLE_INPUT_LAYOUT) };
         psoDesc.pRootSignature = pRootSignature;
-        psoDesc.VS = CD3DX12_SHADER_BYTECODE(pVSBlob.Get());
-        psoDesc.PS = CD3DX12_SHADER_BYTECODE(pPSBlob.Get());
+        psoDesc.VS = CD3DX12_SHADER_BYTECODE(gSimpleVSBlob.Get());
+        psoDesc.PS = CD3DX12_SHADER_BYTECODE(gSimplePSBlob.Get());
         psoDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
         psoDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
         psoDesc.DepthStencilState.DepthEnable = FALSE;
@@ -500,11 +574,19 @@ namespace Muon
         psoDesc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM;
         psoDesc.SampleDesc.Count = 1;
 
-        hr = pDevice->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(out_state));
-        COM_EXCEPT(hr);
+        gPipelineCache.Prewarm(&gSimplePSODesc, 1, gPipelinePrewarm);
 
         return SUCCEEDED(hr);
     }
+
+    bool FinishLoadingShaders(ID3D12PipelineState** out_state)
+    {
+        Core::JobSystem::Wait(gPipelinePrewarm);
+
+        // Already built by the prewarm, this is just a lookup
+        *out_state = gPipelineCache.GetOrCreate(gSimplePSODesc);
+        return *out_state != nullptr;
+    }
     
     bool CreateVertexBuffer(ID3D12Device* pDevice, float aspectRatio, D3D12_VERTEX_BUFFER_VIEW* out_vboView, ID3D12Resource** out_vbo)
     {
@@ -514,14 +596,45 @@ namespace Muon
             float Col[4];
         };
 
-        Vertex triangleVertices[] =
+        const Vertex corners[] =
         {
             { { 0.0f, 0.25f * aspectRatio, 0.0f }, { 1.0f, 0.0f, 0.0f, 1.0f } },
             { { 0.25f, -0.25f * aspectRatio, 0.0f }, { 0.0f, 1.0f, 0.0f, 1.0f } },
             { { -0.25f, -0.25f * aspectRatio, 0.0f }, { 0.0f, 0.0f, 1.0f, 1.0f } }
         };
 
-        const UINT vertexBufferSize = sizeof(triangleVertices);
+        // Point (i, j) of the grid is i steps from the top corner towards the right one and j towards the left
+        const float step = 1.0f / SCENE_SUBDIVISIONS;
+        auto gridVertex = [&corners, step](uint32_t i, uint32_t j)
+        {
+            const float weights[3] = { 1.0f - (i + j) * step, i * step, j * step };
+
+            Vertex v = {};
+            for (uint32_t c = 0; c != 3; ++c)
+            {
+                for (uint32_t k = 0; k != 3; ++k)
+                    v.Pos[k] += weights[c] * corners[c].Pos[k];
+                for (uint32_t k = 0; k != 4; ++k)
+                    v.Col[k] += weights[c] * corners[c].Col[k];
+            }
+            return v;
+        };
+
+        // Every piece keeps the corners' winding, and together they cover the triangle once
+        std::vector<Vertex> triangleVertices;
+        triangleVertices.reserve(SCENE_DRAW_COUNT * 3);
+        for (uint32_t i = 0; i != SCENE_SUBDIVISIONS; ++i)
+        {
+            for (uint32_t j = 0; i + j != SCENE_SUBDIVISIONS; ++j)
+            {
+                triangleVertices.insert(triangleVertices.end(), { gridVertex(i, j), gridVertex(i + 1, j), gridVertex(i, j + 1) });
+                if (i + j + 1 != SCENE_SUBDIVISIONS)
+                    triangleVertices.insert(triangleVertices.end(), { gridVertex(i + 1, j), gridVertex(i + 1, j + 1), gridVertex(i, j + 1) });
+            }
+        }
+        assert(triangleVertices.size() == SCENE_DRAW_COUNT * 3);
+
+        const UINT vertexBufferSize = (UINT)(triangleVertices.size() * sizeof(Vertex));
         HRESULT hr = pDevice->CreateCommittedResource(
             &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
             D3D12_HEAP_FLAG_NONE,
@@ -536,7 +649,7 @@ namespace Muon
         UINT8* pDataBegin;
         CD3DX12_RANGE readRange(0, 0);        // We do not intend to read from this resource on the CPU.
         hr = (*out_vbo)->Map(0, &readRange, reinterpret_cast<void**>(&pDataBegin));
-        memcpy(pDataBegin, triangleVertices, sizeof(triangleVertices));
+        memcpy(pDataBegin, triangleVertices.data(), vertexBufferSize);
         (*out_vbo)->Unmap(0, nullptr);
         COM_EXCEPT(hr);
 
@@ -550,8 +663,155 @@ namespace Muon
     
     /////////////////////////////////////////////////////////////////////
 
+    D3D12_RESOURCE_STATES ToD3D12State(Renderer::RGState state)
+    {
+        using Renderer::RGState;
+        switch (state)
+        {
+        case RGState::RENDER_TARGET:    return D3D12_RESOURCE_STATE_RENDER_TARGET;
+        case RGState::DEPTH_WRITE:      return D3D12_RESOURCE_STATE_DEPTH_WRITE;
+        case RGState::DEPTH_READ:       return D3D12_RESOURCE_STATE_DEPTH_READ;
+        case RGState::SHADER_READ:      return D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+        case RGState::UNORDERED_ACCESS: return D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+        case RGState::COPY_SOURCE:      return D3D12_RESOURCE_STATE_COPY_SOURCE;
+        case RGState::COPY_DEST:        return D3D12_RESOURCE_STATE_COPY_DEST;
+        case RGState::PRESENT:          return D3D12_RESOURCE_STATE_PRESENT;
+        default:                        return D3D12_RESOURCE_STATE_COMMON;
+        }
+    }
+
+    // Turns one batch from the graph into a single ResourceBarrier call
+    void RecordGraphBarriers(Renderer::RGBarrier const* pBarriers, uint32_t count, ID3D12GraphicsCommandList* pCommandList)
+    {
+        const uint32_t MAX_BATCH = 16;
+        D3D12_RESOURCE_BARRIER barriers[MAX_BATCH];
+        uint32_t batched = 0;
+
+        for (uint32_t i = 0; i != count; ++i)
+        {
+            Renderer::RGBarrier const& b = pBarriers[i];
+            ID3D12Resource* pResource = gGraphResources[b.Resource];
+
+            if (b.Before == Renderer::RGState::UNDEFINED)
+                barriers[batched++] = CD3DX12_RESOURCE_BARRIER::Aliasing(nullptr, pResource);
+            else if (b.Before == b.After)
+                barriers[batched++] = CD3DX12_RESOURCE_BARRIER::UAV(pResource);
+            else
+                barriers[batched++] = CD3DX12_RESOURCE_BARRIER::Transition(pResource, ToD3D12State(b.Before), ToD3D12State(b.After));
+
+            if (batched == MAX_BATCH || i + 1 == count)
+            {
+                pCommandList->ResourceBarrier(batched, barriers);
+                batched = 0;
+            }
+        }
+    }
+
+    // Where the serial parts of the frame are currently recording. Swapped for the tail list after a parallel section.
+    struct FrameRecording
+    {
+        ID3D12GraphicsCommandList* pCurrent;
+        bool Failed;
+    };
+
+    void RecordSceneDraws(ID3D12GraphicsCommandList* pCommandList, uint32_t begin, uint32_t end)
+    {
+        pCommandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        pCommandList->IASetVertexBuffers(0, 1, &gVertexBufferView);
+
+        for (uint32_t i = begin; i != end; ++i)
+            pCommandList->DrawInstanced(3, 1, i * 3, 0);
+    }
+
+    // Fresh command lists inherit nothing, so every worker list sets up the same state the main list has
+    void BeginWorkerList(ID3D12GraphicsCommandList* pCommandList)
+    {
+        ID3D12DescriptorHeap* heaps[] = { gSRVHeap.GetHeap() };
+        pCommandList->SetDescriptorHeaps(_countof(heaps), heaps);
+        pCommandList->SetGraphicsRootSignature(gRootSig);
+        pCommandList->RSSetViewports(1, &gViewport);
+        pCommandList->RSSetScissorRects(1, &gScissorRect);
+
+        D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle = CurrentBackBufferView();
+        pCommandList->OMSetRenderTargets(1, &rtvHandle, FALSE, nullptr);
+    }
+
+    void RecordSceneParallel(FrameRecording& frame)
+    {
+        using namespace Renderer;
+
+        RecordRange ranges[MAX_RECORD_LISTS];
+        const uint32_t rangeCount = PartitionRecordRanges(nullptr, SCENE_DRAW_COUNT, MAX_RECORD_LISTS, MIN_DRAWS_PER_LIST, ranges);
+        if (rangeCount <= 1)
+        {
+            RecordSceneDraws(frame.pCurrent, 0, SCENE_DRAW_COUNT);
+            return;
+        }
+
+        // Everything recorded so far (barriers, the clear) has to execute before the worker lists
+        HRESULT hr = frame.pCurrent->Close();
+        gSubmitLists.push_back(frame.pCurrent);
+
+        std::atomic<bool> failed(FAILED(hr));
+        Core::JobCounter counter;
+        Core::JobSystem::Dispatch(counter, rangeCount, 1, [&](uint32_t first, uint32_t last)
+        {
+            for (uint32_t r = first; r != last; ++r)
+            {
+                ID3D12GraphicsCommandList* pList = gRecordLists[r];
+                if (FAILED(gRecordAllocators[r]->Reset()) || FAILED(pList->Reset(gRecordAllocators[r], gPipelineState)))
+                {
+                    failed = true;
+                    continue;
+                }
+
+                BeginWorkerList(pList);
+                RecordSceneDraws(pList, ranges[r].Begin, ranges[r].End);
+
+                if (FAILED(pList->Close()))
+                    failed = true;
+            }
+        });
+        Core::JobSystem::Wait(counter);
+
+        // Range order, not completion order
+        for (uint32_t r = 0; r != rangeCount; ++r)
+            gSubmitLists.push_back(gRecordLists[r]);
+
+        if (FAILED(gTailAllocator->Reset()) || FAILED(gTailList->Reset(gTailAllocator, gPipelineState)))
+            failed = true;
+
+        BeginWorkerList(gTailList);
+        frame.pCurrent = gTailList;
+        frame.Failed |= failed.load();
+    }
+
+    // Declares a pass on this frame's graph and times it on the GPU. Passes may move frame.pCurrent on to
+    // another list, so the scope ends on whichever one the pass finished recording into.
+    Renderer::RGPass AddTimedPass(const char* name, Renderer::RenderGraph::ExecuteFn execute)
+    {
+#if defined(MN_ENABLE_PROFILER)
+        return gFrameGraph.AddPass(name, [name, execute](void* pContext)
+        {
+            FrameRecording& frame = *static_cast<FrameRecording*>(pContext);
+
+            gTimestamps.SetCommandList(frame.pCurrent);
+            const uint32_t scope = gGPUProfiler.BeginScope(gTimestamps, name);
+
+            execute(pContext);
+
+            gTimestamps.SetCommandList(frame.pCurrent);
+            gGPUProfiler.EndScope(gTimestamps, scope);
+        });
+#else
+        return gFrameGraph.AddPass(name, std::move(execute));
+#endif
+    }
+
     bool PopulateCommandList()
     {
+        using namespace Renderer;
+
         ID3D12CommandAllocator* pAllocator = GetCommandAllocator();
         ID3D12GraphicsCommandList* pCommandList = GetCommandList();
 
@@ -564,29 +824,63 @@ namespace Muon
         hr = pCommandList->Reset(pAllocator, gPipelineState);
         COM_EXCEPT(hr);
 
+#if defined(MN_ENABLE_PROFILER)
+        // WaitForPreviousFrame signals gFenceVal once this frame's lists are submitted
+        gTimestamps.SetFrameFence(gFenceVal);
+        gTimestamps.SetCommandList(pCommandList);
+        gGPUProfiler.BeginFrame();
+#endif
+
+        gSubmitLists.clear();
+
+        ID3D12DescriptorHeap* heaps[] = { gSRVHeap.GetHeap() };
+        pCommandList->SetDescriptorHeaps(_countof(heaps), heaps);
+
         pCommandList->SetGraphicsRootSignature(gRootSig);
         pCommandList->RSSetViewports(1, &gViewport);
         pCommandList->RSSetScissorRects(1, &gScissorRect);
 
-        // Set back buffer as render target
-        pCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(gSwapChainBuffers[CurrentBackBuffer], D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET));
+        // Declare this frame's passes. The graph derives the back buffer transitions around them.
+        gFrameGraph.Reset();
+        gGraphResources.clear();
 
-        CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHandle(gRTVHeap->GetCPUDescriptorHandleForHeapStart(), CurrentBackBuffer, gRTVSize);
-        pCommandList->OMSetRenderTargets(1, &rtvHandle, FALSE, nullptr);
+        const RGTextureDesc backBufferDesc = { (uint32_t)gViewport.Width, (uint32_t)gViewport.Height, (uint32_t)BackBufferFormat, 4, 1 };
+        RGResource backBuffer = gFrameGraph.ImportTexture("BackBuffer", backBufferDesc, RGState::PRESENT, RGState::PRESENT);
+        gGraphResources.push_back(gSwapChainBuffers[CurrentBackBuffer]);
 
-        // Record commands
-        const float clearColor[] = { 0.0f, 0.2f, 0.4f, 1.0f };
-        pCommandList->ClearRenderTargetView(rtvHandle, clearColor, 0, nullptr);
-        pCommandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-        pCommandList->IASetVertexBuffers(0, 1, &gVertexBufferView);
-        pCommandList->DrawInstanced(3, 1, 0, 0);
+        RGPass forward = AddTimedPass("Forward", [](void* pContext)
+        {
+            FrameRecording& frame = *static_cast<FrameRecording*>(pContext);
 
-        // Now set back buffer as present target
-        pCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(gSwapChainBuffers[CurrentBackBuffer], D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT));
+            D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle = CurrentBackBufferView();
+            frame.pCurrent->OMSetRenderTargets(1, &rtvHandle, FALSE, nullptr);
 
-        hr = pCommandList->Close();
+            // Record commands
+            const float clearColor[] = { 0.0f, 0.2f, 0.4f, 1.0f };
+            frame.pCurrent->ClearRenderTargetView(rtvHandle, clearColor, 0, nullptr);
 
-        return SUCCEEDED(hr);
+            RecordSceneParallel(frame);
+        });
+        gFrameGraph.Write(forward, backBuffer, RGState::RENDER_TARGET);
+
+        FrameRecording frame = { pCommandList, false };
+
+        gFrameGraph.Compile();
+        gFrameGraph.Execute(&frame, [](RGBarrier const* pBarriers, uint32_t count, void* pContext)
+        {
+            RecordGraphBarriers(pBarriers, count, static_cast<FrameRecording*>(pContext)->pCurrent);
+        });
+
+#if defined(MN_ENABLE_PROFILER)
+        // Also reads back whichever earlier frames the GPU has finished with, without waiting on the rest
+        gTimestamps.SetCommandList(frame.pCurrent);
+        gGPUProfiler.EndFrame();
+#endif
+
+        hr = frame.pCurrent->Close();
+        gSubmitLists.push_back(frame.pCurrent);
+
+        return SUCCEEDED(hr) && !frame.Failed;
     }
 
     bool ExecuteCommandList()
@@ -594,8 +888,12 @@ namespace Muon
         if (!GetCommandList())
             return false;
 
-        ID3D12CommandList* lists[] = { GetCommandList() };
-        GetCommandQueue()->ExecuteCommandLists(_countof(lists), lists);
+        // Outside of a frame (e.g. during init) only the main list has anything in it
+        if (gSubmitLists.empty())
+            gSubmitLists.push_back(GetCommandList());
+
+        GetCommandQueue()->ExecuteCommandLists((UINT)gSubmitLists.size(), gSubmitLists.data());
+        gSubmitLists.clear();
         return true;
     }
 
@@ -611,16 +909,23 @@ namespace Muon
     // This is not good but just doing this for testing DX12 Initialization...
     bool WaitForPreviousFrame()
     {
+        MN_PROFILE_FUNCTION();
+
         const UINT64 currFence = gFenceVal;
         HRESULT hr = GetCommandQueue()->Signal(gFence, currFence);
         gFenceVal++;
 
+        // Transient descriptors written this frame stay alive until the GPU passes currFence
+        gSRVHeap.EndFrame(currFence);
+
         if (gFence->GetCompletedValue() < currFence)
         {
             hr = gFence->SetEventOnCompletion(currFence, gFenceEvt);
             WaitForSingleObject(gFenceEvt, INFINITE);
         }
 
+        gSRVHeap.Retire(gFence->GetCompletedValue());
+
         CurrentBackBuffer = GetSwapChain()->GetCurrentBackBufferIndex();
 
         return SUCCEEDED(hr);
@@ -666,19 +971,30 @@ namespace Muon
         success &= GetDescriptorSizes(GetDevice(), &gRTVSize, &gDSVSize, &gCBVSize);
         CHECK_SUCCESS(success, "Error: Failed to get descriptor sizes!");
 
+        success &= gPipelineCache.Init(GetDevice(), PIPELINELIBRARYPATHW);
+        CHECK_SUCCESS(success, "Error: Failed to create pipeline state cache!");
+
         //success &= DetermineMSAAQuality(GetDevice(), &gMSAAQuality);
         //CHECK_SUCCESS(success, "Error: Failed to determine MSAA quality!");
 
         success &= CreateCommandObjects(GetDevice(), &gCommandQueue, &gCommandAllocator, &gCommandList);
         CHECK_SUCCESS(success, "Error: Failed to create command objects!");
 
+        success &= CreateRecordingCommandLists(GetDevice());
+        CHECK_SUCCESS(success, "Error: Failed to create recording command lists!");
+
         success &= CreateSwapChain(GetDevice(), dxgiFactory.Get(), GetCommandQueue(), hwnd, width, height, gSwapChain);
         CHECK_SUCCESS(success, "Error: Failed to create swap chain!");
 
         success &= CreateFence(GetDevice(), &gFence);
         CHECK_SUCCESS(success, "Error: Failed to create fence!");
 
-        success &= CreateDescriptorHeaps(GetDevice(), &gRTVHeap, &gDSVHeap);
+#if defined(MN_ENABLE_PROFILER)
+        success &= gTimestamps.Init(GetDevice(), GetCommandQueue(), gFence) && gGPUProfiler.Init(&gTimestamps);
+        CHECK_SUCCESS(success, "Error: Failed to create timestamp queries!");
+#endif
+
+        success &= CreateDescriptorHeaps(GetDevice());
         CHECK_SUCCESS(success, "Error: Failed to create descriptor heaps!");
 
         success &= CreateRenderTargetView(GetDevice(), GetSwapChain(), gSwapChainBuffers);
@@ -697,12 +1013,15 @@ namespace Muon
         success &= CreateRootSig(GetDevice(), &gRootSig);
         CHECK_SUCCESS(success, "Error: Failed to create root signature.");
 
-        success &= LoadShaders(GetDevice(), GetCommandList(), gRootSig, &gPipelineState);
+        success &= LoadShaders(gRootSig);
         CHECK_SUCCESS(success, "Error: Failed to load shaders.");
 
         success &= CreateVertexBuffer(GetDevice(), (float)width / (float)height, &gVertexBufferView, &gVertexBuffer);
         CHECK_SUCCESS(success, "Error: Failed create vertex buffer.");
 
+        success &= FinishLoadingShaders(&gPipelineState);
+        CHECK_SUCCESS(success, "Error: Failed to create pipeline state.");
+
         // We've written a bunch of commands, close the list and execute it.
         hr = GetCommandList()->Close();
         COM_EXCEPT(hr);
@@ -712,5 +1031,41 @@ namespace Muon
         return success;
     }
 
+    void Shutdown()
+    {
+        if (!gDevice)
+            return;
+
+        // Nothing may still reference the PSOs or heaps
+        Core::JobSystem::Wait(gPipelinePrewarm);
+        WaitForPreviousFrame();
+
+        gPipelineState = nullptr;
+        gPipelineCache.Shutdown();
+
+        for (uint32_t i = 0; i != MAX_RECORD_LISTS; ++i)
+        {
+            if (gRecordLists[i])
+                gRecordLists[i]->Release();
+            if (gRecordAllocators[i])
+                gRecordAllocators[i]->Release();
+        }
+
+        if (gTailList)
+            gTailList->Release();
+        if (gTailAllocator)
+            gTailAllocator->Release();
+
+#if defined(MN_ENABLE_PROFILER)
+        gGPUProfiler.Shutdown();
+        gTimestamps.Shutdown();
+#endif
+
+        gSRVHeap.Destroy();
+        gSRVStagingHeap.Destroy();
+        gDSVHeap.Destroy();
+        gRTVHeap.Destroy();
+    }
+
 #undef CHECK_SUCCESS
 }
\ No newline at end of file
@@ -26,6 +26,7 @@ namespace Muon
 	bool WaitForPreviousFrame();
 
 	bool Initialize(HWND hwnd, int width, int height);
+	void Shutdown();
 }
 
 #endif
\ No newline at end of file
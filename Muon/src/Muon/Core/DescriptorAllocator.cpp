@@ -0,0 +1,260 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of DescriptorAllocator.h
+----------------------------------------------*/
+#include "DescriptorAllocator.h"
+
+#include <algorithm>
+#include <assert.h>
+
+namespace Muon
+{
+    /////////////////////////////////////////////////////////////////////
+    // DescriptorFreeList
+
+    void DescriptorFreeList::Init(uint32_t baseOffset, uint32_t capacity)
+    {
+        mFreeBlocks.clear();
+        mFreeBlocks.push_back({ baseOffset, capacity });
+
+        mStats = DescriptorAllocatorStats();
+        mStats.Capacity = capacity;
+        RefreshFreeBlockStats();
+    }
+
+    DescriptorRange DescriptorFreeList::Allocate(uint32_t count)
+    {
+        assert(count != 0);
+
+        // Best fit keeps the big blocks around for the big tables
+        size_t bestIdx = mFreeBlocks.size();
+        for (size_t i = 0; i != mFreeBlocks.size(); ++i)
+        {
+            const uint32_t blockCount = mFreeBlocks[i].Count;
+            if (blockCount < count)
+                continue;
+
+            if (bestIdx == mFreeBlocks.size() || blockCount < mFreeBlocks[bestIdx].Count)
+                bestIdx = i;
+
+            if (blockCount == count)
+                break;
+        }
+
+        if (bestIdx == mFreeBlocks.size())
+        {
+            mStats.FailedAllocations++;
+            return DescriptorRange();
+        }
+
+        DescriptorRange& block = mFreeBlocks[bestIdx];
+        DescriptorRange out = { block.Offset, count };
+        block.Offset += count;
+        block.Count  -= count;
+
+        if (block.Count == 0)
+            mFreeBlocks.erase(mFreeBlocks.begin() + bestIdx);
+
+        mStats.Allocated += count;
+        mStats.HighWater = std::max(mStats.HighWater, mStats.Allocated);
+        mStats.TotalAllocations++;
+        RefreshFreeBlockStats();
+
+        return out;
+    }
+
+    void DescriptorFreeList::Free(DescriptorRange range)
+    {
+        if (!range.IsValid())
+            return;
+
+        auto it = std::lower_bound(mFreeBlocks.begin(), mFreeBlocks.end(), range,
+            [](DescriptorRange const& a, DescriptorRange const& b) { return a.Offset < b.Offset; });
+
+        // Catch double frees and frees of ranges we never handed out
+        assert(it == mFreeBlocks.end() || range.Offset + range.Count <= it->Offset);
+        assert(it == mFreeBlocks.begin() || (it - 1)->Offset + (it - 1)->Count <= range.Offset);
+
+        it = mFreeBlocks.insert(it, range);
+
+        // Merge with the following block
+        auto next = it + 1;
+        if (next != mFreeBlocks.end() && it->Offset + it->Count == next->Offset)
+        {
+            it->Count += next->Count;
+            mFreeBlocks.erase(next);
+        }
+
+        // Merge with the preceding block
+        if (it != mFreeBlocks.begin())
+        {
+            auto prev = it - 1;
+            if (prev->Offset + prev->Count == it->Offset)
+            {
+                prev->Count += it->Count;
+                mFreeBlocks.erase(it);
+            }
+        }
+
+        mStats.Allocated -= range.Count;
+        mStats.TotalFrees++;
+        RefreshFreeBlockStats();
+    }
+
+    void DescriptorFreeList::RefreshFreeBlockStats()
+    {
+        uint32_t largest = 0;
+        for (DescriptorRange const& block : mFreeBlocks)
+            largest = std::max(largest, block.Count);
+
+        mStats.FreeBlockCount   = (uint32_t)mFreeBlocks.size();
+        mStats.LargestFreeBlock = largest;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // DescriptorRing
+
+    void DescriptorRing::Init(uint32_t baseOffset, uint32_t capacity)
+    {
+        mBase = baseOffset;
+        mSize = capacity;
+        mHead = 0;
+        mTail = 0;
+        mUsed = 0;
+        mOpenFrameCount = 0;
+        mWastedAtWrap = 0;
+        mFrameFirst = 0;
+        mFrameCount = 0;
+
+        mStats = DescriptorAllocatorStats();
+        mStats.Capacity = capacity;
+        RefreshStats();
+    }
+
+    DescriptorRange DescriptorRing::Allocate(uint32_t count)
+    {
+        assert(count != 0);
+
+        if (mUsed == 0)
+        {
+            // Nothing is live, so start over at zero. Any frames still queued are empty, but their markers
+            // hold the old head and would drag the tail back there when they retire.
+            mHead = mTail = 0;
+            for (uint32_t i = 0; i != mFrameCount; ++i)
+                mFrames[(mFrameFirst + i) % kMaxFramesInFlight].End = 0;
+        }
+
+        const bool headAhead = mHead > mTail || mUsed == 0;
+        uint32_t start = UINT32_MAX;
+
+        if (headAhead)
+        {
+            if (mSize - mHead >= count)
+            {
+                start = mHead;
+            }
+            else if (mTail >= count)
+            {
+                // Not enough room before the end: burn the remainder and restart at zero
+                const uint32_t waste = mSize - mHead;
+                mUsed += waste;
+                mOpenFrameCount += waste;
+                mWastedAtWrap += waste;
+                start = 0;
+            }
+        }
+        else if (mTail - mHead >= count)
+        {
+            start = mHead;
+        }
+
+        if (start == UINT32_MAX)
+        {
+            mStats.FailedAllocations++;
+            return DescriptorRange();
+        }
+
+        mHead = start + count;
+        if (mHead == mSize)
+            mHead = 0;
+
+        mUsed += count;
+        mOpenFrameCount += count;
+
+        mStats.HighWater = std::max(mStats.HighWater, mUsed);
+        mStats.TotalAllocations++;
+        RefreshStats();
+
+        return { mBase + start, count };
+    }
+
+    void DescriptorRing::EndFrame(uint64_t fenceValue)
+    {
+        if (mFrameCount == kMaxFramesInFlight)
+        {
+            // More frames in flight than we can track; fold this one into the newest marker
+            assert(false && "DescriptorRing: Retire() is not being called");
+            FrameMarker& newest = mFrames[(mFrameFirst + mFrameCount - 1) % kMaxFramesInFlight];
+            newest.FenceValue = fenceValue;
+            newest.End = mHead;
+            newest.Count += mOpenFrameCount;
+        }
+        else
+        {
+            FrameMarker& marker = mFrames[(mFrameFirst + mFrameCount) % kMaxFramesInFlight];
+            marker.FenceValue = fenceValue;
+            marker.End = mHead;
+            marker.Count = mOpenFrameCount;
+            mFrameCount++;
+        }
+
+        mOpenFrameCount = 0;
+    }
+
+    void DescriptorRing::Retire(uint64_t completedFenceValue)
+    {
+        while (mFrameCount)
+        {
+            FrameMarker const& oldest = mFrames[mFrameFirst];
+            if (oldest.FenceValue > completedFenceValue)
+                break;
+
+            mUsed -= oldest.Count;
+            mTail = oldest.End;
+            mStats.TotalFrees++;
+
+            mFrameFirst = (mFrameFirst + 1) % kMaxFramesInFlight;
+            mFrameCount--;
+        }
+
+        RefreshStats();
+    }
+
+    void DescriptorRing::RefreshStats()
+    {
+        mStats.Allocated = mUsed;
+
+        if (mUsed == 0)
+        {
+            mStats.FreeBlockCount = 1;
+            mStats.LargestFreeBlock = mSize;
+        }
+        else if (mUsed == mSize)
+        {
+            mStats.FreeBlockCount = 0;
+            mStats.LargestFreeBlock = 0;
+        }
+        else if (mHead > mTail)
+        {
+            // Free space is split around the live region: [head, end) and [0, tail)
+            mStats.FreeBlockCount = (mHead != mSize ? 1 : 0) + (mTail ? 1 : 0);
+            mStats.LargestFreeBlock = std::max(mSize - mHead, mTail);
+        }
+        else
+        {
+            mStats.FreeBlockCount = 1;
+            mStats.LargestFreeBlock = mTail - mHead;
+        }
+    }
+}
@@ -0,0 +1,107 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Device-independent bookkeeping for descriptor heaps
+A free list for persistent descriptors and a fenced ring for per-frame transient ones.
+Both only hand out index ranges, so they can be driven against a fake heap.
+----------------------------------------------*/
+#ifndef MUON_DESCRIPTORALLOCATOR_H
+#define MUON_DESCRIPTORALLOCATOR_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace Muon
+{
+    struct DescriptorRange
+    {
+        uint32_t Offset = 0;
+        uint32_t Count  = 0;
+
+        bool IsValid() const { return Count != 0; }
+    };
+
+    struct DescriptorAllocatorStats
+    {
+        uint32_t Capacity         = 0;
+        uint32_t Allocated        = 0;
+        uint32_t HighWater        = 0;
+        uint32_t FreeBlockCount   = 0;
+        uint32_t LargestFreeBlock = 0;
+        uint64_t TotalAllocations = 0;
+        uint64_t TotalFrees       = 0;
+        uint64_t FailedAllocations= 0;
+
+        // 0 when all free space is one block, approaching 1 as it splinters
+        float GetFragmentation() const
+        {
+            const uint32_t freeCount = Capacity - Allocated;
+            return freeCount ? 1.0f - (float)LargestFreeBlock / (float)freeCount : 0.0f;
+        }
+    };
+
+    // Best-fit allocation over a sorted list of free blocks. Adjacent blocks coalesce on free.
+    class DescriptorFreeList
+    {
+    public:
+        void Init(uint32_t baseOffset, uint32_t capacity);
+
+        DescriptorRange Allocate(uint32_t count);
+        void            Free(DescriptorRange range);
+
+        const DescriptorAllocatorStats& GetStats() const { return mStats; }
+
+    private:
+        void RefreshFreeBlockStats();
+
+        std::vector<DescriptorRange> mFreeBlocks; // Sorted by offset, never adjacent
+        DescriptorAllocatorStats     mStats;
+    };
+
+    // Linear ring of transient descriptors. Each frame's allocations are retired together once the
+    // GPU has passed the fence value the frame was tagged with. Ranges never wrap around the end.
+    class DescriptorRing
+    {
+    public:
+        static const uint32_t kMaxFramesInFlight = 4;
+
+        void Init(uint32_t baseOffset, uint32_t capacity);
+
+        // Closes the current frame under fenceValue; everything allocated since the last call belongs to it
+        void EndFrame(uint64_t fenceValue);
+
+        // Releases every closed frame whose fence value is <= completedFenceValue
+        void Retire(uint64_t completedFenceValue);
+
+        DescriptorRange Allocate(uint32_t count);
+
+        const DescriptorAllocatorStats& GetStats() const { return mStats; }
+        uint32_t GetWastedAtWrap() const { return mWastedAtWrap; }
+
+    private:
+        void RefreshStats();
+
+        struct FrameMarker
+        {
+            uint64_t FenceValue;
+            uint32_t End;
+            uint32_t Count;
+        };
+
+        uint32_t mBase  = 0;
+        uint32_t mSize  = 0;
+        uint32_t mHead  = 0; // Next free slot (relative to mBase)
+        uint32_t mTail  = 0; // Oldest slot still in use
+        uint32_t mUsed  = 0; // Slots between tail and head, including wrap waste
+        uint32_t mOpenFrameCount = 0;
+        uint32_t mWastedAtWrap   = 0;
+
+        FrameMarker mFrames[kMaxFramesInFlight] = {};
+        uint32_t    mFrameFirst = 0;
+        uint32_t    mFrameCount = 0;
+
+        DescriptorAllocatorStats mStats;
+    };
+}
+
+#endif
@@ -0,0 +1,103 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of DescriptorHeap.h
+----------------------------------------------*/
+#include <Muon.h>
+#include <Muon/Utils/Utils.h>
+#include <Muon/Core/DescriptorHeap.h>
+#include <Muon/Renderer/ThrowMacros.h>
+
+namespace Muon
+{
+    bool DescriptorHeap::Init(ID3D12Device* pDevice, D3D12_DESCRIPTOR_HEAP_TYPE type, uint32_t persistentCount, uint32_t transientCount, bool shaderVisible)
+    {
+        if (!pDevice)
+        {
+            Muon::Print("Error: Failed to create descriptor heap because of null device!");
+            return false;
+        }
+
+        // Only CBV/SRV/UAV and sampler heaps may be bound to the pipeline
+        if (shaderVisible && type != D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV && type != D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER)
+        {
+            Muon::Print("Error: RTV/DSV descriptor heaps cannot be shader visible!");
+            return false;
+        }
+
+        D3D12_DESCRIPTOR_HEAP_DESC heapDesc;
+        heapDesc.NumDescriptors = persistentCount + transientCount;
+        heapDesc.Type = type;
+        heapDesc.Flags = shaderVisible ? D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE : D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+        heapDesc.NodeMask = 0;
+
+        HRESULT hr = pDevice->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&mpHeap));
+        COM_EXCEPT(hr);
+
+        mType = type;
+        mShaderVisible = shaderVisible;
+        mIncrementSize = pDevice->GetDescriptorHandleIncrementSize(type);
+        mCPUStart = mpHeap->GetCPUDescriptorHandleForHeapStart();
+        mGPUStart = shaderVisible ? mpHeap->GetGPUDescriptorHandleForHeapStart() : D3D12_GPU_DESCRIPTOR_HANDLE{ 0 };
+
+        mPersistent.Init(0, persistentCount);
+        mTransient.Init(persistentCount, transientCount);
+
+        return SUCCEEDED(hr);
+    }
+
+    void DescriptorHeap::Destroy()
+    {
+        if (mpHeap)
+            mpHeap->Release();
+
+        mpHeap = nullptr;
+    }
+
+    DescriptorRange DescriptorHeap::AllocatePersistent(uint32_t count)
+    {
+        DescriptorRange range = mPersistent.Allocate(count);
+        if (!range.IsValid())
+            Muon::Print("Error: Persistent descriptor heap is full!\n");
+
+        return range;
+    }
+
+    void DescriptorHeap::FreePersistent(DescriptorRange range)
+    {
+        mPersistent.Free(range);
+    }
+
+    DescriptorRange DescriptorHeap::AllocateTransient(uint32_t count)
+    {
+        DescriptorRange range = mTransient.Allocate(count);
+        if (!range.IsValid())
+            Muon::Print("Error: Transient descriptor ring is full! Is the GPU falling behind?\n");
+
+        return range;
+    }
+
+    DescriptorRange DescriptorHeap::StageTransient(ID3D12Device* pDevice, DescriptorHeap const& staging, DescriptorRange stagingRange)
+    {
+        // Copy sources have to live in a CPU-only heap of the same type
+        assert(!staging.IsShaderVisible() && staging.GetType() == mType);
+
+        DescriptorRange dst = AllocateTransient(stagingRange.Count);
+        if (!dst.IsValid())
+            return dst;
+
+        pDevice->CopyDescriptorsSimple(stagingRange.Count, GetCPUHandle(dst.Offset), staging.GetCPUHandle(stagingRange.Offset), mType);
+        return dst;
+    }
+
+    D3D12_CPU_DESCRIPTOR_HANDLE DescriptorHeap::GetCPUHandle(uint32_t index) const
+    {
+        return CD3DX12_CPU_DESCRIPTOR_HANDLE(mCPUStart, (INT)index, mIncrementSize);
+    }
+
+    D3D12_GPU_DESCRIPTOR_HANDLE DescriptorHeap::GetGPUHandle(uint32_t index) const
+    {
+        assert(mShaderVisible);
+        return CD3DX12_GPU_DESCRIPTOR_HANDLE(mGPUStart, (INT)index, mIncrementSize);
+    }
+}
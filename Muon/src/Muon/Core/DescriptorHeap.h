@@ -0,0 +1,59 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : DX12 descriptor heap split into a persistent free list and a per-frame transient ring
+----------------------------------------------*/
+#ifndef MUON_DESCRIPTORHEAP_H
+#define MUON_DESCRIPTORHEAP_H
+
+#include <d3dx12.h>
+#include <d3d12.h>
+
+#include <Muon/Core/DescriptorAllocator.h>
+
+namespace Muon
+{
+    // Layout: [0, persistentCount) is persistent, [persistentCount, persistentCount + transientCount) is the ring.
+    class DescriptorHeap
+    {
+    public:
+        bool Init(ID3D12Device* pDevice, D3D12_DESCRIPTOR_HEAP_TYPE type, uint32_t persistentCount, uint32_t transientCount, bool shaderVisible);
+        void Destroy();
+
+        // Static resources (texture SRVs, render target views, etc.)
+        DescriptorRange AllocatePersistent(uint32_t count = 1);
+        void            FreePersistent(DescriptorRange range);
+
+        // Valid until the GPU passes the fence of the frame it was allocated in
+        DescriptorRange AllocateTransient(uint32_t count);
+
+        // Copies descriptors authored in a CPU-only staging heap into a transient range of this (shader-visible) heap
+        DescriptorRange StageTransient(ID3D12Device* pDevice, DescriptorHeap const& staging, DescriptorRange stagingRange);
+
+        void EndFrame(uint64_t fenceValue)          { mTransient.EndFrame(fenceValue);          }
+        void Retire(uint64_t completedFenceValue)   { mTransient.Retire(completedFenceValue);   }
+
+        D3D12_CPU_DESCRIPTOR_HANDLE GetCPUHandle(uint32_t index) const;
+        D3D12_GPU_DESCRIPTOR_HANDLE GetGPUHandle(uint32_t index) const;
+
+        ID3D12DescriptorHeap*           GetHeap()            const { return mpHeap;                 }
+        D3D12_DESCRIPTOR_HEAP_TYPE      GetType()            const { return mType;                  }
+        UINT                            GetIncrementSize()   const { return mIncrementSize;         }
+        bool                            IsShaderVisible()    const { return mShaderVisible;         }
+        const DescriptorAllocatorStats& GetPersistentStats() const { return mPersistent.GetStats(); }
+        const DescriptorAllocatorStats& GetTransientStats()  const { return mTransient.GetStats();  }
+
+    private:
+        ID3D12DescriptorHeap*       mpHeap = nullptr;
+        D3D12_CPU_DESCRIPTOR_HANDLE mCPUStart = {};
+        D3D12_GPU_DESCRIPTOR_HANDLE mGPUStart = {};
+        UINT                        mIncrementSize = 0;
+        D3D12_DESCRIPTOR_HEAP_TYPE  mType = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+        bool                        mShaderVisible = false;
+
+        DescriptorFreeList          mPersistent;
+        DescriptorRing              mTransient;
+    };
+}
+
+#endif
@@ -0,0 +1,107 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of EntityCommandBuffer.h
+----------------------------------------------*/
+#include "EntityCommandBuffer.h"
+
+#include <string.h>
+
+namespace Core {
+
+namespace {
+
+// Keeps every header aligned after the components before it
+uint32_t PadToHeader(uint32_t size)
+{
+    return (size + 7) & ~7u;
+}
+
+}
+
+EntityCommandBuffer::EntityCommandBuffer() :
+    mCommandCount(0)
+{
+}
+
+void EntityCommandBuffer::Create(ComponentMask mask, void const* pData)
+{
+    const uint32_t size = pData ? GetPackedComponentSize(mask) : 0;
+    uint8_t* pDest = Push(Command::CREATE, kInvalidEntity, mask, size);
+    if (size)
+        memcpy(pDest, pData, size);
+}
+
+void EntityCommandBuffer::Destroy(EntityID entity)
+{
+    Push(Command::DESTROY, entity, 0, 0);
+}
+
+void EntityCommandBuffer::AddComponents(EntityID entity, ComponentMask mask, void const* pData)
+{
+    const uint32_t size = pData ? GetPackedComponentSize(mask) : 0;
+    uint8_t* pDest = Push(Command::ADD, entity, mask, size);
+    if (size)
+        memcpy(pDest, pData, size);
+}
+
+void EntityCommandBuffer::RemoveComponents(EntityID entity, ComponentMask mask)
+{
+    Push(Command::REMOVE, entity, mask, 0);
+}
+
+uint32_t EntityCommandBuffer::Playback(World& world)
+{
+    uint32_t applied = 0;
+    size_t offset = 0;
+    while (offset != mData.size())
+    {
+        CommandHeader const& command = *reinterpret_cast<CommandHeader const*>(&mData[offset]);
+        const void* pData = command.DataSize ? &mData[offset + sizeof(CommandHeader)] : nullptr;
+
+        switch (command.Type)
+        {
+        case Command::CREATE:
+            world.Create(command.Mask, pData);
+            applied++;
+            break;
+        case Command::DESTROY:
+            applied += world.Destroy(command.Entity) ? 1 : 0;
+            break;
+        case Command::ADD:
+            applied += world.AddComponents(command.Entity, command.Mask, pData) ? 1 : 0;
+            break;
+        case Command::REMOVE:
+            applied += world.RemoveComponents(command.Entity, command.Mask) ? 1 : 0;
+            break;
+        }
+
+        offset += sizeof(CommandHeader) + PadToHeader(command.DataSize);
+    }
+
+    Clear();
+    return applied;
+}
+
+void EntityCommandBuffer::Clear()
+{
+    mData.clear();
+    mCommandCount = 0;
+}
+
+uint8_t* EntityCommandBuffer::Push(Command type, EntityID entity, ComponentMask mask, uint32_t dataSize)
+{
+    const size_t offset = mData.size();
+    mData.resize(offset + sizeof(CommandHeader) + PadToHeader(dataSize));
+
+    CommandHeader& command = *reinterpret_cast<CommandHeader*>(&mData[offset]);
+    command.Type     = type;
+    command.DataSize = dataSize;
+    command.Entity   = entity;
+    command.Mask     = mask;
+
+    mCommandCount++;
+    return &mData[offset + sizeof(CommandHeader)];
+}
+
+}
@@ -0,0 +1,82 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Structural changes to a World, recorded now and made later
+Systems iterating a World can't create, destroy or change the components of
+entities without pulling chunks out from under each other, so they record
+what they want here instead, one buffer per job, and it's all played back
+once the iteration is over.
+----------------------------------------------*/
+#ifndef MUON_ENTITYCOMMANDBUFFER_H
+#define MUON_ENTITYCOMMANDBUFFER_H
+
+#include <Muon/Core/World.h>
+
+#include <stdint.h>
+#include <vector>
+
+namespace Core {
+
+class EntityCommandBuffer
+{
+public:
+    EntityCommandBuffer();
+
+    // Same as the World's, only whenever this is played back
+    void Create(ComponentMask mask, void const* pData = nullptr);
+
+    template <typename... Ts>
+    void CreateWith(Ts const&... components)
+    {
+        const ComponentMask mask = GetComponentMask<Ts...>();
+        uint8_t* pData = Push(Command::CREATE, kInvalidEntity, mask, GetPackedComponentSize(mask));
+        (PackComponent(mask, pData, components), ...);
+    }
+
+    void Destroy(EntityID entity);
+
+    void AddComponents(EntityID entity, ComponentMask mask, void const* pData = nullptr);
+    void RemoveComponents(EntityID entity, ComponentMask mask);
+
+    template <typename T>
+    void Add(EntityID entity, T const& component) { AddComponents(entity, GetComponentMask<T>(), &component); }
+
+    template <typename T>
+    void Remove(EntityID entity) { RemoveComponents(entity, GetComponentMask<T>()); }
+
+    // Makes every change in the order it was recorded and empties the buffer. Changes to entities that
+    // are already gone, like one destroyed by two systems, are skipped. Returns how many were made.
+    uint32_t Playback(World& world);
+
+    void Clear();
+
+    uint32_t GetCommandCount() const { return mCommandCount; }
+    bool     IsEmpty() const         { return mCommandCount == 0; }
+
+private:
+    enum class Command : uint8_t
+    {
+        CREATE,
+        DESTROY,
+        ADD,
+        REMOVE
+    };
+
+    struct CommandHeader
+    {
+        Command       Type;
+        uint32_t      DataSize;     // Packed components following the header
+        EntityID      Entity;
+        ComponentMask Mask;
+    };
+
+    // Appends a command, returning where its dataSize bytes of components go
+    uint8_t* Push(Command type, EntityID entity, ComponentMask mask, uint32_t dataSize);
+
+private:
+    std::vector<uint8_t> mData;
+    uint32_t             mCommandCount;
+};
+
+}
+#endif
@@ -0,0 +1,188 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of FrameStatistics.h
+----------------------------------------------*/
+#include "FrameStatistics.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+
+namespace Core {
+
+namespace {
+
+// How fast the hitch baseline follows the frame time: about the last 16 frames
+const double kAverageWeight = 1.0 / 16.0;
+
+// Frames before hitches are called, so the baseline has something to go on
+const uint64_t kWarmupFrames = 8;
+
+// This many hitches in a row is the frame time moving (vsync dropping to 30Hz, a heavier scene), not
+// hitching, so the baseline starts over from there instead of calling every frame after it a hitch
+const uint32_t kRebaseAfterHitches = 3;
+
+}
+
+FrameStatistics::FrameStatistics(uint32_t capacity) :
+    mSettings(),
+    mSamples(capacity),
+    mNext(0),
+    mCount(0),
+    mAverageMs(0.0),
+    mHitchStreak(0),
+    mTotalFrames(0),
+    mTotalHitches(0)
+{
+    assert(capacity != 0);
+}
+
+void FrameStatistics::Reset()
+{
+    mNext = 0;
+    mCount = 0;
+    mAverageMs = 0.0;
+    mHitchStreak = 0;
+    mTotalFrames = 0;
+    mTotalHitches = 0;
+}
+
+bool FrameStatistics::AddFrame(double frameMs)
+{
+    const bool hitch = mTotalFrames >= kWarmupFrames
+                    && frameMs > mAverageMs * mSettings.HitchFactor
+                    && frameMs - mAverageMs >= mSettings.HitchMinMs;
+
+    mHitchStreak = hitch ? mHitchStreak + 1 : 0;
+
+    if (mTotalFrames == 0 || mHitchStreak == kRebaseAfterHitches)
+    {
+        mAverageMs = frameMs;
+        mHitchStreak = 0;
+    }
+    else if (!hitch)
+    {
+        mAverageMs += (frameMs - mAverageMs) * kAverageWeight;
+    }
+
+    mSamples[mNext] = { (float)frameMs, hitch };
+    mNext = (mNext + 1) % (uint32_t)mSamples.size();
+    mCount = std::min(mCount + 1, (uint32_t)mSamples.size());
+
+    mTotalFrames++;
+    mTotalHitches += hitch;
+    return hitch;
+}
+
+FrameStatistics::FrameSample const& FrameStatistics::GetSample(uint32_t age) const
+{
+    const uint32_t capacity = (uint32_t)mSamples.size();
+    return mSamples[(mNext + capacity - mCount + age) % capacity];
+}
+
+FrameStatsSummary FrameStatistics::Summarize() const
+{
+    FrameStatsSummary summary = {};
+    summary.Frames = mCount;
+    summary.TotalFrames = mTotalFrames;
+    summary.TotalHitches = mTotalHitches;
+    if (!mCount)
+        return summary;
+
+    std::vector<float> sorted(mCount);
+    double sum = 0.0;
+    for (uint32_t i = 0; i != mCount; ++i)
+    {
+        FrameSample const& sample = GetSample(i);
+        sorted[i] = sample.Ms;
+        sum += sample.Ms;
+        summary.Hitches += sample.Hitch;
+    }
+    std::sort(sorted.begin(), sorted.end());
+
+    const uint32_t last = mCount - 1;
+    summary.AvgMs = sum / mCount;
+    summary.MinMs = sorted[0];
+    summary.P50Ms = sorted[last / 2];
+    summary.P95Ms = sorted[last * 95 / 100];
+    summary.P99Ms = sorted[last * 99 / 100];
+    summary.MaxMs = sorted[last];
+
+    double squaredError = 0.0;
+    double jitter = 0.0;
+    const double tolerance = summary.P50Ms * mSettings.PacingTolerance;
+    for (uint32_t i = 0; i != mCount; ++i)
+    {
+        const double ms = GetSample(i).Ms;
+        squaredError += (ms - summary.AvgMs) * (ms - summary.AvgMs);
+
+        if (i)
+        {
+            const double change = fabs(ms - GetSample(i - 1).Ms);
+            jitter += change;
+            summary.UnevenFrames += change > tolerance;
+        }
+    }
+    summary.StdDevMs = sqrt(squaredError / mCount);
+    summary.JitterMs = mCount > 1 ? jitter / (mCount - 1) : 0.0;
+
+    return summary;
+}
+
+bool FrameStatistics::WriteCSV(const char* path) const
+{
+    FILE* file = fopen(path, "wb");
+    if (!file)
+        return false;
+
+    fprintf(file, "frame,ms,hitch\n");
+
+    const uint64_t firstFrame = mTotalFrames - mCount;
+    for (uint32_t i = 0; i != mCount; ++i)
+    {
+        FrameSample const& sample = GetSample(i);
+        fprintf(file, "%llu,%.4f,%d\n", (unsigned long long)(firstFrame + i), sample.Ms, sample.Hitch ? 1 : 0);
+    }
+
+    const bool ok = !ferror(file);
+    fclose(file);
+    return ok;
+}
+
+bool FrameStatistics::WriteJSON(const char* path) const
+{
+    FILE* file = fopen(path, "wb");
+    if (!file)
+        return false;
+
+    const FrameStatsSummary summary = Summarize();
+    fprintf(file, "{\"frames\":%u,\"totalFrames\":%llu,\"avgMs\":%.4f,\"minMs\":%.4f,\"p50Ms\":%.4f,\"p95Ms\":%.4f,\"p99Ms\":%.4f,\"maxMs\":%.4f,",
+        summary.Frames, (unsigned long long)summary.TotalFrames, summary.AvgMs, summary.MinMs, summary.P50Ms, summary.P95Ms, summary.P99Ms, summary.MaxMs);
+    fprintf(file, "\"stdDevMs\":%.4f,\"jitterMs\":%.4f,\"unevenFrames\":%u,\"hitches\":%u,\"totalHitches\":%llu,\n\"frameMs\":[",
+        summary.StdDevMs, summary.JitterMs, summary.UnevenFrames, summary.Hitches, (unsigned long long)summary.TotalHitches);
+
+    for (uint32_t i = 0; i != mCount; ++i)
+        fprintf(file, "%s%.4f", i ? "," : "", GetSample(i).Ms);
+
+    fprintf(file, "],\n\"hitchFrames\":[");
+
+    // As indices into frameMs
+    bool first = true;
+    for (uint32_t i = 0; i != mCount; ++i)
+    {
+        if (!GetSample(i).Hitch)
+            continue;
+
+        fprintf(file, "%s%u", first ? "" : ",", i);
+        first = false;
+    }
+
+    fprintf(file, "]}\n");
+    const bool ok = !ferror(file);
+    fclose(file);
+    return ok;
+}
+
+}
@@ -0,0 +1,90 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Frame time statistics and pacing analysis
+Keeps a ring of the most recent frame durations and summarizes them on
+demand: percentiles, spread, how evenly frames were paced and how many
+hitched. A hitch is a frame well over the recent average, caught as it's
+added, and a short run of them resets the average to the new frame time;
+uneven pacing is consecutive frames disagreeing, which a steady
+average FPS can hide (e.g. alternating 16ms and 33ms frames).
+----------------------------------------------*/
+#ifndef MUON_FRAMESTATISTICS_H
+#define MUON_FRAMESTATISTICS_H
+
+#include <Muon/Core/StepTimer.h>
+
+#include <stdint.h>
+#include <vector>
+
+namespace Core {
+
+struct FrameStatsSettings
+{
+    // A hitch is over HitchFactor times the recent average, and over it by at least HitchMinMs
+    double HitchFactor     = 2.0;
+    double HitchMinMs      = 4.0;
+
+    // Consecutive frames further apart than this fraction of the median count as unevenly paced
+    double PacingTolerance = 0.2;
+};
+
+struct FrameStatsSummary
+{
+    uint32_t Frames;            // In the window, everything below is over these
+    double   AvgMs;
+    double   MinMs;
+    double   P50Ms;
+    double   P95Ms;
+    double   P99Ms;
+    double   MaxMs;
+    double   StdDevMs;
+    double   JitterMs;          // Mean change from one frame to the next
+    uint32_t UnevenFrames;
+    uint32_t Hitches;
+
+    uint64_t TotalFrames;       // Since the last Reset
+    uint64_t TotalHitches;
+};
+
+class FrameStatistics
+{
+public:
+    explicit FrameStatistics(uint32_t capacity = 1024);
+
+    void SetSettings(FrameStatsSettings const& settings) { mSettings = settings; }
+    void Reset();
+
+    // Returns true if the frame hitched
+    bool AddFrame(double frameMs);
+    bool AddFrame(StepTimer const& timer) { return AddFrame(timer.GetFrameSeconds() * 1000.0); }
+
+    FrameStatsSummary Summarize() const;
+
+    // One row per frame in the window, oldest first
+    bool WriteCSV(const char* path) const;
+
+    // The summary, then the window's frame times. False if the file couldn't be written.
+    bool WriteJSON(const char* path) const;
+
+private:
+    struct FrameSample
+    {
+        float Ms;
+        bool  Hitch;
+    };
+
+    FrameSample const& GetSample(uint32_t age) const;  // 0 is the oldest in the window
+
+    FrameStatsSettings       mSettings;
+    std::vector<FrameSample> mSamples;
+    uint32_t                 mNext;
+    uint32_t                 mCount;
+    double                   mAverageMs;        // Exponential, hitches left out so one doesn't hide the next
+    uint32_t                 mHitchStreak;      // Hitches in a row; enough of them and the average starts over
+    uint64_t                 mTotalFrames;
+    uint64_t                 mTotalHitches;
+};
+
+}
+#endif
@@ -6,7 +6,9 @@ Description : Implementation of Game.h
 #include "Game.h"
 
 #include <Muon/Core/DXCore.h>
+#include <Muon/Core/Profiler.h>
 #include <Muon/Input/GameInput.h>
+#include <Muon/Memory/Allocators.h>
 
 #include <Muon/Renderer/Camera.h>
 #include <Muon/Renderer/COMException.h>
@@ -15,6 +17,18 @@ Description : Implementation of Game.h
 
 #define USE_DX11 0
 
+// The simulation's rate, independent of how often frames are rendered
+static const double kSimulationStep = 1.0 / 60.0;
+
+#if defined(MN_ENABLE_PROFILER)
+// Startup and the first frames after it end up in MuonProfile.json, next to the executable,
+// their pacing in MuonFrameStats.json and the input that drove them in MuonInput.mnir
+static const uint64_t kProfileCaptureFrames = 600;
+#endif
+
+// Renamed from a MuonInput.mnir, this is played back in place of live input so a capture can be retaken
+static const char* kInputReplayPath = "MuonInputReplay.mnir";
+
 namespace Core
 {
 
@@ -25,7 +39,8 @@ Game::Game() :
     mpLightingManager(nullptr)
 {
     mDeviceResources.RegisterDeviceNotify(this);
-    mTimer.SetFixedTimeStep(false);
+    mTimer.SetFixedTimeStep(true);
+    mTimer.SetTargetElapsedSeconds(kSimulationStep);
 }
 
 // Initialize device resource holder by creating all necessary resources
@@ -33,6 +48,8 @@ bool Game::Init(HWND window, int width, int height)
 {
     using namespace Renderer;
 
+    BeginSession();
+
     // Grab Window handle, creates device and context
     mDeviceResources.SetWindow(window, width, height);
     mDeviceResources.CreateDeviceResources();
@@ -65,27 +82,74 @@ bool Game::Init(HWND window, int width, int height)
 
 bool Game::InitDX12(HWND window, int width, int height)
 {
+    BeginSession();
+
     bool success = Muon::Initialize(window, width, height);
 
     return success;
 }
 
+void Game::BeginSession()
+{
+#if defined(MN_ENABLE_PROFILER)
+    Profiler::BeginCapture();
+    mpInput->SetRecorder(&mInputRecorder);
+#endif
+
+    if (mInputReplay.Load(kInputReplayPath))
+        mpInput->SetReplay(&mInputReplay);
+}
+
 // On Timer tick, run Update() on the game, then Render()
 void Game::Frame()
 {
+    // Recycle the frame arena that was used two frames ago
+    Memory::BeginFrame();
+
     mTimer.Tick([&]()
     {
         Update(mTimer);
     });
+    mFrameStats.AddFrame(mTimer);
+
+    UpdateFrame(mTimer);
 
     Render();
 
     mDeviceResources.UpdateTitleBar(mTimer.GetFramesPerSecond(), mTimer.GetFrameCount());
+
+    MN_PROFILE_FRAME();
+#if defined(MN_ENABLE_PROFILER)
+    if (mTimer.GetFrameCount() == kProfileCaptureFrames && Profiler::IsCapturing())
+    {
+        Profiler::WriteChromeTrace("MuonProfile.json");
+        mFrameStats.WriteJSON("MuonFrameStats.json");
+        mInputRecorder.Save("MuonInput.mnir");
+        mpInput->SetRecorder(nullptr);
+    }
+#endif
 }
 
 void Game::Update(StepTimer const& timer)
 {
-    float elapsedTime = float(timer.GetElapsedSeconds());
+    MN_PROFILE_FUNCTION();
+
+#if USE_DX11
+    mEntityRenderer.Simulate(float(timer.GetElapsedSeconds()));
+#else
+    (void)timer;
+#endif
+}
+
+void Game::UpdateFrame(StepTimer const& timer)
+{
+    MN_PROFILE_FUNCTION();
+
+    // Nothing to blend towards before the first step
+    if (timer.GetFrameCount() == 0)
+        return;
+
+    float elapsedTime = float(timer.GetFrameSeconds());
 #if USE_DX11
     // Update the input, passing in the camera so it will update its internal information
     mpInput->Frame(elapsedTime, mpCamera);
@@ -96,18 +160,27 @@ void Game::Update(StepTimer const& timer)
 
     mpCamera->UpdateView(context);
 
-    // Update the lights (if needed)
-    DirectX::XMFLOAT3A camPos;
-    mpCamera->GetPosition3A(&camPos);
-    mpLightingManager->Update(context, timer.GetTotalSeconds(), camPos);
+    // Update the lights (if needed) and bin them into the new view
+    mpLightingManager->Update(context, timer.GetTotalSeconds(), *mpCamera, mDeviceResources.GetScreenViewport());
     
     // Update the renderer's view matrices, lighting information.
-    mEntityRenderer.Update(context, elapsedTime);
+    mEntityRenderer.Update(context, float(timer.GetInterpolationAlpha()));
+
+    // Shadow cascades span whatever the entities cover. Only a change reaches the lights, next frame.
+    DirectX::XMFLOAT3 sceneMin, sceneMax;
+    mEntityRenderer.GetBounds(sceneMin, sceneMax);
+    mpLightingManager->SetShadowBounds(sceneMin, sceneMax);
+
+    // Stream texture mips towards what this frame's view needs
+    mEntityRenderer.RequestTextureMips(*mpCamera, mDeviceResources.GetScreenViewport().Height);
+    Renderer::ResourceCodex::UpdateStreaming();
 #endif
 }
 
 void Game::Render()
 {
+    MN_PROFILE_FUNCTION();
+
     // Don't try to render anything before the first Update.
     if (mTimer.GetFrameCount() == 0)
     {
@@ -122,6 +195,9 @@ void Game::Render()
 #if USE_DX11
     auto context = mDeviceResources.GetContext();
 
+    // Shadow cascades first, Clear rebinds the back buffer and viewport after them
+    mpLightingManager->DrawShadows(context, mEntityRenderer);
+
     // Clear the necessary backbuffer
     mDeviceResources.Clear(DirectX::Colors::Black);
 
@@ -162,7 +238,8 @@ Game::~Game()
     delete mpInput;
     mpInput = nullptr;
 
-    
+    // Flushes the GPU and writes the pipeline library back to disk
+    Muon::Shutdown();
 }
 
 #pragma region Game State Callbacks
@@ -180,6 +257,8 @@ void Game::OnActivated()
 
 void Game::OnDeactivated()
 {
+    // Whatever was held when focus left gets released somewhere we won't hear about it
+    mpInput->OnFocusLost();
 }
 
 void Game::OnSuspending()
@@ -219,6 +298,16 @@ void Game::OnResize(int newWidth, int newHeight)
     #endif
 }
 
+void Game::OnKeyDown(uint8_t keyCode)
+{
+    mpInput->OnKeyDown(keyCode);
+}
+
+void Game::OnKeyUp(uint8_t keyCode)
+{
+    mpInput->OnKeyUp(keyCode);
+}
+
 void Game::OnMouseMove(short newX, short newY)
 {
     mpInput->OnMouseMove(newX, newY);
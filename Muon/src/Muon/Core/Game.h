@@ -7,8 +7,10 @@ This class encapsulates all app functionality
 #ifndef GAME_H
 #define GAME_H
 
+#include "FrameStatistics.h"
 #include "StepTimer.h"
 
+#include <Muon/Input/InputRecording.h>
 #include <Muon/Renderer/DeviceResources.h>
 #include <Muon/Renderer/EntityRenderer.h>
 #include <Muon/Renderer/SkyRenderer.h>
@@ -51,10 +53,22 @@ public:
     void OnResize(int newWidth, int newHeight);
 
     // Input Callbacks
+    void OnKeyDown(uint8_t keyCode);
+    void OnKeyUp(uint8_t keyCode);
     void OnMouseMove(short newX, short newY);
 
 private:
+    // Starts the profile capture and input recording, or loads a session to replay. Either renderer's init
+    // calls it first, so startup is in the capture too.
+    void BeginSession();
+
+    // Once per fixed step, so the simulation runs the same at any frame rate
     void Update(StepTimer const& timer);
+
+    // Once per rendered frame, after however many steps it took: input, camera, lights, and
+    // every transform blended the leftover fraction of a step past the last one
+    void UpdateFrame(StepTimer const& timer);
+
     void Render();
 
     void CreateDeviceDependentResources();
@@ -75,11 +89,18 @@ private:
     // Input Management
     Input::GameInput* mpInput;
 
+    // The session's input, saved with the profile capture, and a session to act out instead of live input
+    Input::InputRecorder mInputRecorder;
+    Input::InputReplay   mInputReplay;
+
     // Main Camera
     Renderer::Camera* mpCamera;
     
     // Timer for the main game loop
     StepTimer mTimer;
+
+    // Pacing of the frames the timer sees
+    FrameStatistics mFrameStats;
 };
 }
 #endif
\ No newline at end of file
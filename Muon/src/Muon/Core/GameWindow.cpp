@@ -4,6 +4,8 @@ Date : 2019/12
 Description : Implementation of Message Loop
 ----------------------------------------------*/
 #include <Muon/Core/Game.h>
+#include <Muon/Core/JobSystem.h>
+#include <Muon/Memory/Allocators.h>
 
 #include "GameWindow.h"
 
@@ -11,6 +13,9 @@ namespace Core
 {
     GameWindow::GameWindow()
     {
+        // Engine-wide arenas must exist before anything in the game allocates from them
+        Memory::Init();
+        JobSystem::Init();
         m_pGame = new Core::Game();
     }
 
@@ -18,12 +23,51 @@ namespace Core
     {
         delete m_pGame;
         m_pGame = nullptr;
+
+        JobSystem::Shutdown();
+
+        // Reports any tagged allocations the game failed to give back
+        Memory::Shutdown();
     }
 
     LRESULT GameWindow::HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lParam)
     {
         switch (uMsg)
         {
+        case WM_KEYDOWN:
+            // Held keys repeat, but only the first press is news to the input system
+            if (!(lParam & (1 << 30)))
+                m_pGame->OnKeyDown((uint8_t)wParam);
+            return 0;
+        case WM_KEYUP:
+            m_pGame->OnKeyUp((uint8_t)wParam);
+            return 0;
+
+        // Alt and F10 arrive as system keys. Still passed on, or Alt+F4 stops closing the window.
+        case WM_SYSKEYDOWN:
+            if (!(lParam & (1 << 30)))
+                m_pGame->OnKeyDown((uint8_t)wParam);
+            return DefWindowProc(m_hwnd, uMsg, wParam, lParam);
+        case WM_SYSKEYUP:
+            m_pGame->OnKeyUp((uint8_t)wParam);
+            return DefWindowProc(m_hwnd, uMsg, wParam, lParam);
+
+        // Mouse buttons go through as their virtual keys, so chords can mix them with the keyboard.
+        // Captured while held so the release still arrives if it happens outside the window.
+        case WM_LBUTTONDOWN:
+        case WM_RBUTTONDOWN:
+        case WM_MBUTTONDOWN:
+            SetCapture(m_hwnd);
+            m_pGame->OnKeyDown(uMsg == WM_LBUTTONDOWN ? VK_LBUTTON : uMsg == WM_RBUTTONDOWN ? VK_RBUTTON : VK_MBUTTON);
+            return 0;
+        case WM_LBUTTONUP:
+        case WM_RBUTTONUP:
+        case WM_MBUTTONUP:
+            m_pGame->OnKeyUp(uMsg == WM_LBUTTONUP ? VK_LBUTTON : uMsg == WM_RBUTTONUP ? VK_RBUTTON : VK_MBUTTON);
+            if (!(wParam & (MK_LBUTTON | MK_RBUTTON | MK_MBUTTON)))
+                ReleaseCapture();
+            return 0;
+
         case WM_MOUSEMOVE:
             POINTS pt = MAKEPOINTS(lParam);
             m_pGame->OnMouseMove(pt.x, pt.y);
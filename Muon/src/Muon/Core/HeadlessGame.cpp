@@ -0,0 +1,1388 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of HeadlessGame.h
+----------------------------------------------*/
+#include "HeadlessGame.h"
+
+#include <Muon/Core/JobSystem.h>
+#include <Muon/Core/Profiler.h>
+#include <Muon/Renderer/hash_util.h>
+#include <Muon/Renderer/IndirectDrawBuilder.h>
+#include <Muon/Renderer/ParallelRecorder.h>
+
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+namespace Core {
+
+namespace {
+
+// Stand-in sizes for the assets a real scene would load: a cube and a 256x256 RGBA texture with mips
+const uint32_t kMeshVertexCount  = 24;
+const uint32_t kMeshIndexCount   = 36;
+const uint32_t kVertexStride     = 48;  // Position, normal, uv, tangent
+const uint32_t kInstanceStride   = sizeof(float) * 16;
+const uint32_t kFakeShaderSize   = 4096;
+const uint32_t kTextureDimension = 256;
+
+// What a streamed material would cook to: a 2048 BC7 diffuse with a full chain
+const uint32_t kStreamedTextureDimension = 2048;
+
+const float kGridSpacing  = 3.0f;
+const float kCameraOrbit  = 0.1f;   // Radians per second
+const float kCameraFovY   = 1.0f;
+const float kCameraAspect = 16.0f / 10.0f;
+const float kCameraNear   = 0.1f;
+const float kCameraFar    = 150.0f;
+
+// What GameInput and the game's camera fly with
+const float kFreeCameraSpeed       = 5.0f;
+const float kFreeCameraSensitivity = 1.5f;
+const float kFreeCameraMaxPitch    = 1.5f;  // Radians, short of straight up or down where the basis breaks
+
+const uint32_t kJobGroupSize = 256;
+const uint32_t kChunksPerJob = 1;   // A chunk holds a few hundred entities, about a group's worth
+
+// Below this many batches a deferred context costs more to set up and merge than it saves
+const uint32_t kMinBatchesPerContext = 2;
+
+const uint32_t kFrameWidth  = 1280;
+const uint32_t kFrameHeight = 800;
+
+// register(tN) of the clustered lighting buffers, see ClusteredLighting.hlsli
+const uint32_t kClusterLightSlot   = 8;
+const uint32_t kClusterGridSlot    = 9;
+const uint32_t kClusterIndicesSlot = 10;
+
+// The lights move in this many runs, one run per frame
+const uint32_t kMovingLightRuns = 8;
+
+// A fixed sun, so the cached cascades only move when the camera takes them out of their slack
+const float    kSunDirection[3]  = { -0.4f, -1.0f, -0.3f };
+const uint32_t kShadowResolution = 2048;
+const float    kShadowDistance   = 100.0f;
+
+typedef std::chrono::high_resolution_clock Clock;
+
+double ElapsedMs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+void AccumulateTiming(StageTiming& timing, double ms)
+{
+    timing.TotalMs += ms;
+    timing.MinMs = std::min(timing.MinMs, ms);
+    timing.MaxMs = std::max(timing.MaxMs, ms);
+}
+
+// Deterministic LCG, so every run with the same seed builds the same scene
+struct Random
+{
+    uint32_t State;
+
+    uint32_t Next()       { State = State * 1664525u + 1013904223u; return State >> 8; }
+    float    NextFloat()  { return (float)Next() / (float)(1u << 24); }
+};
+
+inline float Dot3(const float* a, const float* b) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+
+void Normalize3(float* v)
+{
+    const float invLen = 1.0f / sqrtf(Dot3(v, v));
+    v[0] *= invLen;
+    v[1] *= invLen;
+    v[2] *= invLen;
+}
+
+// Right and up of a camera that never rolls, left handed like DirectXMath
+void GetCameraBasis(const float* forward, float* out_right, float* out_up)
+{
+    const float worldUp[3] = { 0.0f, 1.0f, 0.0f };
+    const float* f = forward;
+
+    out_right[0] = worldUp[1] * f[2] - worldUp[2] * f[1];
+    out_right[1] = worldUp[2] * f[0] - worldUp[0] * f[2];
+    out_right[2] = worldUp[0] * f[1] - worldUp[1] * f[0];
+    Normalize3(out_right);
+
+    out_up[0] = f[1] * out_right[2] - f[2] * out_right[1];
+    out_up[1] = f[2] * out_right[0] - f[0] * out_right[2];
+    out_up[2] = f[0] * out_right[1] - f[1] * out_right[0];
+}
+
+// Orbit the camera around the grid, looking slightly down at the center
+void GetOrbitCamera(uint32_t entityCount, float time, float* out_position, float* out_forward)
+{
+    const float orbitRadius = 0.35f * kGridSpacing * sqrtf((float)entityCount) + 10.0f;
+    const float angle = time * kCameraOrbit;
+    out_position[0] = cosf(angle) * orbitRadius;
+    out_position[1] = 12.0f;
+    out_position[2] = sinf(angle) * orbitRadius;
+
+    out_forward[0] = -out_position[0];
+    out_forward[1] = -out_position[1];
+    out_forward[2] = -out_position[2];
+    Normalize3(out_forward);
+}
+
+// Row vectors like DirectXMath, so the camera's axes go down the columns
+void GetCameraView(const float* eye, const float* forward, float* out_view)
+{
+    float right[3];
+    float up[3];
+    GetCameraBasis(forward, right, up);
+    const float* axes[3] = { right, up, forward };
+
+    for (int a = 0; a != 3; ++a)
+    {
+        out_view[a]      = axes[a][0];
+        out_view[4 + a]  = axes[a][1];
+        out_view[8 + a]  = axes[a][2];
+        out_view[12 + a] = -Dot3(eye, axes[a]);
+    }
+    out_view[3] = out_view[7] = out_view[11] = 0.0f;
+    out_view[15] = 1.0f;
+}
+
+}
+
+HeadlessGame::HeadlessGame() :
+    mpBackend(nullptr),
+    mWorldMatrices(nullptr),
+    mAppearances(nullptr),
+    mMeshes(nullptr),
+    mMaterials(nullptr),
+    mGroups(nullptr),
+    mGroupCount(0),
+    mGeometryVertexBuffer(Renderer::kInvalidBackendHandle),
+    mGeometryIndexBuffer(Renderer::kInvalidBackendHandle),
+    mInstanceBuffer(Renderer::kInvalidBackendHandle),
+    mInstanceMaterialBuffer(Renderer::kInvalidBackendHandle),
+    mMaterialTableBuffer(Renderer::kInvalidBackendHandle),
+    mLightBuffer(Renderer::kInvalidBackendHandle),
+    mClusterGridBuffer(Renderer::kInvalidBackendHandle),
+    mLightIndexBuffer(Renderer::kInvalidBackendHandle),
+    mCameraBuffer(Renderer::kInvalidBackendHandle),
+    mDrawArgsBuffer(Renderer::kInvalidBackendHandle),
+    mDrawDataBuffer(Renderer::kInvalidBackendHandle),
+    mShadowInstanceBuffer(Renderer::kInvalidBackendHandle),
+    mShadowCascadeBuffers(),
+    mShadowVertexShader(Renderer::kInvalidBackendHandle),
+    mShadowPixelShader(Renderer::kInvalidBackendHandle),
+    mVisible(nullptr),
+    mVisibleCount(0),
+    mBatches(nullptr),
+    mBatchCount(0),
+    mInstanceData(nullptr),
+    mInstanceMaterials(nullptr),
+    mShadowBatches(nullptr),
+    mShadowBatchCount(0),
+    mShadowInstanceData(nullptr),
+    mShadowInstanceCount(0),
+    mTime(0.0),
+    mPrevTime(0.0),
+    mCurrentTransform(0),
+    mInterpolationAlpha(1.0f),
+    mCameraData(),
+    mCameraPosition(),
+    mCameraForward(),
+    mFreeCameraYaw(0.0f),
+    mFreeCameraPitch(0.0f),
+    mpStreamingDevice(nullptr),
+    mReport()
+{
+}
+
+HeadlessGame::~HeadlessGame()
+{
+    Shutdown();
+}
+
+bool HeadlessGame::Init(Renderer::IRenderBackend* pBackend, HeadlessConfig const& config)
+{
+    if (!pBackend || config.EntityCount == 0 || config.MeshCount == 0 || config.MaterialCount == 0)
+        return false;
+
+    // Cluster hits pack the light index into 16 bits
+    if (config.LightCount > 0x10000)
+        return false;
+
+    if (config.ShadowCascades > Renderer::kMaxShadowCascades)
+        return false;
+
+    mpBackend = pBackend;
+    mConfig = config;
+    mTime = 0.0;
+    mPrevTime = 0.0;
+    mCurrentTransform = 0;
+    mPacingTimer.SetClock(config.pPacingClock ? *config.pPacingClock : SystemClock::Get());
+
+    mSimulationTimer.SetClock(mSimulationClock);
+    mSimulationTimer.SetFixedTimeStep(true);
+    mSimulationTimer.SetTargetElapsedSeconds(config.FixedStep);
+
+    const size_t arenaSize = config.EntityCount * (sizeof(EntityAppearance) + sizeof(float) * 16)
+                           + config.MeshCount * sizeof(MeshResources)
+                           + config.MaterialCount * (sizeof(MaterialResources) + sizeof(ShadingGroup))
+                           + 4096;
+    mArena.Init(arenaSize, Memory::MemoryTag::ENTITIES);
+
+    CreateResources();
+    CreateEntities();
+    CreateLights();
+    CreateShadows();
+
+    // A replay starts where the orbit would have
+    GetOrbitCamera(config.EntityCount, 0.0f, mCameraPosition, mCameraForward);
+    mFreeCameraYaw = atan2f(mCameraForward[0], mCameraForward[2]);
+    mFreeCameraPitch = asinf(mCameraForward[1]);
+
+    // After everything else, so the query heap doesn't move any of the scene's handles
+    if (config.GpuTiming && !mGPUProfiler.Init(pBackend))
+        return false;
+
+    return true;
+}
+
+void HeadlessGame::Shutdown()
+{
+    if (!mArena.IsInitialized())
+        return;
+
+    mGPUProfiler.Shutdown();
+    mTextureStreamer.Shutdown();
+    delete mpStreamingDevice;
+    mpStreamingDevice = nullptr;
+
+    for (uint32_t i = 0; i != mConfig.MaterialCount; ++i)
+    {
+        mpBackend->DestroyResource(mMaterials[i].VertexShader);
+        mpBackend->DestroyResource(mMaterials[i].PixelShader);
+        mpBackend->DestroyResource(mMaterials[i].Diffuse);
+    }
+    for (uint32_t i = 0; i != mGroupCount; ++i)
+        mpBackend->DestroyResource(mGroups[i].Page);
+
+    mpBackend->DestroyResource(mGeometryVertexBuffer);
+    mpBackend->DestroyResource(mGeometryIndexBuffer);
+    mpBackend->DestroyResource(mInstanceBuffer);
+    mpBackend->DestroyResource(mInstanceMaterialBuffer);
+    mpBackend->DestroyResource(mMaterialTableBuffer);
+    mMaterialTable.Destroy();
+    mpBackend->DestroyResource(mLightBuffer);
+    mpBackend->DestroyResource(mClusterGridBuffer);
+    mpBackend->DestroyResource(mLightIndexBuffer);
+    mClusteredLighting.Destroy();
+    mpBackend->DestroyResource(mShadowInstanceBuffer);
+    for (Renderer::BufferHandle& buffer : mShadowCascadeBuffers)
+    {
+        mpBackend->DestroyResource(buffer);
+        buffer = Renderer::kInvalidBackendHandle;
+    }
+    mpBackend->DestroyResource(mShadowVertexShader);
+    mpBackend->DestroyResource(mShadowPixelShader);
+    mpBackend->DestroyResource(mCameraBuffer);
+    mpBackend->DestroyResource(mDrawArgsBuffer);
+    mpBackend->DestroyResource(mDrawDataBuffer);
+
+    mWorld.Shutdown();
+    mArena.Destroy();
+    mWorldMatrices = nullptr;
+    mAppearances = nullptr;
+    mMeshes = nullptr;
+    mMaterials = nullptr;
+    mGroups = nullptr;
+    mGroupCount = 0;
+    mInstanceMaterialBuffer = Renderer::kInvalidBackendHandle;
+    mMaterialTableBuffer = Renderer::kInvalidBackendHandle;
+    mLightBuffer = Renderer::kInvalidBackendHandle;
+    mClusterGridBuffer = Renderer::kInvalidBackendHandle;
+    mLightIndexBuffer = Renderer::kInvalidBackendHandle;
+    mShadowInstanceBuffer = Renderer::kInvalidBackendHandle;
+    mShadowVertexShader = Renderer::kInvalidBackendHandle;
+    mShadowPixelShader = Renderer::kInvalidBackendHandle;
+}
+
+void HeadlessGame::CreateResources()
+{
+    MN_PROFILE_FUNCTION();
+
+    using namespace Renderer;
+
+    mMeshes = mArena.AllocArray<MeshResources>(mConfig.MeshCount);
+    for (uint32_t i = 0; i != mConfig.MeshCount; ++i)
+    {
+        MeshResources& mesh = mMeshes[i];
+        mesh.IndexCount = kMeshIndexCount;
+        mesh.FirstIndex = i * kMeshIndexCount;
+        mesh.BaseVertex = (int32_t)(i * kMeshVertexCount);
+    }
+
+    const uint32_t vertexBytes = mConfig.MeshCount * kMeshVertexCount * kVertexStride;
+    const uint32_t indexBytes  = mConfig.MeshCount * kMeshIndexCount * (uint32_t)sizeof(uint32_t);
+    mGeometryVertexBuffer = mpBackend->CreateBuffer({ vertexBytes, kVertexStride, BufferUsage::VERTEX, false }, nullptr);
+    mGeometryIndexBuffer  = mpBackend->CreateBuffer({ indexBytes, sizeof(uint32_t), BufferUsage::INDEX, false }, nullptr);
+
+    static const uint8_t kFakeBytecode[kFakeShaderSize] = {};
+    const uint16_t mipCount = (uint16_t)(log2((double)kTextureDimension) + 1);
+
+    const bool streaming = mConfig.TextureBudgetKB != 0;
+    if (streaming)
+    {
+        TextureStreamerConfig streamerConfig;
+        streamerConfig.BudgetBytes = (uint64_t)mConfig.TextureBudgetKB << 10;
+
+        // Nothing on disk: reads come back zeroed, after as long as the simulated drive would take
+        const uint32_t readMBps = mConfig.StreamingReadMBps;
+        auto readFn = [readMBps](const char*, uint64_t, void* pDst, uint32_t byteSize)
+        {
+            memset(pDst, 0, byteSize);
+            if (readMBps)
+                std::this_thread::sleep_for(std::chrono::microseconds(byteSize / readMBps));
+            return true;
+        };
+
+        mpStreamingDevice = new BackendStreamingDevice(*mpBackend);
+        mTextureStreamer.Init(mpStreamingDevice, streamerConfig, readFn);
+    }
+
+    const uint32_t streamedMipCount = (uint32_t)log2((double)kStreamedTextureDimension) + 1;
+    const DDSDesc streamedDesc = { kStreamedTextureDimension, kStreamedTextureDimension, streamedMipCount, 1, DDSFormat::BC7_UNORM };
+
+    mMaterials = mArena.AllocArray<MaterialResources>(mConfig.MaterialCount);
+    for (uint32_t i = 0; i != mConfig.MaterialCount; ++i)
+    {
+        MaterialResources& material = mMaterials[i];
+        material.VertexShader    = mpBackend->CreateShader(ShaderStage::VERTEX, kFakeBytecode, kFakeShaderSize);
+        material.PixelShader     = mpBackend->CreateShader(ShaderStage::PIXEL, kFakeBytecode, kFakeShaderSize);
+        material.Diffuse         = kInvalidBackendHandle;
+        material.StreamedDiffuse = kInvalidStreamedTexture;
+        material.Group           = (uint16_t)i;
+        material.Slice           = 0;
+        material.TableIndex      = kInvalidMaterialIndex;
+
+        // Packed diffuse maps are created with their page
+        if (streaming)
+            material.StreamedDiffuse = mTextureStreamer.Register("Material_T.dds", streamedDesc);
+        else if (!mConfig.TextureArrays || mConfig.BindlessMaterials)
+            material.Diffuse = mpBackend->CreateTexture({ kTextureDimension, kTextureDimension, mipCount, 1, 4 }, nullptr);
+    }
+    CreateShadingGroups();
+
+    mInstanceBuffer = mpBackend->CreateBuffer({ mConfig.EntityCount * kInstanceStride, kInstanceStride, BufferUsage::INSTANCE, true }, nullptr);
+    if (mConfig.BindlessMaterials || (mConfig.TextureArrays && !streaming))
+        mInstanceMaterialBuffer = mpBackend->CreateBuffer({ mConfig.EntityCount * (uint32_t)sizeof(uint32_t), sizeof(uint32_t), BufferUsage::INSTANCE, true }, nullptr);
+    mCameraBuffer   = mpBackend->CreateBuffer({ sizeof(mCameraData), 0, BufferUsage::CONSTANT, true }, nullptr);
+
+    // At most one indirect draw per (material, mesh) pair
+    const uint32_t maxDraws = mConfig.MaterialCount * mConfig.MeshCount;
+    mDrawArgsBuffer = mpBackend->CreateBuffer({ maxDraws * (uint32_t)sizeof(DrawIndexedArgs), sizeof(DrawIndexedArgs), BufferUsage::INDIRECT_ARGS, true }, nullptr);
+    mDrawDataBuffer = mpBackend->CreateBuffer({ maxDraws * (uint32_t)sizeof(IndirectDrawData), sizeof(IndirectDrawData), BufferUsage::STRUCTURED, true }, nullptr);
+}
+
+void HeadlessGame::CreateShadingGroups()
+{
+    using namespace Renderer;
+
+    mGroups = mArena.AllocArray<ShadingGroup>(mConfig.MaterialCount);
+    mGroupCount = 0;
+
+    if (mConfig.BindlessMaterials)
+    {
+        // Texture handles stand in for descriptor heap indices. Streamed ones are filled in as
+        // residency changes, by UploadMaterialTable.
+        mMaterialTable.Init(mConfig.MaterialCount);
+        for (uint32_t i = 0; i != mConfig.MaterialCount; ++i)
+        {
+            GPUMaterial entry;
+            entry.SpecularExp  = 32.0f;
+            entry.DiffuseIndex = mMaterials[i].Diffuse != kInvalidBackendHandle ? mMaterials[i].Diffuse : kNoDescriptor;
+
+            mMaterials[i].TableIndex = mMaterialTable.Add(entry);
+            mMaterials[i].Group = 0;
+        }
+        mMaterialTableBuffer = mpBackend->CreateBuffer({ mMaterialTable.GetByteSize(), sizeof(GPUMaterial), BufferUsage::STRUCTURED, false }, nullptr);
+        mGroups[mGroupCount++] = { 0, kInvalidBackendHandle };
+        return;
+    }
+
+    if (!mConfig.TextureArrays || mpStreamingDevice)
+    {
+        for (uint32_t i = 0; i != mConfig.MaterialCount; ++i)
+            mGroups[mGroupCount++] = { (uint16_t)i, kInvalidBackendHandle };
+        return;
+    }
+
+    // The plan the cooker would make for the diffuse maps these materials stand in for. Atlases are
+    // off because an instance only carries a slice.
+    const uint32_t mipCount = (uint32_t)log2((double)kTextureDimension) + 1;
+    std::vector<DDSDesc> descs(mConfig.MaterialCount, { kTextureDimension, kTextureDimension, mipCount, 1, DDSFormat::R8G8B8A8_UNORM });
+
+    TexturePackerConfig packerConfig;
+    packerConfig.Atlases = false;
+    TexturePackPlan plan;
+    PlanTexturePack(descs.data(), mConfig.MaterialCount, packerConfig, plan);
+
+    for (TexturePage const& page : plan.Pages)
+    {
+        ShadingGroup& group = mGroups[mGroupCount];
+        group.FirstMaterial = (uint16_t)page.Members[0];
+        group.Page = mpBackend->CreateTexture({ page.Desc.Width, page.Desc.Height, (uint16_t)page.Desc.MipCount, (uint16_t)page.Desc.ArraySize, 4 }, nullptr);
+
+        for (uint32_t member : page.Members)
+        {
+            mMaterials[member].Group = (uint16_t)mGroupCount;
+            mMaterials[member].Slice = (uint16_t)plan.Textures[member].Slice;
+        }
+        mGroupCount++;
+    }
+
+    // A material nothing else shares a page with keeps its own texture and batches alone
+    for (uint32_t i = 0; i != mConfig.MaterialCount; ++i)
+    {
+        if (plan.Textures[i].Page != kUnpackedTexture)
+            continue;
+
+        mMaterials[i].Diffuse = mpBackend->CreateTexture({ kTextureDimension, kTextureDimension, (uint16_t)mipCount, 1, 4 }, nullptr);
+        mMaterials[i].Group = (uint16_t)mGroupCount;
+        mGroups[mGroupCount++] = { (uint16_t)i, kInvalidBackendHandle };
+    }
+}
+
+void HeadlessGame::CreateEntities()
+{
+    mWorld.Init(mConfig.EntityCount);
+    mWorldMatrices = mArena.AllocArray<float>(mConfig.EntityCount * 16);
+    mAppearances = mArena.AllocArray<EntityAppearance>(mConfig.EntityCount);
+
+    // Square grid centered on the origin
+    const uint32_t side = (uint32_t)ceil(sqrt((double)mConfig.EntityCount));
+    const float halfExtent = GetGridHalfExtent(mConfig.EntityCount);
+
+    Random rng = { mConfig.Seed };
+    for (uint32_t i = 0; i != mConfig.EntityCount; ++i)
+    {
+        EntityMotion motion;
+        EntityAppearance appearance;
+        EntityTransform& transform = motion.Transforms[0];
+        transform.Position[0] = (float)(i % side) * kGridSpacing - halfExtent;
+        transform.Position[1] = 0.0f;
+        transform.Position[2] = (float)(i / side) * kGridSpacing - halfExtent;
+        appearance.Scale         = 0.5f + rng.NextFloat();
+        transform.Yaw            = rng.NextFloat() * 6.2831853f;
+        motion.YawRate           = rng.NextFloat() * 2.0f - 1.0f;
+        motion.BobPhase          = rng.NextFloat() * 6.2831853f;
+        appearance.MeshIndex     = (uint16_t)(rng.Next() % mConfig.MeshCount);
+        appearance.MaterialIndex = (uint16_t)(rng.Next() % mConfig.MaterialCount);
+        motion.Transforms[1] = transform;
+
+        mWorld.CreateWith(motion, appearance);
+    }
+}
+
+void HeadlessGame::CreateLights()
+{
+    using namespace Renderer;
+
+    if (!mConfig.LightCount)
+        return;
+
+    ClusterGridConfig gridConfig;
+    gridConfig.MaxLights = mConfig.LightCount;
+    mClusteredLighting.Init(gridConfig);
+
+    // Over the same area as the entities, from a stream of their own so the entities don't change
+    const uint32_t side = (uint32_t)ceil(sqrt((double)mConfig.EntityCount));
+    const float extent = kGridSpacing * (float)side;
+
+    Random rng = { mConfig.Seed ^ 0x9E3779B9u };
+    for (uint32_t i = 0; i != mConfig.LightCount; ++i)
+    {
+        ClusterLight light;
+        light.Position[0] = (rng.NextFloat() - 0.5f) * extent;
+        light.Position[1] = 0.5f + 2.5f * rng.NextFloat();
+        light.Position[2] = (rng.NextFloat() - 0.5f) * extent;
+        light.Range       = 2.0f + 6.0f * rng.NextFloat();
+        light.Color[0]    = rng.NextFloat();
+        light.Color[1]    = rng.NextFloat();
+        light.Color[2]    = rng.NextFloat();
+
+        // Every fourth one is a spot pointing roughly down
+        if (i % 4 == 3)
+        {
+            light.Type          = (uint32_t)ClusterLightType::SPOT;
+            light.Direction[0]  = rng.NextFloat() - 0.5f;
+            light.Direction[1]  = -1.0f;
+            light.Direction[2]  = rng.NextFloat() - 0.5f;
+            light.CosOuterAngle = cosf(0.3f + 0.6f * rng.NextFloat());
+            Normalize3(light.Direction);
+        }
+
+        mClusteredLighting.AddLight(light);
+    }
+
+    mLightBuffer       = mpBackend->CreateBuffer({ mClusteredLighting.GetLightBufferSize(), sizeof(ClusterLight), BufferUsage::STRUCTURED, false }, nullptr);
+    mClusterGridBuffer = mpBackend->CreateBuffer({ mClusteredLighting.GetClusterCount() * (uint32_t)sizeof(ClusterRange), sizeof(ClusterRange), BufferUsage::STRUCTURED, true }, nullptr);
+    mLightIndexBuffer  = mpBackend->CreateBuffer({ gridConfig.MaxLightIndices * (uint32_t)sizeof(uint32_t), sizeof(uint32_t), BufferUsage::STRUCTURED, true }, nullptr);
+}
+
+void HeadlessGame::CreateShadows()
+{
+    using namespace Renderer;
+
+    if (!mConfig.ShadowCascades)
+        return;
+
+    ShadowCascadeConfig shadowConfig;
+    shadowConfig.CascadeCount       = mConfig.ShadowCascades;
+    shadowConfig.Resolution         = kShadowResolution;
+    shadowConfig.MaxDistance        = kShadowDistance;
+    shadowConfig.FirstCachedCascade = mConfig.ShadowCascades - mConfig.ShadowCascades / 2;
+    mShadows.Init(shadowConfig);
+
+    // The grid, with room for the largest cube bobbing at either end
+    const uint32_t side = (uint32_t)ceil(sqrt((double)mConfig.EntityCount));
+    const float reach = 0.5f * kGridSpacing * (float)(side - 1) + 1.5f * 1.7320508f;
+    const float sceneMin[3] = { -reach, -0.5f - 1.5f * 1.7320508f, -reach };
+    const float sceneMax[3] = {  reach,  0.5f + 1.5f * 1.7320508f,  reach };
+    mShadows.SetSceneBounds(sceneMin, sceneMax);
+
+    // The null backend wants a pixel shader in every pair, a real depth pass would bind none
+    static const uint8_t kFakeBytecode[kFakeShaderSize] = {};
+    mShadowVertexShader = mpBackend->CreateShader(ShaderStage::VERTEX, kFakeBytecode, kFakeShaderSize);
+    mShadowPixelShader  = mpBackend->CreateShader(ShaderStage::PIXEL, kFakeBytecode, kFakeShaderSize);
+
+    const uint32_t instanceBytes = mConfig.EntityCount * mConfig.ShadowCascades * kInstanceStride;
+    mShadowInstanceBuffer = mpBackend->CreateBuffer({ instanceBytes, kInstanceStride, BufferUsage::INSTANCE, true }, nullptr);
+    for (uint32_t c = 0; c != mConfig.ShadowCascades; ++c)
+        mShadowCascadeBuffers[c] = mpBackend->CreateBuffer({ sizeof(float) * 16, 0, BufferUsage::CONSTANT, true }, nullptr);
+}
+
+HeadlessReport HeadlessGame::Run()
+{
+    mReport = HeadlessReport();
+    for (uint32_t i = 0; i != mConfig.FrameCount; ++i)
+        Frame();
+
+    return mReport;
+}
+
+void HeadlessGame::Frame()
+{
+    if (mReport.Frames == 0)
+    {
+        for (StageTiming& stage : mReport.Stages)
+            stage = { 0.0, 1e30, 0.0 };
+
+        mReport.Frame = { 0.0, 1e30, 0.0 };
+        mReport.CommandHash = fnv1a64(nullptr, 0);
+        mReport.ShadingGroups = mGroupCount;
+
+        mPacingTimer.ResetElapsedTime();
+        mFrameStats.Reset();
+    }
+
+    // Recycle the frame arena that was used two frames ago
+    Memory::BeginFrame();
+
+    const Clock::time_point frameStart = Clock::now();
+    Clock::time_point stageStart = frameStart;
+
+    if (mConfig.RenderStep > 0.0)
+    {
+        mSimulationClock.AdvanceSeconds(mConfig.RenderStep);
+        mSimulationTimer.Tick([this] { Simulate((float)mConfig.FixedStep); });
+        Interpolate((float)mSimulationTimer.GetInterpolationAlpha());
+    }
+    else
+    {
+        Simulate((float)mConfig.FixedStep);
+        Interpolate(1.0f);
+    }
+    AccumulateTiming(mReport.Stages[(uint8_t)HeadlessStage::UPDATE], ElapsedMs(stageStart));
+
+    stageStart = Clock::now();
+    Cull();
+    AccumulateTiming(mReport.Stages[(uint8_t)HeadlessStage::CULL], ElapsedMs(stageStart));
+
+    stageStart = Clock::now();
+    BinLights();
+    AccumulateTiming(mReport.Stages[(uint8_t)HeadlessStage::LIGHTS], ElapsedMs(stageStart));
+
+    stageStart = Clock::now();
+    CullShadowCasters();
+    AccumulateTiming(mReport.Stages[(uint8_t)HeadlessStage::SHADOWS], ElapsedMs(stageStart));
+
+    stageStart = Clock::now();
+    Build();
+    RequestTextureMips();
+    AccumulateTiming(mReport.Stages[(uint8_t)HeadlessStage::BUILD], ElapsedMs(stageStart));
+
+    stageStart = Clock::now();
+    BuildFrameGraph();
+    AccumulateTiming(mReport.Stages[(uint8_t)HeadlessStage::GRAPH], ElapsedMs(stageStart));
+
+    // Streaming uploads and copies record on the immediate context, so they land inside the frame
+    stageStart = Clock::now();
+    mpBackend->BeginFrame();
+    if (mConfig.GpuTiming)
+        mGPUProfiler.BeginFrame();
+    if (mpStreamingDevice)
+    {
+        mTextureStreamer.Update();
+        mReport.Streaming = mTextureStreamer.GetStats();
+    }
+    AccumulateTiming(mReport.Stages[(uint8_t)HeadlessStage::STREAM], ElapsedMs(stageStart));
+
+    stageStart = Clock::now();
+    Submit();
+    if (mConfig.GpuTiming)
+    {
+        mGPUProfiler.EndFrame();
+        mReport.GPU = mGPUProfiler.GetStats();
+    }
+    mpBackend->EndFrame();
+    AccumulateTiming(mReport.Stages[(uint8_t)HeadlessStage::SUBMIT], ElapsedMs(stageStart));
+
+    AccumulateTiming(mReport.Frame, ElapsedMs(frameStart));
+    mReport.Frames++;
+
+    // From the end of one frame to the end of the next, so time spent between frames counts too
+    mPacingTimer.Tick([] {});
+    mFrameStats.AddFrame(mPacingTimer);
+
+    MN_PROFILE_FRAME();
+}
+
+void HeadlessGame::Simulate(float dt)
+{
+    MN_PROFILE_FUNCTION();
+
+    mPrevTime = mTime;
+    mTime += dt;
+    mReport.SimulationSteps++;
+
+    const float time = (float)mTime;
+    const uint32_t previous = mCurrentTransform;
+    mCurrentTransform ^= 1;
+
+    // Each entity only touches its own data, so this splits cleanly across workers
+    mWorld.ParallelForEach<EntityMotion>([dt, time, previous](EntityMotion& motion)
+    {
+        EntityTransform const& from = motion.Transforms[previous];
+        EntityTransform& to = motion.Transforms[previous ^ 1];
+        to.Position[0] = from.Position[0];
+        to.Position[1] = 0.5f * sinf(time + motion.BobPhase);
+        to.Position[2] = from.Position[2];
+        to.Yaw = from.Yaw + motion.YawRate * dt;
+    }, kChunksPerJob);
+}
+
+void HeadlessGame::Interpolate(float alpha)
+{
+    MN_PROFILE_FUNCTION();
+
+    // At alpha 1 this has to reproduce the last step exactly, so lockstep runs keep their hashes
+    auto blend = [alpha](float from, float to) { return alpha >= 1.0f ? to : from + (to - from) * alpha; };
+
+    mInterpolationAlpha = alpha;
+    const float time = alpha >= 1.0f ? (float)mTime : (float)(mPrevTime + (mTime - mPrevTime) * alpha);
+
+    if (mConfig.pInputReplay)
+        ReplayInput();
+    else if (mConfig.pCameraPath)
+        mConfig.pCameraPath->Evaluate(time, mCameraPosition, mCameraForward);
+    else
+        GetOrbitCamera(mConfig.EntityCount, time, mCameraPosition, mCameraForward);
+
+    memcpy(&mCameraData[0], mCameraPosition, sizeof(mCameraPosition));
+    memcpy(&mCameraData[4], mCameraForward, sizeof(mCameraForward));
+    mCameraData[8] = time;
+
+    const uint32_t current = mCurrentTransform;
+    const ComponentMask mask = GetComponentMask<EntityMotion, EntityAppearance>();
+    mWorld.ParallelForEachChunk(mask, kChunksPerJob, [this, current, &blend](ChunkView const& chunk, uint32_t firstIndex)
+    {
+        EntityMotion const* motions = chunk.Get<EntityMotion>();
+        EntityAppearance const* appearances = chunk.Get<EntityAppearance>();
+        memcpy(&mAppearances[firstIndex], appearances, sizeof(EntityAppearance) * chunk.GetCount());
+
+        for (uint32_t i = 0; i != chunk.GetCount(); ++i)
+        {
+            EntityTransform const& from = motions[i].Transforms[current ^ 1];
+            EntityTransform const& to = motions[i].Transforms[current];
+            const float yaw = blend(from.Yaw, to.Yaw);
+            const float scale = appearances[i].Scale;
+
+            // World = Scale * RotationY * Translation, row vectors like DirectXMath
+            const float c = cosf(yaw) * scale;
+            const float s = sinf(yaw) * scale;
+            float* m = &mWorldMatrices[(firstIndex + i) * 16];
+            m[0]  = c;     m[1]  = 0.0f;    m[2]  = -s;    m[3]  = 0.0f;
+            m[4]  = 0.0f;  m[5]  = scale;   m[6]  = 0.0f;  m[7]  = 0.0f;
+            m[8]  = s;     m[9]  = 0.0f;    m[10] = c;     m[11] = 0.0f;
+            m[12] = blend(from.Position[0], to.Position[0]);
+            m[13] = blend(from.Position[1], to.Position[1]);
+            m[14] = blend(from.Position[2], to.Position[2]);
+            m[15] = 1.0f;
+        }
+    });
+}
+
+void HeadlessGame::ReplayInput()
+{
+    using Input::CommandBit;
+    using Input::GameCommands;
+
+    Input::InputFrame frame;
+    if (!mConfig.pInputReplay->Next(frame))
+        return;
+
+    const uint32_t commands = frame.Commands;
+    const float dt = frame.Dt;
+
+    // Turn first, then move along where it now faces. Rolls are dropped, this camera doesn't.
+    if (commands & CommandBit(GameCommands::CameraRotation))
+    {
+        mFreeCameraYaw += frame.MouseDeltaX * kFreeCameraSensitivity * dt;
+        mFreeCameraPitch -= frame.MouseDeltaY * kFreeCameraSensitivity * dt;
+        mFreeCameraPitch = std::max(-kFreeCameraMaxPitch, std::min(mFreeCameraPitch, kFreeCameraMaxPitch));
+    }
+
+    mCameraForward[0] = cosf(mFreeCameraPitch) * sinf(mFreeCameraYaw);
+    mCameraForward[1] = sinf(mFreeCameraPitch);
+    mCameraForward[2] = cosf(mFreeCameraPitch) * cosf(mFreeCameraYaw);
+
+    float right[3], up[3];
+    GetCameraBasis(mCameraForward, right, up);
+
+    const float distance = kFreeCameraSpeed * dt;
+    const float forwardMove = distance * (((commands & CommandBit(GameCommands::MoveForward)) ? 1.0f : 0.0f) - ((commands & CommandBit(GameCommands::MoveBackward)) ? 1.0f : 0.0f));
+    const float rightMove = distance * (((commands & CommandBit(GameCommands::MoveRight)) ? 1.0f : 0.0f) - ((commands & CommandBit(GameCommands::MoveLeft)) ? 1.0f : 0.0f));
+    const float upMove = (commands & CommandBit(GameCommands::MoveUp)) ? distance : 0.0f;
+    for (uint32_t axis = 0; axis != 3; ++axis)
+        mCameraPosition[axis] += mCameraForward[axis] * forwardMove + right[axis] * rightMove + up[axis] * upMove;
+}
+
+uint64_t HeadlessGame::GetSimulationHash() const
+{
+    uint64_t hash = fnv1a64(&mTime, sizeof(mTime));
+    mWorld.ForEachChunk(GetComponentMask<EntityMotion>(), [this, &hash](ChunkView const& chunk, uint32_t)
+    {
+        EntityMotion const* motions = chunk.Get<EntityMotion>();
+        for (uint32_t i = 0; i != chunk.GetCount(); ++i)
+            hash = fnv1a64(&motions[i].Transforms[mCurrentTransform], sizeof(EntityTransform), hash);
+    });
+    return hash;
+}
+
+void HeadlessGame::Cull()
+{
+    MN_PROFILE_FUNCTION();
+
+    // Build inward-facing side planes straight from the camera basis, no matrices needed
+    const float* f = mCameraForward;
+    float right[3];
+    float up[3];
+    GetCameraBasis(f, right, up);
+
+    const float tanY = tanf(0.5f * kCameraFovY);
+    const float tanX = tanY * kCameraAspect;
+
+    float planes[4][3];
+    for (int i = 0; i != 3; ++i)
+    {
+        planes[0][i] = tanX * f[i] + right[i];
+        planes[1][i] = tanX * f[i] - right[i];
+        planes[2][i] = tanY * f[i] + up[i];
+        planes[3][i] = tanY * f[i] - up[i];
+    }
+    for (float* plane : planes)
+        Normalize3(plane);
+
+    // Flags are written in parallel, then compacted in entity order so the result is deterministic
+    const uint32_t count = mConfig.EntityCount;
+    uint8_t* visibleFlags = Memory::GetFrameArena().AllocArray<uint8_t>(count);
+    mVisible = Memory::GetFrameArena().AllocArray<uint32_t>(count);
+
+    const float* eye = mCameraPosition;
+    JobCounter counter;
+    JobSystem::Dispatch(counter, count, kJobGroupSize, [&](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t i = begin; i != end; ++i)
+        {
+            // Where the entity is drawn, which between steps isn't where it is
+            const float* position = &mWorldMatrices[i * 16 + 12];
+            const float toCenter[3] = { position[0] - eye[0], position[1] - eye[1], position[2] - eye[2] };
+            const float radius = mAppearances[i].Scale * 1.7320508f; // Unit cube bounding sphere
+
+            const float depth = Dot3(toCenter, f);
+            bool visible = depth + radius > kCameraNear && depth - radius < kCameraFar;
+            for (int p = 0; visible && p != 4; ++p)
+                visible = Dot3(planes[p], toCenter) >= -radius;
+
+            visibleFlags[i] = visible ? 1 : 0;
+        }
+    });
+    JobSystem::Wait(counter);
+
+    mVisibleCount = 0;
+    for (uint32_t i = 0; i != count; ++i)
+    {
+        if (visibleFlags[i])
+            mVisible[mVisibleCount++] = i;
+    }
+}
+
+void HeadlessGame::BinLights()
+{
+    MN_PROFILE_FUNCTION();
+
+    using namespace Renderer;
+
+    if (!mConfig.LightCount)
+        return;
+
+    // A different run of the lights bobs each frame, so the upload is one range. They were added to
+    // an empty table in order, so light i is entry i.
+    const float time = (float)mTime;
+    const uint32_t runLength = (mConfig.LightCount + kMovingLightRuns - 1) / kMovingLightRuns;
+    const uint32_t runBegin = (mReport.Frames % kMovingLightRuns) * runLength;
+    const uint32_t runEnd = std::min(runBegin + runLength, mConfig.LightCount);
+    for (uint32_t i = runBegin; i < runEnd; ++i)
+    {
+        ClusterLight light = mClusteredLighting.GetLight(i);
+        light.Position[1] = 1.75f + 1.25f * sinf(time + (float)i);
+        mClusteredLighting.UpdateLight(i, light);
+    }
+
+    ClusterView view;
+    GetCameraView(mCameraPosition, mCameraForward, view.View);
+    view.ProjScaleY = 1.0f / tanf(0.5f * kCameraFovY);
+    view.ProjScaleX = view.ProjScaleY / kCameraAspect;
+    view.Near = kCameraNear;
+    view.Far = kCameraFar;
+
+    mClusteredLighting.Build(view);
+    mReport.Lights = mClusteredLighting.GetStats();
+}
+
+void HeadlessGame::CullShadowCasters()
+{
+    MN_PROFILE_FUNCTION();
+
+    using namespace Renderer;
+
+    mShadowBatchCount = 0;
+    mShadowInstanceCount = 0;
+    if (!mConfig.ShadowCascades)
+        return;
+
+    ShadowView view;
+    GetCameraView(mCameraPosition, mCameraForward, view.View);
+    view.ProjScaleY = 1.0f / tanf(0.5f * kCameraFovY);
+    view.ProjScaleX = view.ProjScaleY / kCameraAspect;
+    view.Near = kCameraNear;
+    view.Far = kCameraFar;
+    memcpy(view.LightDirection, kSunDirection, sizeof(kSunDirection));
+    Normalize3(view.LightDirection);
+
+    mShadows.Update(view);
+    mReport.ShadowCascadesRendered += mShadows.GetStats().CascadesRendered;
+    mReport.ShadowCascadesCached += mShadows.GetStats().CascadesCached;
+
+    // Every entity can cast, whether or not the camera sees it
+    const uint32_t count = mConfig.EntityCount;
+    Memory::LinearArena& frameArena = Memory::GetFrameArena();
+    ShadowCaster* casters = frameArena.AllocArray<ShadowCaster>(count);
+    for (uint32_t i = 0; i != count; ++i)
+    {
+        const float* position = &mWorldMatrices[i * 16 + 12];
+        casters[i] = { { position[0], position[1], position[2] }, mAppearances[i].Scale * 1.7320508f };
+    }
+
+    uint8_t* masks = frameArena.AllocArray<uint8_t>(count);
+    mShadows.CullCasters(casters, count, masks);
+
+    // Counting sort into one batch per (cascade, mesh), in entity order so the result is deterministic
+    const uint32_t cascadeCount = mShadows.GetCascadeCount();
+    const uint32_t batchSlots = cascadeCount * mConfig.MeshCount;
+    uint32_t* counts = frameArena.AllocArray<uint32_t>(batchSlots);
+    memset(counts, 0, sizeof(uint32_t) * batchSlots);
+    for (uint32_t i = 0; i != count; ++i)
+    {
+        for (uint32_t c = 0; c != cascadeCount; ++c)
+        {
+            if (masks[i] & (1u << c))
+                counts[c * mConfig.MeshCount + mAppearances[i].MeshIndex]++;
+        }
+    }
+
+    mShadowBatches = frameArena.AllocArray<ShadowBatch>(batchSlots);
+    uint32_t* cursors = frameArena.AllocArray<uint32_t>(batchSlots);
+    for (uint32_t slot = 0; slot != batchSlots; ++slot)
+    {
+        cursors[slot] = mShadowInstanceCount;
+        if (!counts[slot])
+            continue;
+
+        ShadowBatch& batch = mShadowBatches[mShadowBatchCount++];
+        batch.Cascade       = (uint16_t)(slot / mConfig.MeshCount);
+        batch.MeshIndex     = (uint16_t)(slot % mConfig.MeshCount);
+        batch.FirstInstance = mShadowInstanceCount;
+        batch.InstanceCount = counts[slot];
+        mShadowInstanceCount += counts[slot];
+    }
+
+    mShadowInstanceData = frameArena.AllocArray<float>(std::max(mShadowInstanceCount, 1u) * 16);
+    for (uint32_t i = 0; i != count; ++i)
+    {
+        for (uint32_t c = 0; c != cascadeCount; ++c)
+        {
+            if (masks[i] & (1u << c))
+                memcpy(&mShadowInstanceData[cursors[c * mConfig.MeshCount + mAppearances[i].MeshIndex]++ * 16], &mWorldMatrices[i * 16], kInstanceStride);
+        }
+    }
+}
+
+void HeadlessGame::Build()
+{
+    MN_PROFILE_FUNCTION();
+
+    // Counting sort of the visible entities into one batch per (shading group, mesh)
+    const uint32_t batchSlots = mGroupCount * mConfig.MeshCount;
+    Memory::LinearArena& frameArena = Memory::GetFrameArena();
+
+    uint32_t* counts = frameArena.AllocArray<uint32_t>(batchSlots);
+    memset(counts, 0, sizeof(uint32_t) * batchSlots);
+
+    for (uint32_t v = 0; v != mVisibleCount; ++v)
+    {
+        EntityAppearance const& e = mAppearances[mVisible[v]];
+        counts[mMaterials[e.MaterialIndex].Group * mConfig.MeshCount + e.MeshIndex]++;
+    }
+
+    mBatches = frameArena.AllocArray<DrawBatch>(batchSlots);
+    mBatchCount = 0;
+
+    uint32_t* cursors = frameArena.AllocArray<uint32_t>(batchSlots);
+    uint32_t firstInstance = 0;
+    for (uint32_t slot = 0; slot != batchSlots; ++slot)
+    {
+        cursors[slot] = firstInstance;
+        if (!counts[slot])
+            continue;
+
+        DrawBatch& batch = mBatches[mBatchCount++];
+        batch.GroupIndex    = (uint16_t)(slot / mConfig.MeshCount);
+        batch.MeshIndex     = (uint16_t)(slot % mConfig.MeshCount);
+        batch.FirstInstance = firstInstance;
+        batch.InstanceCount = counts[slot];
+        firstInstance += counts[slot];
+    }
+
+    mInstanceData = frameArena.AllocArray<float>(std::max(mVisibleCount, 1u) * 16);
+    mInstanceMaterials = frameArena.AllocArray<uint32_t>(std::max(mVisibleCount, 1u));
+    for (uint32_t v = 0; v != mVisibleCount; ++v)
+    {
+        const uint32_t entityIndex = mVisible[v];
+        EntityAppearance const& e = mAppearances[entityIndex];
+        MaterialResources const& material = mMaterials[e.MaterialIndex];
+        const uint32_t dst = cursors[material.Group * mConfig.MeshCount + e.MeshIndex]++;
+        memcpy(&mInstanceData[dst * 16], &mWorldMatrices[entityIndex * 16], kInstanceStride);
+        mInstanceMaterials[dst] = mConfig.BindlessMaterials ? material.TableIndex : material.Slice;
+    }
+}
+
+void HeadlessGame::RequestTextureMips()
+{
+    MN_PROFILE_FUNCTION();
+
+    if (!mpStreamingDevice)
+        return;
+
+    // On-screen height of each visible entity's bounding sphere, assuming its UVs cover it once
+    const float pixelsPerUnit = (float)kFrameHeight / (2.0f * tanf(0.5f * kCameraFovY));
+    for (uint32_t v = 0; v != mVisibleCount; ++v)
+    {
+        EntityAppearance const& e = mAppearances[mVisible[v]];
+        const float* position = &mWorldMatrices[mVisible[v] * 16 + 12];
+        const float toCenter[3] = { position[0] - mCameraPosition[0], position[1] - mCameraPosition[1], position[2] - mCameraPosition[2] };
+        const float radius = e.Scale * 1.7320508f;
+        const float depth = std::max(Dot3(toCenter, mCameraForward), radius);
+
+        mTextureStreamer.RequestScreenSize(mMaterials[e.MaterialIndex].StreamedDiffuse, 2.0f * radius * pixelsPerUnit / depth);
+    }
+}
+
+void HeadlessGame::BuildFrameGraph()
+{
+    MN_PROFILE_FUNCTION();
+
+    using namespace Renderer;
+
+    mFrameGraph.Reset();
+
+    const uint32_t w = kFrameWidth;
+    const uint32_t h = kFrameHeight;
+    RGResource backBuffer   = mFrameGraph.ImportTexture("BackBuffer", { w, h, 0, 4, 1 }, RGState::PRESENT, RGState::PRESENT);
+    // Cached cascades keep their contents across frames, so with shadows on the map outlives the graph.
+    // The graph has no arrays, so the cascades sit side by side.
+    RGResource shadowMap = mConfig.ShadowCascades
+        ? mFrameGraph.ImportTexture("ShadowMap", { kShadowResolution * mConfig.ShadowCascades, kShadowResolution, 0, 4, 1 }, RGState::SHADER_READ, RGState::SHADER_READ)
+        : mFrameGraph.CreateTexture("ShadowMap", { 2048, 2048, 0, 4, 1 });
+    RGResource sceneDepth   = mFrameGraph.CreateTexture("SceneDepth",   { w, h, 0, 4, 1 });
+    RGResource sceneColor   = mFrameGraph.CreateTexture("SceneColor",   { w, h, 0, 8, 1 });
+    RGResource bloomHalf    = mFrameGraph.CreateTexture("BloomHalf",    { w / 2, h / 2, 0, 8, 1 });
+    RGResource bloomQuarter = mFrameGraph.CreateTexture("BloomQuarter", { w / 4, h / 4, 0, 8, 1 });
+    RGResource debugOverlay = mFrameGraph.CreateTexture("DebugOverlay", { w, h, 0, 4, 1 });
+
+    RenderGraph::ExecuteFn drawShadows;
+    if (mConfig.ShadowCascades)
+        drawShadows = [this](void*)
+        {
+            Renderer::GPUProfileScope gpuScope(mConfig.GpuTiming ? &mGPUProfiler : nullptr, *mpBackend, "Shadow");
+            SubmitShadows();
+        };
+
+    RGPass shadow = mFrameGraph.AddPass("Shadow", drawShadows);
+    mFrameGraph.Write(shadow, shadowMap, RGState::DEPTH_WRITE);
+
+    RGPass prepass = mFrameGraph.AddPass("DepthPrepass", nullptr);
+    mFrameGraph.Write(prepass, sceneDepth, RGState::DEPTH_WRITE);
+
+    RGPass forward = mFrameGraph.AddPass("Forward", [this](void*)
+    {
+        Renderer::GPUProfileScope gpuScope(mConfig.GpuTiming ? &mGPUProfiler : nullptr, *mpBackend, "Forward");
+        if (mConfig.IndirectDraws)
+            SubmitSceneIndirect();
+        else
+            SubmitScene();
+    });
+    mFrameGraph.Read(forward, shadowMap);
+    mFrameGraph.Read(forward, sceneDepth, RGState::DEPTH_READ);
+    mFrameGraph.Write(forward, sceneColor);
+
+    RGPass sky = mFrameGraph.AddPass("Sky", nullptr);
+    mFrameGraph.Read(sky, sceneDepth, RGState::DEPTH_READ);
+    mFrameGraph.Write(sky, sceneColor);
+
+    RGPass bloomDown = mFrameGraph.AddPass("BloomDown", nullptr);
+    mFrameGraph.Read(bloomDown, sceneColor);
+    mFrameGraph.Write(bloomDown, bloomHalf);
+
+    RGPass bloomDown2 = mFrameGraph.AddPass("BloomDown2", nullptr);
+    mFrameGraph.Read(bloomDown2, bloomHalf);
+    mFrameGraph.Write(bloomDown2, bloomQuarter);
+
+    RGPass tonemap = mFrameGraph.AddPass("Tonemap", nullptr);
+    mFrameGraph.Read(tonemap, sceneColor);
+    mFrameGraph.Read(tonemap, bloomQuarter);
+    mFrameGraph.Write(tonemap, backBuffer);
+
+    // Nothing reads this, so the graph should cull it
+    RGPass debug = mFrameGraph.AddPass("DebugOverlay", nullptr);
+    mFrameGraph.Write(debug, debugOverlay);
+
+    mFrameGraph.Compile();
+    mReport.Graph = mFrameGraph.GetStats();
+}
+
+void HeadlessGame::Submit()
+{
+    MN_PROFILE_FUNCTION();
+
+    // The null backend has no resource states, so barriers only show up in the graph stats
+    mFrameGraph.Execute(nullptr, nullptr);
+}
+
+void HeadlessGame::SubmitScene()
+{
+    using namespace Renderer;
+
+    // Uploads stay on the immediate context; only binds and draws are recorded in parallel
+    UploadInstances();
+
+    // Batches are contiguous per context, so each context keeps most of the material sorting
+    mReport.RecordContexts += RecordParallel(*mpBackend, nullptr, mBatchCount, kMinBatchesPerContext, [this](IRenderContext& context, uint32_t begin, uint32_t end)
+    {
+        RecordBatches(context, begin, end);
+    });
+
+    AccountScene();
+}
+
+void HeadlessGame::SubmitShadows()
+{
+    using namespace Renderer;
+
+    if (!mShadowBatchCount)
+        return;
+
+    mpBackend->UpdateBuffer(mShadowInstanceBuffer, mShadowInstanceData, mShadowInstanceCount * kInstanceStride);
+    mReport.UploadBytes += (uint64_t)mShadowInstanceCount * kInstanceStride;
+
+    // Depth only: the same cube geometry, one view projection per cascade and no material state at all
+    mpBackend->SetShaders(mShadowVertexShader, mShadowPixelShader);
+    mpBackend->SetVertexBuffer(0, mGeometryVertexBuffer, kVertexStride);
+    mpBackend->SetVertexBuffer(1, mShadowInstanceBuffer, kInstanceStride);
+    mpBackend->SetIndexBuffer(mGeometryIndexBuffer);
+
+    uint32_t boundCascade = UINT32_MAX;
+    for (uint32_t b = 0; b != mShadowBatchCount; ++b)
+    {
+        ShadowBatch const& batch = mShadowBatches[b];
+        if (batch.Cascade != boundCascade)
+        {
+            ShadowCascade const& cascade = mShadows.GetCascade(batch.Cascade);
+            mpBackend->UpdateBuffer(mShadowCascadeBuffers[batch.Cascade], cascade.ViewProjection, sizeof(cascade.ViewProjection));
+            mpBackend->SetConstantBuffer(ShaderStage::VERTEX, 0, mShadowCascadeBuffers[batch.Cascade]);
+            mReport.UploadBytes += sizeof(cascade.ViewProjection);
+            boundCascade = batch.Cascade;
+        }
+
+        MeshResources const& mesh = mMeshes[batch.MeshIndex];
+        mpBackend->DrawIndexedInstanced(mesh.IndexCount, batch.InstanceCount, mesh.FirstIndex, mesh.BaseVertex, batch.FirstInstance);
+        mReport.ShadowDraws++;
+        mReport.ShadowInstances += batch.InstanceCount;
+    }
+
+    mReport.CommandHash = fnv1a64(mShadowBatches, sizeof(ShadowBatch) * mShadowBatchCount, mReport.CommandHash);
+}
+
+void HeadlessGame::AccountScene()
+{
+    // Counted from the batches rather than the backend, so direct and indirect submission report the same work
+    for (uint32_t b = 0; b != mBatchCount; ++b)
+    {
+        DrawBatch const& batch = mBatches[b];
+        MeshResources const& mesh = mMeshes[batch.MeshIndex];
+
+        mReport.DrawCalls++;
+        mReport.Instances += batch.InstanceCount;
+        mReport.Triangles += (uint64_t)(mesh.IndexCount / 3) * batch.InstanceCount;
+    }
+
+    mReport.UploadBytes += sizeof(mCameraData) + (uint64_t)mVisibleCount * kInstanceStride;
+    if (mInstanceMaterialBuffer != Renderer::kInvalidBackendHandle)
+        mReport.UploadBytes += (uint64_t)mVisibleCount * sizeof(uint32_t);
+
+    // Fold this frame's visible set and draw order into the run hash
+    mReport.CommandHash = fnv1a64(mVisible, sizeof(uint32_t) * mVisibleCount, mReport.CommandHash);
+    mReport.CommandHash = fnv1a64(mBatches, sizeof(DrawBatch) * mBatchCount, mReport.CommandHash);
+    if (mLightBuffer != Renderer::kInvalidBackendHandle)
+    {
+        mReport.CommandHash = fnv1a64(mClusteredLighting.GetGrid(), sizeof(Renderer::ClusterRange) * mClusteredLighting.GetClusterCount(), mReport.CommandHash);
+        mReport.CommandHash = fnv1a64(mClusteredLighting.GetLightIndices(), sizeof(uint32_t) * mClusteredLighting.GetLightIndexCount(), mReport.CommandHash);
+    }
+}
+
+void HeadlessGame::SubmitSceneIndirect()
+{
+    using namespace Renderer;
+
+    // Same batches as the direct path, packed into argument records instead of issued one by one
+    IndirectDrawBuilder builder;
+    builder.Begin(Memory::GetFrameArena(), mBatchCount);
+    for (uint32_t b = 0; b != mBatchCount; ++b)
+    {
+        DrawBatch const& batch = mBatches[b];
+        MeshResources const& mesh = mMeshes[batch.MeshIndex];
+
+        const DrawIndexedArgs args = { mesh.IndexCount, batch.InstanceCount, mesh.FirstIndex, mesh.BaseVertex, batch.FirstInstance };
+        const IndirectDrawData data = { batch.GroupIndex, batch.MeshIndex, batch.FirstInstance, batch.InstanceCount };
+        builder.Add(args, data);
+    }
+
+    UploadInstances();
+
+    if (builder.GetDrawCount())
+    {
+        mpBackend->UpdateBuffer(mDrawArgsBuffer, builder.GetArgs(), builder.GetArgsByteSize());
+        mpBackend->UpdateBuffer(mDrawDataBuffer, builder.GetDrawData(), builder.GetDrawDataByteSize());
+
+        BindFrameState(*mpBackend);
+
+        // One shader pair for everything: the group comes from the per-draw data, and its
+        // texture from the table bound below instead of a bind per batch
+        MaterialResources const& shared = mMaterials[0];
+        mpBackend->SetShaders(shared.VertexShader, shared.PixelShader);
+        for (uint32_t g = 0; g != mGroupCount; ++g)
+        {
+            if (GetDiffuse(g) != kInvalidBackendHandle)
+                mpBackend->SetTexture(ShaderStage::PIXEL, g, GetDiffuse(g));
+        }
+        mpBackend->SetStructuredBuffer(ShaderStage::VERTEX, 0, mDrawDataBuffer);
+
+        mpBackend->ExecuteIndirect(mDrawArgsBuffer, builder.GetDrawCount());
+        mReport.IndirectSubmissions++;
+    }
+
+    mReport.UploadBytes += builder.GetArgsByteSize() + builder.GetDrawDataByteSize();
+    AccountScene();
+}
+
+void HeadlessGame::UploadInstances()
+{
+    UploadMaterialTable();
+    UploadLights();
+
+    mpBackend->UpdateBuffer(mCameraBuffer, mCameraData, sizeof(mCameraData));
+    if (!mVisibleCount)
+        return;
+
+    mpBackend->UpdateBuffer(mInstanceBuffer, mInstanceData, mVisibleCount * kInstanceStride);
+    if (mInstanceMaterialBuffer != Renderer::kInvalidBackendHandle)
+        mpBackend->UpdateBuffer(mInstanceMaterialBuffer, mInstanceMaterials, mVisibleCount * (uint32_t)sizeof(uint32_t));
+}
+
+void HeadlessGame::UploadMaterialTable()
+{
+    using namespace Renderer;
+
+    if (mMaterialTableBuffer == kInvalidBackendHandle)
+        return;
+
+    // Streamed textures get new handles as mips come and go, which only dirties the entries that moved
+    if (mpStreamingDevice)
+    {
+        for (uint32_t i = 0; i != mConfig.MaterialCount; ++i)
+        {
+            MaterialResources const& material = mMaterials[i];
+            const TextureHandle handle = mTextureStreamer.GetHandle(material.StreamedDiffuse);
+
+            GPUMaterial entry = mMaterialTable.Get(material.TableIndex);
+            entry.DiffuseIndex = handle != kInvalidBackendHandle ? handle : kNoDescriptor;
+            mMaterialTable.Update(material.TableIndex, entry);
+        }
+    }
+
+    mMaterialTable.CollectDirtyRanges(mMaterialRanges);
+    for (GPUTableRange const& range : mMaterialRanges)
+    {
+        const uint32_t byteSize = range.Count * (uint32_t)sizeof(GPUMaterial);
+        mpBackend->UpdateBufferRange(mMaterialTableBuffer, range.First * (uint32_t)sizeof(GPUMaterial), mMaterialTable.GetData() + range.First, byteSize);
+
+        mReport.UploadBytes += byteSize;
+        mReport.MaterialEntriesUploaded += range.Count;
+        mReport.MaterialUploads++;
+    }
+}
+
+void HeadlessGame::UploadLights()
+{
+    using namespace Renderer;
+
+    if (mLightBuffer == kInvalidBackendHandle)
+        return;
+
+    mClusteredLighting.CollectDirtyLights(mLightRanges);
+    for (GPUTableRange const& range : mLightRanges)
+    {
+        const uint32_t byteSize = range.Count * (uint32_t)sizeof(ClusterLight);
+        mpBackend->UpdateBufferRange(mLightBuffer, range.First * (uint32_t)sizeof(ClusterLight), mClusteredLighting.GetLightData() + range.First, byteSize);
+
+        mReport.UploadBytes += byteSize;
+        mReport.LightEntriesUploaded += range.Count;
+        mReport.LightUploads++;
+    }
+
+    // The grid follows the camera, so it goes up whole
+    const uint32_t gridBytes = mClusteredLighting.GetClusterCount() * (uint32_t)sizeof(ClusterRange);
+    const uint32_t indexBytes = mClusteredLighting.GetLightIndexCount() * (uint32_t)sizeof(uint32_t);
+    mpBackend->UpdateBuffer(mClusterGridBuffer, mClusteredLighting.GetGrid(), gridBytes);
+    if (indexBytes)
+        mpBackend->UpdateBuffer(mLightIndexBuffer, mClusteredLighting.GetLightIndices(), indexBytes);
+    mReport.UploadBytes += gridBytes + indexBytes;
+}
+
+void HeadlessGame::BindFrameState(Renderer::IRenderContext& context) const
+{
+    using namespace Renderer;
+
+    context.SetConstantBuffer(ShaderStage::VERTEX, 0, mCameraBuffer);
+    context.SetVertexBuffer(0, mGeometryVertexBuffer, kVertexStride);
+    context.SetVertexBuffer(1, mInstanceBuffer, kInstanceStride);
+    if (mInstanceMaterialBuffer != kInvalidBackendHandle)
+        context.SetVertexBuffer(2, mInstanceMaterialBuffer, sizeof(uint32_t));
+    if (mMaterialTableBuffer != kInvalidBackendHandle)
+        context.SetStructuredBuffer(ShaderStage::PIXEL, 0, mMaterialTableBuffer);
+    if (mLightBuffer != kInvalidBackendHandle)
+    {
+        context.SetStructuredBuffer(ShaderStage::PIXEL, kClusterLightSlot, mLightBuffer);
+        context.SetStructuredBuffer(ShaderStage::PIXEL, kClusterGridSlot, mClusterGridBuffer);
+        context.SetStructuredBuffer(ShaderStage::PIXEL, kClusterIndicesSlot, mLightIndexBuffer);
+    }
+    context.SetIndexBuffer(mGeometryIndexBuffer);
+}
+
+void HeadlessGame::RecordBatches(Renderer::IRenderContext& context, uint32_t begin, uint32_t end) const
+{
+    MN_PROFILE_FUNCTION();
+
+    using namespace Renderer;
+
+    // Contexts start empty, so every range binds its own frame state
+    BindFrameState(context);
+
+    // Batches are sorted by shading group first, so only rebind what actually changed.
+    // Meshes share one set of buffers and never need a rebind.
+    uint32_t boundGroup = UINT32_MAX;
+    for (uint32_t b = begin; b != end; ++b)
+    {
+        DrawBatch const& batch = mBatches[b];
+
+        if (batch.GroupIndex != boundGroup)
+        {
+            MaterialResources const& material = mMaterials[mGroups[batch.GroupIndex].FirstMaterial];
+            context.SetShaders(material.VertexShader, material.PixelShader);
+            if (GetDiffuse(batch.GroupIndex) != kInvalidBackendHandle)
+                context.SetTexture(ShaderStage::PIXEL, 0, GetDiffuse(batch.GroupIndex));
+            boundGroup = batch.GroupIndex;
+        }
+
+        MeshResources const& mesh = mMeshes[batch.MeshIndex];
+        context.DrawIndexedInstanced(mesh.IndexCount, batch.InstanceCount, mesh.FirstIndex, mesh.BaseVertex, batch.FirstInstance);
+    }
+}
+
+Renderer::TextureHandle HeadlessGame::GetDiffuse(uint32_t groupIndex) const
+{
+    ShadingGroup const& group = mGroups[groupIndex];
+    if (group.Page != Renderer::kInvalidBackendHandle || mConfig.BindlessMaterials)
+        return group.Page;
+
+    // Streamed handles change whenever residency does, so never cache them past Update
+    MaterialResources const& material = mMaterials[group.FirstMaterial];
+    return mpStreamingDevice ? mTextureStreamer.GetHandle(material.StreamedDiffuse) : material.Diffuse;
+}
+
+float HeadlessGame::GetGridHalfExtent(uint32_t entityCount)
+{
+    const uint32_t side = (uint32_t)ceil(sqrt((double)entityCount));
+    return side ? 0.5f * kGridSpacing * (float)(side - 1) : 0.0f;
+}
+
+const char* HeadlessGame::GetStageName(HeadlessStage stage)
+{
+    switch (stage)
+    {
+    case HeadlessStage::UPDATE:  return "Update";
+    case HeadlessStage::CULL:    return "Cull";
+    case HeadlessStage::LIGHTS:  return "Lights";
+    case HeadlessStage::SHADOWS: return "Shadows";
+    case HeadlessStage::BUILD:   return "Build";
+    case HeadlessStage::GRAPH:   return "Graph";
+    case HeadlessStage::STREAM:  return "Stream";
+    case HeadlessStage::SUBMIT:  return "Submit";
+    default:                     return "Unknown";
+    }
+}
+
+}
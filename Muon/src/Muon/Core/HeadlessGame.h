@@ -0,0 +1,372 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Windowless game loop that drives the CPU side of a frame
+against an IRenderBackend with a fixed timestep, timing each stage.
+Does not touch D3D or the OS, so it runs anywhere the null backend does.
+----------------------------------------------*/
+#ifndef MUON_HEADLESSGAME_H
+#define MUON_HEADLESSGAME_H
+
+#include <Muon/Core/CameraPath.h>
+#include <Muon/Core/Clock.h>
+#include <Muon/Core/FrameStatistics.h>
+#include <Muon/Core/StepTimer.h>
+#include <Muon/Core/World.h>
+#include <Muon/Input/InputRecording.h>
+#include <Muon/Memory/Allocators.h>
+#include <Muon/Renderer/CascadedShadows.h>
+#include <Muon/Renderer/ClusteredLighting.h>
+#include <Muon/Renderer/GPUProfiler.h>
+#include <Muon/Renderer/MaterialTable.h>
+#include <Muon/Renderer/RenderBackend.h>
+#include <Muon/Renderer/RenderGraph.h>
+#include <Muon/Renderer/TexturePacker.h>
+#include <Muon/Renderer/TextureStreamer.h>
+
+#include <stdint.h>
+#include <vector>
+
+namespace Core {
+
+struct HeadlessConfig
+{
+    uint32_t EntityCount   = 4096;
+    uint32_t MeshCount     = 4;
+    uint32_t MaterialCount = 3;
+    uint32_t FrameCount    = 600;
+    uint32_t Seed          = 1;
+    double   FixedStep     = 1.0 / 60.0;
+
+    // Seconds each frame moves a virtual clock on by. Frames then run however many fixed steps fit
+    // and render their entities between the last two. 0 runs exactly one step per frame.
+    // Anything over a tenth of a second is clamped like StepTimer clamps a debugger pause.
+    double   RenderStep    = 0.0;
+
+    // Submit every batch with one ExecuteIndirect instead of a DrawIndexedInstanced each
+    bool     IndirectDraws = false;
+
+    // Stream every material's diffuse map under this budget instead of keeping a small one fully resident. 0 turns streaming off.
+    uint32_t TextureBudgetKB   = 0;
+
+    // Simulated read speed for streamed mips, 0 reads instantly
+    uint32_t StreamingReadMBps = 0;
+
+    // Pack the diffuse maps into texture arrays, so materials that only differ by texture share batches.
+    // Each instance carries its slice. Ignored when streaming.
+    bool     TextureArrays     = false;
+
+    // Keep every material in one GPU material table and let each instance carry its entry, so a
+    // batch covers any mix of materials. Overrides TextureArrays.
+    bool     BindlessMaterials = false;
+
+    // Point and spot lights scattered over the grid and binned into clusters every frame, an eighth
+    // of them moving each frame. 0 turns clustered lighting off.
+    uint32_t LightCount        = 0;
+
+    // Cascaded shadow maps from a fixed sun, the far half of them cached. 0 turns shadows off.
+    uint32_t ShadowCascades    = 0;
+
+    // Time the frame and its shadow and forward passes with GPU timestamps. Doesn't change the command hash.
+    bool     GpuTiming         = false;
+
+    // What frame pacing is measured against. Null is the system clock; a virtual one makes the pacing stats reproducible.
+    IClock*  pPacingClock      = nullptr;
+
+    // Flies the camera along this instead of orbiting the grid. Read every frame, so it must outlive the game.
+    CameraPath const* pCameraPath = nullptr;
+
+    // Flies a free camera from the orbit's starting point on these recorded commands, one recorded
+    // frame per frame, like GameInput flies the game's. It holds still once they run out. Overrides pCameraPath.
+    Input::InputReplay* pInputReplay = nullptr;
+};
+
+enum class HeadlessStage : uint8_t
+{
+    UPDATE,
+    CULL,
+    LIGHTS,
+    SHADOWS,
+    BUILD,
+    GRAPH,
+    STREAM,
+    SUBMIT,
+    COUNT
+};
+
+struct StageTiming
+{
+    double TotalMs;
+    double MinMs;
+    double MaxMs;
+};
+
+struct HeadlessReport
+{
+    uint32_t    Frames;
+    StageTiming Stages[(uint8_t)HeadlessStage::COUNT];
+    StageTiming Frame;
+
+    uint64_t    DrawCalls;
+    uint64_t    Instances;
+    uint64_t    Triangles;
+    uint64_t    UploadBytes;
+    uint64_t    RecordContexts;  // Deferred contexts the scene was recorded on, 1 when it stayed inline
+    uint64_t    IndirectSubmissions;
+    uint32_t    ShadingGroups;   // Materials, or the texture array pages they were packed into
+    uint64_t    MaterialEntriesUploaded;
+    uint64_t    MaterialUploads; // Ranges of the material table uploaded
+    uint64_t    LightEntriesUploaded;
+    uint64_t    LightUploads;    // Ranges of the light table uploaded
+
+    uint64_t    ShadowDraws;
+    uint64_t    ShadowInstances;         // Casters drawn, counted once per cascade they went into
+    uint64_t    ShadowCascadesRendered;
+    uint64_t    ShadowCascadesCached;    // Kept the map from an earlier frame
+
+    // As of the last frame, only filled in with lights
+    Renderer::ClusterStats Lights;
+
+    // From the last compiled frame graph
+    Renderer::RGStats Graph;
+
+    // As of the last frame, only filled in when streaming
+    Renderer::TextureStreamerStats Streaming;
+
+    // Only filled in with GPU timing. Trails the CPU by the frames still in flight.
+    Renderer::GPUTimingStats GPU;
+
+    uint64_t    SimulationSteps;
+
+    // fnv1a over every frame's visible set and draw batches. Identical configs must produce identical values.
+    uint64_t    CommandHash;
+};
+
+class HeadlessGame
+{
+public:
+    HeadlessGame();
+    ~HeadlessGame();
+
+    // The backend must outlive the game. Memory::Init must have been called.
+    bool Init(Renderer::IRenderBackend* pBackend, HeadlessConfig const& config);
+    void Shutdown();
+
+    // Runs one frame's fixed steps and submits it, accumulating into the report
+    void Frame();
+
+    // Runs config.FrameCount frames from a fresh report
+    HeadlessReport Run();
+
+    HeadlessReport const& GetReport() const { return mReport; }
+
+    // Every frame's duration on the pacing clock, from the start of the run
+    FrameStatistics const& GetFrameStatistics() const { return mFrameStats; }
+
+    // fnv1a over the simulation's current state. Equal after the same number of steps at any render rate.
+    uint64_t GetSimulationHash() const;
+
+    // How far the last frame rendered between the last two steps
+    float GetInterpolationAlpha() const { return mInterpolationAlpha; }
+
+    static const char* GetStageName(HeadlessStage stage);
+
+    // Entities are laid out in a square this far either side of the origin, for placing cameras and lights
+    static float GetGridHalfExtent(uint32_t entityCount);
+
+private:
+    // What a fixed step changes
+    struct EntityTransform
+    {
+        float Position[3];
+        float Yaw;
+    };
+
+    // What Simulate moves, and how
+    struct EntityMotion
+    {
+        EntityTransform Transforms[2];  // [mCurrentTransform] is the last step, the other the one before
+        float    YawRate;
+        float    BobPhase;
+    };
+
+    // What Interpolate copies out next to each world matrix for culling and drawing
+    struct EntityAppearance
+    {
+        float    Scale;
+        uint16_t MeshIndex;
+        uint16_t MaterialIndex;
+    };
+
+    // Every mesh lives in one shared vertex/index buffer, so draws differ only by their offsets.
+    // That is what lets one indirect submission cover every mesh.
+    struct MeshResources
+    {
+        uint32_t IndexCount;
+        uint32_t FirstIndex;
+        int32_t  BaseVertex;
+    };
+
+    struct MaterialResources
+    {
+        Renderer::ShaderHandle      VertexShader;
+        Renderer::ShaderHandle      PixelShader;
+        Renderer::TextureHandle     Diffuse;        // Unused when streaming or packed
+        Renderer::StreamedTextureID StreamedDiffuse;
+        uint16_t                    Group;
+        uint16_t                    Slice;          // In its group's page
+        uint32_t                    TableIndex;     // Its entry in the material table when bindless
+    };
+
+    // Everything one batch binds. Each material is its own group unless its diffuse was packed into a
+    // page, in which case every material in that page draws with the first one's shaders.
+    // Bindless materials all share one group that binds no texture at all.
+    struct ShadingGroup
+    {
+        uint16_t                FirstMaterial;
+        Renderer::TextureHandle Page;               // kInvalidBackendHandle when not packed
+    };
+
+    struct DrawBatch
+    {
+        uint16_t MeshIndex;
+        uint16_t GroupIndex;
+        uint32_t FirstInstance;
+        uint32_t InstanceCount;
+    };
+
+    // Depth only, so casters batch by mesh alone
+    struct ShadowBatch
+    {
+        uint16_t MeshIndex;
+        uint16_t Cascade;
+        uint32_t FirstInstance;
+        uint32_t InstanceCount;
+    };
+
+    // One fixed step of entity and camera motion
+    void Simulate(float dt);
+
+    // World matrices and camera alpha of the way from the step before the last to the last
+    void Interpolate(float alpha);
+
+    // Moves the free camera by the next replayed frame
+    void ReplayInput();
+
+    void Cull();
+    void BinLights();
+    void CullShadowCasters();
+    void Build();
+    void RequestTextureMips();
+    void BuildFrameGraph();
+    void Submit();
+    void SubmitScene();
+    void SubmitSceneIndirect();
+    void SubmitShadows();
+    void UploadInstances();
+    void UploadMaterialTable();
+    void UploadLights();
+    void AccountScene();
+    void BindFrameState(Renderer::IRenderContext& context) const;
+    void RecordBatches(Renderer::IRenderContext& context, uint32_t begin, uint32_t end) const;
+    Renderer::TextureHandle GetDiffuse(uint32_t groupIndex) const;    // kInvalidBackendHandle when bindless
+
+    void CreateResources();
+    void CreateShadingGroups();
+    void CreateEntities();
+    void CreateLights();
+    void CreateShadows();
+
+private:
+    Renderer::IRenderBackend* mpBackend;
+    HeadlessConfig            mConfig;
+
+    // Owns everything that lives as long as the game
+    Memory::LinearArena       mArena;
+
+    // Every entity has motion and an appearance
+    World                     mWorld;
+
+    // Copied out of the world every frame in the order it iterates, which the rest of the frame indexes entities by
+    float*                    mWorldMatrices;   // 16 per entity, row major
+    EntityAppearance*         mAppearances;
+
+    MeshResources*            mMeshes;
+    MaterialResources*        mMaterials;
+    ShadingGroup*             mGroups;
+    uint32_t                  mGroupCount;
+    Renderer::BufferHandle    mGeometryVertexBuffer;
+    Renderer::BufferHandle    mGeometryIndexBuffer;
+    Renderer::BufferHandle    mInstanceBuffer;
+    Renderer::BufferHandle    mInstanceMaterialBuffer;  // Slice or material table index per instance
+    Renderer::BufferHandle    mMaterialTableBuffer;
+    Renderer::BufferHandle    mLightBuffer;
+    Renderer::BufferHandle    mClusterGridBuffer;
+    Renderer::BufferHandle    mLightIndexBuffer;
+    Renderer::BufferHandle    mCameraBuffer;
+    Renderer::BufferHandle    mDrawArgsBuffer;
+    Renderer::BufferHandle    mDrawDataBuffer;
+    Renderer::BufferHandle    mShadowInstanceBuffer;
+    Renderer::BufferHandle    mShadowCascadeBuffers[Renderer::kMaxShadowCascades];   // Each cascade's view projection
+    Renderer::ShaderHandle    mShadowVertexShader;
+    Renderer::ShaderHandle    mShadowPixelShader;
+
+    // Rebuilt from the frame arena every frame
+    uint32_t*                 mVisible;
+    uint32_t                  mVisibleCount;
+    DrawBatch*                mBatches;
+    uint32_t                  mBatchCount;
+    float*                    mInstanceData;
+    uint32_t*                 mInstanceMaterials;
+    ShadowBatch*              mShadowBatches;
+    uint32_t                  mShadowBatchCount;
+    float*                    mShadowInstanceData;
+    uint32_t                  mShadowInstanceCount;
+
+    Renderer::MaterialTable   mMaterialTable;
+    std::vector<Renderer::GPUTableRange> mMaterialRanges;
+
+    Renderer::ClusteredLighting mClusteredLighting;
+    std::vector<Renderer::GPUTableRange> mLightRanges;
+
+    Renderer::CascadedShadows mShadows;
+
+    double                    mTime;
+    double                    mPrevTime;
+    uint32_t                  mCurrentTransform;
+    float                     mInterpolationAlpha;
+
+    // Only ticked with a RenderStep
+    VirtualClock              mSimulationClock;
+    StepTimer                 mSimulationTimer;
+
+    float                     mCameraData[16];
+    float                     mCameraPosition[3];
+    float                     mCameraForward[3];
+
+    // Only flown when replaying input. Never rolls, like every other headless camera.
+    float                     mFreeCameraYaw;
+    float                     mFreeCameraPitch;
+
+    // Stand-in for the passes a full frame would have: shadows, depth, forward, sky, bloom, tonemap
+    Renderer::RenderGraph     mFrameGraph;
+
+    // Reads are simulated, so only residency and scheduling are real
+    Renderer::BackendStreamingDevice* mpStreamingDevice;
+    Renderer::TextureStreamer         mTextureStreamer;
+
+    // Only initialized with GPU timing
+    Renderer::GPUProfiler     mGPUProfiler;
+
+    StepTimer                 mPacingTimer;
+    FrameStatistics           mFrameStats;
+
+    HeadlessReport            mReport;
+
+public:
+    HeadlessGame(HeadlessGame const&)            = delete;
+    HeadlessGame& operator=(HeadlessGame const&) = delete;
+};
+
+}
+#endif
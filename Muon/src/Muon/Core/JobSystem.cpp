@@ -0,0 +1,166 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of JobSystem.h
+----------------------------------------------*/
+#include "JobSystem.h"
+
+#include "Profiler.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Core {
+namespace JobSystem {
+
+namespace {
+
+struct QueuedJob
+{
+    std::function<void()> Work;
+    JobCounter*           Counter;
+};
+
+std::vector<std::thread> gWorkers;
+std::deque<QueuedJob>    gQueue;
+std::mutex               gQueueMutex;
+std::condition_variable  gQueueCV;
+bool                     gStopping = false;
+
+thread_local uint32_t    tThreadIndex = 0;
+
+void RunJob(QueuedJob& job)
+{
+    MN_PROFILE_SCOPE("Job");
+    job.Work();
+    job.Counter->Pending.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+bool TryRunOne()
+{
+    QueuedJob job;
+    {
+        std::lock_guard<std::mutex> lock(gQueueMutex);
+        if (gQueue.empty())
+            return false;
+
+        job = std::move(gQueue.front());
+        gQueue.pop_front();
+    }
+
+    RunJob(job);
+    return true;
+}
+
+void WorkerMain(uint32_t threadIndex)
+{
+    tThreadIndex = threadIndex;
+
+    while (true)
+    {
+        QueuedJob job;
+        {
+            std::unique_lock<std::mutex> lock(gQueueMutex);
+            gQueueCV.wait(lock, [] { return gStopping || !gQueue.empty(); });
+
+            if (gQueue.empty())
+                return; // Stopping and drained
+
+            job = std::move(gQueue.front());
+            gQueue.pop_front();
+        }
+
+        RunJob(job);
+    }
+}
+
+}
+
+void Init(uint32_t workerCount)
+{
+    if (!gWorkers.empty())
+        return;
+
+    if (workerCount == 0)
+    {
+        const uint32_t hw = std::thread::hardware_concurrency();
+        workerCount = hw > 1 ? hw - 1 : 1;
+    }
+
+    gStopping = false;
+    gWorkers.reserve(workerCount);
+    for (uint32_t i = 0; i != workerCount; ++i)
+        gWorkers.emplace_back(WorkerMain, i + 1);
+}
+
+void Shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(gQueueMutex);
+        gStopping = true;
+    }
+    gQueueCV.notify_all();
+
+    for (std::thread& worker : gWorkers)
+        worker.join();
+
+    gWorkers.clear();
+}
+
+uint32_t GetWorkerCount()
+{
+    return (uint32_t)gWorkers.size();
+}
+
+uint32_t GetThreadIndex()
+{
+    return tThreadIndex;
+}
+
+void Execute(JobCounter& counter, std::function<void()> job)
+{
+    counter.Pending.fetch_add(1, std::memory_order_acq_rel);
+
+    if (gWorkers.empty())
+    {
+        QueuedJob inlineJob = { std::move(job), &counter };
+        RunJob(inlineJob);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(gQueueMutex);
+        gQueue.push_back({ std::move(job), &counter });
+    }
+    gQueueCV.notify_one();
+}
+
+void Dispatch(JobCounter& counter, uint32_t count, uint32_t groupSize, std::function<void(uint32_t, uint32_t)> job)
+{
+    if (count == 0)
+        return;
+
+    groupSize = std::max(groupSize, 1u);
+    for (uint32_t begin = 0; begin < count; begin += groupSize)
+    {
+        const uint32_t end = std::min(begin + groupSize, count);
+        Execute(counter, [job, begin, end]() { job(begin, end); });
+    }
+}
+
+void Wait(JobCounter& counter)
+{
+    // Help out instead of sleeping, so waiting from a worker can't deadlock the pool
+    while (counter.IsBusy())
+    {
+        if (!TryRunOne())
+            std::this_thread::yield();
+    }
+}
+
+}
+}
@@ -0,0 +1,45 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Small fixed pool of worker threads for fire-and-wait jobs
+----------------------------------------------*/
+#ifndef MUON_JOBSYSTEM_H
+#define MUON_JOBSYSTEM_H
+
+#include <atomic>
+#include <functional>
+#include <stdint.h>
+
+namespace Core {
+
+// Tracks a batch of jobs. Wait() on it to block until every job in the batch has run.
+struct JobCounter
+{
+    std::atomic<uint32_t> Pending{ 0 };
+
+    bool IsBusy() const { return Pending.load(std::memory_order_acquire) != 0; }
+};
+
+namespace JobSystem {
+
+// workerCount of 0 picks hardware_concurrency - 1. Without Init, every job runs inline on the caller.
+void Init(uint32_t workerCount = 0);
+void Shutdown();
+
+uint32_t GetWorkerCount();
+
+// 0 on the main (or any non-worker) thread, 1..N on workers. Handy for indexing per-thread state.
+uint32_t GetThreadIndex();
+
+void Execute(JobCounter& counter, std::function<void()> job);
+
+// Splits [0, count) into groups of groupSize and runs job(begin, end) for each group
+void Dispatch(JobCounter& counter, uint32_t count, uint32_t groupSize, std::function<void(uint32_t, uint32_t)> job);
+
+// Runs queued jobs on the calling thread until the counter drains
+void Wait(JobCounter& counter);
+
+}
+}
+
+#endif
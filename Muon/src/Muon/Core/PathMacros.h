@@ -21,8 +21,13 @@ helper macros for reaching certain paths
 #define MODELPATH ASSETPATH ## "Models\\"
 #define MODELPATHW WIDEN(MODELPATH)
 #define TEXTUREPATH ASSETPATH ## "Textures\\"
+#define COOKEDTEXTUREPATH "..\\_bin\\Textures\\"
 #define SHADERPATH "..\\_bin\\Shaders\\"
 #define SHADERPATHW WIDEN(SHADERPATH)
+#define PIPELINELIBRARYPATHW SHADERPATHW L"PipelineLibrary.bin"
+#define SHADERARCHIVEPATHW SHADERPATHW L"Shaders.msa"
+#define SHADERSOURCEPATH ASSETPATH ## "Shaders\\"
+#define SHADERSOURCEPATHW WIDEN(SHADERSOURCEPATH)
 
 namespace Core
 {
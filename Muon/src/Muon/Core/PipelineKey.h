@@ -0,0 +1,245 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Device-independent half of the pipeline state cache
+Builds 64-bit keys out of pipeline state and dedups requests for the same key.
+Hashing only touches a desc's members by name, never its padding, so it's
+checked on Linux against a stand-in with D3D12's layout.
+----------------------------------------------*/
+#ifndef MUON_PIPELINEKEY_H
+#define MUON_PIPELINEKEY_H
+
+#include <Muon/Renderer/hash_util.h>
+
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+#include <unordered_map>
+
+namespace Muon
+{
+    class PipelineKeyBuilder
+    {
+    public:
+        PipelineKeyBuilder& AddBytes(const void* data, size_t size)
+        {
+            mHash = fnv1a64(data, size, mHash);
+            return *this;
+        }
+
+        // Structs only go in whole if they have no padding to pick up garbage from
+        template <typename T>
+        PipelineKeyBuilder& AddPod(T const& value)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "PipelineKeyBuilder::AddPod needs a POD type");
+            static_assert(!std::is_class<T>::value || std::has_unique_object_representations<T>::value,
+                "PipelineKeyBuilder::AddPod would hash this struct's padding; add its members one at a time");
+            return AddBytes(&value, sizeof(T));
+        }
+
+        // Hashes the terminator too, so "AB"+"C" and "A"+"BC" differ
+        PipelineKeyBuilder& AddString(const char* str)
+        {
+            if (!str)
+                str = "";
+
+            size_t len = 0;
+            while (str[len])
+                ++len;
+
+            return AddBytes(str, len + 1);
+        }
+
+        uint64_t GetKey() const { return mHash; }
+
+    private:
+        uint64_t mHash = 0xCBF29CE484222325ull;
+    };
+
+    namespace detail
+    {
+        template <typename Bytecode>
+        void AddBytecode(PipelineKeyBuilder& builder, Bytecode const& bytecode)
+        {
+            builder.AddPod((uint64_t)bytecode.BytecodeLength);
+            if (bytecode.BytecodeLength)
+                builder.AddBytes(bytecode.pShaderBytecode, bytecode.BytecodeLength);
+        }
+
+        // The state structs below are hashed a member at a time: D3D12's blend and depth stencil descs end
+        // their UINT8 masks in padding, which a desc built on the stack leaves as whatever was there
+        template <typename BlendDesc>
+        void AddBlendState(PipelineKeyBuilder& builder, BlendDesc const& desc)
+        {
+            builder.AddPod(desc.AlphaToCoverageEnable).AddPod(desc.IndependentBlendEnable);
+            for (auto const& target : desc.RenderTarget)
+            {
+                builder.AddPod(target.BlendEnable).AddPod(target.LogicOpEnable);
+                builder.AddPod(target.SrcBlend).AddPod(target.DestBlend).AddPod(target.BlendOp);
+                builder.AddPod(target.SrcBlendAlpha).AddPod(target.DestBlendAlpha).AddPod(target.BlendOpAlpha);
+                builder.AddPod(target.LogicOp).AddPod(target.RenderTargetWriteMask);
+            }
+        }
+
+        template <typename RasterizerDesc>
+        void AddRasterizerState(PipelineKeyBuilder& builder, RasterizerDesc const& desc)
+        {
+            builder.AddPod(desc.FillMode).AddPod(desc.CullMode).AddPod(desc.FrontCounterClockwise);
+            builder.AddPod(desc.DepthBias).AddPod(desc.DepthBiasClamp).AddPod(desc.SlopeScaledDepthBias);
+            builder.AddPod(desc.DepthClipEnable).AddPod(desc.MultisampleEnable).AddPod(desc.AntialiasedLineEnable);
+            builder.AddPod(desc.ForcedSampleCount).AddPod(desc.ConservativeRaster);
+        }
+
+        template <typename StencilOpDesc>
+        void AddStencilOp(PipelineKeyBuilder& builder, StencilOpDesc const& desc)
+        {
+            builder.AddPod(desc.StencilFailOp).AddPod(desc.StencilDepthFailOp).AddPod(desc.StencilPassOp).AddPod(desc.StencilFunc);
+        }
+
+        template <typename DepthStencilDesc>
+        void AddDepthStencilState(PipelineKeyBuilder& builder, DepthStencilDesc const& desc)
+        {
+            builder.AddPod(desc.DepthEnable).AddPod(desc.DepthWriteMask).AddPod(desc.DepthFunc);
+            builder.AddPod(desc.StencilEnable).AddPod(desc.StencilReadMask).AddPod(desc.StencilWriteMask);
+            AddStencilOp(builder, desc.FrontFace);
+            AddStencilOp(builder, desc.BackFace);
+        }
+    }
+
+    // Every part of a D3D12_GRAPHICS_PIPELINE_STATE_DESC that changes the PSO it builds. The root signature
+    // goes in as the hash of its serialized blob, since the pointer isn't stable across runs.
+    template <typename Desc>
+    uint64_t HashGraphicsPipelineDesc(Desc const& desc, uint64_t rootSignatureHash)
+    {
+        PipelineKeyBuilder builder;
+        builder.AddPod(rootSignatureHash);
+
+        detail::AddBytecode(builder, desc.VS);
+        detail::AddBytecode(builder, desc.PS);
+        detail::AddBytecode(builder, desc.DS);
+        detail::AddBytecode(builder, desc.HS);
+        detail::AddBytecode(builder, desc.GS);
+
+        builder.AddPod(desc.StreamOutput.NumEntries);
+        for (uint32_t i = 0; i != desc.StreamOutput.NumEntries; ++i)
+        {
+            auto const& entry = desc.StreamOutput.pSODeclaration[i];
+            builder.AddPod(entry.Stream).AddString(entry.SemanticName).AddPod(entry.SemanticIndex);
+            builder.AddPod(entry.StartComponent).AddPod(entry.ComponentCount).AddPod(entry.OutputSlot);
+        }
+        builder.AddPod(desc.StreamOutput.RasterizedStream);
+
+        detail::AddBlendState(builder, desc.BlendState);
+        builder.AddPod(desc.SampleMask);
+        detail::AddRasterizerState(builder, desc.RasterizerState);
+        detail::AddDepthStencilState(builder, desc.DepthStencilState);
+
+        // Semantic names are pointers, so walk the layout instead of hashing it whole
+        builder.AddPod(desc.InputLayout.NumElements);
+        for (uint32_t i = 0; i != desc.InputLayout.NumElements; ++i)
+        {
+            auto const& element = desc.InputLayout.pInputElementDescs[i];
+            builder.AddString(element.SemanticName).AddPod(element.SemanticIndex).AddPod(element.Format);
+            builder.AddPod(element.InputSlot).AddPod(element.AlignedByteOffset);
+            builder.AddPod(element.InputSlotClass).AddPod(element.InstanceDataStepRate);
+        }
+
+        builder.AddPod(desc.IBStripCutValue);
+        builder.AddPod(desc.PrimitiveTopologyType);
+        builder.AddPod(desc.NumRenderTargets);
+        builder.AddBytes(desc.RTVFormats, sizeof(desc.RTVFormats[0]) * desc.NumRenderTargets);
+        builder.AddPod(desc.DSVFormat);
+        builder.AddPod(desc.SampleDesc.Count).AddPod(desc.SampleDesc.Quality);
+        builder.AddPod(desc.NodeMask);
+        builder.AddPod(desc.Flags);
+
+        return builder.GetKey();
+    }
+
+    struct PipelineKeyTableStats
+    {
+        uint64_t Requests = 0;
+        uint64_t Hits     = 0;
+        uint32_t Unique   = 0;
+        uint64_t Rejected = 0; // New keys turned away because the table was full
+    };
+
+    // Hands out one slot index per unique key, up to a capacity. The first requester of a key is told
+    // to build it; everyone after shares the slot. Thread safe.
+    class PipelineKeyTable
+    {
+    public:
+        static const uint32_t kNoSlot = ~0u;
+
+        struct Result
+        {
+            uint32_t Index;     // kNoSlot when the key is new and the table is full
+            bool     Inserted;
+        };
+
+        // Keys already in the table stay there even if it's now over capacity
+        void SetCapacity(uint32_t capacity)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mCapacity = capacity;
+        }
+
+        // A key turned away when full isn't kept, so it never takes up a slot
+        Result FindOrAdd(uint64_t key)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStats.Requests++;
+
+            auto it = mSlots.find(key);
+            if (it != mSlots.end())
+            {
+                mStats.Hits++;
+                return { it->second, false };
+            }
+
+            if (mSlots.size() >= mCapacity)
+            {
+                mStats.Rejected++;
+                return { kNoSlot, false };
+            }
+
+            const uint32_t index = (uint32_t)mSlots.size();
+            mSlots.emplace(key, index);
+            mStats.Unique = index + 1;
+            return { index, true };
+        }
+
+        bool Find(uint64_t key, uint32_t& out_index) const
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            auto it = mSlots.find(key);
+            if (it == mSlots.end())
+                return false;
+
+            out_index = it->second;
+            return true;
+        }
+
+        void Clear()
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mSlots.clear();
+            mStats = PipelineKeyTableStats();
+        }
+
+        PipelineKeyTableStats GetStats() const
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            return mStats;
+        }
+
+    private:
+        std::unordered_map<uint64_t, uint32_t> mSlots;
+        uint32_t                               mCapacity = ~0u;
+        PipelineKeyTableStats                  mStats;
+        mutable std::mutex                     mMutex;
+    };
+}
+
+#endif
@@ -0,0 +1,226 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of PipelineStateCache.h
+----------------------------------------------*/
+#include <Muon.h>
+#include <Muon/Utils/Utils.h>
+#include <Muon/Core/JobSystem.h>
+#include <Muon/Core/PipelineStateCache.h>
+
+#include <algorithm>
+#include <assert.h>
+#include <chrono>
+#include <fstream>
+#include <stdio.h>
+#include <thread>
+#include <wrl/client.h>
+
+namespace Muon
+{
+    namespace
+    {
+        void MakeLibraryName(uint64_t key, wchar_t (&out_name)[24])
+        {
+            swprintf_s(out_name, L"PSO_%016llx", (unsigned long long)key);
+        }
+    }
+
+    bool PipelineStateCache::Init(ID3D12Device* pDevice, const wchar_t* libraryPath, uint32_t maxPipelines)
+    {
+        mpDevice = pDevice;
+        mMaxPipelines = maxPipelines;
+        mSlots.reset(new Slot[maxPipelines]);
+        mKeys.Clear();
+        mKeys.SetCapacity(maxPipelines);
+        mFullReported = false;
+        mStats = PipelineStateCacheStats();
+
+        if (!libraryPath)
+            return true;
+
+        mLibraryPath = libraryPath;
+
+        Microsoft::WRL::ComPtr<ID3D12Device1> pDevice1;
+        if (FAILED(pDevice->QueryInterface(IID_PPV_ARGS(pDevice1.GetAddressOf()))))
+        {
+            Muon::Print("Warning: ID3D12Device1 unavailable, pipeline library disabled.\n");
+            return true;
+        }
+
+        std::ifstream file(mLibraryPath, std::ios::binary | std::ios::ate);
+        if (file)
+        {
+            mLibraryBlob.resize((size_t)file.tellg());
+            file.seekg(0);
+            file.read((char*)mLibraryBlob.data(), mLibraryBlob.size());
+        }
+
+        HRESULT hr = E_FAIL;
+        if (!mLibraryBlob.empty())
+        {
+            hr = pDevice1->CreatePipelineLibrary(mLibraryBlob.data(), mLibraryBlob.size(), IID_PPV_ARGS(&mpLibrary));
+
+            // A driver update or a different adapter invalidates the whole library; start over
+            if (FAILED(hr))
+            {
+                Muon::Print("Warning: Discarding stale pipeline library.\n");
+                mLibraryBlob.clear();
+            }
+        }
+
+        if (FAILED(hr))
+            hr = pDevice1->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(&mpLibrary));
+
+        return SUCCEEDED(hr);
+    }
+
+    void PipelineStateCache::Shutdown()
+    {
+        SaveLibrary();
+
+        const uint32_t count = mKeys.GetStats().Unique;
+        for (uint32_t i = 0; i != count; ++i)
+        {
+            ID3D12PipelineState* pState = mSlots[i].State.exchange(nullptr);
+            if (pState)
+                pState->Release();
+        }
+
+        if (mpLibrary)
+            mpLibrary->Release();
+
+        mpLibrary = nullptr;
+        mLibraryBlob.clear();
+        mSlots.reset();
+        mKeys.Clear();
+        mRootSigHashes.clear();
+    }
+
+    void PipelineStateCache::RegisterRootSignature(ID3D12RootSignature* pRootSig, const void* pSerialized, size_t serializedSize)
+    {
+        mRootSigHashes[pRootSig] = fnv1a64(pSerialized, serializedSize);
+    }
+
+    uint64_t PipelineStateCache::ComputeKey(D3D12_GRAPHICS_PIPELINE_STATE_DESC const& desc) const
+    {
+        auto rootIt = mRootSigHashes.find(desc.pRootSignature);
+        assert(rootIt != mRootSigHashes.end() && "PipelineStateCache: root signature was never registered");
+        return HashGraphicsPipelineDesc(desc, rootIt != mRootSigHashes.end() ? rootIt->second : 0ull);
+    }
+
+    ID3D12PipelineState* PipelineStateCache::GetOrCreate(D3D12_GRAPHICS_PIPELINE_STATE_DESC const& desc)
+    {
+        const uint64_t key = ComputeKey(desc);
+        PipelineKeyTable::Result result = mKeys.FindOrAdd(key);
+
+        // The key wasn't kept, but nothing is ever evicted, so every new pipeline from here on fails the same way
+        if (result.Index == PipelineKeyTable::kNoSlot)
+        {
+            if (!mFullReported.exchange(true))
+            {
+                Muon::Print("Error: PipelineStateCache is full, raise maxPipelines! New pipelines will not be created.\n");
+                assert(false && "PipelineStateCache is full");
+            }
+            return nullptr;
+        }
+
+        Slot& slot = mSlots[result.Index];
+
+        if (result.Inserted)
+        {
+            slot.State.store(Build(key, desc), std::memory_order_release);
+            slot.Ready.store(true, std::memory_order_release);
+        }
+
+        // Someone else is already compiling this one
+        while (!slot.Ready.load(std::memory_order_acquire))
+            std::this_thread::yield();
+
+        return slot.State.load(std::memory_order_acquire);
+    }
+
+    void PipelineStateCache::Prewarm(D3D12_GRAPHICS_PIPELINE_STATE_DESC const* pDescs, uint32_t count, Core::JobCounter& counter)
+    {
+        Core::JobSystem::Dispatch(counter, count, 1, [this, pDescs](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t i = begin; i != end; ++i)
+                GetOrCreate(pDescs[i]);
+        });
+    }
+
+    ID3D12PipelineState* PipelineStateCache::Build(uint64_t key, D3D12_GRAPHICS_PIPELINE_STATE_DESC const& desc)
+    {
+        ID3D12PipelineState* pState = nullptr;
+        wchar_t name[24];
+        MakeLibraryName(key, name);
+
+        if (mpLibrary)
+        {
+            std::lock_guard<std::mutex> lock(mLibraryMutex);
+            if (SUCCEEDED(mpLibrary->LoadGraphicsPipeline(name, &desc, IID_PPV_ARGS(&pState))))
+            {
+                std::lock_guard<std::mutex> statsLock(mStatsMutex);
+                mStats.LibraryLoads++;
+                return pState;
+            }
+        }
+
+        // Compile outside the library lock; CreateGraphicsPipelineState is free-threaded
+        auto start = std::chrono::high_resolution_clock::now();
+        HRESULT hr = mpDevice->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(&pState));
+        auto end = std::chrono::high_resolution_clock::now();
+
+        if (FAILED(hr))
+        {
+            Muon::Print("Error: Failed to create graphics pipeline state!\n");
+            return nullptr;
+        }
+
+        {
+            std::lock_guard<std::mutex> statsLock(mStatsMutex);
+            mStats.Compiles++;
+            mStats.CompileMs += std::chrono::duration<double, std::milli>(end - start).count();
+        }
+
+        if (mpLibrary)
+        {
+            std::lock_guard<std::mutex> lock(mLibraryMutex);
+            if (SUCCEEDED(mpLibrary->StorePipeline(name, pState)))
+                mLibraryDirty = true;
+        }
+
+        return pState;
+    }
+
+    bool PipelineStateCache::SaveLibrary()
+    {
+        std::lock_guard<std::mutex> lock(mLibraryMutex);
+        if (!mpLibrary || !mLibraryDirty || mLibraryPath.empty())
+            return true;
+
+        std::vector<uint8_t> blob(mpLibrary->GetSerializedSize());
+        HRESULT hr = mpLibrary->Serialize(blob.data(), blob.size());
+        if (FAILED(hr))
+            return false;
+
+        std::ofstream file(mLibraryPath, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            Muon::Print("Warning: Could not write pipeline library to disk.\n");
+            return false;
+        }
+
+        file.write((const char*)blob.data(), blob.size());
+        mLibraryDirty = false;
+        return true;
+    }
+
+    PipelineStateCacheStats PipelineStateCache::GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(mStatsMutex);
+        PipelineStateCacheStats stats = mStats;
+        stats.Keys = mKeys.GetStats();
+        return stats;
+    }
+}
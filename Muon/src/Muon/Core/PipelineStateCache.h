@@ -0,0 +1,89 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Deduplicated PSO cache backed by an on-disk ID3D12PipelineLibrary
+----------------------------------------------*/
+#ifndef MUON_PIPELINESTATECACHE_H
+#define MUON_PIPELINESTATECACHE_H
+
+#include <d3dx12.h>
+#include <d3d12.h>
+
+#include <Muon/Core/PipelineKey.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Core
+{
+    struct JobCounter;
+}
+
+namespace Muon
+{
+    struct PipelineStateCacheStats
+    {
+        PipelineKeyTableStats Keys;
+        uint32_t LibraryLoads   = 0; // Found in the serialized library
+        uint32_t Compiles       = 0; // Had to go through the driver compiler
+        double   CompileMs      = 0.0;
+    };
+
+    class PipelineStateCache
+    {
+    public:
+        // libraryPath may be null to run without persistence
+        bool Init(ID3D12Device* pDevice, const wchar_t* libraryPath, uint32_t maxPipelines = 1024);
+
+        // Writes the library back to disk if anything new was stored, then releases every PSO
+        void Shutdown();
+
+        // Root signatures are hashed by their serialized blob, since the pointer isn't stable across runs
+        void RegisterRootSignature(ID3D12RootSignature* pRootSig, const void* pSerialized, size_t serializedSize);
+
+        uint64_t ComputeKey(D3D12_GRAPHICS_PIPELINE_STATE_DESC const& desc) const;
+
+        // Blocks if another thread is already building the same PSO. The cache keeps ownership.
+        ID3D12PipelineState* GetOrCreate(D3D12_GRAPHICS_PIPELINE_STATE_DESC const& desc);
+
+        // Kicks off GetOrCreate for each desc on the job system. Everything the descs point at
+        // (bytecode, input layouts) must stay alive until the counter drains.
+        void Prewarm(D3D12_GRAPHICS_PIPELINE_STATE_DESC const* pDescs, uint32_t count, Core::JobCounter& counter);
+
+        bool SaveLibrary();
+
+        PipelineStateCacheStats GetStats() const;
+
+    private:
+        ID3D12PipelineState* Build(uint64_t key, D3D12_GRAPHICS_PIPELINE_STATE_DESC const& desc);
+
+        struct Slot
+        {
+            std::atomic<ID3D12PipelineState*> State{ nullptr };
+            std::atomic<bool>                 Ready{ false };
+        };
+
+        ID3D12Device*                       mpDevice  = nullptr;
+        ID3D12PipelineLibrary*              mpLibrary = nullptr;
+        std::vector<uint8_t>                mLibraryBlob; // Must outlive mpLibrary
+        std::wstring                        mLibraryPath;
+        bool                                mLibraryDirty = false;
+        std::mutex                          mLibraryMutex;
+
+        PipelineKeyTable                    mKeys;
+        std::unique_ptr<Slot[]>             mSlots;
+        uint32_t                            mMaxPipelines = 0;
+        std::atomic<bool>                   mFullReported{ false };
+
+        std::unordered_map<ID3D12RootSignature*, uint64_t> mRootSigHashes;
+
+        mutable std::mutex                  mStatsMutex;
+        PipelineStateCacheStats             mStats;
+    };
+}
+
+#endif
@@ -0,0 +1,396 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of Profiler.h
+----------------------------------------------*/
+#include "Profiler.h"
+
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdio.h>
+#include <vector>
+
+namespace Core {
+namespace Profiler {
+
+namespace {
+
+// Per thread; a thread has to close this many scopes between two EndFrames before any are dropped
+const uint32_t kRingSize = 1 << 15;
+const uint32_t kRingMask = kRingSize - 1;
+
+struct ProfileEvent
+{
+    const char* Name;
+    uint64_t    StartNs;
+    uint64_t    EndNs;
+    uint32_t    Depth;
+};
+
+// Single writer (its thread), single reader (EndFrame). Written is the only thing they share.
+struct ThreadBuffer
+{
+    ProfileEvent          Events[kRingSize];
+    std::atomic<uint64_t> Written{ 0 };
+    uint64_t              Read = 0;
+    uint32_t              ThreadId = 0;
+    uint32_t              WorkerIndex = 0;
+    const char*           TrackName = nullptr;    // Set for tracks, which no thread owns
+};
+
+struct ScopeHistory
+{
+    const char* Name;
+    uint32_t    ThreadId;
+    uint32_t    Depth;
+    uint32_t    Calls;
+    uint64_t    FrameNs;
+    uint64_t    FirstStartNs;
+    uint64_t    LastFrame;
+
+    // Ring of the last kHistoryFrames frames it ran in
+    float       Ms[kHistoryFrames];
+    uint32_t    MsCount;
+    uint32_t    MsNext;
+};
+
+struct CapturedEvent
+{
+    ProfileEvent Event;
+    uint32_t     ThreadId;
+};
+
+std::mutex                 gRegistryMutex;
+std::vector<ThreadBuffer*> gBuffers;
+
+std::vector<ScopeHistory>  gScopes;
+std::vector<ProfileEvent>  gDrained;
+uint64_t                   gFrameIndex = 0;
+uint64_t                   gFrameStartNs = 0;
+uint64_t                   gDroppedEvents = 0;
+
+std::vector<CapturedEvent> gCapture;
+uint32_t                   gCaptureMax = 0;
+bool                       gCapturing = false;
+
+thread_local ThreadBuffer* tBuffer = nullptr;
+thread_local uint32_t      tDepth = 0;
+
+ThreadBuffer* AddBuffer(ThreadBuffer* buffer)
+{
+    std::lock_guard<std::mutex> lock(gRegistryMutex);
+    buffer->ThreadId = (uint32_t)gBuffers.size();
+    gBuffers.push_back(buffer);
+    return buffer;
+}
+
+ThreadBuffer* RegisterThread()
+{
+    ThreadBuffer* buffer = new ThreadBuffer();
+    buffer->WorkerIndex = JobSystem::GetThreadIndex();
+    return AddBuffer(buffer);
+}
+
+void Push(ThreadBuffer* buffer, const char* name, uint64_t startNs, uint64_t endNs, uint32_t depth)
+{
+    const uint64_t index = buffer->Written.load(std::memory_order_relaxed);
+    buffer->Events[index & kRingMask] = { name, startNs, endNs, depth };
+    buffer->Written.store(index + 1, std::memory_order_release);
+}
+
+ScopeHistory& FindScope(const char* name, uint32_t threadId)
+{
+    for (ScopeHistory& scope : gScopes)
+    {
+        if (scope.Name == name && scope.ThreadId == threadId)
+            return scope;
+    }
+
+    ScopeHistory scope = {};
+    scope.Name = name;
+    scope.ThreadId = threadId;
+    scope.LastFrame = ~0ull;
+    gScopes.push_back(scope);
+    return gScopes.back();
+}
+
+// Copies out whatever the thread has published since the last drain
+void DrainBuffer(ThreadBuffer& buffer, std::vector<ProfileEvent>& out_events)
+{
+    out_events.clear();
+
+    uint64_t written = buffer.Written.load(std::memory_order_acquire);
+    if (written - buffer.Read > kRingSize)
+    {
+        gDroppedEvents += written - buffer.Read - kRingSize;
+        buffer.Read = written - kRingSize;
+    }
+
+    const uint64_t first = buffer.Read;
+    for (uint64_t i = first; i != written; ++i)
+        out_events.push_back(buffer.Events[i & kRingMask]);
+
+    // Anything the writer lapped while we were copying may be torn, so throw those away
+    const uint64_t overwritten = buffer.Written.load(std::memory_order_acquire);
+    if (overwritten - first > kRingSize)
+    {
+        const uint64_t lost = std::min<uint64_t>(overwritten - first - kRingSize, out_events.size());
+        out_events.erase(out_events.begin(), out_events.begin() + (size_t)lost);
+        gDroppedEvents += lost;
+    }
+
+    buffer.Read = written;
+}
+
+void WriteJsonString(FILE* file, const char* str)
+{
+    fputc('"', file);
+    for (; *str; ++str)
+    {
+        if (*str == '"' || *str == '\\')
+            fputc('\\', file);
+        fputc(*str, file);
+    }
+    fputc('"', file);
+}
+
+}
+
+uint64_t Now()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Record(const char* name, uint64_t startNs, uint64_t endNs, uint32_t depth)
+{
+    ThreadBuffer* buffer = tBuffer;
+    if (!buffer)
+        buffer = tBuffer = RegisterThread();
+
+    Push(buffer, name, startNs, endNs, depth);
+}
+
+uint32_t RegisterTrack(const char* name)
+{
+    ThreadBuffer* buffer = new ThreadBuffer();
+    buffer->TrackName = name;
+    return AddBuffer(buffer)->ThreadId;
+}
+
+void RecordOnTrack(uint32_t track, const char* name, uint64_t startNs, uint64_t endNs, uint32_t depth)
+{
+    ThreadBuffer* buffer;
+    {
+        std::lock_guard<std::mutex> lock(gRegistryMutex);
+        buffer = gBuffers[track];
+    }
+
+    Push(buffer, name, startNs, endNs, depth);
+}
+
+ProfileScope::ProfileScope(const char* name) :
+    mName(name),
+    mStart(Now()),
+    mDepth(tDepth++)
+{
+}
+
+ProfileScope::~ProfileScope()
+{
+    tDepth--;
+    Record(mName, mStart, Now(), mDepth);
+}
+
+void EndFrame()
+{
+    // The frame itself, from the last EndFrame to this one
+    const uint64_t now = Now();
+    if (gFrameStartNs)
+        Record("Frame", gFrameStartNs, now, tDepth);
+    gFrameStartNs = now;
+
+    std::vector<ThreadBuffer*> buffers;
+    {
+        std::lock_guard<std::mutex> lock(gRegistryMutex);
+        buffers = gBuffers;
+    }
+
+    std::vector<size_t> touched;
+    for (ThreadBuffer* buffer : buffers)
+    {
+        DrainBuffer(*buffer, gDrained);
+
+        for (ProfileEvent const& event : gDrained)
+        {
+            ScopeHistory& scope = FindScope(event.Name, buffer->ThreadId);
+            if (scope.LastFrame != gFrameIndex)
+            {
+                scope.LastFrame = gFrameIndex;
+                scope.Calls = 0;
+                scope.FrameNs = 0;
+                scope.FirstStartNs = event.StartNs;
+                scope.Depth = event.Depth;
+                touched.push_back((size_t)(&scope - gScopes.data()));
+            }
+            scope.Calls++;
+            scope.FrameNs += event.EndNs - event.StartNs;
+            scope.FirstStartNs = std::min(scope.FirstStartNs, event.StartNs);
+            scope.Depth = std::min(scope.Depth, event.Depth);
+
+            if (gCapturing && gCapture.size() < gCaptureMax)
+                gCapture.push_back({ event, buffer->ThreadId });
+        }
+    }
+
+    for (size_t index : touched)
+    {
+        ScopeHistory& scope = gScopes[index];
+        scope.Ms[scope.MsNext] = (float)(scope.FrameNs * 1e-6);
+        scope.MsNext = (scope.MsNext + 1) % kHistoryFrames;
+        scope.MsCount = std::min(scope.MsCount + 1, kHistoryFrames);
+    }
+
+    gFrameIndex++;
+}
+
+void BeginCapture(uint32_t maxEvents)
+{
+    gCapture.clear();
+    gCapture.reserve(std::min(maxEvents, 1u << 16));
+    gCaptureMax = maxEvents;
+    gCapturing = true;
+}
+
+bool IsCapturing()
+{
+    return gCapturing;
+}
+
+bool WriteChromeTrace(const char* path)
+{
+    gCapturing = false;
+
+    FILE* file = fopen(path, "wb");
+    if (!file)
+        return false;
+
+    // Timestamps are microseconds from the first event, which keeps them readable in the viewer
+    uint64_t originNs = ~0ull;
+    for (CapturedEvent const& captured : gCapture)
+        originNs = std::min(originNs, captured.Event.StartNs);
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    std::vector<ThreadBuffer*> buffers;
+    {
+        std::lock_guard<std::mutex> lock(gRegistryMutex);
+        buffers = gBuffers;
+    }
+
+    bool first = true;
+    for (ThreadBuffer const* buffer : buffers)
+    {
+        char threadName[32];
+        if (buffer->TrackName)
+            snprintf(threadName, sizeof(threadName), "%s", buffer->TrackName);
+        else if (buffer->WorkerIndex)
+            snprintf(threadName, sizeof(threadName), "Worker %u", buffer->WorkerIndex);
+        else
+            snprintf(threadName, sizeof(threadName), buffer->ThreadId ? "Thread %u" : "Main", buffer->ThreadId);
+
+        fprintf(file, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}", first ? "" : ",\n", buffer->ThreadId, threadName);
+        first = false;
+    }
+
+    for (CapturedEvent const& captured : gCapture)
+    {
+        ProfileEvent const& event = captured.Event;
+        fprintf(file, "%s{\"ph\":\"X\",\"name\":", first ? "" : ",\n");
+        WriteJsonString(file, event.Name);
+        fprintf(file, ",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", captured.ThreadId,
+            (event.StartNs - originNs) * 1e-3, (event.EndNs - event.StartNs) * 1e-3);
+        first = false;
+    }
+
+    fprintf(file, "\n]}\n");
+    const bool ok = !ferror(file);
+    fclose(file);
+
+    gCapture.clear();
+    gCapture.shrink_to_fit();
+    return ok;
+}
+
+uint32_t GetScopeStats(ScopeStats* out_stats, uint32_t maxCount)
+{
+    std::vector<const ScopeHistory*> order;
+    for (ScopeHistory const& scope : gScopes)
+    {
+        if (scope.MsCount)
+            order.push_back(&scope);
+    }
+
+    // Parents open before their children, so this reads as a tree once indented by depth
+    std::sort(order.begin(), order.end(), [](const ScopeHistory* a, const ScopeHistory* b)
+    {
+        if (a->ThreadId != b->ThreadId)
+            return a->ThreadId < b->ThreadId;
+        if (a->FirstStartNs != b->FirstStartNs)
+            return a->FirstStartNs < b->FirstStartNs;
+        return a->Depth < b->Depth;
+    });
+
+    float sorted[kHistoryFrames];
+    const uint32_t count = std::min((uint32_t)order.size(), maxCount);
+    for (uint32_t i = 0; i != count; ++i)
+    {
+        ScopeHistory const& scope = *order[i];
+        std::copy(scope.Ms, scope.Ms + scope.MsCount, sorted);
+        std::sort(sorted, sorted + scope.MsCount);
+
+        const uint32_t last = scope.MsCount - 1;
+        ScopeStats& stats = out_stats[i];
+        stats.Name     = scope.Name;
+        stats.ThreadId = scope.ThreadId;
+        stats.Depth    = scope.Depth;
+        stats.Calls    = scope.Calls;
+        stats.LastMs   = scope.Ms[(scope.MsNext + kHistoryFrames - 1) % kHistoryFrames];
+        stats.P50Ms    = sorted[last / 2];
+        stats.P95Ms    = sorted[last * 95 / 100];
+        stats.P99Ms    = sorted[last * 99 / 100];
+        stats.MaxMs    = sorted[last];
+    }
+
+    return (uint32_t)order.size();
+}
+
+uint64_t GetDroppedEvents()
+{
+    return gDroppedEvents;
+}
+
+void Shutdown()
+{
+    std::lock_guard<std::mutex> lock(gRegistryMutex);
+    for (ThreadBuffer* buffer : gBuffers)
+        delete buffer;
+    gBuffers.clear();
+
+    // Threads that outlive this would write into freed buffers, so only this one gets to start over
+    tBuffer = nullptr;
+
+    gScopes.clear();
+    gDrained.clear();
+    gCapture.clear();
+    gCapturing = false;
+    gFrameIndex = 0;
+    gFrameStartNs = 0;
+    gDroppedEvents = 0;
+}
+
+}
+}
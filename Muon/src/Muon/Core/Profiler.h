@@ -0,0 +1,100 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Scoped CPU profiler. Each thread appends finished scopes to its
+own ring buffer with no locks; EndFrame drains them all on the main thread,
+keeps a rolling window of per-scope frame times for percentiles, and can
+capture a stretch of frames as Chrome trace JSON (chrome://tracing, Perfetto).
+The macros compile to nothing unless MN_ENABLE_PROFILER is defined.
+----------------------------------------------*/
+#ifndef MUON_PROFILER_H
+#define MUON_PROFILER_H
+
+#include <stdint.h>
+
+namespace Core {
+namespace Profiler {
+
+// Frames of history the percentiles are taken over
+static const uint32_t kHistoryFrames = 256;
+
+struct ScopeStats
+{
+    const char* Name;
+    uint32_t    ThreadId;   // 0 is the first thread that recorded anything, usually main. Tracks count as threads.
+    uint32_t    Depth;      // Nesting depth on its thread, for indenting
+    uint32_t    Calls;      // In the last frame it ran
+    double      LastMs;     // Summed over every call in that frame
+    double      P50Ms;
+    double      P95Ms;
+    double      P99Ms;
+    double      MaxMs;
+};
+
+// Nanoseconds on a steady clock, from an arbitrary start
+uint64_t Now();
+
+// Called by ProfileScope as a scope closes. Lock-free, only ever touches the calling thread's buffer.
+void Record(const char* name, uint64_t startNs, uint64_t endNs, uint32_t depth);
+
+// A timeline that isn't a thread, like the GPU's. Shows up in traces and stats next to the threads.
+uint32_t RegisterTrack(const char* name);
+
+// Adds a finished scope to a track. Each track must only be written from one thread at a time.
+void RecordOnTrack(uint32_t track, const char* name, uint64_t startNs, uint64_t endNs, uint32_t depth);
+
+// Drains every thread's events into the per-scope history and any capture in progress. Call once a frame, on one thread.
+void EndFrame();
+
+// Keeps every event from the next frames, up to maxEvents, until WriteChromeTrace
+void BeginCapture(uint32_t maxEvents = 1 << 20);
+bool IsCapturing();
+
+// Writes the capture as a Chrome trace and ends it. False if the file couldn't be written.
+bool WriteChromeTrace(const char* path);
+
+// Scopes seen over the history window, grouped by thread in the order they last opened.
+// Returns how many there are, filling at most maxCount of them.
+uint32_t GetScopeStats(ScopeStats* out_stats, uint32_t maxCount);
+
+// Events lost because a thread wrote a whole ring's worth between two EndFrames
+uint64_t GetDroppedEvents();
+
+// Frees every thread's buffer and the history. Only once no other thread is recording.
+void Shutdown();
+
+// Times its own lifetime
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char* name);
+    ~ProfileScope();
+
+private:
+    const char* mName;
+    uint64_t    mStart;
+    uint32_t    mDepth;
+
+public:
+    ProfileScope(ProfileScope const&)            = delete;
+    ProfileScope& operator=(ProfileScope const&) = delete;
+};
+
+}
+}
+
+#if defined(MN_ENABLE_PROFILER)
+    #define MN_PROFILE_CONCAT_INNER(a, b) a##b
+    #define MN_PROFILE_CONCAT(a, b) MN_PROFILE_CONCAT_INNER(a, b)
+
+    // name must outlive the profiler: a string literal or __FUNCTION__
+    #define MN_PROFILE_SCOPE(name) ::Core::Profiler::ProfileScope MN_PROFILE_CONCAT(mnProfileScope, __LINE__)(name)
+    #define MN_PROFILE_FUNCTION()  MN_PROFILE_SCOPE(__FUNCTION__)
+    #define MN_PROFILE_FRAME()     ::Core::Profiler::EndFrame()
+#else
+    #define MN_PROFILE_SCOPE(name) ((void)0)
+    #define MN_PROFILE_FUNCTION()  ((void)0)
+    #define MN_PROFILE_FRAME()     ((void)0)
+#endif
+
+#endif
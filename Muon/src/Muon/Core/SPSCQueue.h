@@ -0,0 +1,80 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Fixed size single producer, single consumer queue
+Lock free: the producer only writes the tail and the consumer only the head,
+each publishing with a release store the other reads with acquire. Each side
+also caches the other's index and only rereads it when the queue looks full
+or empty, so the two don't keep pulling each other's cache line back and forth.
+----------------------------------------------*/
+#ifndef MUON_SPSCQUEUE_H
+#define MUON_SPSCQUEUE_H
+
+#include <atomic>
+#include <stdint.h>
+
+namespace Core {
+
+template <typename T, uint32_t Capacity>
+class SPSCQueue
+{
+    static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0, "SPSCQueue capacity must be a power of two");
+
+public:
+    SPSCQueue() :
+        mHead(0),
+        mCachedTail(0),
+        mTail(0),
+        mCachedHead(0)
+    {
+    }
+
+    // Producer only. False, and nothing queued, if the queue is full.
+    bool Push(T const& item)
+    {
+        const uint32_t tail = mTail.load(std::memory_order_relaxed);
+        if (tail - mCachedHead == Capacity)
+        {
+            mCachedHead = mHead.load(std::memory_order_acquire);
+            if (tail - mCachedHead == Capacity)
+                return false;
+        }
+
+        mItems[tail & (Capacity - 1)] = item;
+        mTail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. False if there was nothing to take.
+    bool Pop(T& out_item)
+    {
+        const uint32_t head = mHead.load(std::memory_order_relaxed);
+        if (head == mCachedTail)
+        {
+            mCachedTail = mTail.load(std::memory_order_acquire);
+            if (head == mCachedTail)
+                return false;
+        }
+
+        out_item = mItems[head & (Capacity - 1)];
+        mHead.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    static uint32_t GetCapacity() { return Capacity; }
+
+private:
+    // Consumer's side, then the producer's a cache line away
+    alignas(64) std::atomic<uint32_t> mHead;
+    uint32_t                          mCachedTail;
+    alignas(64) std::atomic<uint32_t> mTail;
+    uint32_t                          mCachedHead;
+    alignas(64) T                     mItems[Capacity];
+
+public:
+    SPSCQueue(SPSCQueue const&)            = delete;
+    SPSCQueue& operator=(SPSCQueue const&) = delete;
+};
+
+}
+#endif
@@ -2,13 +2,14 @@
 Chuck Walbourn
 Date : 2019/12
 Description : StepTimer Interface, taken from the DirectX Visual Studio Template
+Reads time from an IClock rather than QPC directly, so it runs off Windows
+and against a virtual clock.
 ----------------------------------------------*/
 #ifndef STEPTIMER_H
 #define STEPTIMER_H
 
-#include <Muon/Core/WinApp.h>
+#include <Muon/Core/Clock.h>
 #include <cmath>
-#include <exception>
 #include <stdint.h>
 
 namespace Core {
@@ -17,35 +18,35 @@ namespace Core {
 class StepTimer
 {
 public:
-    StepTimer() noexcept(false) :
+    // Times against the system clock unless given another, which must outlive the timer
+    explicit StepTimer(IClock* pClock = nullptr) :
+        m_pClock(nullptr),
         m_elapsedTicks(0),
         m_totalTicks(0),
         m_leftOverTicks(0),
+        m_frameTicks(0),
         m_frameCount(0),
         m_framesPerSecond(0),
         m_framesThisSecond(0),
-        m_qpcSecondCounter(0),
+        m_clockSecondCounter(0),
         m_isFixedTimeStep(false),
         m_targetElapsedTicks(TicksPerSecond / 60)
     {
+        SetClock(pClock ? *pClock : SystemClock::Get());
+    }
 
-        #if defined(MN_DEBUG)
-            if (!QueryPerformanceFrequency(&m_qpcFrequency))
-            {
-                throw std::exception("QueryPerformanceFrequency");
-            }
-
-            if (!QueryPerformanceCounter(&m_qpcLastTime))
-            {
-                throw std::exception("QueryPerformanceCounter");
-            }
-        #else
-            QueryPerformanceFrequency(&m_qpcFrequency);
-            QueryPerformanceCounter(&m_qpcLastTime);
-        #endif
+    // Switch clocks, restarting the elapsed time from now on the new one
+    void SetClock(IClock& clock)
+    {
+        m_pClock = &clock;
+        m_clockFrequency = clock.GetFrequency();
+        m_clockLastTime = clock.GetCounter();
 
         // Initialize max delta to 1/10 of a second.
-        m_qpcMaxDelta = static_cast<uint64_t>(m_qpcFrequency.QuadPart / 10);
+        m_clockMaxDelta = m_clockFrequency / 10;
+
+        m_leftOverTicks = 0;
+        m_clockSecondCounter = 0;
     }
 
     // Get elapsed time since the previous Update call.
@@ -56,6 +57,18 @@ public:
     uint64_t GetTotalTicks() const { return m_totalTicks; }
     double GetTotalSeconds() const { return TicksToSeconds(m_totalTicks); }
 
+    // Get the real time the last Tick covered, clamped like the update time is.
+    // Unlike the elapsed time this doesn't snap to the fixed timestep.
+    uint64_t GetFrameTicks() const { return m_frameTicks; }
+    double GetFrameSeconds() const { return TicksToSeconds(m_frameTicks); }
+
+    // Get how far into the next fixed step the last Tick left off, from 0 up to (not including) 1.
+    // Rendering blends the last two steps' state by this. Always 1 with a variable timestep.
+    double GetInterpolationAlpha() const
+    {
+        return m_isFixedTimeStep ? static_cast<double>(m_leftOverTicks) / m_targetElapsedTicks : 1.0;
+    }
+
     // Get total number of updates since start of the program.
     uint32_t GetFrameCount() const { return m_frameCount; }
 
@@ -81,17 +94,12 @@ public:
 
     void ResetElapsedTime()
     {
-        #if defined(MN_DEBUG)
-        if (!QueryPerformanceCounter(&m_qpcLastTime))
-        {
-            throw std::exception("QueryPerformanceCounter");
-        }
-        #endif
+        m_clockLastTime = m_pClock->GetCounter();
 
         m_leftOverTicks = 0;
         m_framesPerSecond = 0;
         m_framesThisSecond = 0;
-        m_qpcSecondCounter = 0;
+        m_clockSecondCounter = 0;
     }
 
     // Update timer state, calling the specified Update function the appropriate number of times.
@@ -99,31 +107,24 @@ public:
     void Tick(const TUpdate& update)
     {
         // Query the current time.
-        LARGE_INTEGER currentTime;
-        
-        #if defined(MN_DEBUG)
-            if (!QueryPerformanceCounter(&currentTime))
-            {
-                throw std::exception("QueryPerformanceCounter");
-            }
-        #else
-            QueryPerformanceCounter(&currentTime);
-        #endif
+        const uint64_t currentTime = m_pClock->GetCounter();
 
-        uint64_t timeDelta = static_cast<uint64_t>(currentTime.QuadPart - m_qpcLastTime.QuadPart);
+        uint64_t timeDelta = currentTime - m_clockLastTime;
 
-        m_qpcLastTime = currentTime;
-        m_qpcSecondCounter += timeDelta;
+        m_clockLastTime = currentTime;
+        m_clockSecondCounter += timeDelta;
 
         // Clamp excessively large time deltas (e.g. after paused in the debugger).
-        if (timeDelta > m_qpcMaxDelta)
+        if (timeDelta > m_clockMaxDelta)
         {
-            timeDelta = m_qpcMaxDelta;
+            timeDelta = m_clockMaxDelta;
         }
 
-        // Convert QPC units into a canonical tick format. This cannot overflow due to the previous clamp.
+        // Convert clock units into a canonical tick format. This cannot overflow due to the previous clamp.
         timeDelta *= TicksPerSecond;
-        timeDelta /= static_cast<uint64_t>(m_qpcFrequency.QuadPart);
+        timeDelta /= m_clockFrequency;
+
+        m_frameTicks = timeDelta;
 
         uint32_t lastFrameCount = m_frameCount;
 
@@ -172,30 +173,32 @@ public:
             m_framesThisSecond++;
         }
 
-        if (m_qpcSecondCounter >= static_cast<uint64_t>(m_qpcFrequency.QuadPart))
+        if (m_clockSecondCounter >= m_clockFrequency)
         {
             m_framesPerSecond = m_framesThisSecond;
             m_framesThisSecond = 0;
-            m_qpcSecondCounter %= static_cast<uint64_t>(m_qpcFrequency.QuadPart);
+            m_clockSecondCounter %= m_clockFrequency;
         }
     }
 
 private:
-    // Source timing data uses QPC units.
-    LARGE_INTEGER m_qpcFrequency;
-    LARGE_INTEGER m_qpcLastTime;
-    uint64_t m_qpcMaxDelta;
+    // Source timing data uses the clock's units.
+    IClock* m_pClock;
+    uint64_t m_clockFrequency;
+    uint64_t m_clockLastTime;
+    uint64_t m_clockMaxDelta;
 
     // Derived timing data uses a canonical tick format.
     uint64_t m_elapsedTicks;
     uint64_t m_totalTicks;
     uint64_t m_leftOverTicks;
+    uint64_t m_frameTicks;
 
     // Members for tracking the framerate.
     uint32_t m_frameCount;
     uint32_t m_framesPerSecond;
     uint32_t m_framesThisSecond;
-    uint64_t m_qpcSecondCounter;
+    uint64_t m_clockSecondCounter;
 
     // Members for configuring fixed timestep mode.
     bool m_isFixedTimeStep;
@@ -12,7 +12,10 @@ using namespace DirectX;
 Transform::Transform() :
     mPosition       (XMVectorZero()),
     mScale          (XMVectorReplicate(1.0f)),
-    mQuatRotation   (XMQuaternionIdentity())
+    mQuatRotation   (XMQuaternionIdentity()),
+    mPrevPosition   (mPosition),
+    mPrevQuatRotation(mQuatRotation),
+    mPrevScale      (mScale)
 {
     XMStoreFloat4x4(&mWorld, DirectX::XMMatrixIdentity());
 }
@@ -20,7 +23,10 @@ Transform::Transform() :
 Transform::Transform(DirectX::XMVECTOR pos, DirectX::XMVECTOR scale, DirectX::XMVECTOR rotQuat) :
     mPosition(pos),
     mScale(scale),
-    mQuatRotation(rotQuat)
+    mQuatRotation(rotQuat),
+    mPrevPosition(pos),
+    mPrevQuatRotation(rotQuat),
+    mPrevScale(scale)
 {
     // Generate proper world matrix for given parameters
     this->Recompute();
@@ -36,6 +42,26 @@ DirectX::XMFLOAT4X4 Transform::Recompute()
     return mWorld;
 }
 
+void Transform::StoreState()
+{
+    mPrevPosition = mPosition;
+    mPrevQuatRotation = mQuatRotation;
+    mPrevScale = mScale;
+}
+
+DirectX::XMFLOAT4X4 Transform::Interpolate(float alpha)
+{
+    if (alpha >= 1.0f)
+        return Recompute();
+
+    XMVECTOR position = XMVectorLerp(mPrevPosition, mPosition, alpha);
+    XMVECTOR rotation = XMQuaternionSlerp(mPrevQuatRotation, mQuatRotation, alpha);
+    XMVECTOR scale = XMVectorLerp(mPrevScale, mScale, alpha);
+
+    XMStoreFloat4x4(&mWorld, XMMatrixAffineTransformation(scale, XMVectorZero(), rotation, position));
+    return mWorld;
+}
+
 
 void Transform::Translate(float x, float y, float z)
 {
@@ -2,6 +2,8 @@
 Ruben Young (rubenaryo@gmail.com)
 Date : 2020/2
 Description : Transform class for game objects
+Double buffered for fixed step simulation: StoreState keeps the last step's
+state, and Interpolate blends from it to the current one for rendering.
 ----------------------------------------------*/
 #ifndef TRANSFORM_H
 #define TRANSFORM_H
@@ -18,6 +20,12 @@ struct Transform
     // Returns World matrix from internal pos, scale, rot and stores it in mWorld
     DirectX::XMFLOAT4X4 Recompute();
 
+    // Call at the start of every fixed step, before anything moves the transform
+    void StoreState();
+
+    // World matrix between the stored state (alpha 0) and the current one (alpha 1), also stored in mWorld
+    DirectX::XMFLOAT4X4 Interpolate(float alpha);
+
     // Relative Transformers
     void Translate(float x, float y, float z);
     void Translate(DirectX::XMVECTOR translation);
@@ -45,6 +53,11 @@ private:
     DirectX::XMVECTOR mPosition;
     DirectX::XMVECTOR mQuatRotation;
     DirectX::XMVECTOR mScale;
+
+    // As of the last StoreState
+    DirectX::XMVECTOR mPrevPosition;
+    DirectX::XMVECTOR mPrevQuatRotation;
+    DirectX::XMVECTOR mPrevScale;
 };
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,430 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of World.h
+----------------------------------------------*/
+#include "World.h"
+
+#include <Muon/Core/JobSystem.h>
+
+#include <algorithm>
+#include <assert.h>
+#include <mutex>
+
+namespace Core {
+
+namespace {
+
+const uint32_t kChunksPerPool    = 64;      // 1MB of chunks at a time
+const uint32_t kColumnAlignment  = 64;      // Every column starts on its own cache line
+
+ComponentInfo sComponentInfos[kMaxComponentTypes];
+uint32_t      sComponentTypeCount = 0;
+std::mutex    sComponentTypeMutex;
+
+uint32_t AlignUp(uint32_t value, uint32_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// Where each column of mask goes for this many entities per chunk, returning the bytes it all takes
+uint32_t LayoutChunk(ComponentMask mask, uint32_t capacity, uint32_t* out_offsets)
+{
+    uint32_t offset = kChunkHeaderSize + capacity * (uint32_t)sizeof(EntityID);
+    for (uint32_t type = 0; type != kMaxComponentTypes; ++type)
+    {
+        if (!(mask & (ComponentMask(1) << type)))
+            continue;
+
+        ComponentInfo const& info = sComponentInfos[type];
+        offset = AlignUp(offset, std::max(info.Alignment, kColumnAlignment));
+        if (out_offsets)
+            out_offsets[type] = offset;
+        offset += capacity * info.Size;
+    }
+    return offset;
+}
+
+}
+
+uint32_t RegisterComponentType(uint32_t size, uint32_t alignment)
+{
+    std::lock_guard<std::mutex> lock(sComponentTypeMutex);
+    assert(sComponentTypeCount != kMaxComponentTypes && "Out of component types");
+    assert(alignment <= kColumnAlignment && "Columns are only cache line aligned");
+
+    sComponentInfos[sComponentTypeCount] = { size, alignment };
+    return sComponentTypeCount++;
+}
+
+ComponentInfo const& GetComponentInfo(uint32_t type)
+{
+    return sComponentInfos[type];
+}
+
+uint32_t GetPackedComponentOffset(ComponentMask mask, uint32_t type)
+{
+    // Only as far as the highest type before this one
+    ComponentMask below = type < kMaxComponentTypes ? mask & ((ComponentMask(1) << type) - 1) : mask;
+
+    uint32_t offset = 0;
+    for (uint32_t t = 0; below; ++t, below >>= 1)
+    {
+        if (below & 1)
+            offset += sComponentInfos[t].Size;
+    }
+    return offset;
+}
+
+uint32_t GetPackedComponentSize(ComponentMask mask)
+{
+    return GetPackedComponentOffset(mask, kMaxComponentTypes);
+}
+
+World::World() :
+    mFreeRecord(~0u),
+    mEntityCount(0),
+    mpLastArchetype(nullptr),
+    mChunkCount(0)
+{
+}
+
+World::~World()
+{
+    Shutdown();
+}
+
+void World::Init(uint32_t expectedEntities)
+{
+    mRecords.reserve(expectedEntities);
+}
+
+void World::Shutdown()
+{
+    for (std::unique_ptr<Archetype> const& pArchetype : mArchetypes)
+    {
+        for (uint8_t* pChunk : pArchetype->Chunks)
+            FreeChunk(pChunk);
+    }
+
+    mArchetypes.clear();
+    mArchetypeLookup.clear();
+    mpLastArchetype = nullptr;
+    mChunkPools.clear();
+    mRecords.clear();
+    mJobChunks.clear();
+    mJobFirstIndices.clear();
+    mFreeRecord = ~0u;
+    mEntityCount = 0;
+    assert(mChunkCount == 0);
+}
+
+EntityID World::Create(ComponentMask mask, void const* pData)
+{
+    uint32_t index = mFreeRecord;
+    if (index != ~0u)
+    {
+        mFreeRecord = mRecords[index].Slot;
+    }
+    else
+    {
+        index = (uint32_t)mRecords.size();
+        mRecords.push_back({ nullptr, 0, 1 });
+    }
+
+    EntityRecord& record = mRecords[index];
+    const EntityID entity = { index, record.Generation };
+
+    Archetype& archetype = *GetArchetype(mask);
+    record.pArchetype = &archetype;
+    record.Slot = AllocateSlot(archetype, entity);
+
+    uint8_t* pChunk = archetype.Chunks[record.Slot / archetype.Capacity];
+    const uint32_t row = record.Slot % archetype.Capacity;
+
+    const uint8_t* pSource = static_cast<const uint8_t*>(pData);
+    for (uint32_t i = 0; i != archetype.ComponentCount; ++i)
+    {
+        const uint32_t type = archetype.Components[i];
+        const uint32_t size = sComponentInfos[type].Size;
+        uint8_t* pDest = pChunk + archetype.Offsets[type] + row * size;
+        if (pSource)
+        {
+            memcpy(pDest, pSource, size);
+            pSource += size;
+        }
+        else
+        {
+            memset(pDest, 0, size);
+        }
+    }
+
+    mEntityCount++;
+    return entity;
+}
+
+bool World::Destroy(EntityID entity)
+{
+    EntityRecord* pRecord = GetRecord(entity);
+    if (!pRecord)
+        return false;
+
+    FreeSlot(*pRecord->pArchetype, pRecord->Slot);
+
+    pRecord->pArchetype = nullptr;
+    pRecord->Generation = pRecord->Generation + 1 ? pRecord->Generation + 1 : 1;
+    pRecord->Slot = mFreeRecord;
+    mFreeRecord = entity.Index;
+
+    mEntityCount--;
+    return true;
+}
+
+bool World::AddComponents(EntityID entity, ComponentMask mask, void const* pData)
+{
+    EntityRecord* pRecord = GetRecord(entity);
+    if (!pRecord)
+        return false;
+
+    Archetype& from = *pRecord->pArchetype;
+    if ((from.Mask | mask) != from.Mask)
+    {
+        Archetype& to = *GetArchetype(from.Mask | mask);
+        const uint32_t slot = AllocateSlot(to, entity);
+        for (uint32_t i = 0; i != from.ComponentCount; ++i)
+        {
+            const uint32_t type = from.Components[i];
+            memcpy(GetSlotData(to, slot, type), GetSlotData(from, pRecord->Slot, type), sComponentInfos[type].Size);
+        }
+
+        FreeSlot(from, pRecord->Slot);
+        pRecord->pArchetype = &to;
+        pRecord->Slot = slot;
+    }
+
+    const uint8_t* pSource = static_cast<const uint8_t*>(pData);
+    for (uint32_t type = 0; type != kMaxComponentTypes; ++type)
+    {
+        if (!(mask & (ComponentMask(1) << type)))
+            continue;
+
+        const uint32_t size = sComponentInfos[type].Size;
+        uint8_t* pDest = GetSlotData(*pRecord->pArchetype, pRecord->Slot, type);
+        if (pSource)
+        {
+            memcpy(pDest, pSource, size);
+            pSource += size;
+        }
+        else
+        {
+            memset(pDest, 0, size);
+        }
+    }
+    return true;
+}
+
+bool World::RemoveComponents(EntityID entity, ComponentMask mask)
+{
+    EntityRecord* pRecord = GetRecord(entity);
+    if (!pRecord)
+        return false;
+
+    Archetype& from = *pRecord->pArchetype;
+    if (!(from.Mask & mask))
+        return true;
+
+    Archetype& to = *GetArchetype(from.Mask & ~mask);
+    const uint32_t slot = AllocateSlot(to, entity);
+    for (uint32_t i = 0; i != to.ComponentCount; ++i)
+    {
+        const uint32_t type = to.Components[i];
+        memcpy(GetSlotData(to, slot, type), GetSlotData(from, pRecord->Slot, type), sComponentInfos[type].Size);
+    }
+
+    FreeSlot(from, pRecord->Slot);
+    pRecord->pArchetype = &to;
+    pRecord->Slot = slot;
+    return true;
+}
+
+bool World::IsAlive(EntityID entity) const
+{
+    return GetRecord(entity) != nullptr;
+}
+
+void* World::GetComponent(EntityID entity, uint32_t type)
+{
+    EntityRecord* pRecord = GetRecord(entity);
+    if (!pRecord || !pRecord->pArchetype->Offsets[type])
+        return nullptr;
+
+    return GetSlotData(*pRecord->pArchetype, pRecord->Slot, type);
+}
+
+uint32_t World::CountEntities(ComponentMask required) const
+{
+    uint32_t count = 0;
+    for (std::unique_ptr<Archetype> const& pArchetype : mArchetypes)
+    {
+        if ((pArchetype->Mask & required) == required)
+            count += pArchetype->EntityCount;
+    }
+    return count;
+}
+
+void World::ParallelForEachChunk(ComponentMask required, uint32_t chunksPerJob, std::function<void(ChunkView const&, uint32_t)> const& fn)
+{
+    mJobChunks.clear();
+    mJobFirstIndices.clear();
+    ForEachChunk(required, [this](ChunkView const& chunk, uint32_t firstIndex)
+    {
+        mJobChunks.push_back(chunk);
+        mJobFirstIndices.push_back(firstIndex);
+    });
+
+    JobCounter counter;
+    JobSystem::Dispatch(counter, (uint32_t)mJobChunks.size(), chunksPerJob, [this, &fn](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t i = begin; i != end; ++i)
+            fn(mJobChunks[i], mJobFirstIndices[i]);
+    });
+    JobSystem::Wait(counter);
+}
+
+ChunkView World::GetChunkView(Archetype const& archetype, uint32_t chunk)
+{
+    ChunkView view;
+    view.mpData = archetype.Chunks[chunk];
+    view.mpArchetype = &archetype;
+    view.mCount = std::min(archetype.EntityCount - chunk * archetype.Capacity, archetype.Capacity);
+    return view;
+}
+
+World::EntityRecord* World::GetRecord(EntityID entity)
+{
+    if (entity.Index >= mRecords.size())
+        return nullptr;
+
+    EntityRecord& record = mRecords[entity.Index];
+    return record.pArchetype && record.Generation == entity.Generation ? &record : nullptr;
+}
+
+World::EntityRecord const* World::GetRecord(EntityID entity) const
+{
+    return const_cast<World*>(this)->GetRecord(entity);
+}
+
+Archetype* World::GetArchetype(ComponentMask mask)
+{
+    // Entities tend to be made in runs of the same kind
+    if (mpLastArchetype && mpLastArchetype->Mask == mask)
+        return mpLastArchetype;
+
+    auto it = mArchetypeLookup.find(mask);
+    if (it != mArchetypeLookup.end())
+    {
+        mpLastArchetype = mArchetypes[it->second].get();
+        return mpLastArchetype;
+    }
+
+    std::unique_ptr<Archetype> pArchetype(new Archetype());
+    Archetype& archetype = *pArchetype;
+    archetype.Mask = mask;
+    archetype.ComponentCount = 0;
+    archetype.EntityCount = 0;
+    memset(archetype.Offsets, 0, sizeof(archetype.Offsets));
+
+    uint32_t bytesPerEntity = sizeof(EntityID);
+    for (uint32_t type = 0; type != kMaxComponentTypes; ++type)
+    {
+        if (!(mask & (ComponentMask(1) << type)))
+            continue;
+
+        archetype.Components[archetype.ComponentCount++] = (uint8_t)type;
+        bytesPerEntity += sComponentInfos[type].Size;
+    }
+
+    // Start from what would fit without padding and back off until the padding fits too
+    archetype.Capacity = (kChunkSize - kChunkHeaderSize) / bytesPerEntity;
+    while (archetype.Capacity && LayoutChunk(mask, archetype.Capacity, nullptr) > kChunkSize)
+        archetype.Capacity--;
+
+    assert(archetype.Capacity && "Components too large to fit an entity in a chunk");
+    LayoutChunk(mask, archetype.Capacity, archetype.Offsets);
+
+    mArchetypeLookup[mask] = (uint32_t)mArchetypes.size();
+    mArchetypes.push_back(std::move(pArchetype));
+    mpLastArchetype = &archetype;
+    return &archetype;
+}
+
+uint32_t World::AllocateSlot(Archetype& archetype, EntityID entity)
+{
+    const uint32_t slot = archetype.EntityCount++;
+    if (slot == archetype.Chunks.size() * archetype.Capacity)
+        archetype.Chunks.push_back(AllocateChunk());
+
+    EntityID* pEntities = reinterpret_cast<EntityID*>(archetype.Chunks[slot / archetype.Capacity] + kChunkHeaderSize);
+    pEntities[slot % archetype.Capacity] = entity;
+    return slot;
+}
+
+void World::FreeSlot(Archetype& archetype, uint32_t slot)
+{
+    const uint32_t last = --archetype.EntityCount;
+    if (slot != last)
+    {
+        EntityID* pTo = reinterpret_cast<EntityID*>(archetype.Chunks[slot / archetype.Capacity] + kChunkHeaderSize) + slot % archetype.Capacity;
+        EntityID const* pFrom = reinterpret_cast<EntityID const*>(archetype.Chunks[last / archetype.Capacity] + kChunkHeaderSize) + last % archetype.Capacity;
+        *pTo = *pFrom;
+        mRecords[pFrom->Index].Slot = slot;
+
+        for (uint32_t i = 0; i != archetype.ComponentCount; ++i)
+        {
+            const uint32_t type = archetype.Components[i];
+            memcpy(GetSlotData(archetype, slot, type), GetSlotData(archetype, last, type), sComponentInfos[type].Size);
+        }
+    }
+
+    if (last % archetype.Capacity == 0)
+    {
+        FreeChunk(archetype.Chunks.back());
+        archetype.Chunks.pop_back();
+    }
+}
+
+uint8_t* World::GetSlotData(Archetype const& archetype, uint32_t slot, uint32_t type) const
+{
+    uint8_t* pChunk = archetype.Chunks[slot / archetype.Capacity];
+    return pChunk + archetype.Offsets[type] + (slot % archetype.Capacity) * sComponentInfos[type].Size;
+}
+
+// The header's first word is the pool the chunk came from
+uint8_t* World::AllocateChunk()
+{
+    uint32_t pool = 0;
+    void* pChunk = nullptr;
+    for (; pool != (uint32_t)mChunkPools.size() && !pChunk; ++pool)
+        pChunk = mChunkPools[pool]->Alloc();
+
+    if (!pChunk)
+    {
+        mChunkPools.emplace_back(new Memory::PoolAllocator());
+        mChunkPools.back()->Init(kChunkSize, kChunksPerPool, Memory::MemoryTag::ENTITIES, kColumnAlignment);
+        pChunk = mChunkPools.back()->Alloc();
+        pool++;
+    }
+
+    *static_cast<uint32_t*>(pChunk) = pool - 1;
+    mChunkCount++;
+    return static_cast<uint8_t*>(pChunk);
+}
+
+void World::FreeChunk(uint8_t* pChunk)
+{
+    const uint32_t pool = *reinterpret_cast<uint32_t*>(pChunk);
+    mChunkPools[pool]->Free(pChunk);
+    mChunkCount--;
+}
+
+}
@@ -0,0 +1,275 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Archetype based entity storage
+Entities with the same set of components share an archetype, which keeps
+them in 16KB chunks holding one contiguous column per component. Systems
+walk the chunks of every archetype that has what they need, on the calling
+thread or a few chunks per job. An archetype stays densely packed: removing
+an entity moves its last one into the hole, so only the last chunk is ever
+partly empty. Anything that changes an entity's archetype has to wait until
+no system is iterating, which is what EntityCommandBuffer is for.
+----------------------------------------------*/
+#ifndef MUON_WORLD_H
+#define MUON_WORLD_H
+
+#include <Muon/Memory/Allocators.h>
+
+#include <functional>
+#include <memory>
+#include <stdint.h>
+#include <string.h>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace Core {
+
+struct EntityID
+{
+    uint32_t Index;
+    uint32_t Generation;    // Bumped whenever the index is reused, so a stale ID stops resolving
+
+    bool operator==(EntityID const& other) const { return Index == other.Index && Generation == other.Generation; }
+    bool operator!=(EntityID const& other) const { return !(*this == other); }
+};
+
+static const EntityID kInvalidEntity = { ~0u, 0 };
+
+// One bit per component type
+typedef uint64_t ComponentMask;
+static const uint32_t kMaxComponentTypes = 64;
+
+struct ComponentInfo
+{
+    uint32_t Size;
+    uint32_t Alignment;
+};
+
+// Hands out component type IDs in the order types are first used
+uint32_t RegisterComponentType(uint32_t size, uint32_t alignment);
+ComponentInfo const& GetComponentInfo(uint32_t type);
+
+// Components are moved around as raw bytes and never destroyed
+template <typename T>
+uint32_t GetComponentType()
+{
+    static_assert(std::is_trivially_copyable<T>::value && std::is_trivially_destructible<T>::value, "Components must be plain data");
+
+    static const uint32_t type = RegisterComponentType((uint32_t)sizeof(T), (uint32_t)alignof(T));
+    return type;
+}
+
+template <typename... Ts>
+ComponentMask GetComponentMask()
+{
+    return (ComponentMask(0) | ... | (ComponentMask(1) << GetComponentType<Ts>()));
+}
+
+// Component data handed to Create and AddComponents is every component of the mask in ascending
+// type order, packed back to back. This is where one of them starts.
+uint32_t GetPackedComponentOffset(ComponentMask mask, uint32_t type);
+uint32_t GetPackedComponentSize(ComponentMask mask);
+
+template <typename T>
+void PackComponent(ComponentMask mask, uint8_t* pData, T const& component)
+{
+    memcpy(pData + GetPackedComponentOffset(mask, GetComponentType<T>()), &component, sizeof(T));
+}
+
+static const uint32_t kChunkSize       = 16 * 1024;
+static const uint32_t kChunkHeaderSize = 64;
+
+struct Archetype
+{
+    ComponentMask         Mask;
+    uint32_t              ComponentCount;
+    uint8_t               Components[kMaxComponentTypes];   // Every type in Mask, ascending
+    uint32_t              Capacity;                         // Entities per chunk
+    uint32_t              EntityCount;
+    uint32_t              Offsets[kMaxComponentTypes];      // Each component's column in a chunk, 0 when it has none
+    std::vector<uint8_t*> Chunks;
+};
+
+// One chunk's worth of entities and their component columns
+class ChunkView
+{
+public:
+    uint32_t        GetCount() const    { return mCount; }
+    EntityID const* GetEntities() const { return reinterpret_cast<EntityID const*>(mpData + kChunkHeaderSize); }
+
+    // Null when the archetype doesn't have it
+    template <typename T>
+    T* Get() const
+    {
+        const uint32_t offset = mpArchetype->Offsets[GetComponentType<T>()];
+        return offset ? reinterpret_cast<T*>(mpData + offset) : nullptr;
+    }
+
+    ComponentMask GetMask() const { return mpArchetype->Mask; }
+
+private:
+    friend class World;
+
+    uint8_t*         mpData;
+    Archetype const* mpArchetype;
+    uint32_t         mCount;
+};
+
+class World
+{
+public:
+    World();
+    ~World();
+
+    // Reserves room for that many entities. Chunks are pooled a block at a time as they're needed.
+    void Init(uint32_t expectedEntities = 0);
+    void Shutdown();
+
+    // Zeroed components for every bit of mask, or copied from packed pData
+    EntityID Create(ComponentMask mask, void const* pData = nullptr);
+
+    // One of each component given, in any order
+    template <typename... Ts>
+    EntityID CreateWith(Ts const&... components)
+    {
+        const ComponentMask mask = GetComponentMask<Ts...>();
+        uint8_t data[(sizeof(Ts) + ... + 0) + 1];
+        (PackComponent(mask, data, components), ...);
+        return Create(mask, data);
+    }
+
+    // False if the entity was already gone
+    bool Destroy(EntityID entity);
+
+    // Moves the entity to the archetype with these components added or taken away. Added components
+    // are zeroed or copied from packed pData, ones it already had are overwritten. False if it was gone.
+    bool AddComponents(EntityID entity, ComponentMask mask, void const* pData = nullptr);
+    bool RemoveComponents(EntityID entity, ComponentMask mask);
+
+    template <typename T>
+    bool Add(EntityID entity, T const& component) { return AddComponents(entity, GetComponentMask<T>(), &component); }
+
+    template <typename T>
+    bool Remove(EntityID entity) { return RemoveComponents(entity, GetComponentMask<T>()); }
+
+    bool IsAlive(EntityID entity) const;
+
+    // Null if the entity is gone or doesn't have it. Only good until the next structural change.
+    void* GetComponent(EntityID entity, uint32_t type);
+
+    template <typename T>
+    T* Get(EntityID entity) { return static_cast<T*>(GetComponent(entity, GetComponentType<T>())); }
+
+    uint32_t GetEntityCount() const    { return mEntityCount; }
+    uint32_t GetArchetypeCount() const { return (uint32_t)mArchetypes.size(); }
+    uint32_t GetChunkCount() const     { return mChunkCount; }
+
+    // How many entities have every component in required
+    uint32_t CountEntities(ComponentMask required) const;
+
+    // Calls fn(chunk, firstIndex) for every chunk with all of required. firstIndex counts entities in the
+    // order they're visited, archetypes in the order they were made then their chunks, so it stays the
+    // same until something structural changes.
+    template <typename Fn>
+    void ForEachChunk(ComponentMask required, Fn&& fn) const
+    {
+        uint32_t firstIndex = 0;
+        for (std::unique_ptr<Archetype> const& pArchetype : mArchetypes)
+        {
+            Archetype const& archetype = *pArchetype;
+            if ((archetype.Mask & required) != required)
+                continue;
+
+            for (uint32_t c = 0; c != (uint32_t)archetype.Chunks.size(); ++c)
+            {
+                const ChunkView chunk = GetChunkView(archetype, c);
+                fn(chunk, firstIndex);
+                firstIndex += chunk.mCount;
+            }
+        }
+    }
+
+    // fn(T&...) for every entity with all of Ts
+    template <typename... Ts, typename Fn>
+    void ForEach(Fn&& fn)
+    {
+        ForEachChunk(GetComponentMask<Ts...>(), [&fn](ChunkView const& chunk, uint32_t)
+        {
+            RunOverChunk<Ts...>(chunk, fn);
+        });
+    }
+
+    // ForEachChunk spread over the job system, chunksPerJob at a time, returning once they've all run.
+    // Nothing may change structurally until then: record the changes into an EntityCommandBuffer per job
+    // and play them back after. Not reentrant.
+    void ParallelForEachChunk(ComponentMask required, uint32_t chunksPerJob, std::function<void(ChunkView const&, uint32_t)> const& fn);
+
+    template <typename... Ts, typename Fn>
+    void ParallelForEach(Fn const& fn, uint32_t chunksPerJob = 1)
+    {
+        ParallelForEachChunk(GetComponentMask<Ts...>(), chunksPerJob, [&fn](ChunkView const& chunk, uint32_t)
+        {
+            RunOverChunk<Ts...>(chunk, fn);
+        });
+    }
+
+private:
+    struct EntityRecord
+    {
+        Archetype* pArchetype;      // Null while the index is free
+        uint32_t   Slot;            // Index within the archetype, or the next free index
+        uint32_t   Generation;
+    };
+
+    template <typename... Ts, typename Fn>
+    static void RunOverChunk(ChunkView const& chunk, Fn& fn)
+    {
+        auto columns = std::make_tuple(chunk.Get<Ts>()...);
+        for (uint32_t i = 0; i != chunk.GetCount(); ++i)
+            fn(std::get<Ts*>(columns)[i]...);
+    }
+
+    static ChunkView GetChunkView(Archetype const& archetype, uint32_t chunk);
+
+    EntityRecord* GetRecord(EntityID entity);
+    EntityRecord const* GetRecord(EntityID entity) const;
+
+    Archetype* GetArchetype(ComponentMask mask);
+
+    // Appends an entity to the archetype, returning its slot
+    uint32_t AllocateSlot(Archetype& archetype, EntityID entity);
+
+    // Moves the archetype's last entity into the slot and drops the last chunk if that emptied it
+    void FreeSlot(Archetype& archetype, uint32_t slot);
+
+    uint8_t* GetSlotData(Archetype const& archetype, uint32_t slot, uint32_t type) const;
+
+    uint8_t* AllocateChunk();
+    void     FreeChunk(uint8_t* pChunk);
+
+private:
+    std::vector<EntityRecord> mRecords;
+    uint32_t                  mFreeRecord;      // ~0u when every record is in use
+    uint32_t                  mEntityCount;
+
+    std::vector<std::unique_ptr<Archetype>>   mArchetypes;
+    std::unordered_map<ComponentMask, uint32_t> mArchetypeLookup;
+    Archetype*                mpLastArchetype;  // Whatever GetArchetype last returned
+
+    // Every chunk comes from one of these, each a block of kChunksPerPool
+    std::vector<std::unique_ptr<Memory::PoolAllocator>> mChunkPools;
+    uint32_t                  mChunkCount;
+
+    // What ParallelForEachChunk hands out
+    std::vector<ChunkView>    mJobChunks;
+    std::vector<uint32_t>     mJobFirstIndices;
+
+public:
+    World(World const&)            = delete;
+    World& operator=(World const&) = delete;
+};
+
+}
+#endif
@@ -0,0 +1,126 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of ChordMatcher.h
+----------------------------------------------*/
+#include "ChordMatcher.h"
+
+#include <assert.h>
+
+namespace Input {
+
+    ChordMatcher::ChordMatcher()
+    {
+        Clear();
+    }
+
+    void ChordMatcher::Clear()
+    {
+        for (CompiledChord& chord : mChords)
+        {
+            chord.Care.Clear();
+            chord.Previous.Clear();
+            chord.Current.Clear();
+            chord.Bound = false;
+            chord.Impossible = false;
+        }
+
+        for (uint32_t& commands : mKeyCommands)
+            commands = 0;
+
+        mActiveCommands = 0;
+        mLastChanged.Clear();
+        mRetestAll = true;
+    }
+
+    void ChordMatcher::Bind(GameCommands command, Chord const& chord)
+    {
+        Unbind(command);
+
+        const uint32_t bit = CommandBit(command);
+        CompiledChord& compiled = mChords[(uint32_t)command];
+        compiled.Bound = true;
+
+        for (Binding const& binding : chord.GetChord())
+        {
+            assert(binding.GetKeyCode() < 256);
+            const uint8_t key = (uint8_t)binding.GetKeyCode();
+            const KeyState state = binding.GetKeyState();
+            const bool previous = state == KeyState::StillPressed || state == KeyState::JustReleased;
+            const bool current = state == KeyState::StillPressed || state == KeyState::JustPressed;
+
+            if (compiled.Care.Test(key) && (compiled.Previous.Test(key) != previous || compiled.Current.Test(key) != current))
+                compiled.Impossible = true;
+
+            compiled.Care.Set(key);
+            if (previous)
+                compiled.Previous.Set(key);
+            if (current)
+                compiled.Current.Set(key);
+            mKeyCommands[key] |= bit;
+        }
+
+        mRetestAll = true;
+    }
+
+    void ChordMatcher::Unbind(GameCommands command)
+    {
+        const uint32_t bit = CommandBit(command);
+        CompiledChord& compiled = mChords[(uint32_t)command];
+        compiled.Care.Clear();
+        compiled.Previous.Clear();
+        compiled.Current.Clear();
+        compiled.Bound = false;
+        compiled.Impossible = false;
+
+        for (uint32_t& commands : mKeyCommands)
+            commands &= ~bit;
+
+        mActiveCommands &= ~bit;
+        mRetestAll = true;
+    }
+
+    bool ChordMatcher::Matches(CompiledChord const& chord, KeyBits const& previous, KeyBits const& current) const
+    {
+        if (!chord.Bound || chord.Impossible)
+            return false;
+
+        uint64_t mismatch = 0;
+        for (uint32_t i = 0; i != 4; ++i)
+            mismatch |= ((previous.Words[i] ^ chord.Previous.Words[i]) | (current.Words[i] ^ chord.Current.Words[i])) & chord.Care.Words[i];
+        return mismatch == 0;
+    }
+
+    uint32_t ChordMatcher::Update(KeyBits const& previous, KeyBits const& current)
+    {
+        // A chord can only change when one of its keys went down or up this frame or the last
+        uint32_t retest = mRetestAll ? ~0u : 0u;
+        for (uint32_t i = 0; i != 4; ++i)
+        {
+            const uint64_t changed = previous.Words[i] ^ current.Words[i];
+            uint64_t dirty = changed | mLastChanged.Words[i];
+            mLastChanged.Words[i] = changed;
+
+            for (uint32_t bit = 0; dirty; ++bit, dirty >>= 1)
+            {
+                if (dirty & 1)
+                    retest |= mKeyCommands[i * 64 + bit];
+            }
+        }
+        mRetestAll = false;
+
+        for (uint32_t command = 0; command != (uint32_t)GameCommands::COUNT; ++command)
+        {
+            const uint32_t bit = 1u << command;
+            if (!(retest & bit))
+                continue;
+
+            if (Matches(mChords[command], previous, current))
+                mActiveCommands |= bit;
+            else
+                mActiveCommands &= ~bit;
+        }
+
+        return mActiveCommands;
+    }
+}
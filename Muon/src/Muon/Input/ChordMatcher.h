@@ -0,0 +1,66 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Matches key states against every bound chord at once
+Each chord is compiled to three 256 bit masks: which keys it cares about,
+and whether each of those has to have been down last frame and be down now.
+Testing it is then a few word compares instead of a walk over its bindings.
+A table indexed by key code lists the commands using each key, so a frame
+only retests the chords whose keys changed.
+----------------------------------------------*/
+#ifndef CHORDMATCHER_H
+#define CHORDMATCHER_H
+
+#include "InputBinding.h"
+
+#include <stdint.h>
+
+namespace Input {
+
+    // One bit per key code
+    struct KeyBits
+    {
+        uint64_t Words[4];
+
+        void Clear()                          { Words[0] = Words[1] = Words[2] = Words[3] = 0; }
+        bool Test(uint8_t key) const          { return (Words[key >> 6] >> (key & 63)) & 1; }
+        void Set(uint8_t key)                 { Words[key >> 6] |= 1ull << (key & 63); }
+        void Reset(uint8_t key)               { Words[key >> 6] &= ~(1ull << (key & 63)); }
+    };
+
+    class ChordMatcher
+    {
+    public:
+        ChordMatcher();
+
+        void Clear();
+
+        // Replaces whatever the command was bound to. A chord without bindings is always met.
+        void Bind(GameCommands command, Chord const& chord);
+        void Unbind(GameCommands command);
+
+        // The CommandBit of every command whose chord is met, given which keys were down last frame and are now
+        uint32_t Update(KeyBits const& previous, KeyBits const& current);
+
+        uint32_t GetActiveCommands() const { return mActiveCommands; }
+
+    private:
+        struct CompiledChord
+        {
+            KeyBits Care;
+            KeyBits Previous;
+            KeyBits Current;
+            bool    Bound;
+            bool    Impossible;     // Wants some key in two states at once
+        };
+
+        bool Matches(CompiledChord const& chord, KeyBits const& previous, KeyBits const& current) const;
+
+        CompiledChord mChords[(uint32_t)GameCommands::COUNT];
+        uint32_t      mKeyCommands[256];    // CommandBit of every chord using the key
+        uint32_t      mActiveCommands;
+        KeyBits       mLastChanged;         // A key that changed last frame changes its previous state this frame
+        bool          mRetestAll;           // After a binding changes
+    };
+}
+#endif
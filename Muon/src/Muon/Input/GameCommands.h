@@ -0,0 +1,33 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : The commands a key map binds chords to
+Kept apart from the bindings and Windows, so anything that only deals in
+commands (input recordings, the headless camera) builds on any platform.
+----------------------------------------------*/
+#ifndef GAMECOMMANDS_H
+#define GAMECOMMANDS_H
+
+#include <stdint.h>
+
+namespace Input {
+
+    // Enumeration of different GameCommands
+    enum class GameCommands
+    {
+        Quit,
+        MoveForward,
+        MoveBackward,
+        MoveLeft,
+        MoveRight,
+        MoveUp,
+        RollLeft,
+        RollRight,
+        CameraRotation,
+        COUNT
+    };
+
+    // A set of commands as one bit each
+    inline uint32_t CommandBit(GameCommands command) { return 1u << (uint32_t)command; }
+}
+#endif
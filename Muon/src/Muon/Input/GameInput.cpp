@@ -24,13 +24,24 @@ namespace Input {
 
         static const float kSpeed = 5.0f;
 
+        // Sampled here rather than after the last frame's commands, so everything queued up to the camera
+        // moving gets acted on this frame
+        GetInput();
+
+        // Replays act on their recorded dt, so the camera retraces the session whatever the frame rate
+        dt = BeginFrame(dt);
+
         // Act on user input:
-        // - Iterate through all active keys
-        // - Check for commands corresponding to activated chords
+        // - Iterate through all commands
+        // - Check which ones had their chords met
         // - Do something based on those commands
-        for (auto const& pair : mActiveKeyMap)
+        for (uint32_t i = 0; i != (uint32_t)GameCommands::COUNT; ++i)
         {
-            switch (pair.first)
+            const GameCommands command = (GameCommands)i;
+            if (!IsActive(command))
+                continue;
+
+            switch (command)
             {
             case GameCommands::Quit:
                 PostQuitMessage(0);
@@ -71,24 +82,23 @@ namespace Input {
                 pCamera->Rotate(XMQuaternionMultiply(horizontalQuat, verticalQuat));
                 break;
             }
+            default:
+                break;
             }
         }
-        
-        GetInput();
     }
 
     void GameInput::SetDefaultKeyMap()
     {
-        mKeyMap.clear();
-        mKeyMap[GameCommands::Quit]         = new Chord(L"Quit", VK_ESCAPE, KeyState::JustReleased);
-        mKeyMap[GameCommands::MoveForward]  = new Chord(L"Move Forward", 'W', KeyState::StillPressed);
-        mKeyMap[GameCommands::MoveBackward] = new Chord(L"Move Backward", 'S', KeyState::StillPressed);
-        mKeyMap[GameCommands::MoveLeft]     = new Chord(L"Move Left", 'A', KeyState::StillPressed);
-        mKeyMap[GameCommands::MoveRight]    = new Chord(L"Move Right", 'D', KeyState::StillPressed);
-        mKeyMap[GameCommands::MoveUp]       = new Chord(L"Move Up", VK_SPACE, KeyState::StillPressed);
-        mKeyMap[GameCommands::RollLeft]     = new Chord(L"Roll Left", 'Q', KeyState::StillPressed);
-        mKeyMap[GameCommands::RollRight]    = new Chord(L"Roll Right", 'E', KeyState::StillPressed);
+        Bind(GameCommands::Quit,         Chord(L"Quit", VK_ESCAPE, KeyState::JustReleased));
+        Bind(GameCommands::MoveForward,  Chord(L"Move Forward", 'W', KeyState::StillPressed));
+        Bind(GameCommands::MoveBackward, Chord(L"Move Backward", 'S', KeyState::StillPressed));
+        Bind(GameCommands::MoveLeft,     Chord(L"Move Left", 'A', KeyState::StillPressed));
+        Bind(GameCommands::MoveRight,    Chord(L"Move Right", 'D', KeyState::StillPressed));
+        Bind(GameCommands::MoveUp,       Chord(L"Move Up", VK_SPACE, KeyState::StillPressed));
+        Bind(GameCommands::RollLeft,     Chord(L"Roll Left", 'Q', KeyState::StillPressed));
+        Bind(GameCommands::RollRight,    Chord(L"Roll Right", 'E', KeyState::StillPressed));
 
-        mKeyMap[GameCommands::CameraRotation] = new Chord(L"Camera Rotation", VK_RBUTTON, KeyState::StillPressed);
+        Bind(GameCommands::CameraRotation, Chord(L"Camera Rotation", VK_RBUTTON, KeyState::StillPressed));
     }
 }
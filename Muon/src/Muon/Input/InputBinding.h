@@ -7,8 +7,7 @@ to be used by the Inputhandling InputSystem class
 #ifndef INPUTBINDING_H
 #define INPUTBINDING_H
 
-// Preset our windows includes
-#include <Muon/Core/WinApp.h>
+#include "GameCommands.h"
 
 // std inclusions
 #include <string>
@@ -16,20 +15,6 @@ to be used by the Inputhandling InputSystem class
 #include <vector>
 
 namespace Input {
-    
-    // Enumeration of different GameCommands
-    enum class GameCommands
-    {
-        Quit,
-        MoveForward,
-        MoveBackward,
-        MoveLeft,
-        MoveRight,
-        MoveUp,
-        RollLeft,
-        RollRight,
-        CameraRotation
-    };
 
     // Enum to emphasize the different states of a key
     enum class KeyState
@@ -52,7 +37,8 @@ namespace Input {
         Binding(const unsigned int keyCode, const KeyState keyState);
         ~Binding() {};
 
-        friend class InputSystem;
+        unsigned int GetKeyCode() const  { return mKeyCode; }
+        KeyState     GetKeyState() const { return mKeyState; }
     };
 
     // Maps a game command to a Binding
@@ -72,7 +58,10 @@ namespace Input {
         // Accessors for member variables
         std::vector<Binding>& GetChord() { return mChord; }
         std::wstring&         GetName()  { return mName;  }
+
+        std::vector<Binding> const& GetChord() const { return mChord; }
+        std::wstring const&         GetName() const  { return mName;  }
     };
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,259 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of InputRecording.h
+----------------------------------------------*/
+#include "InputRecording.h"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace Input {
+
+    namespace {
+
+        const uint8_t  kMagic[4]    = { 'M', 'N', 'I', 'R' };
+        const uint16_t kVersion     = 1;
+        const size_t   kHeaderBytes = 16;   // Magic, version, reserved, frame count, stream bytes
+
+        // Leads every frame, saying which fields follow it
+        enum FrameFlags : uint8_t
+        {
+            kCommandsChanged = 1 << 0,
+            kMouseMoved      = 1 << 1,
+            kDtChanged       = 1 << 2,
+            kAllFlags        = kCommandsChanged | kMouseMoved | kDtChanged
+        };
+
+        // Little endian whatever the platform, so a recording made on Windows replays anywhere
+
+        void WriteU32(std::vector<uint8_t>& out_data, uint32_t value)
+        {
+            for (uint32_t i = 0; i != 4; ++i)
+                out_data.push_back((uint8_t)(value >> (i * 8)));
+        }
+
+        uint32_t ReadU32(const uint8_t* pData)
+        {
+            return (uint32_t)pData[0] | ((uint32_t)pData[1] << 8) | ((uint32_t)pData[2] << 16) | ((uint32_t)pData[3] << 24);
+        }
+
+        void WriteVarint(std::vector<uint8_t>& out_data, uint32_t value)
+        {
+            while (value >= 0x80)
+            {
+                out_data.push_back((uint8_t)(value | 0x80));
+                value >>= 7;
+            }
+            out_data.push_back((uint8_t)value);
+        }
+
+        bool ReadVarint(const uint8_t* pData, size_t size, size_t& inout_cursor, uint32_t& out_value)
+        {
+            out_value = 0;
+            for (uint32_t shift = 0; shift < 35; shift += 7)
+            {
+                if (inout_cursor == size)
+                    return false;
+
+                const uint8_t byte = pData[inout_cursor++];
+                out_value |= (uint32_t)(byte & 0x7f) << shift;
+                if (!(byte & 0x80))
+                    return true;
+            }
+            return false;
+        }
+
+        // Zigzag, so small deltas either way take one byte
+        uint32_t ZigZag(int16_t value)    { return ((uint32_t)(int32_t)value << 1) ^ (uint32_t)((int32_t)value >> 31); }
+        int16_t  UnZigZag(uint32_t value) { return (int16_t)((value >> 1) ^ (0u - (value & 1))); }
+
+        uint32_t FloatBits(float value)   { uint32_t bits; memcpy(&bits, &value, sizeof(bits)); return bits; }
+        float    BitsFloat(uint32_t bits) { float value; memcpy(&value, &bits, sizeof(value)); return value; }
+
+        // Applies one encoded frame on top of the frame before it
+        bool DecodeFrame(const uint8_t* pData, size_t size, size_t& inout_cursor, InputFrame& inout_frame)
+        {
+            if (inout_cursor == size)
+                return false;
+
+            const uint8_t flags = pData[inout_cursor++];
+            if (flags & ~kAllFlags)
+                return false;
+
+            if ((flags & kCommandsChanged) && !ReadVarint(pData, size, inout_cursor, inout_frame.Commands))
+                return false;
+
+            inout_frame.MouseDeltaX = 0;
+            inout_frame.MouseDeltaY = 0;
+            if (flags & kMouseMoved)
+            {
+                uint32_t x, y;
+                if (!ReadVarint(pData, size, inout_cursor, x) || !ReadVarint(pData, size, inout_cursor, y) || x > 0xffff || y > 0xffff)
+                    return false;
+
+                inout_frame.MouseDeltaX = UnZigZag(x);
+                inout_frame.MouseDeltaY = UnZigZag(y);
+            }
+
+            if (flags & kDtChanged)
+            {
+                if (size - inout_cursor < 4)
+                    return false;
+
+                inout_frame.Dt = BitsFloat(ReadU32(pData + inout_cursor));
+                inout_cursor += 4;
+            }
+            return true;
+        }
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // InputRecorder
+
+    InputRecorder::InputRecorder() :
+        mStream(),
+        mLast(),
+        mFrameCount(0)
+    {
+    }
+
+    void InputRecorder::Reset()
+    {
+        mStream.clear();
+        mLast = InputFrame();
+        mFrameCount = 0;
+    }
+
+    void InputRecorder::Record(InputFrame const& frame)
+    {
+        const bool moved = frame.MouseDeltaX != 0 || frame.MouseDeltaY != 0;
+
+        uint8_t flags = 0;
+        if (frame.Commands != mLast.Commands)
+            flags |= kCommandsChanged;
+        if (moved)
+            flags |= kMouseMoved;
+        if (FloatBits(frame.Dt) != FloatBits(mLast.Dt))
+            flags |= kDtChanged;
+
+        mStream.push_back(flags);
+        if (flags & kCommandsChanged)
+            WriteVarint(mStream, frame.Commands);
+        if (flags & kMouseMoved)
+        {
+            WriteVarint(mStream, ZigZag(frame.MouseDeltaX));
+            WriteVarint(mStream, ZigZag(frame.MouseDeltaY));
+        }
+        if (flags & kDtChanged)
+            WriteU32(mStream, FloatBits(frame.Dt));
+
+        mLast = frame;
+        mFrameCount++;
+    }
+
+    void InputRecorder::Serialize(std::vector<uint8_t>& out_data) const
+    {
+        out_data.clear();
+        out_data.reserve(kHeaderBytes + mStream.size());
+        out_data.insert(out_data.end(), kMagic, kMagic + sizeof(kMagic));
+        WriteU32(out_data, kVersion);   // And the reserved half after it
+        WriteU32(out_data, mFrameCount);
+        WriteU32(out_data, (uint32_t)mStream.size());
+        out_data.insert(out_data.end(), mStream.begin(), mStream.end());
+    }
+
+    bool InputRecorder::Save(const char* path) const
+    {
+        std::vector<uint8_t> data;
+        Serialize(data);
+
+        FILE* file = fopen(path, "wb");
+        if (!file)
+            return false;
+
+        fwrite(data.data(), 1, data.size(), file);
+        const bool ok = !ferror(file);
+        fclose(file);
+        return ok;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // InputReplay
+
+    InputReplay::InputReplay() :
+        mStream(),
+        mCursor(0),
+        mLast(),
+        mFrameCount(0),
+        mFramesPlayed(0)
+    {
+    }
+
+    bool InputReplay::Load(const char* path)
+    {
+        FILE* file = fopen(path, "rb");
+        if (!file)
+            return false;
+
+        std::vector<uint8_t> data;
+        uint8_t chunk[4096];
+        size_t read;
+        while ((read = fread(chunk, 1, sizeof(chunk), file)) != 0)
+            data.insert(data.end(), chunk, chunk + read);
+
+        const bool ok = !ferror(file);
+        fclose(file);
+        return ok && Load(data.data(), data.size());
+    }
+
+    bool InputReplay::Load(const uint8_t* pData, size_t size)
+    {
+        mStream.clear();
+        mFrameCount = 0;
+        Rewind();
+
+        if (size < kHeaderBytes || memcmp(pData, kMagic, sizeof(kMagic)) || (ReadU32(pData + 4) & 0xffff) != kVersion)
+            return false;
+
+        const uint32_t frameCount = ReadU32(pData + 8);
+        const uint32_t streamBytes = ReadU32(pData + 12);
+        if (size - kHeaderBytes != streamBytes)
+            return false;
+
+        // Every frame has to decode and the last has to end the stream
+        const uint8_t* pStream = pData + kHeaderBytes;
+        size_t cursor = 0;
+        InputFrame frame = {};
+        for (uint32_t i = 0; i != frameCount; ++i)
+        {
+            if (!DecodeFrame(pStream, streamBytes, cursor, frame))
+                return false;
+        }
+        if (cursor != streamBytes)
+            return false;
+
+        mStream.assign(pStream, pStream + streamBytes);
+        mFrameCount = frameCount;
+        return true;
+    }
+
+    bool InputReplay::Next(InputFrame& out_frame)
+    {
+        if (IsFinished())
+            return false;
+
+        // Load already checked the stream, so this can't run off it
+        DecodeFrame(mStream.data(), mStream.size(), mCursor, mLast);
+        mFramesPlayed++;
+        out_frame = mLast;
+        return true;
+    }
+
+    void InputReplay::Rewind()
+    {
+        mCursor = 0;
+        mLast = InputFrame();
+        mFramesPlayed = 0;
+    }
+}
@@ -0,0 +1,77 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Recording and replay of the input a game acted on
+A recording is the commands that were active each frame, how far the mouse
+moved and the frame's dt, so replaying it moves a camera exactly as the
+session did. Each frame only stores what changed since the one before,
+which makes an idle frame a single byte.
+----------------------------------------------*/
+#ifndef INPUTRECORDING_H
+#define INPUTRECORDING_H
+
+#include "GameCommands.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace Input {
+
+    // What a game acted on in one frame
+    struct InputFrame
+    {
+        uint32_t Commands;      // CommandBit of every active command
+        int16_t  MouseDeltaX;
+        int16_t  MouseDeltaY;
+        float    Dt;            // Seconds the frame's movement was scaled by
+    };
+
+    class InputRecorder
+    {
+    public:
+        InputRecorder();
+
+        void Reset();
+        void Record(InputFrame const& frame);
+
+        uint32_t GetFrameCount() const { return mFrameCount; }
+
+        // The whole recording, header and all, as it would be saved
+        void Serialize(std::vector<uint8_t>& out_data) const;
+
+        // False if the file couldn't be written
+        bool Save(const char* path) const;
+
+    private:
+        std::vector<uint8_t> mStream;
+        InputFrame           mLast;
+        uint32_t             mFrameCount;
+    };
+
+    class InputReplay
+    {
+    public:
+        InputReplay();
+
+        // Checks every frame decodes before taking the recording. False, and left empty, if one doesn't.
+        bool Load(const char* path);
+        bool Load(const uint8_t* pData, size_t size);
+
+        // The next recorded frame. False once they've all been played.
+        bool Next(InputFrame& out_frame);
+        void Rewind();
+
+        uint32_t GetFrameCount() const  { return mFrameCount; }
+        uint32_t GetFramesPlayed() const { return mFramesPlayed; }
+        bool     IsFinished() const     { return mFramesPlayed == mFrameCount; }
+
+    private:
+        std::vector<uint8_t> mStream;
+        size_t               mCursor;
+        InputFrame           mLast;
+        uint32_t             mFrameCount;
+        uint32_t             mFramesPlayed;
+    };
+}
+#endif
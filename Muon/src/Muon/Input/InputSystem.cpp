@@ -5,109 +5,150 @@ Description : InputSystem method definitions
 ----------------------------------------------*/
 #include "InputSystem.h"
 
+#include <algorithm>
+
 namespace Input {
 
     // Init all keyboard states to 0
-    InputSystem::InputSystem()
+    InputSystem::InputSystem() :
+        mDroppedEvents(0),
+        mActiveCommands(0),
+        mReplayMouseDelta(0.0f, 0.0f),
+        mpRecorder(nullptr),
+        mpReplay(nullptr)
     {
-        mKeyboardCurrent.fill(0);
-        mKeyboardPrevious.fill(0);
-        mMousePrevious.x = 0;
-        mMousePrevious.y = 0;
-        mMouseCurrent.x = 0;
-        mMouseCurrent.y = 0;
+        mKeysDown.Clear();
+        mKeyboardCurrent.Clear();
+        mKeyboardPrevious.Clear();
+        mMousePrevious = { 0, 0 };
+        mMouseCurrent = { 0, 0 };
     }
 
-    // Release all dynamic memory
     InputSystem::~InputSystem()
-    {
-        // Release keyMap and clear
-        for (auto pair : mKeyMap)
-            delete pair.second;
-        mKeyMap.clear();
+    {}
 
-        // No need to delete dynamic memory from activeKeyMap, it's already deleted in keymap*
-        mActiveKeyMap.clear();
+    void InputSystem::Bind(GameCommands command, Chord const& chord)
+    {
+        mKeyMap[(size_t)command] = chord;
+        mMatcher.Bind(command, chord);
     }
 
-    // Stores previous/current keymappings (from windows)
-    // Updates active keymap by comparing all chords 
+    // Applies every event queued since the last call
+    // Shifts the keyboard state into 'previous' and rematches the chords
     // Updates mouse mapping
     void InputSystem::GetInput()
     {
-        // Get the keyboard state from windows
-        GetKeyboardState();
+        mKeyboardPrevious = mKeyboardCurrent;
+        mMousePrevious = mMouseCurrent;
 
-        // Update active/non-active keymaps
-        update();
+        const KeyBits pressed = DrainEvents();
+        for (uint32_t i = 0; i != 4; ++i)
+            mKeyboardCurrent.Words[i] = mKeysDown.Words[i] | pressed.Words[i];
 
-        // Update mouse state
-        mMousePrevious = mMouseCurrent;
+        mActiveCommands = mMatcher.Update(mKeyboardPrevious, mKeyboardCurrent);
+    }
+
+    KeyBits InputSystem::DrainEvents()
+    {
+        KeyBits pressed;
+        pressed.Clear();
+
+        InputEvent event;
+        while (mEvents.Pop(event))
+        {
+            switch (event.Type)
+            {
+            case InputEventType::KeyDown:
+                mKeysDown.Set(event.KeyCode);
+                pressed.Set(event.KeyCode);
+                break;
+            case InputEventType::KeyUp:
+                mKeysDown.Reset(event.KeyCode);
+                break;
+            case InputEventType::MouseMove:
+                mMouseCurrent = { event.X, event.Y };
+                break;
+            case InputEventType::ReleaseAll:
+                // Including keys pressed earlier in the frame, nothing after losing focus should count
+                mKeysDown.Clear();
+                pressed.Clear();
+                break;
+            }
+        }
+        return pressed;
+    }
+
+    bool InputSystem::QueueEvent(InputEvent const& event)
+    {
+        if (mEvents.Push(event))
+            return true;
+
+        mDroppedEvents.fetch_add(1, std::memory_order_relaxed);
+        return false;
     }
 
-    void InputSystem::OnMouseMove(short newX, short newY)
+    bool InputSystem::OnKeyDown(uint8_t keyCode)
     {
-        mMouseCurrent = { newX, newY };
+        return QueueEvent({ InputEventType::KeyDown, keyCode, 0, 0 });
+    }
+
+    bool InputSystem::OnKeyUp(uint8_t keyCode)
+    {
+        return QueueEvent({ InputEventType::KeyUp, keyCode, 0, 0 });
+    }
+
+    bool InputSystem::OnMouseMove(short newX, short newY)
+    {
+        return QueueEvent({ InputEventType::MouseMove, 0, newX, newY });
+    }
+
+    bool InputSystem::OnFocusLost()
+    {
+        return QueueEvent({ InputEventType::ReleaseAll, 0, 0, 0 });
     }
 
     std::pair<float,float> InputSystem::GetMouseDelta() const
     {
+        if (mpReplay)
+            return mReplayMouseDelta;
+
         std::pair<float, float> pt;
-        
+
         pt.first  = static_cast<float>(mMouseCurrent.x - mMousePrevious.x);
         pt.second = static_cast<float>(mMouseCurrent.y - mMousePrevious.y);
         return pt;
     }
 
-    // Clears active key map, then fills it with all values from m_keyMap with a 'fulfilled' chord
-    void InputSystem::update()
+    float InputSystem::BeginFrame(float dt)
     {
-        // Reset active key map
-        mActiveKeyMap.clear();
-
-        // Map which keys are active into the active key map
-        for (auto key : mKeyMap)
+        if (mpReplay)
         {
-            bool activeKey = true;
-
-            // Test Chord
-            for (Binding binding : key.second->GetChord())
+            InputFrame frame;
+            if (mpReplay->Next(frame))
             {
-                if (GetKeyboardKeyState(binding.mKeyCode) != binding.mKeyState)
-                {
-                    activeKey = false;
-                    break;
-                }
+                // As if the recorded commands' chords had been met
+                mActiveCommands = frame.Commands;
+                mReplayMouseDelta = { (float)frame.MouseDeltaX, (float)frame.MouseDeltaY };
+                return frame.Dt;
             }
 
-            // Passed Chord Check : move key to active key map
-            if (activeKey)
-                mActiveKeyMap.insert(key);
+            // Played out, back to live input from here
+            mpReplay = nullptr;
+            mActiveCommands = mMatcher.GetActiveCommands();
         }
-    }
-
-    // Stores the current state of the keyboard as 'previous'
-    // then reads in new 'current values from windows
-    void InputSystem::GetKeyboardState()
-    {
-        mKeyboardPrevious = mKeyboardCurrent;
 
-        for (int i = 0; i < 256; i++)
-            mKeyboardCurrent[i] = isPressed(i);
-    }
+        if (mpRecorder)
+        {
+            InputFrame frame = {};
+            frame.Commands = mActiveCommands;
+
+            const std::pair<float, float> delta = GetMouseDelta();
+            frame.MouseDeltaX = (int16_t)std::max(-32768.0f, std::min(delta.first, 32767.0f));
+            frame.MouseDeltaY = (int16_t)std::max(-32768.0f, std::min(delta.second, 32767.0f));
+            frame.Dt = dt;
+            mpRecorder->Record(frame);
+        }
 
-    // Use logic to deduce Keystate from current and previous keyboard states
-    const KeyState InputSystem::GetKeyboardKeyState(const unsigned int keyCode) const
-    {
-        if (mKeyboardPrevious[keyCode] == 1)
-            if (mKeyboardCurrent[keyCode] == 1)
-                return KeyState::StillPressed;  // true, true
-            else
-                return KeyState::JustReleased;  // true, false
-        else
-            if (mKeyboardCurrent[keyCode] == 1)
-                return KeyState::JustPressed;   // false, true
-            else
-                return KeyState::StillReleased; // false, false
+        return dt;
     }
-}
\ No newline at end of file
+}
@@ -2,44 +2,84 @@
 Ruben Young (rubenaryo@gmail.com)
 Date : 2019/10
 Description : Interface for the InputSystem class
+The window's message handler queues key and mouse events as they arrive,
+and GetInput applies everything queued since the last call and rematches
+the chords whose keys changed. Nothing here touches the OS, so the whole
+pipeline runs anywhere events can be fed to it.
 ----------------------------------------------*/
 #ifndef INPUTSYSTEM_H
 #define INPUTSYSTEM_H
 
-#include <Muon/Core/WinApp.h>
+#include <Muon/Core/SPSCQueue.h>
 #include <array>
-#include <unordered_map>
+#include <atomic>
+#include <utility>
+#include "ChordMatcher.h"
 #include "InputBinding.h"
+#include "InputRecording.h"
 
 namespace Input {
-    
+
+    enum class InputEventType : uint8_t
+    {
+        KeyDown,
+        KeyUp,
+        MouseMove,
+        ReleaseAll
+    };
+
+    struct InputEvent
+    {
+        InputEventType Type;
+        uint8_t        KeyCode;
+        int16_t        X;
+        int16_t        Y;
+    };
+
+    struct MousePosition
+    {
+        int32_t x;
+        int32_t y;
+    };
+
     class InputSystem
     {
     private:
+        // Comfortably more than a frame's worth, even with the mouse flying
+        static const uint32_t kEventQueueSize = 1024;
+
+        // Filled by the message handler, drained by GetInput
+        Core::SPSCQueue<InputEvent, kEventQueueSize> mEvents;
+        std::atomic<uint32_t> mDroppedEvents;   // Counted by the producer
+
         // Keyboard States
-        std::array<BYTE, 256> mKeyboardCurrent;
-        std::array<BYTE, 256> mKeyboardPrevious;
+        KeyBits mKeysDown;          // As of the last event applied
+        KeyBits mKeyboardCurrent;   // Down, or pressed at some point since the last GetInput, so a tap is never missed
+        KeyBits mKeyboardPrevious;
+
+        ChordMatcher mMatcher;
+        uint32_t     mActiveCommands;
 
         // Mouse States
-        POINT mMouseCurrent;
-        POINT mMousePrevious;
+        MousePosition mMouseCurrent;
+        MousePosition mMousePrevious;
 
-        // Uses GetAsyncKeyState to read in 256 bytes
-        void GetKeyboardState();
+        // Applies every queued event, returning the keys pressed along the way
+        KeyBits DrainEvents();
 
-        // returns the state of the key in enum form
-        const KeyState GetKeyboardKeyState(const unsigned int keyCode) const;
+        bool QueueEvent(InputEvent const& event);
 
-        // returns true if the key is down
-        inline const bool isPressed(int keyCode) const
-        {
-            return (GetAsyncKeyState(keyCode) & 0x8000) ? 1 : 0;
-        }
+        // Set while replaying, in place of the live mouse
+        std::pair<float, float> mReplayMouseDelta;
 
-        void update();
+        InputRecorder* mpRecorder;
+        InputReplay*   mpReplay;
 
     protected:
-        std::unordered_map<GameCommands, Chord*> mKeyMap;
+        // Every command's chord, kept for its name. Only Bind changes what's matched.
+        std::array<Chord, (size_t)GameCommands::COUNT> mKeyMap;
+
+        void Bind(GameCommands command, Chord const& chord);
 
         virtual void SetDefaultKeyMap() = 0;
 
@@ -47,20 +87,45 @@ namespace Input {
         InputSystem();
         virtual ~InputSystem();
 
-        std::unordered_map<GameCommands, Chord*> mActiveKeyMap;
-
-        // Main "Update method" for input system
+        // Main "Update method" for input system. Call it as late as possible before acting on the
+        // commands, so they're as fresh as they can be.
         void GetInput();
 
-        // On WM_MOUSEMOVE message, trigger this method
-        void OnMouseMove(short newX, short newY);
+        // From the message handler. Lock free, so it can be on another thread than GetInput. Each
+        // returns false if the queue was full and the event dropped.
+        bool OnKeyDown(uint8_t keyCode);
+        bool OnKeyUp(uint8_t keyCode);
+        bool OnMouseMove(short newX, short newY);
+
+        // Lets go of every key, for when focus moves away and the releases go with it
+        bool OnFocusLost();
+
+        uint32_t GetDroppedEvents() const { return mDroppedEvents.load(std::memory_order_relaxed); }
 
-        // Returns the current mouse position as a POINT
-        POINT GetMousePosition() const { return mMouseCurrent; }
+        // The CommandBit of every command whose chord was met at the last GetInput
+        uint32_t GetActiveCommands() const { return mActiveCommands; }
+        bool     IsActive(GameCommands command) const { return (mActiveCommands & CommandBit(command)) != 0; }
+
+        // Returns the mouse position as of the last GetInput
+        MousePosition GetMousePosition() const { return mMouseCurrent; }
 
         // Returns the difference between current and previous as a std::pair
         std::pair<float, float> GetMouseDelta() const;
 
+        // Logs every frame's active commands, mouse delta and dt from the next BeginFrame on. Null stops.
+        void SetRecorder(InputRecorder* pRecorder) { mpRecorder = pRecorder; }
+
+        // Acts out a recording in place of the live input until it runs out, then goes back to live. Null stops.
+        void SetReplay(InputReplay* pReplay) { mpReplay = pReplay; }
+        bool IsReplaying() const { return mpReplay != nullptr; }
+
+        // Call before acting on the active commands. Records them, or swaps in the next replayed frame, and
+        // returns the dt to act with: the recorded one when replaying, otherwise the one given.
+        float BeginFrame(float dt);
+
+    public:
+        InputSystem(InputSystem const&)            = delete;
+        InputSystem& operator=(InputSystem const&) = delete;
     };
 }
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,472 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of Allocators.h
+----------------------------------------------*/
+#include "Allocators.h"
+
+#include <assert.h>
+#include <atomic>
+#include <new>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(MN_PLATFORM_WINDOWS)
+#include <Muon/Core/WinApp.h>
+#endif
+
+namespace Memory {
+
+namespace {
+
+struct AtomicTagStats
+{
+    std::atomic<size_t>   CurrentBytes;
+    std::atomic<size_t>   HighWaterBytes;
+    std::atomic<uint32_t> LiveAllocations;
+    std::atomic<uint32_t> TotalAllocations;
+};
+
+AtomicTagStats gTagStats[(uint8_t)MemoryTag::COUNT];
+
+const char* kTagNames[(uint8_t)MemoryTag::COUNT] =
+{
+    "General",
+    "Shaders",
+    "Meshes",
+    "Textures",
+    "Entities",
+    "Frame",
+    "Scratch"
+};
+
+// Layout of a guarded allocation: [AllocHeader][user bytes][kGuardBytes of kGuardFill]
+struct AllocHeader
+{
+    uint64_t Magic;
+    uint64_t ByteSize;     // As wide as the size_t it was asked for, so no request gets truncated
+    uint64_t PrevHeader;
+};
+
+const uint64_t kHeaderMagic = 0x4D4E4D48; // "MNMH"
+const size_t   kGuardBytes  = 16;
+const uint8_t  kGuardFill   = 0xFD;
+const uint8_t  kFreedFill   = 0xDD;
+
+const size_t kHeaderBytes = MN_MEMORY_GUARDS ? sizeof(AllocHeader) : 0;
+const size_t kTailBytes   = MN_MEMORY_GUARDS ? kGuardBytes : 0;
+
+inline size_t AlignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+inline bool IsGuardIntact(const uint8_t* guard, uint8_t fill)
+{
+    for (size_t i = 0; i != kGuardBytes; ++i)
+        if (guard[i] != fill)
+            return false;
+
+    return true;
+}
+
+void TrackAlloc(MemoryTag tag, size_t byteSize, uint32_t count)
+{
+    AtomicTagStats& stats = gTagStats[(uint8_t)tag];
+    const size_t current = stats.CurrentBytes.fetch_add(byteSize) + byteSize;
+    stats.LiveAllocations.fetch_add(count);
+    stats.TotalAllocations.fetch_add(count);
+
+    size_t highWater = stats.HighWaterBytes.load();
+    while (current > highWater && !stats.HighWaterBytes.compare_exchange_weak(highWater, current))
+    {}
+}
+
+void TrackFree(MemoryTag tag, size_t byteSize, uint32_t count)
+{
+    AtomicTagStats& stats = gTagStats[(uint8_t)tag];
+    stats.CurrentBytes.fetch_sub(byteSize);
+    stats.LiveAllocations.fetch_sub(count);
+}
+
+void Log(const char* str)
+{
+#if defined(MN_PLATFORM_WINDOWS)
+    OutputDebugStringA(str);
+#else
+    fputs(str, stderr);
+#endif
+}
+
+std::atomic<uint32_t> gCorruptionCount(0);
+std::atomic<bool>     gAssertOnCorruption(true);
+
+#if MN_MEMORY_GUARDS
+void ReportCorruption(const char* str)
+{
+    Log(str);
+    gCorruptionCount.fetch_add(1);
+    assert(!gAssertOnCorruption.load() && "Memory corruption detected");
+}
+#endif
+
+LinearArena gFrameArenas[2];
+LinearArena gScratchArena;
+uint32_t    gFrameIndex = 0;
+
+}
+
+const char* GetTagName(MemoryTag tag)
+{
+    return kTagNames[(uint8_t)tag];
+}
+
+TagStats GetTagStats(MemoryTag tag)
+{
+    const AtomicTagStats& stats = gTagStats[(uint8_t)tag];
+
+    TagStats out;
+    out.CurrentBytes     = stats.CurrentBytes.load();
+    out.HighWaterBytes   = stats.HighWaterBytes.load();
+    out.LiveAllocations  = stats.LiveAllocations.load();
+    out.TotalAllocations = stats.TotalAllocations.load();
+    return out;
+}
+
+uint32_t ReportLeaks()
+{
+    uint32_t leakingTags = 0;
+    char buf[256];
+
+    for (uint8_t t = 0; t != (uint8_t)MemoryTag::COUNT; ++t)
+    {
+        TagStats stats = GetTagStats((MemoryTag)t);
+        if (stats.LiveAllocations == 0)
+            continue;
+
+        snprintf(buf, sizeof(buf), "MEMORY LEAK: [%s] %u live allocations, %zu bytes (high water %zu bytes)\n",
+            kTagNames[t], stats.LiveAllocations, stats.CurrentBytes, stats.HighWaterBytes);
+        Log(buf);
+        ++leakingTags;
+    }
+
+    return leakingTags;
+}
+
+uint32_t GetCorruptionCount()
+{
+    return gCorruptionCount.load();
+}
+
+void SetAssertOnCorruption(bool enabled)
+{
+    gAssertOnCorruption.store(enabled);
+}
+
+/////////////////////////////////////////////////////////////////////
+// LinearArena
+
+LinearArena::LinearArena() :
+    mBase(nullptr),
+    mCapacity(0),
+    mOffset(0),
+    mHighWater(0),
+    mLastHeader(0),
+    mAllocCount(0),
+    mTag(MemoryTag::GENERAL)
+{}
+
+LinearArena::~LinearArena()
+{
+    Destroy();
+}
+
+void LinearArena::Init(size_t capacity, MemoryTag tag)
+{
+    assert(!mBase && "LinearArena initialized twice");
+
+    mBase       = static_cast<uint8_t*>(::operator new(capacity, std::align_val_t(64)));
+    mCapacity   = capacity;
+    mOffset     = 0;
+    mHighWater  = 0;
+    mLastHeader = 0;
+    mAllocCount = 0;
+    mTag        = tag;
+}
+
+void LinearArena::Destroy()
+{
+    if (!mBase)
+        return;
+
+    Reset();
+    ::operator delete(mBase, std::align_val_t(64));
+    mBase     = nullptr;
+    mCapacity = 0;
+}
+
+void* LinearArena::Alloc(size_t byteSize, size_t alignment)
+{
+    assert(mBase && "Allocating from an uninitialized LinearArena");
+    assert((alignment & (alignment - 1)) == 0);
+
+#if MN_MEMORY_GUARDS
+    if (alignment < alignof(AllocHeader))
+        alignment = alignof(AllocHeader);
+#endif
+
+    const uintptr_t base = reinterpret_cast<uintptr_t>(mBase);
+    const size_t userOffset = AlignUp(base + mOffset + kHeaderBytes, alignment) - base;
+
+    // Checked before adding it on, since a size near SIZE_MAX would wrap past the capacity check
+    if (byteSize > mCapacity || userOffset + byteSize + kTailBytes > mCapacity)
+    {
+        char buf[128];
+        snprintf(buf, sizeof(buf), "ERROR: [%s] LinearArena exhausted (%zu/%zu bytes, requested %zu)\n", kTagNames[(uint8_t)mTag], mOffset, mCapacity, byteSize);
+        Log(buf);
+        assert(false);
+        return nullptr;
+    }
+
+    const size_t end = userOffset + byteSize + kTailBytes;
+
+#if MN_MEMORY_GUARDS
+    const size_t headerOffset = userOffset - kHeaderBytes;
+    AllocHeader* pHeader = reinterpret_cast<AllocHeader*>(mBase + headerOffset);
+    pHeader->Magic      = kHeaderMagic;
+    pHeader->ByteSize   = byteSize;
+    pHeader->PrevHeader = mLastHeader;
+    memset(mBase + userOffset + byteSize, kGuardFill, kGuardBytes);
+    mLastHeader = headerOffset + 1;
+#endif
+
+    TrackAlloc(mTag, end - mOffset, 1);
+
+    mOffset = end;
+    mAllocCount++;
+    if (mOffset > mHighWater)
+        mHighWater = mOffset;
+
+    return mBase + userOffset;
+}
+
+void LinearArena::RewindTo(Marker marker)
+{
+    assert(marker.Offset <= mOffset && marker.AllocCount <= mAllocCount);
+
+#if MN_MEMORY_GUARDS
+    if (!CheckGuards())
+        ReportCorruption("ERROR: LinearArena overrun detected on rewind\n");
+
+    // Poison what we hand back so stale pointers are obvious in the debugger
+    memset(mBase + marker.Offset, kFreedFill, mOffset - marker.Offset);
+#endif
+
+    TrackFree(mTag, mOffset - marker.Offset, mAllocCount - marker.AllocCount);
+
+    mOffset     = marker.Offset;
+    mLastHeader = marker.LastHeader;
+    mAllocCount = marker.AllocCount;
+}
+
+void LinearArena::Reset()
+{
+    RewindTo({ 0, 0, 0 });
+}
+
+bool LinearArena::CheckGuards() const
+{
+#if MN_MEMORY_GUARDS
+    size_t header = mLastHeader;
+    while (header != 0)
+    {
+        const AllocHeader* pHeader = reinterpret_cast<const AllocHeader*>(mBase + header - 1);
+        if (pHeader->Magic != kHeaderMagic)
+            return false;
+
+        const uint8_t* guard = reinterpret_cast<const uint8_t*>(pHeader + 1) + pHeader->ByteSize;
+        if (!IsGuardIntact(guard, kGuardFill))
+            return false;
+
+        header = (size_t)pHeader->PrevHeader;
+    }
+#endif
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+// PoolAllocator
+
+PoolAllocator::PoolAllocator() :
+    mBase(nullptr),
+    mFreeList(nullptr),
+    mElementSize(0),
+    mPayload(0),
+    mStride(0),
+    mElementCount(0),
+    mLiveCount(0),
+    mHighWater(0),
+    mTag(MemoryTag::GENERAL)
+{}
+
+PoolAllocator::~PoolAllocator()
+{
+    Destroy();
+}
+
+void PoolAllocator::Init(size_t elementSize, uint32_t elementCount, MemoryTag tag, size_t alignment)
+{
+    assert(!mBase && "PoolAllocator initialized twice");
+    assert((alignment & (alignment - 1)) == 0);
+
+    mElementSize  = elementSize;
+    mPayload      = elementSize > sizeof(void*) ? elementSize : sizeof(void*);
+    mStride       = AlignUp(mPayload + kTailBytes, alignment);
+    mElementCount = elementCount;
+    mLiveCount    = 0;
+    mHighWater    = 0;
+    mTag          = tag;
+
+    assert(alignment <= 64 && "PoolAllocator blocks are only cache line aligned");
+    mBase = static_cast<uint8_t*>(::operator new(mStride * elementCount, std::align_val_t(64)));
+
+    // Thread the free list front to back so allocations come out in address order
+    mFreeList = nullptr;
+    for (uint32_t i = elementCount; i != 0; --i)
+    {
+        uint8_t* block = mBase + (size_t)(i - 1) * mStride;
+        *reinterpret_cast<void**>(block) = mFreeList;
+        mFreeList = block;
+
+    #if MN_MEMORY_GUARDS
+        memset(block + mPayload, kFreedFill, kGuardBytes);
+    #endif
+    }
+}
+
+void PoolAllocator::Destroy()
+{
+    if (!mBase)
+        return;
+
+    if (mLiveCount)
+    {
+        char buf[128];
+        snprintf(buf, sizeof(buf), "MEMORY LEAK: [%s] PoolAllocator destroyed with %u live blocks\n", kTagNames[(uint8_t)mTag], mLiveCount);
+        Log(buf);
+        TrackFree(mTag, mStride * mLiveCount, mLiveCount);
+    }
+
+    ::operator delete(mBase, std::align_val_t(64));
+    mBase      = nullptr;
+    mFreeList  = nullptr;
+    mLiveCount = 0;
+}
+
+void* PoolAllocator::Alloc()
+{
+    assert(mBase && "Allocating from an uninitialized PoolAllocator");
+
+    if (!mFreeList)
+        return nullptr;
+
+    uint8_t* block = static_cast<uint8_t*>(mFreeList);
+    mFreeList = *reinterpret_cast<void**>(block);
+
+#if MN_MEMORY_GUARDS
+    if (!IsGuardIntact(block + mPayload, kFreedFill))
+        ReportCorruption("ERROR: PoolAllocator free block was written to\n");
+    memset(block + mPayload, kGuardFill, kGuardBytes);
+#endif
+
+    TrackAlloc(mTag, mStride, 1);
+
+    if (++mLiveCount > mHighWater)
+        mHighWater = mLiveCount;
+
+    return block;
+}
+
+void PoolAllocator::Free(void* ptr)
+{
+    if (!ptr)
+        return;
+
+    uint8_t* block = static_cast<uint8_t*>(ptr);
+    assert(block >= mBase && block < mBase + mStride * mElementCount && "Pointer does not belong to this pool");
+    assert((size_t)(block - mBase) % mStride == 0 && "Pointer is not the start of a pool block");
+
+#if MN_MEMORY_GUARDS
+    // A freed block carries kFreedFill in its guard. Threading it onto the free list twice would hand it out twice.
+    if (IsGuardIntact(block + mPayload, kFreedFill))
+    {
+        ReportCorruption("ERROR: PoolAllocator double free detected\n");
+        return;
+    }
+    if (!IsGuardIntact(block + mPayload, kGuardFill))
+        ReportCorruption("ERROR: PoolAllocator overrun detected\n");
+
+    memset(block, kFreedFill, mPayload);
+    memset(block + mPayload, kFreedFill, kGuardBytes);
+#endif
+
+    *reinterpret_cast<void**>(block) = mFreeList;
+    mFreeList = block;
+
+    TrackFree(mTag, mStride, 1);
+    --mLiveCount;
+}
+
+bool PoolAllocator::CheckGuards() const
+{
+#if MN_MEMORY_GUARDS
+    for (uint32_t i = 0; i != mElementCount; ++i)
+    {
+        const uint8_t* guard = mBase + (size_t)i * mStride + mPayload;
+        if (!IsGuardIntact(guard, kGuardFill) && !IsGuardIntact(guard, kFreedFill))
+            return false;
+    }
+#endif
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+// Engine-wide arenas
+
+void Init(size_t frameArenaSize, size_t scratchArenaSize)
+{
+    gFrameArenas[0].Init(frameArenaSize, MemoryTag::FRAME);
+    gFrameArenas[1].Init(frameArenaSize, MemoryTag::FRAME);
+    gScratchArena.Init(scratchArenaSize, MemoryTag::SCRATCH);
+    gFrameIndex = 0;
+}
+
+void Shutdown()
+{
+    gFrameArenas[0].Destroy();
+    gFrameArenas[1].Destroy();
+    gScratchArena.Destroy();
+
+    ReportLeaks();
+}
+
+void BeginFrame()
+{
+    gFrameIndex ^= 1;
+    gFrameArenas[gFrameIndex].Reset();
+
+    // Scratch allocations never outlive the scope that made them
+    assert(gScratchArena.GetAllocCount() == 0 && "Scratch allocation leaked across a frame");
+}
+
+LinearArena& GetFrameArena()
+{
+    return gFrameArenas[gFrameIndex];
+}
+
+LinearArena& GetScratchArena()
+{
+    return gScratchArena;
+}
+
+}
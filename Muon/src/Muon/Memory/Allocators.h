@@ -0,0 +1,182 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Tagged linear arenas, scoped scratch stacks and fixed-size pools
+----------------------------------------------*/
+#ifndef MUON_ALLOCATORS_H
+#define MUON_ALLOCATORS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Memory {
+
+// Every allocator reports its usage under one of these, so we can see who owns what at shutdown
+enum class MemoryTag : uint8_t
+{
+    GENERAL,
+    SHADERS,
+    MESHES,
+    TEXTURES,
+    ENTITIES,
+    FRAME,
+    SCRATCH,
+    COUNT
+};
+
+struct TagStats
+{
+    size_t   CurrentBytes;
+    size_t   HighWaterBytes;
+    uint32_t LiveAllocations;
+    uint32_t TotalAllocations;
+};
+
+static const size_t kDefaultAlignment = 16;
+
+// Debug builds pad every allocation with guard bytes that are validated on rewind/free
+#if defined(MN_DEBUG)
+    #define MN_MEMORY_GUARDS 1
+#else
+    #define MN_MEMORY_GUARDS 0
+#endif
+
+const char* GetTagName(MemoryTag tag);
+TagStats    GetTagStats(MemoryTag tag);
+
+// Returns the number of tags that still hold live allocations, printing each one.
+uint32_t ReportLeaks();
+
+// Every overrun, double free or write to a freed block the guards catch is logged and counted. They also
+// assert unless that's turned off, which is only for provoking them on purpose.
+uint32_t GetCorruptionCount();
+void     SetAssertOnCorruption(bool enabled);
+
+// Bump allocator over one contiguous block. Not thread safe: one arena per thread.
+class LinearArena
+{
+public:
+    struct Marker
+    {
+        size_t   Offset;
+        size_t   LastHeader;
+        uint32_t AllocCount;
+    };
+
+    LinearArena();
+    ~LinearArena();
+
+    void Init(size_t capacity, MemoryTag tag);
+    void Destroy();
+
+    // Returns nullptr (and asserts) when the arena is exhausted
+    void* Alloc(size_t byteSize, size_t alignment = kDefaultAlignment);
+
+    template <typename T>
+    T* AllocArray(size_t count) { return static_cast<T*>(Alloc(sizeof(T) * count, alignof(T) > kDefaultAlignment ? alignof(T) : kDefaultAlignment)); }
+
+    Marker GetMarker() const { return { mOffset, mLastHeader, mAllocCount }; }
+    void   RewindTo(Marker marker);
+    void   Reset();
+
+    // Walks every live allocation and validates its guard bytes. Always true without MN_MEMORY_GUARDS.
+    bool CheckGuards() const;
+
+    size_t    GetUsed()       const { return mOffset;     }
+    size_t    GetCapacity()   const { return mCapacity;   }
+    size_t    GetHighWater()  const { return mHighWater;  }
+    uint32_t  GetAllocCount() const { return mAllocCount; }
+    MemoryTag GetTag()        const { return mTag;        }
+    bool      IsInitialized() const { return mBase != nullptr; }
+
+private:
+    uint8_t*  mBase;
+    size_t    mCapacity;
+    size_t    mOffset;
+    size_t    mHighWater;
+    size_t    mLastHeader; // 1 + offset of the newest allocation header, 0 when empty
+    uint32_t  mAllocCount;
+    MemoryTag mTag;
+
+public:
+    LinearArena(LinearArena const&)            = delete;
+    LinearArena& operator=(LinearArena const&) = delete;
+};
+
+// Restores the arena to its state at construction when it leaves scope
+class ScratchScope
+{
+public:
+    explicit ScratchScope(LinearArena& arena) :
+        mArena(arena),
+        mMarker(arena.GetMarker())
+    {}
+
+    ~ScratchScope() { mArena.RewindTo(mMarker); }
+
+    void* Alloc(size_t byteSize, size_t alignment = kDefaultAlignment) { return mArena.Alloc(byteSize, alignment); }
+
+    template <typename T>
+    T* AllocArray(size_t count) { return mArena.AllocArray<T>(count); }
+
+private:
+    LinearArena&        mArena;
+    LinearArena::Marker mMarker;
+
+public:
+    ScratchScope(ScratchScope const&)            = delete;
+    ScratchScope& operator=(ScratchScope const&) = delete;
+};
+
+// Fixed-size blocks threaded through an intrusive free list. Not thread safe.
+class PoolAllocator
+{
+public:
+    PoolAllocator();
+    ~PoolAllocator();
+
+    void Init(size_t elementSize, uint32_t elementCount, MemoryTag tag, size_t alignment = kDefaultAlignment);
+    void Destroy();
+
+    // Returns nullptr when every block is in use
+    void* Alloc();
+
+    // With MN_MEMORY_GUARDS, a block that's already free is reported and left alone
+    void  Free(void* ptr);
+
+    bool CheckGuards() const;
+
+    uint32_t  GetLiveCount()    const { return mLiveCount;    }
+    uint32_t  GetHighWater()    const { return mHighWater;    }
+    uint32_t  GetElementCount() const { return mElementCount; }
+    size_t    GetElementSize()  const { return mElementSize;  }
+    MemoryTag GetTag()          const { return mTag;          }
+
+private:
+    uint8_t*  mBase;
+    void*     mFreeList;
+    size_t    mElementSize;
+    size_t    mPayload;     // Element size, but at least room for the free list's next pointer
+    size_t    mStride;
+    uint32_t  mElementCount;
+    uint32_t  mLiveCount;
+    uint32_t  mHighWater;
+    MemoryTag mTag;
+
+public:
+    PoolAllocator(PoolAllocator const&)            = delete;
+    PoolAllocator& operator=(PoolAllocator const&) = delete;
+};
+
+// Engine-wide arenas. The frame arena is double buffered so data written during frame N
+// stays valid while frame N is still in flight.
+void Init(size_t frameArenaSize = 4 << 20, size_t scratchArenaSize = 16 << 20);
+void Shutdown();
+void BeginFrame();
+
+LinearArena& GetFrameArena();
+LinearArena& GetScratchArena();
+
+}
+
+#endif
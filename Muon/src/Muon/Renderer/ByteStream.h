@@ -0,0 +1,42 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Little endian readers and writers for the small binary formats
+the tools hand to the runtime (reflection sidecars, shader archives)
+----------------------------------------------*/
+#ifndef MUON_BYTESTREAM_H
+#define MUON_BYTESTREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace Renderer {
+
+struct ByteWriter
+{
+    std::vector<uint8_t>& Bytes;
+
+    void U8(uint8_t v)   { Bytes.push_back(v); }
+    void U16(uint16_t v) { U8((uint8_t)v); U8((uint8_t)(v >> 8)); }
+    void U32(uint32_t v) { U16((uint16_t)v); U16((uint16_t)(v >> 16)); }
+    void U64(uint64_t v) { U32((uint32_t)v); U32((uint32_t)(v >> 32)); }
+};
+
+// Callers check Has() before reading; the readers themselves don't bounds check
+struct ByteReader
+{
+    const uint8_t* Data;
+    size_t         Size;
+    size_t         Offset;
+
+    bool Has(size_t n) const { return Size - Offset >= n; }
+
+    uint8_t  U8()  { return Data[Offset++]; }
+    uint16_t U16() { uint16_t lo = U8(); return (uint16_t)(lo | (U8() << 8)); }
+    uint32_t U32() { uint32_t lo = U16(); return lo | ((uint32_t)U16() << 16); }
+    uint64_t U64() { uint64_t lo = U32(); return lo | ((uint64_t)U32() << 32); }
+};
+
+}
+#endif
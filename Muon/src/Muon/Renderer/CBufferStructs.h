@@ -9,6 +9,9 @@ Description : Declation of structs used as constant buffers by various shaders
 #include <DirectXMath.h>
 #include <DirectXColors.h>
 #include "LightStructs.h"
+#include "Generated/CBufferLayouts.h"
+
+#include <stddef.h>
 
 namespace Renderer
 {
@@ -34,7 +37,77 @@ struct alignas(16) cbMaterialParams
 {
     DirectX::XMFLOAT4  colorTint = DirectX::XMFLOAT4(DirectX::Colors::Black);
     float              specularExp = 0.0f;
+
+    // Only read by the TEXTURE_ARRAY variant: where the material's textures sit in their packed pages
+    uint32_t           diffuseSlice = 0;
+    uint32_t           normalSlice = 0;
+    DirectX::XMFLOAT4A diffuseRect = DirectX::XMFLOAT4A(0.0f, 0.0f, 1.0f, 1.0f);
+    DirectX::XMFLOAT4A normalRect = DirectX::XMFLOAT4A(0.0f, 0.0f, 1.0f, 1.0f);
+};
+
+// Only read by the CLUSTERED_LIGHTS variant: how a pixel finds its cluster, see ClusteredLighting.h
+struct alignas(16) cbClusters
+{
+    DirectX::XMFLOAT3 cameraForward = DirectX::XMFLOAT3(0.0f, 0.0f, 1.0f);
+    float             sliceScale = 0.0f;
+    float             sliceBias = 0.0f;
+    DirectX::XMFLOAT2 tileScale = DirectX::XMFLOAT2(0.0f, 0.0f);
+    uint32_t          tilesX = 0;
+    uint32_t          tilesY = 0;
+    uint32_t          slices = 0;
+};
+
+// Only read by the SHADOWS variant, see CascadedShadows.h
+struct alignas(16) cbShadowCascade
+{
+    DirectX::XMFLOAT4X4 viewProjection;
+    float               texelSize = 0.0f;   // World units per texel
+    float               padding[3] = {};
 };
 
+struct alignas(16) cbShadows
+{
+    cbShadowCascade cascades[4];
+    uint32_t        cascadeCount = 0;
+    float           texelUV = 0.0f;
+    float           normalOffset = 0.0f;
+};
+
+// The hand-written structs above are what the engine fills in; these catch them drifting from the HLSL.
+// Regenerate Generated/CBufferLayouts.h with ShaderBuild -cbuffer-header after changing a cbuffer.
+static_assert(sizeof(cbCamera) == sizeof(CBufferLayout::VSPerPass), "cbCamera doesn't match VSPerPass");
+static_assert(sizeof(cbPerEntity) == sizeof(CBufferLayout::VSPerStaticEntity), "cbPerEntity doesn't match VSPerStaticEntity");
+
+static_assert(sizeof(cbLighting) == sizeof(CBufferLayout::PSPerFrame), "cbLighting doesn't match PSPerFrame");
+static_assert(offsetof(cbLighting, ambientColor) == offsetof(CBufferLayout::PSPerFrame, ambientColor), "cbLighting::ambientColor is misaligned");
+static_assert(offsetof(cbLighting, directionalLight) == offsetof(CBufferLayout::PSPerFrame, directionalLight), "cbLighting::directionalLight is misaligned");
+static_assert(offsetof(cbLighting, cameraWorldPos) == offsetof(CBufferLayout::PSPerFrame, cameraWorldPos), "cbLighting::cameraWorldPos is misaligned");
+static_assert(offsetof(DirectionalLight, diffuseColor) == offsetof(CBufferLayout::DirectionalLight, diffuseColor), "DirectionalLight::diffuseColor is misaligned");
+static_assert(offsetof(DirectionalLight, toLight) == offsetof(CBufferLayout::DirectionalLight, toLight), "DirectionalLight::toLight is misaligned");
+
+static_assert(sizeof(cbMaterialParams) == sizeof(CBufferLayout::PSPerMaterial), "cbMaterialParams doesn't match PSPerMaterial");
+static_assert(offsetof(cbMaterialParams, colorTint) == offsetof(CBufferLayout::PSPerMaterial, colorTint), "cbMaterialParams::colorTint is misaligned");
+static_assert(offsetof(cbMaterialParams, specularExp) == offsetof(CBufferLayout::PSPerMaterial, specularity), "cbMaterialParams::specularExp is misaligned");
+static_assert(offsetof(cbMaterialParams, diffuseSlice) == offsetof(CBufferLayout::PSPerMaterial, diffuseSlice), "cbMaterialParams::diffuseSlice is misaligned");
+static_assert(offsetof(cbMaterialParams, normalSlice) == offsetof(CBufferLayout::PSPerMaterial, normalSlice), "cbMaterialParams::normalSlice is misaligned");
+static_assert(offsetof(cbMaterialParams, diffuseRect) == offsetof(CBufferLayout::PSPerMaterial, diffuseRect), "cbMaterialParams::diffuseRect is misaligned");
+static_assert(offsetof(cbMaterialParams, normalRect) == offsetof(CBufferLayout::PSPerMaterial, normalRect), "cbMaterialParams::normalRect is misaligned");
+
+static_assert(sizeof(cbClusters) == sizeof(CBufferLayout::PSClusters), "cbClusters doesn't match PSClusters");
+static_assert(offsetof(cbClusters, cameraForward) == offsetof(CBufferLayout::PSClusters, cameraForward), "cbClusters::cameraForward is misaligned");
+static_assert(offsetof(cbClusters, sliceScale) == offsetof(CBufferLayout::PSClusters, sliceScale), "cbClusters::sliceScale is misaligned");
+static_assert(offsetof(cbClusters, sliceBias) == offsetof(CBufferLayout::PSClusters, sliceBias), "cbClusters::sliceBias is misaligned");
+static_assert(offsetof(cbClusters, tileScale) == offsetof(CBufferLayout::PSClusters, tileScale), "cbClusters::tileScale is misaligned");
+static_assert(offsetof(cbClusters, tilesX) == offsetof(CBufferLayout::PSClusters, clusterTilesX), "cbClusters::tilesX is misaligned");
+static_assert(offsetof(cbClusters, tilesY) == offsetof(CBufferLayout::PSClusters, clusterTilesY), "cbClusters::tilesY is misaligned");
+static_assert(offsetof(cbClusters, slices) == offsetof(CBufferLayout::PSClusters, clusterSlices), "cbClusters::slices is misaligned");
+
+static_assert(sizeof(cbShadowCascade) == sizeof(CBufferLayout::ShadowCascade), "cbShadowCascade doesn't match ShadowCascade");
+static_assert(offsetof(cbShadowCascade, texelSize) == offsetof(CBufferLayout::ShadowCascade, params), "cbShadowCascade::texelSize is misaligned");
+static_assert(sizeof(cbShadows) == sizeof(CBufferLayout::PSShadows), "cbShadows doesn't match PSShadows");
+static_assert(offsetof(cbShadows, cascadeCount) == offsetof(CBufferLayout::PSShadows, shadowCascadeCount), "cbShadows::cascadeCount is misaligned");
+static_assert(offsetof(cbShadows, texelUV) == offsetof(CBufferLayout::PSShadows, shadowTexelUV), "cbShadows::texelUV is misaligned");
+static_assert(offsetof(cbShadows, normalOffset) == offsetof(CBufferLayout::PSShadows, shadowNormalOffset), "cbShadows::normalOffset is misaligned");
+
 }
 #endif
\ No newline at end of file
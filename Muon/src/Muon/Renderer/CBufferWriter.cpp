@@ -0,0 +1,87 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of CBufferWriter.h
+----------------------------------------------*/
+#include "CBufferWriter.h"
+
+#include <assert.h>
+#include <string.h>
+
+namespace Renderer {
+
+void CBufferWriter::Init(uint32_t byteSize)
+{
+    const uint32_t registers = (byteSize + kRegisterSize - 1) / kRegisterSize;
+    mData.assign(registers * kRegisterSize, 0);
+    mDirty.assign(registers, false);
+    MarkAllDirty();
+}
+
+void CBufferWriter::Write(uint32_t offset, const void* pData, uint32_t size)
+{
+    assert(offset + size <= mData.size() && "CBufferWriter: write past the end of the buffer");
+
+    const uint8_t* pSource = static_cast<const uint8_t*>(pData);
+    uint32_t cursor = offset;
+    const uint32_t end = offset + size;
+    while (cursor != end)
+    {
+        // One register's worth at a time so an unchanged register stays clean
+        const uint32_t reg = cursor / kRegisterSize;
+        const uint32_t chunkEnd = (reg + 1) * kRegisterSize < end ? (reg + 1) * kRegisterSize : end;
+        const uint32_t chunkSize = chunkEnd - cursor;
+
+        uint8_t* pDest = mData.data() + cursor;
+        if (memcmp(pDest, pSource, chunkSize))
+        {
+            memcpy(pDest, pSource, chunkSize);
+            if (!mDirty[reg])
+            {
+                mDirty[reg] = true;
+                mDirtyCount++;
+            }
+        }
+
+        pSource += chunkSize;
+        cursor = chunkEnd;
+    }
+}
+
+void CBufferWriter::MarkAllDirty()
+{
+    mDirty.assign(mDirty.size(), true);
+    mDirtyCount = (uint32_t)mDirty.size();
+}
+
+void CBufferWriter::ClearDirty()
+{
+    mDirty.assign(mDirty.size(), false);
+    mDirtyCount = 0;
+}
+
+uint32_t CBufferWriter::GetDirtyRanges(CBufferRange* out_ranges, uint32_t maxRanges, uint32_t mergeGap) const
+{
+    if (!maxRanges || !mDirtyCount)
+        return 0;
+
+    uint32_t count = 0;
+    uint32_t lastDirty = 0;
+    for (uint32_t reg = 0; reg != (uint32_t)mDirty.size(); ++reg)
+    {
+        if (!mDirty[reg])
+            continue;
+
+        // Extend the open range over a short clean gap, or when we're out of ranges
+        if (count && (reg - lastDirty - 1 <= mergeGap || count == maxRanges))
+            out_ranges[count - 1].Size = (reg + 1) * kRegisterSize - out_ranges[count - 1].Offset;
+        else
+            out_ranges[count++] = { reg * kRegisterSize, kRegisterSize };
+
+        lastDirty = reg;
+    }
+
+    return count;
+}
+
+}
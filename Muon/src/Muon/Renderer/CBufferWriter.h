@@ -0,0 +1,62 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : CPU shadow of a constant buffer that tracks which 16-byte registers changed,
+so uploads can cover only the dirty ranges instead of the whole buffer.
+Knows nothing about D3D; see ConstantBufferUpdateManager::UploadDirty.
+----------------------------------------------*/
+#ifndef MUON_CBUFFERWRITER_H
+#define MUON_CBUFFERWRITER_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace Renderer {
+
+// [Offset, Offset + Size) in bytes, both multiples of 16
+struct CBufferRange
+{
+    uint32_t Offset;
+    uint32_t Size;
+};
+
+class CBufferWriter
+{
+public:
+    static const uint32_t kRegisterSize = 16;
+
+    CBufferWriter() = default;
+
+    // byteSize is rounded up to whole registers. Everything starts dirty, so the first upload is complete.
+    void Init(uint32_t byteSize);
+
+    // Only marks registers whose bytes actually differ
+    void Write(uint32_t offset, const void* pData, uint32_t size);
+
+    template <typename T>
+    void Write(uint32_t offset, T const& value) { Write(offset, &value, (uint32_t)sizeof(T)); }
+
+    void MarkAllDirty();
+    void ClearDirty();
+
+    bool IsDirty() const { return mDirtyCount != 0; }
+
+    // Merges dirty registers into at most maxRanges ranges, bridging clean gaps of up to mergeGap registers.
+    // Once maxRanges is hit, the last range is stretched to cover the rest. Returns the number written.
+    uint32_t GetDirtyRanges(CBufferRange* out_ranges, uint32_t maxRanges, uint32_t mergeGap = 0) const;
+
+    const uint8_t* GetData() const     { return mData.data(); }
+    uint32_t       GetByteSize() const { return (uint32_t)mData.size(); }
+
+private:
+    std::vector<uint8_t> mData;
+    std::vector<bool>    mDirty;        // One per register
+    uint32_t             mDirtyCount = 0;
+
+public:
+    CBufferWriter(CBufferWriter const&)            = delete;
+    CBufferWriter& operator=(CBufferWriter const&) = delete;
+};
+
+}
+#endif
@@ -38,7 +38,7 @@ Camera::Camera(float x, float y, float z, float aspectRatio, float nearPlane, fl
     mRight = XMVectorAdd(initialRight, verticalOffset);
     mUp = XMVectorAdd(initialUp, verticalOffset);
 
-    ConstantBufferUpdateManager::Populate(sizeof(cbCamera), 10, EASEL_SHADER_STAGE::ESS_VS, device, &mBindPacket);
+    ConstantBufferUpdateManager::Populate(sizeof(cbCamera), (UINT)VS_REGISTERS::CAMERA, EASEL_SHADER_STAGE::ESS_VS, device, &mBindPacket);
 
     // Create initial matrices
     UpdateView(context);
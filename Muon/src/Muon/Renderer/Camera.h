@@ -46,6 +46,8 @@ public:
     DirectX::XMMATRIX   GetView()           const  { return mView;         }
     DirectX::XMMATRIX   GetProjection()     const  { return mProjection;   }
     float               GetSensitivity()    const  { return mSensitivity;  }
+    float               GetNear()           const  { return mNear;         }
+    float               GetFar()            const  { return mFar;          }
     
     void GetPosition3A(DirectX::XMFLOAT3A* out_pos) const;
     DirectX::XMVECTOR   GetPosition() const;
@@ -0,0 +1,282 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of CascadedShadows.h
+----------------------------------------------*/
+#include "CascadedShadows.h"
+
+#include <Muon/Core/JobSystem.h>
+
+#include <algorithm>
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+
+namespace Renderer {
+
+namespace {
+
+const uint32_t kCasterGroupSize = 256;
+
+inline float Dot(const float* a, const float* b) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+
+inline void Cross(const float* a, const float* b, float* out_c)
+{
+    out_c[0] = a[1] * b[2] - a[2] * b[1];
+    out_c[1] = a[2] * b[0] - a[0] * b[2];
+    out_c[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+inline void Normalize(float* v)
+{
+    const float invLength = 1.0f / sqrtf(Dot(v, v));
+    v[0] *= invLength;
+    v[1] *= invLength;
+    v[2] *= invLength;
+}
+
+}
+
+CascadedShadows::CascadedShadows() :
+    mCascades(),
+    mLightAxes(),
+    mSceneMin(),
+    mSceneMax(),
+    mReceiverFar(),
+    mHasSceneBounds(false),
+    mInvalidated(true),
+    mStats()
+{
+}
+
+void CascadedShadows::Init(ShadowCascadeConfig const& config)
+{
+    assert(config.CascadeCount && config.CascadeCount <= kMaxShadowCascades && config.Resolution > 2);
+    assert(config.SplitLambda >= 0.0f && config.SplitLambda <= 1.0f);
+
+    mConfig = config;
+    memset(mCascades, 0, sizeof(mCascades));
+    mInvalidated = true;
+    mStats = ShadowStats();
+}
+
+void CascadedShadows::SetSceneBounds(const float* min, const float* max)
+{
+    if (mHasSceneBounds && !memcmp(min, mSceneMin, sizeof(mSceneMin)) && !memcmp(max, mSceneMax, sizeof(mSceneMax)))
+        return;
+
+    memcpy(mSceneMin, min, sizeof(mSceneMin));
+    memcpy(mSceneMax, max, sizeof(mSceneMax));
+    mHasSceneBounds = true;
+    mInvalidated = true;
+}
+
+void CascadedShadows::ComputeSplits(ShadowView const& view, float* out_splits) const
+{
+    const uint32_t count = mConfig.CascadeCount;
+    const float nearZ = view.Near;
+    const float farZ = mConfig.MaxDistance > 0.0f ? std::min(mConfig.MaxDistance, view.Far) : view.Far;
+
+    // Practical split scheme: logarithmic spacing matches how perspective spreads texels out, uniform
+    // spacing keeps the near cascades from getting too thin. Lambda blends the two.
+    out_splits[0] = nearZ;
+    for (uint32_t i = 1; i != count; ++i)
+    {
+        const float t = (float)i / (float)count;
+        const float logSplit = nearZ * powf(farZ / nearZ, t);
+        const float uniformSplit = nearZ + (farZ - nearZ) * t;
+        out_splits[i] = mConfig.SplitLambda * logSplit + (1.0f - mConfig.SplitLambda) * uniformSplit;
+    }
+    out_splits[count] = farZ;
+}
+
+void CascadedShadows::FitCascade(ShadowView const& view, float splitNear, float splitFar, bool cached, ShadowCascade const* pPrevious, ShadowCascade& out_cascade, float& out_receiverFar) const
+{
+    // The slice is symmetric about the view axis, so its smallest bounding sphere is centered on it.
+    // A slice corner at depth z sits k * z off axis. The center is where the near and far corners are
+    // equally far away, unless that lands past the far plane, where the far corners alone decide.
+    const float k2 = 1.0f / (view.ProjScaleX * view.ProjScaleX) + 1.0f / (view.ProjScaleY * view.ProjScaleY);
+    const float centerZ = std::min(0.5f * (1.0f + k2) * (splitNear + splitFar), splitFar);
+    const float farOffset = splitFar - centerZ;
+    const float sphereRadius = sqrtf(k2 * splitFar * splitFar + farOffset * farOffset);
+
+    // Snapping moves the cascade up to a texel off the sphere, so leave a texel spare on every side
+    const float resolution = (float)mConfig.Resolution;
+    const float margin = cached ? 1.0f + mConfig.CachedMargin : 1.0f;
+    const float radius = sphereRadius * margin * resolution / (resolution - 2.0f);
+
+    // Back to world space: the view's rotation is orthonormal, so undo the translation and apply its transpose
+    const float* v = view.View;
+    const float local[3] = { -v[12], -v[13], centerZ - v[14] };
+    const float center[3] =
+    {
+        local[0] * v[0] + local[1] * v[1] + local[2] * v[2],
+        local[0] * v[4] + local[1] * v[5] + local[2] * v[6],
+        local[0] * v[8] + local[1] * v[9] + local[2] * v[10],
+    };
+
+    // Moving the cascade by whole texels keeps every caster rasterizing to the same texels
+    const float texelSize = 2.0f * radius / resolution;
+    const float* right = mLightAxes[0];
+    const float* up = mLightAxes[1];
+    const float* forward = mLightAxes[2];
+    int32_t originX = (int32_t)floorf(Dot(center, right) / texelSize);
+    int32_t originY = (int32_t)floorf(Dot(center, up) / texelSize);
+    const float centerLightZ = Dot(center, forward);
+
+    // A cached cascade stays where it was while the slice's sphere is still inside it
+    if (pPrevious && pPrevious->Radius == radius)
+    {
+        const float slack = radius - sphereRadius - texelSize;
+        const float dx = Dot(center, right) - (float)pPrevious->OriginX * texelSize;
+        const float dy = Dot(center, up) - (float)pPrevious->OriginY * texelSize;
+        if (fabsf(dx) <= slack && fabsf(dy) <= slack)
+        {
+            originX = pPrevious->OriginX;
+            originY = pPrevious->OriginY;
+        }
+    }
+
+    // Spanning the whole scene catches casters between the light and the frustum, and keeps the
+    // range from following the camera around
+    float depthNear = centerLightZ - radius;
+    float depthFar = centerLightZ + radius;
+    if (mHasSceneBounds)
+    {
+        depthNear = depthFar = Dot(mSceneMin, forward);
+        for (uint32_t corner = 1; corner != 8; ++corner)
+        {
+            const float p[3] =
+            {
+                (corner & 1) ? mSceneMax[0] : mSceneMin[0],
+                (corner & 2) ? mSceneMax[1] : mSceneMin[1],
+                (corner & 4) ? mSceneMax[2] : mSceneMin[2],
+            };
+            const float z = Dot(p, forward);
+            depthNear = std::min(depthNear, z);
+            depthFar = std::max(depthFar, z);
+        }
+    }
+    const float depthScale = 1.0f / std::max(depthFar - depthNear, 1e-3f);
+
+    // Light view and orthographic projection in one: x' = (dot(p, right) - originX * texelSize) / radius, and so on
+    const float invRadius = 1.0f / radius;
+    float* m = out_cascade.ViewProjection;
+    for (uint32_t row = 0; row != 3; ++row)
+    {
+        m[row * 4 + 0] = right[row] * invRadius;
+        m[row * 4 + 1] = up[row] * invRadius;
+        m[row * 4 + 2] = forward[row] * depthScale;
+        m[row * 4 + 3] = 0.0f;
+    }
+    m[12] = -(float)originX * texelSize * invRadius;
+    m[13] = -(float)originY * texelSize * invRadius;
+    m[14] = -depthNear * depthScale;
+    m[15] = 1.0f;
+
+    out_cascade.SplitNear = splitNear;
+    out_cascade.SplitFar  = splitFar;
+    out_cascade.Radius    = radius;
+    out_cascade.TexelSize = texelSize;
+    out_cascade.OriginX   = originX;
+    out_cascade.OriginY   = originY;
+    out_cascade.DepthNear = depthNear;
+    out_cascade.DepthFar  = depthFar;
+    out_receiverFar = centerLightZ + sphereRadius;
+}
+
+void CascadedShadows::Update(ShadowView const& view)
+{
+    // Light space basis. It only depends on the light, so it never rotates the map as the camera moves.
+    float axes[3][3];
+    memcpy(axes[2], view.LightDirection, sizeof(axes[2]));
+    Normalize(axes[2]);
+
+    const float worldUp[3] = { 0.0f, 1.0f, 0.0f };
+    const float worldRight[3] = { 1.0f, 0.0f, 0.0f };
+    Cross(fabsf(axes[2][1]) < 0.99f ? worldUp : worldRight, axes[2], axes[0]);
+    Normalize(axes[0]);
+    Cross(axes[2], axes[0], axes[1]);
+
+    const bool lightMoved = memcmp(axes, mLightAxes, sizeof(axes)) != 0;
+    memcpy(mLightAxes, axes, sizeof(axes));
+
+    float splits[kMaxShadowCascades + 1];
+    ComputeSplits(view, splits);
+
+    mStats = ShadowStats();
+    for (uint32_t c = 0; c != mConfig.CascadeCount; ++c)
+    {
+        ShadowCascade& cascade = mCascades[c];
+        const bool cached = c >= mConfig.FirstCachedCascade;
+        const bool keepOrigin = cached && !mInvalidated && !lightMoved;
+
+        ShadowCascade fitted;
+        FitCascade(view, splits[c], splits[c + 1], cached, keepOrigin ? &cascade : nullptr, fitted, mReceiverFar[c]);
+
+        const bool fitMoved = fitted.OriginX != cascade.OriginX || fitted.OriginY != cascade.OriginY || fitted.Radius != cascade.Radius ||
+                              fitted.DepthNear != cascade.DepthNear || fitted.DepthFar != cascade.DepthFar;
+        fitted.NeedsRender = !keepOrigin || fitMoved;
+        cascade = fitted;
+
+        mStats.CascadesRendered += cascade.NeedsRender;
+        mStats.CascadesCached += !cascade.NeedsRender;
+    }
+    mInvalidated = false;
+}
+
+void CascadedShadows::CullCasters(const ShadowCaster* pCasters, uint32_t count, uint8_t* out_cascadeMasks) const
+{
+    using namespace Core;
+
+    // The cascade's box swept towards the light: anything overlapping it in x and y, and not wholly behind
+    // the slice's receivers, can throw a shadow onto them
+    struct CascadeBox
+    {
+        float CenterX, CenterY;
+        float HalfSize;
+        float ReceiverFar;
+    };
+    CascadeBox boxes[kMaxShadowCascades];
+    uint32_t renderMask = 0;
+    for (uint32_t c = 0; c != mConfig.CascadeCount; ++c)
+    {
+        ShadowCascade const& cascade = mCascades[c];
+        boxes[c].CenterX = (float)cascade.OriginX * cascade.TexelSize;
+        boxes[c].CenterY = (float)cascade.OriginY * cascade.TexelSize;
+        boxes[c].HalfSize = cascade.Radius;
+        boxes[c].ReceiverFar = mReceiverFar[c];
+        renderMask |= (uint32_t)cascade.NeedsRender << c;
+    }
+
+    const float* right = mLightAxes[0];
+    const float* up = mLightAxes[1];
+    const float* forward = mLightAxes[2];
+    const uint32_t cascadeCount = mConfig.CascadeCount;
+
+    JobCounter counter;
+    JobSystem::Dispatch(counter, count, kCasterGroupSize, [&](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t i = begin; i != end; ++i)
+        {
+            ShadowCaster const& caster = pCasters[i];
+            const float x = Dot(caster.Center, right);
+            const float y = Dot(caster.Center, up);
+            const float z = Dot(caster.Center, forward);
+
+            uint32_t mask = 0;
+            for (uint32_t c = 0; c != cascadeCount; ++c)
+            {
+                CascadeBox const& box = boxes[c];
+                const float reach = box.HalfSize + caster.Radius;
+                const bool inside = fabsf(x - box.CenterX) <= reach && fabsf(y - box.CenterY) <= reach &&
+                                    z - caster.Radius <= box.ReceiverFar;
+                mask |= (uint32_t)inside << c;
+            }
+            out_cascadeMasks[i] = (uint8_t)(mask & renderMask);
+        }
+    });
+    JobSystem::Wait(counter);
+}
+
+}
@@ -0,0 +1,127 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Cascaded shadow maps for a directional light, CPU side
+The camera's depth range is split with the practical split scheme and each slice
+of the frustum gets an orthographic cascade around its bounding sphere. The sphere
+only depends on the split depths and the projection, and the cascade's origin is
+snapped to whole texels, so shadows don't swim or shimmer as the camera turns and moves.
+The light-space depth range covers the whole scene, so casters outside the camera's
+view still land in the map. Far cascades can be cached: they only need drawing again
+when the light turns or their snapped fit moves.
+No D3D dependencies, so it builds and runs anywhere the headless game does.
+----------------------------------------------*/
+#ifndef MUON_CASCADEDSHADOWS_H
+#define MUON_CASCADEDSHADOWS_H
+
+#include <stdint.h>
+
+namespace Renderer {
+
+static const uint32_t kMaxShadowCascades = 4;
+
+struct ShadowCascadeConfig
+{
+    uint32_t CascadeCount       = 4;        // At most kMaxShadowCascades
+    uint32_t Resolution         = 2048;     // Texels per side of each cascade
+    float    SplitLambda        = 0.75f;    // 0 splits the depth range uniformly, 1 logarithmically
+    float    MaxDistance        = 0.0f;     // Shadows end here, 0 uses the camera's far plane
+
+    // Cascades from this one on are cached: they keep last frame's map until the light or their fit moves.
+    // Things moving inside them are the price, so only use it where texels are large anyway.
+    uint32_t FirstCachedCascade = kMaxShadowCascades;
+
+    // Cached cascades are this much wider than their slice needs, and stay put until the slice leaves the slack
+    float    CachedMargin       = 0.1f;
+};
+
+// What the cascades are fitted to. Row vectors and a left handed view like DirectXMath: +z looks forward.
+struct ShadowView
+{
+    float View[16];
+    float ProjScaleX;           // Projection _11
+    float ProjScaleY;           // Projection _22
+    float Near;
+    float Far;
+    float LightDirection[3];    // The way the light travels, normalized
+};
+
+struct ShadowCascade
+{
+    // World to light clip space: x and y in [-1, 1] across the map, z in [0, 1] across the scene
+    float    ViewProjection[16];
+
+    float    SplitNear;         // View depth range of the camera frustum this cascade covers
+    float    SplitFar;
+    float    Radius;            // Half the cascade's width in world units, a texel more than the slice's bounding sphere
+    float    TexelSize;         // World units per texel
+
+    // Light space position of the cascade, x and y in whole texels
+    int32_t  OriginX;
+    int32_t  OriginY;
+    float    DepthNear;
+    float    DepthFar;
+
+    bool     NeedsRender;       // False when a cached cascade's map from an earlier frame still holds
+};
+
+// A caster's world space bounding sphere
+struct ShadowCaster
+{
+    float Center[3];
+    float Radius;
+};
+
+struct ShadowStats
+{
+    uint32_t CascadesRendered;
+    uint32_t CascadesCached;
+};
+
+class CascadedShadows
+{
+public:
+    CascadedShadows();
+
+    void Init(ShadowCascadeConfig const& config);
+
+    // Everything that can cast or receive. The cascades' depth range spans it, so it should be static or
+    // change rarely: any change redraws every cascade.
+    void SetSceneBounds(const float* min, const float* max);
+
+    // Redraws every cascade on the next Update, e.g. after static geometry moved
+    void Invalidate() { mInvalidated = true; }
+
+    void Update(ShadowView const& view);
+
+    // Writes a bit per cascade the caster has to be drawn into, for every cascade with NeedsRender.
+    // A caster is in a cascade when it overlaps the box swept from the cascade towards the light.
+    void CullCasters(const ShadowCaster* pCasters, uint32_t count, uint8_t* out_cascadeMasks) const;
+
+    uint32_t             GetCascadeCount() const            { return mConfig.CascadeCount; }
+    ShadowCascade const& GetCascade(uint32_t index) const   { return mCascades[index];     }
+    ShadowCascadeConfig const& GetConfig() const            { return mConfig;              }
+    ShadowStats const&   GetStats() const                   { return mStats;               }
+
+    // Light space axes, the third being the light's direction
+    const float* GetLightAxis(uint32_t axis) const          { return mLightAxes[axis];     }
+
+private:
+    void ComputeSplits(ShadowView const& view, float* out_splits) const;
+    // pPrevious is the cascade's last fit, which a cached cascade keeps its origin from while the slice is inside it.
+    // Null when it has to be fitted from scratch.
+    void FitCascade(ShadowView const& view, float splitNear, float splitFar, bool cached, ShadowCascade const* pPrevious, ShadowCascade& out_cascade, float& out_receiverFar) const;
+
+    ShadowCascadeConfig mConfig;
+    ShadowCascade       mCascades[kMaxShadowCascades];
+    float               mLightAxes[3][3];
+    float               mSceneMin[3];
+    float               mSceneMax[3];
+    float               mReceiverFar[kMaxShadowCascades];   // Light space depth past which a cascade has no receivers
+    bool                mHasSceneBounds;
+    bool                mInvalidated;
+    ShadowStats         mStats;
+};
+
+}
+#endif
@@ -0,0 +1,404 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of ClusteredLighting.h
+----------------------------------------------*/
+#include "ClusteredLighting.h"
+
+#include <Muon/Core/JobSystem.h>
+
+#include <algorithm>
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+
+#if (defined(_M_X64) || defined(__SSE2__)) && !defined(MN_NO_SIMD)
+#define MN_CLUSTER_SSE 1
+#include <emmintrin.h>
+#else
+#define MN_CLUSTER_SSE 0
+#endif
+
+namespace Renderer {
+
+namespace {
+
+const uint32_t kMaxTilesX       = 256;
+const uint32_t kLightGroupSize  = 256;
+
+// Sits past any light, so padded tiles never pass a test
+const float kUnreachable = 1e30f;
+
+inline float Square(float x) { return x * x; }
+
+// Distance from c to [lo, hi] along one axis, 0 inside
+inline float AxisDistance(float c, float lo, float hi)
+{
+    return std::max(std::max(lo - c, 0.0f), c - hi);
+}
+
+inline uint16_t ToTile(float ndc, uint32_t tileCount)
+{
+    const float t = floorf((ndc + 1.0f) * 0.5f * (float)tileCount);
+    return (uint16_t)std::min(std::max(t, 0.0f), (float)(tileCount - 1));
+}
+
+}
+
+ClusteredLighting::ClusteredLighting() :
+    mPaddedTilesX(0),
+    mFittedTo(),
+    mSliceScale(0.0f),
+    mSliceBias(0.0f),
+    mStats()
+{
+}
+
+void ClusteredLighting::Init(ClusterGridConfig const& config)
+{
+    assert(config.TilesX && config.TilesX <= kMaxTilesX && config.TilesY && config.Slices);
+    assert(config.TilesX * config.TilesY <= 0x10000 && config.MaxLights <= 0x10000 && "ClusteredLighting: hits pack the cluster and light into 16 bits each");
+
+    mConfig = config;
+    mLights.Init(config.MaxLights);
+
+    mPaddedTilesX = (config.TilesX + 3) & ~3u;
+    mTileMinX.assign(config.Slices * mPaddedTilesX, kUnreachable);
+    mTileMaxX.assign(config.Slices * mPaddedTilesX, kUnreachable);
+    mTileMinY.assign(config.Slices * config.TilesY, 0.0f);
+    mTileMaxY.assign(config.Slices * config.TilesY, 0.0f);
+    mSliceMinZ.assign(config.Slices, 0.0f);
+    mSliceMaxZ.assign(config.Slices, 0.0f);
+    memset(mFittedTo, 0, sizeof(mFittedTo));
+
+    mSliceLightOffsets.assign(config.Slices + 1, 0);
+    mSliceHits.resize(config.Slices);
+    mSliceIndices.resize(config.Slices);
+    mSliceStats.resize(config.Slices);
+    mGrid.assign(config.Slices * config.TilesY * config.TilesX, { 0, 0 });
+    mIndices.reserve(std::min(config.MaxLightIndices, 1u << 16));
+    mStats = ClusterStats();
+}
+
+void ClusteredLighting::Destroy()
+{
+    mLights.Destroy();
+    mTileMinX.clear();
+    mTileMaxX.clear();
+    mTileMinY.clear();
+    mTileMaxY.clear();
+    mSliceMinZ.clear();
+    mSliceMaxZ.clear();
+    mBounds.clear();
+    mSliceLights.clear();
+    mSliceBase.clear();
+    mSliceHits.clear();
+    mSliceIndices.clear();
+    mSliceStats.clear();
+    mGrid.clear();
+    mIndices.clear();
+}
+
+void ClusteredLighting::FitGrid(ClusterView const& view)
+{
+    const float fitTo[4] = { view.ProjScaleX, view.ProjScaleY, view.Near, view.Far };
+    if (!memcmp(fitTo, mFittedTo, sizeof(fitTo)))
+        return;
+    memcpy(mFittedTo, fitTo, sizeof(fitTo));
+
+    const uint32_t slices = mConfig.Slices;
+    const float depthRatio = log2f(view.Far / view.Near);
+    mSliceScale = (float)slices / depthRatio;
+    mSliceBias  = -(float)slices * log2f(view.Near) / depthRatio;
+
+    for (uint32_t s = 0; s != slices; ++s)
+    {
+        const float zNear = view.Near * powf(view.Far / view.Near, (float)s / (float)slices);
+        const float zFar  = view.Near * powf(view.Far / view.Near, (float)(s + 1) / (float)slices);
+        mSliceMinZ[s] = zNear;
+        mSliceMaxZ[s] = zFar;
+
+        // A tile's side planes fan out from the eye, so its widest point is at whichever end of the slice is further
+        for (uint32_t x = 0; x != mConfig.TilesX; ++x)
+        {
+            const float ndc0 = -1.0f + 2.0f * (float)x / (float)mConfig.TilesX;
+            const float ndc1 = -1.0f + 2.0f * (float)(x + 1) / (float)mConfig.TilesX;
+            mTileMinX[s * mPaddedTilesX + x] = std::min(ndc0 * zNear, ndc0 * zFar) / view.ProjScaleX;
+            mTileMaxX[s * mPaddedTilesX + x] = std::max(ndc1 * zNear, ndc1 * zFar) / view.ProjScaleX;
+        }
+
+        // Rows count down from the top of the screen
+        for (uint32_t y = 0; y != mConfig.TilesY; ++y)
+        {
+            const float ndc0 = 1.0f - 2.0f * (float)(y + 1) / (float)mConfig.TilesY;
+            const float ndc1 = 1.0f - 2.0f * (float)y / (float)mConfig.TilesY;
+            mTileMinY[s * mConfig.TilesY + y] = std::min(ndc0 * zNear, ndc0 * zFar) / view.ProjScaleY;
+            mTileMaxY[s * mConfig.TilesY + y] = std::max(ndc1 * zNear, ndc1 * zFar) / view.ProjScaleY;
+        }
+    }
+}
+
+uint32_t ClusteredLighting::GetSlice(float viewZ) const
+{
+    const float slice = floorf(log2f(viewZ) * mSliceScale + mSliceBias);
+    return (uint32_t)std::min(std::max(slice, 0.0f), (float)(mConfig.Slices - 1));
+}
+
+void ClusteredLighting::ComputeBounds(ClusterView const& view, uint32_t begin, uint32_t end)
+{
+    const float* v = view.View;
+    for (uint32_t i = begin; i != end; ++i)
+    {
+        LightBounds& bounds = mBounds[i];
+        bounds.MinZ = 1;
+        bounds.MaxZ = 0;
+
+        ClusterLight const& light = mLights.Get(i);
+        if (light.Range <= 0.0f)
+            continue;
+
+        // Spot cones are bounded by the smallest sphere around them, which sits further down the
+        // axis than the light itself once the cone is narrower than 90 degrees
+        float center[3] = { light.Position[0], light.Position[1], light.Position[2] };
+        float radius = light.Range;
+        if (light.Type == (uint32_t)ClusterLightType::SPOT)
+        {
+            const float cosAngle = std::max(light.CosOuterAngle, 0.0f);
+            float offset;
+            if (cosAngle < 0.70710678f)
+            {
+                offset = cosAngle * light.Range;
+                radius = sqrtf(1.0f - cosAngle * cosAngle) * light.Range;
+            }
+            else
+            {
+                offset = light.Range / (2.0f * cosAngle);
+                radius = offset;
+            }
+            center[0] += light.Direction[0] * offset;
+            center[1] += light.Direction[1] * offset;
+            center[2] += light.Direction[2] * offset;
+        }
+
+        const float cx = center[0] * v[0] + center[1] * v[4] + center[2] * v[8]  + v[12];
+        const float cy = center[0] * v[1] + center[1] * v[5] + center[2] * v[9]  + v[13];
+        const float cz = center[0] * v[2] + center[1] * v[6] + center[2] * v[10] + v[14];
+        if (cz + radius < view.Near || cz - radius > view.Far)
+            continue;
+
+        // Conservative screen rect: each edge is extreme at one end of the sphere's depth range
+        const float zLo = std::max(cz - radius, view.Near);
+        const float zHi = std::max(cz + radius, view.Near);
+        const float minX = view.ProjScaleX * std::min((cx - radius) / zLo, (cx - radius) / zHi);
+        const float maxX = view.ProjScaleX * std::max((cx + radius) / zLo, (cx + radius) / zHi);
+        const float minY = view.ProjScaleY * std::min((cy - radius) / zLo, (cy - radius) / zHi);
+        const float maxY = view.ProjScaleY * std::max((cy + radius) / zLo, (cy + radius) / zHi);
+        if (minX > 1.0f || maxX < -1.0f || minY > 1.0f || maxY < -1.0f)
+            continue;
+
+        bounds.Center[0] = cx;
+        bounds.Center[1] = cy;
+        bounds.Center[2] = cz;
+        bounds.Radius    = radius;
+        bounds.MinX = ToTile(minX, mConfig.TilesX);
+        bounds.MaxX = ToTile(maxX, mConfig.TilesX);
+        bounds.MinY = (uint16_t)(mConfig.TilesY - 1 - ToTile(maxY, mConfig.TilesY));
+        bounds.MaxY = (uint16_t)(mConfig.TilesY - 1 - ToTile(minY, mConfig.TilesY));
+        bounds.MinZ = (uint16_t)GetSlice(zLo);
+        bounds.MaxZ = (uint16_t)GetSlice(std::min(cz + radius, view.Far));
+    }
+}
+
+void ClusteredLighting::BinSlice(uint32_t slice)
+{
+    const uint32_t tilesX = mConfig.TilesX;
+    const uint32_t tilesY = mConfig.TilesY;
+    const uint32_t sliceClusters = tilesX * tilesY;
+    const float* tileMinX = &mTileMinX[slice * mPaddedTilesX];
+    const float* tileMaxX = &mTileMaxX[slice * mPaddedTilesX];
+    const float* tileMinY = &mTileMinY[slice * tilesY];
+    const float* tileMaxY = &mTileMaxY[slice * tilesY];
+
+    std::vector<uint32_t>& hits = mSliceHits[slice];
+    hits.clear();
+
+    alignas(16) float dx2[kMaxTilesX];
+    for (uint32_t l = mSliceLightOffsets[slice]; l != mSliceLightOffsets[slice + 1]; ++l)
+    {
+        const uint32_t lightIndex = mSliceLights[l];
+        LightBounds const& bounds = mBounds[lightIndex];
+        const float r2 = Square(bounds.Radius);
+
+        const float remainingZ = r2 - Square(AxisDistance(bounds.Center[2], mSliceMinZ[slice], mSliceMaxZ[slice]));
+        if (remainingZ < 0.0f)
+            continue;
+
+        // Squared x distances for the light's whole tile span, four at a time
+        const uint32_t firstX = bounds.MinX & ~3u;
+        const uint32_t endX = bounds.MaxX + 1u;
+#if MN_CLUSTER_SSE
+        const __m128 cx = _mm_set1_ps(bounds.Center[0]);
+        const __m128 zero = _mm_setzero_ps();
+        for (uint32_t x = firstX; x < endX; x += 4)
+        {
+            const __m128 below = _mm_sub_ps(_mm_loadu_ps(&tileMinX[x]), cx);
+            const __m128 above = _mm_sub_ps(cx, _mm_loadu_ps(&tileMaxX[x]));
+            const __m128 d = _mm_max_ps(_mm_max_ps(below, zero), above);
+            _mm_store_ps(&dx2[x], _mm_mul_ps(d, d));
+        }
+#else
+        for (uint32_t x = firstX; x < endX; ++x)
+            dx2[x] = Square(AxisDistance(bounds.Center[0], tileMinX[x], tileMaxX[x]));
+#endif
+
+        for (uint32_t y = bounds.MinY; y <= bounds.MaxY; ++y)
+        {
+            const float remaining = remainingZ - Square(AxisDistance(bounds.Center[1], tileMinY[y], tileMaxY[y]));
+            if (remaining < 0.0f)
+                continue;
+
+            const uint32_t rowBase = y * tilesX;
+#if MN_CLUSTER_SSE
+            const __m128 limit = _mm_set1_ps(remaining);
+            for (uint32_t x = firstX; x < endX; x += 4)
+            {
+                uint32_t mask = (uint32_t)_mm_movemask_ps(_mm_cmple_ps(_mm_load_ps(&dx2[x]), limit));
+                for (uint32_t lane = 0; mask; ++lane, mask >>= 1)
+                {
+                    const uint32_t tile = x + lane;
+                    if ((mask & 1) && tile >= bounds.MinX && tile < endX)
+                        hits.push_back(((rowBase + tile) << 16) | lightIndex);
+                }
+            }
+#else
+            for (uint32_t x = bounds.MinX; x < endX; ++x)
+            {
+                if (dx2[x] <= remaining)
+                    hits.push_back(((rowBase + x) << 16) | lightIndex);
+            }
+#endif
+        }
+    }
+
+    // Counting sort by cluster. Lights were visited in index order, so each list stays sorted.
+    ClusterRange* grid = &mGrid[slice * sliceClusters];
+    for (uint32_t c = 0; c != sliceClusters; ++c)
+        grid[c] = { 0, 0 };
+    for (uint32_t hit : hits)
+        grid[hit >> 16].Count++;
+
+    ClusterStats& stats = mSliceStats[slice];
+    stats = ClusterStats();
+
+    uint32_t offset = 0;
+    for (uint32_t c = 0; c != sliceClusters; ++c)
+    {
+        grid[c].Offset = offset;
+        offset += grid[c].Count;
+        stats.LitClusters += grid[c].Count != 0;
+        stats.MaxLightsPerCluster = std::max(stats.MaxLightsPerCluster, grid[c].Count);
+    }
+    stats.LightIndices = offset;
+
+    std::vector<uint32_t>& indices = mSliceIndices[slice];
+    indices.resize(offset);
+    for (uint32_t hit : hits)
+    {
+        ClusterRange& range = grid[hit >> 16];
+        indices[range.Offset++] = hit & 0xFFFF;
+    }
+
+    // Offset went one list past while scattering
+    for (uint32_t c = 0; c != sliceClusters; ++c)
+        grid[c].Offset -= grid[c].Count;
+}
+
+void ClusteredLighting::Build(ClusterView const& view)
+{
+    using namespace Core;
+
+    FitGrid(view);
+
+    const uint32_t lightCount = mLights.GetHighWater();
+    const uint32_t slices = mConfig.Slices;
+    mBounds.resize(lightCount);
+
+    JobCounter counter;
+    JobSystem::Dispatch(counter, lightCount, kLightGroupSize, [this, &view](uint32_t begin, uint32_t end)
+    {
+        ComputeBounds(view, begin, end);
+    });
+    JobSystem::Wait(counter);
+
+    // Bucket the visible lights by the slices they span, in light order
+    std::fill(mSliceLightOffsets.begin(), mSliceLightOffsets.end(), 0u);
+    uint32_t visible = 0;
+    for (LightBounds const& bounds : mBounds)
+    {
+        for (uint32_t s = bounds.MinZ; s <= bounds.MaxZ; ++s)
+            mSliceLightOffsets[s + 1]++;
+        visible += bounds.MinZ <= bounds.MaxZ;
+    }
+    for (uint32_t s = 0; s != slices; ++s)
+        mSliceLightOffsets[s + 1] += mSliceLightOffsets[s];
+
+    mSliceLights.resize(mSliceLightOffsets[slices]);
+    mSliceBase.assign(mSliceLightOffsets.begin(), mSliceLightOffsets.end() - 1);
+    for (uint32_t i = 0; i != lightCount; ++i)
+    {
+        for (uint32_t s = mBounds[i].MinZ; s <= mBounds[i].MaxZ; ++s)
+            mSliceLights[mSliceBase[s]++] = i;
+    }
+
+    JobSystem::Dispatch(counter, slices, 1, [this](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t s = begin; s != end; ++s)
+            BinSlice(s);
+    });
+    JobSystem::Wait(counter);
+
+    // Slices go near to far, so when the list is full the furthest ones are the ones left unlit
+    mStats = ClusterStats();
+    mStats.Lights = mLights.GetStats().Live;
+    mStats.VisibleLights = visible;
+
+    const uint32_t sliceClusters = mConfig.TilesX * mConfig.TilesY;
+    uint32_t total = 0;
+    for (uint32_t s = 0; s != slices; ++s)
+    {
+        ClusterStats const& sliceStats = mSliceStats[s];
+        if (total + sliceStats.LightIndices > mConfig.MaxLightIndices)
+        {
+            mStats.DroppedIndices += sliceStats.LightIndices;
+            memset(&mGrid[s * sliceClusters], 0, sizeof(ClusterRange) * sliceClusters);
+            mSliceIndices[s].clear();
+            mSliceBase[s] = total;
+            continue;
+        }
+
+        mSliceBase[s] = total;
+        total += sliceStats.LightIndices;
+        mStats.LitClusters += sliceStats.LitClusters;
+        mStats.MaxLightsPerCluster = std::max(mStats.MaxLightsPerCluster, sliceStats.MaxLightsPerCluster);
+    }
+    mStats.LightIndices = total;
+    mIndices.resize(total);
+
+    JobSystem::Dispatch(counter, slices, 1, [this, sliceClusters](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t s = begin; s != end; ++s)
+        {
+            std::vector<uint32_t> const& indices = mSliceIndices[s];
+            if (indices.empty())
+                continue;
+
+            ClusterRange* grid = &mGrid[s * sliceClusters];
+            for (uint32_t c = 0; c != sliceClusters; ++c)
+                grid[c].Offset += mSliceBase[s];
+            memcpy(&mIndices[mSliceBase[s]], indices.data(), indices.size() * sizeof(uint32_t));
+        }
+    });
+    JobSystem::Wait(counter);
+}
+
+}
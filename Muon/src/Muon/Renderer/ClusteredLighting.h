@@ -0,0 +1,168 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Clustered forward lighting, CPU side
+Point and spot lights live in a GPUTable so only the ones that changed are uploaded.
+Every frame they are binned into a froxel grid fitted to the camera: screen tiles by
+exponentially spaced depth slices. Each cluster gets an (offset, count) into one compact
+light index list, which the pixel shader walks for the cluster it lands in.
+Binning runs on the job system, one depth slice per job, with the sphere/froxel tests
+done four tiles at a time. Spot lights are binned by their cone's bounding sphere.
+No D3D dependencies, so it builds and benchmarks anywhere the headless game does.
+----------------------------------------------*/
+#ifndef MUON_CLUSTEREDLIGHTING_H
+#define MUON_CLUSTEREDLIGHTING_H
+
+#include "GPUTable.h"
+
+#include <stdint.h>
+#include <vector>
+
+namespace Renderer {
+
+enum class ClusterLightType : uint32_t
+{
+    POINT,
+    SPOT
+};
+
+// One entry of StructuredBuffer<ClusterLight>, see Assets/Shaders/ClusteredLighting.hlsli
+struct ClusterLight
+{
+    float    Position[3]   = { 0.0f, 0.0f, 0.0f };
+    float    Range         = 0.0f;     // Removed lights keep 0 and bin nowhere
+    float    Color[3]      = { 0.0f, 0.0f, 0.0f };
+    uint32_t Type          = (uint32_t)ClusterLightType::POINT;
+    float    Direction[3]  = { 0.0f, 0.0f, 1.0f };
+    float    CosOuterAngle = -1.0f;    // Cosine of the spot cone's half angle
+};
+
+static_assert(sizeof(ClusterLight) % 16 == 0, "ClusterLight must stay 16 byte aligned for structured buffers");
+
+struct ClusterGridConfig
+{
+    uint32_t TilesX          = 16;
+    uint32_t TilesY          = 9;
+    uint32_t Slices          = 24;
+    uint32_t MaxLights       = 4096;
+
+    // Size of the index list buffer. When a frame needs more, the furthest slices go unlit.
+    uint32_t MaxLightIndices = 1 << 18;
+};
+
+// What the grid is fitted to. Row vectors and a left handed view like DirectXMath: +z looks forward.
+struct ClusterView
+{
+    float View[16];
+    float ProjScaleX;   // Projection _11
+    float ProjScaleY;   // Projection _22
+    float Near;
+    float Far;
+};
+
+// One per cluster, uint2 in HLSL
+struct ClusterRange
+{
+    uint32_t Offset;
+    uint32_t Count;
+};
+
+struct ClusterStats
+{
+    uint32_t Lights;
+    uint32_t VisibleLights;
+    uint32_t LitClusters;
+    uint32_t LightIndices;
+    uint32_t MaxLightsPerCluster;
+    uint32_t DroppedIndices;    // Didn't fit in MaxLightIndices
+};
+
+class ClusteredLighting
+{
+public:
+    ClusteredLighting();
+
+    void Init(ClusterGridConfig const& config);
+    void Destroy();
+
+    // kInvalidTableIndex when MaxLights are already live
+    uint32_t AddLight(ClusterLight const& light)                    { return mLights.Add(light);   }
+    void     UpdateLight(uint32_t index, ClusterLight const& light) { mLights.Update(index, light); }
+    void     RemoveLight(uint32_t index)                            { mLights.Remove(index);       }
+
+    ClusterLight const& GetLight(uint32_t index) const { return mLights.Get(index); }
+    const ClusterLight* GetLightData() const           { return mLights.GetData();  }
+    uint32_t            GetLightBufferSize() const     { return mLights.GetByteSize(); }
+
+    // Lights changed since the last call, as ranges of GetLightData()
+    void CollectDirtyLights(std::vector<GPUTableRange>& out_ranges) { mLights.CollectDirtyRanges(out_ranges); }
+
+    // Bins every live light into this view's grid. The grid moves with the camera, so unlike the
+    // lights it is rebuilt and uploaded whole every frame.
+    void Build(ClusterView const& view);
+
+    const ClusterRange* GetGrid() const             { return mGrid.data(); }
+    uint32_t            GetClusterCount() const     { return (uint32_t)mGrid.size(); }
+    const uint32_t*     GetLightIndices() const     { return mIndices.data(); }
+    uint32_t            GetLightIndexCount() const  { return mStats.LightIndices; }
+
+    // The slice holding view space depth z is floor(log2(z) * scale + bias)
+    float GetSliceScale() const { return mSliceScale; }
+    float GetSliceBias() const  { return mSliceBias;  }
+
+    ClusterGridConfig const& GetConfig() const { return mConfig; }
+    ClusterStats const&      GetStats() const  { return mStats;  }
+
+    uint32_t GetClusterIndex(uint32_t x, uint32_t y, uint32_t slice) const { return (slice * mConfig.TilesY + y) * mConfig.TilesX + x; }
+
+private:
+    // A light's view space bounding sphere and the clusters it can touch. MinZ > MaxZ when off screen.
+    struct LightBounds
+    {
+        float    Center[3];
+        float    Radius;
+        uint16_t MinX, MaxX;
+        uint16_t MinY, MaxY;
+        uint16_t MinZ, MaxZ;
+    };
+
+    void FitGrid(ClusterView const& view);
+    void ComputeBounds(ClusterView const& view, uint32_t begin, uint32_t end);
+    void BinSlice(uint32_t slice);
+    uint32_t GetSlice(float viewZ) const;
+
+    ClusterGridConfig       mConfig;
+    GPUTable<ClusterLight>  mLights;
+
+    // Froxel bounds in view space. X and Y only depend on the slice and their own tile, so the
+    // full box is never stored. X rows are padded to a multiple of 4 with boxes nothing can touch.
+    uint32_t                mPaddedTilesX;
+    std::vector<float>      mTileMinX;      // [slice * mPaddedTilesX + x]
+    std::vector<float>      mTileMaxX;
+    std::vector<float>      mTileMinY;      // [slice * TilesY + y]
+    std::vector<float>      mTileMaxY;
+    std::vector<float>      mSliceMinZ;
+    std::vector<float>      mSliceMaxZ;
+    float                   mFittedTo[4];   // ProjScaleX, ProjScaleY, Near, Far
+    float                   mSliceScale;
+    float                   mSliceBias;
+
+    // Rebuilt every frame
+    std::vector<LightBounds>            mBounds;
+    std::vector<uint32_t>               mSliceLightOffsets;     // Slices + 1 entries into mSliceLights
+    std::vector<uint32_t>               mSliceLights;
+    std::vector<uint32_t>               mSliceBase;             // Fill cursors, then each slice's first index
+    std::vector<std::vector<uint32_t>>  mSliceHits;             // (local cluster << 16) | light, per slice
+    std::vector<std::vector<uint32_t>>  mSliceIndices;          // Sorted by cluster, per slice
+    std::vector<ClusterStats>           mSliceStats;
+    std::vector<ClusterRange>           mGrid;
+    std::vector<uint32_t>               mIndices;
+    ClusterStats                        mStats;
+
+public:
+    ClusteredLighting(ClusteredLighting const&)            = delete;
+    ClusteredLighting& operator=(ClusteredLighting const&) = delete;
+};
+
+}
+#endif
@@ -1,6 +1,7 @@
 #ifndef CONSTANTBUFFER_H
 #define CONSTANTBUFFER_H
 
+#include "CBufferWriter.h"
 #include "DXCore.h"
 #include "RenderingParams.h"
 
@@ -15,6 +16,7 @@ struct ConstantBufferBindPacket
     UINT          BindSlot;
     UINT          ShaderStage; // EASEL_SHADER_STAGE type
     BOOL          Stale;
+    BOOL          PartialUpdates; // DEFAULT usage, written a 16-byte range at a time through UpdateSubresource1
 };
 
 typedef void (*BindFunction)(ID3D11DeviceContext* context, UINT slot, ID3D11Buffer*const* cbuffer);
@@ -44,10 +46,36 @@ struct ConstantBufferUpdateManager
         cbp.BindSlot    = slot;
         cbp.Stale       = true;
         cbp.ShaderStage = (UINT)shaderStage;
+        cbp.PartialUpdates = false;
 
         *out_packet     = cbp;
     }
 
+    // For buffers filled through a CBufferWriter. Falls back to a regular dynamic buffer when the
+    // driver can't update part of a constant buffer.
+    static void PopulatePartial(UINT byteSize, UINT slot, EASEL_SHADER_STAGE shaderStage, ID3D11Device* device, ConstantBufferBindPacket* out_packet)
+    {
+        D3D11_FEATURE_DATA_D3D11_OPTIONS options = {};
+        const bool supported = SUCCEEDED(device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options))) && options.ConstantBufferPartialUpdate;
+        if (!supported)
+            return Populate(byteSize, slot, shaderStage, device, out_packet);
+
+        D3D11_BUFFER_DESC defaultDesc = {0};
+        defaultDesc.Usage = D3D11_USAGE_DEFAULT;
+        defaultDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        defaultDesc.ByteWidth = byteSize;
+
+        ConstantBufferBindPacket cbp;
+        COM_EXCEPT(device->CreateBuffer(&defaultDesc, nullptr, &cbp.Buffer));
+        cbp.ByteSize       = byteSize;
+        cbp.BindSlot       = slot;
+        cbp.Stale          = true;
+        cbp.ShaderStage    = (UINT)shaderStage;
+        cbp.PartialUpdates = true;
+
+        *out_packet        = cbp;
+    }
+
     static void Populate(UINT byteSize, UINT slot, EASEL_SHADER_STAGE shaderStage, ConstantBufferBindPacket* out_packet)
     {
 
@@ -64,6 +92,38 @@ struct ConstantBufferUpdateManager
         packet->Stale = false;
     }
 
+    // Uploads only what changed since the last upload. Needs the immediate context for partial updates,
+    // since UpdateSubresource1 on a deferred context copies the whole source anyway.
+    static void UploadDirty(ConstantBufferBindPacket* packet, CBufferWriter& writer, ID3D11DeviceContext* context)
+    {
+        if (!writer.IsDirty())
+            return;
+
+        ID3D11DeviceContext1* context1 = nullptr;
+        if (packet->PartialUpdates && SUCCEEDED(context->QueryInterface(__uuidof(ID3D11DeviceContext1), (void**)&context1)))
+        {
+            CBufferRange ranges[4];
+            const UINT rangeCount = writer.GetDirtyRanges(ranges, ARRAYSIZE(ranges), 1);
+            for (UINT i = 0; i != rangeCount; ++i)
+            {
+                const D3D11_BOX box = { ranges[i].Offset, 0, 0, ranges[i].Offset + ranges[i].Size, 1, 1 };
+                context1->UpdateSubresource1(packet->Buffer, 0, &box, writer.GetData() + ranges[i].Offset, 0, 0, 0);
+            }
+            context1->Release();
+        }
+        else if (packet->PartialUpdates)
+        {
+            context->UpdateSubresource(packet->Buffer, 0, nullptr, writer.GetData(), 0, 0);
+        }
+        else
+        {
+            MapUnmap(packet, (void*)writer.GetData(), context);
+        }
+
+        writer.ClearDirty();
+        packet->Stale = false;
+    }
+
     static void Bind(ConstantBufferBindPacket* packet, ID3D11DeviceContext* context)
     {
         kBindFunctions[packet->ShaderStage](context, packet->BindSlot, &packet->Buffer);
@@ -0,0 +1,147 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of D3D11StreamingDevice.h
+----------------------------------------------*/
+#include "D3D11StreamingDevice.h"
+
+#include "ThrowMacros.h"
+
+#include <algorithm>
+#include <assert.h>
+
+namespace Renderer {
+
+namespace {
+
+UINT GetRowPitch(DDSFormat format, uint32_t width)
+{
+    if (IsBlockCompressed(format))
+        return ((width + 3) / 4) * GetDDSElementSize(format);
+
+    return width * GetDDSElementSize(format);
+}
+
+}
+
+D3D11StreamingDevice::D3D11StreamingDevice(ID3D11Device* pDevice, ID3D11DeviceContext* pContext) :
+    mpDevice(pDevice),
+    mpContext(pContext)
+{
+}
+
+D3D11StreamingDevice::~D3D11StreamingDevice()
+{
+    for (Slot& slot : mSlots)
+    {
+        if (slot.SRV)
+            slot.SRV->Release();
+        if (slot.Texture)
+            slot.Texture->Release();
+    }
+}
+
+TextureHandle D3D11StreamingDevice::CreateTexture(DDSDesc const& desc, uint32_t firstMip, const void* pInitialData)
+{
+    Slot slot = {};
+    slot.Desc           = desc;
+    slot.Desc.Width     = std::max(desc.Width >> firstMip, 1u);
+    slot.Desc.Height    = std::max(desc.Height >> firstMip, 1u);
+    slot.Desc.MipCount  = desc.MipCount - firstMip;
+    slot.Desc.ArraySize = 1;
+
+    D3D11_TEXTURE2D_DESC texDesc = {};
+    texDesc.Width              = slot.Desc.Width;
+    texDesc.Height             = slot.Desc.Height;
+    texDesc.MipLevels          = slot.Desc.MipCount;
+    texDesc.ArraySize          = 1;
+    texDesc.Format             = (DXGI_FORMAT)desc.Format;
+    texDesc.SampleDesc.Count   = 1;
+    texDesc.Usage              = D3D11_USAGE_DEFAULT;
+    texDesc.BindFlags          = D3D11_BIND_SHADER_RESOURCE;
+
+    // The mips sit back to back, largest first, exactly like the file
+    D3D11_SUBRESOURCE_DATA initialData[kMaxStreamedMips] = {};
+    if (pInitialData)
+    {
+        const uint8_t* pBytes = (const uint8_t*)pInitialData;
+        for (uint32_t mip = 0; mip != slot.Desc.MipCount; ++mip)
+        {
+            const uint32_t width  = std::max(slot.Desc.Width >> mip, 1u);
+            const uint32_t height = std::max(slot.Desc.Height >> mip, 1u);
+
+            initialData[mip].pSysMem          = pBytes;
+            initialData[mip].SysMemPitch      = GetRowPitch(desc.Format, width);
+            initialData[mip].SysMemSlicePitch = GetDDSSurfaceSize(desc.Format, width, height);
+            pBytes += initialData[mip].SysMemSlicePitch;
+        }
+    }
+
+    COM_EXCEPT(mpDevice->CreateTexture2D(&texDesc, pInitialData ? initialData : nullptr, &slot.Texture));
+    COM_EXCEPT(mpDevice->CreateShaderResourceView(slot.Texture, nullptr, &slot.SRV));
+
+    TextureHandle handle;
+    if (!mFreeHandles.empty())
+    {
+        handle = mFreeHandles.back();
+        mFreeHandles.pop_back();
+        mSlots[handle - 1] = slot;
+    }
+    else
+    {
+        mSlots.push_back(slot);
+        handle = (TextureHandle)mSlots.size();
+    }
+
+    return handle;
+}
+
+void D3D11StreamingDevice::DestroyTexture(TextureHandle texture)
+{
+    if (texture == kInvalidBackendHandle || texture > mSlots.size())
+        return;
+
+    // Anything still bound keeps its own reference until it is unbound
+    Slot& slot = mSlots[texture - 1];
+    if (slot.SRV)
+        slot.SRV->Release();
+    if (slot.Texture)
+        slot.Texture->Release();
+
+    slot = Slot();
+    mFreeHandles.push_back(texture);
+}
+
+void D3D11StreamingDevice::UploadMip(TextureHandle texture, uint32_t mip, const void* pData, uint32_t byteSize)
+{
+    (void)byteSize;
+    Slot const& slot = mSlots[texture - 1];
+    assert(mip < slot.Desc.MipCount);
+    assert(byteSize == GetDDSSurfaceSize(slot.Desc.Format, std::max(slot.Desc.Width >> mip, 1u), std::max(slot.Desc.Height >> mip, 1u)));
+
+    const UINT rowPitch = GetRowPitch(slot.Desc.Format, std::max(slot.Desc.Width >> mip, 1u));
+    mpContext->UpdateSubresource(slot.Texture, D3D11CalcSubresource(mip, 0, slot.Desc.MipCount), nullptr, pData, rowPitch, 0);
+}
+
+void D3D11StreamingDevice::CopyMips(TextureHandle dst, uint32_t dstMip, TextureHandle src, uint32_t srcMip, uint32_t mipCount)
+{
+    Slot const& dstSlot = mSlots[dst - 1];
+    Slot const& srcSlot = mSlots[src - 1];
+
+    for (uint32_t i = 0; i != mipCount; ++i)
+    {
+        mpContext->CopySubresourceRegion(
+            dstSlot.Texture, D3D11CalcSubresource(dstMip + i, 0, dstSlot.Desc.MipCount), 0, 0, 0,
+            srcSlot.Texture, D3D11CalcSubresource(srcMip + i, 0, srcSlot.Desc.MipCount), nullptr);
+    }
+}
+
+ID3D11ShaderResourceView* D3D11StreamingDevice::GetSRV(TextureHandle texture) const
+{
+    if (texture == kInvalidBackendHandle || texture > mSlots.size())
+        return nullptr;
+
+    return mSlots[texture - 1].SRV;
+}
+
+}
@@ -0,0 +1,52 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : D3D11 side of the TextureStreamer
+Owns a texture and SRV per handle. Uploads and copies go through the immediate context,
+so this is only used from the thread that owns it.
+----------------------------------------------*/
+#ifndef MUON_D3D11STREAMINGDEVICE_H
+#define MUON_D3D11STREAMINGDEVICE_H
+
+#include "DXCore.h"
+#include "TextureStreamer.h"
+
+#include <vector>
+
+namespace Renderer {
+
+class D3D11StreamingDevice final : public IStreamingDevice
+{
+public:
+    D3D11StreamingDevice(ID3D11Device* pDevice, ID3D11DeviceContext* pContext);
+    ~D3D11StreamingDevice();
+
+    TextureHandle CreateTexture(DDSDesc const& desc, uint32_t firstMip, const void* pInitialData) override;
+    void          DestroyTexture(TextureHandle texture) override;
+    void          UploadMip(TextureHandle texture, uint32_t mip, const void* pData, uint32_t byteSize) override;
+    void          CopyMips(TextureHandle dst, uint32_t dstMip, TextureHandle src, uint32_t srcMip, uint32_t mipCount) override;
+
+    // Not AddRef'd; it goes away with the texture
+    ID3D11ShaderResourceView* GetSRV(TextureHandle texture) const;
+
+private:
+    struct Slot
+    {
+        ID3D11Texture2D*          Texture;
+        ID3D11ShaderResourceView* SRV;
+        DDSDesc                   Desc;       // Of the texture as created, not the file
+    };
+
+    ID3D11Device*        mpDevice;
+    ID3D11DeviceContext* mpContext;
+
+    std::vector<Slot>          mSlots;     // Index is handle - 1
+    std::vector<TextureHandle> mFreeHandles;
+
+public:
+    D3D11StreamingDevice(D3D11StreamingDevice const&)            = delete;
+    D3D11StreamingDevice& operator=(D3D11StreamingDevice const&) = delete;
+};
+
+}
+#endif
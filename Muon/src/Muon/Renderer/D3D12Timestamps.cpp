@@ -0,0 +1,173 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of D3D12Timestamps.h
+----------------------------------------------*/
+#include <Muon.h>
+#include <Muon/Core/Profiler.h>
+#include <Muon/Renderer/D3D12Timestamps.h>
+
+#include <assert.h>
+#include <string.h>
+#include <utility>
+
+namespace Renderer {
+
+D3D12Timestamps::D3D12Timestamps() :
+    mpDevice(nullptr),
+    mpQueue(nullptr),
+    mpFence(nullptr),
+    mpList(nullptr),
+    mFrameFence(0),
+    mFrequency(0)
+{
+}
+
+D3D12Timestamps::~D3D12Timestamps()
+{
+    Shutdown();
+}
+
+bool D3D12Timestamps::Init(ID3D12Device* pDevice, ID3D12CommandQueue* pQueue, ID3D12Fence* pFence)
+{
+    assert(pDevice && pQueue && pFence);
+
+    UINT64 frequency = 0;
+    if (FAILED(pQueue->GetTimestampFrequency(&frequency)))
+        return false;
+
+    mpDevice = pDevice;
+    mpQueue = pQueue;
+    mpFence = pFence;
+    mFrequency = frequency;
+    return true;
+}
+
+void D3D12Timestamps::Shutdown()
+{
+    for (Heap& heap : mHeaps)
+    {
+        if (heap.Readback)
+            heap.Readback->Release();
+        if (heap.Queries)
+            heap.Queries->Release();
+    }
+
+    mHeaps.clear();
+    mFreeHandles.clear();
+    mpList = nullptr;
+}
+
+void D3D12Timestamps::WriteTimestamp(QueryHeapHandle heap, uint32_t index)
+{
+    assert(mpList && "D3D12Timestamps: no command list to record into");
+    assert(heap != kInvalidBackendHandle && index < mHeaps[heap - 1].ResolvedAt.size());
+    mpList->EndQuery(mHeaps[heap - 1].Queries, D3D12_QUERY_TYPE_TIMESTAMP, index);
+}
+
+QueryHeapHandle D3D12Timestamps::CreateTimestampHeap(uint32_t count)
+{
+    assert(mpDevice && count != 0);
+
+    Heap heap = {};
+
+    D3D12_QUERY_HEAP_DESC heapDesc = {};
+    heapDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+    heapDesc.Count = count;
+    if (FAILED(mpDevice->CreateQueryHeap(&heapDesc, IID_PPV_ARGS(&heap.Queries))))
+        return kInvalidBackendHandle;
+
+    // Readback buffers stay in COPY_DEST for their whole life
+    CD3DX12_HEAP_PROPERTIES readbackHeap(D3D12_HEAP_TYPE_READBACK);
+    CD3DX12_RESOURCE_DESC readbackDesc = CD3DX12_RESOURCE_DESC::Buffer(count * sizeof(UINT64));
+    if (FAILED(mpDevice->CreateCommittedResource(&readbackHeap, D3D12_HEAP_FLAG_NONE, &readbackDesc,
+        D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&heap.Readback))))
+    {
+        heap.Queries->Release();
+        return kInvalidBackendHandle;
+    }
+
+    heap.ResolvedAt.assign(count, 0);
+
+    if (!mFreeHandles.empty())
+    {
+        const QueryHeapHandle handle = mFreeHandles.back();
+        mFreeHandles.pop_back();
+        mHeaps[handle - 1] = std::move(heap);
+        return handle;
+    }
+
+    mHeaps.push_back(std::move(heap));
+    return (QueryHeapHandle)mHeaps.size();
+}
+
+void D3D12Timestamps::DestroyTimestampHeap(QueryHeapHandle handle)
+{
+    if (handle == kInvalidBackendHandle || handle > mHeaps.size())
+        return;
+
+    // Nothing still in flight may resolve into it
+    Heap& heap = mHeaps[handle - 1];
+    if (heap.Readback)
+        heap.Readback->Release();
+    if (heap.Queries)
+        heap.Queries->Release();
+
+    heap = Heap();
+    mFreeHandles.push_back(handle);
+}
+
+void D3D12Timestamps::ResolveTimestamps(QueryHeapHandle handle, uint32_t first, uint32_t count)
+{
+    assert(mpList && "D3D12Timestamps: no command list to record into");
+    Heap& heap = mHeaps[handle - 1];
+    assert((uint64_t)first + count <= heap.ResolvedAt.size() && "D3D12Timestamps: resolve past the end of the heap");
+
+    mpList->ResolveQueryData(heap.Queries, D3D12_QUERY_TYPE_TIMESTAMP, first, count, heap.Readback, first * sizeof(UINT64));
+
+    for (uint32_t i = first; i != first + count; ++i)
+        heap.ResolvedAt[i] = mFrameFence;
+}
+
+bool D3D12Timestamps::ReadTimestamps(QueryHeapHandle handle, uint32_t first, uint32_t count, uint64_t* out_ticks)
+{
+    Heap const& heap = mHeaps[handle - 1];
+    assert((uint64_t)first + count <= heap.ResolvedAt.size());
+
+    const uint64_t completed = mpFence->GetCompletedValue();
+    for (uint32_t i = first; i != first + count; ++i)
+    {
+        if (!heap.ResolvedAt[i] || heap.ResolvedAt[i] > completed)
+            return false;
+    }
+
+    UINT64* pTicks = nullptr;
+    const D3D12_RANGE readRange = { first * sizeof(UINT64), (first + count) * sizeof(UINT64) };
+    if (FAILED(heap.Readback->Map(0, &readRange, reinterpret_cast<void**>(&pTicks))))
+        return false;
+
+    memcpy(out_ticks, pTicks + first, count * sizeof(uint64_t));
+
+    const D3D12_RANGE writeRange = { 0, 0 };
+    heap.Readback->Unmap(0, &writeRange);
+    return true;
+}
+
+void D3D12Timestamps::GetClockCalibration(uint64_t& out_gpuTicks, uint64_t& out_cpuNs)
+{
+    // Keeps whatever pairing the caller had rather than hand it a broken one
+    UINT64 calibrationTicks = 0, calibrationQPC = 0;
+    if (FAILED(mpQueue->GetClockCalibration(&calibrationTicks, &calibrationQPC)))
+        return;
+
+    // The queue pairs its clock with QPC; step that back onto the profiler's clock
+    LARGE_INTEGER qpcNow, qpcFrequency;
+    const uint64_t nowNs = Core::Profiler::Now();
+    QueryPerformanceCounter(&qpcNow);
+    QueryPerformanceFrequency(&qpcFrequency);
+
+    out_gpuTicks = calibrationTicks;
+    out_cpuNs = nowNs - (uint64_t)((double)(qpcNow.QuadPart - (LONGLONG)calibrationQPC) * 1e9 / (double)qpcFrequency.QuadPart);
+}
+
+}
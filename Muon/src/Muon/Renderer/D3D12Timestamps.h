@@ -0,0 +1,72 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : D3D12 side of the GPUProfiler
+Each heap is a timestamp query heap with a readback buffer of its own. Timestamps
+and resolves go into whichever command list was set last. A resolve is readable
+once the queue's fence passes the value the frame it was recorded in will signal,
+which is checked, never waited on.
+----------------------------------------------*/
+#ifndef MUON_D3D12TIMESTAMPS_H
+#define MUON_D3D12TIMESTAMPS_H
+
+#include "RenderBackend.h"
+
+#include <d3dx12.h>
+#include <d3d12.h>
+
+#include <vector>
+
+namespace Renderer {
+
+class D3D12Timestamps final : public ITimestampDevice
+{
+public:
+    D3D12Timestamps();
+    ~D3D12Timestamps();
+
+    // None of these are AddRef'd and all must outlive it
+    bool Init(ID3D12Device* pDevice, ID3D12CommandQueue* pQueue, ID3D12Fence* pFence);
+    void Shutdown();
+
+    // Where timestamps and resolves are recorded from here on
+    void SetCommandList(ID3D12GraphicsCommandList* pList) { mpList = pList; }
+
+    // The fence value the queue signals once the frame being recorded is done
+    void SetFrameFence(uint64_t fenceValue) { mFrameFence = fenceValue; }
+
+    void WriteTimestamp(QueryHeapHandle heap, uint32_t index) override;
+
+    QueryHeapHandle CreateTimestampHeap(uint32_t count) override;
+    void            DestroyTimestampHeap(QueryHeapHandle heap) override;
+
+    void     ResolveTimestamps(QueryHeapHandle heap, uint32_t first, uint32_t count) override;
+    bool     ReadTimestamps(QueryHeapHandle heap, uint32_t first, uint32_t count, uint64_t* out_ticks) override;
+    uint64_t GetTimestampFrequency() const override { return mFrequency; }
+    void     GetClockCalibration(uint64_t& out_gpuTicks, uint64_t& out_cpuNs) override;
+
+private:
+    struct Heap
+    {
+        ID3D12QueryHeap*      Queries;
+        ID3D12Resource*       Readback;
+        std::vector<uint64_t> ResolvedAt;   // Fence value each query's last resolve completes at, 0 if never resolved
+    };
+
+    ID3D12Device*              mpDevice;
+    ID3D12CommandQueue*        mpQueue;
+    ID3D12Fence*               mpFence;
+    ID3D12GraphicsCommandList* mpList;
+    uint64_t                   mFrameFence;
+    uint64_t                   mFrequency;
+
+    std::vector<Heap>            mHeaps;     // Index is handle - 1
+    std::vector<QueryHeapHandle> mFreeHandles;
+
+public:
+    D3D12Timestamps(D3D12Timestamps const&)            = delete;
+    D3D12Timestamps& operator=(D3D12Timestamps const&) = delete;
+};
+
+}
+#endif
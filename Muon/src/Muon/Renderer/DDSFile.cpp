@@ -0,0 +1,177 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of DDSFile.h
+----------------------------------------------*/
+#include "DDSFile.h"
+
+#include "ByteStream.h"
+
+#include <algorithm>
+
+namespace Renderer {
+
+namespace {
+
+const uint32_t kDDSMagic            = 0x20534444; // "DDS "
+const uint32_t kDX10FourCC          = 0x30315844; // "DX10"
+
+const uint32_t kHeaderCaps          = 0x1;
+const uint32_t kHeaderHeight        = 0x2;
+const uint32_t kHeaderWidth         = 0x4;
+const uint32_t kHeaderPitch         = 0x8;
+const uint32_t kHeaderPixelFormat   = 0x1000;
+const uint32_t kHeaderMipCount      = 0x20000;
+const uint32_t kHeaderLinearSize    = 0x80000;
+
+const uint32_t kPixelFormatFourCC   = 0x4;
+
+const uint32_t kCapsComplex         = 0x8;
+const uint32_t kCapsTexture         = 0x1000;
+const uint32_t kCapsMipMap          = 0x400000;
+
+const uint32_t kDimensionTexture2D  = 3;
+const uint32_t kMiscTextureCube     = 0x4;
+
+}
+
+bool IsBlockCompressed(DDSFormat format)
+{
+    return format >= DDSFormat::BC1_UNORM;
+}
+
+uint32_t GetDDSElementSize(DDSFormat format)
+{
+    switch (format)
+    {
+    case DDSFormat::R8G8B8A8_UNORM:
+    case DDSFormat::R8G8B8A8_UNORM_SRGB: return 4;
+    case DDSFormat::R8G8_UNORM:          return 2;
+    case DDSFormat::R8_UNORM:            return 1;
+    case DDSFormat::BC1_UNORM:
+    case DDSFormat::BC1_UNORM_SRGB:
+    case DDSFormat::BC4_UNORM:           return 8;
+    case DDSFormat::BC3_UNORM:
+    case DDSFormat::BC3_UNORM_SRGB:
+    case DDSFormat::BC5_UNORM:
+    case DDSFormat::BC7_UNORM:
+    case DDSFormat::BC7_UNORM_SRGB:      return 16;
+    default:                             return 0;
+    }
+}
+
+uint32_t GetDDSSurfaceSize(DDSFormat format, uint32_t width, uint32_t height)
+{
+    if (IsBlockCompressed(format))
+        return ((width + 3) / 4) * ((height + 3) / 4) * GetDDSElementSize(format);
+
+    return width * height * GetDDSElementSize(format);
+}
+
+const char* GetDDSFormatName(DDSFormat format)
+{
+    switch (format)
+    {
+    case DDSFormat::R8G8B8A8_UNORM:      return "RGBA8";
+    case DDSFormat::R8G8B8A8_UNORM_SRGB: return "RGBA8_SRGB";
+    case DDSFormat::R8G8_UNORM:          return "RG8";
+    case DDSFormat::R8_UNORM:            return "R8";
+    case DDSFormat::BC1_UNORM:           return "BC1";
+    case DDSFormat::BC1_UNORM_SRGB:      return "BC1_SRGB";
+    case DDSFormat::BC3_UNORM:           return "BC3";
+    case DDSFormat::BC3_UNORM_SRGB:      return "BC3_SRGB";
+    case DDSFormat::BC4_UNORM:           return "BC4";
+    case DDSFormat::BC5_UNORM:           return "BC5";
+    case DDSFormat::BC7_UNORM:           return "BC7";
+    case DDSFormat::BC7_UNORM_SRGB:      return "BC7_SRGB";
+    default:                             return "UNKNOWN";
+    }
+}
+
+void WriteDDSHeader(DDSDesc const& desc, std::vector<uint8_t>& out_bytes)
+{
+    ByteWriter w = { out_bytes };
+    const bool compressed = IsBlockCompressed(desc.Format);
+
+    w.U32(kDDSMagic);
+
+    // DDS_HEADER
+    w.U32(124);
+    w.U32(kHeaderCaps | kHeaderHeight | kHeaderWidth | kHeaderPixelFormat | kHeaderMipCount | (compressed ? kHeaderLinearSize : kHeaderPitch));
+    w.U32(desc.Height);
+    w.U32(desc.Width);
+    w.U32(compressed ? GetDDSSurfaceSize(desc.Format, desc.Width, desc.Height) : desc.Width * GetDDSElementSize(desc.Format));
+    w.U32(0);                   // Depth
+    w.U32(desc.MipCount);
+    for (uint32_t i = 0; i != 11; ++i)
+        w.U32(0);               // Reserved
+
+    // DDS_PIXELFORMAT, pointing at the DX10 header
+    w.U32(32);
+    w.U32(kPixelFormatFourCC);
+    w.U32(kDX10FourCC);
+    for (uint32_t i = 0; i != 5; ++i)
+        w.U32(0);               // Bit count and masks
+
+    w.U32(kCapsTexture | (desc.MipCount > 1 ? kCapsComplex | kCapsMipMap : 0));
+    w.U32(0);                   // Caps2
+    w.U32(0);
+    w.U32(0);
+    w.U32(0);                   // Reserved
+
+    // DDS_HEADER_DXT10
+    w.U32((uint32_t)desc.Format);
+    w.U32(kDimensionTexture2D);
+    w.U32(0);                   // Misc flags
+    w.U32(desc.ArraySize);
+    w.U32(0);                   // Alpha mode unknown
+}
+
+bool ParseDDSHeader(const uint8_t* pData, size_t size, DDSDesc& out_desc)
+{
+    ByteReader r = { pData, size, 0 };
+    if (!r.Has(kDDSHeaderSize) || r.U32() != kDDSMagic || r.U32() != 124)
+        return false;
+
+    r.U32();                    // Flags
+    const uint32_t height = r.U32();
+    const uint32_t width  = r.U32();
+    r.U32();                    // Pitch or linear size
+    const uint32_t depth  = r.U32();
+    const uint32_t mips   = r.U32();
+    r.Offset += 11 * 4;
+
+    r.U32();                    // Pixel format size
+    const uint32_t pfFlags  = r.U32();
+    const uint32_t fourCC   = r.U32();
+    r.Offset += 5 * 4 + 5 * 4;  // Masks, caps and reserved
+
+    if (!(pfFlags & kPixelFormatFourCC) || fourCC != kDX10FourCC || depth > 1)
+        return false;
+
+    const DDSFormat format    = (DDSFormat)r.U32();
+    const uint32_t  dimension = r.U32();
+    const uint32_t  miscFlags = r.U32();
+    const uint32_t  arraySize = r.U32();
+
+    if (dimension != kDimensionTexture2D || (miscFlags & kMiscTextureCube) || GetDDSElementSize(format) == 0 || width == 0 || height == 0)
+        return false;
+
+    out_desc.Width     = width;
+    out_desc.Height    = height;
+    out_desc.MipCount  = mips ? mips : 1;
+    out_desc.ArraySize = arraySize ? arraySize : 1;
+    out_desc.Format    = format;
+    return true;
+}
+
+uint64_t GetDDSMipOffset(DDSDesc const& desc, uint32_t mip)
+{
+    uint64_t offset = kDDSHeaderSize;
+    for (uint32_t m = 0; m != mip; ++m)
+        offset += GetDDSSurfaceSize(desc.Format, std::max(desc.Width >> m, 1u), std::max(desc.Height >> m, 1u));
+
+    return offset;
+}
+
+}
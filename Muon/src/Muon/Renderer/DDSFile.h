@@ -0,0 +1,66 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Minimal DDS support for textures cooked offline
+Always writes the DX10 extended header, which DirectX::CreateDDSTextureFromFile reads.
+Surfaces follow the header largest mip first, array slices one after another.
+----------------------------------------------*/
+#ifndef MUON_DDSFILE_H
+#define MUON_DDSFILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace Renderer {
+
+// Values match DXGI_FORMAT, so they can be handed straight to D3D
+enum class DDSFormat : uint32_t
+{
+    UNKNOWN             = 0,
+    R8G8B8A8_UNORM      = 28,
+    R8G8B8A8_UNORM_SRGB = 29,
+    R8G8_UNORM          = 49,
+    R8_UNORM            = 61,
+    BC1_UNORM           = 71,
+    BC1_UNORM_SRGB      = 72,
+    BC3_UNORM           = 77,
+    BC3_UNORM_SRGB      = 78,
+    BC4_UNORM           = 80,
+    BC5_UNORM           = 83,
+    BC7_UNORM           = 98,
+    BC7_UNORM_SRGB      = 99,
+};
+
+// Magic, DDS_HEADER and DDS_HEADER_DXT10, i.e. where the first surface starts
+static const uint32_t kDDSHeaderSize = 4 + 124 + 20;
+
+struct DDSDesc
+{
+    uint32_t  Width;
+    uint32_t  Height;
+    uint32_t  MipCount;
+    uint32_t  ArraySize;
+    DDSFormat Format;
+};
+
+bool        IsBlockCompressed(DDSFormat format);
+
+// Per 4x4 block for block compressed formats, per texel otherwise
+uint32_t    GetDDSElementSize(DDSFormat format);
+
+uint32_t    GetDDSSurfaceSize(DDSFormat format, uint32_t width, uint32_t height);
+const char* GetDDSFormatName(DDSFormat format);
+
+// Appends the magic, DDS_HEADER and DDS_HEADER_DXT10. The caller appends the surfaces.
+void        WriteDDSHeader(DDSDesc const& desc, std::vector<uint8_t>& out_bytes);
+
+// Reads back what WriteDDSHeader wrote. Fails on legacy headers, cube maps, volumes and formats
+// not listed above, which callers should hand to a general purpose loader instead.
+bool        ParseDDSHeader(const uint8_t* pData, size_t size, DDSDesc& out_desc);
+
+// Byte offset of a mip of array slice 0 from the start of the file
+uint64_t    GetDDSMipOffset(DDSDesc const& desc, uint32_t mip);
+
+}
+#endif
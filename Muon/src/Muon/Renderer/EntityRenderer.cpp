@@ -6,6 +6,7 @@ Description : Implementation of Renderer class
 #include "EntityRenderer.h"
 
 #include "Camera.h"
+#include "CascadedShadows.h"
 #include "CBufferStructs.h"
 #include "ConstantBuffer.h"
 #include "DeviceResources.h"
@@ -13,33 +14,153 @@ Description : Implementation of Renderer class
 #include "hash_util.h"
 #include "Material.h"
 #include "Mesh.h"
+#include "ParallelRecorder.h"
 #include "ResourceCodex.h"
 #include "Shader.h"
 #include "SkyRenderer.h"
 #include "ThrowMacros.h"
 
+#include <Muon/Core/JobSystem.h>
+#include <Muon/Core/Profiler.h>
+
 #if defined(MN_DEBUG)
 #include <typeinfo>
 #endif
 
+#include <algorithm>
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+#include <new>
 #include <random>
+#include <string.h>
 #include <time.h>
 
 namespace Renderer {
 
-EntityRenderer::EntityRenderer()
+EntityRenderer::EntityRenderer() :
+    EntityCount(0),
+    InstancingPasses(nullptr),
+    InstancingPassCount(0),
+    DrawItems(nullptr),
+    DrawItemCosts(nullptr),
+    DrawItemCount(0),
+    MaterialParamsCB{},
+    EntityCB{},
+    DeferredContexts{},
+    DeferredContextCount(0),
+    ShadowCasters(nullptr),
+    ShadowMasks(nullptr),
+    ShadowInstances(nullptr),
+    ShadowRanges(nullptr),
+    ShadowInstanceBuffer(nullptr),
+    ShadowVS(nullptr)
 {}
 
+namespace {
+
+// Passes are drawn in runs of at most this many instances, so even one pass can be split across contexts
+const UINT kInstancesPerDrawItem = 64;
+
+// Fewer instances than this per context isn't worth a command list and the state it has to rebind
+const UINT kMinInstancesPerContext = 128;
+
+// Deferred contexts start from default state. Everything the rest of the frame bound on the
+// immediate context before the entity draw is snapshotted here and replayed on each of them.
+struct InheritedContextState
+{
+    ID3D11Buffer*             VSConstantBuffers[D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT];
+    ID3D11Buffer*             PSConstantBuffers[D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT];
+    ID3D11ShaderResourceView* PSClusterResources[(UINT)PS_RESOURCES::CLUSTER_COUNT];
+    ID3D11ShaderResourceView* PSShadowMap;
+    ID3D11SamplerState*       PSSamplers[(UINT)PS_SAMPLERS::COUNT];
+    ID3D11RenderTargetView*   RenderTarget;
+    ID3D11DepthStencilView*   DepthStencil;
+    ID3D11RasterizerState*    RasterState;
+    ID3D11DepthStencilState*  DepthStencilState;
+    UINT                      StencilRef;
+    D3D11_VIEWPORT            Viewport;
+    UINT                      ViewportCount;
+};
+
+void CaptureContextState(ID3D11DeviceContext* context, InheritedContextState& out_state)
+{
+    context->VSGetConstantBuffers(0, D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT, out_state.VSConstantBuffers);
+    context->PSGetConstantBuffers(0, D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT, out_state.PSConstantBuffers);
+    context->PSGetShaderResources((UINT)PS_RESOURCES::CLUSTER_LIGHTS, (UINT)PS_RESOURCES::CLUSTER_COUNT, out_state.PSClusterResources);
+    context->PSGetShaderResources((UINT)PS_RESOURCES::SHADOW_MAP, 1, &out_state.PSShadowMap);
+    context->PSGetSamplers(0, (UINT)PS_SAMPLERS::COUNT, out_state.PSSamplers);
+    context->OMGetRenderTargets(1, &out_state.RenderTarget, &out_state.DepthStencil);
+    context->RSGetState(&out_state.RasterState);
+    context->OMGetDepthStencilState(&out_state.DepthStencilState, &out_state.StencilRef);
+
+    out_state.ViewportCount = 1;
+    context->RSGetViewports(&out_state.ViewportCount, &out_state.Viewport);
+}
+
+void ApplyContextState(ID3D11DeviceContext* context, InheritedContextState const& state)
+{
+    context->VSSetConstantBuffers(0, D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT, state.VSConstantBuffers);
+    context->PSSetConstantBuffers(0, D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT, state.PSConstantBuffers);
+    context->PSSetShaderResources((UINT)PS_RESOURCES::CLUSTER_LIGHTS, (UINT)PS_RESOURCES::CLUSTER_COUNT, state.PSClusterResources);
+    context->PSSetShaderResources((UINT)PS_RESOURCES::SHADOW_MAP, 1, &state.PSShadowMap);
+    context->PSSetSamplers(0, (UINT)PS_SAMPLERS::COUNT, state.PSSamplers);
+    context->OMSetRenderTargets(1, &state.RenderTarget, state.DepthStencil);
+    context->RSSetState(state.RasterState);
+    context->OMSetDepthStencilState(state.DepthStencilState, state.StencilRef);
+    context->RSSetViewports(state.ViewportCount, &state.Viewport);
+    context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+}
+
+template<typename T>
+void SafeRelease(T*& p)
+{
+    if (p)
+        p->Release();
+    p = nullptr;
+}
+
+void ReleaseContextState(InheritedContextState& state)
+{
+    for (ID3D11Buffer*& buffer : state.VSConstantBuffers)
+        SafeRelease(buffer);
+    for (ID3D11Buffer*& buffer : state.PSConstantBuffers)
+        SafeRelease(buffer);
+    for (ID3D11ShaderResourceView*& resource : state.PSClusterResources)
+        SafeRelease(resource);
+    for (ID3D11SamplerState*& sampler : state.PSSamplers)
+        SafeRelease(sampler);
+
+    SafeRelease(state.PSShadowMap);
+    SafeRelease(state.RenderTarget);
+    SafeRelease(state.DepthStencil);
+    SafeRelease(state.RasterState);
+    SafeRelease(state.DepthStencilState);
+}
+
+}
+
 void EntityRenderer::Init(DeviceResources const& dr)
 {
     // Grab reference to d3d11 device and context
     auto device = dr.GetDevice();
     auto context = dr.GetContext();
 
+    const size_t kEntityArenaSize = 1 << 20;
+    EntityArena.Init(kEntityArenaSize, Memory::MemoryTag::ENTITIES);
+
     // Initialize meshes, materials, entities
     InitMeshes(dr);
     InitEntities();
     InitDrawContexts(device);
+
+    // Creating deferred contexts can fail on drivers without command list support; we just record inline then
+    for (UINT i = 0; i != kMaxDeferredContexts; ++i)
+    {
+        if (FAILED(device->CreateDeferredContext(0, &DeferredContexts[DeferredContextCount])))
+            break;
+        DeferredContextCount++;
+    }
     
     // For now, assume we're only using trianglelist
     context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
@@ -58,18 +179,21 @@ void EntityRenderer::InitMeshes(DeviceResources const& dr)
 
     ResourceCodex const& sg_Codex = ResourceCodex::GetSingleton();
 
-    const ShaderID kInstancedPhongVSID = 0xc8a366aa; // FNV1A of L"InstancedPhongVS.cso"
-    const ShaderID kPhongPSID = 0x4dc6e249;          // FNV1A of L"PhongPS.cso"
-    const ShaderID kPhongPSNormalMapID = fnv1a(L"Phong_NormalMapPS.cso");
+    const ShaderID kPhongVSID = fnv1a(L"PhongVS");
+    const ShaderID kPhongPSID = fnv1a(L"PhongPS");
 
-    const VertexShader* instancedPhongVS = sg_Codex.GetVertexShader(kInstancedPhongVSID);
+    // The materials already pulled in the instanced variant, compiling it if it had to
+    const VertexShader* instancedPhongVS = sg_Codex.GetVertexShader(kPhongVSID, ToVariantKey(ShaderFeature::INSTANCED));
     const PixelShader*  PhongPS = sg_Codex.GetPixelShader(kPhongPSID);
 
     const VertexBufferDescription* phongVertDesc = &instancedPhongVS->VertexDesc;
     const MeshID sphereID = ResourceCodex::AddMeshFromFile("sphere.obj", phongVertDesc, device);
     const MeshID cubeID = ResourceCodex::AddMeshFromFile("cube.obj", phongVertDesc, device);
+
+    // Shadow casters only need positions, so they reuse the instanced vertex shader with no pixel shader
+    ShadowVS = instancedPhongVS;
     
-    dr.GetContext()->PSSetSamplers(0, 1, &PhongPS->SamplerState);
+    dr.GetContext()->PSSetSamplers((UINT)PS_SAMPLERS::MATERIAL, 1, &PhongPS->SamplerState);
 }
 
 void EntityRenderer::InitEntities()
@@ -80,10 +204,9 @@ void EntityRenderer::InitEntities()
     const UINT kNumEntities = width * height;
     EntityCount = kNumEntities;
 
-    Entities = (Entity*)malloc(sizeof(Entity) * kNumEntities);
+    Entities.Init(kNumEntities);
     MeshID cubeMeshId = fnv1a(L"cube.obj");
 
-    UINT entityIdx = 0;
     for (UINT i = 0; i != width; ++i)
     {
         for (UINT j = 0; j != height; ++j)
@@ -91,12 +214,11 @@ void EntityRenderer::InitEntities()
             Core::Transform tfm;
             tfm.SetTranslation((float)i, 0.0f, (float)j);
 
-            Entity test;
+            MeshInstance test;
             test.MaterialIndex = i == 0 && j == 0 ? MI_WIREFRAME : MI_LUNAR; 
-            test.mMeshID = cubeMeshId;
-            test.mTransform = tfm;
+            test.Mesh = cubeMeshId;
 
-            Entities[entityIdx++] = test;
+            Entities.CreateWith(tfm, test);
         }
     }
 }
@@ -106,12 +228,18 @@ void EntityRenderer::InitDrawContexts(ID3D11Device* device)
     const UINT kInstancingPassCount = 1;
 
     InstancingPassCount = kInstancingPassCount;
-    InstancingPasses = new InstancedDrawContext[kInstancingPassCount];
+    InstancingPasses = EntityArena.AllocArray<InstancedDrawContext>(kInstancingPassCount);
+    for (UINT i = 0; i != kInstancingPassCount; ++i)
+        new (&InstancingPasses[i]) InstancedDrawContext();
 
     InstancedDrawContext& cubeDraw = InstancingPasses[0];
     cubeDraw.InstanceCount   = EntityCount;
-    cubeDraw.WorldMatrices   = (DirectX::XMFLOAT4X4*)malloc(sizeof(DirectX::XMFLOAT4X4) * cubeDraw.InstanceCount);
-    cubeDraw.InstancedMeshID = Entities[0].mMeshID;
+    cubeDraw.WorldMatrices   = EntityArena.AllocArray<DirectX::XMFLOAT4X4>(cubeDraw.InstanceCount);
+    Entities.ForEachChunk(Core::GetComponentMask<MeshInstance>(), [&cubeDraw](Core::ChunkView const& chunk, uint32_t firstIndex)
+    {
+        if (firstIndex == 0)
+            cubeDraw.InstancedMeshID = chunk.Get<MeshInstance>()[0].Mesh;
+    });
     cubeDraw.MaterialIndex   = MI_LUNAR;
 
     static const bool DRAW_WIREFRAME = true;
@@ -129,25 +257,62 @@ void EntityRenderer::InitDrawContexts(ID3D11Device* device)
     dynamicDesc.StructureByteStride = 0;
     dynamicDesc.ByteWidth = sizeof(DirectX::XMFLOAT4X4) * cubeDraw.InstanceCount;
     COM_EXCEPT(device->CreateBuffer(&dynamicDesc, nullptr, &cubeDraw.DynamicBuffer));
+
+    // Cut every pass into runs of instances, in pass order
+    UINT itemCount = 0;
+    for (UINT p = 0; p != InstancingPassCount; ++p)
+        itemCount += (InstancingPasses[p].InstanceCount + kInstancesPerDrawItem - 1) / kInstancesPerDrawItem;
+
+    DrawItemCount = itemCount;
+    DrawItems     = EntityArena.AllocArray<DrawItem>(itemCount);
+    DrawItemCosts = EntityArena.AllocArray<uint32_t>(itemCount);
+
+    UINT item = 0;
+    for (UINT p = 0; p != InstancingPassCount; ++p)
+    {
+        for (UINT first = 0; first < InstancingPasses[p].InstanceCount; first += kInstancesPerDrawItem, ++item)
+        {
+            DrawItems[item] = { p, first, std::min(kInstancesPerDrawItem, InstancingPasses[p].InstanceCount - first) };
+            DrawItemCosts[item] = DrawItems[item].InstanceCount;
+        }
+    }
+
+    // An instance can land in every cascade at once
+    ShadowCasters   = EntityArena.AllocArray<ShadowCaster>(EntityCount);
+    ShadowMasks     = EntityArena.AllocArray<uint8_t>(EntityCount);
+    ShadowInstances = EntityArena.AllocArray<DirectX::XMFLOAT4X4>(EntityCount * kMaxShadowCascades);
+    ShadowRanges    = EntityArena.AllocArray<ShadowRange>(InstancingPassCount * kMaxShadowCascades);
+    memset(ShadowRanges, 0, sizeof(ShadowRange) * InstancingPassCount * kMaxShadowCascades);
+
+    dynamicDesc.ByteWidth = sizeof(DirectX::XMFLOAT4X4) * EntityCount * kMaxShadowCascades;
+    COM_EXCEPT(device->CreateBuffer(&dynamicDesc, nullptr, &ShadowInstanceBuffer));
 }
 
-void EntityRenderer::Update(ID3D11DeviceContext* context, float dt)
+void EntityRenderer::Simulate(float dt)
 {
-    using namespace DirectX;
-    using Core::Transform;
+    MN_PROFILE_FUNCTION();
 
-    const float rotSpeed = 1.25f;
+    // Nothing moves the entities yet. Whatever does should step them by dt after this.
+    (void)dt;
+    Entities.ForEach<Core::Transform>([](Core::Transform& transform) { transform.StoreState(); });
+}
 
-    static const XMVECTOR rot1 = DirectX::XMQuaternionRotationRollPitchYaw(rotSpeed, -rotSpeed, rotSpeed);
-    static const XMVECTOR rot2 = -rot1;
+void EntityRenderer::Update(ID3D11DeviceContext* context, float alpha)
+{
+    MN_PROFILE_FUNCTION();
+
+    using namespace DirectX;
+    using Core::Transform;
 
     InstancedDrawContext& lunarDraw = InstancingPasses[0];
 
-    for (UINT i = 0; i != EntityCount; ++i)
+    // Instances go in the order the world walks its entities
+    Entities.ParallelForEachChunk(Core::GetComponentMask<Transform>(), 1, [&lunarDraw, alpha](Core::ChunkView const& chunk, uint32_t firstIndex)
     {
-        Transform* tfm = &Entities[i].mTransform;
-        lunarDraw.WorldMatrices[i] = tfm->Recompute();
-    }
+        Transform* transforms = chunk.Get<Transform>();
+        for (uint32_t i = 0; i != chunk.GetCount(); ++i)
+            lunarDraw.WorldMatrices[firstIndex + i] = transforms[i].Interpolate(alpha);
+    });
 
     // Rewrite the dynamic vertex buffer
     D3D11_MAPPED_SUBRESOURCE mappedBuffer;
@@ -156,90 +321,311 @@ void EntityRenderer::Update(ID3D11DeviceContext* context, float dt)
     context->Unmap(lunarDraw.DynamicBuffer, 0);
 }
 
-void EntityRenderer::Draw(ID3D11DeviceContext* context)
+void EntityRenderer::RequestTextureMips(Camera const& camera, float viewportHeight)
 {
-    this->InstancedDraw(context);
+    using namespace DirectX;
+
+    ResourceCodex& codex = ResourceCodex::GetSingleton();
+    const XMMATRIX view = camera.GetView();
+
+    // Pixels a unit-sized object covers at unit depth
+    XMFLOAT4X4 projection;
+    XMStoreFloat4x4(&projection, camera.GetProjection());
+    const float pixelsPerUnit = projection._22 * 0.5f * viewportHeight;
+
+    for (UINT p = 0; p != InstancingPassCount; ++p)
+    {
+        InstancedDrawContext const& pass = InstancingPasses[p];
+
+        // The closest instance decides how sharp the material has to be
+        float largest = 0.0f;
+        for (UINT i = 0; i != pass.InstanceCount; ++i)
+        {
+            XMFLOAT4X4 const& world = pass.WorldMatrices[i];
+            const XMVECTOR center = XMVectorSet(world._41, world._42, world._43, 1.0f);
+            const float radius = sqrtf(world._11 * world._11 + world._12 * world._12 + world._13 * world._13) * 0.8660254f; // Unit cube
+            const float depth = XMVectorGetZ(XMVector3TransformCoord(center, view));
+            if (depth + radius <= 0.0f)
+                continue;
+
+            largest = std::max(largest, 2.0f * radius * pixelsPerUnit / std::max(depth, radius));
+        }
+
+        codex.RequestMaterialMips((uint8_t)pass.MaterialIndex, largest);
+    }
 }
 
-void EntityRenderer::InstancedDraw(ID3D11DeviceContext* context)
+void EntityRenderer::CullShadowCasters(ID3D11DeviceContext* context, CascadedShadows const& shadows)
 {
-    ResourceCodex const& sg_Codex = ResourceCodex::GetSingleton();
+    MN_PROFILE_FUNCTION();
 
-    InstancedDrawContext* drawCtx = InstancingPasses; 
-    InstancedDrawContext* const drawCtxItEnd = InstancingPasses + InstancingPassCount;
-    for (; drawCtx != drawCtxItEnd; ++drawCtx)
+    UINT casterCount = 0;
+    for (UINT p = 0; p != InstancingPassCount; ++p)
     {
-        const Mesh* const mesh = sg_Codex.GetMesh(drawCtx->InstancedMeshID);
+        InstancedDrawContext const& pass = InstancingPasses[p];
+        for (UINT i = 0; i != pass.InstanceCount; ++i)
+        {
+            DirectX::XMFLOAT4X4 const& world = pass.WorldMatrices[i];
+            ShadowCaster& caster = ShadowCasters[casterCount++];
+            caster.Center[0] = world._41;
+            caster.Center[1] = world._42;
+            caster.Center[2] = world._43;
+            caster.Radius = sqrtf(world._11 * world._11 + world._12 * world._12 + world._13 * world._13) * 0.8660254f; // Unit cube
+        }
+    }
 
-        ID3D11Buffer* vertBuffers[2];
-        vertBuffers[0] = mesh->VertexBuffer;        // Vertices
-        vertBuffers[1] = drawCtx->DynamicBuffer;    // Instanced World Matrices
+    shadows.CullCasters(ShadowCasters, casterCount, ShadowMasks);
 
-        static const UINT strides[2] = 
+    // Cascade-major, so each cascade's draws read one contiguous stretch of the buffer
+    UINT written = 0;
+    for (uint32_t c = 0; c != shadows.GetCascadeCount(); ++c)
+    {
+        UINT caster = 0;
+        for (UINT p = 0; p != InstancingPassCount; ++p)
         {
-            mesh->Stride,
-            sizeof(DirectX::XMFLOAT4X4)
-        };
+            InstancedDrawContext const& pass = InstancingPasses[p];
+            ShadowRange& range = ShadowRanges[c * InstancingPassCount + p];
+            range.First = written;
+            for (UINT i = 0; i != pass.InstanceCount; ++i, ++caster)
+            {
+                if (ShadowMasks[caster] & (1u << c))
+                    ShadowInstances[written++] = pass.WorldMatrices[i];
+            }
+            range.Count = written - range.First;
+        }
+    }
 
-        static const UINT offsets[2] = 
-        {
-            0, 
-            0
-        };
+    if (!written)
+        return;
 
+    D3D11_MAPPED_SUBRESOURCE mappedBuffer;
+    COM_EXCEPT(context->Map(ShadowInstanceBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedBuffer));
+    memcpy(mappedBuffer.pData, ShadowInstances, sizeof(DirectX::XMFLOAT4X4) * written);
+    context->Unmap(ShadowInstanceBuffer, 0);
+}
 
-        context->IASetVertexBuffers(0, 2, &vertBuffers[0], &strides[0], &offsets[0]);
+void EntityRenderer::DrawShadowCascade(ID3D11DeviceContext* context, uint32_t cascade)
+{
+    ResourceCodex const& sg_Codex = ResourceCodex::GetSingleton();
+
+    context->IASetInputLayout(ShadowVS->InputLayout);
+    context->VSSetShader(ShadowVS->Shader, nullptr, 0);
+    context->PSSetShader(nullptr, nullptr, 0);
+
+    for (UINT p = 0; p != InstancingPassCount; ++p)
+    {
+        ShadowRange const& range = ShadowRanges[cascade * InstancingPassCount + p];
+        if (!range.Count)
+            continue;
+
+        const Mesh* const mesh = sg_Codex.GetMesh(InstancingPasses[p].InstancedMeshID);
+
+        ID3D11Buffer* vertBuffers[2] = { mesh->VertexBuffer, ShadowInstanceBuffer };
+        const UINT strides[2] = { mesh->Stride, sizeof(DirectX::XMFLOAT4X4) };
+        const UINT offsets[2] = { 0, 0 };
+        context->IASetVertexBuffers(0, 2, vertBuffers, strides, offsets);
         context->IASetIndexBuffer(mesh->IndexBuffer, DXGI_FORMAT_R32_UINT, 0);
 
-        // Setup VS,PS
-        const Material mat = *sg_Codex.GetMaterial(drawCtx->MaterialIndex);
-        const VertexShader* VS = mat.VS;
-        const PixelShader*  PS = mat.PS;
+        context->DrawIndexedInstanced(mesh->IndexCount, range.Count, 0, 0, range.First);
+    }
+}
+
+void EntityRenderer::GetBounds(DirectX::XMFLOAT3& out_min, DirectX::XMFLOAT3& out_max) const
+{
+    using namespace DirectX;
 
-        ID3D11RasterizerState* pCurrRasterState = nullptr;
-        ID3D11RasterizerState* pRasterStateOverride = mat.RasterStateOverride;
-        if (pRasterStateOverride)
+    XMVECTOR boundsMin = XMVectorReplicate(FLT_MAX);
+    XMVECTOR boundsMax = XMVectorReplicate(-FLT_MAX);
+    for (UINT p = 0; p != InstancingPassCount; ++p)
+    {
+        InstancedDrawContext const& pass = InstancingPasses[p];
+        for (UINT i = 0; i != pass.InstanceCount; ++i)
         {
-            context->RSGetState(&pCurrRasterState);
-            context->RSSetState(pRasterStateOverride);
+            XMFLOAT4X4 const& world = pass.WorldMatrices[i];
+            const XMVECTOR center = XMVectorSet(world._41, world._42, world._43, 0.0f);
+            const float radius = sqrtf(world._11 * world._11 + world._12 * world._12 + world._13 * world._13) * 0.8660254f; // Unit cube
+            boundsMin = XMVectorMin(boundsMin, XMVectorSubtract(center, XMVectorReplicate(radius)));
+            boundsMax = XMVectorMax(boundsMax, XMVectorAdd(center, XMVectorReplicate(radius)));
         }
+    }
 
-        context->IASetInputLayout(VS->InputLayout);
-        context->VSSetShader(VS->Shader, nullptr, 0);
-        context->PSSetShader(PS->Shader, nullptr, 0);
+    XMStoreFloat3(&out_min, boundsMin);
+    XMStoreFloat3(&out_max, boundsMax);
+}
 
-        // Update Material Param Data:
-        ConstantBufferUpdateManager::MapUnmap(&MaterialParamsCB, (void*)&mat.Description, context);
+void EntityRenderer::Draw(ID3D11DeviceContext* context)
+{
+    MN_PROFILE_FUNCTION();
 
-        // Bind Textures expected by the shader
-        if (mat.Resources)
-            context->PSSetShaderResources(0, (UINT)TextureSlots::COUNT, mat.Resources->SRVs);
+    this->InstancedDraw(context);
+}
 
-        // Submit draw call to GPU
-        context->DrawIndexedInstanced(mesh->IndexCount, drawCtx->InstanceCount, 0, 0, 0);
+void EntityRenderer::InstancedDraw(ID3D11DeviceContext* context)
+{
+    RecordRange ranges[kMaxDeferredContexts];
+    const UINT rangeCount = PartitionRecordRanges(DrawItemCosts, DrawItemCount, DeferredContextCount, kMinInstancesPerContext, ranges);
+    if (rangeCount <= 1)
+    {
+        RecordDrawItems(context, 0, DrawItemCount);
+        return;
+    }
 
-        if (pRasterStateOverride)
+    InheritedContextState inherited = {};
+    CaptureContextState(context, inherited);
+
+    ID3D11CommandList* commandLists[kMaxDeferredContexts] = {};
+    Core::JobCounter counter;
+    Core::JobSystem::Dispatch(counter, rangeCount, 1, [&](UINT first, UINT last)
+    {
+        for (UINT r = first; r != last; ++r)
         {
-            context->RSSetState(pCurrRasterState); // Put things back how they were
+            ID3D11DeviceContext* deferred = DeferredContexts[r];
+            ApplyContextState(deferred, inherited);
+            RecordDrawItems(deferred, ranges[r].Begin, ranges[r].End);
+            COM_EXCEPT(deferred->FinishCommandList(FALSE, &commandLists[r]));
         }
+    });
+    Core::JobSystem::Wait(counter);
+
+    // Range order is item order, whichever worker finished first
+    for (UINT r = 0; r != rangeCount; ++r)
+    {
+        context->ExecuteCommandList(commandLists[r], TRUE);
+        commandLists[r]->Release();
+    }
+
+    ReleaseContextState(inherited);
+}
+
+void EntityRenderer::RecordDrawItems(ID3D11DeviceContext* context, UINT begin, UINT end)
+{
+    MN_PROFILE_FUNCTION();
+
+    ResourceCodex const& sg_Codex = ResourceCodex::GetSingleton();
+
+    // Materials whose textures were packed into the same pages have identical chords, so only rebind on a change
+    ID3D11ShaderResourceView* boundSRVs[(UINT)TextureSlots::COUNT] = {};
+    bool srvsBound = false;
+
+    // The pass whose state is bound, and the raster state to put back once it's done
+    UINT boundPass = UINT_MAX;
+    const Mesh* mesh = nullptr;
+    ID3D11RasterizerState* pCurrRasterState = nullptr;
+    bool rasterOverridden = false;
+
+    for (UINT i = begin; i != end; ++i)
+    {
+        DrawItem const& item = DrawItems[i];
+        if (item.Pass != boundPass)
+        {
+            if (rasterOverridden)
+            {
+                context->RSSetState(pCurrRasterState); // Put things back how they were
+                if (pCurrRasterState)
+                    pCurrRasterState->Release();
+                pCurrRasterState = nullptr;
+                rasterOverridden = false;
+            }
+
+            InstancedDrawContext const& drawCtx = InstancingPasses[item.Pass];
+            boundPass = item.Pass;
+            mesh = sg_Codex.GetMesh(drawCtx.InstancedMeshID);
+
+            ID3D11Buffer* vertBuffers[2];
+            vertBuffers[0] = mesh->VertexBuffer;        // Vertices
+            vertBuffers[1] = drawCtx.DynamicBuffer;     // Instanced World Matrices
+
+            const UINT strides[2] = 
+            {
+                mesh->Stride,
+                sizeof(DirectX::XMFLOAT4X4)
+            };
+
+            static const UINT offsets[2] = 
+            {
+                0, 
+                0
+            };
+
+            context->IASetVertexBuffers(0, 2, &vertBuffers[0], &strides[0], &offsets[0]);
+            context->IASetIndexBuffer(mesh->IndexBuffer, DXGI_FORMAT_R32_UINT, 0);
+
+            // Setup VS,PS
+            const Material mat = *sg_Codex.GetMaterial(drawCtx.MaterialIndex);
+            const VertexShader* VS = mat.VS;
+            const PixelShader*  PS = mat.PS;
+
+            if (ID3D11RasterizerState* pRasterStateOverride = mat.RasterStateOverride)
+            {
+                context->RSGetState(&pCurrRasterState);
+                context->RSSetState(pRasterStateOverride);
+                rasterOverridden = true;
+            }
+
+            context->IASetInputLayout(VS->InputLayout);
+            context->VSSetShader(VS->Shader, nullptr, 0);
+            context->PSSetShader(PS->Shader, nullptr, 0);
+
+            // Update Material Param Data. Mapped by hand rather than through MapUnmap, which
+            // marks the shared packet and would race between deferred contexts.
+            D3D11_MAPPED_SUBRESOURCE mappedParams = {0};
+            COM_EXCEPT(context->Map(MaterialParamsCB.Buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedParams));
+            memcpy(mappedParams.pData, &mat.Description, MaterialParamsCB.ByteSize);
+            context->Unmap(MaterialParamsCB.Buffer, 0);
+
+            // Bind Textures expected by the shader
+            if (mat.Resources && (!srvsBound || memcmp(boundSRVs, mat.Resources->SRVs, sizeof(boundSRVs))))
+            {
+                context->PSSetShaderResources(0, (UINT)TextureSlots::COUNT, mat.Resources->SRVs);
+                memcpy(boundSRVs, mat.Resources->SRVs, sizeof(boundSRVs));
+                srvsBound = true;
+            }
+        }
+
+        // Submit draw call to GPU; the instance offset picks this item's world matrices out of the pass's buffer
+        context->DrawIndexedInstanced(mesh->IndexCount, item.InstanceCount, 0, 0, item.FirstInstance);
+    }
+
+    if (rasterOverridden)
+    {
+        context->RSSetState(pCurrRasterState); // Put things back how they were
+        if (pCurrRasterState)
+            pCurrRasterState->Release();
     }
 }
 
 EntityRenderer::~EntityRenderer()
 {
-    for (uint8_t i = 0; i != 1; ++i)
+    // Nothing to release if Init was never called (e.g. the DX12 path)
+    if (!EntityArena.IsInitialized())
+        return;
+
+    for (UINT i = 0; i != InstancingPassCount; ++i)
     {
         InstancedDrawContext& drawCtx = InstancingPasses[i];
-
-        free(drawCtx.WorldMatrices);
-        drawCtx.WorldMatrices = nullptr;
-        drawCtx.DynamicBuffer->Release();
+        if (drawCtx.DynamicBuffer)
+            drawCtx.DynamicBuffer->Release();
     }
-    
-    delete[] InstancingPasses;
-    InstancingPasses = nullptr;
 
-    free(Entities);
+    if (ShadowInstanceBuffer)
+        ShadowInstanceBuffer->Release();
+
+    for (UINT i = 0; i != DeferredContextCount; ++i)
+        DeferredContexts[i]->Release();
+    DeferredContextCount = 0;
+
+    Entities.Shutdown();
+
+    // InstancingPasses and their world matrices all live in the arena
+    EntityArena.Destroy();
+    InstancingPasses = nullptr;
+    DrawItems = nullptr;
+    DrawItemCosts = nullptr;
+    DrawItemCount = 0;
+    ShadowCasters = nullptr;
+    ShadowMasks = nullptr;
+    ShadowInstances = nullptr;
+    ShadowRanges = nullptr;
 
     ConstantBufferUpdateManager::Cleanup(&MaterialParamsCB);
     ConstantBufferUpdateManager::Cleanup(&EntityCB);
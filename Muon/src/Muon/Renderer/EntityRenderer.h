@@ -7,6 +7,8 @@ Description : Manager-level class for intelligently binding and drawing objects
 #define RENDERER_H
 
 #include <Muon/Core/Transform.h>
+#include <Muon/Core/World.h>
+#include <Muon/Memory/Allocators.h>
 
 #include "CBufferStructs.h"
 #include "ConstantBuffer.h"
@@ -17,17 +19,20 @@ namespace Renderer
 {
     class DeviceResources;
     class Camera;
+    class CascadedShadows;
 
     struct InstancedDrawContext;
+    struct ShadowCaster;
+    struct VertexShader;
 }
 
 namespace Renderer {
 
-struct Entity
+// What an entity needs to be drawn, alongside its Core::Transform
+struct MeshInstance
 {
-    Core::Transform mTransform;
-    MeshID          mMeshID;
-    uint32_t        MaterialIndex;
+    MeshID   Mesh;
+    uint32_t MaterialIndex;
 };
 
 class EntityRenderer
@@ -40,14 +45,34 @@ public:
 
     // For now, the renderer will handle updating the entities, 
     // In the future, perhaps a Physics Manager or AI Manager would be a good solution?
-    void Update(ID3D11DeviceContext* context, float dt);
+    // Runs once per fixed step, keeping each transform's last state to interpolate from.
+    void Simulate(float dt);
+
+    // Once per rendered frame: blends every transform alpha of the way from its last step to its current one and uploads them
+    void Update(ID3D11DeviceContext* context, float alpha);
 
     // Binds the fields necessary in the material, then draws every entity in m_EntityMap
     void Draw(ID3D11DeviceContext* context);
 
+    // Tells the texture streamer how large each pass's material is on screen. After Update, before ResourceCodex::UpdateStreaming.
+    void RequestTextureMips(Camera const& camera, float viewportHeight);
+
+    // Sorts every instance into the shadow cascades it can darken and uploads them, grouped by cascade.
+    // Only cascades that need rendering this frame get any.
+    void CullShadowCasters(ID3D11DeviceContext* context, CascadedShadows const& shadows);
+
+    // Depth-only draw of the casters CullShadowCasters gave this cascade. The caller binds the target and light camera.
+    void DrawShadowCascade(ID3D11DeviceContext* context, uint32_t cascade);
+
+    // World space box around every entity, as of the last Update
+    void GetBounds(DirectX::XMFLOAT3& out_min, DirectX::XMFLOAT3& out_max) const;
+
 private:
-    // Performs all the instanced draw steps
+    // Performs all the instanced draw steps, spread over deferred contexts when there are enough instances
     void InstancedDraw(ID3D11DeviceContext* context);
+
+    // Records draw items [begin, end) into context, binding each pass once per run of its items. Safe to call from a worker thread.
+    void RecordDrawItems(ID3D11DeviceContext* context, UINT begin, UINT end);
     
     // Loads the necessary models into a collection
     void InitMeshes(DeviceResources const& dr);
@@ -60,20 +85,58 @@ private:
 
 private:
 
-    // All the Entities
-    Entity*  Entities;
-    UINT     EntityCount;
+    // Owns the instancing arrays below, released all at once on destruction
+    Memory::LinearArena EntityArena;
+
+    // All the Entities. Nothing spawns or despawns them after InitEntities yet.
+    Core::World Entities;
+    UINT        EntityCount;
 
     // Array of Instancing Information
     InstancedDrawContext* InstancingPasses;
     UINT                  InstancingPassCount;
 
+    // One instanced draw of a run of a pass's instances. Passes are cut into these so there's enough
+    // work to spread over the deferred contexts; each costs its instance count.
+    struct DrawItem
+    {
+        UINT Pass;
+        UINT FirstInstance;
+        UINT InstanceCount;
+    };
+
+    DrawItem* DrawItems;
+    uint32_t* DrawItemCosts;
+    UINT      DrawItemCount;
+
     // Constant Buffer that holds material parameters
     ConstantBufferBindPacket MaterialParamsCB;
 
     // Constant Buffer that holds non-instanced entity world matrices
     ConstantBufferBindPacket EntityCB;
 
+    // Workers record draw items into these, the immediate context executes them in item order
+    static const UINT kMaxDeferredContexts = 4;
+    ID3D11DeviceContext* DeferredContexts[kMaxDeferredContexts];
+    UINT                 DeferredContextCount;
+
+    // A run of ShadowInstances drawn with one pass's mesh
+    struct ShadowRange
+    {
+        UINT First;
+        UINT Count;
+    };
+
+    // Per entity bounding spheres and the cascades each one lands in
+    ShadowCaster* ShadowCasters;
+    uint8_t*      ShadowMasks;
+
+    // World matrices grouped by [cascade][pass], described by ShadowRanges at the same index
+    DirectX::XMFLOAT4X4* ShadowInstances;
+    ShadowRange*         ShadowRanges;
+    ID3D11Buffer*        ShadowInstanceBuffer;
+    const VertexShader*  ShadowVS;
+
 public: // Enforce use of the default constructor
     EntityRenderer(EntityRenderer const&)               = delete;
     EntityRenderer& operator=(EntityRenderer const&)    = delete;
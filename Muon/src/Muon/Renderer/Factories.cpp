@@ -2,6 +2,9 @@
 
 #include "hash_util.h"
 
+#include <Muon/Core/Profiler.h>
+#include <Muon/Memory/Allocators.h>
+
 // MeshFactory
 #include "Mesh.h"
 #include <assimp/Importer.hpp>
@@ -10,19 +13,26 @@
 
 // ShaderFactory
 #include "Shader.h"
+#include "ShaderArchive.h"
+#include "ShaderReflectionRecord.h"
+#include <Muon/Core/PathMacros.h>
 
 // TextureFactory
 #include "Material.h"
+#include "TexturePacker.h"
 #include <filesystem>
 #include <DDSTextureLoader.h>
 #include <WICTextureLoader.h>
 
+#include <string.h>
 #include <unordered_map>
 
 namespace Renderer {
 
 MeshID MeshFactory::CreateMesh(const char* fileName, const VertexBufferDescription* vertAttr, ID3D11Device* pDevice, Mesh* out_mesh)
 {
+    MN_PROFILE_FUNCTION();
+
     Assimp::Importer Importer;
     MeshID meshId = fnv1a(fileName);
 
@@ -48,11 +58,14 @@ MeshID MeshFactory::CreateMesh(const char* fileName, const VertexBufferDescripti
             const aiMesh* pMesh = pScene->mMeshes[i];
             const aiVector3D c_Zero(0.0f, 0.0f, 0.0f);
 
+            // CPU-side copies only need to live until the buffers are created
+            Memory::ScratchScope scratch(Memory::GetScratchArena());
+
             const UINT numVertices = pMesh->mNumVertices;
-            BYTE* vertices = (BYTE*)malloc(vertDesc.ByteSize * numVertices);
+            BYTE* vertices = scratch.AllocArray<BYTE>(vertDesc.ByteSize * numVertices);
 
             const unsigned int numIndices = pMesh->mNumFaces * 3;
-            uint32_t* indices  = (uint32_t*)malloc(sizeof(uint32_t) * numIndices);
+            uint32_t* indices  = scratch.AllocArray<uint32_t>(numIndices);
 
             // Process Vertices for this mesh
             for (unsigned int j = 0; j != pMesh->mNumVertices; ++j)
@@ -150,9 +163,6 @@ MeshID MeshFactory::CreateMesh(const char* fileName, const VertexBufferDescripti
             #endif
 
             *out_mesh = tempMesh;
-
-            free(vertices);
-            free(indices);
         }
     }
     #if defined(MN_DEBUG)
@@ -187,6 +197,8 @@ MeshID MeshFactory::CreateMesh(const char* fileName, const VertexBufferDescripti
 
 void ShaderFactory::LoadAllShaders(ID3D11Device* device, ResourceCodex& codex)
 {
+    MN_PROFILE_FUNCTION();
+
     namespace fs = std::filesystem;
     std::string shaderPath = SHADERPATH;
 
@@ -198,25 +210,169 @@ void ShaderFactory::LoadAllShaders(ID3D11Device* device, ResourceCodex& codex)
     // Iterate through folder and load shaders
     for (const auto& entry : fs::directory_iterator(shaderPath))
     {
+        // Reflection sidecars and the archive live in the same folder
+        if (entry.path().extension() != L".cso")
+            continue;
+
         std::wstring path = entry.path();
-        std::wstring name = entry.path().filename();
+        std::wstring name = entry.path().stem();
 
-        ShaderID hash = fnv1a(name.c_str());
+        // A loose file is always the base variant of the program it was compiled from
+        const ShaderKey key = { fnv1a(name.c_str()), kBaseVariant };
 
         // Parse file name to decide how to create this resource
-        if (name.find(L"VS") != std::wstring::npos)
+        ProgramStage stage;
+        if (!GetProgramStage(entry.path().stem().string(), &stage))
+            continue;
+
+        if (stage == ProgramStage::VS)
         {
-            codex.AddVertexShader(hash, path.c_str(), device);
+            codex.AddVertexShader(key, path.c_str(), device);
         }
-        else if (name.find(L"PS") != std::wstring::npos)
+        else if (stage == ProgramStage::PS)
         {
-            codex.AddPixelShader(hash, path.c_str(), device);
+            codex.AddPixelShader(key, path.c_str(), device);
         }
     }
+
+    LoadArchive(device, codex);
+}
+
+void ShaderFactory::LoadArchive(ID3D11Device* device, ResourceCodex& codex)
+{
+    MN_PROFILE_FUNCTION();
+
+    ShaderArchive archive;
+    const ArchiveResult result = archive.Load(SHADERARCHIVEPATHW);
+    if (result != ArchiveResult::OK)
+    {
+        #if defined(MN_DEBUG)
+            char buf[128];
+            sprintf_s(buf, "INFO: No shader archive (%s), variants will be compiled on first use\n", ShaderArchive::GetResultString(result));
+            OutputDebugStringA(buf);
+        #endif
+        return;
+    }
+
+    // D3D11 only takes DXBC, so an archive built for the DX12 path (DXIL) is no use here
+    if (archive.GetShaderModel() >= 60)
+    {
+        #if defined(MN_DEBUG)
+            OutputDebugStringA("INFO: Shader archive holds DXIL, rebuild it with -compiler fxc -sm 5_0 for D3D11\n");
+        #endif
+        return;
+    }
+
+    for (uint32_t i = 0; i != archive.GetEntryCount(); ++i)
+    {
+        ShaderArchiveEntry const& entry = archive.GetEntry(i);
+
+        // Loose files are what the Shaders project rebuilds on every edit, so they win over the archive
+        const bool isVertex = entry.Stage == ProgramStage::VS;
+        const bool loaded = isVertex ? codex.GetVertexShader(entry.Key.Program, entry.Key.Variant) != nullptr
+                                     : codex.GetPixelShader(entry.Key.Program, entry.Key.Variant) != nullptr;
+        if (loaded || (!isVertex && entry.Stage != ProgramStage::PS))
+            continue;
+
+        ID3D10Blob* pBlob = nullptr;
+        HRESULT hr = D3DCreateBlob(entry.BytecodeSize, &pBlob);
+        COM_EXCEPT(hr);
+        memcpy(pBlob->GetBufferPointer(), archive.GetBytecode(entry), entry.BytecodeSize);
+
+        if (isVertex)
+        {
+            ShaderReflectionRecord record;
+            const ReflectionResult reflResult = ParseReflectionRecord(archive.GetReflection(entry), entry.ReflectionSize, pBlob->GetBufferPointer(), pBlob->GetBufferSize(), &record);
+            if (reflResult != ReflectionResult::OK)
+                ReflectVertexShader(pBlob, &record);
+
+            codex.AddVertexShader(entry.Key, pBlob, record, device);
+        }
+        else
+        {
+            codex.AddPixelShader(entry.Key, pBlob, device);
+        }
+
+        pBlob->Release();
+    }
+}
+
+const VertexShader* ShaderFactory::RequireVertexShader(const wchar_t* programName, ShaderVariantKey variant, ID3D11Device* device, ResourceCodex& codex)
+{
+    const ShaderKey key = { fnv1a(programName), variant };
+    if (const VertexShader* pShader = codex.GetVertexShader(key.Program, key.Variant))
+        return pShader;
+
+    ID3D10Blob* pBlob = CompileVariant(programName, ProgramStage::VS, variant);
+
+    ShaderReflectionRecord record;
+    ReflectVertexShader(pBlob, &record);
+    codex.AddVertexShader(key, pBlob, record, device);
+    pBlob->Release();
+
+    return codex.GetVertexShader(key.Program, key.Variant);
+}
+
+const PixelShader* ShaderFactory::RequirePixelShader(const wchar_t* programName, ShaderVariantKey variant, ID3D11Device* device, ResourceCodex& codex)
+{
+    const ShaderKey key = { fnv1a(programName), variant };
+    if (const PixelShader* pShader = codex.GetPixelShader(key.Program, key.Variant))
+        return pShader;
+
+    ID3D10Blob* pBlob = CompileVariant(programName, ProgramStage::PS, variant);
+    codex.AddPixelShader(key, pBlob, device);
+    pBlob->Release();
+
+    return codex.GetPixelShader(key.Program, key.Variant);
+}
+
+ID3D10Blob* ShaderFactory::CompileVariant(const wchar_t* programName, ProgramStage stage, ShaderVariantKey variant)
+{
+    MN_PROFILE_FUNCTION();
+
+    const std::wstring sourcePath = std::wstring(SHADERSOURCEPATHW) + programName + L".hlsl";
+    const std::string profile = std::string(GetProgramStagePrefix(stage)) + "_5_0";
+
+    // One NAME=1 per feature, null terminated
+    D3D_SHADER_MACRO macros[(uint8_t)ShaderFeature::COUNT + 1] = {};
+    UINT macroCount = 0;
+    for (uint8_t f = 0; f != (uint8_t)ShaderFeature::COUNT; ++f)
+    {
+        if (HasFeature(variant, (ShaderFeature)f))
+            macros[macroCount++] = { GetShaderFeatureName((ShaderFeature)f), "1" };
+    }
+
+    #if defined(MN_DEBUG)
+        const std::string variantName = GetVariantName(std::filesystem::path(programName).string(), variant);
+        char buf[256];
+        sprintf_s(buf, "INFO: Compiling shader variant '%s' at runtime\n", variantName.c_str());
+        OutputDebugStringA(buf);
+
+        const UINT flags = D3DCOMPILE_ENABLE_STRICTNESS | D3DCOMPILE_DEBUG;
+    #else
+        const UINT flags = D3DCOMPILE_ENABLE_STRICTNESS | D3DCOMPILE_OPTIMIZATION_LEVEL3;
+    #endif
+
+    ID3D10Blob* pBlob = nullptr;
+    ID3D10Blob* pErrors = nullptr;
+    HRESULT hr = D3DCompileFromFile(sourcePath.c_str(), macros, D3D_COMPILE_STANDARD_FILE_INCLUDE, "main", profile.c_str(), flags, 0, &pBlob, &pErrors);
+
+    if (pErrors)
+    {
+        #if defined(MN_DEBUG)
+            OutputDebugStringA((const char*)pErrors->GetBufferPointer());
+        #endif
+        pErrors->Release();
+    }
+
+    COM_EXCEPT(hr);
+    return pBlob;
 }
 
-void ShaderFactory::CreateVertexShader(const wchar_t* path, VertexShader* out_shader, ID3D11Device* device)
+void ShaderFactory::CreateVertexShader(const wchar_t* path, VertexShader* out_shader, ID3D11Device* device, Memory::LinearArena& descArena)
 {
+    MN_PROFILE_FUNCTION();
+
     HRESULT hr = E_FAIL;
 
     // Read bytecode from file to blob
@@ -225,6 +381,36 @@ void ShaderFactory::CreateVertexShader(const wchar_t* path, VertexShader* out_sh
 
     COM_EXCEPT(hr);
 
+    // Prefer the sidecar next to the .cso. D3DReflect only runs when it's missing or was built from other bytecode.
+    ShaderReflectionRecord record;
+    const std::filesystem::path reflPath = GetReflectionPath(path);
+    const ReflectionResult result = LoadReflectionRecord(reflPath, pBlob->GetBufferPointer(), pBlob->GetBufferSize(), &record);
+
+    if (result != ReflectionResult::OK)
+    {
+        #if defined(MN_DEBUG)
+            char buf[256];
+            sprintf_s(buf, "INFO: Reflecting '%ls' at runtime (sidecar %s)\n", path, GetReflectionResultString(result));
+            OutputDebugStringA(buf);
+        #endif
+
+        ReflectVertexShader(pBlob, &record);
+
+        // Next launch can skip all of the above
+        SaveReflectionRecord(reflPath, record);
+    }
+
+    CreateVertexShader(pBlob, record, out_shader, device, descArena);
+
+    pBlob->Release();
+}
+
+void ShaderFactory::CreateVertexShader(ID3D10Blob* pBlob, ShaderReflectionRecord const& record, VertexShader* out_shader, ID3D11Device* device, Memory::LinearArena& descArena)
+{
+    MN_PROFILE_FUNCTION();
+
+    HRESULT hr = E_FAIL;
+
     // Creating the actual vertex shader representation from the blob's bytecode:
     hr = device->CreateVertexShader(pBlob->GetBufferPointer(), 
     pBlob->GetBufferSize(), 
@@ -239,17 +425,14 @@ void ShaderFactory::CreateVertexShader(const wchar_t* path, VertexShader* out_sh
         COM_EXCEPT(hr);
     #endif
 
-    // Use the Blob to create a shader reflection
-    ID3D11ShaderReflection* pReflection = nullptr;
-    hr = D3DReflect(pBlob->GetBufferPointer(), pBlob->GetBufferSize(), IID_ID3D11ShaderReflection, reinterpret_cast<void**>(&pReflection));
-    COM_EXCEPT(hr);
-
-    // Use reflecion to build an input layout, finalizing vertex shader populate.
-    BuildInputLayout(pReflection, pBlob, out_shader, device);
+    // Use the record to build an input layout, finalizing vertex shader populate.
+    BuildInputLayout(record, pBlob, out_shader, device, descArena);
 }
 
 void ShaderFactory::CreatePixelShader(const wchar_t* path, PixelShader* out_shader, ID3D11Device* device)
 {
+    MN_PROFILE_FUNCTION();
+
     HRESULT hr = E_FAIL;
 
     // Read bytecode from file to blob
@@ -258,6 +441,16 @@ void ShaderFactory::CreatePixelShader(const wchar_t* path, PixelShader* out_shad
 
     COM_EXCEPT(hr);
 
+    CreatePixelShader(pBlob, out_shader, device);
+    pBlob->Release();
+}
+
+void ShaderFactory::CreatePixelShader(ID3D10Blob* pBlob, PixelShader* out_shader, ID3D11Device* device)
+{
+    MN_PROFILE_FUNCTION();
+
+    HRESULT hr = E_FAIL;
+
     // Creating the actual vertex shader representation from the blob's bytecode:
     hr = device->CreatePixelShader(pBlob->GetBufferPointer(), 
     pBlob->GetBufferSize(), 
@@ -284,107 +477,146 @@ void ShaderFactory::CreatePixelShader(const wchar_t* path, PixelShader* out_shad
     COM_EXCEPT(hr);
 }
 
-const char* kSemanticNames[] = 
-{
-    "POSITION",
-    "NORMAL",
-    "TEXCOORD",
-    "TANGENT",
-    "BINORMAL",
-    "COLOR",
-    "BLENDINDICES",
-    "BLENDWEIGHTS",
-    "WORLDMATRIX"
-};
+static_assert((semantic_t)Semantics::COUNT == kReflectedSemanticCount, "Reflection records index the Semantics enum directly");
 
-const char* kInstancedSemanticNames[] = 
+// [ComponentType][ComponentCount - 1], where ComponentType follows D3D_REGISTER_COMPONENT_TYPE
+static const DXGI_FORMAT kInputFormats[4][4] =
 {
-    "INSTANCE_POSITION",
-    "INSTANCE_NORMAL",
-    "INSTANCE_TEXCOORD,",
-    "INSTANCE_TANGENT",
-    "INSTANCE_BINORMAL",
-    "INSTANCE_COLOR",
-    "INSTANCE_BLENDINDICES",
-    "INSTANCE_BLENDWEIGHTS",
-    "INSTANCE_WORLDMATRIX"
+    { DXGI_FORMAT_UNKNOWN,    DXGI_FORMAT_UNKNOWN,       DXGI_FORMAT_UNKNOWN,          DXGI_FORMAT_UNKNOWN             },
+    { DXGI_FORMAT_R32_UINT,   DXGI_FORMAT_R32G32_UINT,   DXGI_FORMAT_R32G32B32_UINT,   DXGI_FORMAT_R32G32B32A32_UINT   },
+    { DXGI_FORMAT_R32_SINT,   DXGI_FORMAT_R32G32_SINT,   DXGI_FORMAT_R32G32B32_SINT,   DXGI_FORMAT_R32G32B32A32_SINT   },
+    { DXGI_FORMAT_R32_FLOAT,  DXGI_FORMAT_R32G32_FLOAT,  DXGI_FORMAT_R32G32B32_FLOAT,  DXGI_FORMAT_R32G32B32A32_FLOAT  }
 };
 
-void ShaderFactory::BuildInputLayout(ID3D11ShaderReflection* pReflection, ID3D10Blob* pBlob, VertexShader* out_shader, ID3D11Device* device)
+void ShaderFactory::ReflectVertexShader(ID3D10Blob* pBlob, ShaderReflectionRecord* out_record)
 {
+    ID3D11ShaderReflection* pReflection = nullptr;
+    HRESULT hr = D3DReflect(pBlob->GetBufferPointer(), pBlob->GetBufferSize(), IID_ID3D11ShaderReflection, reinterpret_cast<void**>(&pReflection));
+    COM_EXCEPT(hr);
+
     // Get a shader description
     D3D11_SHADER_DESC shaderDesc;
     pReflection->GetDesc(&shaderDesc);
-    const UINT numInputs = shaderDesc.InputParameters;
-
-    Semantics* tempSemanticsArr = (Semantics*)malloc(sizeof(semantic_t) * numInputs);
-    D3D11_SIGNATURE_PARAMETER_DESC* paramDescs = (D3D11_SIGNATURE_PARAMETER_DESC*)malloc(sizeof(D3D11_SIGNATURE_PARAMETER_DESC) * numInputs);
 
-    // Instance fields false by default
-    out_shader->Instanced = false;
-    ZeroMemory(&out_shader->InstanceDesc, sizeof(VertexBufferDescription));
-
-    uint8_t numInstanceInputs = 0;
-    uint8_t instanceStartIdx = UINT8_MAX;
+    ShaderReflectionRecord record = {};
+    record.BytecodeSize = (uint32_t)pBlob->GetBufferSize();
+    record.BytecodeHash = HashShaderBytecode(pBlob->GetBufferPointer(), pBlob->GetBufferSize());
+    record.InstanceStart = kNoInstanceInputs;
 
-    // Always start with regular vertex semantics
-    const char** comparisonArray = kSemanticNames;
+    // A record that can't describe the shader mustn't be built, let alone saved as its sidecar
+    if (shaderDesc.InputParameters > kMaxReflectedInputs)
+    {
+        char buf[128];
+        sprintf_s(buf, "Vertex shader has %u inputs, reflection records hold at most %u\n", shaderDesc.InputParameters, kMaxReflectedInputs);
+        pReflection->Release();
+        throw std::exception(buf);
+    }
+    record.InputCount = (uint8_t)shaderDesc.InputParameters;
 
-    // First, build semantics enum array from the strings gotten from the reflection
-    // If any of the strings are marked as being for instancing, then split off into initialization of two vertex buffers
-    for (uint8_t i = 0; i != numInputs; ++i)
+    // By convention, every input after the first "INSTANCE_" semantic comes from the instance buffer
+    uint16_t* byteSize = &record.VertexByteSize;
+    for (uint8_t i = 0; i != record.InputCount; ++i)
     {
-        pReflection->GetInputParameterDesc(i, &paramDescs[i]);
+        D3D11_SIGNATURE_PARAMETER_DESC paramDesc;
+        pReflection->GetInputParameterDesc(i, &paramDesc);
 
-        // determine semantic and assign easy enum ID
-        for (semantic_t s = 0; s != (semantic_t)Semantics::COUNT; ++s)
+        ReflectedInput& input = record.Inputs[i];
+        bool instanced = false;
+        if (!FindSemantic(paramDesc.SemanticName, &input.Semantic, &instanced))
         {
-            if (!strcmp(paramDescs[i].SemanticName, comparisonArray[s]))
-            {
-                tempSemanticsArr[i] = (Semantics)s;
-                break;
-            }
-            else if (numInstanceInputs == 0 && strstr(paramDescs[i].SemanticName, "INSTANCE_")) // Look for the instanced prefix set in HLSL
-            {
-                out_shader->Instanced = true; // Now we know this is an instanced shader
-                numInstanceInputs = numInputs - i;
-                instanceStartIdx = i--; // decrement i so we scan this semanticName again
-                comparisonArray = kInstancedSemanticNames; // By convention: we are done with regular vertex attributes, switch to comparing with the instanced versions
-                break;
-            }
+            char buf[256];
+            sprintf_s(buf, "Unknown vertex shader input semantic '%s'\n", paramDesc.SemanticName);
+            pReflection->Release();
+            throw std::exception(buf);
+        }
+
+        if (instanced && record.InstanceStart == kNoInstanceInputs)
+        {
+            record.InstanceStart = i;
+            byteSize = &record.InstanceByteSize;
         }
+
+        // determine component count from the mask ... Thanks MSDN!
+        if      ( paramDesc.Mask == 1  ) input.ComponentCount = 1; // R
+        else if ( paramDesc.Mask <= 3  ) input.ComponentCount = 2; // RG
+        else if ( paramDesc.Mask <= 7  ) input.ComponentCount = 3; // RGB
+        else                             input.ComponentCount = 4; // RGBA
+
+        input.SemanticIndex = (uint8_t)paramDesc.SemanticIndex;
+        input.ComponentType = (uint8_t)paramDesc.ComponentType;
+        input.ByteOffset = *byteSize;
+        *byteSize += (uint16_t)(input.ComponentCount * sizeof(float));
+    }
+
+    // Record cbuffer and texture slots so bindings can be checked without reflecting again
+    for (UINT i = 0; i != shaderDesc.BoundResources; ++i)
+    {
+        D3D11_SHADER_INPUT_BIND_DESC bindDesc;
+        pReflection->GetResourceBindingDesc(i, &bindDesc);
+
+        ReflectedBinding binding = { fnv1a(bindDesc.Name), (uint8_t)bindDesc.BindPoint, (uint8_t)bindDesc.BindCount, 0 };
+        if (bindDesc.Type == D3D_SIT_CBUFFER && record.CBufferCount != kMaxReflectedBindings)
+            record.CBuffers[record.CBufferCount++] = binding;
+        else if (bindDesc.Type == D3D_SIT_TEXTURE && record.TextureCount != kMaxReflectedBindings)
+            record.Textures[record.TextureCount++] = binding;
+    }
+
+    pReflection->Release();
+    *out_record = record;
+}
+
+void ShaderFactory::BuildInputLayout(ShaderReflectionRecord const& record, ID3D10Blob* pBlob, VertexShader* out_shader, ID3D11Device* device, Memory::LinearArena& descArena)
+{
+    const UINT numInputs = record.InputCount;
+
+    // The semantics and byte offsets outlive this function, so they come from the codex's arena.
+    // Everything else is scratch and gets rewound when we return.
+    Memory::ScratchScope scratch(Memory::GetScratchArena());
+
+    Semantics* semanticsArr = descArena.AllocArray<Semantics>(numInputs);
+    uint16_t* byteOffsets = descArena.AllocArray<uint16_t>(numInputs);
+    D3D11_INPUT_ELEMENT_DESC* allInputParams = scratch.AllocArray<D3D11_INPUT_ELEMENT_DESC>(numInputs);
+
+    const bool instanced = record.InstanceStart != kNoInstanceInputs;
+    const UINT instanceStartIdx = instanced ? record.InstanceStart : numInputs;
+
+    for (UINT i = 0; i != numInputs; ++i)
+    {
+        ReflectedInput const& input = record.Inputs[i];
+        const bool perInstance = i >= instanceStartIdx;
+
+        D3D11_INPUT_ELEMENT_DESC inputParam = {};
+        inputParam.SemanticName = GetSemanticName(input.Semantic, perInstance);
+        inputParam.SemanticIndex = input.SemanticIndex;
+        inputParam.Format = kInputFormats[input.ComponentType & 3][input.ComponentCount - 1];
+        inputParam.AlignedByteOffset = input.ByteOffset;
+        inputParam.InputSlotClass = perInstance ? D3D11_INPUT_PER_INSTANCE_DATA : D3D11_INPUT_PER_VERTEX_DATA;
+        inputParam.InputSlot = perInstance ? 1 : 0;
+        inputParam.InstanceDataStepRate = perInstance ? 1 : 0;
+
+        allInputParams[i] = inputParam;
+        semanticsArr[i] = (Semantics)input.Semantic;
+        byteOffsets[i] = input.ByteOffset;
     }
 
-    // Now the temp array has all the semantics properly labeled. Use it to create the vertex buffer and the instance buffer(if applicable)
     VertexBufferDescription vbDesc;
+    vbDesc.SemanticsArr = semanticsArr;
+    vbDesc.ByteOffsets = byteOffsets;
+    vbDesc.AttrCount = (uint16_t)instanceStartIdx;
+    vbDesc.ByteSize = record.VertexByteSize;
+    out_shader->VertexDesc = vbDesc;
 
-    D3D11_INPUT_ELEMENT_DESC* allInputParams = (D3D11_INPUT_ELEMENT_DESC*)malloc(sizeof(D3D11_INPUT_ELEMENT_DESC) * numInputs);
-    if (numInstanceInputs) // Also need to create an instance buffer layout
+    out_shader->Instanced = instanced;
+    ZeroMemory(&out_shader->InstanceDesc, sizeof(VertexBufferDescription));
+    if (instanced) // Also need to describe the instance buffer
     {
-        // Regular vertex buffer
-        UINT numVertexInputs = numInputs - numInstanceInputs;
-        vbDesc.ByteOffsets = (uint16_t*)malloc(sizeof(uint16_t) * numInputs);
-        AssignDXGIFormatsAndByteOffsets(D3D11_INPUT_PER_VERTEX_DATA, &paramDescs[0], numVertexInputs, &allInputParams[0], vbDesc.ByteOffsets, &vbDesc.ByteSize);
-        vbDesc.SemanticsArr = tempSemanticsArr;
-        vbDesc.AttrCount = numVertexInputs;
-        out_shader->VertexDesc = vbDesc;
-        
-        // Instance buffer
         VertexBufferDescription instDesc;
-        instDesc.ByteOffsets = &vbDesc.ByteOffsets[instanceStartIdx];
-        AssignDXGIFormatsAndByteOffsets(D3D11_INPUT_PER_INSTANCE_DATA, &paramDescs[instanceStartIdx], numInstanceInputs, &allInputParams[instanceStartIdx], instDesc.ByteOffsets, &instDesc.ByteSize);
-        instDesc.SemanticsArr = &tempSemanticsArr[instanceStartIdx];
-        instDesc.AttrCount = numInstanceInputs;
+        instDesc.SemanticsArr = &semanticsArr[instanceStartIdx];
+        instDesc.ByteOffsets = &byteOffsets[instanceStartIdx];
+        instDesc.AttrCount = (uint16_t)(numInputs - instanceStartIdx);
+        instDesc.ByteSize = record.InstanceByteSize;
         out_shader->InstanceDesc = instDesc;
     }
-    else // Just regular vertex buffer
-    {
-        vbDesc.ByteOffsets = (uint16_t*)malloc(sizeof(uint16_t) * numInputs);
-        AssignDXGIFormatsAndByteOffsets(D3D11_INPUT_PER_VERTEX_DATA, paramDescs, numInputs, allInputParams, vbDesc.ByteOffsets, &vbDesc.ByteSize);
-        vbDesc.SemanticsArr = tempSemanticsArr;
-        vbDesc.AttrCount = numInputs;
-        out_shader->VertexDesc = vbDesc;
-    }
 
     // Finally, try to create the input layout
     HRESULT hr = device->CreateInputLayout(&allInputParams[0], numInputs, pBlob->GetBufferPointer(), pBlob->GetBufferSize(), &out_shader->InputLayout);
@@ -395,80 +627,16 @@ void ShaderFactory::BuildInputLayout(ID3D11ShaderReflection* pReflection, ID3D10
     hr = out_shader->InputLayout->SetPrivateData(WKPDID_D3DDebugObjectName, ARRAYSIZE(debugNameIL) - 1, debugNameIL);
     COM_EXCEPT(hr);
     #endif
-
-    // Cleanup mallocs
-    free(allInputParams);
-    free(paramDescs);
-}
-
-void ShaderFactory::AssignDXGIFormatsAndByteOffsets(D3D11_INPUT_CLASSIFICATION slotClass, D3D11_SIGNATURE_PARAMETER_DESC* paramDescs, UINT numInputs, D3D11_INPUT_ELEMENT_DESC* out_inputParams, uint16_t* out_byteOffsets, uint16_t* out_byteSize)
-{
-    uint16_t totalByteSize = 0;
-    for (uint8_t i = 0; i != numInputs; ++i)
-    {
-        D3D11_SIGNATURE_PARAMETER_DESC paramDesc = paramDescs[i];
-
-        D3D11_INPUT_ELEMENT_DESC inputParam = {};
-        inputParam.SemanticName = paramDesc.SemanticName;
-        inputParam.SemanticIndex = paramDesc.SemanticIndex;
-        inputParam.InputSlotClass = slotClass;
-
-        if(slotClass == D3D11_INPUT_PER_VERTEX_DATA)
-        {
-            inputParam.InputSlot = 0;
-            inputParam.InstanceDataStepRate = 0;
-        }
-        else // per instance data
-        {
-            inputParam.InputSlot = 1;
-            inputParam.InstanceDataStepRate = 1;
-        }
-
-        out_byteOffsets[i] = totalByteSize;
-        inputParam.AlignedByteOffset = totalByteSize;
-
-        // determine DXGI format ... Thanks MSDN!
-        if ( paramDesc.Mask == 1 ) // R
-        {
-            totalByteSize += 4;
-            if      ( paramDesc.ComponentType == D3D_REGISTER_COMPONENT_UINT32  )   inputParam.Format = DXGI_FORMAT_R32_UINT;
-            else if ( paramDesc.ComponentType == D3D_REGISTER_COMPONENT_SINT32  )   inputParam.Format = DXGI_FORMAT_R32_SINT;
-            else if ( paramDesc.ComponentType == D3D_REGISTER_COMPONENT_FLOAT32 )   inputParam.Format = DXGI_FORMAT_R32_FLOAT;
-        }
-        else if ( paramDesc.Mask <= 3 ) // RG
-        {
-            totalByteSize += 8;
-            if      ( paramDesc.ComponentType == D3D_REGISTER_COMPONENT_UINT32  )   inputParam.Format = DXGI_FORMAT_R32G32_UINT;
-            else if ( paramDesc.ComponentType == D3D_REGISTER_COMPONENT_SINT32  )   inputParam.Format = DXGI_FORMAT_R32G32_SINT;
-            else if ( paramDesc.ComponentType == D3D_REGISTER_COMPONENT_FLOAT32 )   inputParam.Format = DXGI_FORMAT_R32G32_FLOAT;
-        }
-        else if ( paramDesc.Mask <= 7 ) // RGB
-        {
-            totalByteSize += 12;
-            if      ( paramDesc.ComponentType == D3D_REGISTER_COMPONENT_UINT32  )   inputParam.Format = DXGI_FORMAT_R32G32B32_UINT;
-            else if ( paramDesc.ComponentType == D3D_REGISTER_COMPONENT_SINT32  )   inputParam.Format = DXGI_FORMAT_R32G32B32_SINT;
-            else if ( paramDesc.ComponentType == D3D_REGISTER_COMPONENT_FLOAT32 )   inputParam.Format = DXGI_FORMAT_R32G32B32_FLOAT;
-        }
-        else if ( paramDesc.Mask <= 15 ) // RGBA
-        {
-            totalByteSize += 16;
-            if      ( paramDesc.ComponentType == D3D_REGISTER_COMPONENT_UINT32  )   inputParam.Format = DXGI_FORMAT_R32G32B32A32_UINT;
-            else if ( paramDesc.ComponentType == D3D_REGISTER_COMPONENT_SINT32  )   inputParam.Format = DXGI_FORMAT_R32G32B32A32_SINT;
-            else if ( paramDesc.ComponentType == D3D_REGISTER_COMPONENT_FLOAT32 )   inputParam.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
-        }
-
-
-        out_inputParams[i] = inputParam;
-    }
-
-    *out_byteSize = totalByteSize;
 }
 
 // Loads all the textures from the directory and returns them as out params to the ResourceCodex
 void TextureFactory::LoadAllTextures(ID3D11Device* device, ID3D11DeviceContext* context, ResourceCodex& codex)
 {
+    MN_PROFILE_FUNCTION();
+
     namespace fs = std::filesystem;
     std::string texturePath = TEXTUREPATH;
+    const fs::path cookedPath = COOKEDTEXTUREPATH;
 
     #if defined(MN_DEBUG)
     if(!fs::exists(texturePath))
@@ -477,6 +645,36 @@ void TextureFactory::LoadAllTextures(ID3D11Device* device, ID3D11DeviceContext*
     
     std::unordered_map<TextureID, ResourceBindChord> tempTexMap;
 
+    // Pages from TextureCooker -pack. A texture in one still gets its own Texture2D; only a material built with
+    // the TEXTURE_ARRAY variant binds the page instead, through the codex's packed chord, and reads the slice and rect.
+    const fs::path packedPath = cookedPath / "Packed";
+    TexturePackManifest manifest;
+    std::vector<ID3D11ShaderResourceView*> pageSRVs;
+    if (manifest.Load(packedPath / "TexturePack.bin"))
+    {
+        for (uint32_t p = 0; p != manifest.GetPageCount(); ++p)
+        {
+            ID3D11Resource* pPage = nullptr;
+            const fs::path pagePath = packedPath / manifest.GetPage(p);
+            COM_EXCEPT(DirectX::CreateDDSTextureFromFile(device, pagePath.c_str(), &pPage, nullptr));
+
+            // The loader would view a one-slice page (an atlas) as a Texture2D, but the shader samples every page as an array
+            D3D11_TEXTURE2D_DESC pageDesc;
+            static_cast<ID3D11Texture2D*>(pPage)->GetDesc(&pageDesc);
+
+            D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+            srvDesc.Format                   = pageDesc.Format;
+            srvDesc.ViewDimension            = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+            srvDesc.Texture2DArray.MipLevels = pageDesc.MipLevels;
+            srvDesc.Texture2DArray.ArraySize = pageDesc.ArraySize;
+
+            ID3D11ShaderResourceView* pPageSRV = nullptr;
+            COM_EXCEPT(device->CreateShaderResourceView(pPage, &srvDesc, &pPageSRV));
+            pPage->Release();
+            pageSRVs.push_back(pPageSRV);
+        }
+    }
+
     // Iterate through folder and initialize materials
     for (const auto& entry : fs::directory_iterator(texturePath))
     {
@@ -497,6 +695,12 @@ void TextureFactory::LoadAllTextures(ID3D11Device* device, ID3D11DeviceContext*
         HRESULT hr = E_FAIL;
 
         ID3D11Resource* dummy = nullptr;
+        StreamedTextureID streamed = kInvalidStreamedTexture;
+        TexturePackEntry const* pPacked = manifest.Find(entry.path().stem().string());
+
+        // Prefer what TextureCooker produced: block compressed with mips already baked in
+        fs::path cooked = cookedPath / entry.path().filename();
+        cooked.replace_extension(L".dds");
 
         // Special Case: DDS Files (Cube maps with no mipmaps)
         if (TexExt == L"dds")
@@ -507,6 +711,27 @@ void TextureFactory::LoadAllTextures(ID3D11Device* device, ID3D11DeviceContext*
                 &dummy,
                 &pSRV);
         } 
+        else if (fs::exists(cooked))
+        {
+            // Cooked 2D textures stream; only their mip tail is loaded here. Packed ones stay resident like their page.
+            if (!pPacked)
+                streamed = codex.mTextureStreamer.RegisterFile(cooked.string().c_str());
+
+            if (streamed != kInvalidStreamedTexture)
+            {
+                pSRV = codex.mpStreamingDevice->GetSRV(codex.mTextureStreamer.GetHandle(streamed));
+                pSRV->AddRef();
+                hr = S_OK;
+            }
+            else
+            {
+                hr = DirectX::CreateDDSTextureFromFile(
+                    device,
+                    cooked.c_str(),
+                    &dummy,
+                    &pSRV);
+            }
+        }
         else // For most textures, use WIC with mipmaps
         {
             hr = DirectX::CreateWICTextureFromFile(
@@ -517,7 +742,8 @@ void TextureFactory::LoadAllTextures(ID3D11Device* device, ID3D11DeviceContext*
             
         }
         // Clean up Texture2D
-        dummy->Release();
+        if (dummy)
+            dummy->Release();
         assert(!FAILED(hr));
 
         // Classify based on Letter following '_'
@@ -561,30 +787,81 @@ void TextureFactory::LoadAllTextures(ID3D11Device* device, ID3D11DeviceContext*
 
         TextureID tid = fnv1a(TexName.c_str());
         codex.InsertTexture(tid, slot, pSRV);
+
+        if (streamed != kInvalidStreamedTexture)
+            codex.mStreamedBindings.push_back({ tid, slot, streamed });
+
+        if (pPacked)
+        {
+            ResourceCodex::PackedBinding& binding = codex.mPackedTextures[((uint64_t)tid << 8) | slot];
+            binding.Page = pPacked->Page;
+            binding.Slice = pPacked->Slice;
+            memcpy(binding.UVRect, pPacked->UVRect, sizeof(binding.UVRect));
+        }
     }
+
+    // Packed chords start as copies of the finished chords, then swap the slots TEXTURE_ARRAY samples as arrays for pages
+    for (auto const& packed : codex.mPackedTextures)
+    {
+        const TextureID tid = (TextureID)(packed.first >> 8);
+        const UINT slot = (UINT)(packed.first & 0xFF);
+        if (slot != (UINT)TextureSlots::DIFFUSE && slot != (UINT)TextureSlots::NORMAL)
+            continue;
+
+        auto chord = codex.mPackedChords.find(tid);
+        if (chord == codex.mPackedChords.end())
+        {
+            chord = codex.mPackedChords.emplace(tid, codex.mTextureMap.at(tid)).first;
+            for (ID3D11ShaderResourceView* pCopied : chord->second.SRVs)
+                if (pCopied) pCopied->AddRef();
+        }
+
+        ID3D11ShaderResourceView*& bound = chord->second.SRVs[slot];
+        if (bound)
+            bound->Release();
+        bound = pageSRVs[packed.second.Page];
+        bound->AddRef();
+    }
+
+    // Every packed chord slot that uses a page holds its own reference
+    for (ID3D11ShaderResourceView* pPageSRV : pageSRVs)
+        pPageSRV->Release();
 }
 
 bool MaterialFactory::CreateAllMaterials(ID3D11Device* device, ResourceCodex& codex)
 {
+    MN_PROFILE_FUNCTION();
+
     const uint32_t kLunarId = fnv1a(L"Lunar");       // FNV1A of L"Lunar"
 
-    const ShaderID kInstancedPhongVSID = 0xc8a366aa; // FNV1A of L"InstancedPhongVS.cso"
-    const ShaderID kPhongPSID = 0x4dc6e249;          // FNV1A of L"PhongPS.cso"
-    const ShaderID kPhongPSNormalMapID = fnv1a(L"Phong_NormalMapPS.cso");
-    const ShaderID kWireFramePSID = fnv1a(L"WireframePS.cso");
-    const ShaderID kSkyVSID = 0xeb5accd4;         // fnv1a L"SkyVS.cso"
-    const ShaderID kSkyPSID = 0x6ec235e6;         // fnv1a L"SkyPS.cso"
+    const ShaderVariantKey kInstanced = ToVariantKey(ShaderFeature::INSTANCED);
+    const ShaderVariantKey kNormalMap = ToVariantKey(ShaderFeature::NORMAL_MAP);
+    const ShaderVariantKey kTextureArray = ToVariantKey(ShaderFeature::TEXTURE_ARRAY);
+    const ShaderVariantKey kClusteredLights = ToVariantKey(ShaderFeature::CLUSTERED_LIGHTS);
+    const ShaderVariantKey kShadows = ToVariantKey(ShaderFeature::SHADOWS);
     const TextureID kSkyTextureID = 0x2fb626d6;   // fnv1a L"Sky"
     const TextureID kSpaceTextureID = 0xc1c43225; // fnv1a L"Space"
     const MeshID kSkyMeshID = 0x4a986f37; // cube
 
     {
+        // Pages are sampled as arrays, so the packed variant needs both textures to be in one
+        ResourceCodex::PackedBinding diffuse;
+        ResourceCodex::PackedBinding normal;
+        const bool packed = codex.GetPackedTexture(kLunarId, TextureSlots::DIFFUSE, &diffuse) && codex.GetPackedTexture(kLunarId, TextureSlots::NORMAL, &normal);
+
         Material lunarMaterial;
-        lunarMaterial.VS = codex.GetVertexShader(kInstancedPhongVSID);
-        lunarMaterial.PS = codex.GetPixelShader(kPhongPSNormalMapID);
+        lunarMaterial.VS = ShaderFactory::RequireVertexShader(L"PhongVS", kInstanced, device, codex);
+        lunarMaterial.PS = ShaderFactory::RequirePixelShader(L"PhongPS", kNormalMap | kClusteredLights | kShadows | (packed ? kTextureArray : kBaseVariant), device, codex);
         lunarMaterial.Description.colorTint = DirectX::XMFLOAT4(DirectX::Colors::White);
         lunarMaterial.Description.specularExp = 128.0f;
-        lunarMaterial.Resources = codex.GetTexture(kLunarId);
+        lunarMaterial.Resources = packed ? codex.GetPackedChord(kLunarId) : codex.GetTexture(kLunarId);
+        if (packed)
+        {
+            lunarMaterial.Description.diffuseSlice = diffuse.Slice;
+            lunarMaterial.Description.normalSlice  = normal.Slice;
+            lunarMaterial.Description.diffuseRect  = DirectX::XMFLOAT4A(diffuse.UVRect);
+            lunarMaterial.Description.normalRect   = DirectX::XMFLOAT4A(normal.UVRect);
+        }
 
         MaterialIndex lunarMaterialIndex = codex.PushMaterial(lunarMaterial);
         assert(MI_LUNAR == lunarMaterialIndex); // This is stupid
@@ -592,8 +869,8 @@ bool MaterialFactory::CreateAllMaterials(ID3D11Device* device, ResourceCodex& co
 
     {
         Material skyMaterial;
-        skyMaterial.VS = codex.GetVertexShader(kSkyVSID);
-        skyMaterial.PS = codex.GetPixelShader(kSkyPSID);
+        skyMaterial.VS = ShaderFactory::RequireVertexShader(L"SkyVS", kBaseVariant, device, codex);
+        skyMaterial.PS = ShaderFactory::RequirePixelShader(L"SkyPS", kBaseVariant, device, codex);
         skyMaterial.Resources = codex.GetTexture(kSpaceTextureID);
 
         // Back-facing rasterizer state
@@ -624,8 +901,8 @@ bool MaterialFactory::CreateAllMaterials(ID3D11Device* device, ResourceCodex& co
 
     {
         Material wireframeMaterial;
-        wireframeMaterial.VS = codex.GetVertexShader(kInstancedPhongVSID);
-        wireframeMaterial.PS = codex.GetPixelShader(kWireFramePSID);
+        wireframeMaterial.VS = ShaderFactory::RequireVertexShader(L"PhongVS", kInstanced, device, codex);
+        wireframeMaterial.PS = ShaderFactory::RequirePixelShader(L"WireframePS", kBaseVariant, device, codex);
         wireframeMaterial.Description.colorTint = DirectX::XMFLOAT4(DirectX::Colors::White);
         wireframeMaterial.Description.specularExp = 0.0f;
 
@@ -4,25 +4,45 @@
 #include "DXCore.h"
 #include "ResourceCodex.h"
 #include "Shader.h"
+#include "ShaderVariant.h"
 
 #include <utility>
 
+namespace Memory
+{
+class LinearArena;
+}
+
 namespace Renderer {
 
+struct ShaderReflectionRecord;
+
 struct ShaderFactory final
 {
     friend class ResourceCodex;
 
     // Main initialization function: Takes a codex, which then calls the static functions from ShaderFactory to populate its own hashtables
+    // Loose .cso files provide base variants, the shader archive provides every other variant.
     static void LoadAllShaders(ID3D11Device* device, ResourceCodex& codex);
 
+    // Looks a variant up in the codex, compiling it from source the first time if nothing shipped it.
+    // programName is the .hlsl file name without extension, e.g. L"PhongPS".
+    static const VertexShader* RequireVertexShader(const wchar_t* programName, ShaderVariantKey variant, ID3D11Device* device, ResourceCodex& codex);
+    static const PixelShader*  RequirePixelShader(const wchar_t* programName, ShaderVariantKey variant, ID3D11Device* device, ResourceCodex& codex);
+
+private:
+    static void        LoadArchive(ID3D11Device* device, ResourceCodex& codex);
+    static ID3D10Blob* CompileVariant(const wchar_t* programName, ProgramStage stage, ShaderVariantKey variant);
+
 private: // For VertexShader
-    static void CreateVertexShader(const wchar_t* fileName, VertexShader* out_shader, ID3D11Device* device);
-    static void BuildInputLayout(ID3D11ShaderReflection* pReflection, ID3D10Blob* pBlob, VertexShader* out_shader, ID3D11Device* device);
-    static void AssignDXGIFormatsAndByteOffsets(D3D11_INPUT_CLASSIFICATION slotClass, D3D11_SIGNATURE_PARAMETER_DESC* paramDescs, UINT numInputs, D3D11_INPUT_ELEMENT_DESC* out_inputParams, uint16_t* out_byteOffsets, uint16_t* out_byteSize);
+    static void CreateVertexShader(const wchar_t* fileName, VertexShader* out_shader, ID3D11Device* device, Memory::LinearArena& descArena);
+    static void CreateVertexShader(ID3D10Blob* pBlob, ShaderReflectionRecord const& record, VertexShader* out_shader, ID3D11Device* device, Memory::LinearArena& descArena);
+    static void ReflectVertexShader(ID3D10Blob* pBlob, ShaderReflectionRecord* out_record);
+    static void BuildInputLayout(ShaderReflectionRecord const& record, ID3D10Blob* pBlob, VertexShader* out_shader, ID3D11Device* device, Memory::LinearArena& descArena);
 
 private: // For PixelShader
     static void CreatePixelShader(const wchar_t* fileName, PixelShader* out_shader, ID3D11Device* device);
+    static void CreatePixelShader(ID3D10Blob* pBlob, PixelShader* out_shader, ID3D11Device* device);
 };
 
 struct TextureFactory final
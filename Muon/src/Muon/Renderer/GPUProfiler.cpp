@@ -0,0 +1,227 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of GPUProfiler.h
+----------------------------------------------*/
+#include "GPUProfiler.h"
+
+#include <Muon/Core/Profiler.h>
+
+#include <algorithm>
+#include <assert.h>
+
+namespace Renderer {
+
+namespace {
+
+// The two clocks drift apart slowly; re-pairing them every couple of seconds keeps traces aligned
+const uint64_t kRecalibrationFrames = 120;
+
+}
+
+GPUProfiler::GPUProfiler() :
+    mpDevice(nullptr),
+    mMaxScopes(0),
+    mTrack(0),
+    mSlots(),
+    mScopeCount(0),
+    mFrameIndex(0),
+    mOldestPending(0),
+    mNsPerTick(0.0),
+    mCalibrationTicks(0),
+    mCalibrationNs(0),
+    mStats(),
+    mLastReadFrame(0),
+    mLastReadEndNs(0)
+{
+}
+
+GPUProfiler::~GPUProfiler()
+{
+    Shutdown();
+}
+
+bool GPUProfiler::Init(ITimestampDevice* pDevice, uint32_t maxScopesPerFrame)
+{
+    assert(pDevice && maxScopesPerFrame != 0);
+
+    const uint64_t frequency = pDevice->GetTimestampFrequency();
+    if (!frequency)
+        return false;
+
+    mpDevice = pDevice;
+    mMaxScopes = maxScopesPerFrame;
+    mNsPerTick = 1e9 / (double)frequency;
+    mpDevice->GetClockCalibration(mCalibrationTicks, mCalibrationNs);
+
+    // A heap per slot, so resolving one frame never touches queries another may still be reading back
+    for (FrameSlot& slot : mSlots)
+    {
+        slot.Heap = mpDevice->CreateTimestampHeap(maxScopesPerFrame * 2);
+        slot.Names.assign(maxScopesPerFrame, nullptr);
+        slot.Pending = false;
+
+        if (slot.Heap == kInvalidBackendHandle)
+        {
+            Shutdown();
+            return false;
+        }
+    }
+    mReadback.resize(maxScopesPerFrame * 2);
+
+#if defined(MN_ENABLE_PROFILER)
+    mTrack = Core::Profiler::RegisterTrack("GPU");
+#endif
+
+    return true;
+}
+
+void GPUProfiler::Shutdown()
+{
+    if (!mpDevice)
+        return;
+
+    for (FrameSlot& slot : mSlots)
+    {
+        if (slot.Heap != kInvalidBackendHandle)
+            mpDevice->DestroyTimestampHeap(slot.Heap);
+        slot.Heap = kInvalidBackendHandle;
+        slot.Pending = false;
+    }
+    mpDevice = nullptr;
+}
+
+void GPUProfiler::BeginFrame()
+{
+    assert(mpDevice);
+
+    if (mFrameIndex % kRecalibrationFrames == 0)
+        mpDevice->GetClockCalibration(mCalibrationTicks, mCalibrationNs);
+
+    FrameSlot& slot = mSlots[mFrameIndex % kFrameSlots];
+
+    // Still waiting on the frame that last used this slot. Waiting would stall the CPU on the GPU, so drop it.
+    if (slot.Pending && !ReadSlot(slot))
+    {
+        slot.Pending = false;
+        mStats.FramesDropped++;
+    }
+
+    slot.FrameIndex = mFrameIndex;
+    slot.Names[0] = "Frame";
+    mScopeCount.store(1, std::memory_order_relaxed);
+
+    mpDevice->WriteTimestamp(slot.Heap, 0);
+}
+
+void GPUProfiler::EndFrame()
+{
+    assert(mpDevice);
+
+    FrameSlot& slot = mSlots[mFrameIndex % kFrameSlots];
+    mpDevice->WriteTimestamp(slot.Heap, 1);
+
+    slot.ScopeCount = std::min(mScopeCount.load(std::memory_order_relaxed), mMaxScopes);
+    mpDevice->ResolveTimestamps(slot.Heap, 0, slot.ScopeCount * 2);
+
+    slot.SubmitNs = Core::Profiler::Now();
+    slot.CalibrationTicks = mCalibrationTicks;
+    slot.CalibrationNs = mCalibrationNs;
+    slot.Pending = true;
+
+    mFrameIndex++;
+    ReadCompleted();
+}
+
+uint32_t GPUProfiler::BeginScope(ITimestampWriter& writer, const char* name)
+{
+    const uint32_t scope = mScopeCount.fetch_add(1, std::memory_order_relaxed);
+    if (scope >= mMaxScopes)
+        return kInvalidScope;
+
+    FrameSlot& slot = mSlots[mFrameIndex % kFrameSlots];
+    slot.Names[scope] = name;
+    writer.WriteTimestamp(slot.Heap, scope * 2);
+    return scope;
+}
+
+void GPUProfiler::EndScope(ITimestampWriter& writer, uint32_t scope)
+{
+    if (scope == kInvalidScope)
+        return;
+
+    writer.WriteTimestamp(mSlots[mFrameIndex % kFrameSlots].Heap, scope * 2 + 1);
+}
+
+void GPUProfiler::ReadCompleted()
+{
+    for (; mOldestPending != mFrameIndex; ++mOldestPending)
+    {
+        FrameSlot& slot = mSlots[mOldestPending % kFrameSlots];
+
+        // Dropped, or already read when its slot came round
+        if (!slot.Pending || slot.FrameIndex != mOldestPending)
+            continue;
+
+        if (!ReadSlot(slot))
+            break;
+    }
+}
+
+bool GPUProfiler::ReadSlot(FrameSlot& slot)
+{
+    if (!mpDevice->ReadTimestamps(slot.Heap, 0, slot.ScopeCount * 2, mReadback.data()))
+        return false;
+
+    slot.Pending = false;
+
+    const uint64_t startNs = ToCpuNs(slot, mReadback[0]);
+    const uint64_t endNs = std::max(ToCpuNs(slot, mReadback[1]), startNs);
+
+#if defined(MN_ENABLE_PROFILER)
+    for (uint32_t i = 0; i != slot.ScopeCount; ++i)
+    {
+        const uint64_t scopeStart = ToCpuNs(slot, mReadback[i * 2]);
+        const uint64_t scopeEnd = std::max(ToCpuNs(slot, mReadback[i * 2 + 1]), scopeStart);
+        Core::Profiler::RecordOnTrack(mTrack, slot.Names[i], scopeStart, scopeEnd, i == 0 ? 0 : 1);
+    }
+#endif
+
+    mStats.LastBusyMs = (endNs - startNs) / 1e6;
+    mStats.BusyMs += mStats.LastBusyMs;
+    mStats.LatencyMs += endNs > slot.SubmitNs ? (endNs - slot.SubmitNs) / 1e6 : 0.0;
+
+    if (mStats.FramesRead && slot.FrameIndex == mLastReadFrame + 1 && startNs > mLastReadEndNs)
+        mStats.IdleMs += (startNs - mLastReadEndNs) / 1e6;
+
+    mStats.FramesRead++;
+    mLastReadFrame = slot.FrameIndex;
+    mLastReadEndNs = endNs;
+    return true;
+}
+
+uint64_t GPUProfiler::ToCpuNs(FrameSlot const& slot, uint64_t ticks) const
+{
+    const double deltaTicks = (double)(int64_t)(ticks - slot.CalibrationTicks);
+    return slot.CalibrationNs + (int64_t)(deltaTicks * mNsPerTick);
+}
+
+/////////////////////////////////////////////////////////////////////
+// GPUProfileScope
+
+GPUProfileScope::GPUProfileScope(GPUProfiler* pProfiler, ITimestampWriter& writer, const char* name) :
+    mpProfiler(pProfiler),
+    mWriter(writer),
+    mScope(GPUProfiler::kInvalidScope)
+{
+    if (mpProfiler)
+        mScope = mpProfiler->BeginScope(mWriter, name);
+}
+
+GPUProfileScope::~GPUProfileScope()
+{
+    if (mpProfiler)
+        mpProfiler->EndScope(mWriter, mScope);
+}
+
+}
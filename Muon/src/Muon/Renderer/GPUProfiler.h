@@ -0,0 +1,119 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : GPU timing from timestamp queries
+Each frame brackets itself and any scopes inside it with timestamps in its own
+slot's query heap, resolves the heap at EndFrame and reads it back frames
+later without ever waiting on the GPU. Ticks are moved onto the CPU profiler's
+clock through the backend's calibration, so GPU work lines up under the CPU
+scopes that recorded it. A frame whose slot comes round again before its
+results are back is dropped rather than stalled on.
+----------------------------------------------*/
+#ifndef MUON_GPUPROFILER_H
+#define MUON_GPUPROFILER_H
+
+#include "RenderBackend.h"
+
+#include <atomic>
+#include <stdint.h>
+#include <vector>
+
+namespace Renderer {
+
+struct GPUTimingStats
+{
+    uint32_t FramesRead;
+    uint32_t FramesDropped;     // Slot reused before its timestamps came back
+    double   BusyMs;            // Summed over read frames, from a frame's first timestamp to its last
+    double   IdleMs;            // Summed gaps between consecutive read frames. Large when the CPU can't keep up.
+    double   LatencyMs;         // Summed over read frames, from the CPU's EndFrame to the GPU finishing it
+    double   LastBusyMs;
+};
+
+class GPUProfiler
+{
+public:
+    // Returned by BeginScope once a frame is out of scopes; EndScope ignores it
+    static const uint32_t kInvalidScope = ~0u;
+
+    // Frames that can be in flight before one is dropped
+    static const uint32_t kFrameSlots = 4;
+
+    GPUProfiler();
+    ~GPUProfiler();
+
+    // maxScopesPerFrame includes the frame itself
+    bool Init(ITimestampDevice* pDevice, uint32_t maxScopesPerFrame = 64);
+    void Shutdown();
+
+    // Between the backend's BeginFrame and EndFrame. The frame's own timestamps and its resolve go through the device.
+    void BeginFrame();
+    void EndFrame();
+
+    // May be called from the threads recording deferred contexts. name must outlive the profiler.
+    // A scope may end on a different writer than it began on, as long as both go to the same queue.
+    uint32_t BeginScope(ITimestampWriter& writer, const char* name);
+    void     EndScope(ITimestampWriter& writer, uint32_t scope);
+
+    GPUTimingStats const& GetStats() const { return mStats; }
+
+private:
+    struct FrameSlot
+    {
+        QueryHeapHandle          Heap;      // Two timestamps per scope
+        std::vector<const char*> Names;
+        uint32_t ScopeCount;
+        uint64_t FrameIndex;
+        uint64_t SubmitNs;          // CPU clock at EndFrame
+        uint64_t CalibrationTicks;  // The calibration current when it was submitted
+        uint64_t CalibrationNs;
+        bool     Pending;
+    };
+
+    // Reads back every pending slot that's ready, oldest first. Stops at the first that isn't.
+    void     ReadCompleted();
+    bool     ReadSlot(FrameSlot& slot);
+    uint64_t ToCpuNs(FrameSlot const& slot, uint64_t ticks) const;
+
+    ITimestampDevice*     mpDevice;
+    uint32_t              mMaxScopes;
+    uint32_t              mTrack;
+
+    FrameSlot             mSlots[kFrameSlots];
+    std::atomic<uint32_t> mScopeCount;      // In the frame being recorded
+    uint64_t              mFrameIndex;
+    uint64_t              mOldestPending;   // Frame index
+    std::vector<uint64_t> mReadback;
+
+    double                mNsPerTick;
+    uint64_t              mCalibrationTicks;
+    uint64_t              mCalibrationNs;
+
+    GPUTimingStats        mStats;
+    uint64_t              mLastReadFrame;
+    uint64_t              mLastReadEndNs;
+
+public:
+    GPUProfiler(GPUProfiler const&)            = delete;
+    GPUProfiler& operator=(GPUProfiler const&) = delete;
+};
+
+// Times the GPU work recorded into writer during its lifetime. A null profiler makes it a no-op.
+class GPUProfileScope
+{
+public:
+    GPUProfileScope(GPUProfiler* pProfiler, ITimestampWriter& writer, const char* name);
+    ~GPUProfileScope();
+
+private:
+    GPUProfiler*      mpProfiler;
+    ITimestampWriter& mWriter;
+    uint32_t          mScope;
+
+public:
+    GPUProfileScope(GPUProfileScope const&)            = delete;
+    GPUProfileScope& operator=(GPUProfileScope const&) = delete;
+};
+
+}
+#endif
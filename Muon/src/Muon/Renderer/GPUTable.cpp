@@ -0,0 +1,152 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of GPUTable.h
+----------------------------------------------*/
+#include "GPUTable.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace Renderer {
+
+namespace {
+
+bool TestBit(std::vector<uint64_t> const& bits, uint32_t index)
+{
+    return (bits[index >> 6] >> (index & 63)) & 1;
+}
+
+void SetBit(std::vector<uint64_t>& bits, uint32_t index)
+{
+    bits[index >> 6] |= 1ull << (index & 63);
+}
+
+void ClearBit(std::vector<uint64_t>& bits, uint32_t index)
+{
+    bits[index >> 6] &= ~(1ull << (index & 63));
+}
+
+}
+
+GPUTableSlots::GPUTableSlots() :
+    mCapacity(0),
+    mDirtyCount(0),
+    mHighWater(0),
+    mUploadedEntries(0),
+    mUploads(0)
+{
+}
+
+void GPUTableSlots::Init(uint32_t capacity)
+{
+    mCapacity = capacity;
+    mLive.assign((capacity + 63) / 64, 0);
+    mDirty.assign((capacity + 63) / 64, 0);
+    mRetired.clear();
+
+    mFree.resize(capacity);
+    for (uint32_t i = 0; i != capacity; ++i)
+        mFree[i] = capacity - 1 - i;
+
+    mDirtyCount = 0;
+    mHighWater = 0;
+    mUploadedEntries = 0;
+    mUploads = 0;
+}
+
+void GPUTableSlots::Destroy()
+{
+    mCapacity = 0;
+    mLive.clear();
+    mDirty.clear();
+    mFree.clear();
+    mRetired.clear();
+    mDirtyCount = 0;
+    mHighWater = 0;
+}
+
+uint32_t GPUTableSlots::Allocate()
+{
+    if (mFree.empty())
+        return kInvalidTableIndex;
+
+    const uint32_t index = mFree.back();
+    mFree.pop_back();
+
+    SetBit(mLive, index);
+    mHighWater = std::max(mHighWater, index + 1);
+    return index;
+}
+
+void GPUTableSlots::Free(uint32_t index)
+{
+    ClearBit(mLive, index);
+    mRetired.push_back(index);
+}
+
+void GPUTableSlots::MarkDirty(uint32_t index)
+{
+    if (TestBit(mDirty, index))
+        return;
+
+    SetBit(mDirty, index);
+    mDirtyCount++;
+}
+
+void GPUTableSlots::Collect(std::vector<GPUTableRange>& out_ranges, uint32_t mergeGap)
+{
+    out_ranges.clear();
+
+    const uint32_t wordCount = (uint32_t)mDirty.size();
+    for (uint32_t word = 0; word != wordCount && mDirtyCount; ++word)
+    {
+        uint64_t bits = mDirty[word];
+        for (uint32_t bit = 0; bits; ++bit, bits >>= 1)
+        {
+            if (!(bits & 1))
+                continue;
+
+            const uint32_t index = word * 64 + bit;
+            if (!out_ranges.empty() && index - (out_ranges.back().First + out_ranges.back().Count) <= mergeGap)
+                out_ranges.back().Count = index - out_ranges.back().First + 1;
+            else
+                out_ranges.push_back({ index, 1 });
+        }
+        mDirty[word] = 0;
+    }
+
+    for (GPUTableRange const& range : out_ranges)
+        mUploadedEntries += range.Count;
+    mUploads += (uint32_t)out_ranges.size();
+    mDirtyCount = 0;
+
+    // The removals are on their way to the GPU with this upload, so their slots can be handed out again
+    if (!mRetired.empty())
+    {
+        mFree.insert(mFree.end(), mRetired.begin(), mRetired.end());
+        std::sort(mFree.begin(), mFree.end(), std::greater<uint32_t>());
+        mRetired.clear();
+
+        while (mHighWater && !TestBit(mLive, mHighWater - 1))
+            --mHighWater;
+    }
+}
+
+bool GPUTableSlots::IsLive(uint32_t index) const
+{
+    return index < mCapacity && TestBit(mLive, index);
+}
+
+GPUTableStats GPUTableSlots::GetStats() const
+{
+    GPUTableStats stats = {};
+    stats.Capacity  = mCapacity;
+    stats.Live      = mCapacity - (uint32_t)mFree.size() - (uint32_t)mRetired.size();
+    stats.HighWater = mHighWater;
+    stats.UploadedEntries = mUploadedEntries;
+    stats.Uploads   = mUploads;
+    return stats;
+}
+
+}
@@ -0,0 +1,147 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : CPU copy of a fixed-capacity GPU structured buffer that only uploads what changed
+Entries keep their index for as long as they live, so shaders and other buffers can refer to
+them by index. Changed entries are collected as sorted ranges for partial buffer updates.
+No D3D dependencies; the backend owns the buffer.
+----------------------------------------------*/
+#ifndef MUON_GPUTABLE_H
+#define MUON_GPUTABLE_H
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+namespace Renderer {
+
+static const uint32_t kInvalidTableIndex = UINT32_MAX;
+
+// A run of entries to upload, in entries
+struct GPUTableRange
+{
+    uint32_t First;
+    uint32_t Count;
+};
+
+struct GPUTableStats
+{
+    uint32_t Capacity;
+    uint32_t Live;
+    uint32_t HighWater;         // Entries the GPU buffer has to cover
+    uint64_t UploadedEntries;   // Over the table's lifetime
+    uint32_t Uploads;           // Ranges handed out over the table's lifetime
+};
+
+// Index allocation and dirty tracking, independent of what the entries hold
+class GPUTableSlots
+{
+public:
+    GPUTableSlots();
+
+    void Init(uint32_t capacity);
+    void Destroy();
+
+    // kInvalidTableIndex when full. Freed slots are reused lowest first so live ones stay packed at the front.
+    uint32_t Allocate();
+
+    // The slot is not reused until the next Collect, by which point nothing may still refer to it
+    void Free(uint32_t index);
+
+    void MarkDirty(uint32_t index);
+
+    // Dirty slots as sorted ranges, merging runs separated by at most mergeGap clean slots
+    // (uploading a few clean entries beats another copy). Clears the dirty set.
+    void Collect(std::vector<GPUTableRange>& out_ranges, uint32_t mergeGap);
+
+    bool     IsLive(uint32_t index) const;
+    bool     IsDirty() const       { return mDirtyCount != 0; }
+    uint32_t GetCapacity() const   { return mCapacity; }
+    uint32_t GetHighWater() const  { return mHighWater; }
+
+    GPUTableStats GetStats() const;
+
+private:
+    uint32_t              mCapacity;
+    std::vector<uint64_t> mLive;         // One bit per slot
+    std::vector<uint64_t> mDirty;        // One bit per slot
+    std::vector<uint32_t> mFree;         // Sorted descending, so the lowest index pops off the back
+    std::vector<uint32_t> mRetired;      // Freed since the last Collect, released by it
+    uint32_t              mDirtyCount;
+    uint32_t              mHighWater;
+    uint64_t              mUploadedEntries;
+    uint32_t              mUploads;
+};
+
+// T must be trivially copyable and laid out the way the shader reads it
+template <typename T>
+class GPUTable
+{
+public:
+    // The GPU buffer is created at capacity entries and never grows, so indices stay valid
+    void Init(uint32_t capacity)
+    {
+        mEntries.assign(capacity, T());
+        mSlots.Init(capacity);
+    }
+
+    void Destroy()
+    {
+        mEntries.clear();
+        mSlots.Destroy();
+    }
+
+    uint32_t Add(T const& entry)
+    {
+        const uint32_t index = mSlots.Allocate();
+        if (index != kInvalidTableIndex)
+        {
+            mEntries[index] = entry;
+            mSlots.MarkDirty(index);
+        }
+        return index;
+    }
+
+    // Only marks the entry dirty when its bytes actually change
+    void Update(uint32_t index, T const& entry)
+    {
+        assert(mSlots.IsLive(index) && "GPUTable: updating an entry that isn't live");
+        if (!memcmp(&mEntries[index], &entry, sizeof(T)))
+            return;
+
+        mEntries[index] = entry;
+        mSlots.MarkDirty(index);
+    }
+
+    // The entry is reset to T() and uploaded, so anything still pointing at it reads defaults
+    // instead of whatever takes the slot next
+    void Remove(uint32_t index)
+    {
+        assert(mSlots.IsLive(index) && "GPUTable: removing an entry that isn't live");
+        mEntries[index] = T();
+        mSlots.MarkDirty(index);
+        mSlots.Free(index);
+    }
+
+    // The ranges index GetData(), which is what each one is uploaded from
+    void CollectDirtyRanges(std::vector<GPUTableRange>& out_ranges, uint32_t mergeGap = 4) { mSlots.Collect(out_ranges, mergeGap); }
+
+    T const&  Get(uint32_t index) const    { return mEntries[index]; }
+    const T*  GetData() const              { return mEntries.data(); }
+    bool      IsLive(uint32_t index) const { return mSlots.IsLive(index); }
+    bool      IsDirty() const              { return mSlots.IsDirty(); }
+
+    uint32_t GetCapacity() const  { return mSlots.GetCapacity(); }
+    uint32_t GetHighWater() const { return mSlots.GetHighWater(); }
+    uint32_t GetByteSize() const  { return GetCapacity() * (uint32_t)sizeof(T); }
+
+    GPUTableStats GetStats() const { return mSlots.GetStats(); }
+
+private:
+    std::vector<T> mEntries;
+    GPUTableSlots  mSlots;
+};
+
+}
+#endif
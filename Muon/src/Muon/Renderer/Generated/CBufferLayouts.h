@@ -0,0 +1,135 @@
+/*----------------------------------------------
+Generated by ShaderBuild from the HLSL cbuffer declarations. Do not edit;
+regenerate with ShaderBuild -cbuffer-header <this file> after changing a cbuffer.
+Description : C++ mirrors of every cbuffer, padded to HLSL packing rules.
+Matrices are stored one register per column, as HLSL defaults to column_major.
+----------------------------------------------*/
+#ifndef MUON_CBUFFERLAYOUTS_H
+#define MUON_CBUFFERLAYOUTS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Renderer {
+namespace CBufferLayout {
+
+struct ShadowCascade
+{
+    float    viewProjection[4][4];
+    float    params[4];
+};
+static_assert(sizeof(ShadowCascade) == 80, "ShadowCascade size doesn't match HLSL packing");
+static_assert(offsetof(ShadowCascade, viewProjection) == 0, "ShadowCascade::viewProjection is misaligned");
+static_assert(offsetof(ShadowCascade, params) == 64, "ShadowCascade::params is misaligned");
+
+struct DirectionalLight
+{
+    float    diffuseColor[3];
+    uint32_t _pad0;
+    float    toLight[3];
+};
+static_assert(sizeof(DirectionalLight) == 28, "DirectionalLight size doesn't match HLSL packing");
+static_assert(offsetof(DirectionalLight, diffuseColor) == 0, "DirectionalLight::diffuseColor is misaligned");
+static_assert(offsetof(DirectionalLight, toLight) == 16, "DirectionalLight::toLight is misaligned");
+
+// cbuffer PSClusters : register(b12)
+struct PSClusters
+{
+    static const uint32_t kRegister = 12;
+
+    float    cameraForward[3];
+    float    sliceScale;
+    float    sliceBias;
+    float    tileScale[2];
+    uint32_t clusterTilesX;
+    uint32_t clusterTilesY;
+    uint32_t clusterSlices;
+    uint32_t _pad0[2];
+};
+static_assert(sizeof(PSClusters) == 48, "PSClusters size doesn't match HLSL packing");
+static_assert(offsetof(PSClusters, cameraForward) == 0, "PSClusters::cameraForward is misaligned");
+static_assert(offsetof(PSClusters, sliceScale) == 12, "PSClusters::sliceScale is misaligned");
+static_assert(offsetof(PSClusters, sliceBias) == 16, "PSClusters::sliceBias is misaligned");
+static_assert(offsetof(PSClusters, tileScale) == 20, "PSClusters::tileScale is misaligned");
+static_assert(offsetof(PSClusters, clusterTilesX) == 28, "PSClusters::clusterTilesX is misaligned");
+static_assert(offsetof(PSClusters, clusterTilesY) == 32, "PSClusters::clusterTilesY is misaligned");
+static_assert(offsetof(PSClusters, clusterSlices) == 36, "PSClusters::clusterSlices is misaligned");
+
+// cbuffer PSPerFrame : register(b10)
+struct PSPerFrame
+{
+    static const uint32_t kRegister = 10;
+
+    float            ambientColor[3];
+    uint32_t         _pad0;
+    DirectionalLight directionalLight;
+    uint32_t         _pad1;
+    float            cameraWorldPos[3];
+    uint32_t         _pad2;
+};
+static_assert(sizeof(PSPerFrame) == 64, "PSPerFrame size doesn't match HLSL packing");
+static_assert(offsetof(PSPerFrame, ambientColor) == 0, "PSPerFrame::ambientColor is misaligned");
+static_assert(offsetof(PSPerFrame, directionalLight) == 16, "PSPerFrame::directionalLight is misaligned");
+static_assert(offsetof(PSPerFrame, cameraWorldPos) == 48, "PSPerFrame::cameraWorldPos is misaligned");
+
+// cbuffer PSPerMaterial : register(b11)
+struct PSPerMaterial
+{
+    static const uint32_t kRegister = 11;
+
+    float    colorTint[4];
+    float    specularity;
+    uint32_t diffuseSlice;
+    uint32_t normalSlice;
+    uint32_t _pad0;
+    float    diffuseRect[4];
+    float    normalRect[4];
+};
+static_assert(sizeof(PSPerMaterial) == 64, "PSPerMaterial size doesn't match HLSL packing");
+static_assert(offsetof(PSPerMaterial, colorTint) == 0, "PSPerMaterial::colorTint is misaligned");
+static_assert(offsetof(PSPerMaterial, specularity) == 16, "PSPerMaterial::specularity is misaligned");
+static_assert(offsetof(PSPerMaterial, diffuseSlice) == 20, "PSPerMaterial::diffuseSlice is misaligned");
+static_assert(offsetof(PSPerMaterial, normalSlice) == 24, "PSPerMaterial::normalSlice is misaligned");
+static_assert(offsetof(PSPerMaterial, diffuseRect) == 32, "PSPerMaterial::diffuseRect is misaligned");
+static_assert(offsetof(PSPerMaterial, normalRect) == 48, "PSPerMaterial::normalRect is misaligned");
+
+// cbuffer PSShadows : register(b13)
+struct PSShadows
+{
+    static const uint32_t kRegister = 13;
+
+    ShadowCascade shadowCascades[4];
+    uint32_t      shadowCascadeCount;
+    float         shadowTexelUV;
+    float         shadowNormalOffset;
+    uint32_t      _pad0;
+};
+static_assert(sizeof(PSShadows) == 336, "PSShadows size doesn't match HLSL packing");
+static_assert(offsetof(PSShadows, shadowCascades) == 0, "PSShadows::shadowCascades is misaligned");
+static_assert(offsetof(PSShadows, shadowCascadeCount) == 320, "PSShadows::shadowCascadeCount is misaligned");
+static_assert(offsetof(PSShadows, shadowTexelUV) == 324, "PSShadows::shadowTexelUV is misaligned");
+static_assert(offsetof(PSShadows, shadowNormalOffset) == 328, "PSShadows::shadowNormalOffset is misaligned");
+
+// cbuffer VSPerPass : register(b10)
+struct VSPerPass
+{
+    static const uint32_t kRegister = 10;
+
+    float    viewProjection[4][4];
+};
+static_assert(sizeof(VSPerPass) == 64, "VSPerPass size doesn't match HLSL packing");
+static_assert(offsetof(VSPerPass, viewProjection) == 0, "VSPerPass::viewProjection is misaligned");
+
+// cbuffer VSPerStaticEntity : register(b11)
+struct VSPerStaticEntity
+{
+    static const uint32_t kRegister = 11;
+
+    float    world[4][4];
+};
+static_assert(sizeof(VSPerStaticEntity) == 64, "VSPerStaticEntity size doesn't match HLSL packing");
+static_assert(offsetof(VSPerStaticEntity, world) == 0, "VSPerStaticEntity::world is misaligned");
+
+}
+}
+#endif
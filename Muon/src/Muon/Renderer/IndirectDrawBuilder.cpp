@@ -0,0 +1,47 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of IndirectDrawBuilder.h
+----------------------------------------------*/
+#include "IndirectDrawBuilder.h"
+
+#include <assert.h>
+
+namespace Renderer {
+
+IndirectDrawBuilder::IndirectDrawBuilder() :
+    mArgs(nullptr),
+    mDrawData(nullptr),
+    mDrawCount(0),
+    mMaxDraws(0),
+    mInstanceCount(0)
+{
+}
+
+void IndirectDrawBuilder::Begin(Memory::LinearArena& arena, uint32_t maxDraws)
+{
+    // Never hand out null arrays, even for an empty frame
+    const uint32_t capacity = maxDraws ? maxDraws : 1;
+    mArgs          = arena.AllocArray<DrawIndexedArgs>(capacity);
+    mDrawData      = arena.AllocArray<IndirectDrawData>(capacity);
+    mDrawCount     = 0;
+    mMaxDraws      = maxDraws;
+    mInstanceCount = 0;
+}
+
+uint32_t IndirectDrawBuilder::Add(DrawIndexedArgs const& args, IndirectDrawData const& data)
+{
+    if (args.IndexCountPerInstance == 0 || args.InstanceCount == 0)
+        return UINT32_MAX;
+
+    assert(mDrawCount < mMaxDraws && "IndirectDrawBuilder: more draws than Begin() reserved");
+    if (mDrawCount == mMaxDraws)
+        return UINT32_MAX;
+
+    mArgs[mDrawCount]     = args;
+    mDrawData[mDrawCount] = data;
+    mInstanceCount += args.InstanceCount;
+    return mDrawCount++;
+}
+
+}
@@ -0,0 +1,80 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Packs instancing batches into indirect draw arguments
+One argument record per batch, laid out exactly like D3D12_DRAW_INDEXED_ARGUMENTS
+(and the D3D11 DrawIndexedInstancedIndirect buffer), plus a parallel array of
+per-draw data the shaders index by draw. Written on the CPU today; a culling
+compute pass can later write the same layout straight into the GPU buffers.
+----------------------------------------------*/
+#ifndef MUON_INDIRECTDRAWBUILDER_H
+#define MUON_INDIRECTDRAWBUILDER_H
+
+#include <Muon/Memory/Allocators.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Renderer {
+
+struct DrawIndexedArgs
+{
+    uint32_t IndexCountPerInstance;
+    uint32_t InstanceCount;
+    uint32_t StartIndexLocation;
+    int32_t  BaseVertexLocation;
+    uint32_t StartInstanceLocation;
+};
+
+// The GPU reads these records back to back, so the layout is not ours to choose
+static_assert(sizeof(DrawIndexedArgs) == 20, "DrawIndexedArgs must match D3D12_DRAW_INDEXED_ARGUMENTS");
+static_assert(offsetof(DrawIndexedArgs, InstanceCount) == 4, "DrawIndexedArgs layout mismatch");
+static_assert(offsetof(DrawIndexedArgs, StartIndexLocation) == 8, "DrawIndexedArgs layout mismatch");
+static_assert(offsetof(DrawIndexedArgs, BaseVertexLocation) == 12, "DrawIndexedArgs layout mismatch");
+static_assert(offsetof(DrawIndexedArgs, StartInstanceLocation) == 16, "DrawIndexedArgs layout mismatch");
+
+// Read as a StructuredBuffer, so keep it a multiple of 16 bytes
+struct IndirectDrawData
+{
+    uint32_t MaterialIndex;
+    uint32_t MeshIndex;
+    uint32_t FirstInstance;
+    uint32_t InstanceCount;
+};
+
+static_assert(sizeof(IndirectDrawData) % 16 == 0, "IndirectDrawData must stay 16 byte aligned for structured buffers");
+
+class IndirectDrawBuilder
+{
+public:
+    IndirectDrawBuilder();
+
+    // Storage lives in arena (usually the frame arena) and is only valid until it is reset
+    void Begin(Memory::LinearArena& arena, uint32_t maxDraws);
+
+    // Empty draws are dropped, the same way a culling pass would zero them out.
+    // Returns the draw's index, or UINT32_MAX when it was dropped or the builder is full.
+    uint32_t Add(DrawIndexedArgs const& args, IndirectDrawData const& data);
+
+    uint32_t                GetDrawCount() const       { return mDrawCount; }
+    const DrawIndexedArgs*  GetArgs() const            { return mArgs;      }
+    const IndirectDrawData* GetDrawData() const        { return mDrawData;  }
+    uint32_t                GetArgsByteSize() const    { return mDrawCount * (uint32_t)sizeof(DrawIndexedArgs);  }
+    uint32_t                GetDrawDataByteSize() const { return mDrawCount * (uint32_t)sizeof(IndirectDrawData); }
+
+    uint64_t GetInstanceCount() const { return mInstanceCount; }
+
+private:
+    DrawIndexedArgs*  mArgs;
+    IndirectDrawData* mDrawData;
+    uint32_t          mDrawCount;
+    uint32_t          mMaxDraws;
+    uint64_t          mInstanceCount;
+
+public:
+    IndirectDrawBuilder(IndirectDrawBuilder const&)            = delete;
+    IndirectDrawBuilder& operator=(IndirectDrawBuilder const&) = delete;
+};
+
+}
+#endif
@@ -5,26 +5,113 @@ Description : Implementation of LightingManager.h
 ----------------------------------------------*/
 #include "LightingManager.h"
 
+#include "Camera.h"
+#include "EntityRenderer.h"
 #include "LightStructs.h"
 
+#include <math.h>
+#include <string.h>
+
 namespace Renderer
 {
-    LightingManager::LightingManager(ID3D11Device* device, ID3D11DeviceContext* context, DirectX::XMFLOAT3A cameraPos)
+    namespace
+    {
+        const UINT kClusterLightSlot   = 0;
+        const UINT kClusterGridSlot    = (UINT)PS_RESOURCES::CLUSTER_GRID - (UINT)PS_RESOURCES::CLUSTER_LIGHTS;
+        const UINT kClusterIndicesSlot = (UINT)PS_RESOURCES::CLUSTER_INDICES - (UINT)PS_RESOURCES::CLUSTER_LIGHTS;
+
+        const UINT  kShadowCascadeCount = 4;
+        const UINT  kShadowResolution   = 2048;
+        const float kShadowDistance     = 60.0f;
+
+        ID3D11Buffer* CreateStructuredBuffer(ID3D11Device* device, UINT stride, UINT count, bool dynamic, const void* pInitialData, ID3D11ShaderResourceView** out_srv)
+        {
+            D3D11_BUFFER_DESC desc = {0};
+            desc.Usage = dynamic ? D3D11_USAGE_DYNAMIC : D3D11_USAGE_DEFAULT;
+            desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+            desc.CPUAccessFlags = dynamic ? D3D11_CPU_ACCESS_WRITE : 0;
+            desc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+            desc.StructureByteStride = stride;
+            desc.ByteWidth = stride * count;
+
+            D3D11_SUBRESOURCE_DATA initialData = {0};
+            initialData.pSysMem = pInitialData;
+
+            ID3D11Buffer* buffer = nullptr;
+            COM_EXCEPT(device->CreateBuffer(&desc, pInitialData ? &initialData : nullptr, &buffer));
+
+            D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+            srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+            srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+            srvDesc.Buffer.FirstElement = 0;
+            srvDesc.Buffer.NumElements = count;
+            COM_EXCEPT(device->CreateShaderResourceView(buffer, &srvDesc, out_srv));
+
+            return buffer;
+        }
+
+        void MapDiscard(ID3D11Buffer* buffer, const void* pData, size_t byteSize, ID3D11DeviceContext* context)
+        {
+            D3D11_MAPPED_SUBRESOURCE mapped = {0};
+            COM_EXCEPT(context->Map(buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped));
+            memcpy(mapped.pData, pData, byteSize);
+            context->Unmap(buffer, 0);
+        }
+    }
+
+    LightingManager::LightingManager(ID3D11Device* device, ID3D11DeviceContext* context, DirectX::XMFLOAT3A cameraPos) :
+        mClusterBuffers{},
+        mClusterSRVs{},
+        mClusterBindPacket{},
+        mShadowMap(nullptr),
+        mShadowDSVs{},
+        mShadowSRV(nullptr),
+        mShadowSampler(nullptr),
+        mShadowRasterState(nullptr),
+        mShadowPassBindPacket{},
+        mShadowBindPacket{}
     {
         InitLights(cameraPos);
 
-        ConstantBufferUpdateManager::Populate(sizeof(cbLighting), 10, EASEL_SHADER_STAGE::ESS_PS, device, &mBindPacket);
+        mWriter.Init(sizeof(cbLighting));
+        ConstantBufferUpdateManager::PopulatePartial(sizeof(cbLighting), (UINT)PS_REGISTERS::LIGHTS, EASEL_SHADER_STAGE::ESS_PS, device, &mBindPacket);
         ConstantBufferUpdateManager::Bind(&mBindPacket, context);
+
+        InitClusteredLights(device, context);
+        InitShadows(device, context);
     }
 
     LightingManager::~LightingManager()
     {
         ConstantBufferUpdateManager::Cleanup(&mBindPacket);
+        ConstantBufferUpdateManager::Cleanup(&mClusterBindPacket);
+
+        for (UINT i = 0; i != (UINT)PS_RESOURCES::CLUSTER_COUNT; ++i)
+        {
+            mClusterSRVs[i]->Release();
+            mClusterBuffers[i]->Release();
+        }
+
+        mClusters.Destroy();
+
+        ConstantBufferUpdateManager::Cleanup(&mShadowPassBindPacket);
+        ConstantBufferUpdateManager::Cleanup(&mShadowBindPacket);
+        for (UINT c = 0; c != kShadowCascadeCount; ++c)
+            mShadowDSVs[c]->Release();
+        mShadowSRV->Release();
+        mShadowMap->Release();
+        mShadowSampler->Release();
+        mShadowRasterState->Release();
     }
 
-    void LightingManager::Update(ID3D11DeviceContext* context, float dt, DirectX::XMFLOAT3A cameraPos)
+    void LightingManager::Update(ID3D11DeviceContext* context, float dt, Camera const& camera, D3D11_VIEWPORT const& viewport)
     {
+        DirectX::XMFLOAT3A cameraPos;
+        camera.GetPosition3A(&cameraPos);
+
         UpdateLights(dt, cameraPos, context);
+        UpdateClusteredLights(dt, camera, viewport, context);
+        UpdateShadows(camera, context);
     }
 
     // AAA Case: Bring in lights directly from a "world editor" of some sort, which exports light positions, colors, etc for environment artists
@@ -55,7 +142,290 @@ namespace Renderer
         // Overwrite held camera position
         mLightData.cameraWorldPos = cameraPos;
 
-        // Overwrite constant buffer
-        ConstantBufferUpdateManager::MapUnmap(&mBindPacket, &mLightData, context);
+        // Upload whatever changed
+        mWriter.Write(0, mLightData);
+        ConstantBufferUpdateManager::UploadDirty(&mBindPacket, mWriter, context);
+    }
+
+    // Torches over the cube field, a few of them flickering, and spot lights sweeping in from the corners
+    void LightingManager::InitClusteredLights(ID3D11Device* device, ID3D11DeviceContext* context)
+    {
+        ClusterGridConfig config;
+        config.MaxLights = 1024;
+        config.MaxLightIndices = 1 << 16;
+        mClusters.Init(config);
+
+        const UINT kTorchesPerSide = 10;
+        for (UINT i = 0; i != kTorchesPerSide; ++i)
+        {
+            for (UINT j = 0; j != kTorchesPerSide; ++j)
+            {
+                ClusterLight torch;
+                torch.Position[0] = 2.0f * i + 0.5f;
+                torch.Position[1] = 1.25f;
+                torch.Position[2] = 2.0f * j + 0.5f;
+                torch.Range = 2.5f;
+                torch.Color[0] = 1.0f;
+                torch.Color[1] = 0.45f + 0.1f * ((i + j) % 3);
+                torch.Color[2] = 0.15f;
+
+                const uint32_t index = mClusters.AddLight(torch);
+                if ((i * kTorchesPerSide + j) % 3 == 0)
+                {
+                    FlickeringLight flicker = { index, { torch.Color[0], torch.Color[1], torch.Color[2] }, 0.7f * (i * kTorchesPerSide + j) };
+                    mFlickeringLights.push_back(flicker);
+                }
+            }
+        }
+
+        const float kCorners[4][2] = { { -2.0f, -2.0f }, { 21.0f, -2.0f }, { -2.0f, 21.0f }, { 21.0f, 21.0f } };
+        for (UINT c = 0; c != ARRAYSIZE(kCorners); ++c)
+        {
+            ClusterLight spot;
+            spot.Position[0] = kCorners[c][0];
+            spot.Position[1] = 8.0f;
+            spot.Position[2] = kCorners[c][1];
+            spot.Range = 24.0f;
+            spot.Color[0] = 0.35f;
+            spot.Color[1] = 0.5f;
+            spot.Color[2] = 0.9f;
+            spot.Type = (uint32_t)ClusterLightType::SPOT;
+            spot.CosOuterAngle = cosf(DirectX::XMConvertToRadians(20.0f));
+
+            DirectX::XMFLOAT3 direction;
+            DirectX::XMStoreFloat3(&direction, DirectX::XMVector3Normalize(DirectX::XMVectorSet(9.5f - spot.Position[0], -spot.Position[1], 9.5f - spot.Position[2], 0.0f)));
+            spot.Direction[0] = direction.x;
+            spot.Direction[1] = direction.y;
+            spot.Direction[2] = direction.z;
+            mClusters.AddLight(spot);
+        }
+
+        // The light buffer starts out with everything, so nothing is dirty until a light changes
+        mClusterBuffers[kClusterLightSlot] = CreateStructuredBuffer(device, sizeof(ClusterLight), config.MaxLights, false, mClusters.GetLightData(), &mClusterSRVs[kClusterLightSlot]);
+        mClusterBuffers[kClusterGridSlot] = CreateStructuredBuffer(device, sizeof(ClusterRange), mClusters.GetClusterCount(), true, nullptr, &mClusterSRVs[kClusterGridSlot]);
+        mClusterBuffers[kClusterIndicesSlot] = CreateStructuredBuffer(device, sizeof(uint32_t), config.MaxLightIndices, true, nullptr, &mClusterSRVs[kClusterIndicesSlot]);
+        mClusters.CollectDirtyLights(mDirtyLights);
+
+        context->PSSetShaderResources((UINT)PS_RESOURCES::CLUSTER_LIGHTS, (UINT)PS_RESOURCES::CLUSTER_COUNT, mClusterSRVs);
+
+        mClusterData.tilesX = config.TilesX;
+        mClusterData.tilesY = config.TilesY;
+        mClusterData.slices = config.Slices;
+
+        mClusterWriter.Init(sizeof(cbClusters));
+        ConstantBufferUpdateManager::PopulatePartial(sizeof(cbClusters), (UINT)PS_REGISTERS::CLUSTERS, EASEL_SHADER_STAGE::ESS_PS, device, &mClusterBindPacket);
+        ConstantBufferUpdateManager::Bind(&mClusterBindPacket, context);
+    }
+
+    void LightingManager::UpdateClusteredLights(float dt, Camera const& camera, D3D11_VIEWPORT const& viewport, ID3D11DeviceContext* context)
+    {
+        using namespace DirectX;
+
+        for (FlickeringLight const& flicker : mFlickeringLights)
+        {
+            ClusterLight light = mClusters.GetLight(flicker.Index);
+            const float intensity = 0.8f + 0.2f * sinf(11.0f * dt + flicker.Phase) * sinf(3.7f * dt + 2.0f * flicker.Phase);
+            for (UINT k = 0; k != 3; ++k)
+                light.Color[k] = flicker.Color[k] * intensity;
+            mClusters.UpdateLight(flicker.Index, light);
+        }
+
+        // Only the lights that changed go up, one copy per run of them
+        const UINT stride = sizeof(ClusterLight);
+        mClusters.CollectDirtyLights(mDirtyLights);
+        for (GPUTableRange const& range : mDirtyLights)
+        {
+            const D3D11_BOX box = { range.First * stride, 0, 0, (range.First + range.Count) * stride, 1, 1 };
+            context->UpdateSubresource(mClusterBuffers[kClusterLightSlot], 0, &box, mClusters.GetLightData() + range.First, 0, 0);
+        }
+
+        XMFLOAT4X4 view;
+        XMFLOAT4X4 projection;
+        XMStoreFloat4x4(&view, camera.GetView());
+        XMStoreFloat4x4(&projection, camera.GetProjection());
+
+        ClusterView clusterView;
+        memcpy(clusterView.View, &view, sizeof(clusterView.View));
+        clusterView.ProjScaleX = projection._11;
+        clusterView.ProjScaleY = projection._22;
+        clusterView.Near = camera.GetNear();
+        clusterView.Far = camera.GetFar();
+        mClusters.Build(clusterView);
+
+        MapDiscard(mClusterBuffers[kClusterGridSlot], mClusters.GetGrid(), mClusters.GetClusterCount() * sizeof(ClusterRange), context);
+        MapDiscard(mClusterBuffers[kClusterIndicesSlot], mClusters.GetLightIndices(), mClusters.GetLightIndexCount() * sizeof(uint32_t), context);
+
+        // The view's third column is the camera's forward axis in world space
+        mClusterData.cameraForward = XMFLOAT3(view._13, view._23, view._33);
+        mClusterData.sliceScale = mClusters.GetSliceScale();
+        mClusterData.sliceBias = mClusters.GetSliceBias();
+        mClusterData.tileScale = XMFLOAT2(mClusterData.tilesX / viewport.Width, mClusterData.tilesY / viewport.Height);
+
+        mClusterWriter.Write(0, mClusterData);
+        ConstantBufferUpdateManager::UploadDirty(&mClusterBindPacket, mClusterWriter, context);
+    }
+
+    void LightingManager::InitShadows(ID3D11Device* device, ID3D11DeviceContext* context)
+    {
+        ShadowCascadeConfig config;
+        config.CascadeCount       = kShadowCascadeCount;
+        config.Resolution         = kShadowResolution;
+        config.MaxDistance        = kShadowDistance;
+        config.FirstCachedCascade = 2;
+        mShadows.Init(config);
+
+        // Typeless so the same memory is a depth target while drawing and a float texture while shading
+        D3D11_TEXTURE2D_DESC mapDesc = {0};
+        mapDesc.Width = kShadowResolution;
+        mapDesc.Height = kShadowResolution;
+        mapDesc.MipLevels = 1;
+        mapDesc.ArraySize = kShadowCascadeCount;
+        mapDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+        mapDesc.SampleDesc.Count = 1;
+        mapDesc.Usage = D3D11_USAGE_DEFAULT;
+        mapDesc.BindFlags = D3D11_BIND_DEPTH_STENCIL | D3D11_BIND_SHADER_RESOURCE;
+        COM_EXCEPT(device->CreateTexture2D(&mapDesc, nullptr, &mShadowMap));
+
+        for (UINT c = 0; c != kShadowCascadeCount; ++c)
+        {
+            D3D11_DEPTH_STENCIL_VIEW_DESC dsvDesc = {};
+            dsvDesc.Format = DXGI_FORMAT_D32_FLOAT;
+            dsvDesc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2DARRAY;
+            dsvDesc.Texture2DArray.FirstArraySlice = c;
+            dsvDesc.Texture2DArray.ArraySize = 1;
+            COM_EXCEPT(device->CreateDepthStencilView(mShadowMap, &dsvDesc, &mShadowDSVs[c]));
+        }
+
+        D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+        srvDesc.Format = DXGI_FORMAT_R32_FLOAT;
+        srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+        srvDesc.Texture2DArray.MipLevels = 1;
+        srvDesc.Texture2DArray.ArraySize = kShadowCascadeCount;
+        COM_EXCEPT(device->CreateShaderResourceView(mShadowMap, &srvDesc, &mShadowSRV));
+
+        // Anything off the map is lit
+        D3D11_SAMPLER_DESC samplerDesc = {};
+        samplerDesc.Filter = D3D11_FILTER_COMPARISON_MIN_MAG_LINEAR_MIP_POINT;
+        samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_BORDER;
+        samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_BORDER;
+        samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_BORDER;
+        samplerDesc.BorderColor[0] = 1.0f;
+        samplerDesc.BorderColor[1] = 1.0f;
+        samplerDesc.BorderColor[2] = 1.0f;
+        samplerDesc.BorderColor[3] = 1.0f;
+        samplerDesc.ComparisonFunc = D3D11_COMPARISON_LESS_EQUAL;
+        samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
+        COM_EXCEPT(device->CreateSamplerState(&samplerDesc, &mShadowSampler));
+
+        // Slope scaled bias against acne. No depth clip, so casters between the sun and the scene bounds
+        // flatten onto the near plane instead of vanishing.
+        D3D11_RASTERIZER_DESC rasterDesc = {};
+        rasterDesc.FillMode = D3D11_FILL_SOLID;
+        rasterDesc.CullMode = D3D11_CULL_BACK;
+        rasterDesc.DepthBias = 1000;
+        rasterDesc.SlopeScaledDepthBias = 2.0f;
+        rasterDesc.DepthClipEnable = FALSE;
+        COM_EXCEPT(device->CreateRasterizerState(&rasterDesc, &mShadowRasterState));
+
+        context->PSSetShaderResources((UINT)PS_RESOURCES::SHADOW_MAP, 1, &mShadowSRV);
+        context->PSSetSamplers((UINT)PS_SAMPLERS::SHADOW, 1, &mShadowSampler);
+
+        ConstantBufferUpdateManager::Populate(sizeof(cbCamera), (UINT)VS_REGISTERS::CAMERA, EASEL_SHADER_STAGE::ESS_VS, device, &mShadowPassBindPacket);
+
+        mShadowData.cascadeCount = kShadowCascadeCount;
+        mShadowData.texelUV = 1.0f / kShadowResolution;
+        mShadowData.normalOffset = 1.5f;
+
+        mShadowWriter.Init(sizeof(cbShadows));
+        ConstantBufferUpdateManager::PopulatePartial(sizeof(cbShadows), (UINT)PS_REGISTERS::SHADOWS, EASEL_SHADER_STAGE::ESS_PS, device, &mShadowBindPacket);
+        ConstantBufferUpdateManager::Bind(&mShadowBindPacket, context);
+    }
+
+    void LightingManager::SetShadowBounds(DirectX::XMFLOAT3 const& min, DirectX::XMFLOAT3 const& max)
+    {
+        mShadows.SetSceneBounds(&min.x, &max.x);
+    }
+
+    void LightingManager::UpdateShadows(Camera const& camera, ID3D11DeviceContext* context)
+    {
+        using namespace DirectX;
+
+        XMFLOAT4X4 view;
+        XMFLOAT4X4 projection;
+        XMStoreFloat4x4(&view, camera.GetView());
+        XMStoreFloat4x4(&projection, camera.GetProjection());
+
+        ShadowView shadowView;
+        memcpy(shadowView.View, &view, sizeof(shadowView.View));
+        shadowView.ProjScaleX = projection._11;
+        shadowView.ProjScaleY = projection._22;
+        shadowView.Near = camera.GetNear();
+        shadowView.Far = camera.GetFar();
+
+        // The sun turns every frame, so for now the cached cascades only pay off while it's paused
+        XMFLOAT3 lightDirection;
+        XMStoreFloat3(&lightDirection, XMVector3Normalize(XMVectorNegate(XMLoadFloat3A(&mLightData.directionalLight.toLight))));
+        shadowView.LightDirection[0] = lightDirection.x;
+        shadowView.LightDirection[1] = lightDirection.y;
+        shadowView.LightDirection[2] = lightDirection.z;
+        mShadows.Update(shadowView);
+
+        for (UINT c = 0; c != kShadowCascadeCount; ++c)
+        {
+            ShadowCascade const& cascade = mShadows.GetCascade(c);
+            memcpy(&mShadowData.cascades[c].viewProjection, cascade.ViewProjection, sizeof(cascade.ViewProjection));
+            mShadowData.cascades[c].texelSize = cascade.TexelSize;
+        }
+
+        // Cached cascades don't move, so most frames only the near ones' registers go up
+        mShadowWriter.Write(0, mShadowData);
+        ConstantBufferUpdateManager::UploadDirty(&mShadowBindPacket, mShadowWriter, context);
+    }
+
+    void LightingManager::DrawShadows(ID3D11DeviceContext* context, EntityRenderer& entityRenderer)
+    {
+        if (!mShadows.GetStats().CascadesRendered)
+            return;
+
+        entityRenderer.CullShadowCasters(context, mShadows);
+
+        // The map can't be read while it's being drawn into
+        ID3D11ShaderResourceView* const nullSRV = nullptr;
+        context->PSSetShaderResources((UINT)PS_RESOURCES::SHADOW_MAP, 1, &nullSRV);
+
+        ID3D11Buffer* pCameraBuffer = nullptr;
+        ID3D11RasterizerState* pRasterState = nullptr;
+        context->VSGetConstantBuffers((UINT)VS_REGISTERS::CAMERA, 1, &pCameraBuffer);
+        context->RSGetState(&pRasterState);
+
+        const D3D11_VIEWPORT viewport = { 0.0f, 0.0f, (float)kShadowResolution, (float)kShadowResolution, 0.0f, 1.0f };
+        context->RSSetViewports(1, &viewport);
+        context->RSSetState(mShadowRasterState);
+        ConstantBufferUpdateManager::Bind(&mShadowPassBindPacket, context);
+
+        for (UINT c = 0; c != kShadowCascadeCount; ++c)
+        {
+            ShadowCascade const& cascade = mShadows.GetCascade(c);
+            if (!cascade.NeedsRender)
+                continue;
+
+            cbCamera cascadeCamera;
+            memcpy(&cascadeCamera.viewProjection, cascade.ViewProjection, sizeof(cascade.ViewProjection));
+            ConstantBufferUpdateManager::MapUnmap(&mShadowPassBindPacket, &cascadeCamera, context);
+
+            context->ClearDepthStencilView(mShadowDSVs[c], D3D11_CLEAR_DEPTH, 1.0f, 0);
+            context->OMSetRenderTargets(0, nullptr, mShadowDSVs[c]);
+            entityRenderer.DrawShadowCascade(context, c);
+        }
+
+        // Put things back how they were, minus the targets the main pass binds anyway
+        context->OMSetRenderTargets(0, nullptr, nullptr);
+        context->VSSetConstantBuffers((UINT)VS_REGISTERS::CAMERA, 1, &pCameraBuffer);
+        context->RSSetState(pRasterState);
+        context->PSSetShaderResources((UINT)PS_RESOURCES::SHADOW_MAP, 1, &mShadowSRV);
+        if (pCameraBuffer)
+            pCameraBuffer->Release();
+        if (pRasterState)
+            pRasterState->Release();
     }
 }
\ No newline at end of file
@@ -8,10 +8,18 @@ Description : Interface for management of lights in the scene
 
 #include "DXCore.h"
 #include "CBufferStructs.h"
+#include "CBufferWriter.h"
+#include "CascadedShadows.h"
+#include "ClusteredLighting.h"
 #include "ConstantBuffer.h"
 
+#include <vector>
+
 namespace Renderer {
 
+class Camera;
+class EntityRenderer;
+
 class LightingManager
 {
 public:
@@ -19,7 +27,15 @@ public:
     LightingManager()  = delete;
     ~LightingManager();
 
-    void Update(ID3D11DeviceContext* context, float dt, DirectX::XMFLOAT3A cameraPos);
+    // Also rebins the clustered lights and refits the shadow cascades to the camera's view, so call it after the camera moves
+    void Update(ID3D11DeviceContext* context, float dt, Camera const& camera, D3D11_VIEWPORT const& viewport);
+
+    // Renders the sun's shadow cascades that need it. Leaves the render target and viewport unbound, so call it
+    // before the main pass binds its own. After the entities' Update.
+    void DrawShadows(ID3D11DeviceContext* context, EntityRenderer& entityRenderer);
+
+    // Everything that can cast or receive sun shadows, see CascadedShadows::SetSceneBounds
+    void SetShadowBounds(DirectX::XMFLOAT3 const& min, DirectX::XMFLOAT3 const& max);
     
     // Public Setter for the scene to be able to change the ambient color in the light buffer
     inline void SetAmbient(DirectX::XMFLOAT3A ambientColor)
@@ -34,11 +50,61 @@ private:
     // Updates the data in each directional light
     void UpdateLights(float dt, DirectX::XMFLOAT3A cameraPos, ID3D11DeviceContext* context);
 
+    // Places the point and spot lights and creates the buffers the CLUSTERED_LIGHTS shaders read
+    void InitClusteredLights(ID3D11Device* device, ID3D11DeviceContext* context);
+
+    // Animates the flickering lights, uploads the ones that changed and the new grid
+    void UpdateClusteredLights(float dt, Camera const& camera, D3D11_VIEWPORT const& viewport, ID3D11DeviceContext* context);
+
+    // Creates the shadow map array and its states, and binds what the SHADOWS shaders read
+    void InitShadows(ID3D11Device* device, ID3D11DeviceContext* context);
+
+    // Fits the cascades to the camera and the sun, and uploads PSShadows
+    void UpdateShadows(Camera const& camera, ID3D11DeviceContext* context);
+
 private:
     ConstantBufferBindPacket mBindPacket;
 
     // Constant buffer struct
     cbLighting mLightData;
+
+    // Shadow of the GPU copy, so only the registers that moved get uploaded (the ambient rarely does)
+    CBufferWriter mWriter;
+
+    struct FlickeringLight
+    {
+        uint32_t Index;
+        float    Color[3];
+        float    Phase;
+    };
+
+    ClusteredLighting                mClusters;
+    std::vector<FlickeringLight>     mFlickeringLights;
+    std::vector<GPUTableRange>       mDirtyLights;
+
+    // Indexed by PS_RESOURCES - CLUSTER_LIGHTS. Lights are DEFAULT and patched per dirty range,
+    // the grid and index list are rewritten whole every frame.
+    ID3D11Buffer*                    mClusterBuffers[(UINT)PS_RESOURCES::CLUSTER_COUNT];
+    ID3D11ShaderResourceView*        mClusterSRVs[(UINT)PS_RESOURCES::CLUSTER_COUNT];
+
+    ConstantBufferBindPacket         mClusterBindPacket;
+    cbClusters                       mClusterData;
+    CBufferWriter                    mClusterWriter;
+
+    // One slice per cascade. Cached cascades keep their slice from an earlier frame.
+    CascadedShadows                  mShadows;
+    ID3D11Texture2D*                 mShadowMap;
+    ID3D11DepthStencilView*          mShadowDSVs[kMaxShadowCascades];
+    ID3D11ShaderResourceView*        mShadowSRV;
+    ID3D11SamplerState*              mShadowSampler;
+    ID3D11RasterizerState*           mShadowRasterState;
+
+    // VSPerPass while drawing a cascade, in place of the camera's
+    ConstantBufferBindPacket         mShadowPassBindPacket;
+
+    ConstantBufferBindPacket         mShadowBindPacket;
+    cbShadows                        mShadowData;
+    CBufferWriter                    mShadowWriter;
 };
 
 }
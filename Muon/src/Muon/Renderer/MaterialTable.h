@@ -0,0 +1,36 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : The bindless material table
+Every material's parameters and texture descriptor indices live in one GPU structured buffer,
+and each instance carries the index of its entry. Nothing is bound per material, so any mix of
+materials can share a draw, including one indirect batch.
+----------------------------------------------*/
+#ifndef MUON_MATERIALTABLE_H
+#define MUON_MATERIALTABLE_H
+
+#include "GPUTable.h"
+
+namespace Renderer {
+
+static const uint32_t kInvalidMaterialIndex = kInvalidTableIndex;
+
+// Texture slots no texture was given for. Shaders test for it before indexing the heap.
+static const uint32_t kNoDescriptor = UINT32_MAX;
+
+// One entry of StructuredBuffer<GPUMaterial>, see Assets/Shaders/MaterialTable.hlsli
+struct GPUMaterial
+{
+    float    ColorTint[4]   = { 0.0f, 0.0f, 0.0f, 1.0f };
+    float    SpecularExp    = 0.0f;
+    uint32_t DiffuseIndex   = kNoDescriptor;   // Into the shader visible CBV/SRV/UAV heap
+    uint32_t NormalIndex    = kNoDescriptor;
+    uint32_t Flags          = 0;
+};
+
+static_assert(sizeof(GPUMaterial) % 16 == 0, "GPUMaterial must stay 16 byte aligned for structured buffers");
+
+typedef GPUTable<GPUMaterial> MaterialTable;
+
+}
+#endif
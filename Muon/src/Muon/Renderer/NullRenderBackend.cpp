@@ -0,0 +1,599 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of NullRenderBackend.h
+----------------------------------------------*/
+#include "NullRenderBackend.h"
+
+#include "hash_util.h"
+#include "IndirectDrawBuilder.h"
+
+#include <Muon/Core/Profiler.h>
+
+#include <algorithm>
+#include <assert.h>
+#include <string.h>
+
+namespace Renderer {
+
+namespace {
+
+// The simulated GPU ticks at 100 MHz from its own arbitrary epoch, so calibration has something to undo
+const uint64_t kNullTimestampFrequency = 100000000;
+const uint64_t kNullNsPerTick          = 1000000000 / kNullTimestampFrequency;
+const uint64_t kNullGPUClockEpoch      = 0x5000000000ull;
+
+// Resolved timestamps become readable this many frames after the one that resolved them
+const uint32_t kNullReadbackLatency = 2;
+
+uint64_t ToNullGPUTicks(uint64_t cpuNs)
+{
+    return cpuNs / kNullNsPerTick + kNullGPUClockEpoch;
+}
+
+}
+
+/////////////////////////////////////////////////////////////////////
+// NullRenderContext
+
+NullRenderContext::NullRenderContext(NullRenderBackend const& owner) :
+    mOwner(owner),
+    mStats(),
+    mRecording(false)
+{
+}
+
+void NullRenderContext::Reset(bool recording)
+{
+    mCommands.clear();
+    mStats = NullBackendStats();
+    mRecording = recording;
+}
+
+void NullRenderContext::Append(NullRenderContext& other)
+{
+    mCommands.insert(mCommands.end(), other.mCommands.begin(), other.mCommands.end());
+
+    mStats.DrawCalls           += other.mStats.DrawCalls;
+    mStats.IndirectSubmissions += other.mStats.IndirectSubmissions;
+    mStats.StateChanges        += other.mStats.StateChanges;
+    mStats.Instances           += other.mStats.Instances;
+    mStats.Triangles           += other.mStats.Triangles;
+
+    // Like a D3D11 command list, a deferred context is consumed by executing it
+    other.Reset(true);
+}
+
+void NullRenderContext::SetShaders(ShaderHandle vertexShader, ShaderHandle pixelShader)
+{
+    assert(mOwner.IsLive(vertexShader, NullRenderBackend::ResourceKind::SHADER) && mOwner.IsLive(pixelShader, NullRenderBackend::ResourceKind::SHADER));
+    mStats.StateChanges++;
+    Record(BackendCommandType::SET_SHADERS, vertexShader, pixelShader);
+}
+
+void NullRenderContext::SetVertexBuffer(uint32_t slot, BufferHandle buffer, uint32_t stride)
+{
+    assert(mOwner.IsLive(buffer, NullRenderBackend::ResourceKind::BUFFER));
+    mStats.StateChanges++;
+    Record(BackendCommandType::SET_VERTEX_BUFFER, slot, buffer, stride);
+}
+
+void NullRenderContext::SetIndexBuffer(BufferHandle buffer)
+{
+    assert(mOwner.IsLive(buffer, NullRenderBackend::ResourceKind::BUFFER));
+    mStats.StateChanges++;
+    Record(BackendCommandType::SET_INDEX_BUFFER, buffer);
+}
+
+void NullRenderContext::SetConstantBuffer(ShaderStage stage, uint32_t slot, BufferHandle buffer)
+{
+    assert(mOwner.IsLive(buffer, NullRenderBackend::ResourceKind::BUFFER));
+    mStats.StateChanges++;
+    Record(BackendCommandType::SET_CONSTANT_BUFFER, (uint32_t)stage, slot, buffer);
+}
+
+void NullRenderContext::SetTexture(ShaderStage stage, uint32_t slot, TextureHandle texture)
+{
+    assert(mOwner.IsLive(texture, NullRenderBackend::ResourceKind::TEXTURE));
+    mStats.StateChanges++;
+    Record(BackendCommandType::SET_TEXTURE, (uint32_t)stage, slot, texture);
+}
+
+void NullRenderContext::SetStructuredBuffer(ShaderStage stage, uint32_t slot, BufferHandle buffer)
+{
+    assert(mOwner.IsLive(buffer, NullRenderBackend::ResourceKind::BUFFER));
+    mStats.StateChanges++;
+    Record(BackendCommandType::SET_STRUCTURED_BUFFER, (uint32_t)stage, slot, buffer);
+}
+
+void NullRenderContext::Draw(uint32_t vertexCount, uint32_t startVertex)
+{
+    mStats.DrawCalls++;
+    mStats.Instances++;
+    mStats.Triangles += vertexCount / 3;
+    Record(BackendCommandType::DRAW, vertexCount, startVertex);
+}
+
+void NullRenderContext::DrawIndexed(uint32_t indexCount, uint32_t startIndex, int32_t baseVertex)
+{
+    mStats.DrawCalls++;
+    mStats.Instances++;
+    mStats.Triangles += indexCount / 3;
+    Record(BackendCommandType::DRAW_INDEXED, indexCount, startIndex, (uint32_t)baseVertex);
+}
+
+void NullRenderContext::DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex, uint32_t startInstance)
+{
+    mStats.DrawCalls++;
+    mStats.Instances += instanceCount;
+    mStats.Triangles += (uint64_t)(indexCount / 3) * instanceCount;
+    Record(BackendCommandType::DRAW_INDEXED_INSTANCED, indexCount, instanceCount, startIndex, (uint32_t)baseVertex, startInstance);
+}
+
+void NullRenderContext::ExecuteIndirect(BufferHandle argsBuffer, uint32_t drawCount)
+{
+    assert(mOwner.IsLive(argsBuffer, NullRenderBackend::ResourceKind::BUFFER));
+
+    // Expand the records the way the command processor would, so the result is directly comparable to direct draws
+    std::vector<uint8_t> const& contents = mOwner.mResources[argsBuffer - 1].Contents;
+    assert(contents.size() >= (size_t)drawCount * sizeof(DrawIndexedArgs) && "NullRenderBackend: ExecuteIndirect reads past the argument buffer");
+    if (contents.size() < (size_t)drawCount * sizeof(DrawIndexedArgs))
+        return;
+
+    mStats.IndirectSubmissions++;
+    Record(BackendCommandType::EXECUTE_INDIRECT, argsBuffer, drawCount);
+
+    for (uint32_t i = 0; i != drawCount; ++i)
+    {
+        DrawIndexedArgs args;
+        memcpy(&args, contents.data() + i * sizeof(DrawIndexedArgs), sizeof(args));
+        DrawIndexedInstanced(args.IndexCountPerInstance, args.InstanceCount, args.StartIndexLocation, args.BaseVertexLocation, args.StartInstanceLocation);
+    }
+}
+
+void NullRenderContext::WriteTimestamp(QueryHeapHandle heap, uint32_t index)
+{
+    assert(mOwner.IsLive(heap, NullRenderBackend::ResourceKind::QUERY_HEAP));
+    assert(index < mOwner.mResources[heap - 1].Written.size() && "NullRenderBackend: timestamp past the end of the heap");
+    Record(BackendCommandType::WRITE_TIMESTAMP, heap, index);
+}
+
+void NullRenderContext::Record(BackendCommandType type, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3, uint32_t a4)
+{
+    assert(mRecording && "NullRenderBackend: command recorded outside BeginFrame/EndFrame");
+    mCommands.push_back({ type, { a0, a1, a2, a3, a4 } });
+}
+
+/////////////////////////////////////////////////////////////////////
+// NullRenderBackend
+
+NullRenderBackend::NullRenderBackend(uint32_t deferredContextCount) :
+    mImmediate(*this),
+    mStats(),
+    mInFrame(false),
+    mGPUBusyUntilNs(0),
+    mQueryHeapCount(0)
+{
+    mDeferred.reserve(deferredContextCount);
+    for (uint32_t i = 0; i != deferredContextCount; ++i)
+        mDeferred.emplace_back(new NullRenderContext(*this));
+}
+
+NullRenderBackend::~NullRenderBackend()
+{
+}
+
+BackendHandle NullRenderBackend::AddResource(ResourceKind kind, uint64_t byteSize, bool keepContents)
+{
+    BackendHandle handle;
+    if (!mFreeHandles.empty())
+    {
+        handle = mFreeHandles.back();
+        mFreeHandles.pop_back();
+    }
+    else
+    {
+        mResources.emplace_back();
+        handle = (BackendHandle)mResources.size();
+    }
+
+    ResourceRecord& record = mResources[handle - 1];
+    record.Kind     = kind;
+    record.ByteSize = byteSize;
+    record.Texture  = TextureDesc();
+    record.Contents.assign(keepContents ? byteSize : 0, 0);
+    record.Written.clear();
+    record.Resolved.clear();
+    record.ReadyFrame.clear();
+
+    switch (kind)
+    {
+    case ResourceKind::BUFFER:  mStats.BufferCount++;  mStats.BufferBytes  += byteSize; break;
+    case ResourceKind::TEXTURE: mStats.TextureCount++; mStats.TextureBytes += byteSize; break;
+    case ResourceKind::SHADER:  mStats.ShaderCount++;  mStats.ShaderBytes  += byteSize; break;
+    default: break;
+    }
+
+    return handle;
+}
+
+bool NullRenderBackend::IsLive(BackendHandle handle, ResourceKind kind) const
+{
+    return handle != kInvalidBackendHandle && handle <= mResources.size() && mResources[handle - 1].Kind == kind;
+}
+
+BufferHandle NullRenderBackend::CreateBuffer(BufferDesc const& desc, const void* pInitialData)
+{
+    assert(desc.ByteSize != 0);
+
+    const bool keepContents = desc.Usage == BufferUsage::INDIRECT_ARGS;
+    BufferHandle handle = AddResource(ResourceKind::BUFFER, desc.ByteSize, keepContents);
+    if (keepContents && pInitialData)
+        memcpy(mResources[handle - 1].Contents.data(), pInitialData, desc.ByteSize);
+
+    return handle;
+}
+
+TextureHandle NullRenderBackend::CreateTexture(TextureDesc const& desc, const void* pInitialData)
+{
+    (void)pInitialData;
+
+    // Full mip chain footprint, mips never go below one texel
+    uint64_t byteSize = 0;
+    for (uint32_t mip = 0; mip != std::max<uint32_t>(desc.MipLevels, 1); ++mip)
+    {
+        const uint64_t w = std::max<uint32_t>(desc.Width >> mip, 1);
+        const uint64_t h = std::max<uint32_t>(desc.Height >> mip, 1);
+        byteSize += w * h * desc.BytesPerPixel;
+    }
+    byteSize *= std::max<uint32_t>(desc.ArraySize, 1);
+
+    TextureHandle handle = AddResource(ResourceKind::TEXTURE, byteSize);
+    mResources[handle - 1].Texture = desc;
+    return handle;
+}
+
+ShaderHandle NullRenderBackend::CreateShader(ShaderStage stage, const void* pBytecode, size_t bytecodeSize)
+{
+    (void)stage;
+    (void)pBytecode;
+    return AddResource(ResourceKind::SHADER, bytecodeSize);
+}
+
+void NullRenderBackend::DestroyResource(BackendHandle handle)
+{
+    if (handle == kInvalidBackendHandle || handle > mResources.size())
+        return;
+
+    ResourceRecord& resource = mResources[handle - 1];
+    switch (resource.Kind)
+    {
+    case ResourceKind::BUFFER:  mStats.BufferCount--;  mStats.BufferBytes  -= resource.ByteSize; break;
+    case ResourceKind::TEXTURE: mStats.TextureCount--; mStats.TextureBytes -= resource.ByteSize; break;
+    case ResourceKind::SHADER:  mStats.ShaderCount--;  mStats.ShaderBytes  -= resource.ByteSize; break;
+    case ResourceKind::QUERY_HEAP: mQueryHeapCount--; break;
+    default:
+        assert(false && "NullRenderBackend: double destroy");
+        return;
+    }
+
+    resource.Kind = ResourceKind::NONE;
+    resource.ByteSize = 0;
+    resource.Contents.clear();
+    mFreeHandles.push_back(handle);
+}
+
+QueryHeapHandle NullRenderBackend::CreateTimestampHeap(uint32_t count)
+{
+    assert(count != 0);
+
+    QueryHeapHandle handle = AddResource(ResourceKind::QUERY_HEAP, (uint64_t)count * sizeof(uint64_t));
+    ResourceRecord& record = mResources[handle - 1];
+    record.Written.assign(count, 0);
+    record.Resolved.assign(count, 0);
+    record.ReadyFrame.assign(count, ~0u);
+    mQueryHeapCount++;
+    return handle;
+}
+
+void NullRenderBackend::DestroyTimestampHeap(QueryHeapHandle heap)
+{
+    assert(heap == kInvalidBackendHandle || IsLive(heap, ResourceKind::QUERY_HEAP));
+    DestroyResource(heap);
+}
+
+void NullRenderBackend::UpdateBuffer(BufferHandle buffer, const void* pData, uint32_t byteSize)
+{
+    UpdateBufferRange(buffer, 0, pData, byteSize);
+}
+
+void NullRenderBackend::UpdateBufferRange(BufferHandle buffer, uint32_t byteOffset, const void* pData, uint32_t byteSize)
+{
+    assert(IsLive(buffer, ResourceKind::BUFFER));
+    assert((uint64_t)byteOffset + byteSize <= mResources[buffer - 1].ByteSize && "NullRenderBackend: buffer update overruns the buffer");
+
+    std::vector<uint8_t>& contents = mResources[buffer - 1].Contents;
+    if (!contents.empty() && pData)
+        memcpy(contents.data() + byteOffset, pData, byteSize);
+
+    mImmediate.mStats.UploadBytes += byteSize;
+    mImmediate.Record(BackendCommandType::UPDATE_BUFFER, buffer, byteSize, byteOffset);
+}
+
+void NullRenderBackend::UpdateTexture(TextureHandle texture, uint32_t mip, const void* pData, uint32_t byteSize)
+{
+    (void)pData;
+    assert(IsLive(texture, ResourceKind::TEXTURE));
+    assert(mip < std::max<uint32_t>(mResources[texture - 1].Texture.MipLevels, 1) && "NullRenderBackend: texture update past the last mip");
+
+    mImmediate.mStats.UploadBytes += byteSize;
+    mImmediate.Record(BackendCommandType::UPDATE_TEXTURE, texture, mip, byteSize);
+}
+
+void NullRenderBackend::CopyTextureMips(TextureHandle dst, uint32_t dstMip, TextureHandle src, uint32_t srcMip, uint32_t mipCount)
+{
+    assert(IsLive(dst, ResourceKind::TEXTURE) && IsLive(src, ResourceKind::TEXTURE));
+
+    TextureDesc const& dstDesc = mResources[dst - 1].Texture;
+    TextureDesc const& srcDesc = mResources[src - 1].Texture;
+    assert(dstMip + mipCount <= std::max<uint32_t>(dstDesc.MipLevels, 1) && srcMip + mipCount <= std::max<uint32_t>(srcDesc.MipLevels, 1));
+    assert(std::max<uint32_t>(dstDesc.Width >> dstMip, 1) == std::max<uint32_t>(srcDesc.Width >> srcMip, 1) && "NullRenderBackend: copied mips differ in size");
+
+    for (uint32_t i = 0; i != mipCount; ++i)
+    {
+        const uint64_t w = std::max<uint32_t>(srcDesc.Width >> (srcMip + i), 1);
+        const uint64_t h = std::max<uint32_t>(srcDesc.Height >> (srcMip + i), 1);
+        mImmediate.mStats.CopyBytes += w * h * srcDesc.BytesPerPixel;
+    }
+
+    mImmediate.Record(BackendCommandType::COPY_TEXTURE_MIPS, dst, dstMip, src, srcMip, mipCount);
+}
+
+void NullRenderBackend::ResolveTimestamps(QueryHeapHandle heap, uint32_t first, uint32_t count)
+{
+    assert(IsLive(heap, ResourceKind::QUERY_HEAP));
+    ResourceRecord& record = mResources[heap - 1];
+    assert((uint64_t)first + count <= record.Written.size() && "NullRenderBackend: resolve past the end of the heap");
+
+    // Whatever was resolved there before is gone once this is queued, the new values arrive with the GPU
+    std::fill(record.ReadyFrame.begin() + first, record.ReadyFrame.begin() + first + count, ~0u);
+    mImmediate.Record(BackendCommandType::RESOLVE_TIMESTAMPS, heap, first, count);
+}
+
+bool NullRenderBackend::ReadTimestamps(QueryHeapHandle heap, uint32_t first, uint32_t count, uint64_t* out_ticks)
+{
+    assert(IsLive(heap, ResourceKind::QUERY_HEAP));
+    ResourceRecord const& record = mResources[heap - 1];
+    assert((uint64_t)first + count <= record.Resolved.size());
+
+    for (uint32_t i = first; i != first + count; ++i)
+    {
+        if (record.ReadyFrame[i] > mStats.FrameCount)
+            return false;
+    }
+
+    memcpy(out_ticks, record.Resolved.data() + first, count * sizeof(uint64_t));
+    return true;
+}
+
+uint64_t NullRenderBackend::GetTimestampFrequency() const
+{
+    return kNullTimestampFrequency;
+}
+
+void NullRenderBackend::GetClockCalibration(uint64_t& out_gpuTicks, uint64_t& out_cpuNs)
+{
+    out_cpuNs = Core::Profiler::Now();
+    out_gpuTicks = ToNullGPUTicks(out_cpuNs);
+}
+
+void NullRenderBackend::SimulateGPU()
+{
+    // The GPU picks the frame up once it's submitted, or once it's done with the last one if that's later
+    double timeNs = (double)std::max(Core::Profiler::Now(), mGPUBusyUntilNs);
+
+    for (BackendCommand const& cmd : mImmediate.mCommands)
+    {
+        timeNs += mGPUCost.PerCommand;
+
+        switch (cmd.Type)
+        {
+        case BackendCommandType::DRAW:
+        case BackendCommandType::DRAW_INDEXED:
+            timeNs += mGPUCost.PerDraw + mGPUCost.PerTriangle * (cmd.Args[0] / 3);
+            break;
+        case BackendCommandType::DRAW_INDEXED_INSTANCED:
+            timeNs += mGPUCost.PerDraw + mGPUCost.PerTriangle * (double)(cmd.Args[0] / 3) * cmd.Args[1];
+            break;
+        case BackendCommandType::UPDATE_BUFFER:
+            timeNs += mGPUCost.PerUploadKB * cmd.Args[1] / 1024.0;
+            break;
+        case BackendCommandType::UPDATE_TEXTURE:
+            timeNs += mGPUCost.PerUploadKB * cmd.Args[2] / 1024.0;
+            break;
+        case BackendCommandType::COPY_TEXTURE_MIPS:
+        {
+            TextureDesc const& src = mResources[cmd.Args[2] - 1].Texture;
+            for (uint32_t mip = cmd.Args[3]; mip != cmd.Args[3] + cmd.Args[4]; ++mip)
+            {
+                const uint64_t w = std::max<uint32_t>(src.Width >> mip, 1);
+                const uint64_t h = std::max<uint32_t>(src.Height >> mip, 1);
+                timeNs += mGPUCost.PerCopyKB * (double)(w * h * src.BytesPerPixel) / 1024.0;
+            }
+            break;
+        }
+        case BackendCommandType::WRITE_TIMESTAMP:
+            mResources[cmd.Args[0] - 1].Written[cmd.Args[1]] = ToNullGPUTicks((uint64_t)timeNs);
+            break;
+        case BackendCommandType::RESOLVE_TIMESTAMPS:
+        {
+            ResourceRecord& heap = mResources[cmd.Args[0] - 1];
+            for (uint32_t i = cmd.Args[1]; i != cmd.Args[1] + cmd.Args[2]; ++i)
+            {
+                heap.Resolved[i] = heap.Written[i];
+                heap.ReadyFrame[i] = mStats.FrameCount + 1 + kNullReadbackLatency;
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    mGPUBusyUntilNs = (uint64_t)timeNs;
+}
+
+void NullRenderBackend::BeginFrame()
+{
+    assert(!mInFrame);
+    mInFrame = true;
+
+    mImmediate.Reset(true);
+    for (auto& pContext : mDeferred)
+        pContext->Reset(true);
+}
+
+void NullRenderBackend::EndFrame()
+{
+    assert(mInFrame);
+    mInFrame = false;
+
+    // Anything left in a deferred context was never executed and is dropped
+    mImmediate.mRecording = false;
+    for (auto& pContext : mDeferred)
+        pContext->Reset(false);
+
+    // Commands hash field by field; BackendCommand has padding after Type.
+    // Timestamps are left out so timing a run doesn't change what it's compared by.
+    uint64_t hash = fnv1a64(nullptr, 0);
+    for (BackendCommand const& cmd : mImmediate.mCommands)
+    {
+        if (cmd.Type == BackendCommandType::WRITE_TIMESTAMP || cmd.Type == BackendCommandType::RESOLVE_TIMESTAMPS)
+            continue;
+
+        hash = fnv1a64(&cmd.Type, sizeof(cmd.Type), hash);
+        hash = fnv1a64(cmd.Args, sizeof(cmd.Args), hash);
+    }
+
+    uint64_t drawHash = fnv1a64(nullptr, 0);
+    for (BackendCommand const& cmd : mImmediate.mCommands)
+    {
+        if (cmd.Type == BackendCommandType::DRAW_INDEXED_INSTANCED)
+            drawHash = fnv1a64(cmd.Args, sizeof(cmd.Args), drawHash);
+    }
+
+    NullBackendStats const& frame = mImmediate.mStats;
+    mStats.DrawCalls           = frame.DrawCalls;
+    mStats.IndirectSubmissions = frame.IndirectSubmissions;
+    mStats.StateChanges        = frame.StateChanges;
+    mStats.Instances           = frame.Instances;
+    mStats.Triangles           = frame.Triangles;
+    mStats.UploadBytes         = frame.UploadBytes;
+    mStats.CopyBytes           = frame.CopyBytes;
+    mStats.DeferredContexts    = frame.DeferredContexts;
+    mStats.CommandHash         = hash;
+    mStats.DrawArgsHash        = drawHash;
+
+    // Nothing can observe the simulated GPU without a query heap
+    if (mQueryHeapCount)
+        SimulateGPU();
+
+    mStats.FrameCount++;
+}
+
+IRenderContext* NullRenderBackend::GetDeferredContext(uint32_t index)
+{
+    assert(index < mDeferred.size());
+    return mDeferred[index].get();
+}
+
+void NullRenderBackend::ExecuteDeferredContext(IRenderContext* pContext)
+{
+    assert(mInFrame);
+
+    auto it = std::find_if(mDeferred.begin(), mDeferred.end(), [pContext](std::unique_ptr<NullRenderContext> const& p) { return p.get() == pContext; });
+    assert(it != mDeferred.end() && "NullRenderBackend: context does not belong to this backend");
+
+    mImmediate.Append(**it);
+    mImmediate.mStats.DeferredContexts++;
+}
+
+void NullRenderBackend::SetShaders(ShaderHandle vertexShader, ShaderHandle pixelShader)
+{
+    mImmediate.SetShaders(vertexShader, pixelShader);
+}
+
+void NullRenderBackend::SetVertexBuffer(uint32_t slot, BufferHandle buffer, uint32_t stride)
+{
+    mImmediate.SetVertexBuffer(slot, buffer, stride);
+}
+
+void NullRenderBackend::SetIndexBuffer(BufferHandle buffer)
+{
+    mImmediate.SetIndexBuffer(buffer);
+}
+
+void NullRenderBackend::SetConstantBuffer(ShaderStage stage, uint32_t slot, BufferHandle buffer)
+{
+    mImmediate.SetConstantBuffer(stage, slot, buffer);
+}
+
+void NullRenderBackend::SetTexture(ShaderStage stage, uint32_t slot, TextureHandle texture)
+{
+    mImmediate.SetTexture(stage, slot, texture);
+}
+
+void NullRenderBackend::SetStructuredBuffer(ShaderStage stage, uint32_t slot, BufferHandle buffer)
+{
+    mImmediate.SetStructuredBuffer(stage, slot, buffer);
+}
+
+void NullRenderBackend::Draw(uint32_t vertexCount, uint32_t startVertex)
+{
+    mImmediate.Draw(vertexCount, startVertex);
+}
+
+void NullRenderBackend::DrawIndexed(uint32_t indexCount, uint32_t startIndex, int32_t baseVertex)
+{
+    mImmediate.DrawIndexed(indexCount, startIndex, baseVertex);
+}
+
+void NullRenderBackend::DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex, uint32_t startInstance)
+{
+    mImmediate.DrawIndexedInstanced(indexCount, instanceCount, startIndex, baseVertex, startInstance);
+}
+
+void NullRenderBackend::ExecuteIndirect(BufferHandle argsBuffer, uint32_t drawCount)
+{
+    mImmediate.ExecuteIndirect(argsBuffer, drawCount);
+}
+
+void NullRenderBackend::WriteTimestamp(QueryHeapHandle heap, uint32_t index)
+{
+    mImmediate.WriteTimestamp(heap, index);
+}
+
+const char* NullRenderBackend::GetCommandName(BackendCommandType type)
+{
+    switch (type)
+    {
+    case BackendCommandType::SET_SHADERS:            return "SetShaders";
+    case BackendCommandType::SET_VERTEX_BUFFER:      return "SetVertexBuffer";
+    case BackendCommandType::SET_INDEX_BUFFER:       return "SetIndexBuffer";
+    case BackendCommandType::SET_CONSTANT_BUFFER:    return "SetConstantBuffer";
+    case BackendCommandType::SET_TEXTURE:            return "SetTexture";
+    case BackendCommandType::SET_STRUCTURED_BUFFER:  return "SetStructuredBuffer";
+    case BackendCommandType::UPDATE_BUFFER:          return "UpdateBuffer";
+    case BackendCommandType::UPDATE_TEXTURE:         return "UpdateTexture";
+    case BackendCommandType::COPY_TEXTURE_MIPS:      return "CopyTextureMips";
+    case BackendCommandType::DRAW:                   return "Draw";
+    case BackendCommandType::DRAW_INDEXED:           return "DrawIndexed";
+    case BackendCommandType::DRAW_INDEXED_INSTANCED: return "DrawIndexedInstanced";
+    case BackendCommandType::EXECUTE_INDIRECT:       return "ExecuteIndirect";
+    case BackendCommandType::WRITE_TIMESTAMP:        return "WriteTimestamp";
+    case BackendCommandType::RESOLVE_TIMESTAMPS:     return "ResolveTimestamps";
+    default:                                         return "Unknown";
+    }
+}
+
+}
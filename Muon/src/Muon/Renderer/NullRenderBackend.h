@@ -0,0 +1,222 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Backend that creates nothing and records everything
+Tracks resource byte sizes and the per-frame command stream so headless runs
+can be measured and compared against each other. Timestamps come from a
+simulated GPU that runs each frame after it's submitted, at a cost per command.
+----------------------------------------------*/
+#ifndef MUON_NULLRENDERBACKEND_H
+#define MUON_NULLRENDERBACKEND_H
+
+#include "RenderBackend.h"
+
+#include <memory>
+#include <vector>
+
+namespace Renderer {
+
+enum class BackendCommandType : uint8_t
+{
+    SET_SHADERS,
+    SET_VERTEX_BUFFER,
+    SET_INDEX_BUFFER,
+    SET_CONSTANT_BUFFER,
+    SET_TEXTURE,
+    SET_STRUCTURED_BUFFER,
+    UPDATE_BUFFER,
+    UPDATE_TEXTURE,
+    COPY_TEXTURE_MIPS,
+    DRAW,
+    DRAW_INDEXED,
+    DRAW_INDEXED_INSTANCED,
+    EXECUTE_INDIRECT,       // Followed by the DRAW_INDEXED_INSTANCED commands it expanded to
+    WRITE_TIMESTAMP,
+    RESOLVE_TIMESTAMPS,
+    COUNT
+};
+
+// What the simulated GPU charges for each command, in nanoseconds
+struct NullGPUCostModel
+{
+    double PerCommand   = 50.0;
+    double PerDraw      = 2000.0;
+    double PerTriangle  = 0.25;
+    double PerUploadKB  = 64.0;     // ~16 GB/s
+    double PerCopyKB    = 16.0;     // ~64 GB/s
+};
+
+struct BackendCommand
+{
+    BackendCommandType Type;
+    uint32_t           Args[5];
+};
+
+struct NullBackendStats
+{
+    // Live resources
+    uint32_t BufferCount;
+    uint32_t TextureCount;
+    uint32_t ShaderCount;
+    uint64_t BufferBytes;
+    uint64_t TextureBytes;
+    uint64_t ShaderBytes;
+
+    // Last completed frame. Draws inside an ExecuteIndirect count individually in DrawCalls.
+    uint32_t DrawCalls;
+    uint32_t IndirectSubmissions;
+    uint32_t StateChanges;
+    uint64_t Instances;
+    uint64_t Triangles;
+    uint64_t UploadBytes;           // Buffers and textures
+    uint64_t CopyBytes;             // GPU to GPU
+    uint64_t CommandHash;
+    uint64_t DrawArgsHash;          // Only the draws' arguments, so direct and indirect submission of the same draws match
+    uint32_t DeferredContexts;      // Executed into the frame
+
+    uint32_t FrameCount;
+};
+
+class NullRenderBackend;
+
+// One command stream. The backend's immediate context is one of these, and so is each deferred context.
+class NullRenderContext final : public IRenderContext
+{
+public:
+    explicit NullRenderContext(NullRenderBackend const& owner);
+
+    void SetShaders(ShaderHandle vertexShader, ShaderHandle pixelShader) override;
+    void SetVertexBuffer(uint32_t slot, BufferHandle buffer, uint32_t stride) override;
+    void SetIndexBuffer(BufferHandle buffer) override;
+    void SetConstantBuffer(ShaderStage stage, uint32_t slot, BufferHandle buffer) override;
+    void SetTexture(ShaderStage stage, uint32_t slot, TextureHandle texture) override;
+    void SetStructuredBuffer(ShaderStage stage, uint32_t slot, BufferHandle buffer) override;
+
+    void Draw(uint32_t vertexCount, uint32_t startVertex) override;
+    void DrawIndexed(uint32_t indexCount, uint32_t startIndex, int32_t baseVertex) override;
+    void DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex, uint32_t startInstance) override;
+    void ExecuteIndirect(BufferHandle argsBuffer, uint32_t drawCount) override;
+    void WriteTimestamp(QueryHeapHandle heap, uint32_t index) override;
+
+    std::vector<BackendCommand> const& GetCommands() const { return mCommands; }
+
+private:
+    friend class NullRenderBackend;
+
+    void Reset(bool recording);
+    void Append(NullRenderContext& other);
+    void Record(BackendCommandType type, uint32_t a0 = 0, uint32_t a1 = 0, uint32_t a2 = 0, uint32_t a3 = 0, uint32_t a4 = 0);
+
+    NullRenderBackend const&    mOwner;
+    std::vector<BackendCommand> mCommands;
+    NullBackendStats            mStats;         // Only the per-frame counters are used
+    bool                        mRecording;
+
+public:
+    NullRenderContext(NullRenderContext const&)            = delete;
+    NullRenderContext& operator=(NullRenderContext const&) = delete;
+};
+
+class NullRenderBackend final : public IRenderBackend
+{
+public:
+    explicit NullRenderBackend(uint32_t deferredContextCount = 4);
+    ~NullRenderBackend();
+
+    BufferHandle  CreateBuffer(BufferDesc const& desc, const void* pInitialData) override;
+    TextureHandle CreateTexture(TextureDesc const& desc, const void* pInitialData) override;
+    ShaderHandle  CreateShader(ShaderStage stage, const void* pBytecode, size_t bytecodeSize) override;
+    void          DestroyResource(BackendHandle handle) override;
+
+    QueryHeapHandle CreateTimestampHeap(uint32_t count) override;
+    void            DestroyTimestampHeap(QueryHeapHandle heap) override;
+
+    void UpdateBuffer(BufferHandle buffer, const void* pData, uint32_t byteSize) override;
+    void UpdateBufferRange(BufferHandle buffer, uint32_t byteOffset, const void* pData, uint32_t byteSize) override;
+    void UpdateTexture(TextureHandle texture, uint32_t mip, const void* pData, uint32_t byteSize) override;
+    void CopyTextureMips(TextureHandle dst, uint32_t dstMip, TextureHandle src, uint32_t srcMip, uint32_t mipCount) override;
+
+    void BeginFrame() override;
+    void EndFrame() override;
+
+    void     ResolveTimestamps(QueryHeapHandle heap, uint32_t first, uint32_t count) override;
+    bool     ReadTimestamps(QueryHeapHandle heap, uint32_t first, uint32_t count, uint64_t* out_ticks) override;
+    uint64_t GetTimestampFrequency() const override;
+    void     GetClockCalibration(uint64_t& out_gpuTicks, uint64_t& out_cpuNs) override;
+
+    void SetGPUCostModel(NullGPUCostModel const& model) { mGPUCost = model; }
+
+    uint32_t        GetDeferredContextCount() const override { return (uint32_t)mDeferred.size(); }
+    IRenderContext* GetDeferredContext(uint32_t index) override;
+    void            ExecuteDeferredContext(IRenderContext* pContext) override;
+
+    void SetShaders(ShaderHandle vertexShader, ShaderHandle pixelShader) override;
+    void SetVertexBuffer(uint32_t slot, BufferHandle buffer, uint32_t stride) override;
+    void SetIndexBuffer(BufferHandle buffer) override;
+    void SetConstantBuffer(ShaderStage stage, uint32_t slot, BufferHandle buffer) override;
+    void SetTexture(ShaderStage stage, uint32_t slot, TextureHandle texture) override;
+    void SetStructuredBuffer(ShaderStage stage, uint32_t slot, BufferHandle buffer) override;
+
+    void Draw(uint32_t vertexCount, uint32_t startVertex) override;
+    void DrawIndexed(uint32_t indexCount, uint32_t startIndex, int32_t baseVertex) override;
+    void DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex, uint32_t startInstance) override;
+    void ExecuteIndirect(BufferHandle argsBuffer, uint32_t drawCount) override;
+    void WriteTimestamp(QueryHeapHandle heap, uint32_t index) override;
+
+    // Commands recorded since the last BeginFrame, deferred contexts included once executed
+    std::vector<BackendCommand> const& GetCommands() const { return mImmediate.GetCommands(); }
+    NullBackendStats const&            GetStats()    const { return mStats;    }
+
+    static const char* GetCommandName(BackendCommandType type);
+
+private:
+    friend class NullRenderContext;
+
+    enum class ResourceKind : uint8_t
+    {
+        NONE,
+        BUFFER,
+        TEXTURE,
+        SHADER,
+        QUERY_HEAP
+    };
+
+    struct ResourceRecord
+    {
+        ResourceKind         Kind;
+        uint64_t             ByteSize;
+        TextureDesc          Texture;   // Only for textures, to check updates and copies against
+        std::vector<uint8_t> Contents;  // Only kept for INDIRECT_ARGS buffers, which we have to read back to expand
+
+        // Only for query heaps: what the GPU wrote, what was resolved, and the frame each resolved value is readable from
+        std::vector<uint64_t> Written;
+        std::vector<uint64_t> Resolved;
+        std::vector<uint32_t> ReadyFrame;
+    };
+
+    BackendHandle AddResource(ResourceKind kind, uint64_t byteSize, bool keepContents = false);
+    bool          IsLive(BackendHandle handle, ResourceKind kind) const;
+
+    // Runs the frame's commands on the simulated GPU, starting when it's submitted or when the last frame finishes
+    void          SimulateGPU();
+
+    std::vector<ResourceRecord> mResources;     // Index is handle - 1, read-only while contexts record
+    std::vector<BackendHandle>  mFreeHandles;
+
+    NullRenderContext                               mImmediate;
+    std::vector<std::unique_ptr<NullRenderContext>> mDeferred;
+
+    NullBackendStats            mStats;
+    bool                        mInFrame;
+
+    NullGPUCostModel            mGPUCost;
+    uint64_t                    mGPUBusyUntilNs;    // On the CPU clock
+    uint32_t                    mQueryHeapCount;
+
+public:
+    NullRenderBackend(NullRenderBackend const&)            = delete;
+    NullRenderBackend& operator=(NullRenderBackend const&) = delete;
+};
+
+}
+#endif
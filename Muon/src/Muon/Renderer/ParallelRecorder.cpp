@@ -0,0 +1,91 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of ParallelRecorder.h
+----------------------------------------------*/
+#include "ParallelRecorder.h"
+
+#include <Muon/Core/JobSystem.h>
+
+#include <algorithm>
+#include <assert.h>
+
+namespace Renderer {
+
+namespace {
+
+// Enough for one context per worker on any machine we run on
+const uint32_t kMaxRecordRanges = 64;
+
+}
+
+uint32_t PartitionRecordRanges(const uint32_t* pCosts, uint32_t itemCount, uint32_t maxRanges, uint32_t minCostPerRange, RecordRange* out_ranges)
+{
+    if (itemCount == 0 || maxRanges == 0)
+        return 0;
+
+    uint64_t totalCost = 0;
+    for (uint32_t i = 0; i != itemCount; ++i)
+        totalCost += pCosts ? pCosts[i] : 1;
+
+    uint64_t rangeCount = minCostPerRange ? totalCost / minCostPerRange : maxRanges;
+    rangeCount = std::max<uint64_t>(1, std::min<uint64_t>(rangeCount, std::min(maxRanges, itemCount)));
+
+    // Close range r once the running cost passes r+1 shares of the total. Measuring against the
+    // prefix sum rather than a per-range budget keeps rounding from piling up in the last range.
+    uint32_t written = 0;
+    uint32_t begin = 0;
+    uint64_t runningCost = 0;
+    for (uint32_t i = 0; i != itemCount && written + 1 < rangeCount; ++i)
+    {
+        runningCost += pCosts ? pCosts[i] : 1;
+
+        const uint64_t threshold = totalCost * (written + 1) / rangeCount;
+        const uint32_t itemsLeft = itemCount - (i + 1);
+        const uint32_t rangesLeft = (uint32_t)rangeCount - (written + 1);
+        if ((runningCost >= threshold && itemsLeft >= rangesLeft) || itemsLeft == rangesLeft)
+        {
+            out_ranges[written++] = { begin, i + 1 };
+            begin = i + 1;
+        }
+    }
+
+    out_ranges[written++] = { begin, itemCount };
+    return written;
+}
+
+uint32_t RecordParallel(IRenderBackend& backend, const uint32_t* pCosts, uint32_t itemCount, uint32_t minCostPerRange, RecordFn const& recordFn)
+{
+    if (itemCount == 0)
+        return 0;
+
+    RecordRange ranges[kMaxRecordRanges];
+    const uint32_t maxRanges = std::min(backend.GetDeferredContextCount(), kMaxRecordRanges);
+    const uint32_t rangeCount = PartitionRecordRanges(pCosts, itemCount, maxRanges, minCostPerRange, ranges);
+
+    if (rangeCount <= 1)
+    {
+        recordFn(backend, 0, itemCount);
+        return 1;
+    }
+
+    IRenderContext* contexts[kMaxRecordRanges];
+    for (uint32_t r = 0; r != rangeCount; ++r)
+        contexts[r] = backend.GetDeferredContext(r);
+
+    // One job per range; range r always goes to context r no matter which thread records it
+    Core::JobCounter counter;
+    Core::JobSystem::Dispatch(counter, rangeCount, 1, [&](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t r = begin; r != end; ++r)
+            recordFn(*contexts[r], ranges[r].Begin, ranges[r].End);
+    });
+    Core::JobSystem::Wait(counter);
+
+    for (uint32_t r = 0; r != rangeCount; ++r)
+        backend.ExecuteDeferredContext(contexts[r]);
+
+    return rangeCount;
+}
+
+}
@@ -0,0 +1,38 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Splits draw recording across the job system
+Items (draw batches, instancing passes...) are cut into contiguous ranges of similar cost,
+each range is recorded into its own deferred context on a worker, and the contexts are
+executed back in range order. The split depends only on the costs and the context count,
+never on which thread picked up which range, so the submitted stream is deterministic.
+----------------------------------------------*/
+#ifndef MUON_PARALLELRECORDER_H
+#define MUON_PARALLELRECORDER_H
+
+#include "RenderBackend.h"
+
+#include <functional>
+#include <stdint.h>
+
+namespace Renderer {
+
+struct RecordRange
+{
+    uint32_t Begin;
+    uint32_t End;
+};
+
+// Splits [0, itemCount) into at most maxRanges contiguous ranges, each worth at least minCostPerRange
+// where possible. pCosts may be null to weigh every item as 1. Returns the number of ranges written.
+uint32_t PartitionRecordRanges(const uint32_t* pCosts, uint32_t itemCount, uint32_t maxRanges, uint32_t minCostPerRange, RecordRange* out_ranges);
+
+typedef std::function<void(IRenderContext& context, uint32_t begin, uint32_t end)> RecordFn;
+
+// Records [0, itemCount) with recordFn across the backend's deferred contexts, then executes them in order.
+// Falls back to recording inline on the immediate context when there is only one range.
+// recordFn must bind everything it uses: deferred contexts inherit no state. Returns the number of contexts used.
+uint32_t RecordParallel(IRenderBackend& backend, const uint32_t* pCosts, uint32_t itemCount, uint32_t minCostPerRange, RecordFn const& recordFn);
+
+}
+#endif
@@ -0,0 +1,144 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : API-agnostic rendering backend interface
+The CPU side of a frame talks to this instead of a D3D context, so it can run
+against a real device or a null backend that only records what it was asked to do.
+----------------------------------------------*/
+#ifndef MUON_RENDERBACKEND_H
+#define MUON_RENDERBACKEND_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Renderer {
+
+typedef uint32_t BackendHandle;
+typedef BackendHandle BufferHandle;
+typedef BackendHandle TextureHandle;
+typedef BackendHandle ShaderHandle;
+typedef BackendHandle QueryHeapHandle;
+
+static const BackendHandle kInvalidBackendHandle = 0;
+
+enum class BufferUsage : uint8_t
+{
+    VERTEX,
+    INDEX,
+    INSTANCE,
+    CONSTANT,
+    STRUCTURED,     // Read by shaders per draw or per instance
+    INDIRECT_ARGS,  // Packed DrawIndexedArgs records, see IndirectDrawBuilder.h
+    COUNT
+};
+
+enum class ShaderStage : uint8_t
+{
+    VERTEX,
+    PIXEL,
+    COUNT
+};
+
+struct BufferDesc
+{
+    uint32_t    ByteSize;
+    uint32_t    Stride;
+    BufferUsage Usage;
+    bool        Dynamic;    // Rewritten every frame through UpdateBuffer
+};
+
+struct TextureDesc
+{
+    uint32_t Width;
+    uint32_t Height;
+    uint16_t MipLevels;
+    uint16_t ArraySize;
+    uint32_t BytesPerPixel;  // Per texel of the top mip, block formats round up
+};
+
+// Anything GPU timestamps can be recorded into
+class ITimestampWriter
+{
+public:
+    virtual ~ITimestampWriter() {}
+
+    // Stores the GPU clock into heap[index] once every command before it has finished
+    virtual void WriteTimestamp(QueryHeapHandle heap, uint32_t index) = 0;
+};
+
+// What GPUProfiler needs from a device. Writes through the device itself go into its own command stream.
+// The backend is one; D3D12Timestamps is one for the D3D12 renderer, which doesn't go through the backend.
+class ITimestampDevice : public virtual ITimestampWriter
+{
+public:
+    // count timestamp queries, see WriteTimestamp
+    virtual QueryHeapHandle CreateTimestampHeap(uint32_t count) = 0;
+    virtual void            DestroyTimestampHeap(QueryHeapHandle heap) = 0;
+
+    // ResolveTimestamps copies [first, first + count) out of the heap when the GPU reaches it in this frame;
+    // ReadTimestamps never waits and returns false until that has happened.
+    virtual void     ResolveTimestamps(QueryHeapHandle heap, uint32_t first, uint32_t count) = 0;
+    virtual bool     ReadTimestamps(QueryHeapHandle heap, uint32_t first, uint32_t count, uint64_t* out_ticks) = 0;
+    virtual uint64_t GetTimestampFrequency() const = 0;
+
+    // A GPU timestamp and the Core::Profiler::Now() it was taken at, to map one clock onto the other
+    virtual void     GetClockCalibration(uint64_t& out_gpuTicks, uint64_t& out_cpuNs) = 0;
+};
+
+// Everything that records into a command stream. The backend itself is the immediate context;
+// deferred contexts record the same calls on other threads.
+class IRenderContext : public virtual ITimestampWriter
+{
+public:
+
+    virtual void SetShaders(ShaderHandle vertexShader, ShaderHandle pixelShader) = 0;
+    virtual void SetVertexBuffer(uint32_t slot, BufferHandle buffer, uint32_t stride) = 0;
+    virtual void SetIndexBuffer(BufferHandle buffer) = 0;
+    virtual void SetConstantBuffer(ShaderStage stage, uint32_t slot, BufferHandle buffer) = 0;
+    virtual void SetTexture(ShaderStage stage, uint32_t slot, TextureHandle texture) = 0;
+    virtual void SetStructuredBuffer(ShaderStage stage, uint32_t slot, BufferHandle buffer) = 0;
+
+    virtual void Draw(uint32_t vertexCount, uint32_t startVertex) = 0;
+    virtual void DrawIndexed(uint32_t indexCount, uint32_t startIndex, int32_t baseVertex) = 0;
+    virtual void DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex, uint32_t startInstance) = 0;
+
+    // One submission that runs drawCount DrawIndexedInstanced records from an INDIRECT_ARGS buffer
+    // with whatever is currently bound. Every draw must share the bound shaders and geometry buffers.
+    virtual void ExecuteIndirect(BufferHandle argsBuffer, uint32_t drawCount) = 0;
+};
+
+class IRenderBackend : public IRenderContext, public ITimestampDevice
+{
+public:
+    // Resources. pInitialData may be null.
+    virtual BufferHandle  CreateBuffer(BufferDesc const& desc, const void* pInitialData) = 0;
+    virtual TextureHandle CreateTexture(TextureDesc const& desc, const void* pInitialData) = 0;
+    virtual ShaderHandle  CreateShader(ShaderStage stage, const void* pBytecode, size_t bytecodeSize) = 0;
+    virtual void          DestroyResource(BackendHandle handle) = 0;
+
+    virtual void UpdateBuffer(BufferHandle buffer, const void* pData, uint32_t byteSize) = 0;
+
+    // Rewrites only [byteOffset, byteOffset + byteSize) and leaves the rest of the buffer as it was
+    virtual void UpdateBufferRange(BufferHandle buffer, uint32_t byteOffset, const void* pData, uint32_t byteSize) = 0;
+
+    // Replaces one mip of array slice 0. Rows are tightly packed, block rows for block formats.
+    virtual void UpdateTexture(TextureHandle texture, uint32_t mip, const void* pData, uint32_t byteSize) = 0;
+
+    // GPU copy of mipCount mips between two textures whose mips line up in size
+    virtual void CopyTextureMips(TextureHandle dst, uint32_t dstMip, TextureHandle src, uint32_t srcMip, uint32_t mipCount) = 0;
+
+    // Command stream
+    virtual void BeginFrame() = 0;
+    virtual void EndFrame() = 0;
+
+    // Deferred contexts are cleared by BeginFrame and start with nothing bound, like D3D11 deferred
+    // contexts or fresh D3D12 command lists. Each one may be recorded by a single thread at a time.
+    // Their commands only land in the frame when ExecuteDeferredContext is called on the main thread,
+    // so the order of those calls is the submission order.
+    virtual uint32_t        GetDeferredContextCount() const = 0;
+    virtual IRenderContext* GetDeferredContext(uint32_t index) = 0;
+    virtual void            ExecuteDeferredContext(IRenderContext* pContext) = 0;
+};
+
+}
+#endif
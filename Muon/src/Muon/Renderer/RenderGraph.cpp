@@ -0,0 +1,364 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of RenderGraph.h
+----------------------------------------------*/
+#include "RenderGraph.h"
+
+#include <algorithm>
+#include <assert.h>
+
+namespace Renderer {
+
+namespace {
+
+bool IsRenderTargetState(RGState state)
+{
+    return state == RGState::RENDER_TARGET || state == RGState::DEPTH_WRITE || state == RGState::DEPTH_READ;
+}
+
+uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+}
+
+void RenderGraph::Reset()
+{
+    mPasses.clear();
+    mResources.clear();
+    mAccesses.clear();
+    mBarriers.clear();
+    mFinalBarrierStart = 0;
+    mCompiled = false;
+    mOpenPass = kInvalidRGPass;
+    mStats = RGStats();
+}
+
+RGResource RenderGraph::CreateTexture(const char* name, RGTextureDesc const& desc)
+{
+    Resource res = {};
+    res.Name         = name;
+    res.Desc         = desc;
+    res.InitialState = RGState::UNDEFINED;
+    res.FinalState   = RGState::UNDEFINED;
+    res.Imported     = false;
+    mResources.push_back(res);
+    return (RGResource)(mResources.size() - 1);
+}
+
+RGResource RenderGraph::ImportTexture(const char* name, RGTextureDesc const& desc, RGState initialState, RGState finalState)
+{
+    RGResource handle = CreateTexture(name, desc);
+    Resource& res = mResources[handle];
+    res.InitialState = initialState;
+    res.FinalState   = finalState;
+    res.Imported     = true;
+    return handle;
+}
+
+RGPass RenderGraph::AddPass(const char* name, ExecuteFn execute, bool hasSideEffects)
+{
+    Pass pass = {};
+    pass.Name           = name;
+    pass.Execute        = std::move(execute);
+    pass.FirstAccess    = (uint32_t)mAccesses.size();
+    pass.HasSideEffects = hasSideEffects;
+    mPasses.push_back(std::move(pass));
+
+    mOpenPass = (RGPass)(mPasses.size() - 1);
+    mCompiled = false;
+    return mOpenPass;
+}
+
+void RenderGraph::Read(RGPass pass, RGResource resource, RGState state)
+{
+    AddAccess(pass, resource, state, false);
+}
+
+void RenderGraph::Write(RGPass pass, RGResource resource, RGState state)
+{
+    AddAccess(pass, resource, state, true);
+}
+
+void RenderGraph::AddAccess(RGPass pass, RGResource resource, RGState state, bool isWrite)
+{
+    assert(pass == mOpenPass && "RenderGraph: declare a pass's reads and writes before adding the next pass");
+    assert(resource < mResources.size());
+    assert(state != RGState::UNDEFINED);
+
+    mAccesses.push_back({ resource, state, isWrite });
+    mPasses[pass].AccessCount++;
+    mCompiled = false;
+}
+
+bool RenderGraph::Compile()
+{
+    mBarriers.clear();
+    mStats = RGStats();
+    mStats.DeclaredPasses = (uint32_t)mPasses.size();
+
+    CullPasses();
+    ComputeLifetimes();
+    BuildBarriers();
+    PlaceTransients();
+
+    mOpenPass = kInvalidRGPass;
+    mCompiled = true;
+    return true;
+}
+
+void RenderGraph::CullPasses()
+{
+    for (Resource& res : mResources)
+        res.Needed = false;
+
+    // Walk backwards: a pass lives if it has side effects, writes something external,
+    // or writes something a later live pass reads. Whatever a live pass reads is then needed.
+    for (size_t p = mPasses.size(); p-- != 0; )
+    {
+        Pass& pass = mPasses[p];
+        bool live = pass.HasSideEffects;
+
+        for (uint32_t a = 0; !live && a != pass.AccessCount; ++a)
+        {
+            Access const& access = mAccesses[pass.FirstAccess + a];
+            if (access.IsWrite)
+                live = mResources[access.Resource].Imported || mResources[access.Resource].Needed;
+        }
+
+        pass.Live = live;
+        if (!live)
+        {
+            mStats.CulledPasses++;
+            continue;
+        }
+
+        for (uint32_t a = 0; a != pass.AccessCount; ++a)
+        {
+            Access const& access = mAccesses[pass.FirstAccess + a];
+            if (!access.IsWrite)
+                mResources[access.Resource].Needed = true;
+        }
+    }
+}
+
+void RenderGraph::ComputeLifetimes()
+{
+    for (Resource& res : mResources)
+    {
+        res.FirstUse = kInvalidRGPass;
+        res.LastUse  = kInvalidRGPass;
+    }
+
+    for (RGPass p = 0; p != (RGPass)mPasses.size(); ++p)
+    {
+        Pass const& pass = mPasses[p];
+        if (!pass.Live)
+            continue;
+
+        for (uint32_t a = 0; a != pass.AccessCount; ++a)
+        {
+            Resource& res = mResources[mAccesses[pass.FirstAccess + a].Resource];
+            if (res.FirstUse == kInvalidRGPass)
+                res.FirstUse = p;
+            res.LastUse = p;
+        }
+    }
+}
+
+void RenderGraph::BuildBarriers()
+{
+    std::vector<RGState> current(mResources.size());
+    std::vector<bool>    pendingUAV(mResources.size(), false);
+    for (size_t r = 0; r != mResources.size(); ++r)
+        current[r] = mResources[r].InitialState;
+
+    for (Pass& pass : mPasses)
+    {
+        pass.FirstBarrier = (uint32_t)mBarriers.size();
+        pass.BarrierCount = 0;
+
+        if (!pass.Live)
+            continue;
+
+        for (uint32_t a = 0; a != pass.AccessCount; ++a)
+        {
+            Access const& access = mAccesses[pass.FirstAccess + a];
+
+            // A resource touched twice in one pass settles on its write state
+            RGState wanted = access.State;
+            bool duplicate = false;
+            for (uint32_t b = 0; b != pass.AccessCount; ++b)
+            {
+                Access const& other = mAccesses[pass.FirstAccess + b];
+                if (b == a || other.Resource != access.Resource)
+                    continue;
+
+                if (b < a)
+                    duplicate = true;
+                if (other.IsWrite && !access.IsWrite)
+                    wanted = other.State;
+            }
+
+            if (duplicate)
+                continue;
+
+            const RGResource r = access.Resource;
+            if (current[r] != wanted)
+            {
+                mBarriers.push_back({ r, current[r], wanted });
+                current[r] = wanted;
+            }
+            else if (wanted == RGState::UNORDERED_ACCESS && pendingUAV[r])
+            {
+                // Back to back UAV work still needs the previous writes flushed
+                mBarriers.push_back({ r, wanted, wanted });
+            }
+
+            pendingUAV[r] = wanted == RGState::UNORDERED_ACCESS && access.IsWrite;
+        }
+
+        pass.BarrierCount = (uint32_t)mBarriers.size() - pass.FirstBarrier;
+        if (pass.BarrierCount)
+            mStats.BarrierBatches++;
+    }
+
+    // Hand imported resources back in the state their owner expects
+    mFinalBarrierStart = (uint32_t)mBarriers.size();
+    for (RGResource r = 0; r != (RGResource)mResources.size(); ++r)
+    {
+        Resource const& res = mResources[r];
+        if (res.Imported && current[r] != res.FinalState)
+            mBarriers.push_back({ r, current[r], res.FinalState });
+    }
+
+    if (mBarriers.size() != mFinalBarrierStart)
+        mStats.BarrierBatches++;
+
+    mStats.BarrierCount = (uint32_t)mBarriers.size();
+}
+
+void RenderGraph::PlaceTransients()
+{
+    std::vector<RGResource> transients;
+    for (RGResource r = 0; r != (RGResource)mResources.size(); ++r)
+    {
+        Resource& res = mResources[r];
+        res.Placement = { RGHeapClass::TEXTURE, 0, 0 };
+
+        if (res.Imported || res.FirstUse == kInvalidRGPass)
+            continue;
+
+        res.Placement.Size = AlignUp(GetTextureSize(res.Desc), kPlacementAlignment);
+        transients.push_back(r);
+
+        mStats.TransientCount++;
+        mStats.UnaliasedBytes += res.Placement.Size;
+    }
+
+    // Anything bound as a render target or depth buffer must live in a render target heap
+    for (Access const& access : mAccesses)
+    {
+        if (IsRenderTargetState(access.State))
+            mResources[access.Resource].Placement.HeapClass = RGHeapClass::RENDER_TARGET;
+    }
+
+    // Biggest first keeps the greedy packing tight
+    std::stable_sort(transients.begin(), transients.end(), [this](RGResource a, RGResource b)
+    {
+        return mResources[a].Placement.Size > mResources[b].Placement.Size;
+    });
+
+    std::vector<RGResource> placed;
+    std::vector<std::pair<uint64_t, uint64_t>> busy; // [offset, end) of lifetime-overlapping neighbours
+
+    for (RGResource r : transients)
+    {
+        Resource& res = mResources[r];
+
+        busy.clear();
+        for (RGResource o : placed)
+        {
+            Resource const& other = mResources[o];
+            const bool sameHeap = other.Placement.HeapClass == res.Placement.HeapClass;
+            const bool overlaps = other.FirstUse <= res.LastUse && res.FirstUse <= other.LastUse;
+            if (sameHeap && overlaps)
+                busy.push_back({ other.Placement.Offset, other.Placement.Offset + other.Placement.Size });
+        }
+        std::sort(busy.begin(), busy.end());
+
+        // Lowest gap that fits
+        uint64_t offset = 0;
+        for (auto const& range : busy)
+        {
+            if (offset + res.Placement.Size <= range.first)
+                break;
+            offset = std::max(offset, range.second);
+        }
+
+        res.Placement.Offset = offset;
+        placed.push_back(r);
+
+        uint64_t& heapBytes = mStats.HeapBytes[(uint8_t)res.Placement.HeapClass];
+        heapBytes = std::max(heapBytes, offset + res.Placement.Size);
+    }
+
+    for (uint64_t heapBytes : mStats.HeapBytes)
+        mStats.AliasedBytes += heapBytes;
+}
+
+void RenderGraph::Execute(void* pContext, BarrierFn const& barrierFn) const
+{
+    assert(mCompiled && "RenderGraph: Compile() before Execute()");
+
+    for (Pass const& pass : mPasses)
+    {
+        if (!pass.Live)
+            continue;
+
+        if (pass.BarrierCount && barrierFn)
+            barrierFn(&mBarriers[pass.FirstBarrier], pass.BarrierCount, pContext);
+
+        if (pass.Execute)
+            pass.Execute(pContext);
+    }
+
+    const uint32_t finalCount = (uint32_t)mBarriers.size() - mFinalBarrierStart;
+    if (finalCount && barrierFn)
+        barrierFn(&mBarriers[mFinalBarrierStart], finalCount, pContext);
+}
+
+uint64_t RenderGraph::GetTextureSize(RGTextureDesc const& desc)
+{
+    uint64_t size = 0;
+    for (uint32_t mip = 0; mip != std::max<uint32_t>(desc.MipLevels, 1); ++mip)
+    {
+        const uint64_t w = std::max<uint32_t>(desc.Width >> mip, 1);
+        const uint64_t h = std::max<uint32_t>(desc.Height >> mip, 1);
+        size += w * h * desc.BytesPerPixel;
+    }
+
+    return size;
+}
+
+const char* RenderGraph::GetStateName(RGState state)
+{
+    switch (state)
+    {
+    case RGState::UNDEFINED:        return "UNDEFINED";
+    case RGState::COMMON:           return "COMMON";
+    case RGState::RENDER_TARGET:    return "RENDER_TARGET";
+    case RGState::DEPTH_WRITE:      return "DEPTH_WRITE";
+    case RGState::DEPTH_READ:       return "DEPTH_READ";
+    case RGState::SHADER_READ:      return "SHADER_READ";
+    case RGState::UNORDERED_ACCESS: return "UNORDERED_ACCESS";
+    case RGState::COPY_SOURCE:      return "COPY_SOURCE";
+    case RGState::COPY_DEST:        return "COPY_DEST";
+    case RGState::PRESENT:          return "PRESENT";
+    default:                        return "UNKNOWN";
+    }
+}
+
+}
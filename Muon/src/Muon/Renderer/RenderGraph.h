@@ -0,0 +1,177 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Declarative frame graph
+Passes declare what they read and write. Compile() culls passes nothing depends on,
+works out the minimal barrier batch in front of each pass, and places transient
+textures into shared heaps so resources with disjoint lifetimes share memory.
+Knows nothing about D3D; the backend turns barriers and placements into API calls.
+----------------------------------------------*/
+#ifndef MUON_RENDERGRAPH_H
+#define MUON_RENDERGRAPH_H
+
+#include <functional>
+#include <stdint.h>
+#include <vector>
+
+namespace Renderer {
+
+typedef uint16_t RGResource;
+typedef uint16_t RGPass;
+
+static const RGResource kInvalidRGResource = UINT16_MAX;
+static const RGPass     kInvalidRGPass     = UINT16_MAX;
+
+// Mirrors the D3D12_RESOURCE_STATES we actually use
+enum class RGState : uint8_t
+{
+    UNDEFINED,      // Contents are garbage, e.g. a transient on first use
+    COMMON,
+    RENDER_TARGET,
+    DEPTH_WRITE,
+    DEPTH_READ,
+    SHADER_READ,
+    UNORDERED_ACCESS,
+    COPY_SOURCE,
+    COPY_DEST,
+    PRESENT,
+    COUNT
+};
+
+// Tier 1 heaps can't mix render targets with other textures, so they alias separately
+enum class RGHeapClass : uint8_t
+{
+    RENDER_TARGET,
+    TEXTURE,
+    COUNT
+};
+
+struct RGTextureDesc
+{
+    uint32_t Width;
+    uint32_t Height;
+    uint32_t Format;        // Opaque to the graph, DXGI_FORMAT on Windows
+    uint16_t BytesPerPixel;
+    uint16_t MipLevels;
+};
+
+struct RGBarrier
+{
+    RGResource Resource;
+    RGState    Before;
+    RGState    After;
+};
+
+struct RGPlacement
+{
+    RGHeapClass HeapClass;
+    uint64_t    Offset;
+    uint64_t    Size;
+};
+
+struct RGStats
+{
+    uint32_t DeclaredPasses;
+    uint32_t CulledPasses;
+    uint32_t TransientCount;
+    uint32_t BarrierCount;
+    uint32_t BarrierBatches;        // ResourceBarrier calls this frame needs
+    uint64_t UnaliasedBytes;        // What the transients would cost as committed resources
+    uint64_t HeapBytes[(uint8_t)RGHeapClass::COUNT];
+    uint64_t AliasedBytes;          // Sum of HeapBytes
+
+    uint64_t GetSavedBytes() const { return UnaliasedBytes - AliasedBytes; }
+};
+
+class RenderGraph
+{
+public:
+    typedef std::function<void(void* pContext)>                                  ExecuteFn;
+    typedef std::function<void(RGBarrier const* pBarriers, uint32_t count, void* pContext)> BarrierFn;
+
+    // Placed resources in D3D12 are aligned to 64KB by default
+    static const uint64_t kPlacementAlignment = 64 * 1024;
+
+    // Forgets every pass and resource but keeps allocations around for next frame
+    void Reset();
+
+    RGResource CreateTexture(const char* name, RGTextureDesc const& desc);
+
+    // External resources (e.g. the back buffer) are never aliased, and are returned to finalState after the last pass
+    RGResource ImportTexture(const char* name, RGTextureDesc const& desc, RGState initialState, RGState finalState);
+
+    // Passes with side effects are never culled, even if nothing reads what they write
+    RGPass AddPass(const char* name, ExecuteFn execute, bool hasSideEffects = false);
+
+    void Read(RGPass pass, RGResource resource, RGState state = RGState::SHADER_READ);
+    void Write(RGPass pass, RGResource resource, RGState state = RGState::RENDER_TARGET);
+
+    bool Compile();
+
+    // Calls barrierFn with each pass's batch (if any) right before running it, then the final batch
+    void Execute(void* pContext, BarrierFn const& barrierFn) const;
+
+    bool               IsPassCulled(RGPass pass) const   { return !mPasses[pass].Live; }
+    RGPlacement const& GetPlacement(RGResource res) const { return mResources[res].Placement; }
+    bool               IsImported(RGResource res) const  { return mResources[res].Imported; }
+    const char*        GetResourceName(RGResource res) const { return mResources[res].Name; }
+    const char*        GetPassName(RGPass pass) const    { return mPasses[pass].Name; }
+    RGStats const&     GetStats() const                  { return mStats; }
+
+    static uint64_t    GetTextureSize(RGTextureDesc const& desc);
+    static const char* GetStateName(RGState state);
+
+private:
+    struct Access
+    {
+        RGResource Resource;
+        RGState    State;
+        bool       IsWrite;
+    };
+
+    struct Pass
+    {
+        const char* Name;
+        ExecuteFn   Execute;
+        uint32_t    FirstAccess;
+        uint32_t    AccessCount;
+        uint32_t    FirstBarrier;
+        uint32_t    BarrierCount;
+        bool        HasSideEffects;
+        bool        Live;
+    };
+
+    struct Resource
+    {
+        const char*   Name;
+        RGTextureDesc Desc;
+        RGState       InitialState;
+        RGState       FinalState;
+        bool          Imported;
+        bool          Needed;
+        RGPass        FirstUse;
+        RGPass        LastUse;
+        RGPlacement   Placement;
+    };
+
+    void AddAccess(RGPass pass, RGResource resource, RGState state, bool isWrite);
+    void CullPasses();
+    void ComputeLifetimes();
+    void BuildBarriers();
+    void PlaceTransients();
+
+    std::vector<Pass>      mPasses;
+    std::vector<Resource>  mResources;
+    std::vector<Access>    mAccesses;        // Per pass, in declaration order
+    std::vector<RGBarrier> mBarriers;        // Per pass batches, then the final batch
+    uint32_t               mFinalBarrierStart = 0;
+    bool                   mCompiled = false;
+
+    // Accesses are stored per pass, so passes must be declared one at a time
+    RGPass                 mOpenPass = kInvalidRGPass;
+
+    RGStats                mStats = {};
+};
+
+}
+#endif
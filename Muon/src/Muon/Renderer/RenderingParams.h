@@ -1,6 +1,8 @@
 #ifndef RENDERINGPARAMS_H
 #define RENDERINGPARAMS_H
 
+#include "Generated/CBufferLayouts.h"
+
 namespace Renderer {
 
 enum class EASEL_PIPELINE_STAGE : UINT
@@ -22,19 +24,42 @@ enum class EASEL_SHADER_STAGE : UINT
 };
 
 // Reserved Constant Buffer Registers for Vertex Shader Stage
+// Taken from the shaders' register(bN) through the generated layouts, so the two can't drift apart
 enum class VS_REGISTERS : UINT
 {
     // ESS_VS
-    CAMERA = 10,
-    WORLD  = 11,
+    CAMERA = CBufferLayout::VSPerPass::kRegister,
+    WORLD  = CBufferLayout::VSPerStaticEntity::kRegister,
 };
 
 // Reserved Constant Buffer Registers for Pixel Shader Stage
 enum class PS_REGISTERS : UINT
 {
     // ESS_PS
-    LIGHTS   = 10,
-    MATERIAL = 11
+    LIGHTS   = CBufferLayout::PSPerFrame::kRegister,
+    MATERIAL = CBufferLayout::PSPerMaterial::kRegister,
+    CLUSTERS = CBufferLayout::PSClusters::kRegister,
+    SHADOWS  = CBufferLayout::PSShadows::kRegister
+};
+
+// Reserved Shader Resource Slots for Pixel Shader Stage, register(tN) in ClusteredLighting.hlsli and CascadedShadows.hlsli
+enum class PS_RESOURCES : UINT
+{
+    // ESS_PS
+    CLUSTER_LIGHTS  = 8,
+    CLUSTER_GRID    = 9,
+    CLUSTER_INDICES = 10,
+    CLUSTER_COUNT   = 3,
+    SHADOW_MAP      = 11
+};
+
+// Reserved Sampler Slots for Pixel Shader Stage
+enum class PS_SAMPLERS : UINT
+{
+    // ESS_PS
+    MATERIAL = 0,
+    SHADOW   = 1,   // Comparison sampler for the shadow map
+    COUNT    = 2
 };
 
 
@@ -7,6 +7,7 @@ Description : Master Resource Distributor
 
 #include <Muon/Core/PathMacros.h>
 
+#include "D3D11StreamingDevice.h"
 #include "Factories.h"
 #include "Material.h"
 #include "Mesh.h"
@@ -43,6 +44,12 @@ MeshID ResourceCodex::AddMeshFromFile(const char* fileName, const VertexBufferDe
 void ResourceCodex::Init(ID3D11Device* device, ID3D11DeviceContext* context)
 {
     ResourceCodex& codexInstance = GetSingleton();
+
+    const size_t kShaderDescArenaSize = 64 * 1024;
+    codexInstance.mShaderDescArena.Init(kShaderDescArenaSize, Memory::MemoryTag::SHADERS);
+
+    codexInstance.mpStreamingDevice = new D3D11StreamingDevice(device, context);
+    codexInstance.mTextureStreamer.Init(codexInstance.mpStreamingDevice, TextureStreamerConfig());
     
     TextureFactory::LoadAllTextures(device, context, codexInstance);
     ShaderFactory::LoadAllShaders(device, codexInstance);
@@ -72,12 +79,13 @@ void ResourceCodex::Destroy()
     {
         const VertexShader& vs = s.second;
         vs.InputLayout->Release();
-        free(vs.VertexDesc.SemanticsArr);
-        free(vs.VertexDesc.ByteOffsets);
         vs.Shader->Release();
     }
 
-    std::unordered_map<ShaderID, const PixelShader>::iterator it = codexInstance.mPixelShaders.begin();
+    // Releases every VertexBufferDescription array at once
+    codexInstance.mShaderDescArena.Destroy();
+
+    auto it = codexInstance.mPixelShaders.begin();
 
     while (it != codexInstance.mPixelShaders.end())
     {
@@ -89,6 +97,79 @@ void ResourceCodex::Destroy()
     for (auto const& t : codexInstance.mTextureMap)
         for(ID3D11ShaderResourceView* srv : t.second.SRVs)
             if(srv) srv->Release();
+
+    for (auto const& t : codexInstance.mPackedChords)
+        for (ID3D11ShaderResourceView* srv : t.second.SRVs)
+            if (srv) srv->Release();
+    codexInstance.mPackedChords.clear();
+
+    // The chords held their own references, so the streamed textures can go now
+    codexInstance.mTextureStreamer.Shutdown();
+    codexInstance.mStreamedBindings.clear();
+    codexInstance.mPackedTextures.clear();
+    delete codexInstance.mpStreamingDevice;
+    codexInstance.mpStreamingDevice = nullptr;
+}
+
+void ResourceCodex::UpdateStreaming()
+{
+    ResourceCodex& codexInstance = GetSingleton();
+    codexInstance.mTextureStreamer.Update();
+
+    for (StreamedBinding const& binding : codexInstance.mStreamedBindings)
+    {
+        const TextureHandle handle = codexInstance.mTextureStreamer.GetHandle(binding.Streamed);
+        ID3D11ShaderResourceView* pSRV = codexInstance.mpStreamingDevice->GetSRV(handle);
+        ID3D11ShaderResourceView*& bound = codexInstance.mTextureMap[binding.Texture].SRVs[binding.Slot];
+        if (bound == pSRV)
+            continue;
+
+        // Materials point at the chord, so they pick the new view up on their next bind
+        pSRV->AddRef();
+        if (bound)
+            bound->Release();
+        bound = pSRV;
+
+        // Packed textures never stream, so this slot is never one of the packed chord's pages
+        auto packed = codexInstance.mPackedChords.find(binding.Texture);
+        if (packed != codexInstance.mPackedChords.end())
+        {
+            ID3D11ShaderResourceView*& packedBound = packed->second.SRVs[binding.Slot];
+            pSRV->AddRef();
+            if (packedBound)
+                packedBound->Release();
+            packedBound = pSRV;
+        }
+    }
+}
+
+bool ResourceCodex::GetPackedTexture(TextureID UID, TextureSlots slot, PackedBinding* out_binding) const
+{
+    auto it = mPackedTextures.find(((uint64_t)UID << 8) | (uint64_t)slot);
+    if (it == mPackedTextures.end())
+        return false;
+
+    *out_binding = it->second;
+    return true;
+}
+
+const ResourceBindChord* ResourceCodex::GetPackedChord(TextureID UID) const
+{
+    auto it = mPackedChords.find(UID);
+    return it != mPackedChords.end() ? &it->second : nullptr;
+}
+
+void ResourceCodex::RequestMaterialMips(uint8_t materialIndex, float screenPixels)
+{
+    const Material* pMaterial = GetMaterial(materialIndex);
+    if (!pMaterial || !pMaterial->Resources)
+        return;
+
+    for (StreamedBinding const& binding : mStreamedBindings)
+    {
+        if (&mTextureMap.at(binding.Texture) == pMaterial->Resources || GetPackedChord(binding.Texture) == pMaterial->Resources)
+            mTextureStreamer.RequestScreenSize(binding.Streamed, screenPixels);
+    }
 }
 
 const Mesh* ResourceCodex::GetMesh(MeshID UID) const
@@ -115,36 +196,54 @@ const ResourceBindChord* ResourceCodex::GetTexture(TextureID UID) const
         return nullptr;
 }
 
-const VertexShader* ResourceCodex::GetVertexShader(ShaderID UID) const
+const VertexShader* ResourceCodex::GetVertexShader(ShaderID program, ShaderVariantKey variant) const
 {
-    if(mVertexShaders.find(UID) != mVertexShaders.end())
-        return &mVertexShaders.at(UID);
+    auto it = mVertexShaders.find({ program, variant });
+    if(it != mVertexShaders.end())
+        return &it->second;
     else
         return nullptr;
 }
 
-const PixelShader* ResourceCodex::GetPixelShader(ShaderID UID) const
+const PixelShader* ResourceCodex::GetPixelShader(ShaderID program, ShaderVariantKey variant) const
 {
-    if(mPixelShaders.find(UID) != mPixelShaders.end())
-        return &mPixelShaders.at(UID);
+    auto it = mPixelShaders.find({ program, variant });
+    if(it != mPixelShaders.end())
+        return &it->second;
     else
         return nullptr;
 }
 
-void ResourceCodex::AddVertexShader(ShaderID hash, const wchar_t* path, ID3D11Device* pDevice)
+void ResourceCodex::AddVertexShader(ShaderKey key, const wchar_t* path, ID3D11Device* pDevice)
+{
+    VertexShader shader;
+    ShaderFactory::CreateVertexShader(path, &shader, pDevice, mShaderDescArena);
+    const VertexShader cShader = shader;
+    mVertexShaders.insert(std::pair<ShaderKey, const VertexShader>(key, cShader));
+}
+
+void ResourceCodex::AddVertexShader(ShaderKey key, ID3D10Blob* pBlob, ShaderReflectionRecord const& record, ID3D11Device* pDevice)
 {
     VertexShader shader;
-    ShaderFactory::CreateVertexShader(path, &shader, pDevice);
+    ShaderFactory::CreateVertexShader(pBlob, record, &shader, pDevice, mShaderDescArena);
     const VertexShader cShader = shader;
-    mVertexShaders.insert(std::pair<ShaderID, const VertexShader>(hash, cShader));
+    mVertexShaders.insert(std::pair<ShaderKey, const VertexShader>(key, cShader));
 }
 
-void ResourceCodex::AddPixelShader(ShaderID hash, const wchar_t* path, ID3D11Device* pDevice)
+void ResourceCodex::AddPixelShader(ShaderKey key, const wchar_t* path, ID3D11Device* pDevice)
 {   
     PixelShader shader;
     ShaderFactory::CreatePixelShader(path, &shader, pDevice);
     const PixelShader cShader = shader;
-    mPixelShaders.insert(std::pair<ShaderID, const PixelShader>(hash, cShader));
+    mPixelShaders.insert(std::pair<ShaderKey, const PixelShader>(key, cShader));
+}
+
+void ResourceCodex::AddPixelShader(ShaderKey key, ID3D10Blob* pBlob, ID3D11Device* pDevice)
+{
+    PixelShader shader;
+    ShaderFactory::CreatePixelShader(pBlob, &shader, pDevice);
+    const PixelShader cShader = shader;
+    mPixelShaders.insert(std::pair<ShaderKey, const PixelShader>(key, cShader));
 }
 
 void ResourceCodex::InsertTexture(TextureID UID, UINT slot, ID3D11ShaderResourceView* pSRV)
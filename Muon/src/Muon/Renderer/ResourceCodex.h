@@ -11,20 +11,25 @@ Description : Loads and distributes all static resources (materials, textures, e
 #include "Material.h"
 #include "Mesh.h"
 #include "Shader.h"
+#include "ShaderVariant.h"
+#include "TextureStreamer.h"
+
+#include <Muon/Memory/Allocators.h>
 
 #include <unordered_map>
 
 namespace Renderer {
 
+class D3D11StreamingDevice;
 struct MeshFactory;
 struct ShaderFactory;
+struct ShaderReflectionRecord;
 struct TextureFactory;
 }
 
 namespace Renderer {
 
 typedef uint32_t id_type;
-typedef id_type ShaderID;
 typedef id_type MeshID;
 typedef id_type TextureID;
 
@@ -50,13 +55,42 @@ public:
     const Mesh* GetMesh(MeshID UID) const;
     const Material* GetMaterial(uint8_t materialIndex) const;
     const ResourceBindChord* GetTexture(TextureID UID) const;
-    const VertexShader* GetVertexShader(ShaderID UID) const;
-    const PixelShader* GetPixelShader(ShaderID UID) const;
+    const VertexShader* GetVertexShader(ShaderID program, ShaderVariantKey variant = kBaseVariant) const;
+    const PixelShader* GetPixelShader(ShaderID program, ShaderVariantKey variant = kBaseVariant) const;
 
-private:
+    // screenPixels is how large something drawn with the material is on screen. Largest request per frame wins.
+    void RequestMaterialMips(uint8_t materialIndex, float screenPixels);
+
+    // Swaps in streamed mips and points the bind chords at the new SRVs. Once per frame, on the immediate context's thread.
+    static void UpdateStreaming();
+
+    TextureStreamerStats const& GetStreamingStats() const { return mTextureStreamer.GetStats(); }
+
+    // Where a texture sits in its page, when TextureCooker -pack put it in one
+    struct PackedBinding
+    {
+        uint32_t Page;
+        uint32_t Slice;
+        float    UVRect[4];
+    };
+    bool GetPackedTexture(TextureID UID, TextureSlots slot, PackedBinding* out_binding) const;
+
+    // GetTexture's chord binds every texture as its own Texture2D. This one is for materials built with the
+    // TEXTURE_ARRAY variant: packed diffuse and normal slots point at their pages instead, everything else
+    // is the same. Null when neither of the texture's diffuse or normal is packed.
+    const ResourceBindChord* GetPackedChord(TextureID UID) const;
 
-    std::unordered_map<ShaderID, const VertexShader>  mVertexShaders;
-    std::unordered_map<ShaderID, const PixelShader>   mPixelShaders;
+private:
+    // A chord slot whose SRV belongs to the streamer and changes with its residency
+    struct StreamedBinding
+    {
+        TextureID         Texture;
+        UINT              Slot;
+        StreamedTextureID Streamed;
+    };
+
+    std::unordered_map<ShaderKey, const VertexShader, ShaderKeyHasher> mVertexShaders;
+    std::unordered_map<ShaderKey, const PixelShader, ShaderKeyHasher>  mPixelShaders;
     std::unordered_map<MeshID, const Mesh>            mMeshMap;
     std::unordered_map<TextureID, ResourceBindChord>   mTextureMap;
 
@@ -65,6 +99,20 @@ private:
     // TODO: Use fixed_vector?
     std::vector<Material> mMaterials;
 
+    // Backs the semantic/offset arrays inside each VertexShader's buffer descriptions
+    Memory::LinearArena mShaderDescArena;
+
+    // Cooked 2D textures start at their mip tail and stream the rest on demand
+    D3D11StreamingDevice*        mpStreamingDevice = nullptr;
+    TextureStreamer              mTextureStreamer;
+    std::vector<StreamedBinding> mStreamedBindings;
+
+    // Keyed by (TextureID << 8) | slot
+    std::unordered_map<uint64_t, PackedBinding> mPackedTextures;
+
+    // Holds its own references, page or not
+    std::unordered_map<TextureID, ResourceBindChord> mPackedChords;
+
     // Singleton stuff
     static ResourceCodex* CodexInstance;
 
@@ -76,8 +124,10 @@ private:
     MaterialIndex PushMaterial(const Material& material);
 
     friend struct ShaderFactory;
-    void AddVertexShader(ShaderID hash, const wchar_t* path, ID3D11Device* pDevice);
-    void AddPixelShader(ShaderID hash, const wchar_t* path, ID3D11Device* pDevice);
+    void AddVertexShader(ShaderKey key, const wchar_t* path, ID3D11Device* pDevice);
+    void AddVertexShader(ShaderKey key, ID3D10Blob* pBlob, ShaderReflectionRecord const& record, ID3D11Device* pDevice);
+    void AddPixelShader(ShaderKey key, const wchar_t* path, ID3D11Device* pDevice);
+    void AddPixelShader(ShaderKey key, ID3D10Blob* pBlob, ID3D11Device* pDevice);
 };
 }
 #endif
\ No newline at end of file
@@ -41,7 +41,7 @@ struct VertexShader
     ID3D11InputLayout*  InputLayout;
     ID3D11VertexShader* Shader;
     VertexBufferDescription VertexDesc;
-    VertexBufferDescription InstanceDesc; // Note: The allocated memory inside this one is contiguous with VertexDesc, so no additional free's are required.
+    VertexBufferDescription InstanceDesc; // Note: Both descriptions point into the ResourceCodex's shader arena, which owns them.
     BOOL Instanced;
 };
 
@@ -0,0 +1,216 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of ShaderArchive.h
+----------------------------------------------*/
+#include "ShaderArchive.h"
+
+#include "ByteStream.h"
+#include "hash_util.h"
+
+#include <algorithm>
+#include <fstream>
+#include <string.h>
+
+namespace Renderer {
+
+namespace {
+
+// Header: magic, version, shader model, entry count, data size, checksum of everything after the header
+const size_t kHeaderSize = 24;
+const size_t kEntrySize  = 32;
+
+// Keeps every blob 4-byte aligned inside the data section
+const size_t kBlobAlignment = 4;
+
+}
+
+bool ShaderArchiveWriter::Add(ShaderKey key, ProgramStage stage, const void* pBytecode, size_t bytecodeSize, std::vector<uint8_t> const& reflection)
+{
+    for (ShaderArchiveEntry const& entry : mEntries)
+    {
+        if (entry.Key == key)
+            return false;
+    }
+
+    ShaderArchiveEntry entry = {};
+    entry.Key            = key;
+    entry.Stage          = stage;
+    entry.BytecodeOffset = AddBlob(pBytecode, bytecodeSize);
+    entry.BytecodeSize   = (uint32_t)bytecodeSize;
+    if (!reflection.empty())
+    {
+        entry.ReflectionOffset = AddBlob(reflection.data(), reflection.size());
+        entry.ReflectionSize   = (uint32_t)reflection.size();
+    }
+
+    mEntries.push_back(entry);
+    return true;
+}
+
+uint32_t ShaderArchiveWriter::AddBlob(const void* pData, size_t size)
+{
+    const uint64_t hash = fnv1a64(pData, size);
+    for (BlobRecord const& blob : mBlobs)
+    {
+        if (blob.Hash == hash && blob.Size == size && !memcmp(mData.data() + blob.Offset, pData, size))
+        {
+            mSharedBytes += size;
+            return blob.Offset;
+        }
+    }
+
+    const uint32_t offset = (uint32_t)mData.size();
+    mData.insert(mData.end(), (const uint8_t*)pData, (const uint8_t*)pData + size);
+    mData.resize((mData.size() + kBlobAlignment - 1) & ~(kBlobAlignment - 1), 0);
+
+    mBlobs.push_back({ hash, offset, (uint32_t)size });
+    return offset;
+}
+
+void ShaderArchiveWriter::Serialize(std::vector<uint8_t>& out_bytes) const
+{
+    std::vector<ShaderArchiveEntry> sorted = mEntries;
+    std::sort(sorted.begin(), sorted.end(), [](ShaderArchiveEntry const& a, ShaderArchiveEntry const& b) { return a.Key < b.Key; });
+
+    out_bytes.clear();
+    out_bytes.reserve(kHeaderSize + sorted.size() * kEntrySize + mData.size());
+
+    ByteWriter w = { out_bytes };
+    w.U32(kShaderArchiveMagic);
+    w.U16(kShaderArchiveVersion);
+    w.U16(mShaderModel);
+    w.U32((uint32_t)sorted.size());
+    w.U32((uint32_t)mData.size());
+    w.U64(0); // Checksum, patched below
+
+    for (ShaderArchiveEntry const& entry : sorted)
+    {
+        w.U32(entry.Key.Program);
+        w.U8((uint8_t)entry.Stage);
+        w.U8(0);
+        w.U16(0);
+        w.U64(entry.Key.Variant);
+        w.U32(entry.BytecodeOffset);
+        w.U32(entry.BytecodeSize);
+        w.U32(entry.ReflectionOffset);
+        w.U32(entry.ReflectionSize);
+    }
+
+    out_bytes.insert(out_bytes.end(), mData.begin(), mData.end());
+
+    // Last field of the header
+    const uint64_t checksum = fnv1a64(out_bytes.data() + kHeaderSize, out_bytes.size() - kHeaderSize);
+    for (size_t i = 0; i != sizeof(checksum); ++i)
+        out_bytes[kHeaderSize - sizeof(checksum) + i] = (uint8_t)(checksum >> (i * 8));
+}
+
+bool ShaderArchiveWriter::Save(std::filesystem::path const& path) const
+{
+    std::vector<uint8_t> bytes;
+    Serialize(bytes);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+        return false;
+
+    file.write((const char*)bytes.data(), bytes.size());
+    return file.good();
+}
+
+ArchiveResult ShaderArchive::Load(std::filesystem::path const& path)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+        return ArchiveResult::MISSING;
+
+    std::vector<uint8_t> bytes((size_t)file.tellg());
+    file.seekg(0);
+    if (!file.read((char*)bytes.data(), bytes.size()))
+        return ArchiveResult::CORRUPT;
+
+    return Parse(std::move(bytes));
+}
+
+ArchiveResult ShaderArchive::Parse(std::vector<uint8_t>&& bytes)
+{
+    mBytes.clear();
+    mEntries.clear();
+    mDataOffset = 0;
+    mShaderModel = 0;
+
+    ByteReader r = { bytes.data(), bytes.size(), 0 };
+    if (!r.Has(kHeaderSize))
+        return ArchiveResult::CORRUPT;
+
+    if (r.U32() != kShaderArchiveMagic || r.U16() != kShaderArchiveVersion)
+        return ArchiveResult::BAD_HEADER;
+
+    const uint16_t shaderModel = r.U16();
+    const uint32_t entryCount  = r.U32();
+    const uint32_t dataSize   = r.U32();
+    const uint64_t checksum   = r.U64();
+
+    const size_t dataOffset = kHeaderSize + (size_t)entryCount * kEntrySize;
+    if (bytes.size() != dataOffset + dataSize)
+        return ArchiveResult::CORRUPT;
+
+    if (fnv1a64(bytes.data() + kHeaderSize, bytes.size() - kHeaderSize) != checksum)
+        return ArchiveResult::CORRUPT;
+
+    std::vector<ShaderArchiveEntry> entries(entryCount);
+    for (ShaderArchiveEntry& entry : entries)
+    {
+        entry.Key.Program      = r.U32();
+        entry.Stage            = (ProgramStage)r.U8();
+        r.U8();
+        r.U16();
+        entry.Key.Variant      = r.U64();
+        entry.BytecodeOffset   = r.U32();
+        entry.BytecodeSize     = r.U32();
+        entry.ReflectionOffset = r.U32();
+        entry.ReflectionSize   = r.U32();
+
+        const bool bytecodeFits   = (uint64_t)entry.BytecodeOffset + entry.BytecodeSize <= dataSize;
+        const bool reflectionFits = (uint64_t)entry.ReflectionOffset + entry.ReflectionSize <= dataSize;
+        if (entry.Stage >= ProgramStage::COUNT || !entry.BytecodeSize || !bytecodeFits || !reflectionFits)
+            return ArchiveResult::CORRUPT;
+    }
+
+    // Find() relies on the order
+    for (size_t i = 1; i < entries.size(); ++i)
+    {
+        if (!(entries[i - 1].Key < entries[i].Key))
+            return ArchiveResult::CORRUPT;
+    }
+
+    mBytes      = std::move(bytes);
+    mEntries    = std::move(entries);
+    mDataOffset  = dataOffset;
+    mShaderModel = shaderModel;
+    return ArchiveResult::OK;
+}
+
+ShaderArchiveEntry const* ShaderArchive::Find(ShaderKey key) const
+{
+    auto it = std::lower_bound(mEntries.begin(), mEntries.end(), key, [](ShaderArchiveEntry const& entry, ShaderKey const& k) { return entry.Key < k; });
+    if (it == mEntries.end() || !(it->Key == key))
+        return nullptr;
+
+    return &*it;
+}
+
+const char* ShaderArchive::GetResultString(ArchiveResult result)
+{
+    switch (result)
+    {
+    case ArchiveResult::OK:         return "OK";
+    case ArchiveResult::MISSING:    return "MISSING";
+    case ArchiveResult::BAD_HEADER: return "BAD_HEADER";
+    case ArchiveResult::CORRUPT:    return "CORRUPT";
+    }
+
+    return "UNKNOWN";
+}
+
+}
@@ -0,0 +1,100 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Single-file archive of every compiled shader variant
+Entries are sorted by (program, variant) and found with a binary search.
+Each carries its bytecode and the serialized reflection record that goes with it.
+Identical bytecode (e.g. a feature that compiles away for one program) is stored once.
+----------------------------------------------*/
+#ifndef MUON_SHADERARCHIVE_H
+#define MUON_SHADERARCHIVE_H
+
+#include "ShaderVariant.h"
+
+#include <filesystem>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace Renderer {
+
+static const uint32_t kShaderArchiveMagic   = 0x5241534D; // "MSAR"
+static const uint16_t kShaderArchiveVersion = 1;
+
+struct ShaderArchiveEntry
+{
+    ShaderKey   Key;
+    ProgramStage Stage;
+    uint32_t    BytecodeOffset;     // From the start of the data section
+    uint32_t    BytecodeSize;
+    uint32_t    ReflectionOffset;
+    uint32_t    ReflectionSize;     // 0 when the entry has no reflection record
+};
+
+enum class ArchiveResult : uint8_t
+{
+    OK,
+    MISSING,
+    BAD_HEADER,     // Wrong magic or version
+    CORRUPT         // Truncated, out of bounds, unsorted or failed its checksum
+};
+
+class ShaderArchiveWriter
+{
+public:
+    // Major * 10 + minor, e.g. 50 for FXC bytecode or 60 for DXIL. Tells a D3D11 runtime to keep its hands off DXIL.
+    void SetShaderModel(uint16_t shaderModel) { mShaderModel = shaderModel; }
+
+    // Returns false if the key was already added
+    bool Add(ShaderKey key, ProgramStage stage, const void* pBytecode, size_t bytecodeSize, std::vector<uint8_t> const& reflection);
+
+    void Serialize(std::vector<uint8_t>& out_bytes) const;
+    bool Save(std::filesystem::path const& path) const;
+
+    uint32_t GetEntryCount() const  { return (uint32_t)mEntries.size(); }
+    uint64_t GetSharedBytes() const { return mSharedBytes; }    // Bytecode skipped because an identical blob was already stored
+
+private:
+    uint32_t AddBlob(const void* pData, size_t size);
+
+    struct BlobRecord
+    {
+        uint64_t Hash;
+        uint32_t Offset;
+        uint32_t Size;
+    };
+
+    std::vector<ShaderArchiveEntry> mEntries;
+    std::vector<uint8_t>            mData;
+    std::vector<BlobRecord>         mBlobs;         // Everything already in mData, for dedup
+    uint64_t                        mSharedBytes = 0;
+    uint16_t                        mShaderModel = 0;
+};
+
+class ShaderArchive
+{
+public:
+    ArchiveResult Load(std::filesystem::path const& path);
+    ArchiveResult Parse(std::vector<uint8_t>&& bytes);
+
+    // nullptr if the archive doesn't have that variant
+    ShaderArchiveEntry const* Find(ShaderKey key) const;
+
+    uint16_t                  GetShaderModel() const       { return mShaderModel; }
+    uint32_t                  GetEntryCount() const        { return (uint32_t)mEntries.size(); }
+    ShaderArchiveEntry const& GetEntry(uint32_t i) const   { return mEntries[i]; }
+
+    const uint8_t* GetBytecode(ShaderArchiveEntry const& entry) const   { return mBytes.data() + mDataOffset + entry.BytecodeOffset; }
+    const uint8_t* GetReflection(ShaderArchiveEntry const& entry) const { return mBytes.data() + mDataOffset + entry.ReflectionOffset; }
+
+    static const char* GetResultString(ArchiveResult result);
+
+private:
+    std::vector<uint8_t>            mBytes;
+    std::vector<ShaderArchiveEntry> mEntries;
+    size_t                          mDataOffset = 0;
+    uint16_t                        mShaderModel = 0;
+};
+
+}
+#endif
@@ -0,0 +1,252 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of ShaderReflectionRecord.h
+----------------------------------------------*/
+#include "ShaderReflectionRecord.h"
+
+#include "ByteStream.h"
+#include "hash_util.h"
+
+#include <fstream>
+#include <string.h>
+
+namespace Renderer {
+
+namespace {
+
+const char* kSemanticNames[kReflectedSemanticCount] =
+{
+    "POSITION",
+    "NORMAL",
+    "TEXCOORD",
+    "TANGENT",
+    "BINORMAL",
+    "COLOR",
+    "BLENDINDICES",
+    "BLENDWEIGHTS",
+    "WORLDMATRIX"
+};
+
+const char* kInstancedSemanticNames[kReflectedSemanticCount] =
+{
+    "INSTANCE_POSITION",
+    "INSTANCE_NORMAL",
+    "INSTANCE_TEXCOORD",
+    "INSTANCE_TANGENT",
+    "INSTANCE_BINORMAL",
+    "INSTANCE_COLOR",
+    "INSTANCE_BLENDINDICES",
+    "INSTANCE_BLENDWEIGHTS",
+    "INSTANCE_WORLDMATRIX"
+};
+
+// Fixed-size little endian header, followed by the inputs, cbuffers, textures and a trailing checksum
+const size_t kHeaderSize   = 32;
+const size_t kInputSize    = 6;
+const size_t kBindingSize  = 8;
+const size_t kChecksumSize = 8;
+
+void WriteBinding(ByteWriter& w, ReflectedBinding const& binding)
+{
+    w.U32(binding.NameHash);
+    w.U8(binding.Slot);
+    w.U8(binding.BindCount);
+    w.U16(0);
+}
+
+ReflectedBinding ReadBinding(ByteReader& r)
+{
+    ReflectedBinding binding;
+    binding.NameHash  = r.U32();
+    binding.Slot      = r.U8();
+    binding.BindCount = r.U8();
+    binding.Reserved  = r.U16();
+    return binding;
+}
+
+}
+
+const char* GetSemanticName(uint8_t semantic, bool instanced)
+{
+    if (semantic >= kReflectedSemanticCount)
+        return nullptr;
+
+    return instanced ? kInstancedSemanticNames[semantic] : kSemanticNames[semantic];
+}
+
+bool FindSemantic(const char* semanticName, uint8_t* out_semantic, bool* out_instanced)
+{
+    for (uint8_t s = 0; s != kReflectedSemanticCount; ++s)
+    {
+        if (!strcmp(semanticName, kSemanticNames[s]))
+        {
+            *out_semantic = s;
+            *out_instanced = false;
+            return true;
+        }
+
+        if (!strcmp(semanticName, kInstancedSemanticNames[s]))
+        {
+            *out_semantic = s;
+            *out_instanced = true;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+uint64_t HashShaderBytecode(const void* pBytecode, size_t bytecodeSize)
+{
+    return fnv1a64(pBytecode, bytecodeSize);
+}
+
+std::filesystem::path GetReflectionPath(std::filesystem::path const& shaderPath)
+{
+    std::filesystem::path reflPath = shaderPath;
+    return reflPath.replace_extension(".refl");
+}
+
+void SerializeReflectionRecord(ShaderReflectionRecord const& record, std::vector<uint8_t>& out_bytes)
+{
+    out_bytes.clear();
+    out_bytes.reserve(kHeaderSize + record.InputCount * kInputSize + (record.CBufferCount + record.TextureCount) * kBindingSize + kChecksumSize);
+
+    ByteWriter w = { out_bytes };
+    w.U32(kReflectionMagic);
+    w.U16(kReflectionVersion);
+    w.U8(record.InputCount);
+    w.U8(record.InstanceStart);
+    w.U64(record.BytecodeHash);
+    w.U32(record.BytecodeSize);
+    w.U16(record.VertexByteSize);
+    w.U16(record.InstanceByteSize);
+    w.U8(record.CBufferCount);
+    w.U8(record.TextureCount);
+    w.U16(0);
+    w.U32(0);
+
+    for (uint8_t i = 0; i != record.InputCount; ++i)
+    {
+        ReflectedInput const& input = record.Inputs[i];
+        w.U8(input.Semantic);
+        w.U8(input.SemanticIndex);
+        w.U8(input.ComponentType);
+        w.U8(input.ComponentCount);
+        w.U16(input.ByteOffset);
+    }
+
+    for (uint8_t i = 0; i != record.CBufferCount; ++i)
+        WriteBinding(w, record.CBuffers[i]);
+
+    for (uint8_t i = 0; i != record.TextureCount; ++i)
+        WriteBinding(w, record.Textures[i]);
+
+    w.U64(fnv1a64(out_bytes.data(), out_bytes.size()));
+}
+
+ReflectionResult ParseReflectionRecord(const uint8_t* pData, size_t dataSize, const void* pBytecode, size_t bytecodeSize, ShaderReflectionRecord* out_record)
+{
+    ByteReader r = { pData, dataSize, 0 };
+    if (!pData || !r.Has(kHeaderSize + kChecksumSize))
+        return ReflectionResult::CORRUPT;
+
+    if (r.U32() != kReflectionMagic || r.U16() != kReflectionVersion)
+        return ReflectionResult::BAD_HEADER;
+
+    ShaderReflectionRecord record = {};
+    record.InputCount       = r.U8();
+    record.InstanceStart    = r.U8();
+    record.BytecodeHash     = r.U64();
+    record.BytecodeSize     = r.U32();
+    record.VertexByteSize   = r.U16();
+    record.InstanceByteSize = r.U16();
+    record.CBufferCount     = r.U8();
+    record.TextureCount     = r.U8();
+    r.U16();
+    r.U32();
+
+    if (record.InputCount > kMaxReflectedInputs || record.CBufferCount > kMaxReflectedBindings || record.TextureCount > kMaxReflectedBindings)
+        return ReflectionResult::CORRUPT;
+
+    if (record.InstanceStart != kNoInstanceInputs && record.InstanceStart >= record.InputCount)
+        return ReflectionResult::CORRUPT;
+
+    const size_t bodySize = record.InputCount * kInputSize + (record.CBufferCount + record.TextureCount) * kBindingSize;
+    if (dataSize != kHeaderSize + bodySize + kChecksumSize)
+        return ReflectionResult::CORRUPT;
+
+    for (uint8_t i = 0; i != record.InputCount; ++i)
+    {
+        ReflectedInput& input = record.Inputs[i];
+        input.Semantic       = r.U8();
+        input.SemanticIndex  = r.U8();
+        input.ComponentType  = r.U8();
+        input.ComponentCount = r.U8();
+        input.ByteOffset     = r.U16();
+
+        if (input.Semantic >= kReflectedSemanticCount || input.ComponentCount == 0 || input.ComponentCount > 4)
+            return ReflectionResult::CORRUPT;
+    }
+
+    for (uint8_t i = 0; i != record.CBufferCount; ++i)
+        record.CBuffers[i] = ReadBinding(r);
+
+    for (uint8_t i = 0; i != record.TextureCount; ++i)
+        record.Textures[i] = ReadBinding(r);
+
+    const uint64_t checksum = fnv1a64(pData, r.Offset);
+    if (r.U64() != checksum)
+        return ReflectionResult::CORRUPT;
+
+    // Size is the cheap check, the hash catches recompiles that happen to keep the same size
+    if (record.BytecodeSize != bytecodeSize || record.BytecodeHash != HashShaderBytecode(pBytecode, bytecodeSize))
+        return ReflectionResult::STALE;
+
+    *out_record = record;
+    return ReflectionResult::OK;
+}
+
+ReflectionResult LoadReflectionRecord(std::filesystem::path const& path, const void* pBytecode, size_t bytecodeSize, ShaderReflectionRecord* out_record)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+        return ReflectionResult::MISSING;
+
+    std::vector<uint8_t> bytes((size_t)file.tellg());
+    file.seekg(0);
+    if (!file.read((char*)bytes.data(), bytes.size()))
+        return ReflectionResult::CORRUPT;
+
+    return ParseReflectionRecord(bytes.data(), bytes.size(), pBytecode, bytecodeSize, out_record);
+}
+
+bool SaveReflectionRecord(std::filesystem::path const& path, ShaderReflectionRecord const& record)
+{
+    std::vector<uint8_t> bytes;
+    SerializeReflectionRecord(record, bytes);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+        return false;
+
+    file.write((const char*)bytes.data(), bytes.size());
+    return file.good();
+}
+
+const char* GetReflectionResultString(ReflectionResult result)
+{
+    switch (result)
+    {
+    case ReflectionResult::OK:         return "OK";
+    case ReflectionResult::MISSING:    return "MISSING";
+    case ReflectionResult::BAD_HEADER: return "BAD_HEADER";
+    case ReflectionResult::CORRUPT:    return "CORRUPT";
+    case ReflectionResult::STALE:      return "STALE";
+    }
+
+    return "UNKNOWN";
+}
+
+}
@@ -0,0 +1,100 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Compact reflection sidecar (.refl) stored next to each compiled shader
+Holds what D3DReflect would have told us about the vertex inputs and bindings,
+validated against a hash of the bytecode it was generated from.
+No D3D dependencies, so the tools can write it and it can be read anywhere.
+----------------------------------------------*/
+#ifndef MUON_SHADERREFLECTIONRECORD_H
+#define MUON_SHADERREFLECTIONRECORD_H
+
+#include <filesystem>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace Renderer {
+
+static const uint32_t kReflectionMagic   = 0x4645524D; // "MREF"
+static const uint16_t kReflectionVersion = 1;
+
+static const uint8_t kMaxReflectedInputs   = 16;
+static const uint8_t kMaxReflectedBindings = 16;
+static const uint8_t kNoInstanceInputs     = UINT8_MAX;
+
+// Matches D3D_REGISTER_COMPONENT_TYPE so the runtime can pick a DXGI format
+enum class ReflectedComponentType : uint8_t
+{
+    UNKNOWN = 0,
+    UINT32  = 1,
+    SINT32  = 2,
+    FLOAT32 = 3
+};
+
+struct ReflectedInput
+{
+    uint8_t  Semantic;       // Renderer::Semantics
+    uint8_t  SemanticIndex;
+    uint8_t  ComponentType;  // ReflectedComponentType
+    uint8_t  ComponentCount;
+    uint16_t ByteOffset;     // Relative to the start of its own buffer (vertex or instance)
+};
+
+struct ReflectedBinding
+{
+    uint32_t NameHash;       // fnv1a of the HLSL name
+    uint8_t  Slot;
+    uint8_t  BindCount;
+    uint16_t Reserved;
+};
+
+struct ShaderReflectionRecord
+{
+    uint64_t BytecodeHash;
+    uint32_t BytecodeSize;
+
+    ReflectedInput Inputs[kMaxReflectedInputs];
+    uint8_t        InputCount;
+    uint8_t        InstanceStart;   // Index of the first per-instance input, or kNoInstanceInputs
+    uint16_t       VertexByteSize;
+    uint16_t       InstanceByteSize;
+
+    ReflectedBinding CBuffers[kMaxReflectedBindings];
+    uint8_t          CBufferCount;
+
+    ReflectedBinding Textures[kMaxReflectedBindings];
+    uint8_t          TextureCount;
+};
+
+enum class ReflectionResult : uint8_t
+{
+    OK,
+    MISSING,
+    BAD_HEADER,     // Wrong magic or version
+    CORRUPT,        // Truncated or failed its own checksum
+    STALE           // Valid, but generated from different bytecode
+};
+
+// Semantic names as written in HLSL, indexed by Renderer::Semantics
+static const uint8_t kReflectedSemanticCount = 9;
+const char* GetSemanticName(uint8_t semantic, bool instanced);
+
+// Maps an HLSL semantic name to its Renderer::Semantics index. Returns false for unknown names.
+bool FindSemantic(const char* semanticName, uint8_t* out_semantic, bool* out_instanced);
+
+uint64_t HashShaderBytecode(const void* pBytecode, size_t bytecodeSize);
+
+// Replaces the extension of a .cso path with .refl
+std::filesystem::path GetReflectionPath(std::filesystem::path const& shaderPath);
+
+void             SerializeReflectionRecord(ShaderReflectionRecord const& record, std::vector<uint8_t>& out_bytes);
+ReflectionResult ParseReflectionRecord(const uint8_t* pData, size_t dataSize, const void* pBytecode, size_t bytecodeSize, ShaderReflectionRecord* out_record);
+
+ReflectionResult LoadReflectionRecord(std::filesystem::path const& path, const void* pBytecode, size_t bytecodeSize, ShaderReflectionRecord* out_record);
+bool             SaveReflectionRecord(std::filesystem::path const& path, ShaderReflectionRecord const& record);
+
+const char* GetReflectionResultString(ReflectionResult result);
+
+}
+#endif
@@ -0,0 +1,162 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of ShaderVariant.h
+----------------------------------------------*/
+#include "ShaderVariant.h"
+
+#include <string.h>
+
+namespace Renderer {
+
+namespace {
+
+const char* kFeatureNames[(uint8_t)ShaderFeature::COUNT] =
+{
+    "INSTANCED",
+    "NORMAL_MAP",
+    "ALPHA_TEST",
+    "TEXTURE_ARRAY",
+    "CLUSTERED_LIGHTS",
+    "SHADOWS"
+};
+
+const char* kStageSuffixes[(uint8_t)ProgramStage::COUNT] = { "VS", "PS", "CS", "GS", "HS", "DS" };
+const char* kStagePrefixes[(uint8_t)ProgramStage::COUNT] = { "vs", "ps", "cs", "gs", "hs", "ds" };
+
+const char kVariantTag[] = "Variants:";
+
+bool IsNameChar(char c)
+{
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+}
+
+const char* GetShaderFeatureName(ShaderFeature feature)
+{
+    if ((uint8_t)feature >= (uint8_t)ShaderFeature::COUNT)
+        return nullptr;
+
+    return kFeatureNames[(uint8_t)feature];
+}
+
+bool FindShaderFeature(const char* name, size_t nameLength, ShaderFeature* out_feature)
+{
+    for (uint8_t f = 0; f != (uint8_t)ShaderFeature::COUNT; ++f)
+    {
+        if (strlen(kFeatureNames[f]) == nameLength && !strncmp(name, kFeatureNames[f], nameLength))
+        {
+            *out_feature = (ShaderFeature)f;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool ParseVariantDeclaration(std::string const& source, ShaderVariantKey* out_supported, std::string& out_error)
+{
+    *out_supported = kBaseVariant;
+
+    size_t lineStart = 0;
+    while (lineStart < source.size())
+    {
+        size_t lineEnd = source.find('\n', lineStart);
+        if (lineEnd == std::string::npos)
+            lineEnd = source.size();
+
+        // Only a line comment of the form "// Variants: A B C" counts
+        size_t pos = source.find_first_not_of(" \t", lineStart);
+        if (pos != std::string::npos && pos + 2 <= lineEnd && !source.compare(pos, 2, "//"))
+        {
+            pos = source.find_first_not_of(" \t", pos + 2);
+            if (pos != std::string::npos && pos < lineEnd && !source.compare(pos, sizeof(kVariantTag) - 1, kVariantTag))
+            {
+                pos += sizeof(kVariantTag) - 1;
+                while (pos < lineEnd)
+                {
+                    if (!IsNameChar(source[pos]))
+                    {
+                        ++pos;
+                        continue;
+                    }
+
+                    const size_t nameStart = pos;
+                    while (pos < lineEnd && IsNameChar(source[pos]))
+                        ++pos;
+
+                    ShaderFeature feature;
+                    if (!FindShaderFeature(source.data() + nameStart, pos - nameStart, &feature))
+                    {
+                        out_error = "unknown shader feature '" + source.substr(nameStart, pos - nameStart) + "'";
+                        return false;
+                    }
+
+                    *out_supported |= ToVariantKey(feature);
+                }
+
+                return true;
+            }
+        }
+
+        lineStart = lineEnd + 1;
+    }
+
+    return true;
+}
+
+void EnumerateVariants(ShaderVariantKey supported, std::vector<ShaderVariantKey>& out_variants)
+{
+    out_variants.clear();
+
+    // Counting up through the submasks of supported
+    ShaderVariantKey variant = kBaseVariant;
+    do
+    {
+        out_variants.push_back(variant);
+        variant = (variant - supported) & supported;
+    } while (variant != kBaseVariant);
+}
+
+std::string GetVariantName(std::string const& programName, ShaderVariantKey variant)
+{
+    std::string name = programName;
+    for (uint8_t f = 0; f != (uint8_t)ShaderFeature::COUNT; ++f)
+    {
+        if (HasFeature(variant, (ShaderFeature)f))
+        {
+            name += '+';
+            name += kFeatureNames[f];
+        }
+    }
+
+    return name;
+}
+
+bool GetProgramStage(std::string const& programName, ProgramStage* out_stage)
+{
+    if (programName.size() < 2)
+        return false;
+
+    for (uint8_t s = 0; s != (uint8_t)ProgramStage::COUNT; ++s)
+    {
+        if (!programName.compare(programName.size() - 2, 2, kStageSuffixes[s]))
+        {
+            *out_stage = (ProgramStage)s;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+const char* GetProgramStagePrefix(ProgramStage stage)
+{
+    if ((uint8_t)stage >= (uint8_t)ProgramStage::COUNT)
+        return nullptr;
+
+    return kStagePrefixes[(uint8_t)stage];
+}
+
+}
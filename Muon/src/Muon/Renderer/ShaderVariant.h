@@ -0,0 +1,96 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Shader permutations
+One .hlsl file is one program. Each feature it supports is an #if in the source,
+and the set of enabled features is the 64-bit variant key the program is looked up by.
+A program lists what it supports on a comment line near the top:
+    // Variants: INSTANCED NORMAL_MAP
+No D3D dependencies, so the tools and the runtime share it.
+----------------------------------------------*/
+#ifndef MUON_SHADERVARIANT_H
+#define MUON_SHADERVARIANT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace Renderer {
+
+// fnv1a of the program's file name without extension, e.g. "PhongPS"
+typedef uint32_t ShaderID;
+
+typedef uint64_t ShaderVariantKey;
+static const ShaderVariantKey kBaseVariant = 0;
+
+// Bit positions in a ShaderVariantKey. Append only: keys are baked into archives.
+enum class ShaderFeature : uint8_t
+{
+    INSTANCED,        // World matrix comes from the instance stream instead of a cbuffer
+    NORMAL_MAP,       // Samples a tangent space normal map from t1
+    ALPHA_TEST,       // Clips texels below the alpha cutoff
+    TEXTURE_ARRAY,    // Material textures are slices or atlas cells of packed pages, see PSPerMaterial
+    CLUSTERED_LIGHTS, // Adds the point and spot lights binned into the camera's cluster grid, see PSClusters
+    SHADOWS,          // Shadows the sun through the cascaded shadow map at t11, see PSShadows
+    COUNT
+};
+
+static_assert((uint8_t)ShaderFeature::COUNT <= 64, "ShaderVariantKey has one bit per feature");
+
+// Stage a program compiles to, from its file name suffix as in the Shaders project.
+// Separate from the backend's ShaderStage, which only covers the stages it can bind.
+enum class ProgramStage : uint8_t
+{
+    VS,
+    PS,
+    CS,
+    GS,
+    HS,
+    DS,
+    COUNT
+};
+
+struct ShaderKey
+{
+    ShaderID         Program;
+    ShaderVariantKey Variant;
+
+    bool operator==(ShaderKey const& other) const { return Program == other.Program && Variant == other.Variant; }
+    bool operator<(ShaderKey const& other) const  { return Program != other.Program ? Program < other.Program : Variant < other.Variant; }
+};
+
+struct ShaderKeyHasher
+{
+    size_t operator()(ShaderKey const& key) const { return (size_t)(key.Variant * 0x9E3779B97F4A7C15ull) ^ key.Program; }
+};
+
+constexpr ShaderVariantKey ToVariantKey(ShaderFeature feature)
+{
+    return 1ull << (uint8_t)feature;
+}
+
+constexpr bool HasFeature(ShaderVariantKey variant, ShaderFeature feature)
+{
+    return (variant & ToVariantKey(feature)) != 0;
+}
+
+// Also the preprocessor define each feature is compiled with
+const char* GetShaderFeatureName(ShaderFeature feature);
+bool        FindShaderFeature(const char* name, size_t nameLength, ShaderFeature* out_feature);
+
+// Reads the "// Variants:" line. A program without one only has the base variant.
+bool ParseVariantDeclaration(std::string const& source, ShaderVariantKey* out_supported, std::string& out_error);
+
+// Every subset of supported, base variant first
+void EnumerateVariants(ShaderVariantKey supported, std::vector<ShaderVariantKey>& out_variants);
+
+// "PhongPS" for the base variant, "PhongPS+NORMAL_MAP+ALPHA_TEST" otherwise
+std::string GetVariantName(std::string const& programName, ShaderVariantKey variant);
+
+// Stage from the last two letters of the program name. Returns false if they aren't a stage.
+bool        GetProgramStage(std::string const& programName, ProgramStage* out_stage);
+const char* GetProgramStagePrefix(ProgramStage stage);   // "vs", "ps", ... as used in compiler profiles
+
+}
+#endif
@@ -0,0 +1,457 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of TexturePacker.h
+----------------------------------------------*/
+#include "TexturePacker.h"
+
+#include "ByteStream.h"
+#include "hash_util.h"
+
+#include <algorithm>
+#include <fstream>
+#include <numeric>
+#include <string.h>
+
+namespace Renderer {
+
+namespace {
+
+// Header: magic, version, reserved, page count, entry count, checksum of everything after the header
+const size_t kManifestHeaderSize = 24;
+
+bool IsPowerOfTwo(uint32_t v)
+{
+    return v && !(v & (v - 1));
+}
+
+uint32_t NextPowerOfTwo(uint32_t v)
+{
+    uint32_t p = 1;
+    while (p < v)
+        p <<= 1;
+    return p;
+}
+
+uint32_t GetBlockDimension(DDSFormat format)
+{
+    return IsBlockCompressed(format) ? 4 : 1;
+}
+
+// Mips an atlas cell keeps while every one of them is still a whole number of blocks
+uint32_t GetCellMipCount(DDSDesc const& desc)
+{
+    const uint32_t block = GetBlockDimension(desc.Format);
+    const uint32_t smaller = std::min(desc.Width, desc.Height);
+
+    uint32_t mips = 1;
+    while (mips < desc.MipCount && (smaller >> mips) >= block)
+        mips++;
+    return mips;
+}
+
+bool SameArrayGroup(DDSDesc const& a, DDSDesc const& b)
+{
+    return a.Format == b.Format && a.Width == b.Width && a.Height == b.Height && a.MipCount == b.MipCount;
+}
+
+void PutString(ByteWriter& w, std::string const& s)
+{
+    w.U16((uint16_t)s.size());
+    w.Bytes.insert(w.Bytes.end(), s.begin(), s.end());
+}
+
+bool GetString(ByteReader& r, std::string& out_s)
+{
+    if (!r.Has(2))
+        return false;
+
+    const uint16_t length = r.U16();
+    if (!r.Has(length))
+        return false;
+
+    out_s.assign((const char*)r.Data + r.Offset, length);
+    r.Offset += length;
+    return true;
+}
+
+uint32_t FloatBits(float f)
+{
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+
+float BitsFloat(uint32_t bits)
+{
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+// Shelf packs one format's candidates, tallest first. Shelf heights only shrink and x is rounded up
+// to each cell's width, so every cell lands on a multiple of its own size.
+void PlanAtlases(DDSDesc const* pSources, std::vector<uint32_t> const& candidates, uint32_t dimension, TexturePackPlan& out_plan)
+{
+    std::vector<uint32_t> members;
+    uint32_t x = 0;
+    uint32_t shelfY = 0;
+    uint32_t shelfHeight = 0;
+    uint32_t right = 0;
+    uint32_t bottom = 0;
+
+    auto finishPage = [&]()
+    {
+        if (members.size() < 2)
+        {
+            // A page of one is the texture itself with a detour
+            for (uint32_t m : members)
+                out_plan.Textures[m].Page = kUnpackedTexture;
+        }
+        else
+        {
+            TexturePage page;
+            page.Kind           = TexturePageKind::ATLAS;
+            page.Desc.Width     = NextPowerOfTwo(right);
+            page.Desc.Height    = NextPowerOfTwo(bottom);
+            page.Desc.MipCount  = UINT32_MAX;
+            page.Desc.ArraySize = 1;
+            page.Desc.Format    = pSources[members[0]].Format;
+            for (uint32_t m : members)
+            {
+                page.Desc.MipCount = std::min(page.Desc.MipCount, GetCellMipCount(pSources[m]));
+                out_plan.Textures[m].Page = (uint32_t)out_plan.Pages.size();
+            }
+
+            page.Members = members;
+            out_plan.Pages.push_back(page);
+        }
+
+        members.clear();
+        x = shelfY = shelfHeight = right = bottom = 0;
+    };
+
+    for (uint32_t index : candidates)
+    {
+        const uint32_t w = pSources[index].Width;
+        const uint32_t h = pSources[index].Height;
+
+        x = (x + w - 1) & ~(w - 1);
+        if (x + w > dimension)
+        {
+            shelfY += shelfHeight;
+            shelfHeight = 0;
+            x = 0;
+        }
+        if (shelfY + h > dimension)
+            finishPage();
+        if (shelfHeight == 0)
+            shelfHeight = h;
+
+        out_plan.Textures[index].X = x;
+        out_plan.Textures[index].Y = shelfY;
+        members.push_back(index);
+
+        x += w;
+        right = std::max(right, x);
+        bottom = std::max(bottom, shelfY + h);
+    }
+
+    finishPage();
+}
+
+}
+
+uint32_t TexturePackPlan::GetTextureCount() const
+{
+    uint32_t count = (uint32_t)Pages.size();
+    for (PackedTexture const& texture : Textures)
+    {
+        if (texture.Page == kUnpackedTexture)
+            count++;
+    }
+
+    return count;
+}
+
+void PlanTexturePack(DDSDesc const* pSources, uint32_t count, TexturePackerConfig const& config, TexturePackPlan& out_plan)
+{
+    out_plan.Pages.clear();
+    out_plan.Textures.resize(count);
+    for (uint32_t i = 0; i != count; ++i)
+        out_plan.Textures[i] = { kUnpackedTexture, 0, 0, 0, pSources[i].Width, pSources[i].Height };
+
+    std::vector<uint32_t> order(count);
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(), [pSources](uint32_t a, uint32_t b)
+    {
+        DDSDesc const& da = pSources[a];
+        DDSDesc const& db = pSources[b];
+        if (da.Format != db.Format)     return da.Format < db.Format;
+        if (da.Width != db.Width)       return da.Width < db.Width;
+        if (da.Height != db.Height)     return da.Height < db.Height;
+        return da.MipCount < db.MipCount;
+    });
+
+    // Identical layouts become array slices, in the order they were given
+    const uint32_t maxSlices = std::max(config.MaxArraySlices, 1u);
+    std::vector<uint32_t> leftovers;
+    for (uint32_t begin = 0; begin != count;)
+    {
+        uint32_t end = begin + 1;
+        while (end != count && SameArrayGroup(pSources[order[begin]], pSources[order[end]]))
+            end++;
+
+        for (uint32_t chunk = begin; chunk < end; chunk += maxSlices)
+        {
+            const uint32_t chunkEnd = std::min(chunk + maxSlices, end);
+            if (chunkEnd - chunk < 2 || pSources[order[chunk]].ArraySize != 1)
+            {
+                leftovers.insert(leftovers.end(), order.begin() + chunk, order.begin() + chunkEnd);
+                continue;
+            }
+
+            TexturePage page;
+            page.Kind           = TexturePageKind::ARRAY;
+            page.Desc           = pSources[order[chunk]];
+            page.Desc.ArraySize = chunkEnd - chunk;
+            for (uint32_t i = chunk; i != chunkEnd; ++i)
+            {
+                out_plan.Textures[order[i]].Page  = (uint32_t)out_plan.Pages.size();
+                out_plan.Textures[order[i]].Slice = i - chunk;
+                page.Members.push_back(order[i]);
+            }
+            out_plan.Pages.push_back(page);
+        }
+
+        begin = end;
+    }
+
+    if (!config.Atlases)
+        return;
+
+    // What's left may still atlas: power of two, at most half a page and at least MinAtlasCell (and a block) on a side
+    std::vector<uint32_t> candidates;
+    for (uint32_t index : leftovers)
+    {
+        DDSDesc const& desc = pSources[index];
+        const uint32_t minCell = std::max(config.MinAtlasCell, GetBlockDimension(desc.Format));
+        if (IsPowerOfTwo(desc.Width) && IsPowerOfTwo(desc.Height) && desc.ArraySize == 1 &&
+            std::max(desc.Width, desc.Height) <= config.AtlasDimension / 2 && std::min(desc.Width, desc.Height) >= minCell)
+        {
+            candidates.push_back(index);
+        }
+    }
+
+    std::stable_sort(candidates.begin(), candidates.end(), [pSources](uint32_t a, uint32_t b)
+    {
+        DDSDesc const& da = pSources[a];
+        DDSDesc const& db = pSources[b];
+        if (da.Format != db.Format)     return da.Format < db.Format;
+        if (da.Height != db.Height)     return da.Height > db.Height;
+        return da.Width > db.Width;
+    });
+
+    for (size_t begin = 0; begin != candidates.size();)
+    {
+        size_t end = begin + 1;
+        while (end != candidates.size() && pSources[candidates[end]].Format == pSources[candidates[begin]].Format)
+            end++;
+
+        const std::vector<uint32_t> run(candidates.begin() + begin, candidates.begin() + end);
+        PlanAtlases(pSources, run, config.AtlasDimension, out_plan);
+        begin = end;
+    }
+}
+
+void BuildTexturePage(TexturePackPlan const& plan, uint32_t pageIndex, const uint8_t* const* pMemberSurfaces, std::vector<uint8_t>& out_dds)
+{
+    TexturePage const& page = plan.Pages[pageIndex];
+    DDSDesc const& desc = page.Desc;
+
+    out_dds.clear();
+    WriteDDSHeader(desc, out_dds);
+
+    // Slices follow each other whole, so an array is every member's chain back to back
+    if (page.Kind == TexturePageKind::ARRAY)
+    {
+        const size_t chainSize = (size_t)(GetDDSMipOffset(desc, desc.MipCount) - kDDSHeaderSize);
+        for (size_t i = 0; i != page.Members.size(); ++i)
+            out_dds.insert(out_dds.end(), pMemberSurfaces[i], pMemberSurfaces[i] + chainSize);
+        return;
+    }
+
+    // Atlas cells are block aligned at every mip the page keeps, so rows of blocks copy straight across
+    const uint32_t block = GetBlockDimension(desc.Format);
+    const uint32_t elementSize = GetDDSElementSize(desc.Format);
+    std::vector<size_t> sourceOffsets(page.Members.size(), 0);
+
+    for (uint32_t mip = 0; mip != desc.MipCount; ++mip)
+    {
+        const uint32_t pageWidth  = std::max(desc.Width >> mip, 1u);
+        const uint32_t pageHeight = std::max(desc.Height >> mip, 1u);
+        const size_t pageRowBytes = (size_t)((pageWidth + block - 1) / block) * elementSize;
+
+        const size_t base = out_dds.size();
+        out_dds.resize(base + GetDDSSurfaceSize(desc.Format, pageWidth, pageHeight), 0);
+
+        for (size_t i = 0; i != page.Members.size(); ++i)
+        {
+            PackedTexture const& cell = plan.Textures[page.Members[i]];
+            const uint32_t cellWidth  = cell.Width >> mip;
+            const uint32_t cellHeight = cell.Height >> mip;
+            const size_t rowBytes = (size_t)(cellWidth / block) * elementSize;
+
+            uint8_t* pDst = out_dds.data() + base + ((cell.Y >> mip) / block) * pageRowBytes + ((cell.X >> mip) / block) * elementSize;
+            const uint8_t* pSrc = pMemberSurfaces[i] + sourceOffsets[i];
+            for (uint32_t row = 0; row != cellHeight / block; ++row)
+                memcpy(pDst + row * pageRowBytes, pSrc + row * rowBytes, rowBytes);
+
+            sourceOffsets[i] += GetDDSSurfaceSize(desc.Format, cellWidth, cellHeight);
+        }
+    }
+}
+
+void GetPackedUVRect(TexturePackPlan const& plan, uint32_t texture, float out_rect[4])
+{
+    PackedTexture const& packed = plan.Textures[texture];
+    out_rect[0] = 0.0f;
+    out_rect[1] = 0.0f;
+    out_rect[2] = 1.0f;
+    out_rect[3] = 1.0f;
+
+    if (packed.Page == kUnpackedTexture || plan.Pages[packed.Page].Kind != TexturePageKind::ATLAS)
+        return;
+
+    DDSDesc const& page = plan.Pages[packed.Page].Desc;
+    out_rect[0] = (float)packed.X / (float)page.Width;
+    out_rect[1] = (float)packed.Y / (float)page.Height;
+    out_rect[2] = (float)packed.Width / (float)page.Width;
+    out_rect[3] = (float)packed.Height / (float)page.Height;
+}
+
+void TexturePackManifest::AddEntry(TexturePackEntry const& entry)
+{
+    auto it = std::lower_bound(mEntries.begin(), mEntries.end(), entry.Name, [](TexturePackEntry const& e, std::string const& name) { return e.Name < name; });
+    if (it != mEntries.end() && it->Name == entry.Name)
+        *it = entry;
+    else
+        mEntries.insert(it, entry);
+}
+
+void TexturePackManifest::Serialize(std::vector<uint8_t>& out_bytes) const
+{
+    out_bytes.clear();
+
+    ByteWriter w = { out_bytes };
+    w.U32(kTexturePackMagic);
+    w.U16(kTexturePackVersion);
+    w.U16(0);
+    w.U32((uint32_t)mPages.size());
+    w.U32((uint32_t)mEntries.size());
+    w.U64(0); // Checksum, patched below
+
+    for (std::string const& page : mPages)
+        PutString(w, page);
+
+    for (TexturePackEntry const& entry : mEntries)
+    {
+        PutString(w, entry.Name);
+        w.U32(entry.Page);
+        w.U32(entry.Slice);
+        for (float f : entry.UVRect)
+            w.U32(FloatBits(f));
+    }
+
+    const uint64_t checksum = fnv1a64(out_bytes.data() + kManifestHeaderSize, out_bytes.size() - kManifestHeaderSize);
+    for (size_t i = 0; i != sizeof(checksum); ++i)
+        out_bytes[kManifestHeaderSize - sizeof(checksum) + i] = (uint8_t)(checksum >> (i * 8));
+}
+
+bool TexturePackManifest::Save(std::filesystem::path const& path) const
+{
+    std::vector<uint8_t> bytes;
+    Serialize(bytes);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+        return false;
+
+    file.write((const char*)bytes.data(), bytes.size());
+    return file.good();
+}
+
+bool TexturePackManifest::Load(std::filesystem::path const& path)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+        return false;
+
+    std::vector<uint8_t> bytes((size_t)file.tellg());
+    file.seekg(0);
+    if (!file.read((char*)bytes.data(), bytes.size()))
+        return false;
+
+    return Parse(bytes);
+}
+
+bool TexturePackManifest::Parse(std::vector<uint8_t> const& bytes)
+{
+    mPages.clear();
+    mEntries.clear();
+
+    ByteReader r = { bytes.data(), bytes.size(), 0 };
+    if (!r.Has(kManifestHeaderSize) || r.U32() != kTexturePackMagic || r.U16() != kTexturePackVersion)
+        return false;
+
+    r.U16();
+    const uint32_t pageCount  = r.U32();
+    const uint32_t entryCount = r.U32();
+    const uint64_t checksum   = r.U64();
+    if (fnv1a64(bytes.data() + kManifestHeaderSize, bytes.size() - kManifestHeaderSize) != checksum)
+        return false;
+
+    std::vector<std::string> pages(pageCount);
+    for (std::string& page : pages)
+    {
+        if (!GetString(r, page))
+            return false;
+    }
+
+    std::vector<TexturePackEntry> entries(entryCount);
+    for (TexturePackEntry& entry : entries)
+    {
+        if (!GetString(r, entry.Name) || !r.Has(6 * 4))
+            return false;
+
+        entry.Page  = r.U32();
+        entry.Slice = r.U32();
+        for (float& f : entry.UVRect)
+            f = BitsFloat(r.U32());
+
+        if (entry.Page >= pageCount)
+            return false;
+    }
+
+    // Find() relies on the order
+    for (size_t i = 1; i < entries.size(); ++i)
+    {
+        if (!(entries[i - 1].Name < entries[i].Name))
+            return false;
+    }
+
+    mPages   = std::move(pages);
+    mEntries = std::move(entries);
+    return r.Offset == bytes.size();
+}
+
+TexturePackEntry const* TexturePackManifest::Find(std::string const& name) const
+{
+    auto it = std::lower_bound(mEntries.begin(), mEntries.end(), name, [](TexturePackEntry const& e, std::string const& n) { return e.Name < n; });
+    if (it == mEntries.end() || it->Name != name)
+        return nullptr;
+
+    return &*it;
+}
+
+}
@@ -0,0 +1,123 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Packs cooked textures into shared pages so materials stop needing SRVs of their own
+Textures with the same format, size and mip count become slices of one Texture2DArray.
+Power of two leftovers that share a format are atlased instead. Each cell sits at a multiple
+of its own size, so every mip of the page holds every cell's matching mip, block aligned,
+and no texel has to be decoded or re-encoded. Cells have no gutters: bilinear filtering can
+pick up a neighbour's edge texels, which is the usual price of atlasing block compressed data.
+Anything else (odd sizes, formats nothing else uses) is left as its own texture.
+No D3D dependencies, so the cooker plans and builds pages and the runtime reads the manifest.
+----------------------------------------------*/
+#ifndef MUON_TEXTUREPACKER_H
+#define MUON_TEXTUREPACKER_H
+
+#include "DDSFile.h"
+
+#include <filesystem>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace Renderer {
+
+static const uint32_t kUnpackedTexture = UINT32_MAX;
+
+enum class TexturePageKind : uint8_t
+{
+    ARRAY,
+    ATLAS
+};
+
+struct TexturePackerConfig
+{
+    // A group larger than this is split over several arrays
+    uint32_t MaxArraySlices = 64;
+
+    // Atlas pages are at most this on a side, and only textures up to half of it are atlased
+    uint32_t AtlasDimension = 2048;
+
+    // A page keeps only the mips its smallest cell still has whole blocks for, so tiny textures stay out
+    uint32_t MinAtlasCell   = 64;
+
+    bool     Atlases        = true;
+};
+
+struct TexturePage
+{
+    TexturePageKind       Kind;
+    DDSDesc               Desc;       // ArraySize is the slice count for arrays, 1 for atlases
+    std::vector<uint32_t> Members;    // Indices of the textures it holds, in slice order for arrays
+};
+
+// Where one texture ended up. Atlas cells keep the texture's own top mip size.
+struct PackedTexture
+{
+    uint32_t Page;      // kUnpackedTexture when left on its own
+    uint32_t Slice;
+    uint32_t X;         // Top mip texel offset of an atlas cell, 0 for array slices
+    uint32_t Y;
+    uint32_t Width;
+    uint32_t Height;
+};
+
+struct TexturePackPlan
+{
+    std::vector<TexturePage>   Pages;
+    std::vector<PackedTexture> Textures;   // One per source, in source order
+
+    // Separate textures a renderer binds after packing: one per page plus the ones left out
+    uint32_t GetTextureCount() const;
+};
+
+// Deterministic for the same sources in the same order
+void PlanTexturePack(DDSDesc const* pSources, uint32_t count, TexturePackerConfig const& config, TexturePackPlan& out_plan);
+
+// Writes one page as a DDS. pMemberSurfaces[i] points at the first surface of page.Members[i]'s
+// cooked file, i.e. just past its header, with the full mip chain the plan was made from behind it.
+void BuildTexturePage(TexturePackPlan const& plan, uint32_t page, const uint8_t* const* pMemberSurfaces, std::vector<uint8_t>& out_dds);
+
+// UV offset (xy) and scale (zw) taking a packed texture's own UVs into its page
+void GetPackedUVRect(TexturePackPlan const& plan, uint32_t texture, float out_rect[4]);
+
+static const uint32_t kTexturePackMagic   = 0x4B50544D; // "MTPK"
+static const uint16_t kTexturePackVersion = 1;
+
+struct TexturePackEntry
+{
+    std::string Name;       // The cooked file's stem, e.g. "Lunar_T"
+    uint32_t    Page;
+    uint32_t    Slice;
+    float       UVRect[4];
+};
+
+// What the cooker leaves next to the pages so the runtime can find every texture in them.
+// Pages are file names relative to the manifest. Textures left out of every page aren't listed.
+class TexturePackManifest
+{
+public:
+    void AddPage(std::string const& fileName) { mPages.push_back(fileName); }
+    void AddEntry(TexturePackEntry const& entry);
+
+    void Serialize(std::vector<uint8_t>& out_bytes) const;
+    bool Save(std::filesystem::path const& path) const;
+
+    // False when the file is missing, from another version or fails its checksum
+    bool Load(std::filesystem::path const& path);
+    bool Parse(std::vector<uint8_t> const& bytes);
+
+    // nullptr if the texture isn't in any page
+    TexturePackEntry const* Find(std::string const& name) const;
+
+    uint32_t           GetPageCount() const            { return (uint32_t)mPages.size(); }
+    std::string const& GetPage(uint32_t i) const       { return mPages[i]; }
+    uint32_t           GetEntryCount() const           { return (uint32_t)mEntries.size(); }
+
+private:
+    std::vector<std::string>      mPages;
+    std::vector<TexturePackEntry> mEntries;     // Sorted by name
+};
+
+}
+#endif
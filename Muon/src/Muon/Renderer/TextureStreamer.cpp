@@ -0,0 +1,483 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of TextureStreamer.h
+----------------------------------------------*/
+#include "TextureStreamer.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <fstream>
+#include <math.h>
+#include <queue>
+
+namespace Renderer {
+
+namespace {
+
+bool ReadFileRange(const char* path, uint64_t offset, void* pDst, uint32_t byteSize)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+
+    file.seekg((std::streamoff)offset);
+    file.read((char*)pDst, byteSize);
+    return file.good();
+}
+
+uint32_t GetMipDimension(uint32_t dimension, uint32_t mip)
+{
+    return std::max(dimension >> mip, 1u);
+}
+
+}
+
+/////////////////////////////////////////////////////////////////////
+// BackendStreamingDevice
+
+TextureHandle BackendStreamingDevice::CreateTexture(DDSDesc const& desc, uint32_t firstMip, const void* pInitialData)
+{
+    // The backend sizes textures per texel; block formats round up like TextureDesc says
+    const uint32_t elementSize = GetDDSElementSize(desc.Format);
+    const uint32_t bytesPerPixel = IsBlockCompressed(desc.Format) ? std::max(elementSize / 16, 1u) : elementSize;
+
+    TextureDesc textureDesc;
+    textureDesc.Width         = GetMipDimension(desc.Width, firstMip);
+    textureDesc.Height        = GetMipDimension(desc.Height, firstMip);
+    textureDesc.MipLevels     = (uint16_t)(desc.MipCount - firstMip);
+    textureDesc.ArraySize     = 1;
+    textureDesc.BytesPerPixel = bytesPerPixel;
+    return mBackend.CreateTexture(textureDesc, pInitialData);
+}
+
+void BackendStreamingDevice::DestroyTexture(TextureHandle texture)
+{
+    mBackend.DestroyResource(texture);
+}
+
+void BackendStreamingDevice::UploadMip(TextureHandle texture, uint32_t mip, const void* pData, uint32_t byteSize)
+{
+    mBackend.UpdateTexture(texture, mip, pData, byteSize);
+}
+
+void BackendStreamingDevice::CopyMips(TextureHandle dst, uint32_t dstMip, TextureHandle src, uint32_t srcMip, uint32_t mipCount)
+{
+    mBackend.CopyTextureMips(dst, dstMip, src, srcMip, mipCount);
+}
+
+/////////////////////////////////////////////////////////////////////
+// TextureStreamer
+
+TextureStreamer::TextureStreamer() :
+    mpDevice(nullptr),
+    mFrame(0),
+    mPendingBytes(0),
+    mStats(),
+    mIOStop(false)
+{
+}
+
+TextureStreamer::~TextureStreamer()
+{
+    Shutdown();
+}
+
+void TextureStreamer::Init(IStreamingDevice* pDevice, TextureStreamerConfig const& config, ReadFn readFn)
+{
+    assert(pDevice && !mpDevice && "TextureStreamer: already initialized");
+
+    mpDevice = pDevice;
+    mConfig = config;
+    mReadFn = readFn ? std::move(readFn) : ReadFn(ReadFileRange);
+    mFrame = 0;
+    mPendingBytes = 0;
+    mStats = TextureStreamerStats();
+    mStats.BudgetBytes = config.BudgetBytes;
+
+    if (config.AsyncIO)
+    {
+        mIOStop = false;
+        mIOThread = std::thread(&TextureStreamer::IOThreadMain, this);
+    }
+}
+
+void TextureStreamer::Shutdown()
+{
+    if (!mpDevice)
+        return;
+
+    // Anything still queued is dropped; the read in progress finishes first
+    if (mIOThread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mIOMutex);
+            mIOStop = true;
+        }
+        mIOWake.notify_one();
+        mIOThread.join();
+    }
+
+    mIOQueue.clear();
+    mIODone.clear();
+    mFinished.clear();
+
+    for (Texture const& texture : mTextures)
+        mpDevice->DestroyTexture(texture.Handle);
+
+    mTextures.clear();
+    mpDevice = nullptr;
+}
+
+StreamedTextureID TextureStreamer::RegisterFile(const char* path)
+{
+    uint8_t header[kDDSHeaderSize];
+    DDSDesc desc;
+    if (!mReadFn(path, 0, header, kDDSHeaderSize) || !ParseDDSHeader(header, kDDSHeaderSize, desc))
+        return kInvalidStreamedTexture;
+
+    return Register(path, desc);
+}
+
+StreamedTextureID TextureStreamer::Register(const char* path, DDSDesc const& desc)
+{
+    assert(mpDevice && "TextureStreamer: Init() before registering textures");
+
+    if (desc.ArraySize != 1 || desc.MipCount == 0 || desc.MipCount > kMaxStreamedMips || GetDDSElementSize(desc.Format) == 0)
+        return kInvalidStreamedTexture;
+
+    Texture texture = {};
+    texture.Path = path;
+    texture.Desc = desc;
+
+    texture.MipOffsets[0] = kDDSHeaderSize;
+    for (uint32_t mip = 0; mip != desc.MipCount; ++mip)
+        texture.MipOffsets[mip + 1] = texture.MipOffsets[mip] + GetDDSSurfaceSize(desc.Format, GetMipDimension(desc.Width, mip), GetMipDimension(desc.Height, mip));
+
+    // The tail is the finest mip at or under TailDimension that can still be a texture's top mip
+    uint32_t tail = desc.MipCount - 1;
+    for (uint32_t mip = 0; mip != desc.MipCount; ++mip)
+    {
+        if (std::max(GetMipDimension(desc.Width, mip), GetMipDimension(desc.Height, mip)) <= mConfig.TailDimension)
+        {
+            tail = mip;
+            break;
+        }
+    }
+    while (tail != 0 && !IsValidTopMip(texture, tail))
+        --tail;
+
+    std::vector<uint8_t> tailData(GetResidentSize(texture, tail));
+    if (!mReadFn(path, texture.MipOffsets[tail], tailData.data(), (uint32_t)tailData.size()))
+        return kInvalidStreamedTexture;
+
+    texture.Handle      = mpDevice->CreateTexture(desc, tail, tailData.data());
+    texture.ResidentMip = tail;
+    texture.TailMip     = tail;
+    texture.WantedMip   = tail;
+    texture.TargetMip   = tail;
+
+    mStats.ResidentBytes += tailData.size();
+    mTextures.push_back(std::move(texture));
+    return (StreamedTextureID)(mTextures.size() - 1);
+}
+
+bool TextureStreamer::IsValidTopMip(Texture const& texture, uint32_t mip) const
+{
+    // D3D wants the top mip of a block compressed texture to be whole blocks
+    if (mip == 0 || !IsBlockCompressed(texture.Desc.Format))
+        return true;
+
+    const uint32_t width  = texture.Desc.Width >> mip;
+    const uint32_t height = texture.Desc.Height >> mip;
+    return width != 0 && height != 0 && width % 4 == 0 && height % 4 == 0;
+}
+
+void TextureStreamer::RequestScreenSize(StreamedTextureID texture, float screenPixels)
+{
+    assert(texture < mTextures.size());
+    Texture& t = mTextures[texture];
+    t.ScreenPixels = std::max(t.ScreenPixels, screenPixels);
+}
+
+void TextureStreamer::Update()
+{
+    assert(mpDevice);
+    mFrame++;
+
+    ApplyFinishedReads();
+    PlanResidency();
+    IssueReads();
+
+    mStats.TextureCount     = (uint32_t)mTextures.size();
+    mStats.TexturesAtWanted = 0;
+    mStats.TexturesTrimmed  = 0;
+    for (Texture const& texture : mTextures)
+    {
+        mStats.TexturesAtWanted += texture.ResidentMip == texture.WantedMip ? 1 : 0;
+        mStats.TexturesTrimmed  += texture.TargetMip > texture.WantedMip ? 1 : 0;
+    }
+}
+
+void TextureStreamer::ApplyFinishedReads()
+{
+    if (mConfig.AsyncIO)
+    {
+        std::lock_guard<std::mutex> lock(mIOMutex);
+        for (ReadRequest& request : mIODone)
+            mFinished.push_back(std::move(request));
+        mIODone.clear();
+    }
+
+    uint64_t uploaded = 0;
+    size_t applied = 0;
+    for (; applied != mFinished.size(); ++applied)
+    {
+        ReadRequest& request = mFinished[applied];
+        if (applied != 0 && uploaded + request.Data.size() > mConfig.MaxUploadBytesPerFrame)
+            break;
+
+        uploaded += request.Data.size();
+        ApplyRead(request);
+    }
+
+    mFinished.erase(mFinished.begin(), mFinished.begin() + applied);
+}
+
+void TextureStreamer::ApplyRead(ReadRequest& request)
+{
+    Texture& t = mTextures[request.Texture];
+    assert(t.ReadPending && t.ResidentMip == request.EndMip && "TextureStreamer: residency changed under a pending read");
+
+    t.ReadPending = false;
+    mPendingBytes -= request.Data.size();
+    mStats.PendingReads--;
+
+    if (!request.Succeeded)
+    {
+        mStats.FailedReads++;
+        return;
+    }
+
+    // The plan may have moved on while the read was in flight; only take what is still wanted
+    const uint32_t top = std::max(request.FirstMip, t.TargetMip);
+    if (top >= request.EndMip)
+    {
+        mStats.CancelledReads++;
+        return;
+    }
+
+    const uint32_t mipCount = t.Desc.MipCount;
+    TextureHandle handle = mpDevice->CreateTexture(t.Desc, top, nullptr);
+    for (uint32_t mip = top; mip != request.EndMip; ++mip)
+    {
+        const uint64_t offset = t.MipOffsets[mip] - t.MipOffsets[request.FirstMip];
+        mpDevice->UploadMip(handle, mip - top, request.Data.data() + offset, (uint32_t)(t.MipOffsets[mip + 1] - t.MipOffsets[mip]));
+    }
+    mpDevice->CopyMips(handle, request.EndMip - top, t.Handle, 0, mipCount - request.EndMip);
+    mpDevice->DestroyTexture(t.Handle);
+
+    mStats.ResidentBytes += t.MipOffsets[request.EndMip] - t.MipOffsets[top];
+    mStats.ReadCount++;
+    mStats.ReadBytes += request.Data.size();
+    mStats.ReadLatencyFrames += mFrame - request.IssueFrame;
+
+    t.Handle = handle;
+    t.ResidentMip = top;
+}
+
+void TextureStreamer::PlanResidency()
+{
+    // Only what was asked for this frame counts towards keeping mips under pressure
+    std::vector<float> pixels(mTextures.size());
+    uint64_t total = 0;
+
+    for (size_t i = 0; i != mTextures.size(); ++i)
+    {
+        Texture& t = mTextures[i];
+        if (t.ScreenPixels > 0.0f)
+        {
+            uint32_t mip = std::min(ComputeMipForScreenSize(t.Desc.Width, t.Desc.Height, t.ScreenPixels, mConfig.MipBias), t.TailMip);
+            while (mip != 0 && !IsValidTopMip(t, mip))
+                --mip;
+
+            t.WantedMip = mip;
+            t.LastScreenPixels = t.ScreenPixels;
+            t.LastRequestFrame = mFrame;
+        }
+        else if (mFrame - t.LastRequestFrame > mConfig.EvictDelayFrames)
+        {
+            t.WantedMip = t.TailMip;
+            t.LastScreenPixels = 0.0f;
+        }
+
+        pixels[i] = t.ScreenPixels;
+        t.ScreenPixels = 0.0f;
+        t.TargetMip = t.WantedMip;
+        total += GetResidentSize(t, t.TargetMip);
+    }
+    mStats.WantedBytes = total;
+
+    // Over budget, the texture with the most texels per screen pixel gives up a mip until everything fits.
+    // Unseen textures come first, largest first.
+    auto oversampling = [this, &pixels](size_t i)
+    {
+        Texture const& t = mTextures[i];
+        const float dimension = (float)std::max(GetMipDimension(t.Desc.Width, t.TargetMip), GetMipDimension(t.Desc.Height, t.TargetMip));
+        return pixels[i] > 0.0f ? dimension / pixels[i] : 1e6f + dimension;
+    };
+
+    typedef std::pair<float, size_t> Candidate;
+    std::priority_queue<Candidate> candidates;
+    if (total > mConfig.BudgetBytes)
+    {
+        for (size_t i = 0; i != mTextures.size(); ++i)
+        {
+            if (mTextures[i].TargetMip < mTextures[i].TailMip)
+                candidates.push({ oversampling(i), i });
+        }
+    }
+
+    while (total > mConfig.BudgetBytes && !candidates.empty())
+    {
+        const size_t i = candidates.top().second;
+        candidates.pop();
+
+        Texture& t = mTextures[i];
+        uint32_t mip = t.TargetMip + 1;
+        while (mip < t.TailMip && !IsValidTopMip(t, mip))
+            ++mip;
+
+        total -= GetResidentSize(t, t.TargetMip) - GetResidentSize(t, mip);
+        t.TargetMip = mip;
+
+        if (mip < t.TailMip)
+            candidates.push({ oversampling(i), i });
+    }
+
+    // Free memory before asking for more. Textures with a read in flight shrink once it lands.
+    for (Texture& t : mTextures)
+    {
+        if (t.ResidentMip < t.TargetMip && !t.ReadPending)
+            Shrink(t, t.TargetMip);
+    }
+}
+
+void TextureStreamer::Shrink(Texture& texture, uint32_t topMip)
+{
+    const uint32_t mipCount = texture.Desc.MipCount;
+    TextureHandle handle = mpDevice->CreateTexture(texture.Desc, topMip, nullptr);
+    mpDevice->CopyMips(handle, 0, texture.Handle, topMip - texture.ResidentMip, mipCount - topMip);
+    mpDevice->DestroyTexture(texture.Handle);
+
+    const uint64_t freed = texture.MipOffsets[topMip] - texture.MipOffsets[texture.ResidentMip];
+    mStats.ResidentBytes -= freed;
+    mStats.EvictedBytes += freed;
+    mStats.EvictionCount++;
+
+    texture.Handle = handle;
+    texture.ResidentMip = topMip;
+}
+
+void TextureStreamer::IssueReads()
+{
+    std::vector<StreamedTextureID> wanting;
+    for (StreamedTextureID i = 0; i != (StreamedTextureID)mTextures.size(); ++i)
+    {
+        Texture const& t = mTextures[i];
+        if (t.ResidentMip > t.TargetMip && !t.ReadPending)
+            wanting.push_back(i);
+    }
+
+    // Whatever is blurriest on screen right now goes first
+    auto undersampling = [this](StreamedTextureID i)
+    {
+        Texture const& t = mTextures[i];
+        const float dimension = (float)std::max(GetMipDimension(t.Desc.Width, t.ResidentMip), GetMipDimension(t.Desc.Height, t.ResidentMip));
+        return t.LastScreenPixels / dimension;
+    };
+    std::stable_sort(wanting.begin(), wanting.end(), [&undersampling](StreamedTextureID a, StreamedTextureID b)
+    {
+        return undersampling(a) > undersampling(b);
+    });
+
+    for (StreamedTextureID i : wanting)
+    {
+        if (mStats.PendingReads >= mConfig.MaxPendingReads)
+            break;
+
+        Texture& t = mTextures[i];
+
+        // Targets fit the budget, but a texture still waiting on a cancelled read may not have shrunk yet
+        const uint64_t bytes = t.MipOffsets[t.ResidentMip] - t.MipOffsets[t.TargetMip];
+        if (mStats.ResidentBytes + mPendingBytes + bytes > mConfig.BudgetBytes)
+            continue;
+
+        // Mips are stored largest first, so everything missing is one contiguous read
+        ReadRequest request;
+        request.Texture    = i;
+        request.FirstMip   = t.TargetMip;
+        request.EndMip     = t.ResidentMip;
+        request.IssueFrame = mFrame;
+        request.Path       = t.Path;
+        request.Offset     = t.MipOffsets[t.TargetMip];
+        request.Data.resize(bytes);
+        request.Succeeded  = false;
+
+        t.ReadPending = true;
+        mPendingBytes += bytes;
+        mStats.PendingReads++;
+
+        if (mConfig.AsyncIO)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mIOMutex);
+                mIOQueue.push_back(std::move(request));
+            }
+            mIOWake.notify_one();
+        }
+        else
+        {
+            Read(request);
+            mFinished.push_back(std::move(request));
+        }
+    }
+}
+
+void TextureStreamer::Read(ReadRequest& request)
+{
+    request.Succeeded = mReadFn(request.Path.c_str(), request.Offset, request.Data.data(), (uint32_t)request.Data.size());
+}
+
+void TextureStreamer::IOThreadMain()
+{
+    for (;;)
+    {
+        ReadRequest request;
+        {
+            std::unique_lock<std::mutex> lock(mIOMutex);
+            mIOWake.wait(lock, [this] { return mIOStop || !mIOQueue.empty(); });
+            if (mIOStop)
+                return;
+
+            request = std::move(mIOQueue.front());
+            mIOQueue.pop_front();
+        }
+
+        Read(request);
+
+        std::lock_guard<std::mutex> lock(mIOMutex);
+        mIODone.push_back(std::move(request));
+    }
+}
+
+uint32_t TextureStreamer::ComputeMipForScreenSize(uint32_t width, uint32_t height, float screenPixels, float bias)
+{
+    if (screenPixels <= 0.0f)
+        return kMaxStreamedMips;
+
+    const float mip = log2f((float)std::max(width, height) / screenPixels) + bias;
+    return mip <= 0.0f ? 0 : (uint32_t)mip;
+}
+
+}
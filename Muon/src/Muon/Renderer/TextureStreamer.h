@@ -0,0 +1,212 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Streams texture mips in and out under a memory budget
+Textures register from cooked DDS files and start with only their mip tail resident.
+Each frame the caller reports how large the things using a texture are on screen. Update()
+turns that into a wanted mip per texture, trims the wanted set to fit the budget, shrinks
+textures that are over their share right away and queues reads for the ones under it.
+Reads run on an IO thread and are swapped in on a later Update(), so a texture is always
+drawable at whatever it has resident. Knows nothing about D3D; an IStreamingDevice does the GPU side.
+----------------------------------------------*/
+#ifndef MUON_TEXTURESTREAMER_H
+#define MUON_TEXTURESTREAMER_H
+
+#include "DDSFile.h"
+#include "RenderBackend.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Renderer {
+
+typedef uint32_t StreamedTextureID;
+static const StreamedTextureID kInvalidStreamedTexture = UINT32_MAX;
+
+// 32768 on a side, more than any GPU we target can sample
+static const uint32_t kMaxStreamedMips = 16;
+
+// GPU side of the streamer. Textures are replaced rather than resized, so every change in
+// residency is a create, a GPU copy of the mips both sides share and a destroy.
+class IStreamingDevice
+{
+public:
+    virtual ~IStreamingDevice() {}
+
+    // Allocates mips [firstMip, desc.MipCount) of desc. pInitialData holds all of them back to back
+    // as they sit in the file, or is null to leave them undefined.
+    virtual TextureHandle CreateTexture(DDSDesc const& desc, uint32_t firstMip, const void* pInitialData) = 0;
+    virtual void          DestroyTexture(TextureHandle texture) = 0;
+
+    // Mip indices here are relative to each texture's own top mip
+    virtual void UploadMip(TextureHandle texture, uint32_t mip, const void* pData, uint32_t byteSize) = 0;
+    virtual void CopyMips(TextureHandle dst, uint32_t dstMip, TextureHandle src, uint32_t srcMip, uint32_t mipCount) = 0;
+};
+
+// Streams through an IRenderBackend, which is how the null backend measures it
+class BackendStreamingDevice final : public IStreamingDevice
+{
+public:
+    explicit BackendStreamingDevice(IRenderBackend& backend) : mBackend(backend) {}
+
+    TextureHandle CreateTexture(DDSDesc const& desc, uint32_t firstMip, const void* pInitialData) override;
+    void          DestroyTexture(TextureHandle texture) override;
+    void          UploadMip(TextureHandle texture, uint32_t mip, const void* pData, uint32_t byteSize) override;
+    void          CopyMips(TextureHandle dst, uint32_t dstMip, TextureHandle src, uint32_t srcMip, uint32_t mipCount) override;
+
+private:
+    IRenderBackend& mBackend;
+};
+
+struct TextureStreamerConfig
+{
+    uint64_t BudgetBytes            = 128ull << 20;
+
+    // Mips this size and smaller load at registration and never leave
+    uint32_t TailDimension          = 64;
+
+    uint32_t MaxPendingReads        = 8;
+
+    // Finished reads past this wait for the next Update. One always goes through, however large.
+    uint64_t MaxUploadBytesPerFrame = 8ull << 20;
+
+    // A texture nobody asked for keeps its mips this long, so turning the camera around doesn't thrash
+    uint32_t EvictDelayFrames       = 60;
+
+    // Positive asks for coarser mips than the screen size calls for
+    float    MipBias                = 0.0f;
+
+    // Off reads inline in Update, which makes every run with the same requests identical
+    bool     AsyncIO                = true;
+};
+
+struct TextureStreamerStats
+{
+    uint32_t TextureCount;
+    uint32_t TexturesAtWanted;      // Resident at exactly the mip the screen asks for
+    uint32_t TexturesTrimmed;       // Held coarser than wanted to stay in budget
+    uint32_t PendingReads;
+    uint64_t ResidentBytes;
+    uint64_t WantedBytes;           // What every texture would take at its wanted mip, budget ignored
+    uint64_t BudgetBytes;
+
+    // Since Init
+    uint64_t ReadCount;
+    uint64_t ReadBytes;
+    uint64_t ReadLatencyFrames;     // Summed over ReadCount, from issue to resident
+    uint64_t CancelledReads;        // Landed after their texture stopped wanting them
+    uint64_t FailedReads;
+    uint64_t EvictionCount;
+    uint64_t EvictedBytes;
+};
+
+class TextureStreamer
+{
+public:
+    // Fills pDst with byteSize bytes of the file at offset. Called on the IO thread.
+    typedef std::function<bool(const char* path, uint64_t offset, void* pDst, uint32_t byteSize)> ReadFn;
+
+    TextureStreamer();
+    ~TextureStreamer();
+
+    // A null readFn reads from disk. The device must outlive the streamer.
+    void Init(IStreamingDevice* pDevice, TextureStreamerConfig const& config, ReadFn readFn = nullptr);
+
+    // Waits for reads in flight and destroys every texture
+    void Shutdown();
+
+    // Read the header (if not given) and the mip tail right away. Returns kInvalidStreamedTexture
+    // for anything that can't stream: cube maps, arrays, unreadable files.
+    StreamedTextureID RegisterFile(const char* path);
+    StreamedTextureID Register(const char* path, DDSDesc const& desc);
+
+    // Asks for enough resolution to cover screenPixels, the on-screen extent of something drawn
+    // with the texture. The largest request since the last Update wins. Main thread only.
+    void RequestScreenSize(StreamedTextureID texture, float screenPixels);
+
+    // Swaps in finished reads, replans residency and issues new reads. Must run where the device may record.
+    void Update();
+
+    // Changes whenever residency does, so fetch it after Update every frame
+    TextureHandle  GetHandle(StreamedTextureID texture) const      { return mTextures[texture].Handle;      }
+    uint32_t       GetResidentMip(StreamedTextureID texture) const { return mTextures[texture].ResidentMip; }
+    uint32_t       GetWantedMip(StreamedTextureID texture) const   { return mTextures[texture].WantedMip;   }
+    DDSDesc const& GetDesc(StreamedTextureID texture) const        { return mTextures[texture].Desc;        }
+    uint32_t       GetTextureCount() const                         { return (uint32_t)mTextures.size();     }
+
+    TextureStreamerStats const& GetStats() const { return mStats; }
+
+    // Finest mip whose larger side still covers screenPixels, before clamping to the texture
+    static uint32_t ComputeMipForScreenSize(uint32_t width, uint32_t height, float screenPixels, float bias);
+
+private:
+    struct Texture
+    {
+        std::string   Path;
+        DDSDesc       Desc;
+        uint64_t      MipOffsets[kMaxStreamedMips + 1];  // From the start of the file, the last one is the end of the chain
+        TextureHandle Handle;
+        uint32_t      ResidentMip;
+        uint32_t      TailMip;
+        uint32_t      WantedMip;
+        uint32_t      TargetMip;    // WantedMip after the budget had its say
+        float         ScreenPixels; // Largest request since the last Update
+        float         LastScreenPixels;
+        uint32_t      LastRequestFrame;
+        bool          ReadPending;
+    };
+
+    struct ReadRequest
+    {
+        StreamedTextureID    Texture;
+        uint32_t             FirstMip;
+        uint32_t             EndMip;     // The resident mip when the read was issued
+        uint32_t             IssueFrame;
+        std::string          Path;
+        uint64_t             Offset;
+        std::vector<uint8_t> Data;
+        bool                 Succeeded;
+    };
+
+    uint64_t GetResidentSize(Texture const& texture, uint32_t topMip) const { return texture.MipOffsets[texture.Desc.MipCount] - texture.MipOffsets[topMip]; }
+    bool     IsValidTopMip(Texture const& texture, uint32_t mip) const;
+
+    void ApplyFinishedReads();
+    void ApplyRead(ReadRequest& request);
+    void PlanResidency();
+    void Shrink(Texture& texture, uint32_t topMip);
+    void IssueReads();
+    void Read(ReadRequest& request);
+    void IOThreadMain();
+
+    IStreamingDevice*         mpDevice;
+    TextureStreamerConfig     mConfig;
+    ReadFn                    mReadFn;
+
+    std::vector<Texture>      mTextures;
+    std::vector<ReadRequest>  mFinished;    // Taken from the IO thread, waiting on the upload allowance
+    uint32_t                  mFrame;
+    uint64_t                  mPendingBytes;
+    TextureStreamerStats      mStats;
+
+    // Shared with the IO thread
+    std::thread               mIOThread;
+    std::mutex                mIOMutex;
+    std::condition_variable   mIOWake;
+    std::deque<ReadRequest>   mIOQueue;
+    std::vector<ReadRequest>  mIODone;
+    bool                      mIOStop;
+
+public:
+    TextureStreamer(TextureStreamer const&)            = delete;
+    TextureStreamer& operator=(TextureStreamer const&) = delete;
+};
+
+}
+#endif
@@ -6,6 +6,7 @@ Description : Material class for shader information
 #ifndef EASEL_HASH_UTIL_H
 #define EASEL_HASH_UTIL_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 // Helper function for hashing c strings
@@ -27,4 +28,14 @@ inline uint32_t fnv1a(const wchar_t* text, uint32_t hash = 0x811C9DC5, uint32_t
     return hash;
 }
 
+// 64-bit variant over raw bytes, for keys built from whole structs or blobs
+inline uint64_t fnv1a64(const void* data, size_t size, uint64_t hash = 0xCBF29CE484222325ull, uint64_t prime = 0x00000100000001B3ull)
+{
+    const unsigned char* ptr = (const unsigned char*)data;
+    for (size_t i = 0; i != size; ++i)
+        hash = (ptr[i] ^ hash) * prime;
+
+    return hash;
+}
+
 #endif
\ No newline at end of file
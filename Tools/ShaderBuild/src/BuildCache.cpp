@@ -0,0 +1,130 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of BuildCache.h
+----------------------------------------------*/
+#include "BuildCache.h"
+
+#include "IncludeScanner.h"
+
+#include <Muon/Renderer/hash_util.h>
+
+#include <fstream>
+#include <inttypes.h>
+#include <stdio.h>
+
+namespace fs = std::filesystem;
+
+namespace ShaderBuild {
+
+namespace {
+
+const char* kManifestName = "manifest.txt";
+const char* kObjectDir    = "objects";
+
+}
+
+bool ComputeBuildKey(std::string const& commandSignature, std::vector<fs::path> const& dependencies, uint64_t* out_key)
+{
+    uint64_t key = fnv1a64(commandSignature.data(), commandSignature.size());
+
+    // Names are hashed along with contents so moving a header between include dirs still invalidates
+    for (fs::path const& dependency : dependencies)
+    {
+        std::string text;
+        if (!ReadTextFile(dependency, text))
+            return false;
+
+        const std::string name = dependency.filename().generic_string();
+        key = fnv1a64(name.data(), name.size(), key);
+        key = fnv1a64(text.data(), text.size(), key);
+    }
+
+    // 0 means "never built" in the manifest
+    *out_key = key ? key : 1;
+    return true;
+}
+
+BuildCache::BuildCache(fs::path const& cacheDir) :
+    mCacheDir(cacheDir),
+    mManifestLoaded(false)
+{
+    std::error_code ec;
+    fs::create_directories(mCacheDir / kObjectDir, ec);
+}
+
+void BuildCache::Clear()
+{
+    std::error_code ec;
+    fs::remove_all(mCacheDir / kObjectDir, ec);
+    fs::remove(mCacheDir / kManifestName, ec);
+    fs::create_directories(mCacheDir / kObjectDir, ec);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mManifest.clear();
+    mManifestLoaded = false;
+}
+
+bool BuildCache::LoadManifest()
+{
+    std::ifstream file(mCacheDir / kManifestName);
+    if (!file)
+        return false;
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mManifest.clear();
+
+    // One "<name> <key>" pair per line
+    std::string name;
+    std::string keyText;
+    while (file >> name >> keyText)
+        mManifest[name] = strtoull(keyText.c_str(), nullptr, 16);
+
+    mManifestLoaded = true;
+    return true;
+}
+
+bool BuildCache::SaveManifest() const
+{
+    std::ofstream file(mCacheDir / kManifestName, std::ios::trunc);
+    if (!file)
+        return false;
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (auto const& entry : mManifest)
+    {
+        char keyText[17];
+        snprintf(keyText, sizeof(keyText), "%016" PRIx64, entry.second);
+        file << entry.first << ' ' << keyText << '\n';
+    }
+
+    return (bool)file;
+}
+
+uint64_t BuildCache::GetManifestKey(std::string const& name) const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mManifest.find(name);
+    return it != mManifest.end() ? it->second : 0;
+}
+
+void BuildCache::SetManifestKey(std::string const& name, uint64_t key)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mManifest[name] = key;
+}
+
+fs::path BuildCache::GetObjectPath(uint64_t key, const char* extension) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016" PRIx64 "%s", key, extension);
+    return mCacheDir / kObjectDir / name;
+}
+
+bool BuildCache::HasObject(uint64_t key, const char* extension) const
+{
+    std::error_code ec;
+    return fs::exists(GetObjectPath(key, extension), ec);
+}
+
+}
@@ -0,0 +1,58 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Content-addressed store for compiled shaders
+A shader's key hashes the compiler command and the contents of every file it
+depends on. Outputs are stored under that key, so reverting a change or switching
+branches picks the old bytecode back up instead of compiling it again. The manifest
+remembers which key each output was last built from, for the up-to-date check.
+----------------------------------------------*/
+#ifndef SHADERBUILD_BUILDCACHE_H
+#define SHADERBUILD_BUILDCACHE_H
+
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ShaderBuild {
+
+// Returns false if any dependency can't be read
+bool ComputeBuildKey(std::string const& commandSignature, std::vector<std::filesystem::path> const& dependencies, uint64_t* out_key);
+
+class BuildCache
+{
+public:
+    explicit BuildCache(std::filesystem::path const& cacheDir);
+
+    // Drops every stored object and the manifest
+    void Clear();
+
+    bool LoadManifest();
+    bool SaveManifest() const;
+
+    // Key the named output was last built from, or 0 if it was never built
+    uint64_t GetManifestKey(std::string const& name) const;
+    void     SetManifestKey(std::string const& name, uint64_t key);
+
+    // Where the object for key with the given extension (".cso", ".refl") lives in the store
+    std::filesystem::path GetObjectPath(uint64_t key, const char* extension) const;
+    bool                  HasObject(uint64_t key, const char* extension) const;
+
+    bool HasManifest() const { return mManifestLoaded; }
+
+private:
+    std::filesystem::path           mCacheDir;
+    std::map<std::string, uint64_t> mManifest;     // Ordered so the file diffs cleanly
+    mutable std::mutex              mMutex;
+    bool                            mManifestLoaded;
+
+public:
+    BuildCache(BuildCache const&)            = delete;
+    BuildCache& operator=(BuildCache const&) = delete;
+};
+
+}
+#endif
@@ -0,0 +1,421 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of CBufferLayout.h
+----------------------------------------------*/
+#include "CBufferLayout.h"
+
+#include "IncludeScanner.h"
+
+#include <algorithm>
+#include <fstream>
+#include <regex>
+#include <stdlib.h>
+
+namespace ShaderBuild {
+
+namespace {
+
+const uint32_t kRegisterSize = 16;
+
+uint32_t AlignToRegister(uint32_t offset)
+{
+    return (offset + kRegisterSize - 1) & ~(kRegisterSize - 1);
+}
+
+struct Declaration
+{
+    std::string Type;
+    std::string Name;
+    uint32_t    ArrayCount;     // 0 when not an array
+    bool        RowMajor;
+};
+
+bool ParseDeclarations(std::string const& body, std::string const& owner, std::vector<Declaration>& out_decls, std::string& out_error)
+{
+    static const std::regex kDecl(R"(^\s*((?:(?:row_major|column_major|uniform|static|const|precise)\s+)*)(\w+)\s+(\w+)\s*(?:\[\s*(\d+)\s*\])?\s*(?::\s*(\w+)\s*(?:\([^)]*\))?)?\s*$)");
+
+    out_decls.clear();
+    size_t start = 0;
+    while (start < body.size())
+    {
+        size_t end = body.find(';', start);
+        if (end == std::string::npos)
+            end = body.size();
+
+        const std::string text = body.substr(start, end - start);
+        start = end + 1;
+
+        if (text.find_first_not_of(" \t\r\n") == std::string::npos)
+            continue;
+
+        std::smatch m;
+        if (!std::regex_match(text, m, kDecl))
+        {
+            out_error = owner + ": can't parse member '" + text.substr(text.find_first_not_of(" \t\r\n")) + "'";
+            return false;
+        }
+
+        if (m[5].matched && m[5].str() == "packoffset")
+        {
+            out_error = owner + ": packoffset on '" + m[3].str() + "' isn't supported, let the compiler pack it";
+            return false;
+        }
+
+        Declaration decl;
+        decl.Type       = m[2].str();
+        decl.Name       = m[3].str();
+        decl.ArrayCount = m[4].matched ? (uint32_t)atoi(m[4].str().c_str()) : 0;
+        decl.RowMajor   = m[1].str().find("row_major") != std::string::npos;
+        out_decls.push_back(decl);
+    }
+
+    return true;
+}
+
+// Scalars, vectors and matrices. Everything in a cbuffer is 32 bits per component.
+bool ParseNumericType(std::string const& type, std::string& out_cppType, uint32_t* out_rows, uint32_t* out_columns)
+{
+    static const std::regex kNumeric(R"(^(float|half|int|uint|dword|bool)([1-4])?(?:x([1-4]))?$)");
+
+    if (type == "matrix")
+        return ParseNumericType("float4x4", out_cppType, out_rows, out_columns);
+    if (type == "vector")
+        return ParseNumericType("float4", out_cppType, out_rows, out_columns);
+
+    std::smatch m;
+    if (!std::regex_match(type, m, kNumeric))
+        return false;
+
+    const std::string base = m[1].str();
+    out_cppType = (base == "float" || base == "half") ? "float" : (base == "int" ? "int32_t" : "uint32_t");
+
+    // floatN is one row of N; floatRxC is R rows of C
+    *out_rows    = m[3].matched ? (uint32_t)atoi(m[2].str().c_str()) : 1;
+    *out_columns = m[3].matched ? (uint32_t)atoi(m[3].str().c_str()) : (m[2].matched ? (uint32_t)atoi(m[2].str().c_str()) : 1);
+    return true;
+}
+
+class LayoutBuilder
+{
+public:
+    LayoutBuilder(std::string const& source, CBufferLayoutSet& layouts) : mSource(source), mLayouts(layouts) {}
+
+    // Lays out the members in order, returning where the last one ends
+    bool Layout(std::vector<Declaration> const& decls, std::string const& owner, std::vector<CBufferField>& out_fields, uint32_t* out_end, std::string& out_error)
+    {
+        uint32_t cursor = 0;
+        out_fields.clear();
+
+        for (Declaration const& decl : decls)
+        {
+            CBufferField field = {};
+            field.Name = decl.Name;
+
+            std::string cppType;
+            uint32_t rows = 0;
+            uint32_t columns = 0;
+            uint32_t elementSize = 0;
+            bool newRegister = decl.ArrayCount != 0;
+            bool isStruct = false;
+
+            if (ParseNumericType(decl.Type, cppType, &rows, &columns))
+            {
+                field.CppType = cppType;
+                if (rows == 1)
+                {
+                    elementSize = columns * 4;
+                    field.Extents[0] = columns > 1 ? columns : 0;
+                }
+                else
+                {
+                    // One register per column unless row_major, so the other dimension is the register's width
+                    const uint32_t registers = decl.RowMajor ? rows : columns;
+                    const uint32_t width     = decl.RowMajor ? columns : rows;
+                    if (width != 4)
+                    {
+                        out_error = owner + ": " + decl.Type + " " + decl.Name + " leaves a gap in every register; use a 4-wide matrix or split it into vectors";
+                        return false;
+                    }
+
+                    elementSize = registers * kRegisterSize;
+                    field.Extents[0] = registers;
+                    field.Extents[1] = width;
+                    newRegister = true;
+                }
+            }
+            else
+            {
+                const CBufferStruct* pStruct = nullptr;
+                if (!RequireStruct(decl.Type, &pStruct, out_error))
+                    return false;
+
+                field.CppType = pStruct->Name;
+                elementSize   = pStruct->Size;
+                newRegister   = true;
+                isStruct      = true;
+            }
+
+            if (decl.ArrayCount)
+            {
+                // Elements sit 16 bytes apart, which only C++ arrays of register-sized elements can express
+                if (elementSize % kRegisterSize)
+                {
+                    out_error = owner + ": array " + decl.Name + " pads every element to 16 bytes; use 16-byte elements (e.g. float4) instead";
+                    return false;
+                }
+
+                if (field.Extents[1])
+                {
+                    out_error = owner + ": arrays of matrices aren't supported (" + decl.Name + ")";
+                    return false;
+                }
+
+                // float4 a[N] becomes float a[N][4]
+                field.Extents[1] = field.Extents[0];
+                field.Extents[0] = decl.ArrayCount;
+            }
+
+            const uint32_t size = decl.ArrayCount ? elementSize * decl.ArrayCount : elementSize;
+
+            if (newRegister || (cursor % kRegisterSize) + size > kRegisterSize)
+                cursor = AlignToRegister(cursor);
+
+            field.Offset = cursor;
+            field.Size   = size;
+            cursor += size;
+
+            if (isStruct)
+                cursor = AlignToRegister(cursor);
+
+            out_fields.push_back(field);
+        }
+
+        *out_end = cursor;
+        return true;
+    }
+
+private:
+    bool RequireStruct(std::string const& name, const CBufferStruct** out_struct, std::string& out_error)
+    {
+        for (CBufferStruct const& existing : mLayouts.Structs)
+        {
+            if (existing.Name == name)
+            {
+                *out_struct = &existing;
+                return true;
+            }
+        }
+
+        if (std::find(mInProgress.begin(), mInProgress.end(), name) != mInProgress.end())
+        {
+            out_error = "struct " + name + " contains itself";
+            return false;
+        }
+
+        const std::regex structRegex(R"(\bstruct\s+)" + name + R"(\s*\{([^}]*)\})");
+        std::smatch body;
+        if (!std::regex_search(mSource, body, structRegex))
+        {
+            out_error = "unknown type '" + name + "' in a cbuffer";
+            return false;
+        }
+
+        std::vector<Declaration> decls;
+        if (!ParseDeclarations(body[1].str(), "struct " + name, decls, out_error))
+            return false;
+
+        mInProgress.push_back(name);
+        CBufferStruct desc;
+        desc.Name = name;
+        const bool ok = Layout(decls, "struct " + name, desc.Fields, &desc.Size, out_error);
+        mInProgress.pop_back();
+        if (!ok)
+            return false;
+
+        // Members first, so the header can be written in order
+        mLayouts.Structs.push_back(desc);
+        *out_struct = &mLayouts.Structs.back();
+        return true;
+    }
+
+    std::string const&       mSource;
+    CBufferLayoutSet&        mLayouts;
+    std::vector<std::string> mInProgress;
+};
+
+// Canonical text of a layout, for comparing declarations from different shaders
+std::string Describe(std::vector<CBufferField> const& fields, uint32_t size)
+{
+    std::string text = std::to_string(size);
+    for (CBufferField const& f : fields)
+        text += "|" + f.CppType + " " + f.Name + "@" + std::to_string(f.Offset) + ":" + std::to_string(f.Extents[0]) + "x" + std::to_string(f.Extents[1]);
+    return text;
+}
+
+void WriteFields(std::string& out, std::vector<CBufferField> const& fields, uint32_t size)
+{
+    size_t typeWidth = 8;
+    for (CBufferField const& f : fields)
+        typeWidth = std::max(typeWidth, f.CppType.size());
+
+    uint32_t cursor = 0;
+    uint32_t padIndex = 0;
+    auto pad = [&](uint32_t to)
+    {
+        if (to == cursor)
+            return;
+
+        std::string type = "uint32_t";
+        type.resize(typeWidth, ' ');
+        out += "    " + type + " _pad" + std::to_string(padIndex++);
+        if (to - cursor != 4)
+            out += "[" + std::to_string((to - cursor) / 4) + "]";
+        out += ";\n";
+        cursor = to;
+    };
+
+    for (CBufferField const& f : fields)
+    {
+        pad(f.Offset);
+
+        std::string type = f.CppType;
+        type.resize(typeWidth, ' ');
+        out += "    " + type + " " + f.Name;
+        for (uint32_t extent : f.Extents)
+        {
+            if (extent)
+                out += "[" + std::to_string(extent) + "]";
+        }
+        out += ";\n";
+        cursor = f.Offset + f.Size;
+    }
+
+    pad(size);
+}
+
+void WriteAsserts(std::string& out, std::string const& type, std::vector<CBufferField> const& fields, uint32_t size)
+{
+    out += "static_assert(sizeof(" + type + ") == " + std::to_string(size) + ", \"" + type + " size doesn't match HLSL packing\");\n";
+    for (CBufferField const& f : fields)
+        out += "static_assert(offsetof(" + type + ", " + f.Name + ") == " + std::to_string(f.Offset) + ", \"" + type + "::" + f.Name + " is misaligned\");\n";
+}
+
+}
+
+bool ReflectCBufferLayouts(std::string const& source, CBufferLayoutSet& out_layouts, std::string& out_error)
+{
+    static const std::regex kCBuffer(R"(\bcbuffer\s+(\w+)\s*(?::\s*register\s*\(\s*b(\d+)\s*\))?\s*\{([^}]*)\})");
+
+    out_layouts = CBufferLayoutSet();
+    LayoutBuilder builder(source, out_layouts);
+
+    for (std::sregex_iterator it(source.begin(), source.end(), kCBuffer), end; it != end; ++it)
+    {
+        std::smatch const& m = *it;
+        const std::string owner = "cbuffer " + m[1].str();
+        if (!m[2].matched)
+        {
+            out_error = owner + " has no explicit register(bN); the C++ side needs to know where it binds";
+            return false;
+        }
+
+        std::vector<Declaration> decls;
+        if (!ParseDeclarations(m[3].str(), owner, decls, out_error))
+            return false;
+
+        CBufferDesc desc;
+        desc.Name     = m[1].str();
+        desc.Register = (uint32_t)atoi(m[2].str().c_str());
+        if (!builder.Layout(decls, owner, desc.Fields, &desc.Size, out_error))
+            return false;
+
+        desc.Size = AlignToRegister(desc.Size);
+        out_layouts.CBuffers.push_back(desc);
+    }
+
+    return true;
+}
+
+bool MergeCBufferLayouts(CBufferLayoutSet const& layouts, std::string const& origin, CBufferLayoutSet& inout_merged, std::string& out_error)
+{
+    for (CBufferStruct const& s : layouts.Structs)
+    {
+        auto it = std::find_if(inout_merged.Structs.begin(), inout_merged.Structs.end(), [&](CBufferStruct const& e) { return e.Name == s.Name; });
+        if (it == inout_merged.Structs.end())
+            inout_merged.Structs.push_back(s);
+        else if (Describe(it->Fields, it->Size) != Describe(s.Fields, s.Size))
+        {
+            out_error = origin + ": struct " + s.Name + " is laid out differently than in another shader";
+            return false;
+        }
+    }
+
+    for (CBufferDesc const& c : layouts.CBuffers)
+    {
+        auto it = std::find_if(inout_merged.CBuffers.begin(), inout_merged.CBuffers.end(), [&](CBufferDesc const& e) { return e.Name == c.Name; });
+        if (it == inout_merged.CBuffers.end())
+            inout_merged.CBuffers.push_back(c);
+        else if (it->Register != c.Register || Describe(it->Fields, it->Size) != Describe(c.Fields, c.Size))
+        {
+            out_error = origin + ": cbuffer " + c.Name + " is declared differently than in another shader";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool WriteCBufferHeader(std::filesystem::path const& path, CBufferLayoutSet const& layouts, bool* out_changed, std::string& out_error)
+{
+    // Sorted so the output only changes when a layout does
+    std::vector<CBufferDesc> cbuffers = layouts.CBuffers;
+    std::sort(cbuffers.begin(), cbuffers.end(), [](CBufferDesc const& a, CBufferDesc const& b) { return a.Name < b.Name; });
+
+    std::string out;
+    out += "/*----------------------------------------------\n";
+    out += "Generated by ShaderBuild from the HLSL cbuffer declarations. Do not edit;\n";
+    out += "regenerate with ShaderBuild -cbuffer-header <this file> after changing a cbuffer.\n";
+    out += "Description : C++ mirrors of every cbuffer, padded to HLSL packing rules.\n";
+    out += "Matrices are stored one register per column, as HLSL defaults to column_major.\n";
+    out += "----------------------------------------------*/\n";
+    out += "#ifndef MUON_CBUFFERLAYOUTS_H\n#define MUON_CBUFFERLAYOUTS_H\n\n";
+    out += "#include <stddef.h>\n#include <stdint.h>\n\n";
+    out += "namespace Renderer {\nnamespace CBufferLayout {\n";
+
+    for (CBufferStruct const& s : layouts.Structs)
+    {
+        out += "\nstruct " + s.Name + "\n{\n";
+        WriteFields(out, s.Fields, s.Size);
+        out += "};\n";
+        WriteAsserts(out, s.Name, s.Fields, s.Size);
+    }
+
+    for (CBufferDesc const& c : cbuffers)
+    {
+        out += "\n// cbuffer " + c.Name + " : register(b" + std::to_string(c.Register) + ")\n";
+        out += "struct " + c.Name + "\n{\n";
+        out += "    static const uint32_t kRegister = " + std::to_string(c.Register) + ";\n\n";
+        WriteFields(out, c.Fields, c.Size);
+        out += "};\n";
+        WriteAsserts(out, c.Name, c.Fields, c.Size);
+    }
+
+    out += "\n}\n}\n#endif\n";
+
+    std::string existing;
+    *out_changed = !ReadTextFile(path, existing) || existing != out;
+    if (!*out_changed)
+        return true;
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file || !file.write(out.data(), out.size()))
+    {
+        out_error = "cannot write " + path.generic_string();
+        return false;
+    }
+
+    return true;
+}
+
+}
@@ -0,0 +1,64 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Works out cbuffer layouts from HLSL source with the HLSL packing rules
+and writes them out as C++ structs with explicit padding and static_asserted offsets.
+Packing rules, in bytes:
+- Scalars and vectors pack into the current 16-byte register unless they would straddle it
+- Structs, matrices and arrays start on a new register; so does whatever follows a struct
+- Array elements are 16 bytes apart, and a matrix takes one register per column (column_major)
+  or per row (row_major)
+Only layouts that map onto plain C++ members are accepted: packoffset, and arrays or
+matrices whose elements don't fill a whole register, are reported as errors.
+----------------------------------------------*/
+#ifndef SHADERBUILD_CBUFFERLAYOUT_H
+#define SHADERBUILD_CBUFFERLAYOUT_H
+
+#include <filesystem>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ShaderBuild {
+
+struct CBufferField
+{
+    std::string Name;
+    std::string CppType;        // Element type as written in the generated header, e.g. "float" or "DirectionalLight"
+    uint32_t    Offset;         // From the start of the enclosing cbuffer or struct
+    uint32_t    Size;           // Bytes actually occupied, excluding trailing padding
+    uint32_t    Extents[2];     // C++ array extents, 0 when unused. float3 -> { 3, 0 }, float4x4 -> { 4, 4 }
+};
+
+struct CBufferStruct
+{
+    std::string               Name;
+    uint32_t                  Size;
+    std::vector<CBufferField> Fields;
+};
+
+struct CBufferDesc
+{
+    std::string               Name;
+    uint32_t                  Register;
+    uint32_t                  Size;         // Rounded up to whole registers
+    std::vector<CBufferField> Fields;
+};
+
+struct CBufferLayoutSet
+{
+    std::vector<CBufferDesc>   CBuffers;
+    std::vector<CBufferStruct> Structs;     // Only those some cbuffer uses, dependencies first
+};
+
+// source must already be preprocessed (see PreprocessHlsl)
+bool ReflectCBufferLayouts(std::string const& source, CBufferLayoutSet& out_layouts, std::string& out_error);
+
+// Adds layouts reflected from another shader. A cbuffer or struct seen before must have the exact same layout.
+bool MergeCBufferLayouts(CBufferLayoutSet const& layouts, std::string const& origin, CBufferLayoutSet& inout_merged, std::string& out_error);
+
+// Writes the header only when its contents change, so an unchanged layout doesn't trigger rebuilds
+bool WriteCBufferHeader(std::filesystem::path const& path, CBufferLayoutSet const& layouts, bool* out_changed, std::string& out_error);
+
+}
+#endif
@@ -0,0 +1,462 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of HlslReflector.h
+----------------------------------------------*/
+#include "HlslReflector.h"
+
+#include <Muon/Renderer/hash_util.h>
+
+#include <ctype.h>
+#include <regex>
+#include <stdlib.h>
+#include <string.h>
+#include <unordered_map>
+#include <vector>
+
+namespace ShaderBuild {
+
+using namespace Renderer;
+
+namespace {
+
+// Comments would otherwise confuse every regex below
+std::string StripComments(std::string const& source)
+{
+    std::string out;
+    out.reserve(source.size());
+
+    for (size_t i = 0; i < source.size(); ++i)
+    {
+        if (source.compare(i, 2, "//") == 0)
+        {
+            while (i < source.size() && source[i] != '\n')
+                ++i;
+            out.push_back('\n');
+        }
+        else if (source.compare(i, 2, "/*") == 0)
+        {
+            const size_t end = source.find("*/", i + 2);
+            i = end == std::string::npos ? source.size() : end + 1;
+            out.push_back(' ');
+        }
+        else
+        {
+            out.push_back(source[i]);
+        }
+    }
+
+    return out;
+}
+
+// Evaluates the small subset of #if expressions shaders use here:
+// terms are NAME, defined(NAME), defined NAME or an integer, optionally negated with !, joined by && and ||
+bool EvaluateCondition(std::string const& expression, std::unordered_map<std::string, std::string> const& macros, bool* out_value, std::string& out_error)
+{
+    static const std::regex kTerm(R"(^\s*(!?)\s*(?:defined\s*\(\s*(\w+)\s*\)|defined\s+(\w+)|(\w+))\s*$)");
+
+    auto evaluateTerm = [&](std::string const& text, bool* out_term) -> bool
+    {
+        std::smatch m;
+        if (!std::regex_match(text, m, kTerm))
+        {
+            out_error = "unsupported #if expression '" + expression + "'";
+            return false;
+        }
+
+        bool value;
+        if (m[2].matched || m[3].matched)
+        {
+            value = macros.count(m[2].matched ? m[2].str() : m[3].str()) != 0;
+        }
+        else if (isdigit((unsigned char)m[4].str()[0]))
+        {
+            value = atoi(m[4].str().c_str()) != 0;
+        }
+        else
+        {
+            // Like the real preprocessor, undefined names are 0
+            auto it = macros.find(m[4].str());
+            value = it != macros.end() && (it->second.empty() || atoi(it->second.c_str()) != 0);
+        }
+
+        *out_term = m[1].length() ? !value : value;
+        return true;
+    };
+
+    bool result = false;
+    size_t orStart = 0;
+    while (orStart <= expression.size())
+    {
+        size_t orEnd = expression.find("||", orStart);
+        if (orEnd == std::string::npos)
+            orEnd = expression.size();
+
+        bool conjunction = true;
+        const std::string orTerm = expression.substr(orStart, orEnd - orStart);
+        size_t andStart = 0;
+        while (andStart <= orTerm.size())
+        {
+            size_t andEnd = orTerm.find("&&", andStart);
+            if (andEnd == std::string::npos)
+                andEnd = orTerm.size();
+
+            bool term;
+            if (!evaluateTerm(orTerm.substr(andStart, andEnd - andStart), &term))
+                return false;
+
+            conjunction = conjunction && term;
+            andStart = andEnd + 2;
+        }
+
+        result = result || conjunction;
+        orStart = orEnd + 2;
+    }
+
+    *out_value = result;
+    return true;
+}
+
+// Drops the lines inside inactive conditional blocks. Directive lines are blanked so line counts stay the same.
+bool ResolveConditionals(std::string const& source, std::vector<std::string> const& defines, std::string& out_source, std::string& out_error)
+{
+    static const std::regex kDirective(R"(^\s*#\s*(\w+)\s*(.*?)\s*$)");
+
+    std::unordered_map<std::string, std::string> macros;
+    for (std::string const& define : defines)
+        macros[define] = "1";
+
+    struct Block
+    {
+        bool ParentActive;
+        bool Active;
+        bool Taken;     // Some branch of this block has already been active
+    };
+    std::vector<Block> blocks;
+
+    out_source.clear();
+    out_source.reserve(source.size());
+
+    size_t lineStart = 0;
+    while (lineStart < source.size())
+    {
+        size_t lineEnd = source.find('\n', lineStart);
+        if (lineEnd == std::string::npos)
+            lineEnd = source.size();
+
+        const std::string line = source.substr(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1;
+
+        const bool active = blocks.empty() || blocks.back().Active;
+
+        std::smatch m;
+        if (!std::regex_match(line, m, kDirective))
+        {
+            if (active)
+                out_source += line;
+            out_source += '\n';
+            continue;
+        }
+
+        const std::string directive = m[1].str();
+        const std::string argument = m[2].str();
+        bool value = false;
+
+        if (directive == "if" || directive == "ifdef" || directive == "ifndef")
+        {
+            if (directive == "if" && active && !EvaluateCondition(argument, macros, &value, out_error))
+                return false;
+            if (directive != "if")
+                value = (macros.count(argument) != 0) == (directive == "ifdef");
+
+            value = value && active;
+            blocks.push_back({ active, value, value });
+        }
+        else if (directive == "elif" || directive == "else")
+        {
+            if (blocks.empty())
+            {
+                out_error = "#" + directive + " without #if";
+                return false;
+            }
+
+            Block& block = blocks.back();
+            if (directive == "elif" && block.ParentActive && !block.Taken && !EvaluateCondition(argument, macros, &value, out_error))
+                return false;
+            if (directive == "else")
+                value = true;
+
+            block.Active = block.ParentActive && !block.Taken && value;
+            block.Taken = block.Taken || block.Active;
+        }
+        else if (directive == "endif")
+        {
+            if (blocks.empty())
+            {
+                out_error = "#endif without #if";
+                return false;
+            }
+            blocks.pop_back();
+        }
+        else if (directive == "define" && active)
+        {
+            const size_t nameEnd = argument.find_first_of(" \t(");
+            macros[argument.substr(0, nameEnd)] = nameEnd == std::string::npos ? std::string() : argument.substr(argument.find_first_not_of(" \t", nameEnd));
+        }
+        else if (directive == "undef" && active)
+        {
+            macros.erase(argument);
+        }
+
+        out_source += '\n';
+    }
+
+    if (!blocks.empty())
+    {
+        out_error = "unterminated #if";
+        return false;
+    }
+
+    return true;
+}
+
+struct HlslType
+{
+    ReflectedComponentType ComponentType;
+    uint8_t                Columns;
+    uint8_t                Rows;    // Matrices take one input slot per row
+};
+
+bool ParseType(std::string const& name, HlslType* out_type)
+{
+    if (name == "matrix")
+    {
+        *out_type = { ReflectedComponentType::FLOAT32, 4, 4 };
+        return true;
+    }
+
+    static const struct { const char* Prefix; ReflectedComponentType Type; } kScalars[] =
+    {
+        { "min16float", ReflectedComponentType::FLOAT32 },
+        { "float",      ReflectedComponentType::FLOAT32 },
+        { "half",       ReflectedComponentType::FLOAT32 },
+        { "uint",       ReflectedComponentType::UINT32  },
+        { "dword",      ReflectedComponentType::UINT32  },
+        { "bool",       ReflectedComponentType::UINT32  },
+        { "int",        ReflectedComponentType::SINT32  },
+    };
+
+    for (auto const& scalar : kScalars)
+    {
+        const size_t prefixLen = strlen(scalar.Prefix);
+        if (name.compare(0, prefixLen, scalar.Prefix) != 0)
+            continue;
+
+        // float, float3 or float4x4
+        const char* dims = name.c_str() + prefixLen;
+        uint8_t rows = 1;
+        uint8_t cols = 1;
+        if (isdigit((unsigned char)dims[0]))
+        {
+            rows = 1;
+            cols = (uint8_t)(dims[0] - '0');
+            if (dims[1] == 'x' && isdigit((unsigned char)dims[2]) && dims[3] == '\0')
+            {
+                rows = cols;
+                cols = (uint8_t)(dims[2] - '0');
+            }
+            else if (dims[1] != '\0')
+            {
+                return false;
+            }
+        }
+        else if (dims[0] != '\0')
+        {
+            return false;
+        }
+
+        if (cols < 1 || cols > 4 || rows < 1 || rows > 4)
+            return false;
+
+        *out_type = { scalar.Type, cols, rows };
+        return true;
+    }
+
+    return false;
+}
+
+struct Declaration
+{
+    std::string Type;
+    std::string Semantic;
+};
+
+// Splits "[modifiers] type name [: SEMANTIC]" entries separated by delimiter
+void ParseDeclarations(std::string const& text, char delimiter, std::vector<Declaration>& out_decls)
+{
+    static const std::regex kDecl(R"(^\s*(?:(?:in|const|nointerpolation|linear|centroid|noperspective|sample|precise)\s+)*(\w+)\s+\w+\s*(?::\s*(\w+))?\s*$)");
+
+    size_t start = 0;
+    while (start <= text.size())
+    {
+        size_t end = text.find(delimiter, start);
+        if (end == std::string::npos)
+            end = text.size();
+
+        const std::string entry = text.substr(start, end - start);
+        std::smatch match;
+        if (std::regex_match(entry, match, kDecl))
+            out_decls.push_back({ match[1].str(), match[2].str() });
+
+        start = end + 1;
+    }
+}
+
+// "TEXCOORD1" -> "TEXCOORD", 1
+void SplitSemantic(std::string const& semantic, std::string& out_name, uint8_t& out_index)
+{
+    size_t digits = semantic.size();
+    while (digits > 0 && isdigit((unsigned char)semantic[digits - 1]))
+        --digits;
+
+    out_name = semantic.substr(0, digits);
+    out_index = digits == semantic.size() ? 0 : (uint8_t)atoi(semantic.c_str() + digits);
+}
+
+bool ReflectInputs(std::string const& source, const char* entryPoint, ShaderReflectionRecord& record, std::string& out_error)
+{
+    // "<ret> main(<params>)", the parameter list can't contain parentheses in the shaders we write
+    const std::regex entryRegex(std::string(R"(\b\w+\s+)") + entryPoint + R"(\s*\(([^)]*)\))");
+    std::smatch entry;
+    if (!std::regex_search(source, entry, entryRegex))
+    {
+        out_error = std::string("no entry point named ") + entryPoint;
+        return false;
+    }
+
+    std::vector<Declaration> params;
+    ParseDeclarations(entry[1].str(), ',', params);
+
+    // Inputs are either semantics on the parameters themselves, or the fields of a struct parameter
+    std::vector<Declaration> inputs;
+    for (Declaration const& param : params)
+    {
+        if (!param.Semantic.empty())
+        {
+            inputs.push_back(param);
+            continue;
+        }
+
+        const std::regex structRegex(R"(\bstruct\s+)" + param.Type + R"(\s*\{([^}]*)\})");
+        std::smatch body;
+        if (!std::regex_search(source, body, structRegex))
+        {
+            out_error = "cannot find struct " + param.Type;
+            return false;
+        }
+
+        ParseDeclarations(body[1].str(), ';', inputs);
+    }
+
+    record.InstanceStart = kNoInstanceInputs;
+    uint16_t* byteSize = &record.VertexByteSize;
+
+    for (Declaration const& decl : inputs)
+    {
+        // System values never reach the input layout
+        if (decl.Semantic.empty() || decl.Semantic.compare(0, 3, "SV_") == 0)
+            continue;
+
+        std::string semanticName;
+        uint8_t semanticIndex = 0;
+        SplitSemantic(decl.Semantic, semanticName, semanticIndex);
+
+        uint8_t semantic = 0;
+        bool instanced = false;
+        if (!FindSemantic(semanticName.c_str(), &semantic, &instanced))
+        {
+            out_error = "unknown input semantic " + decl.Semantic;
+            return false;
+        }
+
+        HlslType type;
+        if (!ParseType(decl.Type, &type))
+        {
+            out_error = "unsupported input type " + decl.Type;
+            return false;
+        }
+
+        // Same convention as the runtime: everything from the first INSTANCE_ semantic on is per instance
+        if (instanced && record.InstanceStart == kNoInstanceInputs)
+        {
+            record.InstanceStart = record.InputCount;
+            byteSize = &record.InstanceByteSize;
+        }
+
+        for (uint8_t row = 0; row != type.Rows; ++row)
+        {
+            if (record.InputCount == kMaxReflectedInputs)
+            {
+                out_error = "too many vertex inputs";
+                return false;
+            }
+
+            ReflectedInput& input = record.Inputs[record.InputCount++];
+            input.Semantic       = semantic;
+            input.SemanticIndex  = (uint8_t)(semanticIndex + row);
+            input.ComponentType  = (uint8_t)type.ComponentType;
+            input.ComponentCount = type.Columns;
+            input.ByteOffset     = *byteSize;
+            *byteSize += (uint16_t)(type.Columns * sizeof(float));
+        }
+    }
+
+    return true;
+}
+
+void ReflectBindings(std::string const& source, ShaderReflectionRecord& record)
+{
+    static const std::regex kCBuffer(R"(\bcbuffer\s+(\w+)\s*:\s*register\s*\(\s*b(\d+)\s*\))");
+    static const std::regex kTexture(R"(\b(?:Texture1D|Texture1DArray|Texture2D|Texture2DArray|Texture2DMS|Texture3D|TextureCube|TextureCubeArray)\b\s*(?:<[^>]*>)?\s+(\w+)\s*(?:\[\s*(\d+)\s*\])?\s*:\s*register\s*\(\s*t(\d+)\s*\))");
+
+    for (std::sregex_iterator it(source.begin(), source.end(), kCBuffer), end; it != end && record.CBufferCount != kMaxReflectedBindings; ++it)
+    {
+        std::smatch const& m = *it;
+        record.CBuffers[record.CBufferCount++] = { fnv1a(m[1].str().c_str()), (uint8_t)atoi(m[2].str().c_str()), 1, 0 };
+    }
+
+    for (std::sregex_iterator it(source.begin(), source.end(), kTexture), end; it != end && record.TextureCount != kMaxReflectedBindings; ++it)
+    {
+        std::smatch const& m = *it;
+        const uint8_t count = m[2].matched ? (uint8_t)atoi(m[2].str().c_str()) : 1;
+        record.Textures[record.TextureCount++] = { fnv1a(m[1].str().c_str()), (uint8_t)atoi(m[3].str().c_str()), count, 0 };
+    }
+}
+
+}
+
+bool PreprocessHlsl(std::string const& source, std::vector<std::string> const& defines, std::string& out_source, std::string& out_error)
+{
+    return ResolveConditionals(StripComments(source), defines, out_source, out_error);
+}
+
+bool ReflectHlslSource(std::string const& source, const char* entryPoint, std::vector<std::string> const& defines, bool vertexInputs,
+                       ShaderReflectionRecord* out_record, std::string& out_error)
+{
+    std::string stripped;
+    if (!PreprocessHlsl(source, defines, stripped, out_error))
+        return false;
+
+    ShaderReflectionRecord record = {};
+    record.InstanceStart = kNoInstanceInputs;
+
+    if (vertexInputs && !ReflectInputs(stripped, entryPoint, record, out_error))
+        return false;
+
+    ReflectBindings(stripped, record);
+
+    *out_record = record;
+    return true;
+}
+
+}
@@ -0,0 +1,32 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Builds reflection sidecars from HLSL source instead of D3DReflect
+Reads the entry point's vertex inputs and the register bindings straight from the
+source text, so sidecars can be written on machines without the D3D runtime.
+Bindings are what the source declares, which may include a few the compiler would
+have stripped as unused; the runtime only uses them for validation.
+Conditional blocks are resolved against the variant's defines first, but only
+#if/#ifdef/#ifndef/#elif/#else/#endif and #define; macros are not expanded.
+----------------------------------------------*/
+#ifndef SHADERBUILD_HLSLREFLECTOR_H
+#define SHADERBUILD_HLSLREFLECTOR_H
+
+#include <Muon/Renderer/ShaderReflectionRecord.h>
+
+#include <string>
+#include <vector>
+
+namespace ShaderBuild {
+
+// Strips comments and drops inactive conditional blocks, keeping line counts intact
+bool PreprocessHlsl(std::string const& source, std::vector<std::string> const& defines, std::string& out_source, std::string& out_error);
+
+// source should be the shader with its includes already appended, so declarations from headers are seen.
+// defines are the names passed to the compiler as NAME=1.
+// Vertex inputs are only read when vertexInputs is set. BytecodeHash and BytecodeSize are left for the caller.
+bool ReflectHlslSource(std::string const& source, const char* entryPoint, std::vector<std::string> const& defines, bool vertexInputs,
+                       Renderer::ShaderReflectionRecord* out_record, std::string& out_error);
+
+}
+#endif
@@ -0,0 +1,190 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of IncludeScanner.h
+----------------------------------------------*/
+#include "IncludeScanner.h"
+
+#include <fstream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace ShaderBuild {
+
+bool ReadTextFile(fs::path const& path, std::string& out_text)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    out_text = contents.str();
+    return true;
+}
+
+void ParseIncludes(std::string const& source, std::vector<std::string>& out_names)
+{
+    const size_t size = source.size();
+    bool inBlockComment = false;
+    bool atLineStart = true;
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        const char c = source[i];
+
+        if (inBlockComment)
+        {
+            if (c == '*' && i + 1 < size && source[i + 1] == '/')
+            {
+                inBlockComment = false;
+                ++i;
+            }
+            continue;
+        }
+
+        if (c == '/' && i + 1 < size && source[i + 1] == '*')
+        {
+            inBlockComment = true;
+            ++i;
+            continue;
+        }
+
+        if (c == '/' && i + 1 < size && source[i + 1] == '/')
+        {
+            while (i < size && source[i] != '\n')
+                ++i;
+            atLineStart = true;
+            continue;
+        }
+
+        if (c == '\n')
+        {
+            atLineStart = true;
+            continue;
+        }
+
+        if (c == ' ' || c == '\t' || c == '\r')
+            continue;
+
+        if (c != '#' || !atLineStart)
+        {
+            atLineStart = false;
+            continue;
+        }
+
+        // "#   include   "name"" with any amount of horizontal whitespace
+        size_t p = i + 1;
+        while (p < size && (source[p] == ' ' || source[p] == '\t'))
+            ++p;
+
+        atLineStart = false;
+        if (source.compare(p, 7, "include") != 0)
+            continue;
+
+        p += 7;
+        while (p < size && (source[p] == ' ' || source[p] == '\t'))
+            ++p;
+
+        if (p >= size || (source[p] != '"' && source[p] != '<'))
+            continue;
+
+        const char close = source[p] == '"' ? '"' : '>';
+        const size_t nameEnd = source.find(close, p + 1);
+        if (nameEnd == std::string::npos || source.find('\n', p) < nameEnd)
+            continue;
+
+        out_names.push_back(source.substr(p + 1, nameEnd - p - 1));
+        i = nameEnd;
+    }
+}
+
+IncludeScanner::IncludeScanner(std::vector<fs::path> const& includeDirs) :
+    mIncludeDirs(includeDirs)
+{
+}
+
+IncludeScanner::FileIncludes const& IncludeScanner::GetIncludes(fs::path const& file)
+{
+    const std::string key = file.generic_string();
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mCache.find(key);
+        if (it != mCache.end())
+            return it->second;
+    }
+
+    // Parse outside the lock; if two threads race on the same header they produce the same result
+    FileIncludes includes;
+    std::string text;
+    includes.Readable = ReadTextFile(file, text);
+    if (includes.Readable)
+        ParseIncludes(text, includes.Names);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mCache.emplace(key, std::move(includes)).first->second;
+}
+
+bool IncludeScanner::Resolve(fs::path const& includer, std::string const& name, fs::path& out_path) const
+{
+    // Same order as the compiler: next to the including file first, then the -I directories
+    std::error_code ec;
+    fs::path candidate = includer.parent_path() / name;
+    if (fs::exists(candidate, ec))
+    {
+        out_path = candidate.lexically_normal();
+        return true;
+    }
+
+    for (fs::path const& dir : mIncludeDirs)
+    {
+        candidate = dir / name;
+        if (fs::exists(candidate, ec))
+        {
+            out_path = candidate.lexically_normal();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool IncludeScanner::Scan(fs::path const& source, std::vector<fs::path>& out_files, std::string& out_error)
+{
+    out_files.clear();
+    out_files.push_back(source.lexically_normal());
+
+    // Breadth first over out_files itself; a file already in the list is never visited twice, which also stops include cycles
+    for (size_t next = 0; next != out_files.size(); ++next)
+    {
+        const fs::path current = out_files[next];
+        FileIncludes const& includes = GetIncludes(current);
+        if (!includes.Readable)
+        {
+            out_error = "cannot read " + current.generic_string();
+            return false;
+        }
+
+        for (std::string const& name : includes.Names)
+        {
+            fs::path resolved;
+            if (!Resolve(current, name, resolved))
+            {
+                out_error = current.generic_string() + ": cannot find include \"" + name + "\"";
+                return false;
+            }
+
+            bool seen = false;
+            for (fs::path const& existing : out_files)
+                seen = seen || existing == resolved;
+
+            if (!seen)
+                out_files.push_back(resolved);
+        }
+    }
+
+    return true;
+}
+
+}
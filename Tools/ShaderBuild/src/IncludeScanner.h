@@ -0,0 +1,55 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Finds every file a shader pulls in through #include
+Only looks at #include lines, not the rest of the preprocessor, so an include
+behind an #if is still treated as a dependency. Rebuilding one shader too many
+is cheap; missing a changed header is not.
+----------------------------------------------*/
+#ifndef SHADERBUILD_INCLUDESCANNER_H
+#define SHADERBUILD_INCLUDESCANNER_H
+
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ShaderBuild {
+
+class IncludeScanner
+{
+public:
+    explicit IncludeScanner(std::vector<std::filesystem::path> const& includeDirs);
+
+    // Fills out_files with source followed by everything it includes, directly or not, each once and in a
+    // stable order. Returns false and describes the problem in out_error if an include can't be found.
+    // Safe to call from several threads; shared headers are only read once.
+    bool Scan(std::filesystem::path const& source, std::vector<std::filesystem::path>& out_files, std::string& out_error);
+
+private:
+    struct FileIncludes
+    {
+        bool                               Readable;
+        std::vector<std::string>           Names;      // As written between the quotes or brackets
+    };
+
+    FileIncludes const& GetIncludes(std::filesystem::path const& file);
+    bool                Resolve(std::filesystem::path const& includer, std::string const& name, std::filesystem::path& out_path) const;
+
+    std::vector<std::filesystem::path>            mIncludeDirs;
+    std::mutex                                    mMutex;
+    std::unordered_map<std::string, FileIncludes> mCache;
+
+public:
+    IncludeScanner(IncludeScanner const&)            = delete;
+    IncludeScanner& operator=(IncludeScanner const&) = delete;
+};
+
+// Pulls the names out of every #include line in an HLSL source, skipping comments
+void ParseIncludes(std::string const& source, std::vector<std::string>& out_names);
+
+bool ReadTextFile(std::filesystem::path const& path, std::string& out_text);
+
+}
+#endif
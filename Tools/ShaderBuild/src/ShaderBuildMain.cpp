@@ -0,0 +1,457 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Offline shader build. Compiles every variant of every program in parallel
+through DXC (or any compiler taking the same -T/-E/-Fo/-I/-D flags, e.g. FXC with -sm 5_0),
+skips variants whose sources and includes haven't changed, reuses cached bytecode
+by content hash, and packs all of them into one shader archive.
+Base variants are also written as loose .cso files with a .refl sidecar next to each.
+With -cbuffer-header, every cbuffer's layout is checked for agreement across shaders
+and written out as C++ structs the engine static_asserts against.
+Usage: ShaderBuild [-src dir] [-out dir] [-archive file] [-cache dir] [-compiler path] [-sm 6_0] [-I dir]... [-jobs N] [-clean]
+                   [-cbuffer-header file]
+----------------------------------------------*/
+#include "BuildCache.h"
+#include "CBufferLayout.h"
+#include "HlslReflector.h"
+#include "IncludeScanner.h"
+
+#include <Muon/Core/JobSystem.h>
+#include <Muon/Renderer/ShaderArchive.h>
+#include <Muon/Renderer/ShaderReflectionRecord.h>
+#include <Muon/Renderer/ShaderVariant.h>
+#include <Muon/Renderer/hash_util.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct BuildOptions
+{
+    fs::path              SourceDir    = "Assets/Shaders";
+    fs::path              OutputDir    = "_bin/Shaders";
+    fs::path              ArchivePath;                      // Defaults to <OutputDir>/Shaders.msa
+    fs::path              CacheDir     = "_int/ShaderCache";
+    std::string           Compiler     = "dxc";
+    std::string           ShaderModel  = "6_0";
+    std::vector<fs::path> IncludeDirs;
+    fs::path              CBufferHeader;                    // Not generated unless set
+    uint32_t              JobCount     = 0;
+    bool                  Clean        = false;
+};
+
+enum class BuildStatus : uint8_t
+{
+    UP_TO_DATE,
+    FROM_CACHE,
+    COMPILED,
+    FAILED,
+    COUNT
+};
+
+const char* kStatusNames[(uint8_t)BuildStatus::COUNT] = { "up to date", "from cache", "compiled", "FAILED" };
+
+struct ShaderJob
+{
+    fs::path                   Source;
+    std::string                Program;    // File stem, e.g. "PhongPS"
+    std::string                Name;       // Program and features, e.g. "PhongPS+NORMAL_MAP"
+    Renderer::ProgramStage      Stage;
+    Renderer::ShaderVariantKey Variant;
+
+    // The source and everything it includes, source first
+    std::vector<fs::path>      Dependencies;
+
+    BuildStatus Status;
+    uint64_t    Key;
+    double      Milliseconds;
+    std::string Message;
+};
+
+void GetVariantDefines(Renderer::ShaderVariantKey variant, std::vector<std::string>& out_defines)
+{
+    out_defines.clear();
+    for (uint8_t f = 0; f != (uint8_t)Renderer::ShaderFeature::COUNT; ++f)
+    {
+        if (Renderer::HasFeature(variant, (Renderer::ShaderFeature)f))
+            out_defines.push_back(Renderer::GetShaderFeatureName((Renderer::ShaderFeature)f));
+    }
+}
+
+std::string Quote(fs::path const& path)
+{
+    return "\"" + path.string() + "\"";
+}
+
+bool CopyIfPresent(fs::path const& from, fs::path const& to)
+{
+    std::error_code ec;
+    if (!fs::exists(from, ec))
+        return false;
+
+    return fs::copy_file(from, to, fs::copy_options::overwrite_existing, ec);
+}
+
+// Headers first so the entry point's struct and any cbuffers they declare are all visible
+bool ConcatenateSources(std::vector<fs::path> const& dependencies, std::string& out_source, std::string& out_error)
+{
+    out_source.clear();
+    for (size_t i = dependencies.size(); i-- != 0; )
+    {
+        std::string text;
+        if (!ShaderBuild::ReadTextFile(dependencies[i], text))
+        {
+            out_error = "cannot read " + dependencies[i].generic_string();
+            return false;
+        }
+        out_source += text;
+        out_source += '\n';
+    }
+
+    return true;
+}
+
+bool WriteSidecar(ShaderJob& job, std::vector<std::string> const& defines, fs::path const& bytecodePath, fs::path const& sidecarPath)
+{
+    std::string source;
+    if (!ConcatenateSources(job.Dependencies, source, job.Message))
+        return false;
+
+    std::string bytecode;
+    if (!ShaderBuild::ReadTextFile(bytecodePath, bytecode))
+    {
+        job.Message = "compiler produced no output";
+        return false;
+    }
+
+    Renderer::ShaderReflectionRecord record;
+    const bool vertexInputs = job.Stage == Renderer::ProgramStage::VS;
+    if (!ShaderBuild::ReflectHlslSource(source, "main", defines, vertexInputs, &record, job.Message))
+        return false;
+
+    record.BytecodeSize = (uint32_t)bytecode.size();
+    record.BytecodeHash = Renderer::HashShaderBytecode(bytecode.data(), bytecode.size());
+
+    if (!Renderer::SaveReflectionRecord(sidecarPath, record))
+    {
+        job.Message = "cannot write " + sidecarPath.generic_string();
+        return false;
+    }
+
+    return true;
+}
+
+void BuildShader(ShaderJob& job, BuildOptions const& options, ShaderBuild::IncludeScanner& scanner, ShaderBuild::BuildCache& cache)
+{
+    const auto start = std::chrono::steady_clock::now();
+    auto finish = [&](BuildStatus status)
+    {
+        job.Status = status;
+        job.Milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    if (!scanner.Scan(job.Source, job.Dependencies, job.Message))
+        return finish(BuildStatus::FAILED);
+
+    std::vector<std::string> defines;
+    GetVariantDefines(job.Variant, defines);
+
+    // Anything that changes the bytecode has to be part of the key
+    const std::string profile = std::string(Renderer::GetProgramStagePrefix(job.Stage)) + "_" + options.ShaderModel;
+    std::string signature = options.Compiler + "|" + profile + "|main";
+    for (std::string const& define : defines)
+        signature += "|" + define;
+    if (!ShaderBuild::ComputeBuildKey(signature, job.Dependencies, &job.Key))
+    {
+        job.Message = "cannot read dependencies";
+        return finish(BuildStatus::FAILED);
+    }
+
+    // Only base variants are written loose; the archive is built from the cache afterwards
+    const bool writeLoose = job.Variant == Renderer::kBaseVariant;
+    const fs::path outBytecode = options.OutputDir / (job.Program + ".cso");
+    const fs::path outSidecar  = Renderer::GetReflectionPath(outBytecode);
+
+    const bool cached = cache.HasObject(job.Key, ".cso") && cache.HasObject(job.Key, ".refl");
+
+    std::error_code ec;
+    if (cached && cache.GetManifestKey(job.Name) == job.Key && (!writeLoose || (fs::exists(outBytecode, ec) && fs::exists(outSidecar, ec))))
+        return finish(BuildStatus::UP_TO_DATE);
+
+    const fs::path cachedBytecode = cache.GetObjectPath(job.Key, ".cso");
+    const fs::path cachedSidecar  = cache.GetObjectPath(job.Key, ".refl");
+
+    BuildStatus status = BuildStatus::FROM_CACHE;
+    if (!cached)
+    {
+        // Compile to a temporary name so a failed or interrupted compile never looks like a cache hit
+        const fs::path tempBytecode = cache.GetObjectPath(job.Key, ".cso.tmp");
+        const fs::path logPath      = cache.GetObjectPath(job.Key, ".log");
+
+        std::string command = Quote(options.Compiler) + " -T " + profile + " -E main -Fo " + Quote(tempBytecode);
+        command += " -I " + Quote(job.Source.parent_path());
+        for (fs::path const& dir : options.IncludeDirs)
+            command += " -I " + Quote(dir);
+        for (std::string const& define : defines)
+            command += " -D " + define + "=1";
+        command += " " + Quote(job.Source) + " > " + Quote(logPath) + " 2>&1";
+
+#if defined(MN_PLATFORM_WINDOWS)
+        // cmd.exe strips the outer quotes of a command line that starts with one
+        command = "\"" + command + "\"";
+#endif
+
+        if (system(command.c_str()) != 0 || !fs::exists(tempBytecode, ec))
+        {
+            std::string log;
+            ShaderBuild::ReadTextFile(logPath, log);
+            job.Message = log.empty() ? "compiler failed: " + command : log;
+            return finish(BuildStatus::FAILED);
+        }
+
+        if (!WriteSidecar(job, defines, tempBytecode, cachedSidecar))
+            return finish(BuildStatus::FAILED);
+
+        fs::rename(tempBytecode, cachedBytecode, ec);
+        if (ec)
+        {
+            job.Message = "cannot move " + tempBytecode.generic_string() + " into the cache";
+            return finish(BuildStatus::FAILED);
+        }
+
+        status = BuildStatus::COMPILED;
+    }
+
+    if (writeLoose && (!CopyIfPresent(cachedBytecode, outBytecode) || !CopyIfPresent(cachedSidecar, outSidecar)))
+    {
+        job.Message = "cannot copy outputs to " + options.OutputDir.generic_string();
+        return finish(BuildStatus::FAILED);
+    }
+
+    cache.SetManifestKey(job.Name, job.Key);
+    finish(status);
+}
+
+// "6_0" -> 60
+uint16_t ParseShaderModel(std::string const& shaderModel)
+{
+    const size_t separator = shaderModel.find('_');
+    const int minor = separator == std::string::npos ? 0 : atoi(shaderModel.c_str() + separator + 1);
+    return (uint16_t)(atoi(shaderModel.c_str()) * 10 + minor);
+}
+
+// Rewritten every run; it's only a few reads from the cache and keeps the archive in step with the manifest
+bool WriteArchive(std::vector<ShaderJob> const& jobs, BuildOptions const& options, ShaderBuild::BuildCache const& cache)
+{
+    Renderer::ShaderArchiveWriter writer;
+    writer.SetShaderModel(ParseShaderModel(options.ShaderModel));
+    std::string bytecode;
+    std::string reflection;
+    for (ShaderJob const& job : jobs)
+    {
+        if (job.Status == BuildStatus::FAILED)
+            continue;
+
+        if (!ShaderBuild::ReadTextFile(cache.GetObjectPath(job.Key, ".cso"), bytecode) ||
+            !ShaderBuild::ReadTextFile(cache.GetObjectPath(job.Key, ".refl"), reflection))
+        {
+            fprintf(stderr, "%s: cached outputs went missing\n", job.Name.c_str());
+            return false;
+        }
+
+        const Renderer::ShaderKey key = { fnv1a(job.Program.c_str()), job.Variant };
+        writer.Add(key, job.Stage, bytecode.data(), bytecode.size(), std::vector<uint8_t>(reflection.begin(), reflection.end()));
+    }
+
+    const fs::path archivePath = options.ArchivePath.empty() ? options.OutputDir / "Shaders.msa" : options.ArchivePath;
+    if (!writer.Save(archivePath))
+    {
+        fprintf(stderr, "Cannot write shader archive %s\n", archivePath.string().c_str());
+        return false;
+    }
+
+    std::error_code ec;
+    printf("Archived %u variants in %s (%llu KB, %llu KB of identical bytecode shared)\n", writer.GetEntryCount(), archivePath.generic_string().c_str(),
+        (unsigned long long)(fs::file_size(archivePath, ec) >> 10), (unsigned long long)(writer.GetSharedBytes() >> 10));
+    return true;
+}
+
+// Every variant is reflected, since a cbuffer can differ between them. Compiled or not, layouts are cheap to redo.
+bool WriteCBufferLayouts(std::vector<ShaderJob> const& jobs, BuildOptions const& options)
+{
+    ShaderBuild::CBufferLayoutSet merged;
+    std::string source;
+    std::string preprocessed;
+    std::string error;
+    std::vector<std::string> defines;
+    for (ShaderJob const& job : jobs)
+    {
+        if (job.Status == BuildStatus::FAILED)
+            continue;
+
+        ShaderBuild::CBufferLayoutSet layouts;
+        GetVariantDefines(job.Variant, defines);
+        if (!ConcatenateSources(job.Dependencies, source, error) ||
+            !ShaderBuild::PreprocessHlsl(source, defines, preprocessed, error) ||
+            !ShaderBuild::ReflectCBufferLayouts(preprocessed, layouts, error) ||
+            !ShaderBuild::MergeCBufferLayouts(layouts, job.Name, merged, error))
+        {
+            fprintf(stderr, "%s: %s\n", job.Name.c_str(), error.c_str());
+            return false;
+        }
+    }
+
+    bool changed = false;
+    if (!ShaderBuild::WriteCBufferHeader(options.CBufferHeader, merged, &changed, error))
+    {
+        fprintf(stderr, "%s\n", error.c_str());
+        return false;
+    }
+
+    printf("%s %zu cbuffer layouts in %s\n", changed ? "Wrote" : "Checked", merged.CBuffers.size(), options.CBufferHeader.generic_string().c_str());
+    return true;
+}
+
+bool ParseArguments(int argc, char** argv, BuildOptions& out_options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "-clean"))
+            out_options.Clean = true;
+        else if (!strcmp(argv[i], "-src") && hasValue)
+            out_options.SourceDir = argv[++i];
+        else if (!strcmp(argv[i], "-out") && hasValue)
+            out_options.OutputDir = argv[++i];
+        else if (!strcmp(argv[i], "-archive") && hasValue)
+            out_options.ArchivePath = argv[++i];
+        else if (!strcmp(argv[i], "-cache") && hasValue)
+            out_options.CacheDir = argv[++i];
+        else if (!strcmp(argv[i], "-compiler") && hasValue)
+            out_options.Compiler = argv[++i];
+        else if (!strcmp(argv[i], "-sm") && hasValue)
+            out_options.ShaderModel = argv[++i];
+        else if (!strcmp(argv[i], "-I") && hasValue)
+            out_options.IncludeDirs.push_back(argv[++i]);
+        else if (!strcmp(argv[i], "-cbuffer-header") && hasValue)
+            out_options.CBufferHeader = argv[++i];
+        else if (!strcmp(argv[i], "-jobs") && hasValue)
+            out_options.JobCount = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        else
+        {
+            fprintf(stderr, "Unknown or incomplete argument '%s'\n", argv[i]);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    BuildOptions options;
+    if (!ParseArguments(argc, argv, options))
+        return EXIT_FAILURE;
+
+    const auto buildStart = std::chrono::steady_clock::now();
+
+    std::error_code ec;
+    if (!fs::is_directory(options.SourceDir, ec))
+    {
+        fprintf(stderr, "Shader source directory '%s' does not exist\n", options.SourceDir.string().c_str());
+        return EXIT_FAILURE;
+    }
+    fs::create_directories(options.OutputDir, ec);
+
+    // Sorted so the report and the manifest come out the same every run
+    std::vector<ShaderJob> jobs;
+    std::vector<Renderer::ShaderVariantKey> variants;
+    for (fs::directory_entry const& entry : fs::recursive_directory_iterator(options.SourceDir, ec))
+    {
+        if (!entry.is_regular_file() || entry.path().extension() != ".hlsl")
+            continue;
+
+        const std::string stem = entry.path().stem().string();
+        Renderer::ProgramStage stage;
+        if (!Renderer::GetProgramStage(stem, &stage))
+        {
+            printf("Skipping %s: can't tell its stage from the name\n", entry.path().filename().string().c_str());
+            continue;
+        }
+
+        std::string source;
+        std::string error;
+        Renderer::ShaderVariantKey supported;
+        if (!ShaderBuild::ReadTextFile(entry.path(), source) || !Renderer::ParseVariantDeclaration(source, &supported, error))
+        {
+            fprintf(stderr, "%s: %s\n", entry.path().filename().string().c_str(), error.empty() ? "cannot read file" : error.c_str());
+            return EXIT_FAILURE;
+        }
+
+        Renderer::EnumerateVariants(supported, variants);
+        for (Renderer::ShaderVariantKey variant : variants)
+        {
+            ShaderJob job = {};
+            job.Source  = entry.path();
+            job.Program = stem;
+            job.Name    = Renderer::GetVariantName(stem, variant);
+            job.Stage   = stage;
+            job.Variant = variant;
+            jobs.push_back(job);
+        }
+    }
+    std::sort(jobs.begin(), jobs.end(), [](ShaderJob const& a, ShaderJob const& b) { return a.Name < b.Name; });
+
+    ShaderBuild::BuildCache cache(options.CacheDir);
+    if (options.Clean)
+        cache.Clear();
+
+    const bool incremental = cache.LoadManifest();
+
+    ShaderBuild::IncludeScanner scanner(options.IncludeDirs);
+
+    // Compiles are separate processes, so run them wide; the main thread helps out in Wait
+    Core::JobSystem::Init(options.JobCount);
+    Core::JobCounter counter;
+    Core::JobSystem::Dispatch(counter, (uint32_t)jobs.size(), 1, [&](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t i = begin; i != end; ++i)
+            BuildShader(jobs[i], options, scanner, cache);
+    });
+    Core::JobSystem::Wait(counter);
+    const uint32_t threadCount = Core::JobSystem::GetWorkerCount() + 1;
+    Core::JobSystem::Shutdown();
+
+    cache.SaveManifest();
+
+    const bool archived = WriteArchive(jobs, options, cache);
+    const bool generated = options.CBufferHeader.empty() || WriteCBufferLayouts(jobs, options);
+
+    uint32_t counts[(uint8_t)BuildStatus::COUNT] = {};
+    for (ShaderJob const& job : jobs)
+    {
+        counts[(uint8_t)job.Status]++;
+        printf("%-32s %-10s %9.1f ms  %016llx\n", job.Name.c_str(), kStatusNames[(uint8_t)job.Status], job.Milliseconds, (unsigned long long)job.Key);
+        if (job.Status == BuildStatus::FAILED)
+            fprintf(stderr, "%s\n", job.Message.c_str());
+    }
+
+    const double totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - buildStart).count();
+    printf("%s build of %zu shader variants on %u threads: %u compiled, %u from cache, %u up to date, %u failed in %.1f ms\n",
+        incremental ? "Incremental" : "Clean", jobs.size(), threadCount,
+        counts[(uint8_t)BuildStatus::COMPILED], counts[(uint8_t)BuildStatus::FROM_CACHE],
+        counts[(uint8_t)BuildStatus::UP_TO_DATE], counts[(uint8_t)BuildStatus::FAILED], totalMs);
+
+    return counts[(uint8_t)BuildStatus::FAILED] || !archived || !generated ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,777 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of BlockCompression.h
+----------------------------------------------*/
+#include "BlockCompression.h"
+
+#include <Muon/Core/JobSystem.h>
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+namespace TextureCooker {
+
+using Renderer::DDSFormat;
+
+namespace {
+
+const uint32_t kRowsPerJob = 4;
+const uint32_t kRefineIterations = 2;
+
+const uint8_t kBC7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+// Little endian bit packing for BC7
+struct BitWriter
+{
+    uint8_t* Out;
+    uint32_t Position;
+
+    void Write(uint32_t value, uint32_t count)
+    {
+        for (uint32_t i = 0; i != count; ++i, ++Position)
+        {
+            if ((value >> i) & 1)
+                Out[Position >> 3] |= (uint8_t)(1 << (Position & 7));
+        }
+    }
+};
+
+struct BitReader
+{
+    const uint8_t* In;
+    uint32_t       Position;
+
+    uint32_t Read(uint32_t count)
+    {
+        uint32_t value = 0;
+        for (uint32_t i = 0; i != count; ++i, ++Position)
+            value |= (uint32_t)((In[Position >> 3] >> (Position & 7)) & 1) << i;
+        return value;
+    }
+};
+
+// Principal axis of N-channel points by power iteration on the covariance matrix
+template <uint32_t N>
+void PrincipalAxis(const float (*points)[N], float const* mean, float* out_axis)
+{
+    float covariance[N][N] = {};
+    for (uint32_t i = 0; i != 16; ++i)
+    {
+        for (uint32_t a = 0; a != N; ++a)
+        {
+            for (uint32_t b = 0; b != N; ++b)
+                covariance[a][b] += (points[i][a] - mean[a]) * (points[i][b] - mean[b]);
+        }
+    }
+
+    float axis[N];
+    for (uint32_t a = 0; a != N; ++a)
+        axis[a] = 1.0f;
+
+    for (uint32_t iteration = 0; iteration != 8; ++iteration)
+    {
+        float next[N] = {};
+        float largest = 0.0f;
+        for (uint32_t a = 0; a != N; ++a)
+        {
+            for (uint32_t b = 0; b != N; ++b)
+                next[a] += covariance[a][b] * axis[b];
+            largest = std::max(largest, fabsf(next[a]));
+        }
+
+        // Flat block: any axis will do
+        if (largest < 1e-8f)
+            break;
+
+        for (uint32_t a = 0; a != N; ++a)
+            axis[a] = next[a] / largest;
+    }
+
+    for (uint32_t a = 0; a != N; ++a)
+        out_axis[a] = axis[a];
+}
+
+// Endpoints at the extremes of the points' projections onto the principal axis
+template <uint32_t N>
+void FitEndpoints(const float (*points)[N], float* out_e0, float* out_e1)
+{
+    float mean[N] = {};
+    for (uint32_t i = 0; i != 16; ++i)
+    {
+        for (uint32_t a = 0; a != N; ++a)
+            mean[a] += points[i][a] / 16.0f;
+    }
+
+    float axis[N];
+    PrincipalAxis<N>(points, mean, axis);
+
+    float lo = 0.0f;
+    float hi = 0.0f;
+    for (uint32_t i = 0; i != 16; ++i)
+    {
+        float t = 0.0f;
+        for (uint32_t a = 0; a != N; ++a)
+            t += (points[i][a] - mean[a]) * axis[a];
+        lo = std::min(lo, t);
+        hi = std::max(hi, t);
+    }
+
+    float lengthSq = 0.0f;
+    for (uint32_t a = 0; a != N; ++a)
+        lengthSq += axis[a] * axis[a];
+    if (lengthSq > 0.0f)
+    {
+        lo /= lengthSq;
+        hi /= lengthSq;
+    }
+
+    for (uint32_t a = 0; a != N; ++a)
+    {
+        out_e0[a] = std::min(255.0f, std::max(0.0f, mean[a] + axis[a] * hi));
+        out_e1[a] = std::min(255.0f, std::max(0.0f, mean[a] + axis[a] * lo));
+    }
+}
+
+// Least squares endpoints for fixed interpolation weights (0 = all e0, 1 = all e1). False if the system is singular.
+template <uint32_t N>
+bool SolveEndpoints(const float (*points)[N], const float* weights, float* out_e0, float* out_e1)
+{
+    float aa = 0.0f;
+    float ab = 0.0f;
+    float bb = 0.0f;
+    float ax[N] = {};
+    float bx[N] = {};
+    for (uint32_t i = 0; i != 16; ++i)
+    {
+        const float b = weights[i];
+        const float a = 1.0f - b;
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for (uint32_t c = 0; c != N; ++c)
+        {
+            ax[c] += a * points[i][c];
+            bx[c] += b * points[i][c];
+        }
+    }
+
+    const float det = aa * bb - ab * ab;
+    if (fabsf(det) < 1e-6f)
+        return false;
+
+    for (uint32_t c = 0; c != N; ++c)
+    {
+        out_e0[c] = std::min(255.0f, std::max(0.0f, (bb * ax[c] - ab * bx[c]) / det));
+        out_e1[c] = std::min(255.0f, std::max(0.0f, (aa * bx[c] - ab * ax[c]) / det));
+    }
+    return true;
+}
+
+//
+// BC1
+//
+
+uint16_t To565(const float* color)
+{
+    const uint32_t r = (uint32_t)(color[0] * 31.0f / 255.0f + 0.5f);
+    const uint32_t g = (uint32_t)(color[1] * 63.0f / 255.0f + 0.5f);
+    const uint32_t b = (uint32_t)(color[2] * 31.0f / 255.0f + 0.5f);
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+void From565(uint16_t c, int32_t* out_rgb)
+{
+    const int32_t r = (c >> 11) & 31;
+    const int32_t g = (c >> 5) & 63;
+    const int32_t b = c & 31;
+    out_rgb[0] = (r << 3) | (r >> 2);
+    out_rgb[1] = (g << 2) | (g >> 4);
+    out_rgb[2] = (b << 3) | (b >> 2);
+}
+
+// Four color palette in index order: c0, c1, 2/3 c0 + 1/3 c1, 1/3 c0 + 2/3 c1
+void BC1Palette(uint16_t c0, uint16_t c1, int32_t (*out_palette)[3])
+{
+    From565(c0, out_palette[0]);
+    From565(c1, out_palette[1]);
+    for (uint32_t c = 0; c != 3; ++c)
+    {
+        out_palette[2][c] = (2 * out_palette[0][c] + out_palette[1][c]) / 3;
+        out_palette[3][c] = (out_palette[0][c] + 2 * out_palette[1][c]) / 3;
+    }
+}
+
+uint32_t BC1Indices(const float (*points)[3], uint16_t c0, uint16_t c1, uint8_t* out_indices)
+{
+    int32_t palette[4][3];
+    BC1Palette(c0, c1, palette);
+
+    uint32_t total = 0;
+    for (uint32_t i = 0; i != 16; ++i)
+    {
+        uint32_t best = UINT32_MAX;
+        for (uint8_t p = 0; p != 4; ++p)
+        {
+            uint32_t error = 0;
+            for (uint32_t c = 0; c != 3; ++c)
+            {
+                const int32_t d = (int32_t)points[i][c] - palette[p][c];
+                error += (uint32_t)(d * d);
+            }
+            if (error < best)
+            {
+                best = error;
+                out_indices[i] = p;
+            }
+        }
+        total += best;
+    }
+    return total;
+}
+
+void EncodeColorBlock(const uint8_t* pBlock, uint8_t* pOut)
+{
+    float points[16][3];
+    for (uint32_t i = 0; i != 16; ++i)
+    {
+        for (uint32_t c = 0; c != 3; ++c)
+            points[i][c] = pBlock[i * 4 + c];
+    }
+
+    float e0[3];
+    float e1[3];
+    FitEndpoints<3>(points, e0, e1);
+
+    // Pull the endpoints in slightly; the extremes are rarely worth a whole palette entry
+    for (uint32_t c = 0; c != 3; ++c)
+    {
+        const float inset = (e0[c] - e1[c]) / 16.0f;
+        e0[c] -= inset;
+        e1[c] += inset;
+    }
+
+    uint16_t c0 = To565(e0);
+    uint16_t c1 = To565(e1);
+    uint8_t indices[16];
+    uint32_t error = BC1Indices(points, c0, c1, indices);
+
+    static const float kWeights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+    for (uint32_t iteration = 0; iteration != kRefineIterations && error; ++iteration)
+    {
+        float weights[16];
+        for (uint32_t i = 0; i != 16; ++i)
+            weights[i] = kWeights[indices[i]];
+
+        if (!SolveEndpoints<3>(points, weights, e0, e1))
+            break;
+
+        const uint16_t n0 = To565(e0);
+        const uint16_t n1 = To565(e1);
+        uint8_t candidate[16];
+        const uint32_t candidateError = BC1Indices(points, n0, n1, candidate);
+        if (candidateError >= error)
+            break;
+
+        c0 = n0;
+        c1 = n1;
+        error = candidateError;
+        memcpy(indices, candidate, sizeof(indices));
+    }
+
+    // c0 > c1 selects the four color mode; swapping the endpoints swaps index pairs
+    if (c0 < c1)
+    {
+        std::swap(c0, c1);
+        for (uint8_t& index : indices)
+            index ^= 1;
+    }
+    else if (c0 == c1)
+    {
+        memset(indices, 0, sizeof(indices));
+    }
+
+    uint32_t packed = 0;
+    for (uint32_t i = 0; i != 16; ++i)
+        packed |= (uint32_t)indices[i] << (i * 2);
+
+    pOut[0] = (uint8_t)c0;
+    pOut[1] = (uint8_t)(c0 >> 8);
+    pOut[2] = (uint8_t)c1;
+    pOut[3] = (uint8_t)(c1 >> 8);
+    memcpy(pOut + 4, &packed, 4);
+}
+
+void DecodeColorBlock(const uint8_t* pIn, uint8_t* pOut, bool allowPunchThrough)
+{
+    const uint16_t c0 = (uint16_t)(pIn[0] | (pIn[1] << 8));
+    const uint16_t c1 = (uint16_t)(pIn[2] | (pIn[3] << 8));
+
+    int32_t palette[4][3];
+    BC1Palette(c0, c1, palette);
+    uint8_t alpha[4] = { 255, 255, 255, 255 };
+    if (allowPunchThrough && c0 <= c1)
+    {
+        for (uint32_t c = 0; c != 3; ++c)
+        {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+        alpha[3] = 0;
+    }
+
+    for (uint32_t i = 0; i != 16; ++i)
+    {
+        const uint32_t index = (pIn[4 + i / 4] >> ((i % 4) * 2)) & 3;
+        for (uint32_t c = 0; c != 3; ++c)
+            pOut[i * 4 + c] = (uint8_t)palette[index][c];
+        pOut[i * 4 + 3] = alpha[index];
+    }
+}
+
+//
+// BC4
+//
+
+void BC4Palette(uint8_t r0, uint8_t r1, uint8_t* out_palette)
+{
+    out_palette[0] = r0;
+    out_palette[1] = r1;
+    if (r0 > r1)
+    {
+        for (uint32_t i = 1; i != 7; ++i)
+            out_palette[i + 1] = (uint8_t)(((7 - i) * r0 + i * r1 + 3) / 7);
+    }
+    else
+    {
+        for (uint32_t i = 1; i != 5; ++i)
+            out_palette[i + 1] = (uint8_t)(((5 - i) * r0 + i * r1 + 2) / 5);
+        out_palette[6] = 0;
+        out_palette[7] = 255;
+    }
+}
+
+uint32_t BC4Indices(const uint8_t* values, uint8_t r0, uint8_t r1, uint8_t* out_indices)
+{
+    uint8_t palette[8];
+    BC4Palette(r0, r1, palette);
+
+    uint32_t total = 0;
+    for (uint32_t i = 0; i != 16; ++i)
+    {
+        uint32_t best = UINT32_MAX;
+        for (uint8_t p = 0; p != 8; ++p)
+        {
+            const int32_t d = (int32_t)values[i] - palette[p];
+            if ((uint32_t)(d * d) < best)
+            {
+                best = (uint32_t)(d * d);
+                out_indices[i] = p;
+            }
+        }
+        total += best;
+    }
+    return total;
+}
+
+void EncodeSingleChannel(const uint8_t* pBlock, uint32_t channel, uint8_t* pOut)
+{
+    uint8_t values[16];
+    uint8_t lo = 255;
+    uint8_t hi = 0;
+    uint8_t innerLo = 255;
+    uint8_t innerHi = 0;
+    for (uint32_t i = 0; i != 16; ++i)
+    {
+        const uint8_t v = pBlock[i * 4 + channel];
+        values[i] = v;
+        lo = std::min(lo, v);
+        hi = std::max(hi, v);
+        if (v != 0 && v != 255)
+        {
+            innerLo = std::min(innerLo, v);
+            innerHi = std::max(innerHi, v);
+        }
+    }
+
+    uint8_t r0 = hi;
+    uint8_t r1 = lo;
+    uint8_t indices[16] = {};
+    uint32_t error = lo == hi ? 0 : BC4Indices(values, r0, r1, indices);
+
+    // Blocks that touch 0 or 255 can spend the palette on everything in between instead
+    if (error && innerLo <= innerHi && (lo == 0 || hi == 255))
+    {
+        uint8_t candidate[16];
+        const uint32_t candidateError = BC4Indices(values, innerLo, innerHi, candidate);
+        if (candidateError < error)
+        {
+            r0 = innerLo;
+            r1 = innerHi;
+            error = candidateError;
+            memcpy(indices, candidate, sizeof(indices));
+        }
+    }
+
+    pOut[0] = r0;
+    pOut[1] = r1;
+    uint64_t packed = 0;
+    for (uint32_t i = 0; i != 16; ++i)
+        packed |= (uint64_t)indices[i] << (i * 3);
+    for (uint32_t i = 0; i != 6; ++i)
+        pOut[2 + i] = (uint8_t)(packed >> (i * 8));
+}
+
+void DecodeSingleChannel(const uint8_t* pIn, uint32_t channel, uint8_t* pOut)
+{
+    uint8_t palette[8];
+    BC4Palette(pIn[0], pIn[1], palette);
+
+    uint64_t packed = 0;
+    for (uint32_t i = 0; i != 6; ++i)
+        packed |= (uint64_t)pIn[2 + i] << (i * 8);
+
+    for (uint32_t i = 0; i != 16; ++i)
+        pOut[i * 4 + channel] = palette[(packed >> (i * 3)) & 7];
+}
+
+//
+// BC7 mode 6
+//
+
+struct BC7Endpoints
+{
+    uint8_t Quantized[2][4];    // 7 bits per channel
+    uint8_t PBits[2];
+};
+
+void ExpandBC7(BC7Endpoints const& ep, int32_t (*out_endpoints)[4])
+{
+    for (uint32_t e = 0; e != 2; ++e)
+    {
+        for (uint32_t c = 0; c != 4; ++c)
+            out_endpoints[e][c] = (ep.Quantized[e][c] << 1) | ep.PBits[e];
+    }
+}
+
+int32_t InterpolateBC7(int32_t e0, int32_t e1, uint32_t index)
+{
+    return ((64 - kBC7Weights4[index]) * e0 + kBC7Weights4[index] * e1 + 32) >> 6;
+}
+
+uint32_t BC7Indices(const float (*points)[4], BC7Endpoints const& ep, uint8_t* out_indices)
+{
+    int32_t endpoints[2][4];
+    ExpandBC7(ep, endpoints);
+
+    int32_t palette[16][4];
+    for (uint32_t i = 0; i != 16; ++i)
+    {
+        for (uint32_t c = 0; c != 4; ++c)
+            palette[i][c] = InterpolateBC7(endpoints[0][c], endpoints[1][c], i);
+    }
+
+    // Project onto the endpoint segment for a first guess, then check its neighbours
+    float axis[4];
+    float lengthSq = 0.0f;
+    for (uint32_t c = 0; c != 4; ++c)
+    {
+        axis[c] = (float)(endpoints[1][c] - endpoints[0][c]);
+        lengthSq += axis[c] * axis[c];
+    }
+
+    uint32_t total = 0;
+    for (uint32_t i = 0; i != 16; ++i)
+    {
+        float t = 0.0f;
+        if (lengthSq > 0.0f)
+        {
+            for (uint32_t c = 0; c != 4; ++c)
+                t += (points[i][c] - endpoints[0][c]) * axis[c];
+            t /= lengthSq;
+        }
+
+        const int32_t guess = (int32_t)(std::min(1.0f, std::max(0.0f, t)) * 15.0f + 0.5f);
+        uint32_t best = UINT32_MAX;
+        for (int32_t p = std::max(0, guess - 1); p <= std::min(15, guess + 1); ++p)
+        {
+            uint32_t error = 0;
+            for (uint32_t c = 0; c != 4; ++c)
+            {
+                const int32_t d = (int32_t)points[i][c] - palette[p][c];
+                error += (uint32_t)(d * d);
+            }
+            if (error < best)
+            {
+                best = error;
+                out_indices[i] = (uint8_t)p;
+            }
+        }
+        total += best;
+    }
+    return total;
+}
+
+// Each endpoint takes whichever p-bit lands its channels closest to the float endpoint.
+// Far cheaper than re-running the index search for all four combinations, for ~0.1 dB.
+uint32_t QuantizeBC7(const float (*points)[4], const float* e0, const float* e1, BC7Endpoints& out_ep, uint8_t* out_indices)
+{
+    const float* endpoints[2] = { e0, e1 };
+    for (uint32_t e = 0; e != 2; ++e)
+    {
+        float bestError = INFINITY;
+        for (uint8_t pbit = 0; pbit != 2; ++pbit)
+        {
+            uint8_t quantized[4];
+            float error = 0.0f;
+            for (uint32_t c = 0; c != 4; ++c)
+            {
+                quantized[c] = (uint8_t)std::min(127.0f, std::max(0.0f, roundf((endpoints[e][c] - pbit) / 2.0f)));
+                const float d = (float)((quantized[c] << 1) | pbit) - endpoints[e][c];
+                error += d * d;
+            }
+
+            if (error < bestError)
+            {
+                bestError = error;
+                out_ep.PBits[e] = pbit;
+                memcpy(out_ep.Quantized[e], quantized, 4);
+            }
+        }
+    }
+
+    return BC7Indices(points, out_ep, out_indices);
+}
+
+}
+
+void EncodeBC1(const uint8_t* pBlock, uint8_t* pOut)
+{
+    EncodeColorBlock(pBlock, pOut);
+}
+
+void EncodeBC3(const uint8_t* pBlock, uint8_t* pOut)
+{
+    EncodeSingleChannel(pBlock, 3, pOut);
+    EncodeColorBlock(pBlock, pOut + 8);
+}
+
+void EncodeBC4(const uint8_t* pBlock, uint32_t channel, uint8_t* pOut)
+{
+    EncodeSingleChannel(pBlock, channel, pOut);
+}
+
+void EncodeBC5(const uint8_t* pBlock, uint8_t* pOut)
+{
+    EncodeSingleChannel(pBlock, 0, pOut);
+    EncodeSingleChannel(pBlock, 1, pOut + 8);
+}
+
+void EncodeBC7(const uint8_t* pBlock, uint8_t* pOut)
+{
+    float points[16][4];
+    for (uint32_t i = 0; i != 16; ++i)
+    {
+        for (uint32_t c = 0; c != 4; ++c)
+            points[i][c] = pBlock[i * 4 + c];
+    }
+
+    float e0[4];
+    float e1[4];
+    FitEndpoints<4>(points, e0, e1);
+
+    BC7Endpoints ep;
+    uint8_t indices[16];
+    uint32_t error = QuantizeBC7(points, e0, e1, ep, indices);
+
+    for (uint32_t iteration = 0; iteration != kRefineIterations && error; ++iteration)
+    {
+        float weights[16];
+        for (uint32_t i = 0; i != 16; ++i)
+            weights[i] = kBC7Weights4[indices[i]] / 64.0f;
+
+        if (!SolveEndpoints<4>(points, weights, e0, e1))
+            break;
+
+        BC7Endpoints candidate;
+        uint8_t candidateIndices[16];
+        const uint32_t candidateError = QuantizeBC7(points, e0, e1, candidate, candidateIndices);
+        if (candidateError >= error)
+            break;
+
+        ep = candidate;
+        error = candidateError;
+        memcpy(indices, candidateIndices, sizeof(indices));
+    }
+
+    // The first texel's index has an implied 0 top bit, so flip the block around if it needs one
+    if (indices[0] & 8)
+    {
+        for (uint32_t c = 0; c != 4; ++c)
+            std::swap(ep.Quantized[0][c], ep.Quantized[1][c]);
+        std::swap(ep.PBits[0], ep.PBits[1]);
+        for (uint8_t& index : indices)
+            index = 15 - index;
+    }
+
+    memset(pOut, 0, 16);
+    BitWriter bits = { pOut, 0 };
+    bits.Write(1 << 6, 7);
+    for (uint32_t c = 0; c != 4; ++c)
+    {
+        bits.Write(ep.Quantized[0][c], 7);
+        bits.Write(ep.Quantized[1][c], 7);
+    }
+    bits.Write(ep.PBits[0], 1);
+    bits.Write(ep.PBits[1], 1);
+    bits.Write(indices[0], 3);
+    for (uint32_t i = 1; i != 16; ++i)
+        bits.Write(indices[i], 4);
+}
+
+bool DecodeBlock(DDSFormat format, const uint8_t* pIn, uint8_t* pOut)
+{
+    memset(pOut, 0, 64);
+    for (uint32_t i = 0; i != 16; ++i)
+        pOut[i * 4 + 3] = 255;
+
+    switch (format)
+    {
+    case DDSFormat::BC1_UNORM:
+    case DDSFormat::BC1_UNORM_SRGB:
+        DecodeColorBlock(pIn, pOut, true);
+        return true;
+    case DDSFormat::BC3_UNORM:
+    case DDSFormat::BC3_UNORM_SRGB:
+        DecodeColorBlock(pIn + 8, pOut, false);
+        DecodeSingleChannel(pIn, 3, pOut);
+        return true;
+    case DDSFormat::BC4_UNORM:
+        DecodeSingleChannel(pIn, 0, pOut);
+        return true;
+    case DDSFormat::BC5_UNORM:
+        DecodeSingleChannel(pIn, 0, pOut);
+        DecodeSingleChannel(pIn + 8, 1, pOut);
+        return true;
+    case DDSFormat::BC7_UNORM:
+    case DDSFormat::BC7_UNORM_SRGB:
+    {
+        BitReader bits = { pIn, 0 };
+        if (bits.Read(7) != (1 << 6))
+            return false;
+
+        BC7Endpoints ep;
+        for (uint32_t c = 0; c != 4; ++c)
+        {
+            ep.Quantized[0][c] = (uint8_t)bits.Read(7);
+            ep.Quantized[1][c] = (uint8_t)bits.Read(7);
+        }
+        ep.PBits[0] = (uint8_t)bits.Read(1);
+        ep.PBits[1] = (uint8_t)bits.Read(1);
+
+        int32_t endpoints[2][4];
+        ExpandBC7(ep, endpoints);
+        for (uint32_t i = 0; i != 16; ++i)
+        {
+            const uint32_t index = bits.Read(i ? 4 : 3);
+            for (uint32_t c = 0; c != 4; ++c)
+                pOut[i * 4 + c] = (uint8_t)InterpolateBC7(endpoints[0][c], endpoints[1][c], index);
+        }
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+void CompressRows(DDSFormat format, const uint8_t* pRGBA, uint32_t width, uint32_t height, uint32_t rowBegin, uint32_t rowEnd, uint8_t* pOut)
+{
+    const uint32_t elementSize = Renderer::GetDDSElementSize(format);
+
+    if (!Renderer::IsBlockCompressed(format))
+    {
+        // Rows are texel rows here; keep the leading channels
+        for (uint32_t y = rowBegin; y != rowEnd; ++y)
+        {
+            for (uint32_t x = 0; x != width; ++x)
+            {
+                const size_t texel = (size_t)y * width + x;
+                memcpy(pOut + texel * elementSize, pRGBA + texel * 4, elementSize);
+            }
+        }
+        return;
+    }
+
+    const uint32_t blocksWide = (width + 3) / 4;
+    uint8_t block[64];
+    for (uint32_t by = rowBegin; by != rowEnd; ++by)
+    {
+        for (uint32_t bx = 0; bx != blocksWide; ++bx)
+        {
+            for (uint32_t i = 0; i != 16; ++i)
+            {
+                const uint32_t x = std::min(bx * 4 + i % 4, width - 1);
+                const uint32_t y = std::min(by * 4 + i / 4, height - 1);
+                memcpy(block + i * 4, pRGBA + ((size_t)y * width + x) * 4, 4);
+            }
+
+            uint8_t* pBlockOut = pOut + ((size_t)by * blocksWide + bx) * elementSize;
+            switch (format)
+            {
+            case DDSFormat::BC1_UNORM:
+            case DDSFormat::BC1_UNORM_SRGB: EncodeBC1(block, pBlockOut); break;
+            case DDSFormat::BC3_UNORM:
+            case DDSFormat::BC3_UNORM_SRGB: EncodeBC3(block, pBlockOut); break;
+            case DDSFormat::BC4_UNORM:      EncodeBC4(block, 0, pBlockOut); break;
+            case DDSFormat::BC5_UNORM:      EncodeBC5(block, pBlockOut); break;
+            case DDSFormat::BC7_UNORM:
+            case DDSFormat::BC7_UNORM_SRGB: EncodeBC7(block, pBlockOut); break;
+            default: break;
+            }
+        }
+    }
+}
+
+void CompressSurface(DDSFormat format, const uint8_t* pRGBA, uint32_t width, uint32_t height, std::vector<uint8_t>& out_bytes)
+{
+    out_bytes.assign(Renderer::GetDDSSurfaceSize(format, width, height), 0);
+    const uint32_t rows = Renderer::IsBlockCompressed(format) ? (height + 3) / 4 : height;
+
+    uint8_t* pOut = out_bytes.data();
+    Core::JobCounter counter;
+    Core::JobSystem::Dispatch(counter, rows, kRowsPerJob, [=](uint32_t begin, uint32_t end)
+    {
+        CompressRows(format, pRGBA, width, height, begin, end, pOut);
+    });
+    Core::JobSystem::Wait(counter);
+}
+
+bool DecompressSurface(DDSFormat format, const uint8_t* pData, uint32_t width, uint32_t height, std::vector<uint8_t>& out_rgba)
+{
+    out_rgba.assign((size_t)width * height * 4, 0);
+    const uint32_t blocksWide = (width + 3) / 4;
+    const uint32_t blocksHigh = (height + 3) / 4;
+    const uint32_t elementSize = Renderer::GetDDSElementSize(format);
+
+    uint8_t block[64];
+    for (uint32_t by = 0; by != blocksHigh; ++by)
+    {
+        for (uint32_t bx = 0; bx != blocksWide; ++bx)
+        {
+            if (!DecodeBlock(format, pData + ((size_t)by * blocksWide + bx) * elementSize, block))
+                return false;
+
+            for (uint32_t i = 0; i != 16; ++i)
+            {
+                const uint32_t x = bx * 4 + i % 4;
+                const uint32_t y = by * 4 + i / 4;
+                if (x < width && y < height)
+                    memcpy(out_rgba.data() + ((size_t)y * width + x) * 4, block + i * 4, 4);
+            }
+        }
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,42 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : BC1/BC3/BC4/BC5/BC7 block encoders, plus decoders for measuring their error
+Blocks are 4x4 RGBA texels, row major, 64 bytes.
+BC1 fits endpoints along the principal axis of the block's colors, then refines them
+by least squares against the chosen indices. BC4 tries both the 8 value and the
+6 value + 0/255 palettes. BC7 only uses mode 6 (one subset, 7.7.7.7 endpoints with
+p-bits, 4-bit indices), which covers opaque and alpha textures with one encoder.
+----------------------------------------------*/
+#ifndef TEXTURECOOKER_BLOCKCOMPRESSION_H
+#define TEXTURECOOKER_BLOCKCOMPRESSION_H
+
+#include <Muon/Renderer/DDSFile.h>
+
+#include <stdint.h>
+#include <vector>
+
+namespace TextureCooker {
+
+void EncodeBC1(const uint8_t* pBlock, uint8_t* pOut);
+void EncodeBC3(const uint8_t* pBlock, uint8_t* pOut);
+void EncodeBC4(const uint8_t* pBlock, uint32_t channel, uint8_t* pOut);   // Encodes one channel
+void EncodeBC5(const uint8_t* pBlock, uint8_t* pOut);                     // R and G
+void EncodeBC7(const uint8_t* pBlock, uint8_t* pOut);
+
+// Writes 64 bytes of RGBA. Channels a format doesn't store come back as 0 (alpha as 255).
+// Returns false for BC7 blocks in modes other than 6, which the encoder never writes.
+bool DecodeBlock(Renderer::DDSFormat format, const uint8_t* pIn, uint8_t* pOut);
+
+// Encodes (or for uncompressed formats, packs) the block rows [rowBegin, rowEnd) of an RGBA surface into pOut,
+// which holds the whole surface. Blocks hanging off the edge repeat the last row and column.
+void CompressRows(Renderer::DDSFormat format, const uint8_t* pRGBA, uint32_t width, uint32_t height, uint32_t rowBegin, uint32_t rowEnd, uint8_t* pOut);
+
+// The whole surface, spread over the job system
+void CompressSurface(Renderer::DDSFormat format, const uint8_t* pRGBA, uint32_t width, uint32_t height, std::vector<uint8_t>& out_bytes);
+
+// Decodes a compressed surface back to RGBA
+bool DecompressSurface(Renderer::DDSFormat format, const uint8_t* pData, uint32_t width, uint32_t height, std::vector<uint8_t>& out_rgba);
+
+}
+#endif
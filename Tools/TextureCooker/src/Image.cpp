@@ -0,0 +1,32 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of Image.h (decoders are in PngDecoder.cpp and JpegDecoder.cpp)
+----------------------------------------------*/
+#include "Image.h"
+
+namespace TextureCooker {
+
+bool Image::HasAlpha() const
+{
+    for (size_t i = 3; i < Pixels.size(); i += 4)
+    {
+        if (Pixels[i] != 255)
+            return true;
+    }
+    return false;
+}
+
+bool DecodeImage(std::string const& bytes, Image& out_image, std::string& out_error)
+{
+    const uint8_t* pData = (const uint8_t*)bytes.data();
+    if (bytes.size() >= 8 && pData[0] == 0x89 && pData[1] == 'P')
+        return DecodePng(pData, bytes.size(), out_image, out_error);
+    if (bytes.size() >= 2 && pData[0] == 0xFF && pData[1] == 0xD8)
+        return DecodeJpeg(pData, bytes.size(), out_image, out_error);
+
+    out_error = "not a PNG or JPEG";
+    return false;
+}
+
+}
@@ -0,0 +1,34 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Decoded source images. Everything is expanded to 8-bit RGBA
+so the rest of the cooker only deals with one layout.
+Supports PNG (8 and 16 bit, any color type, not interlaced) and
+JPEG (baseline and progressive, greyscale or YCbCr, any chroma subsampling).
+----------------------------------------------*/
+#ifndef TEXTURECOOKER_IMAGE_H
+#define TEXTURECOOKER_IMAGE_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace TextureCooker {
+
+struct Image
+{
+    uint32_t             Width  = 0;
+    uint32_t             Height = 0;
+    std::vector<uint8_t> Pixels;        // RGBA, rows top to bottom
+
+    bool HasAlpha() const;
+};
+
+// Picks the decoder from the file signature
+bool DecodeImage(std::string const& bytes, Image& out_image, std::string& out_error);
+
+bool DecodePng(const uint8_t* pData, size_t size, Image& out_image, std::string& out_error);
+bool DecodeJpeg(const uint8_t* pData, size_t size, Image& out_image, std::string& out_error);
+
+}
+#endif
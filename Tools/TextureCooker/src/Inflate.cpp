@@ -0,0 +1,368 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of Inflate.h
+----------------------------------------------*/
+#include "Inflate.h"
+
+#include <string.h>
+
+namespace TextureCooker {
+
+namespace {
+
+const uint16_t kLengthBase[29]  = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+const uint8_t  kLengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+const uint16_t kDistBase[30]    = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+const uint8_t  kDistExtra[30]   = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+const uint8_t  kCodeLengthOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+const uint32_t kFastBits = 9;
+
+// Canonical Huffman decoding. Codes up to kFastBits long resolve with one table lookup,
+// longer ones fall back to walking the code lengths.
+struct Huffman
+{
+    uint16_t Fast[1 << kFastBits];      // (length << 12) | symbol, 0 when the code is longer
+    uint16_t FirstCode[17];
+    uint16_t FirstSymbol[17];
+    uint16_t Count[17];
+    uint16_t Symbols[288];
+
+    bool Build(const uint8_t* lengths, uint32_t count)
+    {
+        memset(Fast, 0, sizeof(Fast));
+        memset(Count, 0, sizeof(Count));
+        for (uint32_t i = 0; i != count; ++i)
+            Count[lengths[i]]++;
+        Count[0] = 0;
+
+        uint16_t offsets[17];
+        uint32_t code = 0;
+        uint32_t symbol = 0;
+        for (uint32_t len = 1; len <= 16; ++len)
+        {
+            FirstCode[len]   = (uint16_t)code;
+            FirstSymbol[len] = (uint16_t)symbol;
+            offsets[len]     = (uint16_t)symbol;
+            code = (code + Count[len]) << 1;
+            symbol += Count[len];
+
+            // Oversubscribed
+            if (Count[len] && FirstCode[len] + Count[len] > (1u << len))
+                return false;
+        }
+
+        for (uint32_t i = 0; i != count; ++i)
+        {
+            const uint32_t len = lengths[i];
+            if (!len)
+                continue;
+
+            const uint32_t index = offsets[len]++;
+            Symbols[index] = (uint16_t)i;
+
+            if (len <= kFastBits)
+            {
+                // The stream is read LSB first, so the table is indexed by the bit-reversed code
+                const uint32_t codeValue = FirstCode[len] + (index - FirstSymbol[len]);
+                uint32_t reversed = 0;
+                for (uint32_t b = 0; b != len; ++b)
+                    reversed |= ((codeValue >> b) & 1) << (len - 1 - b);
+
+                for (uint32_t fill = reversed; fill < (1u << kFastBits); fill += 1u << len)
+                    Fast[fill] = (uint16_t)((len << 12) | i);
+            }
+        }
+
+        return true;
+    }
+};
+
+struct BitReader
+{
+    const uint8_t* Data;
+    size_t         Size;
+    size_t         Offset;
+    uint64_t       Bits;
+    uint32_t       BitCount;
+    bool           Overrun;
+
+    void Refill()
+    {
+        while (BitCount <= 56)
+        {
+            // Past the end reads zeros; Overrun is only set once those bits are actually consumed
+            const uint64_t byte = Offset < Size ? Data[Offset] : 0;
+            Offset++;
+            Bits |= byte << BitCount;
+            BitCount += 8;
+        }
+    }
+
+    uint32_t Peek(uint32_t count)
+    {
+        if (BitCount < count)
+            Refill();
+        return (uint32_t)(Bits & ((1ull << count) - 1));
+    }
+
+    void Consume(uint32_t count)
+    {
+        Bits >>= count;
+        BitCount -= count;
+        if (Offset > Size && (Offset - Size) * 8 > BitCount)
+            Overrun = true;
+    }
+
+    uint32_t Read(uint32_t count)
+    {
+        if (!count)
+            return 0;
+        const uint32_t value = Peek(count);
+        Consume(count);
+        return value;
+    }
+
+    void AlignToByte()
+    {
+        Consume(BitCount & 7);
+    }
+
+    int Decode(Huffman const& h)
+    {
+        const uint32_t fast = h.Fast[Peek(kFastBits)];
+        if (fast)
+        {
+            Consume(fast >> 12);
+            return fast & 0xFFF;
+        }
+
+        // Slow path: grow the code one bit at a time, MSB first
+        Peek(16);
+        uint32_t code = 0;
+        for (uint32_t len = 1; len <= 16; ++len)
+        {
+            code |= (uint32_t)((Bits >> (len - 1)) & 1);
+            const uint32_t first = h.FirstCode[len];
+            if (code - first < h.Count[len])
+            {
+                Consume(len);
+                return h.Symbols[h.FirstSymbol[len] + (code - first)];
+            }
+            code <<= 1;
+        }
+        return -1;
+    }
+};
+
+void BuildFixedTables(Huffman& litLen, Huffman& dist)
+{
+    uint8_t lengths[288];
+    memset(lengths, 8, 144);
+    memset(lengths + 144, 9, 112);
+    memset(lengths + 256, 7, 24);
+    memset(lengths + 280, 8, 8);
+    litLen.Build(lengths, 288);
+
+    memset(lengths, 5, 30);
+    dist.Build(lengths, 30);
+}
+
+bool ReadDynamicTables(BitReader& bits, Huffman& litLen, Huffman& dist, std::string& out_error)
+{
+    const uint32_t litCount  = bits.Read(5) + 257;
+    const uint32_t distCount = bits.Read(5) + 1;
+    const uint32_t codeCount = bits.Read(4) + 4;
+
+    uint8_t codeLengths[19] = {};
+    for (uint32_t i = 0; i != codeCount; ++i)
+        codeLengths[kCodeLengthOrder[i]] = (uint8_t)bits.Read(3);
+
+    Huffman codeLengthTable;
+    if (!codeLengthTable.Build(codeLengths, 19))
+    {
+        out_error = "bad code length table";
+        return false;
+    }
+
+    uint8_t lengths[286 + 30] = {};
+    uint32_t n = 0;
+    while (n < litCount + distCount)
+    {
+        const int symbol = bits.Decode(codeLengthTable);
+        if (symbol < 0)
+        {
+            out_error = "bad code length";
+            return false;
+        }
+
+        if (symbol < 16)
+        {
+            lengths[n++] = (uint8_t)symbol;
+            continue;
+        }
+
+        uint8_t  value = 0;
+        uint32_t repeat = 0;
+        if (symbol == 16)
+        {
+            if (!n)
+            {
+                out_error = "repeat with no previous length";
+                return false;
+            }
+            value  = lengths[n - 1];
+            repeat = 3 + bits.Read(2);
+        }
+        else if (symbol == 17)
+            repeat = 3 + bits.Read(3);
+        else
+            repeat = 11 + bits.Read(7);
+
+        if (n + repeat > litCount + distCount)
+        {
+            out_error = "code lengths overflow";
+            return false;
+        }
+        memset(lengths + n, value, repeat);
+        n += repeat;
+    }
+
+    if (!litLen.Build(lengths, litCount) || !dist.Build(lengths + litCount, distCount))
+    {
+        out_error = "bad huffman table";
+        return false;
+    }
+
+    return true;
+}
+
+bool InflateBlock(BitReader& bits, Huffman const& litLen, Huffman const& dist, std::vector<uint8_t>& out, std::string& out_error)
+{
+    for (;;)
+    {
+        const int symbol = bits.Decode(litLen);
+        if (symbol < 0 || bits.Overrun)
+        {
+            out_error = "bad literal/length code";
+            return false;
+        }
+
+        if (symbol < 256)
+        {
+            out.push_back((uint8_t)symbol);
+            continue;
+        }
+
+        if (symbol == 256)
+            return true;
+
+        const uint32_t lengthIndex = (uint32_t)symbol - 257;
+        if (lengthIndex >= 29)
+        {
+            out_error = "bad length symbol";
+            return false;
+        }
+        const uint32_t length = kLengthBase[lengthIndex] + bits.Read(kLengthExtra[lengthIndex]);
+
+        const int distSymbol = bits.Decode(dist);
+        if (distSymbol < 0 || distSymbol >= 30)
+        {
+            out_error = "bad distance code";
+            return false;
+        }
+        const uint32_t distance = kDistBase[distSymbol] + bits.Read(kDistExtra[distSymbol]);
+        if (distance > out.size())
+        {
+            out_error = "distance reaches before the start of the stream";
+            return false;
+        }
+
+        // Byte by byte, since the copy may overlap what it's writing
+        size_t from = out.size() - distance;
+        for (uint32_t i = 0; i != length; ++i)
+            out.push_back(out[from++]);
+    }
+}
+
+}
+
+bool InflateZlib(const uint8_t* pData, size_t size, std::vector<uint8_t>& out_data, std::string& out_error)
+{
+    if (size < 6 || (pData[0] & 0x0F) != 8 || ((pData[0] << 8) | pData[1]) % 31 != 0 || (pData[1] & 0x20))
+    {
+        out_error = "not a zlib stream";
+        return false;
+    }
+
+    BitReader bits = { pData + 2, size - 2, 0, 0, 0, false };
+    const size_t start = out_data.size();
+
+    Huffman litLen;
+    Huffman dist;
+    bool last = false;
+    while (!last)
+    {
+        last = bits.Read(1) != 0;
+        const uint32_t type = bits.Read(2);
+
+        if (type == 0)
+        {
+            bits.AlignToByte();
+            const uint32_t len  = bits.Read(16);
+            const uint32_t nlen = bits.Read(16);
+            if ((len ^ 0xFFFF) != nlen)
+            {
+                out_error = "stored block length mismatch";
+                return false;
+            }
+
+            for (uint32_t i = 0; i != len; ++i)
+                out_data.push_back((uint8_t)bits.Read(8));
+        }
+        else if (type == 1)
+        {
+            BuildFixedTables(litLen, dist);
+            if (!InflateBlock(bits, litLen, dist, out_data, out_error))
+                return false;
+        }
+        else if (type == 2)
+        {
+            if (!ReadDynamicTables(bits, litLen, dist, out_error) || !InflateBlock(bits, litLen, dist, out_data, out_error))
+                return false;
+        }
+        else
+        {
+            out_error = "reserved block type";
+            return false;
+        }
+
+        if (bits.Overrun)
+        {
+            out_error = "truncated stream";
+            return false;
+        }
+    }
+
+    bits.AlignToByte();
+    const uint32_t expected = (bits.Read(8) << 24) | (bits.Read(8) << 16) | (bits.Read(8) << 8) | bits.Read(8);
+
+    uint32_t a = 1;
+    uint32_t b = 0;
+    for (size_t i = start; i != out_data.size(); ++i)
+    {
+        a = (a + out_data[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+
+    if (((b << 16) | a) != expected || bits.Overrun)
+    {
+        out_error = "checksum mismatch";
+        return false;
+    }
+
+    return true;
+}
+
+}
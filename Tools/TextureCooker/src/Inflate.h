@@ -0,0 +1,20 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : zlib (RFC 1950/1951) decompression, enough for PNG image data
+----------------------------------------------*/
+#ifndef TEXTURECOOKER_INFLATE_H
+#define TEXTURECOOKER_INFLATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace TextureCooker {
+
+// Appends the decompressed stream to out_data and checks its Adler-32
+bool InflateZlib(const uint8_t* pData, size_t size, std::vector<uint8_t>& out_data, std::string& out_error);
+
+}
+#endif
@@ -0,0 +1,834 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : JPEG half of Image.h
+Coefficients for the whole image are kept until the last scan, so baseline and
+progressive files go through the same dequantize/IDCT/color convert at the end.
+----------------------------------------------*/
+#include "Image.h"
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+namespace TextureCooker {
+
+namespace {
+
+const uint8_t kZigZag[64] =
+{
+     0,  1,  8, 16,  9,  2,  3, 10,
+    17, 24, 32, 25, 18, 11,  4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34,
+    27, 20, 13,  6,  7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36,
+    29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46,
+    53, 60, 61, 54, 47, 55, 62, 63,
+};
+
+const uint32_t kFastBits = 9;
+
+struct HuffmanTable
+{
+    uint16_t Fast[1 << kFastBits];      // (length << 8) | symbol, 0 when the code is longer
+    int32_t  MaxCode[18];               // Largest code of each length, -1 if none
+    int32_t  ValueOffset[17];           // Symbol index of a code minus the code itself
+    uint8_t  Symbols[256];
+    bool     Defined = false;
+};
+
+struct Component
+{
+    uint8_t  Id;
+    uint8_t  H;
+    uint8_t  V;
+    uint8_t  QuantTable;
+    uint8_t  DCTable;
+    uint8_t  ACTable;
+    uint32_t BlocksWide;                // Padded out to whole MCUs
+    uint32_t BlocksHigh;
+    int32_t  DCPredictor;
+    std::vector<int16_t> Coefficients;  // 64 per block, natural order
+    std::vector<uint8_t> Plane;         // BlocksWide * 8 by BlocksHigh * 8 samples
+};
+
+class JpegDecoder
+{
+public:
+    JpegDecoder(const uint8_t* pData, size_t size) : mData(pData), mSize(size) {}
+
+    bool Decode(Image& out_image, std::string& out_error);
+
+private:
+    bool ReadMarker(uint8_t* out_marker);
+    bool ReadQuantTables(size_t end);
+    bool ReadHuffmanTables(size_t end);
+    bool ReadFrame(size_t end, bool progressive);
+    bool ReadScan(size_t end);
+    bool DecodeScan();
+    bool DecodeBlock(Component& comp, int16_t* pCoefs);
+    void ResetEntropy();
+    void Finish(Image& out_image);
+
+    // Entropy coded data, read MSB first with 0xFF00 unstuffing. Stops at the next marker and feeds zeros after it.
+    void     Fill();
+    uint32_t GetBits(uint32_t count);
+    uint32_t GetBit() { return GetBits(1); }
+    int32_t  Extend(uint32_t value, uint32_t count) const;
+    int      DecodeHuffman(HuffmanTable const& table);
+
+    const uint8_t* mData;
+    size_t         mSize;
+    size_t         mPos = 0;
+    std::string    mError;
+
+    uint16_t       mQuant[4][64] = {};     // Natural order
+    HuffmanTable   mDCTables[4];
+    HuffmanTable   mACTables[4];
+
+    uint32_t       mWidth = 0;
+    uint32_t       mHeight = 0;
+    uint32_t       mMaxH = 1;
+    uint32_t       mMaxV = 1;
+    uint32_t       mMcusWide = 0;
+    uint32_t       mMcusHigh = 0;
+    bool           mProgressive = false;
+    uint32_t       mComponentCount = 0;
+    Component      mComponents[3];
+
+    uint32_t       mRestartInterval = 0;
+
+    // Current scan
+    uint32_t       mScanComponents[3] = {};
+    uint32_t       mScanCount = 0;
+    uint32_t       mSpectralStart = 0;
+    uint32_t       mSpectralEnd = 63;
+    uint32_t       mApproxHigh = 0;
+    uint32_t       mApproxLow = 0;
+    uint32_t       mEobRun = 0;
+
+    uint32_t       mBits = 0;
+    uint32_t       mBitCount = 0;
+    bool           mHitMarker = false;
+};
+
+bool BuildHuffman(HuffmanTable& table, const uint8_t counts[16], const uint8_t* pSymbols)
+{
+    memset(table.Fast, 0, sizeof(table.Fast));
+
+    uint32_t code = 0;
+    uint32_t k = 0;
+    for (uint32_t len = 1; len <= 16; ++len)
+    {
+        table.ValueOffset[len] = (int32_t)k - (int32_t)code;
+        for (uint32_t i = 0; i != counts[len - 1]; ++i, ++k, ++code)
+        {
+            table.Symbols[k] = pSymbols[k];
+            if (len <= kFastBits)
+            {
+                const uint32_t shift = kFastBits - len;
+                for (uint32_t fill = 0; fill != (1u << shift); ++fill)
+                    table.Fast[(code << shift) | fill] = (uint16_t)((len << 8) | pSymbols[k]);
+            }
+        }
+
+        table.MaxCode[len] = counts[len - 1] ? (int32_t)code - 1 : -1;
+        if (code > (1u << len))
+            return false;
+        code <<= 1;
+    }
+    table.MaxCode[17] = INT32_MAX;
+    table.Defined = true;
+    return true;
+}
+
+// Separable float IDCT on dequantized coefficients, then level shift and clamp
+void InverseDCT(const int16_t* pCoefs, const uint16_t* pQuant, uint8_t* pOut, size_t stride)
+{
+    static float s_cosines[8][8];
+    static bool s_initialized = false;
+    if (!s_initialized)
+    {
+        for (uint32_t x = 0; x != 8; ++x)
+        {
+            for (uint32_t u = 0; u != 8; ++u)
+            {
+                const float scale = u ? 0.5f : 0.5f / sqrtf(2.0f);
+                s_cosines[x][u] = scale * cosf((2.0f * x + 1.0f) * u * 3.14159265358979f / 16.0f);
+            }
+        }
+        s_initialized = true;
+    }
+
+    float dequantized[64];
+    for (uint32_t i = 0; i != 64; ++i)
+        dequantized[i] = (float)pCoefs[i] * pQuant[i];
+
+    // Rows, then columns
+    float temp[64];
+    for (uint32_t v = 0; v != 8; ++v)
+    {
+        for (uint32_t x = 0; x != 8; ++x)
+        {
+            float sum = 0.0f;
+            for (uint32_t u = 0; u != 8; ++u)
+                sum += s_cosines[x][u] * dequantized[v * 8 + u];
+            temp[v * 8 + x] = sum;
+        }
+    }
+
+    for (uint32_t y = 0; y != 8; ++y)
+    {
+        for (uint32_t x = 0; x != 8; ++x)
+        {
+            float sum = 0.0f;
+            for (uint32_t v = 0; v != 8; ++v)
+                sum += s_cosines[y][v] * temp[v * 8 + x];
+            pOut[y * stride + x] = (uint8_t)std::min(255.0f, std::max(0.0f, roundf(sum + 128.0f)));
+        }
+    }
+}
+
+uint8_t ClampToByte(float v)
+{
+    return (uint8_t)std::min(255.0f, std::max(0.0f, roundf(v)));
+}
+
+}
+
+void JpegDecoder::Fill()
+{
+    while (mBitCount <= 24)
+    {
+        uint32_t byte = 0;
+        if (!mHitMarker && mPos < mSize)
+        {
+            byte = mData[mPos];
+            if (byte == 0xFF)
+            {
+                const uint8_t next = mPos + 1 < mSize ? mData[mPos + 1] : 0;
+                if (next == 0x00)
+                    mPos += 2;
+                else
+                {
+                    // Leave the marker for the caller
+                    mHitMarker = true;
+                    byte = 0;
+                }
+            }
+            else
+                mPos++;
+        }
+
+        mBits |= byte << (24 - mBitCount);
+        mBitCount += 8;
+    }
+}
+
+uint32_t JpegDecoder::GetBits(uint32_t count)
+{
+    if (!count)
+        return 0;
+    if (mBitCount < count)
+        Fill();
+
+    const uint32_t value = mBits >> (32 - count);
+    mBits <<= count;
+    mBitCount -= count;
+    return value;
+}
+
+int32_t JpegDecoder::Extend(uint32_t value, uint32_t count) const
+{
+    return count && value < (1u << (count - 1)) ? (int32_t)value - (int32_t)(1u << count) + 1 : (int32_t)value;
+}
+
+int JpegDecoder::DecodeHuffman(HuffmanTable const& table)
+{
+    if (mBitCount < 16)
+        Fill();
+
+    const uint16_t fast = table.Fast[mBits >> (32 - kFastBits)];
+    if (fast)
+    {
+        const uint32_t len = fast >> 8;
+        mBits <<= len;
+        mBitCount -= len;
+        return fast & 0xFF;
+    }
+
+    for (uint32_t len = kFastBits + 1; len <= 16; ++len)
+    {
+        const int32_t code = (int32_t)(mBits >> (32 - len));
+        if (code <= table.MaxCode[len])
+        {
+            mBits <<= len;
+            mBitCount -= len;
+            return table.Symbols[code + table.ValueOffset[len]];
+        }
+    }
+
+    return -1;
+}
+
+void JpegDecoder::ResetEntropy()
+{
+    mBits = 0;
+    mBitCount = 0;
+    mHitMarker = false;
+    mEobRun = 0;
+    for (Component& comp : mComponents)
+        comp.DCPredictor = 0;
+}
+
+bool JpegDecoder::ReadMarker(uint8_t* out_marker)
+{
+    // Skip fill bytes and anything left over from the previous scan
+    while (mPos + 1 < mSize)
+    {
+        if (mData[mPos] == 0xFF && mData[mPos + 1] != 0x00 && mData[mPos + 1] != 0xFF)
+        {
+            *out_marker = mData[mPos + 1];
+            mPos += 2;
+            return true;
+        }
+        mPos++;
+    }
+
+    mError = "unexpected end of file";
+    return false;
+}
+
+bool JpegDecoder::ReadQuantTables(size_t end)
+{
+    while (mPos < end)
+    {
+        const uint8_t info = mData[mPos++];
+        const uint32_t precision = info >> 4;
+        const uint32_t id = info & 15;
+        if (id > 3 || precision > 1 || mPos + 64 * (precision + 1) > end)
+        {
+            mError = "bad quantization table";
+            return false;
+        }
+
+        for (uint32_t i = 0; i != 64; ++i)
+        {
+            mQuant[id][kZigZag[i]] = precision ? (uint16_t)((mData[mPos] << 8) | mData[mPos + 1]) : mData[mPos];
+            mPos += precision + 1;
+        }
+    }
+    return true;
+}
+
+bool JpegDecoder::ReadHuffmanTables(size_t end)
+{
+    while (mPos < end)
+    {
+        if (end - mPos < 17)
+        {
+            mError = "bad huffman table";
+            return false;
+        }
+
+        const uint8_t info = mData[mPos++];
+        const uint8_t* pCounts = mData + mPos;
+        mPos += 16;
+
+        uint32_t total = 0;
+        for (uint32_t i = 0; i != 16; ++i)
+            total += pCounts[i];
+
+        const uint32_t id = info & 15;
+        if ((info >> 4) > 1 || id > 3 || total > 256 || mPos + total > end)
+        {
+            mError = "bad huffman table";
+            return false;
+        }
+
+        HuffmanTable& table = (info >> 4) ? mACTables[id] : mDCTables[id];
+        if (!BuildHuffman(table, pCounts, mData + mPos))
+        {
+            mError = "bad huffman table";
+            return false;
+        }
+        mPos += total;
+    }
+    return true;
+}
+
+bool JpegDecoder::ReadFrame(size_t end, bool progressive)
+{
+    if (end - mPos < 6 || mData[mPos] != 8)
+    {
+        mError = "only 8-bit JPEGs are supported";
+        return false;
+    }
+
+    mHeight = (mData[mPos + 1] << 8) | mData[mPos + 2];
+    mWidth  = (mData[mPos + 3] << 8) | mData[mPos + 4];
+    mComponentCount = mData[mPos + 5];
+    mProgressive = progressive;
+    mPos += 6;
+
+    if (!mWidth || !mHeight || (mComponentCount != 1 && mComponentCount != 3) || end - mPos < mComponentCount * 3)
+    {
+        mError = "unsupported JPEG frame (only greyscale and YCbCr)";
+        return false;
+    }
+
+    for (uint32_t i = 0; i != mComponentCount; ++i)
+    {
+        Component& comp = mComponents[i];
+        comp.Id         = mData[mPos];
+        comp.H          = mData[mPos + 1] >> 4;
+        comp.V          = mData[mPos + 1] & 15;
+        comp.QuantTable = mData[mPos + 2];
+        mPos += 3;
+
+        if (!comp.H || comp.H > 4 || !comp.V || comp.V > 4 || comp.QuantTable > 3)
+        {
+            mError = "bad component";
+            return false;
+        }
+        mMaxH = std::max<uint32_t>(mMaxH, comp.H);
+        mMaxV = std::max<uint32_t>(mMaxV, comp.V);
+    }
+
+    mMcusWide = (mWidth + mMaxH * 8 - 1) / (mMaxH * 8);
+    mMcusHigh = (mHeight + mMaxV * 8 - 1) / (mMaxV * 8);
+    for (uint32_t i = 0; i != mComponentCount; ++i)
+    {
+        Component& comp = mComponents[i];
+        comp.BlocksWide = mMcusWide * comp.H;
+        comp.BlocksHigh = mMcusHigh * comp.V;
+        comp.Coefficients.assign((size_t)comp.BlocksWide * comp.BlocksHigh * 64, 0);
+    }
+
+    return true;
+}
+
+bool JpegDecoder::ReadScan(size_t end)
+{
+    mScanCount = mData[mPos++];
+    if (!mScanCount || mScanCount > mComponentCount || end - mPos != mScanCount * 2 + 3)
+    {
+        mError = "bad scan header";
+        return false;
+    }
+
+    for (uint32_t i = 0; i != mScanCount; ++i)
+    {
+        const uint8_t id = mData[mPos];
+        const uint8_t tables = mData[mPos + 1];
+        mPos += 2;
+
+        uint32_t index = 0;
+        while (index != mComponentCount && mComponents[index].Id != id)
+            index++;
+        if (index == mComponentCount || (tables >> 4) > 3 || (tables & 15) > 3)
+        {
+            mError = "scan references an unknown component";
+            return false;
+        }
+
+        mScanComponents[i] = index;
+        mComponents[index].DCTable = tables >> 4;
+        mComponents[index].ACTable = tables & 15;
+    }
+
+    mSpectralStart = mData[mPos];
+    mSpectralEnd   = mData[mPos + 1];
+    mApproxHigh    = mData[mPos + 2] >> 4;
+    mApproxLow     = mData[mPos + 2] & 15;
+    mPos += 3;
+
+    if (mProgressive)
+    {
+        // DC and AC never share a scan, and AC scans cover one component
+        if (mSpectralStart > mSpectralEnd || mSpectralEnd > 63 || (mSpectralStart == 0 && mSpectralEnd != 0) ||
+            (mSpectralStart != 0 && mScanCount != 1) || mApproxLow > 13)
+        {
+            mError = "bad progressive scan";
+            return false;
+        }
+    }
+    else
+    {
+        mSpectralStart = 0;
+        mSpectralEnd = 63;
+        mApproxHigh = mApproxLow = 0;
+    }
+
+    return true;
+}
+
+bool JpegDecoder::DecodeBlock(Component& comp, int16_t* pCoefs)
+{
+    const bool dcScan = mSpectralStart == 0;
+    if (dcScan)
+    {
+        if (mApproxHigh == 0)
+        {
+            HuffmanTable const& dcTable = mDCTables[comp.DCTable];
+            const int t = dcTable.Defined ? DecodeHuffman(dcTable) : -1;
+            if (t < 0 || t > 11)
+            {
+                mError = "bad DC code";
+                return false;
+            }
+
+            comp.DCPredictor += Extend(GetBits(t), t);
+            pCoefs[0] = (int16_t)(comp.DCPredictor * (1 << mApproxLow));
+        }
+        else if (GetBit())
+        {
+            pCoefs[0] = (int16_t)(pCoefs[0] | (1 << mApproxLow));
+        }
+
+        // Baseline blocks carry their AC coefficients right after the DC
+        if (mProgressive)
+            return true;
+    }
+
+    HuffmanTable const& acTable = mACTables[comp.ACTable];
+    if (!acTable.Defined)
+    {
+        mError = "missing AC table";
+        return false;
+    }
+
+    uint32_t k = dcScan ? 1 : mSpectralStart;
+    const uint32_t end = mSpectralEnd;
+
+    if (mApproxHigh == 0 || !mProgressive)
+    {
+        if (mEobRun)
+        {
+            mEobRun--;
+            return true;
+        }
+
+        while (k <= end)
+        {
+            const int rs = DecodeHuffman(acTable);
+            if (rs < 0)
+            {
+                mError = "bad AC code";
+                return false;
+            }
+
+            const uint32_t r = (uint32_t)rs >> 4;
+            const uint32_t s = (uint32_t)rs & 15;
+            if (!s)
+            {
+                if (r < 15)
+                {
+                    // End of block, or of this many blocks in a progressive scan
+                    mEobRun = (1u << r) - 1;
+                    if (r)
+                        mEobRun += GetBits(r);
+                    break;
+                }
+                k += 16;
+                continue;
+            }
+
+            k += r;
+            if (k > 63)
+            {
+                mError = "AC coefficient out of range";
+                return false;
+            }
+            pCoefs[kZigZag[k]] = (int16_t)(Extend(GetBits(s), s) * (1 << mApproxLow));
+            k++;
+        }
+        return true;
+    }
+
+    // Successive approximation refinement of AC coefficients (see libjpeg's decode_mcu_AC_refine)
+    const int32_t plus  = 1 << mApproxLow;
+    const int32_t minus = -1 * (1 << mApproxLow);
+    auto refine = [&](int16_t& coef)
+    {
+        if (GetBit() && (coef & plus) == 0)
+            coef = (int16_t)(coef + (coef >= 0 ? plus : minus));
+    };
+
+    if (!mEobRun)
+    {
+        for (; k <= end; ++k)
+        {
+            const int rs = DecodeHuffman(acTable);
+            if (rs < 0)
+            {
+                mError = "bad AC code";
+                return false;
+            }
+
+            int32_t r = rs >> 4;
+            int32_t value = 0;
+            if (rs & 15)
+                value = GetBit() ? plus : minus;
+            else if (r != 15)
+            {
+                mEobRun = 1u << r;
+                if (r)
+                    mEobRun += GetBits(r);
+                break;
+            }
+
+            // Skip r zero coefficients, refining the nonzero ones passed on the way
+            while (k <= end)
+            {
+                int16_t& coef = pCoefs[kZigZag[k]];
+                if (coef)
+                    refine(coef);
+                else if (--r < 0)
+                    break;
+                k++;
+            }
+
+            if (value && k <= end)
+                pCoefs[kZigZag[k]] = (int16_t)value;
+        }
+    }
+
+    if (mEobRun)
+    {
+        for (; k <= end; ++k)
+        {
+            int16_t& coef = pCoefs[kZigZag[k]];
+            if (coef)
+                refine(coef);
+        }
+        mEobRun--;
+    }
+
+    return true;
+}
+
+bool JpegDecoder::DecodeScan()
+{
+    ResetEntropy();
+
+    // A single component scan walks that component's own blocks, not whole MCUs
+    uint32_t unitsWide = mMcusWide;
+    uint32_t unitsHigh = mMcusHigh;
+    if (mScanCount == 1)
+    {
+        Component const& comp = mComponents[mScanComponents[0]];
+        unitsWide = ((mWidth * comp.H + mMaxH - 1) / mMaxH + 7) / 8;
+        unitsHigh = ((mHeight * comp.V + mMaxV - 1) / mMaxV + 7) / 8;
+    }
+
+    uint32_t untilRestart = mRestartInterval;
+    for (uint32_t uy = 0; uy != unitsHigh; ++uy)
+    {
+        for (uint32_t ux = 0; ux != unitsWide; ++ux)
+        {
+            for (uint32_t c = 0; c != mScanCount; ++c)
+            {
+                Component& comp = mComponents[mScanComponents[c]];
+                const uint32_t h = mScanCount == 1 ? 1 : comp.H;
+                const uint32_t v = mScanCount == 1 ? 1 : comp.V;
+
+                for (uint32_t by = 0; by != v; ++by)
+                {
+                    for (uint32_t bx = 0; bx != h; ++bx)
+                    {
+                        const size_t block = (size_t)(uy * v + by) * comp.BlocksWide + (ux * h + bx);
+                        if (!DecodeBlock(comp, comp.Coefficients.data() + block * 64))
+                            return false;
+                    }
+                }
+            }
+
+            if (mRestartInterval && --untilRestart == 0 && (uy != unitsHigh - 1 || ux != unitsWide - 1))
+            {
+                // The marker should be the next thing in the stream
+                uint8_t marker = 0;
+                if (!ReadMarker(&marker) || marker < 0xD0 || marker > 0xD7)
+                {
+                    mError = "missing restart marker";
+                    return false;
+                }
+                ResetEntropy();
+                untilRestart = mRestartInterval;
+            }
+        }
+    }
+
+    return true;
+}
+
+void JpegDecoder::Finish(Image& out_image)
+{
+    for (uint32_t i = 0; i != mComponentCount; ++i)
+    {
+        Component& comp = mComponents[i];
+        const size_t stride = (size_t)comp.BlocksWide * 8;
+        comp.Plane.resize(stride * comp.BlocksHigh * 8);
+
+        for (uint32_t by = 0; by != comp.BlocksHigh; ++by)
+        {
+            for (uint32_t bx = 0; bx != comp.BlocksWide; ++bx)
+            {
+                const int16_t* pCoefs = comp.Coefficients.data() + ((size_t)by * comp.BlocksWide + bx) * 64;
+                InverseDCT(pCoefs, mQuant[comp.QuantTable], comp.Plane.data() + by * 8 * stride + bx * 8, stride);
+            }
+        }
+        comp.Coefficients.clear();
+        comp.Coefficients.shrink_to_fit();
+    }
+
+    out_image.Width  = mWidth;
+    out_image.Height = mHeight;
+    out_image.Pixels.resize((size_t)mWidth * mHeight * 4);
+
+    // Subsampled components are upsampled bilinearly, with sample centers lined up
+    auto sample = [this](Component const& comp, uint32_t x, uint32_t y) -> float
+    {
+        const size_t stride = (size_t)comp.BlocksWide * 8;
+        if (comp.H == mMaxH && comp.V == mMaxV)
+            return comp.Plane[y * stride + x];
+
+        const uint32_t planeW = (mWidth * comp.H + mMaxH - 1) / mMaxH;
+        const uint32_t planeH = (mHeight * comp.V + mMaxV - 1) / mMaxV;
+        const float fx = std::max(0.0f, (x + 0.5f) * comp.H / mMaxH - 0.5f);
+        const float fy = std::max(0.0f, (y + 0.5f) * comp.V / mMaxV - 0.5f);
+        const uint32_t x0 = std::min((uint32_t)fx, planeW - 1);
+        const uint32_t y0 = std::min((uint32_t)fy, planeH - 1);
+        const uint32_t x1 = std::min(x0 + 1, planeW - 1);
+        const uint32_t y1 = std::min(y0 + 1, planeH - 1);
+        const float tx = fx - x0;
+        const float ty = fy - y0;
+
+        const float top    = comp.Plane[y0 * stride + x0] * (1 - tx) + comp.Plane[y0 * stride + x1] * tx;
+        const float bottom = comp.Plane[y1 * stride + x0] * (1 - tx) + comp.Plane[y1 * stride + x1] * tx;
+        return top * (1 - ty) + bottom * ty;
+    };
+
+    for (uint32_t y = 0; y != mHeight; ++y)
+    {
+        uint8_t* pOut = out_image.Pixels.data() + (size_t)y * mWidth * 4;
+        for (uint32_t x = 0; x != mWidth; ++x, pOut += 4)
+        {
+            const float luma = sample(mComponents[0], x, y);
+            if (mComponentCount == 1)
+            {
+                pOut[0] = pOut[1] = pOut[2] = ClampToByte(luma);
+            }
+            else
+            {
+                const float cb = sample(mComponents[1], x, y) - 128.0f;
+                const float cr = sample(mComponents[2], x, y) - 128.0f;
+                pOut[0] = ClampToByte(luma + 1.402f * cr);
+                pOut[1] = ClampToByte(luma - 0.344136f * cb - 0.714136f * cr);
+                pOut[2] = ClampToByte(luma + 1.772f * cb);
+            }
+            pOut[3] = 255;
+        }
+    }
+}
+
+bool JpegDecoder::Decode(Image& out_image, std::string& out_error)
+{
+    uint8_t marker = 0;
+    if (mSize < 4 || mData[0] != 0xFF || mData[1] != 0xD8)
+    {
+        out_error = "not a JPEG";
+        return false;
+    }
+    mPos = 2;
+
+    bool haveFrame = false;
+    for (;;)
+    {
+        if (!ReadMarker(&marker))
+            break;
+
+        if (marker == 0xD9)
+        {
+            if (!haveFrame)
+                mError = "no image in file";
+            break;
+        }
+
+        if (mSize - mPos < 2)
+        {
+            mError = "truncated segment";
+            break;
+        }
+        const size_t length = (mData[mPos] << 8) | mData[mPos + 1];
+        const size_t end = mPos + length;
+        if (length < 2 || end > mSize)
+        {
+            mError = "truncated segment";
+            break;
+        }
+        mPos += 2;
+
+        bool ok = true;
+        switch (marker)
+        {
+        case 0xDB:
+            ok = ReadQuantTables(end);
+            break;
+        case 0xC4:
+            ok = ReadHuffmanTables(end);
+            break;
+        case 0xDD:
+            mRestartInterval = length >= 4 ? (mData[mPos] << 8) | mData[mPos + 1] : 0;
+            break;
+        case 0xC0:
+        case 0xC1:
+        case 0xC2:
+            ok = !haveFrame && ReadFrame(end, marker == 0xC2);
+            if (ok)
+                haveFrame = true;
+            else if (mError.empty())
+                mError = "more than one frame";
+            break;
+        case 0xDA:
+            if (!haveFrame)
+                mError = "scan before frame";
+            ok = haveFrame && ReadScan(end) && DecodeScan();
+
+            // The entropy coded data runs on past the header, up to the next marker
+            if (ok)
+                continue;
+            break;
+        default:
+            // SOF3 and up are lossless, hierarchical or arithmetic coded
+            if (marker >= 0xC3 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC)
+            {
+                mError = "unsupported JPEG coding process";
+                ok = false;
+            }
+            break;
+        }
+
+        if (!ok)
+            break;
+        mPos = end;
+    }
+
+    if (!mError.empty())
+    {
+        out_error = mError;
+        return false;
+    }
+
+    Finish(out_image);
+    return true;
+}
+
+bool DecodeJpeg(const uint8_t* pData, size_t size, Image& out_image, std::string& out_error)
+{
+    JpegDecoder decoder(pData, size);
+    return decoder.Decode(out_image, out_error);
+}
+
+}
@@ -0,0 +1,286 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Implementation of MipChain.h
+----------------------------------------------*/
+#include "MipChain.h"
+
+#include <Muon/Core/JobSystem.h>
+
+#include <algorithm>
+#include <math.h>
+
+namespace TextureCooker {
+
+namespace {
+
+const float    kPi            = 3.14159265358979f;
+const float    kKaiserRadius  = 3.0f;  // In destination texels
+const float    kKaiserAlpha   = 4.0f;
+const uint32_t kRowsPerJob    = 8;
+
+struct FloatImage
+{
+    uint32_t           Width;
+    uint32_t           Height;
+    std::vector<float> Texels;      // RGBA
+};
+
+struct FilterTap
+{
+    uint32_t Index;
+    float    Weight;
+};
+
+// Taps for each destination texel along one axis
+struct FilterKernel
+{
+    std::vector<uint32_t>  First;   // Per destination texel, plus one past the end
+    std::vector<FilterTap> Taps;
+};
+
+float SrgbToLinear(float v)
+{
+    return v <= 0.04045f ? v / 12.92f : powf((v + 0.055f) / 1.055f, 2.4f);
+}
+
+float LinearToSrgb(float v)
+{
+    return v <= 0.0031308f ? v * 12.92f : 1.055f * powf(v, 1.0f / 2.4f) - 0.055f;
+}
+
+uint8_t ToByte(float v)
+{
+    return (uint8_t)(std::min(1.0f, std::max(0.0f, v)) * 255.0f + 0.5f);
+}
+
+float Sinc(float x)
+{
+    return fabsf(x) < 1e-6f ? 1.0f : sinf(kPi * x) / (kPi * x);
+}
+
+// Zeroth order modified Bessel function of the first kind
+float BesselI0(float x)
+{
+    float sum = 1.0f;
+    float term = 1.0f;
+    for (uint32_t k = 1; k != 32; ++k)
+    {
+        term *= (x / (2.0f * k)) * (x / (2.0f * k));
+        sum += term;
+        if (term < sum * 1e-7f)
+            break;
+    }
+    return sum;
+}
+
+float Kaiser(float x)
+{
+    return fabsf(x) >= 1.0f ? 0.0f : BesselI0(kKaiserAlpha * sqrtf(1.0f - x * x)) / BesselI0(kKaiserAlpha);
+}
+
+void BuildKernel(uint32_t srcSize, uint32_t dstSize, MipFilter filter, FilterKernel& out_kernel)
+{
+    const float scale = (float)srcSize / (float)dstSize;
+    out_kernel.First.clear();
+    out_kernel.Taps.clear();
+
+    for (uint32_t x = 0; x != dstSize; ++x)
+    {
+        const uint32_t first = (uint32_t)out_kernel.Taps.size();
+        out_kernel.First.push_back(first);
+
+        if (filter == MipFilter::BOX)
+        {
+            // Each source texel weighs in by how much of it the destination texel covers
+            const float lo = x * scale;
+            const float hi = (x + 1) * scale;
+            for (int32_t i = (int32_t)floorf(lo); (float)i < hi; ++i)
+            {
+                const float weight = std::min(hi, (float)i + 1) - std::max(lo, (float)i);
+                if (weight > 1e-6f)
+                    out_kernel.Taps.push_back({ (uint32_t)std::min<int32_t>(i, (int32_t)srcSize - 1), weight });
+            }
+        }
+        else
+        {
+            const float center = (x + 0.5f) * scale;
+            const float radius = kKaiserRadius * scale;
+            for (int32_t i = (int32_t)floorf(center - radius); (float)i <= ceilf(center + radius); ++i)
+            {
+                const float t = ((float)i + 0.5f - center) / scale;
+                const float weight = Sinc(t) * Kaiser(t / kKaiserRadius);
+                if (weight == 0.0f)
+                    continue;
+
+                const int32_t wrapped = ((i % (int32_t)srcSize) + (int32_t)srcSize) % (int32_t)srcSize;
+                out_kernel.Taps.push_back({ (uint32_t)wrapped, weight });
+            }
+        }
+
+        float sum = 0.0f;
+        for (size_t t = first; t != out_kernel.Taps.size(); ++t)
+            sum += out_kernel.Taps[t].Weight;
+        for (size_t t = first; t != out_kernel.Taps.size(); ++t)
+            out_kernel.Taps[t].Weight /= sum;
+    }
+    out_kernel.First.push_back((uint32_t)out_kernel.Taps.size());
+}
+
+void ForEachRow(uint32_t rows, std::function<void(uint32_t)> const& fn)
+{
+    Core::JobCounter counter;
+    Core::JobSystem::Dispatch(counter, rows, kRowsPerJob, [&fn](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t y = begin; y != end; ++y)
+            fn(y);
+    });
+    Core::JobSystem::Wait(counter);
+}
+
+void Downsample(FloatImage const& src, MipFilter filter, FloatImage& out_dst)
+{
+    out_dst.Width  = std::max(1u, src.Width / 2);
+    out_dst.Height = std::max(1u, src.Height / 2);
+    out_dst.Texels.assign((size_t)out_dst.Width * out_dst.Height * 4, 0.0f);
+
+    FilterKernel horizontal;
+    FilterKernel vertical;
+    BuildKernel(src.Width, out_dst.Width, filter, horizontal);
+    BuildKernel(src.Height, out_dst.Height, filter, vertical);
+
+    // Horizontal into a src.Height tall intermediate, then vertical
+    std::vector<float> temp((size_t)out_dst.Width * src.Height * 4, 0.0f);
+    ForEachRow(src.Height, [&](uint32_t y)
+    {
+        const float* pSrc = src.Texels.data() + (size_t)y * src.Width * 4;
+        float* pDst = temp.data() + (size_t)y * out_dst.Width * 4;
+        for (uint32_t x = 0; x != out_dst.Width; ++x, pDst += 4)
+        {
+            for (uint32_t t = horizontal.First[x]; t != horizontal.First[x + 1]; ++t)
+            {
+                const float* pTexel = pSrc + horizontal.Taps[t].Index * 4;
+                const float weight = horizontal.Taps[t].Weight;
+                for (uint32_t c = 0; c != 4; ++c)
+                    pDst[c] += pTexel[c] * weight;
+            }
+        }
+    });
+
+    ForEachRow(out_dst.Height, [&](uint32_t y)
+    {
+        float* pDst = out_dst.Texels.data() + (size_t)y * out_dst.Width * 4;
+        for (uint32_t t = vertical.First[y]; t != vertical.First[y + 1]; ++t)
+        {
+            const float* pSrc = temp.data() + (size_t)vertical.Taps[t].Index * out_dst.Width * 4;
+            const float weight = vertical.Taps[t].Weight;
+            for (uint32_t i = 0; i != out_dst.Width * 4; ++i)
+                pDst[i] += pSrc[i] * weight;
+        }
+    });
+}
+
+void Renormalize(FloatImage& image)
+{
+    for (size_t i = 0; i < image.Texels.size(); i += 4)
+    {
+        float* n = &image.Texels[i];
+        const float length = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (length > 1e-6f)
+        {
+            n[0] /= length;
+            n[1] /= length;
+            n[2] /= length;
+        }
+        else
+        {
+            // Opposing normals cancelled out; flat is the best guess
+            n[0] = n[1] = 0.0f;
+            n[2] = 1.0f;
+        }
+    }
+}
+
+void ToFloat(Image const& image, TextureUsage usage, FloatImage& out_image)
+{
+    float srgbTable[256];
+    for (uint32_t i = 0; i != 256; ++i)
+        srgbTable[i] = SrgbToLinear(i / 255.0f);
+
+    out_image.Width  = image.Width;
+    out_image.Height = image.Height;
+    out_image.Texels.resize(image.Pixels.size());
+    for (size_t i = 0; i != image.Pixels.size(); ++i)
+    {
+        const uint8_t v = image.Pixels[i];
+        const bool alpha = (i & 3) == 3;
+        if (usage == TextureUsage::COLOR && !alpha)
+            out_image.Texels[i] = srgbTable[v];
+        else if (usage == TextureUsage::NORMAL && !alpha)
+            out_image.Texels[i] = v / 127.5f - 1.0f;
+        else
+            out_image.Texels[i] = v / 255.0f;
+    }
+
+    if (usage == TextureUsage::NORMAL)
+        Renormalize(out_image);
+}
+
+void ToLevel(FloatImage const& image, TextureUsage usage, MipLevel& out_level)
+{
+    out_level.Width  = image.Width;
+    out_level.Height = image.Height;
+    out_level.Pixels.resize(image.Texels.size());
+    for (size_t i = 0; i != image.Texels.size(); ++i)
+    {
+        const float v = image.Texels[i];
+        const bool alpha = (i & 3) == 3;
+        if (usage == TextureUsage::COLOR && !alpha)
+            out_level.Pixels[i] = ToByte(LinearToSrgb(std::max(0.0f, v)));
+        else if (usage == TextureUsage::NORMAL && !alpha)
+            out_level.Pixels[i] = ToByte(v * 0.5f + 0.5f);
+        else
+            out_level.Pixels[i] = ToByte(v);
+    }
+}
+
+}
+
+void GenerateMips(Image const& image, TextureUsage usage, MipFilter filter, std::vector<MipLevel>& out_mips)
+{
+    out_mips.clear();
+
+    FloatImage current;
+    ToFloat(image, usage, current);
+
+    // The top level goes out untouched unless it had to be renormalized
+    out_mips.emplace_back();
+    if (usage == TextureUsage::NORMAL)
+        ToLevel(current, usage, out_mips.back());
+    else
+        out_mips.back() = { image.Width, image.Height, image.Pixels };
+
+    FloatImage next;
+    while (current.Width > 1 || current.Height > 1)
+    {
+        Downsample(current, filter, next);
+        if (usage == TextureUsage::NORMAL)
+            Renormalize(next);
+
+        out_mips.emplace_back();
+        ToLevel(next, usage, out_mips.back());
+        std::swap(current, next);
+    }
+}
+
+const char* GetMipFilterName(MipFilter filter)
+{
+    switch (filter)
+    {
+    case MipFilter::BOX:    return "box";
+    case MipFilter::KAISER: return "kaiser";
+    default:                return "unknown";
+    }
+}
+
+}
@@ -0,0 +1,45 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : CPU mip generation
+Each level is filtered from the one above it in float. Color textures are filtered
+in linear light and re-encoded to sRGB, so dark/bright detail doesn't shift the
+average brightness of distant mips. Normal maps are renormalized at every level.
+Textures are assumed to tile, so filters wrap at the edges.
+----------------------------------------------*/
+#ifndef TEXTURECOOKER_MIPCHAIN_H
+#define TEXTURECOOKER_MIPCHAIN_H
+
+#include "Image.h"
+
+namespace TextureCooker {
+
+enum class TextureUsage : uint8_t
+{
+    COLOR,      // sRGB encoded RGBA (_T)
+    NORMAL,     // Tangent space normals packed as n * 0.5 + 0.5 (_N)
+    SCALAR,     // Linear single channel data in R (_R, _H)
+    COUNT
+};
+
+enum class MipFilter : uint8_t
+{
+    BOX,        // Area average, 2x2 for even sizes
+    KAISER,     // Kaiser windowed sinc: sharper, at the cost of a little ringing
+    COUNT
+};
+
+struct MipLevel
+{
+    uint32_t             Width;
+    uint32_t             Height;
+    std::vector<uint8_t> Pixels;    // RGBA
+};
+
+// Fills out_mips from the full size image down to 1x1. Filtering runs on the job system.
+void GenerateMips(Image const& image, TextureUsage usage, MipFilter filter, std::vector<MipLevel>& out_mips);
+
+const char* GetMipFilterName(MipFilter filter);
+
+}
+#endif
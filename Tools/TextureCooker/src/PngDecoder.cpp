@@ -0,0 +1,278 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : PNG half of Image.h
+----------------------------------------------*/
+#include "Image.h"
+
+#include "Inflate.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+namespace TextureCooker {
+
+namespace {
+
+const uint8_t kPngSignature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+enum PngColorType : uint8_t
+{
+    GREY       = 0,
+    RGB        = 2,
+    PALETTE    = 3,
+    GREY_ALPHA = 4,
+    RGB_ALPHA  = 6,
+};
+
+uint32_t ReadBE32(const uint8_t* p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+uint8_t Paeth(uint8_t a, uint8_t b, uint8_t c)
+{
+    const int p  = (int)a + b - c;
+    const int pa = abs(p - a);
+    const int pb = abs(p - b);
+    const int pc = abs(p - c);
+    if (pa <= pb && pa <= pc)
+        return a;
+    return pb <= pc ? b : c;
+}
+
+// Undoes the per-scanline filters in place. stride is the unfiltered row size, bpp bytes per pixel rounded up.
+bool Unfilter(std::vector<uint8_t>& data, uint32_t height, size_t stride, uint32_t bpp, std::string& out_error)
+{
+    uint8_t* pPrev = nullptr;
+    for (uint32_t y = 0; y != height; ++y)
+    {
+        uint8_t* pRow = data.data() + y * (stride + 1);
+        const uint8_t filter = pRow[0];
+        uint8_t* p = pRow + 1;
+
+        for (size_t x = 0; x != stride; ++x)
+        {
+            const uint8_t a = x >= bpp ? p[x - bpp] : 0;
+            const uint8_t b = pPrev ? pPrev[x] : 0;
+            const uint8_t c = pPrev && x >= bpp ? pPrev[x - bpp] : 0;
+
+            switch (filter)
+            {
+            case 0: break;
+            case 1: p[x] = (uint8_t)(p[x] + a); break;
+            case 2: p[x] = (uint8_t)(p[x] + b); break;
+            case 3: p[x] = (uint8_t)(p[x] + ((a + b) >> 1)); break;
+            case 4: p[x] = (uint8_t)(p[x] + Paeth(a, b, c)); break;
+            default:
+                out_error = "unknown scanline filter";
+                return false;
+            }
+        }
+
+        pPrev = p;
+    }
+
+    return true;
+}
+
+}
+
+bool DecodePng(const uint8_t* pData, size_t size, Image& out_image, std::string& out_error)
+{
+    if (size < 8 || memcmp(pData, kPngSignature, 8))
+    {
+        out_error = "not a PNG";
+        return false;
+    }
+
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint8_t  bitDepth = 0;
+    uint8_t  colorType = 0;
+    uint8_t  palette[256][4];
+    uint32_t paletteSize = 0;
+    bool     hasColorKey = false;
+    uint16_t colorKey[3] = {};
+    std::vector<uint8_t> compressed;
+
+    for (uint32_t i = 0; i != 256; ++i)
+    {
+        memset(palette[i], 0, 3);
+        palette[i][3] = 255;
+    }
+
+    size_t offset = 8;
+    bool ended = false;
+    while (!ended)
+    {
+        if (size - offset < 12)
+        {
+            out_error = "truncated chunk";
+            return false;
+        }
+
+        const uint32_t length = ReadBE32(pData + offset);
+        const uint8_t* pType  = pData + offset + 4;
+        const uint8_t* pChunk = pData + offset + 8;
+        if (length > size - offset - 12)
+        {
+            out_error = "truncated chunk";
+            return false;
+        }
+        offset += 12 + length;
+
+        if (!memcmp(pType, "IHDR", 4))
+        {
+            if (length != 13)
+            {
+                out_error = "bad IHDR";
+                return false;
+            }
+            width     = ReadBE32(pChunk);
+            height    = ReadBE32(pChunk + 4);
+            bitDepth  = pChunk[8];
+            colorType = pChunk[9];
+
+            if (pChunk[12] != 0)
+            {
+                out_error = "interlaced PNGs aren't supported";
+                return false;
+            }
+
+            const bool depthOk = colorType == PALETTE ? bitDepth <= 8 : (colorType == GREY ? true : bitDepth >= 8);
+            if (!width || !height || width > (1u << 15) || height > (1u << 15) || !depthOk || bitDepth > 16 || (bitDepth & (bitDepth - 1)) ||
+                (colorType != GREY && colorType != RGB && colorType != PALETTE && colorType != GREY_ALPHA && colorType != RGB_ALPHA))
+            {
+                out_error = "unsupported PNG format";
+                return false;
+            }
+        }
+        else if (!memcmp(pType, "PLTE", 4))
+        {
+            paletteSize = length / 3;
+            if (paletteSize > 256)
+            {
+                out_error = "bad palette";
+                return false;
+            }
+            for (uint32_t i = 0; i != paletteSize; ++i)
+                memcpy(palette[i], pChunk + i * 3, 3);
+        }
+        else if (!memcmp(pType, "tRNS", 4))
+        {
+            if (colorType == PALETTE)
+            {
+                for (uint32_t i = 0; i != length && i != 256; ++i)
+                    palette[i][3] = pChunk[i];
+            }
+            else if (colorType == GREY && length >= 2)
+            {
+                hasColorKey = true;
+                colorKey[0] = colorKey[1] = colorKey[2] = (uint16_t)((pChunk[0] << 8) | pChunk[1]);
+            }
+            else if (colorType == RGB && length >= 6)
+            {
+                hasColorKey = true;
+                for (uint32_t c = 0; c != 3; ++c)
+                    colorKey[c] = (uint16_t)((pChunk[c * 2] << 8) | pChunk[c * 2 + 1]);
+            }
+        }
+        else if (!memcmp(pType, "IDAT", 4))
+        {
+            compressed.insert(compressed.end(), pChunk, pChunk + length);
+        }
+        else if (!memcmp(pType, "IEND", 4))
+        {
+            ended = true;
+        }
+        else if (!(pType[0] & 0x20))
+        {
+            out_error = "unknown critical chunk " + std::string((const char*)pType, 4);
+            return false;
+        }
+    }
+
+    if (!width || compressed.empty() || (colorType == PALETTE && !paletteSize))
+    {
+        out_error = "missing image data";
+        return false;
+    }
+
+    const uint32_t channels = colorType == GREY || colorType == PALETTE ? 1 : (colorType == GREY_ALPHA ? 2 : (colorType == RGB ? 3 : 4));
+    const uint32_t bitsPerPixel = channels * bitDepth;
+    const size_t   stride = ((size_t)width * bitsPerPixel + 7) / 8;
+
+    std::vector<uint8_t> raw;
+    raw.reserve((stride + 1) * height);
+    if (!InflateZlib(compressed.data(), compressed.size(), raw, out_error))
+        return false;
+
+    if (raw.size() < (stride + 1) * height)
+    {
+        out_error = "image data is too short";
+        return false;
+    }
+
+    if (!Unfilter(raw, height, stride, (bitsPerPixel + 7) / 8, out_error))
+        return false;
+
+    out_image.Width  = width;
+    out_image.Height = height;
+    out_image.Pixels.resize((size_t)width * height * 4);
+
+    // Sub-byte greys are scaled up to the full range, 16-bit samples keep their high byte
+    const uint32_t greyScale = bitDepth < 8 ? 255 / ((1u << bitDepth) - 1) : 1;
+    for (uint32_t y = 0; y != height; ++y)
+    {
+        const uint8_t* pRow = raw.data() + y * (stride + 1) + 1;
+        uint8_t* pOut = out_image.Pixels.data() + (size_t)y * width * 4;
+
+        for (uint32_t x = 0; x != width; ++x, pOut += 4)
+        {
+            uint16_t samples[4];
+            for (uint32_t c = 0; c != channels; ++c)
+            {
+                const size_t sample = (size_t)x * channels + c;
+                if (bitDepth == 16)
+                    samples[c] = (uint16_t)((pRow[sample * 2] << 8) | pRow[sample * 2 + 1]);
+                else if (bitDepth == 8)
+                    samples[c] = pRow[sample];
+                else
+                {
+                    const size_t bit = sample * bitDepth;
+                    samples[c] = (uint16_t)((pRow[bit / 8] >> (8 - bitDepth - bit % 8)) & ((1u << bitDepth) - 1));
+                }
+            }
+
+            const auto to8 = [bitDepth](uint16_t v) { return (uint8_t)(bitDepth == 16 ? v >> 8 : v); };
+            switch (colorType)
+            {
+            case PALETTE:
+                memcpy(pOut, palette[samples[0]], 4);
+                break;
+            case GREY:
+                pOut[0] = pOut[1] = pOut[2] = (uint8_t)(to8(samples[0]) * greyScale);
+                pOut[3] = hasColorKey && samples[0] == colorKey[0] ? 0 : 255;
+                break;
+            case GREY_ALPHA:
+                pOut[0] = pOut[1] = pOut[2] = to8(samples[0]);
+                pOut[3] = to8(samples[1]);
+                break;
+            case RGB:
+                for (uint32_t c = 0; c != 3; ++c)
+                    pOut[c] = to8(samples[c]);
+                pOut[3] = hasColorKey && samples[0] == colorKey[0] && samples[1] == colorKey[1] && samples[2] == colorKey[2] ? 0 : 255;
+                break;
+            default:
+                for (uint32_t c = 0; c != 4; ++c)
+                    pOut[c] = to8(samples[c]);
+                break;
+            }
+        }
+    }
+
+    return true;
+}
+
+}
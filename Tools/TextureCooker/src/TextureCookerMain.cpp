@@ -0,0 +1,502 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2026/10
+Description : Offline texture cooker. Decodes PNG/JPEG sources, builds the full mip
+chain on the CPU and block compresses every level into a DDS that
+DirectX::CreateDDSTextureFromFile loads directly, with no mip generation at load.
+The format follows the usual _X suffix: _T color -> BC7 (or BC1/BC3 with -color bc1),
+_N normal map -> BC5 (x and y; the shader rebuilds z), _R and _H -> BC4.
+Color stays gamma encoded in UNORM formats, as the renderer shades into a UNORM back
+buffer; -srgb writes the _SRGB formats instead. Mips are filtered in linear light either way.
+Textures whose DDS is newer than their source are skipped unless -force is passed.
+-bench encodes every top mip in every format on one thread and on all of them.
+-pack then packs everything in the output folder into texture arrays and atlases under
+Packed/, with a manifest the runtime binds them from (see TexturePacker.h).
+Usage: TextureCooker [-src dir] [-out dir] [-filter box|kaiser] [-color bc7|bc1] [-srgb] [-jobs N] [-force] [-bench] [-pack]
+----------------------------------------------*/
+#include "BlockCompression.h"
+#include "Image.h"
+#include "MipChain.h"
+
+#include <Muon/Core/JobSystem.h>
+#include <Muon/Renderer/DDSFile.h>
+#include <Muon/Renderer/TexturePacker.h>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <math.h>
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+using Renderer::DDSFormat;
+using TextureCooker::MipFilter;
+using TextureCooker::TextureUsage;
+
+namespace {
+
+struct CookOptions
+{
+    fs::path  SourceDir = "Assets/Textures";
+    fs::path  OutputDir = "_bin/Textures";
+    MipFilter Filter    = MipFilter::BOX;
+    bool      ColorBC1  = false;
+    bool      Srgb      = false;
+    uint32_t  JobCount  = 0;
+    bool      Force     = false;
+    bool      Bench     = false;
+    bool      Pack      = false;
+};
+
+struct CookResult
+{
+    std::string Name;
+    DDSFormat   Format;
+    uint32_t    Width;
+    uint32_t    Height;
+    uint32_t    MipCount;
+    uint64_t    UncompressedBytes;  // RGBA8 with mips, what the runtime used to upload
+    uint64_t    CookedBytes;
+    double      MipMs;
+    double      EncodeMs;
+    double      Psnr;               // Of the top mip, over the channels the format stores
+    bool        Skipped;
+};
+
+double Milliseconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool ReadFile(fs::path const& path, std::string& out_bytes)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+
+    std::stringstream stream;
+    stream << file.rdbuf();
+    out_bytes = stream.str();
+    return true;
+}
+
+// "Lunar_T.JPG" -> 'T'
+bool GetUsage(fs::path const& path, TextureUsage* out_usage)
+{
+    const std::string stem = path.stem().string();
+    const size_t underscore = stem.rfind('_');
+    if (underscore == std::string::npos || underscore + 2 != stem.size())
+        return false;
+
+    switch (stem[underscore + 1])
+    {
+    case 'T': *out_usage = TextureUsage::COLOR;  return true;
+    case 'N': *out_usage = TextureUsage::NORMAL; return true;
+    case 'R':
+    case 'H': *out_usage = TextureUsage::SCALAR; return true;
+    default:  return false;
+    }
+}
+
+DDSFormat ChooseFormat(TextureUsage usage, bool hasAlpha, bool blockAligned, CookOptions const& options)
+{
+    // The top mip of a block compressed texture must be a whole number of blocks
+    if (!blockAligned)
+    {
+        if (usage == TextureUsage::NORMAL)
+            return DDSFormat::R8G8_UNORM;
+        if (usage == TextureUsage::SCALAR)
+            return DDSFormat::R8_UNORM;
+        return options.Srgb ? DDSFormat::R8G8B8A8_UNORM_SRGB : DDSFormat::R8G8B8A8_UNORM;
+    }
+
+    if (usage == TextureUsage::NORMAL)
+        return DDSFormat::BC5_UNORM;
+    if (usage == TextureUsage::SCALAR)
+        return DDSFormat::BC4_UNORM;
+
+    if (!options.ColorBC1)
+        return options.Srgb ? DDSFormat::BC7_UNORM_SRGB : DDSFormat::BC7_UNORM;
+    if (hasAlpha)
+        return options.Srgb ? DDSFormat::BC3_UNORM_SRGB : DDSFormat::BC3_UNORM;
+    return options.Srgb ? DDSFormat::BC1_UNORM_SRGB : DDSFormat::BC1_UNORM;
+}
+
+uint32_t GetStoredChannels(DDSFormat format)
+{
+    switch (format)
+    {
+    case DDSFormat::R8_UNORM:
+    case DDSFormat::BC4_UNORM:      return 1;
+    case DDSFormat::R8G8_UNORM:
+    case DDSFormat::BC5_UNORM:      return 2;
+    case DDSFormat::BC1_UNORM:
+    case DDSFormat::BC1_UNORM_SRGB: return 3;
+    default:                        return 4;
+    }
+}
+
+double ComputePsnr(DDSFormat format, std::vector<uint8_t> const& compressed, TextureCooker::MipLevel const& level)
+{
+    if (!Renderer::IsBlockCompressed(format))
+        return INFINITY;
+
+    std::vector<uint8_t> decoded;
+    if (!TextureCooker::DecompressSurface(format, compressed.data(), level.Width, level.Height, decoded))
+        return 0.0;
+
+    const uint32_t channels = GetStoredChannels(format);
+    double sum = 0.0;
+    for (size_t i = 0; i != decoded.size(); ++i)
+    {
+        if ((i & 3) >= channels)
+            continue;
+        const double d = (double)decoded[i] - level.Pixels[i];
+        sum += d * d;
+    }
+
+    const double mse = sum / ((double)level.Width * level.Height * channels);
+    return mse > 0.0 ? 10.0 * log10(255.0 * 255.0 / mse) : INFINITY;
+}
+
+bool CookTexture(fs::path const& source, TextureUsage usage, CookOptions const& options, CookResult& out_result, std::string& out_error)
+{
+    const fs::path target = options.OutputDir / (source.stem().string() + ".dds");
+    out_result.Name = source.filename().string();
+
+    std::error_code ec;
+    if (!options.Force && fs::exists(target, ec) && fs::last_write_time(target, ec) >= fs::last_write_time(source, ec))
+    {
+        out_result.Skipped = true;
+        return true;
+    }
+
+    std::string bytes;
+    TextureCooker::Image image;
+    if (!ReadFile(source, bytes))
+    {
+        out_error = "cannot read file";
+        return false;
+    }
+    if (!TextureCooker::DecodeImage(bytes, image, out_error))
+        return false;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<TextureCooker::MipLevel> mips;
+    TextureCooker::GenerateMips(image, usage, options.Filter, mips);
+    out_result.MipMs = Milliseconds(start);
+
+    const bool blockAligned = image.Width % 4 == 0 && image.Height % 4 == 0;
+    if (!blockAligned)
+        printf("%s: %ux%u isn't a multiple of 4, storing uncompressed\n", out_result.Name.c_str(), image.Width, image.Height);
+
+    Renderer::DDSDesc desc = {};
+    desc.Width     = image.Width;
+    desc.Height    = image.Height;
+    desc.MipCount  = (uint32_t)mips.size();
+    desc.ArraySize = 1;
+    desc.Format    = ChooseFormat(usage, image.HasAlpha(), blockAligned, options);
+
+    std::vector<uint8_t> file;
+    Renderer::WriteDDSHeader(desc, file);
+
+    start = std::chrono::steady_clock::now();
+    std::vector<uint8_t> surface;
+    for (size_t m = 0; m != mips.size(); ++m)
+    {
+        TextureCooker::MipLevel const& level = mips[m];
+        TextureCooker::CompressSurface(desc.Format, level.Pixels.data(), level.Width, level.Height, surface);
+        file.insert(file.end(), surface.begin(), surface.end());
+        out_result.UncompressedBytes += level.Pixels.size();
+
+        if (m == 0)
+        {
+            // Timed with the rest of the encode; it's a small fraction of it
+            out_result.Psnr = ComputePsnr(desc.Format, surface, level);
+        }
+    }
+    out_result.EncodeMs = Milliseconds(start);
+
+    const fs::path temp = target.string() + ".tmp";
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if (!out || !out.write((const char*)file.data(), file.size()))
+        {
+            out_error = "cannot write " + temp.generic_string();
+            return false;
+        }
+    }
+    fs::rename(temp, target, ec);
+    if (ec)
+    {
+        out_error = "cannot write " + target.generic_string();
+        return false;
+    }
+
+    out_result.Format      = desc.Format;
+    out_result.Width       = desc.Width;
+    out_result.Height      = desc.Height;
+    out_result.MipCount    = desc.MipCount;
+    out_result.CookedBytes = file.size();
+    return true;
+}
+
+// Top mip only, every block format the texture's usage could end up in
+void Benchmark(fs::path const& source, TextureUsage usage)
+{
+    std::string bytes;
+    std::string error;
+    TextureCooker::Image image;
+    if (!ReadFile(source, bytes) || !TextureCooker::DecodeImage(bytes, image, error))
+        return;
+
+    std::vector<TextureCooker::MipLevel> mips;
+    TextureCooker::GenerateMips(image, usage, MipFilter::BOX, mips);
+    TextureCooker::MipLevel const& top = mips[0];
+
+    std::vector<DDSFormat> formats;
+    if (usage == TextureUsage::COLOR)
+        formats = { DDSFormat::BC1_UNORM, DDSFormat::BC3_UNORM, DDSFormat::BC7_UNORM };
+    else if (usage == TextureUsage::NORMAL)
+        formats = { DDSFormat::BC5_UNORM };
+    else
+        formats = { DDSFormat::BC4_UNORM };
+
+    const double megapixels = (double)top.Width * top.Height / 1e6;
+    std::vector<uint8_t> surface;
+    for (DDSFormat format : formats)
+    {
+        surface.assign(Renderer::GetDDSSurfaceSize(format, top.Width, top.Height), 0);
+
+        auto start = std::chrono::steady_clock::now();
+        TextureCooker::CompressRows(format, top.Pixels.data(), top.Width, top.Height, 0, (top.Height + 3) / 4, surface.data());
+        const double serialMs = Milliseconds(start);
+
+        start = std::chrono::steady_clock::now();
+        TextureCooker::CompressSurface(format, top.Pixels.data(), top.Width, top.Height, surface);
+        const double parallelMs = Milliseconds(start);
+
+        printf("%-20s %-5s %8.1f MPix/s on 1 thread %8.1f MPix/s on %u  PSNR %6.2f dB\n", source.filename().string().c_str(),
+            Renderer::GetDDSFormatName(format), megapixels / (serialMs / 1000.0), megapixels / (parallelMs / 1000.0),
+            Core::JobSystem::GetWorkerCount() + 1, ComputePsnr(format, surface, top));
+    }
+}
+
+// Packs every cooked texture in the output folder, not just this run's, so pages never miss one that was up to date
+bool PackTextures(CookOptions const& options)
+{
+    std::vector<fs::path> paths;
+    std::error_code ec;
+    for (fs::directory_entry const& entry : fs::directory_iterator(options.OutputDir, ec))
+    {
+        if (entry.is_regular_file() && entry.path().extension() == ".dds")
+            paths.push_back(entry.path());
+    }
+    std::sort(paths.begin(), paths.end());
+
+    std::vector<std::string> files;
+    std::vector<std::string> names;
+    std::vector<Renderer::DDSDesc> descs;
+    for (fs::path const& path : paths)
+    {
+        std::string bytes;
+        Renderer::DDSDesc desc;
+        if (!ReadFile(path, bytes) || !Renderer::ParseDDSHeader((const uint8_t*)bytes.data(), bytes.size(), desc) ||
+            desc.ArraySize != 1 || bytes.size() < Renderer::GetDDSMipOffset(desc, desc.MipCount))
+        {
+            printf("Not packing %s: not a single cooked 2D texture\n", path.filename().string().c_str());
+            continue;
+        }
+
+        files.push_back(std::move(bytes));
+        names.push_back(path.stem().string());
+        descs.push_back(desc);
+    }
+
+    Renderer::TexturePackPlan plan;
+    Renderer::PlanTexturePack(descs.data(), (uint32_t)descs.size(), Renderer::TexturePackerConfig(), plan);
+
+    // Pages from an earlier pack may hold different members, so start clean
+    const fs::path packedDir = options.OutputDir / "Packed";
+    fs::remove_all(packedDir, ec);
+    fs::create_directories(packedDir, ec);
+
+    Renderer::TexturePackManifest manifest;
+    std::vector<uint8_t> page;
+    std::vector<const uint8_t*> surfaces;
+    uint32_t arrayCount = 0;
+    for (uint32_t p = 0; p != (uint32_t)plan.Pages.size(); ++p)
+    {
+        Renderer::TexturePage const& desc = plan.Pages[p];
+        const bool isArray = desc.Kind == Renderer::TexturePageKind::ARRAY;
+        arrayCount += isArray ? 1 : 0;
+
+        surfaces.clear();
+        for (uint32_t member : desc.Members)
+            surfaces.push_back((const uint8_t*)files[member].data() + Renderer::kDDSHeaderSize);
+        Renderer::BuildTexturePage(plan, p, surfaces.data(), page);
+
+        const std::string fileName = "Page" + std::to_string(p) + ".dds";
+        std::ofstream out(packedDir / fileName, std::ios::binary | std::ios::trunc);
+        if (!out || !out.write((const char*)page.data(), page.size()))
+        {
+            fprintf(stderr, "Cannot write %s\n", (packedDir / fileName).generic_string().c_str());
+            return false;
+        }
+        manifest.AddPage(fileName);
+
+        std::string members;
+        for (uint32_t member : desc.Members)
+        {
+            Renderer::TexturePackEntry entry = {};
+            entry.Name  = names[member];
+            entry.Page  = p;
+            entry.Slice = plan.Textures[member].Slice;
+            Renderer::GetPackedUVRect(plan, member, entry.UVRect);
+            manifest.AddEntry(entry);
+
+            members += (members.empty() ? "" : " ") + names[member];
+        }
+
+        printf("%-10s %-5s %-8s %4ux%-4u %2u mips %3zu textures: %s\n", fileName.c_str(), isArray ? "array" : "atlas",
+            Renderer::GetDDSFormatName(desc.Desc.Format), desc.Desc.Width, desc.Desc.Height, desc.Desc.MipCount, desc.Members.size(), members.c_str());
+    }
+
+    if (!manifest.Save(packedDir / "TexturePack.bin"))
+    {
+        fprintf(stderr, "Cannot write %s\n", (packedDir / "TexturePack.bin").generic_string().c_str());
+        return false;
+    }
+
+    printf("Packed %u of %zu textures into %u arrays and %u atlases: %zu textures to bind -> %u\n",
+        manifest.GetEntryCount(), descs.size(), arrayCount, (uint32_t)plan.Pages.size() - arrayCount, descs.size(), plan.GetTextureCount());
+    return true;
+}
+
+bool ParseArguments(int argc, char** argv, CookOptions& out_options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "-force"))
+            out_options.Force = true;
+        else if (!strcmp(argv[i], "-bench"))
+            out_options.Bench = true;
+        else if (!strcmp(argv[i], "-srgb"))
+            out_options.Srgb = true;
+        else if (!strcmp(argv[i], "-pack"))
+            out_options.Pack = true;
+        else if (!strcmp(argv[i], "-src") && hasValue)
+            out_options.SourceDir = argv[++i];
+        else if (!strcmp(argv[i], "-out") && hasValue)
+            out_options.OutputDir = argv[++i];
+        else if (!strcmp(argv[i], "-jobs") && hasValue)
+            out_options.JobCount = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        else if (!strcmp(argv[i], "-filter") && hasValue && (!strcmp(argv[i + 1], "box") || !strcmp(argv[i + 1], "kaiser")))
+            out_options.Filter = !strcmp(argv[++i], "box") ? MipFilter::BOX : MipFilter::KAISER;
+        else if (!strcmp(argv[i], "-color") && hasValue && (!strcmp(argv[i + 1], "bc7") || !strcmp(argv[i + 1], "bc1")))
+            out_options.ColorBC1 = !strcmp(argv[++i], "bc1");
+        else
+        {
+            fprintf(stderr, "Unknown or incomplete argument '%s'\n", argv[i]);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    CookOptions options;
+    if (!ParseArguments(argc, argv, options))
+        return EXIT_FAILURE;
+
+    std::error_code ec;
+    if (!fs::is_directory(options.SourceDir, ec))
+    {
+        fprintf(stderr, "Texture source directory '%s' does not exist\n", options.SourceDir.string().c_str());
+        return EXIT_FAILURE;
+    }
+    fs::create_directories(options.OutputDir, ec);
+
+    // Same folder layout LoadAllTextures expects: flat, named <Name>_<Type>.<ext>
+    std::vector<std::pair<fs::path, TextureUsage>> sources;
+    for (fs::directory_entry const& entry : fs::directory_iterator(options.SourceDir, ec))
+    {
+        std::string ext = entry.path().extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](char c) { return (char)tolower(c); });
+        if (!entry.is_regular_file() || (ext != ".png" && ext != ".jpg" && ext != ".jpeg"))
+            continue;
+
+        TextureUsage usage;
+        if (!GetUsage(entry.path(), &usage))
+        {
+            printf("Skipping %s: no cooking rule for its suffix\n", entry.path().filename().string().c_str());
+            continue;
+        }
+        sources.push_back({ entry.path(), usage });
+    }
+    std::sort(sources.begin(), sources.end());
+
+    Core::JobSystem::Init(options.JobCount);
+    const auto start = std::chrono::steady_clock::now();
+
+    // One texture at a time; the mip filters and encoders go wide within each
+    uint32_t failed = 0;
+    uint32_t cooked = 0;
+    uint64_t uncompressedBytes = 0;
+    uint64_t cookedBytes = 0;
+    for (auto const& source : sources)
+    {
+        CookResult result = {};
+        std::string error;
+        if (!CookTexture(source.first, source.second, options, result, error))
+        {
+            fprintf(stderr, "%s: %s\n", source.first.filename().string().c_str(), error.c_str());
+            failed++;
+            continue;
+        }
+
+        if (result.Skipped)
+        {
+            printf("%-20s up to date\n", result.Name.c_str());
+            continue;
+        }
+
+        cooked++;
+        uncompressedBytes += result.UncompressedBytes;
+        cookedBytes += result.CookedBytes;
+
+        const double megapixels = result.UncompressedBytes / 4.0 / 1e6;
+        printf("%-20s %4ux%-4u %2u mips %-10s %6llu KB -> %5llu KB  mips %6.1f ms  encode %7.1f ms (%6.1f MPix/s)  PSNR %6.2f dB\n",
+            result.Name.c_str(), result.Width, result.Height, result.MipCount, Renderer::GetDDSFormatName(result.Format),
+            (unsigned long long)(result.UncompressedBytes >> 10), (unsigned long long)(result.CookedBytes >> 10),
+            result.MipMs, result.EncodeMs, megapixels / (result.EncodeMs / 1000.0), result.Psnr);
+    }
+
+    printf("Cooked %u textures (%s mips) on %u threads in %.1f ms: %.1f MB of RGBA8 -> %.1f MB, %u failed\n",
+        cooked, TextureCooker::GetMipFilterName(options.Filter), Core::JobSystem::GetWorkerCount() + 1, Milliseconds(start),
+        uncompressedBytes / 1048576.0, cookedBytes / 1048576.0, failed);
+
+    if (options.Pack && !PackTextures(options))
+        failed++;
+
+    if (options.Bench)
+    {
+        for (auto const& source : sources)
+            Benchmark(source.first, source.second);
+    }
+
+    Core::JobSystem::Shutdown();
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
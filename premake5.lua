@@ -1,3 +1,9 @@
+newoption
+{
+    trigger     = "profile",
+    description = "Compile in the scoped CPU profiler (MN_ENABLE_PROFILER)"
+}
+
 workspace "Muon"
     architecture "x64"
     startproject "IsoDungeon"
@@ -13,6 +19,11 @@ workspace "Muon"
 		"MultiProcessorCompile"
 	}
 
+    filter "options:profile"
+        defines "MN_ENABLE_PROFILER"
+
+    filter {}
+
 outputdir = "%{cfg.buildcfg}x64"
 
 project "Muon"
@@ -144,3 +155,182 @@ project "Shaders"
 
     filter { "files:**VS.hlsl" }
         shadertype "Vertex"
+
+project "Headless"
+    location "Headless"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++17"
+
+    targetdir ("_bin/" .. outputdir .. "/%{prj.name}")
+    objdir ("_int/" .. outputdir .. "/%{prj.name}")
+
+    -- Only the platform-independent parts of the engine, so this also builds on Linux (gmake2)
+    files
+    {
+        "%{prj.name}/src/**.h",
+        "%{prj.name}/src/**.cpp",
+        "Muon/src/Muon/Core/CameraPath.*",
+        "Muon/src/Muon/Core/Clock.*",
+        "Muon/src/Muon/Core/DescriptorAllocator.*",
+        "Muon/src/Muon/Core/EntityCommandBuffer.*",
+        "Muon/src/Muon/Core/FrameStatistics.*",
+        "Muon/src/Muon/Core/HeadlessGame.*",
+        "Muon/src/Muon/Core/JobSystem.*",
+        "Muon/src/Muon/Core/PipelineKey.h",
+        "Muon/src/Muon/Core/SPSCQueue.h",
+        "Muon/src/Muon/Core/StepTimer.h",
+        "Muon/src/Muon/Core/Profiler.*",
+        "Muon/src/Muon/Core/World.*",
+        "Muon/src/Muon/Input/ChordMatcher.*",
+        "Muon/src/Muon/Input/GameCommands.h",
+        "Muon/src/Muon/Input/InputBinding.*",
+        "Muon/src/Muon/Input/InputRecording.*",
+        "Muon/src/Muon/Input/InputSystem.*",
+        "Muon/src/Muon/Memory/**",
+        "Muon/src/Muon/Renderer/RenderBackend.h",
+        "Muon/src/Muon/Renderer/ByteStream.h",
+        "Muon/src/Muon/Renderer/CascadedShadows.*",
+        "Muon/src/Muon/Renderer/ClusteredLighting.*",
+        "Muon/src/Muon/Renderer/DDSFile.*",
+        "Muon/src/Muon/Renderer/GPUProfiler.*",
+        "Muon/src/Muon/Renderer/IndirectDrawBuilder.*",
+        "Muon/src/Muon/Renderer/GPUTable.*",
+        "Muon/src/Muon/Renderer/MaterialTable.h",
+        "Muon/src/Muon/Renderer/NullRenderBackend.*",
+        "Muon/src/Muon/Renderer/ParallelRecorder.*",
+        "Muon/src/Muon/Renderer/RenderGraph.*",
+        "Muon/src/Muon/Renderer/ShaderReflectionRecord.*",
+        "Muon/src/Muon/Renderer/TexturePacker.*",
+        "Muon/src/Muon/Renderer/TextureStreamer.*",
+        "Muon/src/Muon/Renderer/hash_util.h"
+    }
+
+    includedirs
+    {
+        "Muon/src"
+    }
+
+    filter "system:windows"
+        staticruntime "On"
+        systemversion "latest"
+
+        defines
+        {
+            "MN_PLATFORM_WINDOWS"
+        }
+
+    filter "system:linux"
+        links
+        {
+            "pthread"
+        }
+
+    filter "configurations:Debug"
+        defines "MN_DEBUG"
+        symbols "On"
+
+    filter "configurations:Release"
+        defines "MN_RELEASE"
+        optimize "On"
+
+project "ShaderBuild"
+    location "Tools/ShaderBuild"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++17"
+
+    targetdir ("_bin/" .. outputdir .. "/%{prj.name}")
+    objdir ("_int/" .. outputdir .. "/%{prj.name}")
+
+    -- Offline tool: drives dxc (or fxc) as a separate process, so it needs none of the D3D headers
+    files
+    {
+        "Tools/%{prj.name}/src/**.h",
+        "Tools/%{prj.name}/src/**.cpp",
+        "Muon/src/Muon/Core/JobSystem.*",
+        "Muon/src/Muon/Core/Profiler.*",
+        "Muon/src/Muon/Renderer/ByteStream.h",
+        "Muon/src/Muon/Renderer/ShaderArchive.*",
+        "Muon/src/Muon/Renderer/ShaderReflectionRecord.*",
+        "Muon/src/Muon/Renderer/ShaderVariant.*",
+        "Muon/src/Muon/Renderer/hash_util.h"
+    }
+
+    includedirs
+    {
+        "Muon/src"
+    }
+
+    filter "system:windows"
+        staticruntime "On"
+        systemversion "latest"
+
+        defines
+        {
+            "MN_PLATFORM_WINDOWS"
+        }
+
+    filter "system:linux"
+        links
+        {
+            "pthread"
+        }
+
+    filter "configurations:Debug"
+        defines "MN_DEBUG"
+        symbols "On"
+
+    filter "configurations:Release"
+        defines "MN_RELEASE"
+        optimize "On"
+
+project "TextureCooker"
+    location "Tools/TextureCooker"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++17"
+
+    targetdir ("_bin/" .. outputdir .. "/%{prj.name}")
+    objdir ("_int/" .. outputdir .. "/%{prj.name}")
+
+    -- Offline tool: decodes, mips and block compresses on the CPU, so it needs neither WIC nor D3D
+    files
+    {
+        "Tools/%{prj.name}/src/**.h",
+        "Tools/%{prj.name}/src/**.cpp",
+        "Muon/src/Muon/Core/JobSystem.*",
+        "Muon/src/Muon/Core/Profiler.*",
+        "Muon/src/Muon/Renderer/ByteStream.h",
+        "Muon/src/Muon/Renderer/DDSFile.*",
+        "Muon/src/Muon/Renderer/TexturePacker.*",
+        "Muon/src/Muon/Renderer/hash_util.h"
+    }
+
+    includedirs
+    {
+        "Muon/src"
+    }
+
+    filter "system:windows"
+        staticruntime "On"
+        systemversion "latest"
+
+        defines
+        {
+            "MN_PLATFORM_WINDOWS"
+        }
+
+    filter "system:linux"
+        links
+        {
+            "pthread"
+        }
+
+    filter "configurations:Debug"
+        defines "MN_DEBUG"
+        symbols "On"
+
+    filter "configurations:Release"
+        defines "MN_RELEASE"
+        optimize "On"